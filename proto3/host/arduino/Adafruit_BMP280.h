@@ -0,0 +1,44 @@
+// ============================================================
+// Adafruit_BMP280.h — host stand-in for the Adafruit BMP280 lib
+// ============================================================
+// Pressure follows the simulated altitude ramp and weather drift
+// (barometric formula, ~1 Pa noise after the x16 IIR filter).
+// readAltitude() uses the library's own formula.
+// ============================================================
+
+#pragma once
+
+#include <stdint.h>
+#include "Wire.h"
+
+class Adafruit_BMP280 {
+public:
+  enum sensor_mode {
+    MODE_SLEEP = 0x00, MODE_FORCED = 0x01, MODE_NORMAL = 0x03,
+    MODE_SOFT_RESET_CODE = 0xB6
+  };
+  enum sensor_sampling {
+    SAMPLING_NONE = 0x00, SAMPLING_X1, SAMPLING_X2, SAMPLING_X4,
+    SAMPLING_X8, SAMPLING_X16
+  };
+  enum sensor_filter {
+    FILTER_OFF = 0x00, FILTER_X2, FILTER_X4, FILTER_X8, FILTER_X16
+  };
+  enum standby_duration {
+    STANDBY_MS_1 = 0x00, STANDBY_MS_63, STANDBY_MS_125, STANDBY_MS_250,
+    STANDBY_MS_500, STANDBY_MS_1000, STANDBY_MS_2000, STANDBY_MS_4000
+  };
+
+  explicit Adafruit_BMP280(TwoWire* = &Wire) {}
+
+  bool  begin(uint8_t addr = 0x77, uint8_t chipid = 0x58);
+  void  setSampling(sensor_mode mode = MODE_NORMAL,
+                    sensor_sampling tempSampling = SAMPLING_X16,
+                    sensor_sampling pressSampling = SAMPLING_X16,
+                    sensor_filter filter = FILTER_OFF,
+                    standby_duration duration = STANDBY_MS_1) {}
+
+  float readTemperature();
+  float readPressure();
+  float readAltitude(float seaLevelhPa = 1013.25f);
+};
@@ -0,0 +1,129 @@
+// ============================================================
+// Arduino.h — host stand-in for the ESP32 Arduino core
+// ============================================================
+// Just enough of the core for tiga_main_v6a.ino. Time comes from
+// the simulator's virtual clock: millis()/micros() read it and
+// delay() advances it, so a 3s delay costs no wall time.
+// Pins, tone() and analogRead() are routed to the simulated world;
+// a pin interrupt runs when the scenario changes that pin.
+// ============================================================
+
+#pragma once
+
+#include <stdint.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <algorithm>
+
+#include "sim.h"
+
+typedef uint8_t byte;
+typedef bool    boolean;
+
+using std::min;
+using std::max;
+
+#define HIGH               1
+#define LOW                0
+#define INPUT              0x01
+#define OUTPUT             0x03
+#define INPUT_PULLUP       0x05
+#define OUTPUT_OPEN_DRAIN  0x13
+
+#define PI          3.1415926535897932384626433832795
+#define DEG_TO_RAD  0.017453292519943295769236907684886
+#define RAD_TO_DEG  57.295779513082320876798154814105
+
+#define radians(deg) ((deg) * DEG_TO_RAD)
+#define degrees(rad) ((rad) * RAD_TO_DEG)
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+// esp_attr.h: RTC slow memory survives deep sleep; a simulated
+// run ends at deep sleep, so plain RAM will do. Code is code.
+#define RTC_DATA_ATTR
+#define IRAM_ATTR
+
+// ── Time ─────────────────────────────────────────────────────
+inline unsigned long micros() { return (unsigned long)(uint32_t)simNowUs(); }
+inline unsigned long millis() { return (unsigned long)(uint32_t)(simNowUs() / 1000); }
+inline void delay(uint32_t ms)             { simDelayUs((uint64_t)ms * 1000); }
+inline void delayMicroseconds(uint32_t us) { simDelayUs(us); }
+inline void yield() {}
+
+// ── GPIO / ADC / LEDC ────────────────────────────────────────
+inline void pinMode(uint8_t, uint8_t) {}
+inline void digitalWrite(uint8_t pin, uint8_t val) { simPinWrite(pin, val != LOW); }
+inline int  digitalRead(uint8_t pin)               { return simPinRead(pin) ? HIGH : LOW; }
+inline uint16_t analogRead(uint8_t pin)            { return simAnalogRead(pin); }
+inline void tone(uint8_t pin, unsigned int hz, unsigned long = 0) { simTone(pin, hz); }
+inline void noTone(uint8_t pin)                                    { simTone(pin, 0); }
+
+// ── Interrupts ───────────────────────────────────────────────
+// One thread: an ISR runs in place of the event that moved the
+// pin, so masking has nothing to hold off
+#define CHANGE   0x03
+#define digitalPinToInterrupt(p) (p)
+inline void attachInterrupt(uint8_t pin, void (*fn)(), int) { simAttachInterrupt(pin, fn); }
+inline void noInterrupts() {}
+inline void interrupts()   {}
+
+// ── Serial ───────────────────────────────────────────────────
+#define SERIAL_8N1  0x800001c
+
+class HardwareSerial {
+public:
+  explicit HardwareSerial(int port) : port_(port) {}
+
+  void begin(unsigned long baud, uint32_t = SERIAL_8N1, int8_t = -1, int8_t = -1) {
+    if (port_ == 0) simSerialBegin((uint32_t)baud);
+  }
+  void end() {}
+  void flush() {}
+
+  // UART RX — the GPS model feeds TinyGPSPlus directly, nothing arrives here
+  int available() { return 0; }
+  int read()      { return -1; }
+
+  int    availableForWrite()                   { return port_ == 0 ? simSerialRoom() : 0; }
+  size_t write(uint8_t b)                      { return write(&b, 1); }
+  size_t write(const uint8_t* p, size_t n)     { return port_ == 0 ? simSerialWrite(p, n) : n; }
+
+  size_t print(const char* s)   { return write((const uint8_t*)s, strlen(s)); }
+  size_t print(char c)          { return write((uint8_t)c); }
+  size_t print(int v)           { return printf("%d", v); }
+  size_t print(unsigned v)      { return printf("%u", v); }
+  size_t print(long v)          { return printf("%ld", v); }
+  size_t print(unsigned long v) { return printf("%lu", v); }
+  size_t print(double v, int d = 2) { return printf("%.*f", d, v); }
+
+  size_t println()              { return print("\r\n"); }
+  template <typename T>
+  size_t println(T v)           { size_t n = print(v); return n + println(); }
+
+  size_t printf(const char* fmt, ...) __attribute__((format(printf, 2, 3))) {
+    char buf[256];
+    va_list ap;
+    va_start(ap, fmt);
+    int n = vsnprintf(buf, sizeof(buf), fmt, ap);
+    va_end(ap);
+    if (n < 0) return 0;
+    if (n >= (int)sizeof(buf)) n = sizeof(buf) - 1;
+    return write((const uint8_t*)buf, (size_t)n);
+  }
+
+private:
+  int port_;
+};
+
+extern HardwareSerial Serial;
+
+// ── NTP / RTC (esp32-hal-time) ───────────────────────────────
+inline void configTime(long gmtOffsetSec, int daylightOffsetSec, const char*,
+                       const char* = nullptr, const char* = nullptr) {
+  simConfigTime(gmtOffsetSec + daylightOffsetSec);
+}
+inline bool getLocalTime(struct tm* info, uint32_t = 5000) { return simLocalTime(info); }
@@ -0,0 +1,265 @@
+// ============================================================
+// BLEDevice.h — host stand-in for the ESP32 BLE (Bluedroid) API
+// ============================================================
+// One server, services, characteristics and descriptors, with
+// the callback shapes the firmware uses. The link is driven from
+// the scenario ("ble connect [mtu]" / "ble disconnect"); notify()
+// and indicate() count packets and bytes only while it is up and
+// the characteristic's CCCD has them on, as the Arduino wrapper
+// does, and hand them to simBleNotifyHook (the simulated phone) if
+// set. The phone subscribes to everything as it connects; "ble
+// unsubscribe" / "ble subscribe" move that later.
+// esp_ble_gatts_send_indicate() does the same and confirms at
+// once through the custom GATTS handler. The GAP calls the
+// stream asks for (connection interval, data length, 2M PHY) are
+// granted as asked and recorded in simWorld.
+// BLEServer.h, BLEUtils.h and BLE2902.h all resolve to this file.
+// ============================================================
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <vector>
+#include "sim.h"
+
+class BLEServer;
+class BLECharacteristic;
+
+// The simulated central: sees every notification while the link is up
+extern void (*simBleNotifyHook)(BLECharacteristic* c, const uint8_t* p, size_t n);
+
+// esp_gatts_api.h — the events the firmware listens for, and
+// indications sent past the Arduino wrapper (whose indicate()
+// blocks until the phone confirms)
+typedef uint8_t esp_gatt_if_t;
+typedef uint8_t esp_bd_addr_t[6];
+typedef enum { ESP_GATTS_CONF_EVT = 5, ESP_GATTS_CONGEST_EVT = 24 } esp_gatts_cb_event_t;
+typedef enum { ESP_GATT_OK = 0 } esp_gatt_status_t;
+typedef union {
+  struct { esp_gatt_status_t status; uint16_t conn_id; uint16_t handle; uint16_t len; uint8_t* value; } conf;
+  struct { uint16_t conn_id; bool congested; } congest;
+  struct { uint16_t conn_id; esp_bd_addr_t remote_bda; } connect;
+} esp_ble_gatts_cb_param_t;
+typedef void (*gatts_event_handler)(esp_gatts_cb_event_t, esp_gatt_if_t, esp_ble_gatts_cb_param_t*);
+
+class BLEDescriptor {
+public:
+  virtual ~BLEDescriptor() {}
+};
+
+// Off until the simulated phone subscribes
+class BLE2902 : public BLEDescriptor {
+public:
+  void setNotifications(bool on) { notify_ = on; }
+  void setIndications(bool on)   { indicate_ = on; }
+  bool getNotifications() const  { return notify_; }
+  bool getIndications() const    { return indicate_; }
+private:
+  bool notify_ = false, indicate_ = false;
+};
+
+class BLECharacteristicCallbacks {
+public:
+  virtual ~BLECharacteristicCallbacks() {}
+  virtual void onRead(BLECharacteristic*) {}
+  virtual void onWrite(BLECharacteristic*) {}
+};
+
+class BLECharacteristic {
+public:
+  static const uint32_t PROPERTY_READ      = 1 << 0;
+  static const uint32_t PROPERTY_WRITE     = 1 << 1;
+  static const uint32_t PROPERTY_NOTIFY    = 1 << 2;
+  static const uint32_t PROPERTY_BROADCAST = 1 << 3;
+  static const uint32_t PROPERTY_INDICATE  = 1 << 4;
+  static const uint32_t PROPERTY_WRITE_NR  = 1 << 5;
+
+  BLECharacteristic(const char* uuid, uint32_t props) : uuid_(uuid), props_(props) {
+    static uint16_t handles = 0x29;
+    handle_ = handles += 3;                 // value, declaration, CCCD
+  }
+
+  void addDescriptor(BLEDescriptor* d)              { descs_.push_back(d); }
+  void setCallbacks(BLECharacteristicCallbacks* cb) { cb_ = cb; }
+  void setValue(const uint8_t* p, size_t n)         { value_.assign(p, p + n); }
+  void setValue(const char* s)                      { setValue((const uint8_t*)s, strlen(s)); }
+  uint8_t* getData()                                { return value_.data(); }
+  size_t   getLength() const                        { return value_.size(); }
+  const char* getUUID() const                       { return uuid_; }
+  uint16_t    getHandle() const                     { return handle_; }
+
+  void notify(bool = true) { if (subscribed(false)) send(); }
+  void indicate()          { if (subscribed(true)) send(); }
+  bool sendRaw(const uint8_t* p, size_t n)          { setValue(p, n); return send(); }
+
+  // Simulator side: a central wrote to us
+  void simWrite(const uint8_t* p, size_t n) {
+    setValue(p, n);
+    if (cb_) cb_->onWrite(this);
+  }
+
+  // Simulator side: the central wrote our CCCD
+  void simSubscribe(bool on) {
+    for (BLEDescriptor* d : descs_)
+      if (BLE2902* c = dynamic_cast<BLE2902*>(d)) { c->setNotifications(on); c->setIndications(on); }
+  }
+
+private:
+  const char*                 uuid_;
+  uint32_t                    props_;
+  uint16_t                    handle_;
+  std::vector<uint8_t>        value_;
+  std::vector<BLEDescriptor*> descs_;
+  BLECharacteristicCallbacks* cb_ = nullptr;
+
+  // No CCCD: the wrapper sends anyway
+  bool subscribed(bool ind) const {
+    for (BLEDescriptor* d : descs_)
+      if (const BLE2902* c = dynamic_cast<const BLE2902*>(d)) return ind ? c->getIndications() : c->getNotifications();
+    return true;
+  }
+
+  bool send() {
+    if (!simWorld.bleLink) return false;
+    simIo.bleNotifies++;
+    simIo.bleBytes += value_.size();
+    if (simBleNotifyHook) simBleNotifyHook(this, value_.data(), value_.size());
+    return true;
+  }
+};
+
+class BLEService {
+public:
+  explicit BLEService(const char* uuid) : uuid_(uuid) {}
+  BLECharacteristic* createCharacteristic(const char* uuid, uint32_t props) {
+    chars_.push_back(new BLECharacteristic(uuid, props));
+    return chars_.back();
+  }
+  void start() {}
+  const char* getUUID() const { return uuid_; }
+  const std::vector<BLECharacteristic*>& characteristics() const { return chars_; }
+private:
+  const char*                     uuid_;
+  std::vector<BLECharacteristic*> chars_;
+};
+
+class BLEServerCallbacks {
+public:
+  virtual ~BLEServerCallbacks() {}
+  virtual void onConnect(BLEServer*) {}
+  virtual void onConnect(BLEServer*, esp_ble_gatts_cb_param_t*) {}   // called right after
+  virtual void onDisconnect(BLEServer*) {}
+};
+
+class BLEServer {
+public:
+  void        setCallbacks(BLEServerCallbacks* cb) { cb_ = cb; }
+  BLEService* createService(const char* uuid) {
+    services_.push_back(new BLEService(uuid));
+    return services_.back();
+  }
+  uint32_t getConnectedCount() const { return simWorld.bleLink ? 1 : 0; }
+  uint16_t getConnId() const         { return 0; }
+  uint16_t getGattsIf() const        { return 3; }
+  uint16_t getPeerMTU(uint16_t) const;
+
+  // Simulator side: link state changes from the scenario
+  void simLink(bool up) {
+    if (up == simWorld.bleLink) return;
+    simWorld.bleLink = up;
+    if (up) { simWorld.bleInterval = 24; simWorld.ble2M = false; }
+    esp_ble_gatts_cb_param_t p = {};
+    memcpy(p.connect.remote_bda, "\x24\x6f\x28\x11\x22\x33", 6);
+    if (!cb_) return;
+    if (up) { cb_->onConnect(this); cb_->onConnect(this, &p); simSubscribe(true); }
+    else    cb_->onDisconnect(this);
+  }
+
+  // The central writing every CCCD on or off
+  void simSubscribe(bool on) {
+    for (BLEService* sv : services_)
+      for (BLECharacteristic* c : sv->characteristics()) c->simSubscribe(on);
+  }
+  const std::vector<BLEService*>& services() const { return services_; }
+
+private:
+  BLEServerCallbacks*      cb_ = nullptr;
+  std::vector<BLEService*> services_;
+};
+
+class BLEAdvertising {
+public:
+  void addServiceUUID(const char*) {}
+  void setScanResponse(bool) {}
+  void setMinPreferred(uint16_t) {}
+  void start() {}
+};
+
+class BLEDevice {
+public:
+  static void init(const char*) {}
+  static BLEServer* createServer() {
+    if (!server()) server() = new BLEServer();
+    return server();
+  }
+  static BLEAdvertising* getAdvertising() { static BLEAdvertising adv; return &adv; }
+  static void startAdvertising() {}
+  static void setMTU(uint16_t mtu) { mtu_() = mtu; }
+  static uint16_t getMTU() { return mtu_(); }
+  static void setCustomGattsHandler(gatts_event_handler h) { handler() = h; }   // never congested
+
+  static BLEServer*& server() { static BLEServer* s = nullptr; return s; }
+  static gatts_event_handler& handler() { static gatts_event_handler h = nullptr; return h; }
+
+private:
+  static uint16_t& mtu_() { static uint16_t m = 23; return m; }
+};
+
+// What the exchange settles on: the smaller of the two asks
+inline uint16_t BLEServer::getPeerMTU(uint16_t) const {
+  uint16_t m = BLEDevice::getMTU();
+  return simWorld.bleMtu < m ? simWorld.bleMtu : m;
+}
+
+inline int esp_ble_gatts_send_indicate(esp_gatt_if_t gatts_if, uint16_t conn_id, uint16_t attr_handle,
+                                       uint16_t value_len, uint8_t* value, bool need_confirm) {
+  BLEServer* s = BLEDevice::server();
+  if (!s) return -1;
+  for (BLEService* sv : s->services())
+    for (BLECharacteristic* c : sv->characteristics()) {
+      if (c->getHandle() != attr_handle) continue;
+      if (!c->sendRaw(value, value_len)) return -1;
+      if (need_confirm && BLEDevice::handler()) {
+        esp_ble_gatts_cb_param_t p = {};
+        p.conf.status  = ESP_GATT_OK;
+        p.conf.conn_id = conn_id;
+        p.conf.handle  = attr_handle;
+        BLEDevice::handler()(ESP_GATTS_CONF_EVT, gatts_if, &p);
+      }
+      return 0;
+    }
+  return -1;
+}
+
+// esp_gap_ble_api.h — what the watch asks of the link once up
+#define CONFIG_BT_BLE_50_FEATURES_SUPPORTED 1
+#define ESP_BLE_GAP_PHY_2M_PREF_MASK        (1 << 1)
+#define ESP_BLE_GAP_PHY_OPTIONS_NO_PREF     0
+typedef struct {
+  esp_bd_addr_t bda;
+  uint16_t      min_int, max_int, latency, timeout;
+} esp_ble_conn_update_params_t;
+
+inline int esp_ble_gap_update_conn_params(esp_ble_conn_update_params_t* p) {
+  if (!simWorld.bleLink) return -1;
+  simWorld.bleInterval = p->min_int;
+  return 0;
+}
+inline int esp_ble_gap_set_pkt_data_len(esp_bd_addr_t, uint16_t) { return simWorld.bleLink ? 0 : -1; }
+inline int esp_ble_gap_set_preferred_phy(esp_bd_addr_t, uint8_t, uint8_t tx, uint8_t, uint16_t) {
+  if (!simWorld.bleLink) return -1;
+  simWorld.ble2M = tx & ESP_BLE_GAP_PHY_2M_PREF_MASK;
+  return 0;
+}
@@ -0,0 +1,3 @@
+// Host stand-in — see BLEDevice.h
+#pragma once
+#include "BLEDevice.h"
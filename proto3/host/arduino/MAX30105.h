@@ -0,0 +1,32 @@
+// ============================================================
+// MAX30105.h — host stand-in for the SparkFun MAX3010x library
+// ============================================================
+// Only the configuration calls live here. Sample data is read
+// the way tiga_ppg_fifo.h reads it on the device — raw FIFO
+// registers over Wire — from the MAX30102 register model that
+// sim_sensors.cpp attaches at 0x57.
+// ============================================================
+
+#pragma once
+
+#include <stdint.h>
+#include "Wire.h"
+
+#define I2C_SPEED_STANDARD  100000
+#define I2C_SPEED_FAST      400000
+
+class MAX30105 {
+public:
+  bool begin(TwoWire& bus = Wire, uint32_t i2cSpeed = I2C_SPEED_STANDARD,
+             uint8_t addr = 0x57);
+
+  // Same defaults as the SparkFun library
+  void setup(uint8_t powerLevel = 0x1F, uint8_t sampleAverage = 4,
+             uint8_t ledMode = 3, int sampleRate = 400,
+             int pulseWidth = 411, int adcRange = 4096);
+
+  void setPulseAmplitudeRed(uint8_t) {}
+  void setPulseAmplitudeIR(uint8_t) {}
+  void setPulseAmplitudeGreen(uint8_t) {}
+  void clearFIFO();
+};
@@ -0,0 +1,68 @@
+// ============================================================
+// MPU6050.h — host stand-in for the Electronic Cats MPU6050 lib
+// ============================================================
+// Models the part the firmware relies on: sample-rate divider,
+// DLPF, full-scale ranges, the 1 KB FIFO with its frame layout
+// (accel, temp, gyro X/Y/Z — whichever are enabled) and the
+// FIFO overflow interrupt flag, which clears when read.
+// Samples come from the simulated wearer (sim_sensors.cpp) or a
+// capture replay. Each call costs its I2C transfer time.
+// ============================================================
+
+#pragma once
+
+#include <stdint.h>
+
+#define MPU6050_ACCEL_FS_2    0x00
+#define MPU6050_ACCEL_FS_4    0x01
+#define MPU6050_ACCEL_FS_8    0x02
+#define MPU6050_ACCEL_FS_16   0x03
+
+#define MPU6050_GYRO_FS_250   0x00
+#define MPU6050_GYRO_FS_500   0x01
+#define MPU6050_GYRO_FS_1000  0x02
+#define MPU6050_GYRO_FS_2000  0x03
+
+#define MPU6050_DLPF_BW_256   0x00
+#define MPU6050_DLPF_BW_188   0x01
+#define MPU6050_DLPF_BW_98    0x02
+#define MPU6050_DLPF_BW_42    0x03
+#define MPU6050_DLPF_BW_20    0x04
+#define MPU6050_DLPF_BW_10    0x05
+#define MPU6050_DLPF_BW_5     0x06
+
+#define MPU6050_FIFO_BYTES    1024
+
+class MPU6050 {
+public:
+  explicit MPU6050(uint8_t addr = 0x68) : addr_(addr) {}
+
+  void initialize();
+  bool testConnection();
+
+  void setFullScaleAccelRange(uint8_t range);
+  void setFullScaleGyroRange(uint8_t range);
+  void setDLPFMode(uint8_t mode);
+  void setRate(uint8_t div);
+
+  void getAcceleration(int16_t* x, int16_t* y, int16_t* z);
+  void getRotation(int16_t* x, int16_t* y, int16_t* z);
+  void getMotion6(int16_t* ax, int16_t* ay, int16_t* az,
+                  int16_t* gx, int16_t* gy, int16_t* gz);
+  int16_t getTemperature();
+
+  // FIFO
+  void     setAccelFIFOEnabled(bool on);
+  void     setXGyroFIFOEnabled(bool on);
+  void     setYGyroFIFOEnabled(bool on);
+  void     setZGyroFIFOEnabled(bool on);
+  void     setTempFIFOEnabled(bool on);
+  void     setFIFOEnabled(bool on);
+  void     resetFIFO();
+  uint16_t getFIFOCount();
+  void     getFIFOBytes(uint8_t* data, uint8_t length);
+  bool     getIntFIFOBufferOverflowStatus();
+
+private:
+  uint8_t  addr_;
+};
@@ -0,0 +1,275 @@
+// ============================================================
+// TFT_eSPI.h — host stand-in for Bodmer's TFT_eSPI
+// ============================================================
+// Draws into RAM: the panel object into the simulated LCD's
+// framebuffer (which sim.cpp can dump as an image), TFT_eSprite
+// into its own buffer. Anything that reaches the panel also
+// counts bus bytes and blocks the virtual clock for them, so slow
+// screens show up as scheduler jitter and overruns as on the board.
+//
+// Configured like the T-Display-S3 setup: 8-bit parallel bus,
+// TFT_PARALLEL_8_BIT, no DMA. Build with -DSIM_LCD_SPI for an SPI
+// panel instead; that defines ESP32_DMA and pushImageDMA() then
+// runs in the background (sim.cpp queues the transfer).
+//
+// Byte model (ST7789, 16-bit pixels):
+//   every window     11 bytes of CASET/RASET/RAMWR
+//   fills            2 bytes per pixel, clipped to the screen
+//   images           2 bytes per pixel, one window
+//   opaque text      one window per glyph, 6×8×size² pixels
+//   transparent text ~14 lit pixels per glyph, each its own
+//                    size×size window — why it is slow
+// Sprites draw in RAM and cost nothing until pushed.
+// ============================================================
+
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+#include <vector>
+#include "sim.h"
+#include "glcdfont.h"
+
+#ifdef SIM_LCD_SPI
+#define ESP32_DMA
+#else
+#define TFT_PARALLEL_8_BIT
+#endif
+
+#define TL_DATUM 0
+#define TC_DATUM 1
+#define TR_DATUM 2
+#define ML_DATUM 3
+#define MC_DATUM 4
+#define MR_DATUM 5
+#define BL_DATUM 6
+#define BC_DATUM 7
+#define BR_DATUM 8
+
+#define TFT_BLACK  0x0000
+#define TFT_WHITE  0xFFFF
+#define TFT_RED    0xF800
+#define TFT_GREEN  0x07E0
+#define TFT_BLUE   0x001F
+
+#define TFT_WINDOW_BYTES  11
+#define TFT_GLYPH_LIT     14
+
+class TFT_eSPI {
+public:
+  TFT_eSPI(int16_t w = 170, int16_t h = 320) : w0_(w), h0_(h), w_(w), h_(h) {}
+  virtual ~TFT_eSPI() {}
+
+  void init()                    { attachPanel(); simLcdCost(64); }   // reset + init sequence
+  void setRotation(uint8_t r) {
+    rot_ = r & 3;
+    w_ = (rot_ & 1) ? h0_ : w0_;
+    h_ = (rot_ & 1) ? w0_ : h0_;
+    if (panel_) attachPanel();
+  }
+  void setSwapBytes(bool s)      { swap_ = s; }
+  bool getSwapBytes() const      { return swap_; }
+  int16_t width()  const         { return w_; }
+  int16_t height() const         { return h_; }
+
+  void setTextDatum(uint8_t d)   { datum_ = d; }
+  void setTextSize(uint8_t s)    { size_ = s ? s : 1; }
+  void setTextColor(uint16_t c)  { fg_ = bg_ = c; }
+  void setTextColor(uint16_t c, uint16_t bg, bool = false) { fg_ = c; bg_ = bg; }
+
+  void fillScreen(uint16_t c)    { fillRect(0, 0, w_, h_, c); }
+  void fillRect(int32_t x, int32_t y, int32_t w, int32_t h, uint16_t c) {
+    if (!clip(x, y, w, h)) return;
+    for (int32_t r = 0; r < h; r++) span(x, y + r, w, c);
+    cost(1, (uint32_t)w * h * 2);
+  }
+  void drawRect(int32_t x, int32_t y, int32_t w, int32_t h, uint16_t c) {
+    fillRect(x, y, w, 1, c); fillRect(x, y + h - 1, w, 1, c);
+    fillRect(x, y, 1, h, c); fillRect(x + w - 1, y, 1, h, c);
+  }
+  void drawFastHLine(int32_t x, int32_t y, int32_t w, uint16_t c) { fillRect(x, y, w, 1, c); }
+  void drawFastVLine(int32_t x, int32_t y, int32_t h, uint16_t c) { fillRect(x, y, 1, h, c); }
+  void drawPixel(int32_t x, int32_t y, uint16_t c)                { fillRect(x, y, 1, 1, c); }
+
+  void drawLine(int32_t x0, int32_t y0, int32_t x1, int32_t y1, uint16_t c) {
+    int32_t dx = x1 > x0 ? x1 - x0 : x0 - x1, sx = x0 < x1 ? 1 : -1;
+    int32_t dy = y1 > y0 ? y0 - y1 : y1 - y0, sy = y0 < y1 ? 1 : -1;
+    int32_t err = dx + dy, n = 0;
+    for (;;) {                            // Bresenham, pixel by pixel
+      plot(x0, y0, c); n++;
+      if (x0 == x1 && y0 == y1) break;
+      int32_t e2 = 2 * err;
+      if (e2 >= dy) { err += dy; x0 += sx; }
+      if (e2 <= dx) { err += dx; y0 += sy; }
+    }
+    cost(n, n * 2);
+  }
+  void fillCircle(int32_t x, int32_t y, int32_t r, uint16_t c) {
+    for (int32_t dy = -r; dy <= r; dy++) {
+      int32_t dx = 0;
+      while ((dx + 1) * (dx + 1) + dy * dy <= r * r + r) dx++;
+      span(x - dx, y + dy, 2 * dx + 1, c);
+    }
+    cost(2 * r + 1, (uint32_t)(3.1416f * r * r) * 2);   // one span per row
+  }
+  void drawCircle(int32_t x, int32_t y, int32_t r, uint16_t c) {
+    int32_t px = r, py = 0, err = 1 - r;
+    while (px >= py) {                    // midpoint, eight octants
+      plot(x + px, y + py, c); plot(x + py, y + px, c);
+      plot(x - py, y + px, c); plot(x - px, y + py, c);
+      plot(x - px, y - py, c); plot(x - py, y - px, c);
+      plot(x + py, y - px, c); plot(x + px, y - py, c);
+      py++;
+      if (err < 0) err += 2 * py + 1;
+      else         { px--; err += 2 * (py - px) + 1; }
+    }
+    uint32_t n = (uint32_t)(6.2832f * r);
+    cost(n, n * 2);
+  }
+
+  int16_t textWidth(const char* s) const { return (int16_t)(strlen(s) * 6 * size_); }
+  int16_t fontHeight() const             { return (int16_t)(8 * size_); }
+
+  int16_t drawString(const char* s, int32_t x, int32_t y) {
+    uint32_t n  = (uint32_t)strlen(s);
+    int32_t  tw = textWidth(s), th = fontHeight();
+    if (datum_ % 3 == 1) x -= tw / 2;
+    if (datum_ % 3 == 2) x -= tw;
+    if (datum_ / 3 == 1) y -= th / 2;
+    if (datum_ / 3 == 2) y -= th;
+    for (const char* p = s; *p; p++, x += 6 * size_) glyph((uint8_t)*p, x, y);
+
+    if (fg_ != bg_) cost(n, n * 6 * 8 * size_ * size_ * 2);
+    else            cost(n * TFT_GLYPH_LIT, n * TFT_GLYPH_LIT * size_ * size_ * 2);
+    return (int16_t)tw;
+  }
+  int16_t drawString(const char* s, int32_t x, int32_t y, uint8_t) { return drawString(s, x, y); }
+
+  // Image in bus order unless swap bytes is on, as on the device
+  void pushImage(int32_t x, int32_t y, int32_t w, int32_t h, const uint16_t* data) {
+    blit(x, y, w, h, data);
+    cost(1, (uint32_t)w * h * 2);
+  }
+
+#ifdef ESP32_DMA
+  bool initDMA(bool = false) { dma_ = true; return true; }
+  bool dmaBusy() const       { return simNowUs() < dmaDoneUs_; }
+  void dmaWait()             { if (dmaBusy()) simAdvanceUs(dmaDoneUs_ - simNowUs()); }
+  void pushImageDMA(int32_t x, int32_t y, int32_t w, int32_t h, const uint16_t* data,
+                    uint16_t* = nullptr) {
+    dmaWait();
+    blit(x, y, w, h, data);
+    simIo.lcdCalls++;
+    dmaDoneUs_ = simLcdDma(TFT_WINDOW_BYTES + (uint32_t)w * h * 2);
+  }
+#endif
+
+protected:
+  int16_t  w0_, h0_, w_, h_;
+  uint8_t  rot_   = 0;
+  uint8_t  datum_ = TL_DATUM;
+  uint8_t  size_  = 1;
+  uint16_t fg_    = 0xFFFF, bg_ = 0xFFFF;
+  bool     swap_  = false;
+  bool     panel_ = true;          // false for sprites: RAM only, no bus
+  bool     swapStore_ = false;     // sprites keep pixels byte-swapped
+  std::vector<uint16_t> px_;
+#ifdef ESP32_DMA
+  bool     dma_ = false;
+  uint64_t dmaDoneUs_ = 0;
+#endif
+
+  static uint16_t bswap(uint16_t c) { return (uint16_t)(c << 8 | c >> 8); }
+
+  void attachPanel() {
+    px_.assign((size_t)w_ * h_, 0);
+    simLcdAttach(px_.data(), w_, h_);
+  }
+
+  bool clip(int32_t& x, int32_t& y, int32_t& w, int32_t& h) const {
+    if (x < 0) { w += x; x = 0; }
+    if (y < 0) { h += y; y = 0; }
+    if (x + w > w_) w = w_ - x;
+    if (y + h > h_) h = h_ - y;
+    return w > 0 && h > 0 && !px_.empty();
+  }
+
+  void span(int32_t x, int32_t y, int32_t w, uint16_t c) {
+    int32_t h = 1;
+    if (!clip(x, y, w, h)) return;
+    uint16_t v = swapStore_ ? bswap(c) : c;
+    uint16_t* p = &px_[(size_t)y * w_ + x];
+    for (int32_t i = 0; i < w; i++) p[i] = v;
+    if (panel_) simLcdTouch();
+  }
+
+  void plot(int32_t x, int32_t y, uint16_t c) { span(x, y, 1, c); }
+
+  void glyph(uint8_t ch, int32_t x, int32_t y) {
+    if (fg_ != bg_) {
+      for (int32_t r = 0; r < 8 * size_; r++) span(x, y + r, 6 * size_, bg_);
+    }
+    if (ch < 0x20 || ch > 0x7E) return;
+    const uint8_t* cols = simFont5x7[ch - 0x20];
+    for (int32_t cx = 0; cx < 5; cx++) {
+      for (int32_t cy = 0; cy < 8; cy++) {
+        if (!(cols[cx] >> cy & 1)) continue;
+        for (int32_t r = 0; r < size_; r++)
+          span(x + cx * size_, y + cy * size_ + r, size_, fg_);
+      }
+    }
+  }
+
+  // Bus order on the wire is high byte first: without swap bytes
+  // the panel sees each word byte-swapped
+  void blit(int32_t x, int32_t y, int32_t w, int32_t h, const uint16_t* data) {
+    int32_t cx = x, cy = y, cw = w, ch = h;
+    if (!clip(cx, cy, cw, ch)) return;
+    for (int32_t r = 0; r < ch; r++) {
+      const uint16_t* src = &data[(size_t)(cy - y + r) * w + (cx - x)];
+      uint16_t* dst = &px_[(size_t)(cy + r) * w_ + cx];
+      for (int32_t i = 0; i < cw; i++) {
+        uint16_t c = swap_ ? src[i] : bswap(src[i]);
+        dst[i] = swapStore_ ? bswap(c) : c;
+      }
+    }
+    if (panel_) simLcdTouch();
+  }
+
+  void cost(uint32_t windows, uint32_t pixelBytes) {
+    if (!panel_) return;
+    simIo.lcdCalls++;
+    simLcdCost(windows * TFT_WINDOW_BYTES + pixelBytes);
+  }
+};
+
+// ── TFT_eSprite: 16-bit only ─────────────────────────────────
+class TFT_eSprite : public TFT_eSPI {
+public:
+  explicit TFT_eSprite(TFT_eSPI* tft) : TFT_eSPI(0, 0), tft_(tft) {
+    panel_ = false;
+    swapStore_ = true;
+  }
+
+  void* createSprite(int16_t w, int16_t h, uint8_t = 1) {
+    w0_ = w_ = w;
+    h0_ = h_ = h;
+    px_.assign((size_t)w * h, 0);
+    return px_.data();
+  }
+  void  deleteSprite()             { px_.clear(); px_.shrink_to_fit(); }
+  bool  created() const            { return !px_.empty(); }
+  void* getPointer()               { return px_.empty() ? nullptr : px_.data(); }
+  void* setColorDepth(int8_t)      { return getPointer(); }
+  void  fillSprite(uint16_t c)     { fillScreen(c); }
+
+  void pushSprite(int32_t x, int32_t y) {
+    bool s = tft_->getSwapBytes();
+    tft_->setSwapBytes(false);
+    tft_->pushImage(x, y, w_, h_, px_.data());
+    tft_->setSwapBytes(s);
+  }
+
+private:
+  TFT_eSPI* tft_;
+};
@@ -0,0 +1,41 @@
+// ============================================================
+// TinyGPSPlus.h — host stand-in for TinyGPS++
+// ============================================================
+// No NMEA: the fields read the simulated GPS directly (fix, sats,
+// position moving at walking pace). distanceBetween() is the
+// library's great-circle formula.
+// ============================================================
+
+#pragma once
+
+#include <stdint.h>
+
+struct TinyGPSLocation {
+  bool     isValid() const;
+  bool     isUpdated() const { return isValid(); }
+  uint32_t age() const;
+  double   lat() const;
+  double   lng() const;
+};
+
+struct TinyGPSSpeed {
+  bool   isValid() const;
+  double kmph() const;
+  double mps() const { return kmph() / 3.6; }
+};
+
+struct TinyGPSInteger {
+  bool     isValid() const;
+  uint32_t value() const;
+};
+
+class TinyGPSPlus {
+public:
+  bool encode(char) { return false; }
+
+  TinyGPSLocation location;
+  TinyGPSSpeed    speed;
+  TinyGPSInteger  satellites;
+
+  static double distanceBetween(double lat1, double long1, double lat2, double long2);
+};
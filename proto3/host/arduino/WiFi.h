@@ -0,0 +1,40 @@
+// ============================================================
+// WiFi.h — host stand-in for the ESP32 WiFi class
+// ============================================================
+// Station mode only. Associates one virtual second after begin()
+// unless the scenario turned WiFi off ("wifi off").
+// ============================================================
+
+#pragma once
+
+#include <stdint.h>
+#include "sim.h"
+
+typedef enum {
+  WL_IDLE_STATUS    = 0,
+  WL_NO_SSID_AVAIL  = 1,
+  WL_CONNECTED      = 3,
+  WL_CONNECT_FAILED = 4,
+  WL_DISCONNECTED   = 6
+} wl_status_t;
+
+class WiFiClass {
+public:
+  wl_status_t begin(const char*, const char* = nullptr) {
+    beginUs_ = simNowUs();
+    started_ = true;
+    return status();
+  }
+  wl_status_t status() {
+    if (!started_ || !simWorld.wifi) return WL_DISCONNECTED;
+    return simNowUs() - beginUs_ >= 1000000ULL ? WL_CONNECTED : WL_DISCONNECTED;
+  }
+  bool disconnect(bool = false) { started_ = false; return true; }
+  bool mode(int)                { return true; }
+
+private:
+  uint64_t beginUs_ = 0;
+  bool     started_ = false;
+};
+
+extern WiFiClass WiFi;
@@ -0,0 +1,65 @@
+// ============================================================
+// Wire.h — host stand-in for the ESP32 TwoWire driver
+// ============================================================
+// Register-level devices (the MPU6050 FIFO and MAX30102 models)
+// attach to an address and see the same write/read transactions
+// the firmware issues. Every transaction costs bus time on the
+// virtual clock at the configured SCL rate, and an absent address
+// NACKs. Scripted faults (SimWorld::i2cFault, sdaStuck) make a
+// transaction NACK, stretch the clock until the timeout, or find
+// the bus held. Status codes are the ESP32 core's: 0 ok, 2 NACK,
+// 4 bus error, 5 timeout.
+// ============================================================
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define I2C_BUFFER_LENGTH 128
+
+// A device on the simulated bus. write() receives the bytes of one
+// write transaction (first byte = register); read() fills a read.
+class SimI2cDevice {
+public:
+  virtual ~SimI2cDevice() {}
+  virtual bool    present() = 0;
+  virtual void    write(const uint8_t* p, uint8_t n) = 0;
+  virtual void    read(uint8_t* out, uint8_t n) = 0;
+};
+
+class TwoWire {
+public:
+  explicit TwoWire(uint8_t bus) : bus_(bus) {}
+
+  bool begin(int sda = -1, int scl = -1, uint32_t freq = 0);
+  void setClock(uint32_t hz);
+  uint32_t getClock() const { return clockHz_; }
+  void     setTimeOut(uint16_t ms) { timeOutMs_ = ms; }
+  uint16_t getTimeOut() const { return timeOutMs_; }
+
+  void    beginTransmission(uint8_t addr);
+  size_t  write(uint8_t b);
+  size_t  write(const uint8_t* p, size_t n);
+  uint8_t endTransmission(bool stop = true);
+
+  uint8_t requestFrom(uint8_t addr, uint8_t n, bool stop = true);
+  uint8_t requestFrom(int addr, int n) { return requestFrom((uint8_t)addr, (uint8_t)n); }
+  int     available() const { return (int)(rxLen_ - rxPos_); }
+  int     read()            { return rxPos_ < rxLen_ ? rxBuf_[rxPos_++] : -1; }
+
+  void attach(uint8_t addr, SimI2cDevice* dev) { devs_[addr & 0x7F] = dev; }
+
+private:
+  uint8_t       bus_;
+  uint32_t      clockHz_ = 100000;
+  uint16_t      timeOutMs_ = 50;       // the ESP32 core's default
+  uint8_t       txAddr_  = 0;
+  uint8_t       txBuf_[I2C_BUFFER_LENGTH];
+  uint8_t       txLen_   = 0;
+  uint8_t       rxBuf_[I2C_BUFFER_LENGTH];
+  uint8_t       rxLen_   = 0, rxPos_ = 0;
+  SimI2cDevice* devs_[128] = {};
+};
+
+extern TwoWire Wire;
@@ -0,0 +1,45 @@
+// ============================================================
+// esp_partition.h — host stand-in for ESP-IDF flash partitions
+// ============================================================
+// Three data partitions in one flash image (host/flash_file.h):
+//   capture   subtype 0x40, 4 MB   (tiga_capture.h)
+//   history   subtype 0x41, 1 MB   (tiga_history.h)
+//   alerts    subtype 0x42, 8 KB   (tiga_alert_link.h)
+// NOR semantics: erase sets 0xFF in 4 KB sectors, writes can only
+// clear bits. Erase and program cost virtual time at typical
+// SPI-flash rates. The image is RAM unless --flash names a file,
+// which then carries its contents from one run to the next.
+// ============================================================
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include "esp_sleep.h"   // esp_err_t, ESP_OK
+
+#define ESP_ERR_INVALID_ARG   0x102
+#define ESP_ERR_INVALID_SIZE  0x104
+
+typedef enum {
+  ESP_PARTITION_TYPE_APP  = 0x00,
+  ESP_PARTITION_TYPE_DATA = 0x01,
+  ESP_PARTITION_TYPE_ANY  = 0xff
+} esp_partition_type_t;
+
+typedef int esp_partition_subtype_t;
+
+typedef struct {
+  esp_partition_type_t    type;
+  esp_partition_subtype_t subtype;
+  uint32_t                address;
+  uint32_t                size;
+  char                    label[17];
+  uint32_t                image;      // host: offset in the flash image
+} esp_partition_t;
+
+const esp_partition_t* esp_partition_find_first(esp_partition_type_t type,
+                                                esp_partition_subtype_t subtype,
+                                                const char* label);
+esp_err_t esp_partition_erase_range(const esp_partition_t* p, size_t off, size_t len);
+esp_err_t esp_partition_write(const esp_partition_t* p, size_t off, const void* src, size_t len);
+esp_err_t esp_partition_read(const esp_partition_t* p, size_t off, void* dst, size_t len);
@@ -0,0 +1,26 @@
+// ============================================================
+// esp_sleep.h — host stand-in for ESP-IDF deep sleep
+// ============================================================
+// Deep sleep ends the simulated run: esp_deep_sleep_start()
+// throws SimHalt, which the simulator reports and exits on.
+// ============================================================
+
+#pragma once
+
+#include "sim.h"
+
+typedef int esp_err_t;
+#define ESP_OK    0
+#define ESP_FAIL -1
+
+typedef enum {
+  GPIO_NUM_0 = 0, GPIO_NUM_1,  GPIO_NUM_2,  GPIO_NUM_3,  GPIO_NUM_4,
+  GPIO_NUM_5,  GPIO_NUM_6,  GPIO_NUM_7,  GPIO_NUM_8,  GPIO_NUM_9,
+  GPIO_NUM_10, GPIO_NUM_11, GPIO_NUM_12, GPIO_NUM_13, GPIO_NUM_14,
+  GPIO_NUM_15, GPIO_NUM_16, GPIO_NUM_17, GPIO_NUM_18, GPIO_NUM_19,
+  GPIO_NUM_20, GPIO_NUM_21, GPIO_NUM_38 = 38, GPIO_NUM_43 = 43,
+  GPIO_NUM_44 = 44, GPIO_NUM_MAX = 49
+} gpio_num_t;
+
+inline esp_err_t esp_sleep_enable_ext0_wakeup(gpio_num_t, int) { return ESP_OK; }
+inline void      esp_deep_sleep_start() { throw SimHalt{"deep sleep"}; }
@@ -0,0 +1,45 @@
+// ============================================================
+// heartRate.h — host stand-in for SparkFun's checkForBeat()
+// ============================================================
+// Same contract as the library: feed raw IR one sample at a time,
+// returns true once per beat on a rising zero crossing of the
+// DC-removed, low-passed signal, if the swing since the previous
+// crossing looks like a pulse (20 < p-p < 1000 counts).
+// Hysteresis at a quarter of the last swing keeps noise and the
+// dicrotic notch from counting twice.
+//
+// This is a simplified re-implementation, not SparkFun's FIR
+// code — close enough for scheduling and pipeline work, but
+// tune HR algorithms against real captures.
+// ============================================================
+
+#pragma once
+
+#include <stdint.h>
+
+inline bool checkForBeat(int32_t sample) {
+  static int32_t dc = 0;           // DC estimate, ×64
+  static int32_t lp = 0;           // low-passed AC
+  static int32_t acMax = 0, acMin = 0;
+  static int32_t hyst = 10;
+  static bool    armed = false, primed = false;
+
+  if (!primed) { dc = sample << 6; primed = true; }
+  dc += sample - (dc >> 6);
+  int32_t ac = sample - (dc >> 6);
+  lp = (lp * 3 + ac) / 4;
+
+  if (lp > acMax) acMax = lp;
+  if (lp < acMin) acMin = lp;
+  if (lp < -hyst) armed = true;
+
+  bool beat = false;
+  if (armed && lp >= 0) {
+    int32_t swing = acMax - acMin;
+    beat  = swing > 20 && swing < 1000;
+    hyst  = beat ? swing / 4 : 10;
+    armed = false;
+    acMax = acMin = 0;
+  }
+  return beat;
+}
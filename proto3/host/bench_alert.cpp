@@ -0,0 +1,412 @@
+// ============================================================
+// bench_alert.cpp — alert indications over a modelled BLE link
+// ============================================================
+// AlertLink on the watch, AlertReceiver on the phone, a RAM flash
+// partition and a loopback link on a virtual millisecond clock:
+//
+//   an indication goes out at the next connection event and the
+//   phone's confirmation comes back at the one after (ATT allows
+//   one outstanding). Nothing is lost while the link is up — the
+//   link layer retransmits — but a drop takes whatever is in
+//   flight either way, and after a reconnect the app takes a while
+//   to subscribe again. The watch also loses power now and then,
+//   in the middle of raising an alert.
+//
+// Alerts come at random, a few an hour with the odd burst. For
+// each link: raise-to-phone and raise-to-confirmation latency,
+// resends and duplicates the phone threw away, against the old
+// way — the falls byte of the once-a-second snapshot. Checks that
+// every alert reaches the phone exactly once, intact, across drops
+// and reboots. Then a power cut at every byte while a full sector
+// is left for a fresh one, to check no waiting alert is lost and
+// no id comes back.
+//
+//   make bench
+// ============================================================
+
+#include "tiga_alert_link.h"
+#include "flash_file.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <map>
+#include <vector>
+
+#define BENCH_PART_BYTES  (2 * HIST_SECTOR)
+#define BENCH_HOURS       8
+#define BENCH_TASK_MS     20             // firmware "bleAlert" task period
+#define BENCH_RAM_MAX     800
+
+// ── Flash ────────────────────────────────────────────────────
+static FlashFile flash;
+
+static bool fRead(uint32_t off, void* dst, uint32_t n)        { return flash.read(off, dst, n); }
+static bool fWrite(uint32_t off, const void* src, uint32_t n) { return flash.write(off, src, n); }
+static bool fErase(uint32_t off)                              { return flash.erase(off, HIST_SECTOR); }
+static const HistFlash benchFlash = { BENCH_PART_BYTES, fRead, fWrite, fErase };
+
+static uint32_t rng = 7;
+static uint32_t rnd() { rng ^= rng << 13; rng ^= rng >> 17; rng ^= rng << 5; return rng; }
+static uint32_t expo(uint32_t meanMs) {            // exponential, for arrivals and link times
+  double u = (rnd() % 1000000 + 0.5) / 1000000.0;
+  return (uint32_t)(-log(u) * meanMs);
+}
+
+// ── Loopback link ────────────────────────────────────────────
+struct LinkModel {
+  const char* name;
+  uint32_t intervalMs;     // connection interval
+  uint32_t subscribeMs;    // connect → app has indications on again
+  uint32_t upMeanS;        // mean time up / down; 0 = never drops
+  uint32_t downMeanS;
+  uint32_t rebootMeanS;    // mean time between power cuts; 0 = none
+  uint32_t dropPct;        // % of indications and confirmations the link goes down on
+};
+
+static const LinkModel* model;
+static uint32_t vnow;                 // virtual ms
+static bool     linkUp, subscribed;
+static uint32_t upAt;                 // when the link came up: connection events from here
+static bool     indPending, confPending;
+static uint8_t  indBuf[ALERT_EVENT_BYTES];
+static AlertLink* watch;
+
+static uint32_t benchMs() { return vnow; }
+
+static bool linkIndicate(const uint8_t* p, uint16_t n) {
+  if (!linkUp || !subscribed || indPending || confPending) return false;
+  memcpy(indBuf, p, n);
+  indPending = true;
+  return true;
+}
+
+// ── Phone ────────────────────────────────────────────────────
+struct Raised {
+  AlertEvent e;
+  uint32_t   raisedMs;
+  uint32_t   phoneMs = 0;      // first arrival
+  bool       got = false;
+  bool       interrupted = false;   // power went during raise()
+  bool       legacySeen = false;
+  uint32_t   legacyMs = 0;
+};
+
+static AlertReceiver*        phone;
+static std::map<uint32_t, Raised> raisedById;
+static uint32_t              phoneWrong, arrivals;
+
+static void phoneIndication() {
+  arrivals++;
+  AlertEvent e;
+  if (!phone->onIndication(indBuf, ALERT_EVENT_BYTES, e)) return;
+  auto it = raisedById.find(e.id);
+  if (it == raisedById.end() || !(it->second.e == e) || it->second.got) { phoneWrong++; return; }
+  it->second.got = true;
+  it->second.phoneMs = vnow;
+}
+
+// ── One run ──────────────────────────────────────────────────
+struct Result {
+  uint32_t raised, interrupted, delivered, missing, wrong, dupes, resent, timeouts, linkDrops, dropped;
+  uint32_t reboots, legacyLost, missingCritical;
+  std::vector<uint32_t> toPhone, toConfirm, legacy;
+};
+
+static AlertEvent makeEvent() {
+  static const uint8_t types[] = { ALERT_EV_FALL, ALERT_EV_SOS, ALERT_EV_HR_HIGH, ALERT_EV_HR_LOW, ALERT_EV_BATTERY };
+  AlertEvent e;
+  e.type     = types[rnd() % 5];
+  e.severity = e.type == ALERT_EV_BATTERY ? ALERT_SEV_INFO : e.type >= ALERT_EV_HR_HIGH ? ALERT_SEV_WARNING : ALERT_SEV_CRITICAL;
+  e.t        = 1776124800u + vnow / 1000;
+  e.lat7     = 515007000 + (int32_t)(rnd() % 20000);
+  e.lng7     = -1246000 - (int32_t)(rnd() % 20000);
+  e.fixAgeS  = rnd() % 8 == 0 ? ALERT_NO_FIX : (uint16_t)(rnd() % 120);
+  e.sats     = (uint8_t)(4 + rnd() % 8);
+  return e;
+}
+
+static Result runLink(const LinkModel& m) {
+  model = &m;
+  rng = 7;
+  vnow = 0;
+  linkUp = true; subscribed = true; upAt = 0;
+  indPending = confPending = false;
+  raisedById.clear();
+  phoneWrong = arrivals = 0;
+
+  flash.open(nullptr, BENCH_PART_BYTES);
+  AlertReceiver rx;
+  phone = &rx;
+  watch = new AlertLink({ linkIndicate }, benchMs);
+  watch->begin(benchFlash);
+  watch->onConnect();
+
+  Result r = {};
+  uint32_t end = BENCH_HOURS * 3600000u;
+  uint32_t nextAlert = expo(600000), nextTask = 0, nextLink = m.upMeanS ? expo(m.upMeanS * 1000) : UINT32_MAX;
+  uint32_t nextReboot = m.rebootMeanS ? expo(m.rebootMeanS * 1000) : UINT32_MAX;
+  uint32_t subscribeAt = 0, nextLegacy = 1000;
+  uint32_t legacyCount = 0, legacyPhone = 0;     // the falls byte: watch's and what the phone last saw
+  std::vector<uint32_t> legacyOrder;             // ids in counter order, for the legacy latency
+  uint32_t confirmedBefore = 0;
+  uint32_t totalResent = 0, totalTimeouts = 0, totalDrops = 0, totalDropped = 0;
+
+  for (vnow = 0; vnow < end; vnow++) {
+    // Link drops and comes back
+    if (vnow >= nextLink) {
+      if (linkUp) {
+        linkUp = subscribed = false;
+        indPending = confPending = false;        // in flight either way: gone
+        watch->onDisconnect();
+        nextLink = vnow + expo(m.downMeanS * 1000) + 1000;
+      } else {
+        linkUp = true;
+        upAt = vnow;
+        subscribeAt = vnow + m.subscribeMs;
+        watch->onConnect();
+        nextLink = vnow + expo(m.upMeanS * 1000) + 1000;
+      }
+    }
+    if (linkUp && !subscribed && vnow >= subscribeAt) subscribed = true;
+
+    // Power cut in the middle of raising an alert, then a reboot
+    // with the link back a few seconds later
+    if (vnow >= nextReboot) {
+      r.reboots++;
+      flash.cutAfter(rnd() % (ALERT_SLOT + 4));
+      AlertEvent e = makeEvent();
+      uint32_t id = watch->raise(e);
+      e.id = id;
+      raisedById[id] = { e, vnow, 0, false, true };
+      r.interrupted++;
+      flash.powerOn();
+      totalResent += watch->resent; totalTimeouts += watch->timeouts;
+      totalDrops += watch->linkDrops; totalDropped += watch->dropped;
+      delete watch;
+      watch = new AlertLink({ linkIndicate }, benchMs);
+      watch->begin(benchFlash);
+      confirmedBefore = 0;
+      legacyCount = legacyPhone = 0;             // RAM: the count restarts
+      for (uint32_t i : legacyOrder) if (!raisedById[i].legacySeen) r.legacyLost++;
+      legacyOrder.clear();
+      linkUp = subscribed = false;
+      indPending = confPending = false;
+      nextLink = vnow + 3000;
+      nextReboot = vnow + expo(m.rebootMeanS * 1000) + 60000;
+      continue;
+    }
+
+    // Alerts: a few an hour, one in five with another close behind
+    if (vnow >= nextAlert) {
+      AlertEvent e = makeEvent();
+      uint32_t id = watch->raise(e);
+      e.id = id;
+      raisedById[id] = { e, vnow };
+      legacyCount++;
+      legacyOrder.push_back(id);
+      nextAlert = vnow + (rnd() % 5 == 0 ? 200 + rnd() % 3000 : expo(900000));
+    }
+
+    if (vnow >= nextTask) {
+      watch->run();
+      if (watch->confirmed != confirmedBefore) {
+        confirmedBefore = watch->confirmed;
+        r.toConfirm.push_back(watch->latLastMs);
+      }
+      nextTask += BENCH_TASK_MS;
+    }
+
+    // Connection events: indication out, confirmation back. On a
+    // bad link the supervision timeout hits right there, before
+    // the packet (or after the indication, before its confirmation)
+    if (linkUp && (vnow - upAt) % m.intervalMs == 0 && (indPending || confPending) &&
+        rnd() % 100 < m.dropPct) {
+      if (indPending && rnd() % 2) phoneIndication();
+      linkUp = subscribed = false;
+      indPending = confPending = false;
+      watch->onDisconnect();
+      nextLink = vnow + 2000 + expo(3000);
+    }
+    if (linkUp && (vnow - upAt) % m.intervalMs == 0) {
+      if (confPending) {
+        confPending = false;
+        watch->onConfirm();
+      } else if (indPending) {
+        indPending = false;
+        phoneIndication();
+        confPending = true;
+      }
+    }
+
+    // The old way: the falls byte in the 1 Hz snapshot
+    if (vnow >= nextLegacy) {
+      nextLegacy += 1000;
+      if (linkUp && subscribed) {
+        while (legacyPhone < legacyCount) {
+          Raised& x = raisedById[legacyOrder[legacyPhone++]];
+          x.legacySeen = true;
+          x.legacyMs = vnow + m.intervalMs / 2 - x.raisedMs;
+        }
+      }
+    }
+  }
+
+  // Let it finish with the link up
+  if (!linkUp) { linkUp = true; upAt = vnow; watch->onConnect(); }
+  subscribed = true;
+  for (uint32_t k = 0; k < 600000 && watch->waiting(); k++, vnow++) {
+    if (vnow % BENCH_TASK_MS == 0) watch->run();
+    if ((vnow - upAt) % m.intervalMs == 0) {
+      if (confPending)      { confPending = false; watch->onConfirm(); }
+      else if (indPending)  { indPending = false; phoneIndication(); confPending = true; }
+    }
+  }
+
+  r.resent    = totalResent + watch->resent;
+  r.timeouts  = totalTimeouts + watch->timeouts;
+  r.linkDrops = totalDrops + watch->linkDrops;
+  r.dropped   = totalDropped + watch->dropped;
+  r.wrong     = phoneWrong;
+  r.dupes     = rx.dupes;
+  for (auto& kv : raisedById) {
+    const Raised& x = kv.second;
+    if (x.interrupted) { if (x.got) r.delivered++; continue; }
+    r.raised++;
+    if (!x.got) { r.missing++; r.missingCritical += x.e.severity == ALERT_SEV_CRITICAL; continue; }
+    r.delivered++;
+    r.toPhone.push_back(x.phoneMs - x.raisedMs);
+    if (x.legacySeen) r.legacy.push_back(x.legacyMs);
+  }
+  for (uint32_t i : legacyOrder) if (!raisedById[i].legacySeen) r.legacyLost++;
+  delete watch;
+  return r;
+}
+
+static uint32_t pct(std::vector<uint32_t> v, double p) {
+  if (v.empty()) return 0;
+  std::sort(v.begin(), v.end());
+  return v[(size_t)(p * (v.size() - 1))];
+}
+
+// ── Power cut while the head sector turns over ───────────────
+// A sector of alerts, the last five waiting: the next raise()
+// erases the other sector and copies the five across first. Cut at every unit of that, reboot, and check.
+static bool cutSweep(uint32_t* points, uint32_t* worst) {
+  bool ok = true;
+  *points = 0;
+  *worst = 0;
+  for (uint32_t cut = 0; ; cut++) {
+    flash.open(nullptr, BENCH_PART_BYTES);
+    vnow = 0;
+    linkUp = false;
+    AlertLink* w = new AlertLink({ linkIndicate }, benchMs);
+    w->begin(benchFlash);
+    uint32_t maxId = 0;
+    std::vector<uint32_t> waiting;
+    for (uint32_t i = 0; i < ALERT_SLOTS; i++) {
+      AlertEvent e = makeEvent();
+      uint32_t id = w->raise(e);
+      maxId = id;
+      if (i < ALERT_SLOTS - 5) {                   // confirmed straight away
+        w->onConnect();
+        linkUp = subscribed = true;
+        indPending = confPending = false;
+        w->run();
+        w->onConfirm();
+        vnow += BENCH_TASK_MS;
+        w->run();
+        linkUp = false;
+        w->onDisconnect();
+        w->run();
+      } else {
+        waiting.push_back(id);
+      }
+    }
+    uint64_t before = flash.bytesProgrammed + flash.sectorsErased;
+    flash.cutAfter(cut);
+    AlertEvent e = makeEvent();
+    w->raise(e);
+    bool finished = !flash.dead();
+    flash.powerOn();
+    uint64_t used = flash.bytesProgrammed + flash.sectorsErased - before;
+    delete w;
+
+    w = new AlertLink({ linkIndicate }, benchMs);
+    w->begin(benchFlash);
+    // Everything waiting before the cut is still waiting, in order
+    std::vector<uint32_t> back;
+    AlertLink* probe = w;
+    while (probe->waiting()) {
+      back.push_back(probe->oldest().id);
+      linkUp = subscribed = true;
+      indPending = confPending = false;
+      probe->onConnect();
+      probe->run();
+      probe->onConfirm();
+      vnow += BENCH_TASK_MS;
+      probe->run();
+      if (back.size() > ALERT_WAITING + 2) break;
+    }
+    for (size_t i = 0; i < waiting.size(); i++)
+      if (i >= back.size() || back[i] != waiting[i]) ok = false;
+    // and a new alert gets an id never used before
+    AlertEvent n = makeEvent();
+    if (w->raise(n) <= maxId) ok = false;
+    if ((uint32_t)back.size() > *worst) *worst = (uint32_t)back.size();
+    delete w;
+    (*points)++;
+    if (finished || cut > used + 4) break;
+  }
+  return ok;
+}
+
+int main() {
+  static const LinkModel links[] = {
+    //  name                          interval subscribe   up  down  reboot drop%
+    { "30 ms, steady",                     30,      0,      0,   0,      0,  0 },
+    { "10 ms, steady",                     10,      0,      0,   0,      0,  0 },
+    { "30 ms, drops ~2 min",               30,    400,    120,  20,      0,  0 },
+    { "50 ms, flaky (10 s up, 3 s down)",  50,    400,     10,   3,      0,  0 },
+    { "30 ms, drops mid-indication 40%",   30,    400,      0,   0,      0, 40 },
+    { "30 ms, out of range for hours",     30,    400,   1800, 5400,     0,  0 },
+    { "30 ms, drops and reboots",          30,    400,    120,  20,   3600, 10 },
+  };
+
+  printf("Alert indications, %d h per link, a few alerts an hour in bursts, task every %d ms\n",
+         BENCH_HOURS, BENCH_TASK_MS);
+  printf("  %-34s %6s %6s %6s %6s  %9s %9s %9s  %11s\n", "", "", "", "", "",
+         "to phone", "", "confirm", "falls byte");
+  printf("  %-34s %6s %6s %6s %6s  %9s %9s %9s  %5s %5s\n",
+         "link", "alerts", "gave up", "resent", "dupes", "p50 ms", "max ms", "p95 ms", "p50", "lost");
+  int fail = 0;
+  for (const LinkModel& m : links) {
+    Result r = runLink(m);
+    bool ok = r.missing == r.dropped && !r.missingCritical && !r.wrong;
+    if (!m.upMeanS && !m.rebootMeanS && !m.dropPct && pct(r.toConfirm, 0.95) > 2 * m.intervalMs + 2 * BENCH_TASK_MS) ok = false;
+    printf("  %-34s %6u %6u %6u %6u  %9u %9u %9u  %5u %5u%s\n",
+           m.name, r.raised, r.dropped, r.resent, r.dupes,
+           pct(r.toPhone, 0.5), pct(r.toPhone, 1.0), pct(r.toConfirm, 0.95),
+           pct(r.legacy, 0.5), r.legacyLost, ok ? "" : "  FAILED");
+    if (m.rebootMeanS)
+      printf("  %-34s %u reboots; of the alerts being raised as the power went, %u of %u arrived\n",
+             "", r.reboots, r.delivered - (r.raised - r.missing), r.interrupted);
+    fail |= !ok;
+  }
+  printf("  (gave up: more than %d waiting, the oldest of the least severe goes; falls\n"
+         "   byte: the old counter in the 1 Hz snapshot, no id, kind or place, and \"lost\"\n"
+         "   counts events it never showed: the count restarts at a reboot)\n",
+         ALERT_WAITING);
+
+  uint32_t points, worst;
+  bool cutOk = cutSweep(&points, &worst);
+  printf("  power cut at each of %u points while the head sector turns over: %s\n",
+         points, cutOk ? "every waiting alert kept, no id reused" : "ALERT LOST OR ID REUSED");
+  fail |= !cutOk;
+
+  printf("  RAM %zu bytes (AlertLink)\n", sizeof(AlertLink));
+  if (sizeof(AlertLink) > BENCH_RAM_MAX) fail = 1;
+  printf("  %s\n", fail ? "FAILED" : "all checks passed");
+  return fail;
+}
@@ -0,0 +1,214 @@
+// ============================================================
+// bench_alerts.cpp — alert pattern timing on a virtual clock
+// ============================================================
+// AlertSequencer drives a recording buzzer and motor from a
+// virtual millisecond clock. Each pattern's expected output is
+// worked out from its tables: the buzzer at step i's frequency
+// from the sum of the steps before it, the motor likewise, both
+// off at the end.
+//
+// Checks, for every pattern: ticked every millisecond, each
+// output call lands exactly on its step boundary with the step's
+// value, and nothing else is called; ticked late and unevenly
+// (the "alertSeq" task held up by the UI), every call reflects
+// the step due at that tick and the pattern still ends on its
+// table's total, so late ticks never stretch it; the same across
+// millis() wrapping. Then priorities: SOS cuts a goal chime off
+// at once and plays from that moment, a goal chime during an SOS
+// is refused and counted and leaves the outputs alone, an equal
+// priority restarts, and stop() silences both.
+//
+//   make bench
+// ============================================================
+
+#include "tiga_alerts.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+static uint32_t rng = 3;
+static uint32_t rnd() { rng ^= rng << 13; rng ^= rng >> 17; rng ^= rng << 5; return rng; }
+
+// ── Recording outputs ────────────────────────────────────────
+struct Call { uint32_t ms; uint16_t value; };
+static uint32_t          nowMs = 0;
+static std::vector<Call> buzCalls, motCalls;
+
+static void recTone(uint16_t hz) { buzCalls.push_back({ nowMs, hz }); }
+static void recMotor(bool on)    { motCalls.push_back({ nowMs, (uint16_t)on }); }
+
+static void clearCalls() { buzCalls.clear(); motCalls.clear(); }
+
+// ── Expected output ──────────────────────────────────────────
+// Value of a channel `t` ms into the pattern: the step it's in,
+// 0 once past the end
+static uint16_t levelAt(const AlertStep* s, uint8_t len, uint32_t t, bool motor) {
+  uint32_t at = 0;
+  for (uint8_t i = 0; i < len; i++) {
+    at += s[i].ms;
+    if (t < at) return motor ? (s[i].value != 0) : s[i].value;
+  }
+  return 0;
+}
+
+static uint32_t totalMs(const AlertStep* s, uint8_t len) {
+  uint32_t t = 0;
+  for (uint8_t i = 0; i < len; i++) t += s[i].ms;
+  return t;
+}
+
+// Calls on the step boundaries, from the table
+static std::vector<Call> boundaries(const AlertStep* s, uint8_t len, uint32_t startMs, bool motor) {
+  std::vector<Call> v;
+  if (!s || !len) return v;
+  uint32_t at = 0;
+  v.push_back({ startMs, motor ? (uint16_t)(s[0].value != 0) : s[0].value });
+  for (uint8_t i = 0; i < len; i++) {
+    at += s[i].ms;
+    v.push_back({ startMs + at, levelAt(s, len, at, motor) });
+  }
+  return v;
+}
+
+static int fail = 0;
+
+// Every-millisecond ticks: calls exactly on the boundaries
+static bool exact(const AlertPattern& p, uint32_t startMs) {
+  AlertSequencer seq({ recTone, recMotor });
+  clearCalls();
+  nowMs = startMs;
+  seq.play(p, nowMs);
+  uint32_t end = startMs + 5000;
+  while (seq.busy() && nowMs != end) { nowMs++; seq.update(nowMs); }
+  std::vector<Call> wantB = boundaries(p.buzzer, p.buzzerLen, startMs, false);
+  std::vector<Call> wantM = boundaries(p.motor, p.motorLen, startMs, true);
+  // A channel with no steps is set silent once, at the start
+  if (wantB.empty()) wantB.push_back({ startMs, 0 });
+  if (wantM.empty()) wantM.push_back({ startMs, 0 });
+  auto same = [](const std::vector<Call>& a, const std::vector<Call>& b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); i++)
+      if (a[i].ms != b[i].ms || a[i].value != b[i].value) return false;
+    return true;
+  };
+  return same(buzCalls, wantB) && same(motCalls, wantM) && !seq.busy();
+}
+
+// Late, uneven ticks: each call shows the step due at its tick,
+// and the pattern ends on its table's total. Returns the latest
+// end past that total.
+static bool late(const AlertPattern& p, uint32_t startMs, uint32_t maxGapMs, uint32_t* worstEndLate) {
+  AlertSequencer seq({ recTone, recMotor });
+  clearCalls();
+  nowMs = startMs;
+  seq.play(p, nowMs);
+  uint32_t lastTick = nowMs;
+  while (seq.busy()) {
+    nowMs += 1 + rnd() % maxGapMs;
+    lastTick = nowMs;
+    seq.update(nowMs);
+  }
+  bool ok = true;
+  for (const Call& c : buzCalls) ok &= c.value == levelAt(p.buzzer, p.buzzerLen, c.ms - startMs, false);
+  for (const Call& c : motCalls) ok &= c.value == levelAt(p.motor, p.motorLen, c.ms - startMs, true);
+  // Finished at the first tick at or after the longer channel's end
+  uint32_t total = std::max(totalMs(p.buzzer, p.buzzerLen), totalMs(p.motor, p.motorLen));
+  uint32_t endLate = lastTick - startMs - total;
+  ok &= (int32_t)endLate >= 0 && endLate < maxGapMs;
+  if (endLate > *worstEndLate) *worstEndLate = endLate;
+  return ok;
+}
+
+static void report(const char* name, bool ok, const char* detail) {
+  printf("  %-40s %-36s %s\n", name, detail, ok ? "ok" : "FAIL");
+  fail |= !ok;
+}
+
+int main() {
+  const AlertPattern* pats[] = {
+    &ALERT_LOW, &ALERT_MEDIUM, &ALERT_HIGH, &ALERT_GOAL, &ALERT_SOS, &ALERT_LOWBAT, &ALERT_FALL
+  };
+
+  printf("Alert patterns on a virtual clock\n");
+  printf("  pattern   length  buzzer  motor   every ms  late ticks (≤25 ms)  across wrap\n");
+  for (const AlertPattern* p : pats) {
+    bool ex = exact(*p, 1000);
+    uint32_t worst = 0;
+    bool lt = true;
+    for (int run = 0; run < 200; run++) lt &= late(*p, 1000 + rnd() % 1000, 25, &worst);
+    bool wr = exact(*p, 0xFFFFFFFFu - 200) && late(*p, 0xFFFFFFFFu - 300, 25, &worst);
+    uint32_t total = std::max(totalMs(p->buzzer, p->buzzerLen), totalMs(p->motor, p->motorLen));
+    printf("  %-8s %5u ms %6u %6u   %-8s  %-20s %s\n", p->name, total, p->buzzerLen, p->motorLen,
+           ex ? "exact" : "FAIL", lt ? "ends on time" : "FAIL", wr ? "ok" : "FAIL");
+    fail |= !(ex && lt && wr);
+  }
+
+  // SOS over a goal chime: at once, and timed from then
+  {
+    AlertSequencer seq({ recTone, recMotor });
+    clearCalls();
+    nowMs = 5000;
+    seq.play(ALERT_GOAL, nowMs);
+    for (; nowMs < 5150; nowMs++) seq.update(nowMs);
+    clearCalls();
+    bool took = seq.play(ALERT_SOS, nowMs);
+    uint32_t sosAt = nowMs;
+    bool now = buzCalls.size() == 1 && buzCalls[0].value == BUZ_SOS[0].value &&
+               motCalls.size() == 1 && motCalls[0].value == 1;
+    while (seq.busy()) { nowMs++; seq.update(nowMs); }
+    bool fromThen = buzCalls.back().ms == sosAt + totalMs(BUZ_SOS, ALERT_LEN(BUZ_SOS)) &&
+                    motCalls[1].ms == sosAt + MOT_LONG[0].ms;
+    bool ok = took && now && fromThen && seq.preempted == 1 && seq.rejected == 0;
+    char d[64];
+    snprintf(d, sizeof(d), "%u preempted, ends %u ms after", seq.preempted, buzCalls.back().ms - sosAt);
+    report("SOS cuts a goal chime off", ok, d);
+  }
+
+  // Goal chime during an SOS: refused, outputs untouched
+  {
+    AlertSequencer seq({ recTone, recMotor });
+    nowMs = 9000;
+    seq.play(ALERT_SOS, nowMs);
+    for (; nowMs < 9050; nowMs++) seq.update(nowMs);
+    clearCalls();
+    bool took = seq.play(ALERT_GOAL, nowMs);
+    bool lowTook = seq.play(ALERT_LOW, nowMs);
+    bool ok = !took && !lowTook && buzCalls.empty() && motCalls.empty() &&
+              seq.rejected == 2 && seq.current() == &ALERT_SOS;
+    while (seq.busy()) { nowMs++; seq.update(nowMs); }
+    ok &= buzCalls.back().ms == 9000 + totalMs(BUZ_SOS, ALERT_LEN(BUZ_SOS));
+    char d[64];
+    snprintf(d, sizeof(d), "%u rejected, SOS unchanged", seq.rejected);
+    report("lower priority refused", ok, d);
+  }
+
+  // Equal priority restarts; stop() silences
+  {
+    AlertSequencer seq({ recTone, recMotor });
+    nowMs = 20000;
+    seq.play(ALERT_MEDIUM, nowMs);
+    for (; nowMs < 20300; nowMs++) seq.update(nowMs);
+    bool took = seq.play(ALERT_LOWBAT, nowMs);
+    uint32_t at = nowMs;
+    clearCalls();
+    while (seq.busy()) { nowMs++; seq.update(nowMs); }
+    bool ok = took && seq.preempted == 1 &&
+              buzCalls.back().ms == at + totalMs(BUZ_LOWBAT, ALERT_LEN(BUZ_LOWBAT));
+    seq.play(ALERT_HIGH, nowMs);
+    nowMs += 100;
+    seq.update(nowMs);
+    clearCalls();
+    seq.stop();
+    ok &= !seq.busy() && buzCalls.size() == 1 && buzCalls[0].value == 0 &&
+          motCalls.size() == 1 && motCalls[0].value == 0;
+    nowMs += 1000;
+    seq.update(nowMs);
+    ok &= buzCalls.size() == 1 && motCalls.size() == 1;
+    report("equal priority restarts; stop() silences", ok, "");
+  }
+
+  printf("  RAM %zu bytes (AlertSequencer)\n", sizeof(AlertSequencer));
+  printf("  %s\n", fail ? "FAILED" : "all checks passed");
+  return fail;
+}
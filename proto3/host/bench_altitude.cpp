@@ -0,0 +1,258 @@
+// ============================================================
+// bench_altitude.cpp — altitude engine against known climbs
+// ============================================================
+// A wearer's day in phases (walking, standing, stairs, hills,
+// lifts), with the true altitude and the stairs known. It becomes
+// what the firmware gets: BMP280 pressure at 10 Hz through the
+// barometric formula and noise (its IIR filter off), with
+// weather drift and door / ventilation pulses on top; the fused
+// vertical acceleration at 200 Hz with walking bounce, noise and
+// an offset; a step() at the cadence. That goes through
+// tiga_altitude.h as the sketch feeds it, and through v6a's
+// readBMP280() logic (powf altitude, a floor per 3 m up) for
+// comparison.
+//
+//   stairs    3 floors up at 0.15 m/s with landings, 3 down
+//   slow      2 floors up at 0.07 m/s with a rest on each
+//             landing, 2 down
+//   lift      12 m up and down standing still, walks between
+//   weather   40 min walking on the level, pressure falling
+//             250 Pa/h (a storm: +21 m/h on the barometer)
+//   drift     resting in a rising 200 Pa/h, then 2 floors at
+//             0.08 m/s, then resting
+//   hill      6 m up a 10% slope at 1.2 m/s, walking back down
+//   ramp      6 m over 10 min of walking: 1%, level for floors
+//   doors     walking the level with a ±40 Pa pulse every minute
+//   noisy     stairs, 3 Pa of noise and the arm raised and
+//             lowered 30 cm at random
+//
+// Checks: floors up and down exactly right in every case;
+// climbed altitude within 1 m of the truth throughout (the ramp
+// is climbed but too gently to be stairs, so isn't checked);
+// pressure table within 12 cm of the formula below 1000 m.
+//
+//   make bench
+// ============================================================
+
+#include "tiga_altitude.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <vector>
+
+#define BENCH_IMU_HZ    200
+#define BENCH_BARO_MS   100
+#define BENCH_FLOOR_M   3.0
+
+static const double PI = 3.14159265358979;
+
+static uint64_t nowNs() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static double gauss() {
+  double u = (rand() + 1.0) / ((double)RAND_MAX + 2), v = rand() / ((double)RAND_MAX + 1);
+  return sqrt(-2 * log(u)) * cos(2 * PI * v);
+}
+
+static double pressureAt(double altM) {
+  return 101325.0 * pow(1.0 - 2.25577e-5 * altM, 5.25588);
+}
+
+// ── Traces ───────────────────────────────────────────────────
+struct Phase {
+  double secs;
+  double spm;                     // cadence, 0 = standing
+  double vMps;                    // body vertical speed
+  bool   climbed;                 // on foot: counts toward the truth
+};
+
+struct Case {
+  const char* name;
+  std::vector<Phase> phases;
+  double driftPaH;
+  double noisePa;
+  bool   doors;                   // ±40 Pa for 2 s every minute
+  bool   armRaise;                // wrist up 30 cm now and then
+  int    up, down;                // floors to find
+  bool   checkAlt;
+};
+
+struct Result {
+  int    up = 0, down = 0;
+  int    oldUp = 0;
+  double altErr = 0;              // worst |climbed - truth|, m
+  double truthAlt = 0;
+  double baroAlt = 0;             // what the old code showed at the end
+  uint64_t pressNs = 0, accelNs = 0;
+  uint32_t pressCalls = 0, accelCalls = 0;
+};
+
+static Result run(const Case& c) {
+  AltitudeEngine alt;
+  Result r;
+  double t = 0, h = 0, v = 0, truthClimb = 0;
+  double oldBase = 0, oldLast = 0;
+  bool   oldSet = false;
+  double stepPhase = 0, armH = 0, armV = 0, armTarget = 0, armNext = 20;
+  uint32_t baroNext = 0;
+  const double dt = 1.0 / BENCH_IMU_HZ;
+  const double bias = 0.012 * 9.80665;    // fusion's vertical offset
+
+  for (const Phase& ph : c.phases) {
+    double end = t + ph.secs;
+    double tau = ph.spm > 0 ? 0.4 : 1.0;  // a lift eases in
+    for (; t < end; t += dt) {
+      uint32_t tMs = (uint32_t)lround(t * 1000);
+      double vOld = v;
+      v += (ph.vMps - v) * dt / tau;
+      h += v * dt;
+      if (ph.climbed) truthClimb += v * dt;
+      double a = (v - vOld) / dt;
+
+      // Walking bounce, ±3 cm at the cadence
+      double bounce = 0;
+      if (ph.spm > 0) {
+        double f = ph.spm / 60;
+        double before = stepPhase;
+        stepPhase += f * dt;
+        bounce = -0.30 * 9.80665 * sin(2 * PI * stepPhase);
+        if (floor(stepPhase) != floor(before)) alt.step(tMs);
+      }
+      // The wrist lifted and lowered at random, as to a rail
+      if (c.armRaise) {
+        if (t >= armNext) { armTarget = armTarget ? 0 : 0.3; armNext = t + 5 + 20.0 * rand() / RAND_MAX; }
+        double av = (armTarget - armH) / 0.5;
+        a += (av - armV) / dt;
+        armV = av;
+        armH += av * dt;
+      }
+
+      double acc = a + bounce + bias + 0.02 * 9.80665 * gauss();
+      int16_t vert = (int16_t)lrint(acc / 9.80665 * MOTION_LSB_PER_G);
+      uint64_t n0 = nowNs();
+      alt.accel(vert);
+      r.accelNs += nowNs() - n0;
+      r.accelCalls++;
+
+      if (tMs < baroNext) continue;
+      baroNext = tMs + BENCH_BARO_MS;
+      double p = pressureAt(h + armH) - c.driftPaH * t / 3600 + c.noisePa * gauss();
+      if (c.doors && fmod(t, 60) >= 30 && fmod(t, 60) < 32) p += (fmod(t, 120) < 60 ? 40 : -40);
+
+      n0 = nowNs();
+      int8_t fl = alt.pressure((float)p, tMs);
+      r.pressNs += nowNs() - n0;
+      r.pressCalls++;
+      if (fl > 0) r.up++;
+      if (fl < 0) r.down++;
+      r.altErr = fmax(r.altErr, fabs(alt.altitudeM() - truthClimb));
+
+      // v6a: powf altitude, a floor per 3 m above the last one
+      double old = 44330.0 * (1.0 - pow(p / 101325.0, 0.1903));
+      if (!oldSet) { oldBase = oldLast = old; oldSet = true; }
+      if (old - oldLast >= BENCH_FLOOR_M) { r.oldUp++; oldLast = old; }
+      r.baroAlt = old - oldBase;
+    }
+  }
+  r.truthAlt = truthClimb;
+  return r;
+}
+
+static std::vector<Phase> stairs(int floors, double v, double spm, double landingS, double landingSpm) {
+  std::vector<Phase> p;
+  for (int i = 0; i < floors; i++) {
+    p.push_back({ BENCH_FLOOR_M / fabs(v), spm, v, true });
+    p.push_back({ landingS, landingSpm, 0, true });
+  }
+  return p;
+}
+
+static std::vector<Phase> cat(std::initializer_list<std::vector<Phase>> parts) {
+  std::vector<Phase> all;
+  for (const auto& p : parts) all.insert(all.end(), p.begin(), p.end());
+  return all;
+}
+
+int main() {
+  const std::vector<Phase> walk30  = { { 30, 100, 0, true } };
+  const std::vector<Phase> stand30 = { { 30, 0, 0, true } };
+  const std::vector<Phase> ride30  = { { 30, 0, 0, false } };   // in the lift, stopping
+  const Case cases[] = {
+    { "stairs",  cat({ walk30, stairs(3, 0.15, 100, 5, 100), walk30, stairs(3, -0.20, 110, 5, 100), stand30 }),
+      0, 1, false, false, 3, 3, true },
+    { "slow",    cat({ walk30, stairs(2, 0.07, 60, 15, 0), walk30, stairs(2, -0.08, 60, 15, 0), stand30 }),
+      0, 1, false, false, 2, 2, true },
+    { "lift",    cat({ stand30, { { 8, 0, 1.5, false } }, ride30, { { 60, 100, 0, true } },
+                       { { 8, 0, -1.5, false } }, ride30 }),
+      0, 1, false, false, 0, 0, true },
+    { "weather", { { 2400, 100, 0, true } }, -250, 1, false, false, 0, 0, true },
+    { "drift",   cat({ { { 600, 0, 0, true } }, stairs(2, 0.08, 70, 5, 70), { { 600, 0, 0, true } } }),
+      200, 1, false, false, 2, 0, true },
+    { "hill",    cat({ walk30, { { 50, 110, 0.12, true } }, walk30, { { 50, 110, -0.12, true } }, stand30 }),
+      0, 1, false, false, 2, 2, true },
+    { "ramp",    cat({ walk30, { { 600, 100, 0.01, true } }, stand30 }),
+      0, 1, false, false, 0, 0, false },
+    { "doors",   { { 600, 100, 0, true } }, 0, 1, true, false, 0, 0, true },
+    { "noisy",   cat({ walk30, stairs(3, 0.15, 100, 5, 100), walk30, stairs(3, -0.20, 110, 5, 100), stand30 }),
+      0, 3, false, true, 3, 3, true },
+  };
+  int fail = 0;
+  srand(17);
+
+  printf("Altitude engine (tiga_altitude.h): synthetic traces, baro %d Hz, IMU %d Hz\n",
+         1000 / BENCH_BARO_MS, BENCH_IMU_HZ);
+  printf("  %-8s %8s %8s %7s %10s %9s %11s\n", "", "floors", "found", "v6a", "climbed", "alt err",
+         "v6a alt");
+  uint64_t pressNs = 0, accelNs = 0;
+  uint32_t pressCalls = 0, accelCalls = 0;
+  for (const Case& c : cases) {
+    Result r = run(c);
+    bool bad = r.up != c.up || r.down != c.down || (c.checkAlt && r.altErr > 1.0);
+    printf("  %-8s %4d/%-3d %4d/%-3d %4d up %8.1f m %7.2f m %9.1f m%s\n",
+           c.name, c.up, c.down, r.up, r.down, r.oldUp, fabs(r.truthAlt) < 0.05 ? 0.0 : r.truthAlt,
+           c.checkAlt ? r.altErr : NAN, r.baroAlt, bad ? "  <- FAIL" : "");
+    if (bad) fail = 1;
+    pressNs += r.pressNs; pressCalls += r.pressCalls;
+    accelNs += r.accelNs; accelCalls += r.accelCalls;
+  }
+  printf("  floors are up/down, climbed is the truth on foot; v6a counted up only, from its altitude\n");
+
+  // ── Pressure table against the formula ─────────────────────
+  AltitudeEngine alt;
+  double worst = 0, worstLow = 0, worstSlope = 0;
+  for (double p = 30000; p <= 110000; p += 7.3) {
+    double f = 44330.0 * (1.0 - pow(p / 101325.0, 0.1903));
+    double e = fabs(alt.baroMm((int32_t)lround(p * 16)) / 1000.0 - f);
+    worst = fmax(worst, e);
+    if (f < 1000) worstLow = fmax(worstLow, e);
+    if (p >= 90000 && p + 36 <= 110000) {   // 3 m near sea level, either side of an entry
+      double f2 = 44330.0 * (1.0 - pow((p + 36) / 101325.0, 0.1903));
+      double d = (alt.baroMm((int32_t)lround(p * 16)) - alt.baroMm((int32_t)lround((p + 36) * 16))) / 1000.0;
+      worstSlope = fmax(worstSlope, fabs(d / (f - f2) - 1));
+    }
+  }
+  if (worstLow > 0.12) fail = 1;
+  printf("\n  table vs formula: %.3f m worst below 1000 m, %.2f m to 30 kPa; "
+         "slope within %.2f%% near sea level\n", worstLow, worst, worstSlope * 100);
+
+  // ── Cost ───────────────────────────────────────────────────
+  volatile float sink = 0;
+  const int N = 1000000;
+  uint64_t t0 = nowNs();
+  for (int i = 0; i < N; i++) sink = sink + 44330.0f * (1.0f - powf((100000.0f + (i & 1023)) / 101325.0f, 0.1903f));
+  double powNs = (double)(nowNs() - t0) / N;
+  t0 = nowNs();
+  for (int i = 0; i < N; i++) sink = sink + (float)alt.baroMm((100000 + (i & 1023)) * 16);
+  double tabNs = (double)(nowNs() - t0) / N;
+  printf("  per reading: pressure() %.0f ns (Kalman, stairs, drift), conversion %.1f ns vs powf %.1f ns\n",
+         (double)pressNs / pressCalls, tabNs, powNs);
+  printf("  per IMU sample: accel() %.1f ns (timer included); state %u bytes, no heap\n",
+         (double)accelNs / accelCalls, (unsigned)sizeof(AltitudeEngine));
+  printf("  %s\n", fail ? "FAILED" : "all checks passed");
+  return fail;
+}
@@ -0,0 +1,320 @@
+// ============================================================
+// bench_buttons.cpp — button debouncing and events on bouncing contacts
+// ============================================================
+// A random hour of someone using the two buttons — taps, taps
+// shorter than the lockout, 3 s holds, both together — drawn as
+// the waveform each pin actually shows: every change followed by
+// a burst of contact chatter. Every edge goes to ButtonInput::isr()
+// at its microsecond; the input task runs every BENCH_TASK_MS,
+// calling settle() and taking events from next(), except while
+// something else holds core 1 (a full redraw, an alert pattern, a
+// flash erase), modelled as stalls.
+//
+// Checks, per contact type and stall pattern: every gesture comes
+// out as exactly its events (press, release with tap, long,
+// chord), presses stamped at their first edge and releases within
+// the chatter, nothing dropped from the ring, and press-to-handled
+// no worse than the longest stall plus a task period and the
+// lockout. Against it, the old readButtons(): both pins read
+// each time the task ran — taps it never saw and bounces it took
+// for a second tap. Then ns per ISR call and per event.
+//
+//   make bench
+// ============================================================
+
+#include "tiga_buttons.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <algorithm>
+#include <vector>
+
+#define BENCH_MINUTES     60
+#define BENCH_TASK_MS     10           // firmware "input" task period
+#define BENCH_RAM_MAX     400
+
+static uint32_t rng = 11;
+static uint32_t rnd() { rng ^= rng << 13; rng ^= rng >> 17; rng ^= rng << 5; return rng; }
+static uint32_t between(uint32_t lo, uint32_t hi) { return lo + rnd() % (hi - lo + 1); }
+
+static uint64_t nowNs() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+// ── Waveforms ────────────────────────────────────────────────
+struct Contact {
+  const char* name;
+  uint32_t    bounceUs;      // chatter lasts up to this after each change
+  uint8_t     bursts;        // up to this many open/close pairs in it
+};
+
+struct Edge { uint32_t us; uint8_t button; bool down; };
+
+struct Expect {
+  ButtonEventType type;
+  uint8_t         button;
+  bool            tap;
+  uint32_t        us;        // the change itself
+  uint32_t        slackUs;   // how late the stamp may be: a release
+                             // the lockout hid is timed at its last edge
+};
+
+struct Press { uint8_t button; uint32_t downUs, upUs; };
+
+struct Script {
+  std::vector<Edge>   edges;
+  std::vector<Expect> expect;
+  std::vector<Press>  presses;
+  uint32_t taps = 0, shortTaps = 0, longs = 0, chords = 0;
+};
+
+// A change on button b at t, then chatter that ends at the new
+// level before `untilUs`. Returns the last edge's time.
+static uint32_t change(Script& s, const Contact& c, uint8_t b, bool down, uint32_t t, uint32_t untilUs) {
+  s.edges.push_back({ t, b, down });
+  uint32_t end = std::min(t + c.bounceUs, untilUs), last = t;
+  uint8_t  n   = c.bursts ? (uint8_t)(rnd() % (c.bursts + 1)) : 0;
+  for (uint8_t i = 0; i < n; i++) {
+    uint32_t a = last + between(30, 1500), z = a + between(30, 1500);
+    if (z >= end) break;
+    s.edges.push_back({ a, b, !down });
+    s.edges.push_back({ z, b, down });
+    last = z;
+  }
+  return last;
+}
+
+static Script makeScript(const Contact& c) {
+  Script s;
+  uint32_t t = 500000, endUs = (uint32_t)BENCH_MINUTES * 60000000u;
+  while (t < endUs) {
+    uint32_t kind = rnd() % 100;
+    uint8_t  b    = rnd() & 1;
+    if (kind < 60) {                                   // tap
+      uint32_t hold = between(60000, 400000);
+      change(s, c, b, true, t, t + hold);
+      change(s, c, b, false, t + hold, t + hold + 100000);
+      s.expect.push_back({ BTN_PRESS, b, false, t, 0 });
+      s.expect.push_back({ BTN_RELEASE, b, true, t + hold, 0 });
+      s.presses.push_back({ b, t, t + hold });
+      s.taps++;
+      t += hold;
+    } else if (kind < 70) {                            // quicker than the lockout
+      uint32_t hold = between(BTN_LOCKOUT_US / 2, BTN_LOCKOUT_US - 2000);
+      change(s, c, b, true, t, t + hold - 1000);
+      uint32_t last = change(s, c, b, false, t + hold, t + hold + 100000);
+      s.expect.push_back({ BTN_PRESS, b, false, t, 0 });
+      s.expect.push_back({ BTN_RELEASE, b, true, t + hold, last - (t + hold) });
+      s.presses.push_back({ b, t, t + hold });
+      s.shortTaps++;
+      t += hold;
+    } else if (kind < 85) {                            // held long
+      uint32_t hold = between(BTN_LONG_US + 200000, BTN_LONG_US + 2000000);
+      change(s, c, b, true, t, t + hold);
+      change(s, c, b, false, t + hold, t + hold + 100000);
+      s.expect.push_back({ BTN_PRESS, b, false, t, 0 });
+      s.expect.push_back({ BTN_LONG, b, false, t + BTN_LONG_US, 0 });
+      s.expect.push_back({ BTN_RELEASE, b, false, t + hold, 0 });
+      s.presses.push_back({ b, t, t + hold });
+      s.longs++;
+      t += hold;
+    } else {                                           // both together
+      uint8_t  o   = (uint8_t)(b ^ 1);
+      uint32_t t2  = t + between(25000, 200000);
+      uint32_t r1  = t2 + between(100000, 800000), r2 = r1 + between(25000, 200000);
+      bool     oFirst = rnd() & 1;
+      change(s, c, b, true, t, t2);
+      change(s, c, o, true, t2, r1);
+      change(s, c, oFirst ? o : b, false, r1, r2);
+      change(s, c, oFirst ? b : o, false, r2, r2 + 100000);
+      s.expect.push_back({ BTN_PRESS, b, false, t, 0 });
+      s.expect.push_back({ BTN_CHORD, o, false, t2, 0 });
+      s.expect.push_back({ BTN_RELEASE, oFirst ? o : b, false, r1, 0 });
+      s.expect.push_back({ BTN_RELEASE, oFirst ? b : o, false, r2, 0 });
+      s.presses.push_back({ b, t, oFirst ? r2 : r1 });
+      s.presses.push_back({ o, t2, oFirst ? r1 : r2 });
+      s.chords++;
+      t = r2;
+    }
+    t += between(150000, 1500000);
+  }
+  std::stable_sort(s.edges.begin(), s.edges.end(),
+                   [](const Edge& a, const Edge& b) { return a.us < b.us; });
+  return s;
+}
+
+// ── Core 1 ───────────────────────────────────────────────────
+struct Stalls {
+  const char* name;
+  uint32_t    everyMs;       // mean gap between stalls, 0 = none
+  uint32_t    maxMs;         // each up to this long
+};
+
+// Times the input task runs
+static std::vector<uint32_t> taskTimes(const Stalls& st, uint32_t endUs) {
+  std::vector<uint32_t> v;
+  uint32_t t = 0, nextStall = st.everyMs ? between(st.everyMs / 2, st.everyMs * 3 / 2) * 1000 : UINT32_MAX;
+  while (t < endUs) {
+    v.push_back(t);
+    t += BENCH_TASK_MS * 1000;
+    if (t >= nextStall) {
+      t += between(st.maxMs / 4, st.maxMs) * 1000;
+      nextStall = t + between(st.everyMs / 2, st.everyMs * 3 / 2) * 1000;
+    }
+  }
+  return v;
+}
+
+struct Result {
+  uint32_t events = 0, wrong = 0, missing = 0, extra = 0;
+  uint32_t dropped = 0, resyncs = 0, bounces = 0, edges = 0;
+  uint32_t stampMaxUs = 0;
+  std::vector<uint32_t> lat;
+  uint32_t oldMissed = 0, oldDoubled = 0;
+};
+
+static uint32_t pct(std::vector<uint32_t> v, double p) {
+  if (v.empty()) return 0;
+  std::sort(v.begin(), v.end());
+  return v[std::min(v.size() - 1, (size_t)(p * (v.size() - 1) + 0.5))];
+}
+
+static Result run(const Script& s, const Stalls& st) {
+  Result r;
+  ButtonInput in;
+  std::vector<ButtonEvent> got;
+  uint32_t endUs = s.edges.back().us + BTN_LONG_US + 1000000;
+  std::vector<uint32_t> tasks = taskTimes(st, endUs);
+
+  size_t ei = 0;
+  for (uint32_t now : tasks) {
+    for (; ei < s.edges.size() && s.edges[ei].us <= now; ei++)
+      in.isr(s.edges[ei].button, s.edges[ei].down, s.edges[ei].us);
+    in.settle(now);
+    ButtonEvent e;
+    while (in.next(now, &e)) { got.push_back(e); r.lat.push_back(now - e.us); }
+  }
+  r.events  = (uint32_t)got.size();
+  r.dropped = in.dropped();
+  r.resyncs = in.resyncs;
+  r.bounces = in.bounces;
+  r.edges   = in.edges;
+
+  // Events per button in order; the two buttons interleave freely
+  for (uint8_t b = 0; b < BTN_COUNT; b++) {
+    std::vector<const Expect*> want;
+    std::vector<const ButtonEvent*> have;
+    for (const Expect& x : s.expect) if (x.button == b) want.push_back(&x);
+    for (const ButtonEvent& e : got) if (e.button == b) have.push_back(&e);
+    size_t n = std::min(want.size(), have.size());
+    for (size_t i = 0; i < n; i++) {
+      const Expect& x = *want[i];
+      const ButtonEvent& e = *have[i];
+      int32_t off = (int32_t)(e.us - x.us);
+      if (e.type != x.type || (e.type == BTN_RELEASE && e.tap != x.tap) ||
+          off < 0 || (uint32_t)off > x.slackUs) {
+        r.wrong++;
+        continue;
+      }
+      r.stampMaxUs = std::max(r.stampMaxUs, (uint32_t)off);
+    }
+    if (want.size() > n) r.missing += (uint32_t)(want.size() - n);
+    if (have.size() > n) r.extra   += (uint32_t)(have.size() - n);
+  }
+
+  // The old way: both pins read each time the task ran. A press
+  // no read landed in is missed; a down read after an up one that
+  // isn't the first in its press is chatter taken for another.
+  std::vector<uint32_t> down[BTN_COUNT];
+  bool lv[BTN_COUNT] = {}, was[BTN_COUNT] = {};
+  size_t ci = 0;
+  for (uint32_t now : tasks) {
+    for (; ci < s.edges.size() && s.edges[ci].us <= now; ci++) lv[s.edges[ci].button] = s.edges[ci].down;
+    for (uint8_t b = 0; b < BTN_COUNT; b++) {
+      if (lv[b] && !was[b]) down[b].push_back(now);
+      was[b] = lv[b];
+    }
+  }
+  for (const Press& p : s.presses) {
+    const std::vector<uint32_t>& d = down[p.button];
+    auto lo = std::lower_bound(d.begin(), d.end(), p.downUs);
+    auto hi = std::lower_bound(d.begin(), d.end(), p.upUs + 1);
+    if (lo == hi) r.oldMissed++;
+    else          r.oldDoubled += (uint32_t)(hi - lo - 1);
+  }
+  return r;
+}
+
+// ── CPU ──────────────────────────────────────────────────────
+static void cpu(double* isrNs, double* eventNs) {
+  Script s = makeScript({ "", 5000, 6 });
+  ButtonInput in;
+  uint64_t t0 = nowNs();
+  for (const Edge& e : s.edges) in.isr(e.button, e.down, e.us);
+  uint64_t t1 = nowNs();
+  *isrNs = (double)(t1 - t0) / s.edges.size();
+
+  // Events alone: the ring refilled between batches
+  ButtonInput in2;
+  uint32_t n = 0, us = 0;
+  uint64_t spent = 0;
+  for (int k = 0; k < 20000; k++) {
+    for (int i = 0; i < 8; i++) { us += BTN_LOCKOUT_US; in2.isr(0, !(i & 1), us); }
+    ButtonEvent e;
+    uint64_t a = nowNs();
+    while (in2.next(us, &e)) n++;
+    spent += nowNs() - a;
+  }
+  *eventNs = (double)spent / n;
+}
+
+int main() {
+  static const Contact contacts[] = {
+    { "clean (no chatter)",          0, 0 },
+    { "tactile, chatter to 5 ms",    5000, 4 },
+    { "worn, chatter to 15 ms",     15000, 8 },
+  };
+  static const Stalls stalls[] = {
+    { "task every 10 ms",               0,    0 },
+    { "stalls to 120 ms every 2 s",  2000,  120 },
+    { "stalls to 1.5 s every 20 s", 20000, 1500 },
+  };
+
+  printf("Button events, %d min of taps, short taps, 3 s holds and chords per run, task every %d ms\n",
+         BENCH_MINUTES, BENCH_TASK_MS);
+  printf("  %-26s %-28s %6s %6s %6s %6s %7s %7s  %6s %6s %6s  %8s %8s\n",
+         "contact", "core 1", "events", "wrong", "miss", "drop", "bounces", "resync",
+         "p50 ms", "p95 ms", "max ms", "old miss", "old 2nd");
+  int fail = 0;
+  for (const Contact& c : contacts) {
+    rng = 11;
+    Script s = makeScript(c);
+    for (const Stalls& st : stalls) {
+      Result r = run(s, st);
+      uint32_t bound = (st.maxMs + BENCH_TASK_MS) * 1000 + BTN_LOCKOUT_US + 1000;
+      bool ok = !r.wrong && !r.missing && !r.extra && !r.dropped && pct(r.lat, 1.0) <= bound;
+      printf("  %-26s %-28s %6u %6u %6u %6u %7u %7u  %6.1f %6.1f %6.1f  %8u %8u%s\n",
+             c.name, st.name, r.events, r.wrong + r.extra, r.missing, r.dropped, r.bounces, r.resyncs,
+             pct(r.lat, 0.5) / 1000.0, pct(r.lat, 0.95) / 1000.0, pct(r.lat, 1.0) / 1000.0,
+             r.oldMissed, r.oldDoubled, ok ? "" : "  FAILED");
+      fail |= !ok;
+    }
+    printf("  %-26s %u taps, %u under the lockout, %u long, %u chords\n",
+           "", s.taps, s.shortTaps, s.longs, s.chords);
+  }
+  printf("  (latency is press-to-handled: from the change on the pin to next() handing the\n"
+         "   event over, a long press from when it reached %d s; \"old\" reads both pins each\n"
+         "   time the task runs, as readButtons() did: presses it missed, bounces it took\n"
+         "   for another press)\n", BTN_LONG_US / 1000000);
+
+  double isrNs, eventNs;
+  cpu(&isrNs, &eventNs);
+  printf("  CPU (host): %.1f ns per ISR call, %.1f ns per event\n", isrNs, eventNs);
+  printf("  RAM %zu bytes (ButtonInput, %d-event ring)\n", sizeof(ButtonInput), BTN_QUEUE);
+  if (sizeof(ButtonInput) > BENCH_RAM_MAX) fail = 1;
+  printf("  %s\n", fail ? "FAILED" : "all checks passed");
+  return fail;
+}
@@ -0,0 +1,260 @@
+// ============================================================
+// bench_capture.cpp — capture recorder → reader round trip
+// ============================================================
+// CaptureRecorder records a numbered IMU and PPG stream (ax and
+// red are each sample's place in it) with baro, GPS and button
+// records between, on a virtual microsecond clock, and drains to
+// a modelled serial port: a CAP_SERIAL_TX_BYTES TX buffer emptied
+// at 115200 baud into a file. Between drains, as on the device,
+// another writer puts text on the same port — partial lines,
+// whatever fits. CaptureReader then reads the file back.
+//
+// Checks: every record the recorder kept decodes, in order, with
+// its samples the right ones and none missing, and the only bytes
+// the reader skips are the text's — so no text landed inside a
+// record. Then the same stream through a flash-like sink that
+// takes writes only up to its 4 KB sector ends, with no room():
+// records split across writes still come back byte for byte.
+// Then ns per sample through imu() + drain().
+//
+//   make bench
+// ============================================================
+
+#include "tiga_capture.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <vector>
+
+#define BENCH_SECONDS   120
+#define BENCH_BAUD      115200       // Serial.begin() in setup()
+#define BENCH_DRAIN_MS  10           // firmware "capture" task period
+
+static uint32_t clockNow = 0;
+static uint32_t vclock() { return clockNow; }
+
+static uint32_t rng = 11;
+static uint32_t rnd() { rng ^= rng << 13; rng ^= rng >> 17; rng ^= rng << 5; return rng; }
+
+static uint64_t nowNs() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+// ── Serial port ──────────────────────────────────────────────
+// Bytes leave the TX buffer at the baud rate; the file sees them
+// in the order they were written, whoever wrote them.
+static std::vector<uint8_t> wire;
+static uint64_t portIdleUs = 0;          // when the TX buffer will be empty, ×10
+
+static uint32_t portQueued() {
+  uint64_t now = (uint64_t)clockNow * 10;
+  if (portIdleUs <= now) return 0;
+  uint64_t byteUs10 = 10ULL * 10 * 1000000 / BENCH_BAUD;   // 10 bits, in 0.1 µs
+  return (uint32_t)((portIdleUs - now + byteUs10 - 1) / byteUs10);
+}
+
+static uint16_t portRoom() { return (uint16_t)(CAP_SERIAL_TX_BYTES - portQueued()); }
+
+static uint16_t portWrite(const uint8_t* p, uint16_t n) {
+  uint16_t room = portRoom();
+  if (n > room) n = room;
+  wire.insert(wire.end(), p, p + n);
+  uint64_t now = (uint64_t)clockNow * 10;
+  portIdleUs = (portIdleUs > now ? portIdleUs : now) + n * (10ULL * 10 * 1000000 / BENCH_BAUD);
+  return n;
+}
+
+// ── Flash-like sink ──────────────────────────────────────────
+static uint16_t flashWrite(const uint8_t* p, uint16_t n) {
+  uint32_t room = 4096 - wire.size() % 4096;
+  if (n > room) n = (uint16_t)room;
+  wire.insert(wire.end(), p, p + n);
+  return n;
+}
+
+static bool save(const char* path) {
+  FILE* f = fopen(path, "wb");
+  if (!f) return false;
+  bool ok = fwrite(wire.data(), 1, wire.size(), f) == wire.size();
+  return fclose(f) == 0 && ok;
+}
+
+// ── Recording ────────────────────────────────────────────────
+struct Made {
+  uint32_t imu = 0, ppg = 0, other = 0;
+  uint32_t textBytes = 0, textLines = 0;
+};
+
+// BENCH_SECONDS of IMU bursts and 4 Hz PPG blocks, baro
+// at 1 Hz, GPS and buttons now and then; text between drains
+static void record(CaptureRecorder& rec, Made& m, bool text) {
+  clockNow = 0;
+  wire.clear();
+  portIdleUs = 0;
+  rec.begin(0);
+  rec.config(IMU_RATE_HZ, 100, 8192, 1310);
+  rec.drain();                               // the file header leads
+  ImuSample imu[CAP_IMU_MAX_SAMPLES + 5];
+  PpgBlock  blk;
+  memset(&blk, 0, sizeof(blk));
+  char line[96];
+  uint16_t lineLen = 0, lineOff = 0;
+  for (uint32_t t = 0; t < BENCH_SECONDS * 1000 / BENCH_DRAIN_MS; t++) {
+    clockNow += BENCH_DRAIN_MS * 1000;
+    // One poll's IMU burst — sometimes more than one record's worth
+    uint8_t n = (uint8_t)(IMU_RATE_HZ * BENCH_DRAIN_MS / 1000 + (rnd() % 8 == 0 ? 14 : 0));
+    for (uint8_t i = 0; i < n; i++) {
+      memset(&imu[i], 0, sizeof(ImuSample));
+      imu[i].idx = m.imu + i;
+      imu[i].ax  = (int16_t)(m.imu + i);
+      imu[i].gz  = (int16_t)~(m.imu + i);
+    }
+    rec.imu(imu, n);
+    m.imu += n;
+    if (t % 4 == 0) {
+      blk.firstSample = m.ppg;
+      blk.count = (uint16_t)(PPG_BLOCK_SAMPLES / 2 + rnd() % (PPG_BLOCK_SAMPLES / 2 + 1));
+      for (uint16_t i = 0; i < blk.count; i++) blk.s[i] = { m.ppg + i, (m.ppg + i) * 3 & 0x3FFFF };
+      rec.ppg(blk);
+      m.ppg += blk.count;
+    }
+    if (t % 100 == 0) { rec.baro(101325.0f - t, 21.5f); m.other++; }
+    if (rnd() % 200 == 0) { rec.gps(51.5, -0.12, 4.2f, 9, true); m.other++; }
+    if (rnd() % 300 == 0) { rec.button(1 + rnd() % 2, true); m.other++; }
+    // The other writer: a line now and then, as much as fits
+    if (text && lineOff == lineLen && rnd() % 5 == 0) {
+      lineLen = (uint16_t)snprintf(line, sizeof(line), "[TIGA] step %u hr %u - text on the capture port\n",
+                                   t, 60 + rnd() % 40);
+      lineOff = 0;
+      m.textLines++;
+    }
+    if (lineOff < lineLen) {
+      uint16_t k = portWrite((const uint8_t*)line + lineOff, lineLen - lineOff);
+      lineOff += k;
+      m.textBytes += k;
+    }
+    rec.drain();
+  }
+  // Let the port empty and the ring go out
+  while (rec.buffered() || lineOff < lineLen) {
+    clockNow += BENCH_DRAIN_MS * 1000;
+    if (lineOff < lineLen) {
+      uint16_t k = portWrite((const uint8_t*)line + lineOff, lineLen - lineOff);
+      lineOff += k;
+      m.textBytes += k;
+    }
+    rec.drain();
+  }
+  rec.end();
+}
+
+// ── Reading back ─────────────────────────────────────────────
+struct Read {
+  uint32_t records = 0, imu = 0, ppg = 0, other = 0, bad = 0;
+};
+
+static bool readBack(const char* path, Read& r, uint32_t* skipped) {
+  CaptureReader rd;
+  if (!rd.open(path)) return false;
+  CapRecord c;
+  uint32_t lastT = 0;
+  while (rd.next(c)) {
+    r.records++;
+    bool ok = c.tUs >= lastT;
+    lastT = c.tUs;
+    if (c.type == CAP_IMU) {
+      ok &= capImuFirst(c) == r.imu;
+      for (uint8_t i = 0; i < capImuCount(c); i++) {
+        ImuSample s;
+        capImuSample(c, i, s);
+        ok &= s.ax == (int16_t)(r.imu + i) && s.gz == (int16_t)~(r.imu + i);
+      }
+      r.imu += capImuCount(c);
+    } else if (c.type == CAP_PPG) {
+      ok &= capPpgFirst(c) == r.ppg && capPpgLost(c) == 0;
+      for (uint8_t i = 0; i < capPpgCount(c); i++)
+        ok &= capPpgRed(c, i) == r.ppg + i && capPpgIr(c, i) == ((r.ppg + i) * 3 & 0x3FFFF);
+      r.ppg += capPpgCount(c);
+    } else if (c.type != CAP_CONFIG) {
+      r.other++;
+    }
+    r.bad += !ok;
+  }
+  *skipped = rd.skippedBytes;
+  return true;
+}
+
+static int fail = 0;
+
+static void report(const char* name, bool ok, const char* detail) {
+  printf("  %-40s %-52s %s\n", name, detail, ok ? "ok" : "FAIL");
+  fail |= !ok;
+}
+
+int main() {
+  static CaptureRecorder serialRec({ portWrite, portRoom }, vclock);
+  static CaptureRecorder flashRec({ flashWrite }, vclock);
+  const char* path = "build/bench_capture.tigc";
+
+  printf("Capture round trip, %d s at %d Hz IMU with PPG blocks, drained every %d ms\n",
+         BENCH_SECONDS, IMU_RATE_HZ, BENCH_DRAIN_MS);
+
+  // Serial, text on the same port
+  {
+    Made m;
+    record(serialRec, m, true);
+    Read r;
+    uint32_t skipped = 0;
+    bool opened = save(path) && readBack(path, r, &skipped);
+    bool ok = opened && r.bad == 0 && serialRec.dropped == 0 &&
+              r.records == serialRec.records && r.imu == m.imu && r.ppg == m.ppg &&
+              r.other == m.other && skipped == m.textBytes && m.textLines > 0;
+    char d[96];
+    snprintf(d, sizeof(d), "%u records, %u text lines (%u B) skipped, %u bad",
+             r.records, m.textLines, skipped, r.bad);
+    report("serial, text interleaved", ok, d);
+    snprintf(d, sizeof(d), "%u kB out, worst %u B buffered",
+             serialRec.bytesOut / 1024, serialRec.maxBuffered);
+    report("  nothing dropped at 115200 baud", serialRec.dropped == 0, d);
+  }
+
+  // Flash: writes end at each sector, records split across them
+  {
+    Made m;
+    record(flashRec, m, false);
+    Read r;
+    uint32_t skipped = 0;
+    bool opened = save(path) && readBack(path, r, &skipped);
+    bool ok = opened && r.bad == 0 && skipped == 0 && flashRec.dropped == 0 &&
+              r.records == flashRec.records && r.imu == m.imu && r.ppg == m.ppg &&
+              r.other == m.other && wire.size() == flashRec.bytesOut;
+    char d[96];
+    snprintf(d, sizeof(d), "%u records in %zu sectors, %u bytes skipped",
+             r.records, (wire.size() + 4095) / 4096, skipped);
+    report("flash, writes split at sectors", ok, d);
+  }
+  remove(path);
+
+  // Host CPU: IMU bursts recorded and drained to a sink that takes all
+  CaptureRecorder* rec = new CaptureRecorder({ [](const uint8_t*, uint16_t n) { return n; } }, vclock);
+  ImuSample burst[10];
+  memset(burst, 0, sizeof(burst));
+  rec->begin(0);
+  const uint32_t polls = 200000;
+  uint64_t t0 = nowNs();
+  for (uint32_t i = 0; i < polls; i++) {
+    burst[0].idx = i * 10;
+    rec->imu(burst, 10);
+    rec->drain();
+  }
+  printf("  CPU (host): %.1f ns per IMU sample through imu() + drain()\n",
+         (double)(nowNs() - t0) / (polls * 10.0));
+  printf("  RAM %zu bytes (CaptureRecorder, %d-byte ring)\n", sizeof(CaptureRecorder), CAP_RING_BYTES);
+  delete rec;
+
+  printf("  %s\n", fail ? "FAILED" : "all checks passed");
+  return fail;
+}
@@ -0,0 +1,364 @@
+// ============================================================
+// bench_fusion.cpp — attitude filter against known orientation
+// ============================================================
+// Synthetic wrist motion with the true orientation known at
+// every sample: a body-rate profile is integrated (1 kHz, double)
+// into the truth, then turned into MPU6050 counts as the part
+// would report them — gravity and linear acceleration in sensor
+// axes, gyro with a zero-rate offset, noise on both.
+//
+//   still     tilted and not moving, gyro offset to learn
+//   turns     slow rotation about all three axes
+//   walking   arm swing plus step bounce and sway
+//   fast      bursts at 200°/s about random axes
+//   falls     free fall turning over, impact, lying, getting up
+//
+// Three estimates of pitch and roll against the truth:
+// accelerometer alone (what v6a displayed), a float Mahony filter
+// with the same gains, and tiga_fusion.h. Also vertical
+// acceleration against the true one, next to |a| - 1g (what the
+// balance score used). Then µs per update.
+//
+// Checks: the fixed-point filter stays within 0.2° of the float
+// one; beats accel-only tilt wherever there is linear
+// acceleration (walking, falls); and elsewhere, where accel-only
+// tilt is already right, stays within 1° RMS (0.5° still, with
+// the gyro offset to learn).
+//
+//   make bench
+// ============================================================
+
+#include "tiga_fusion.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <vector>
+
+#define BENCH_SECS      120
+#define BENCH_SUBSTEPS  5           // truth integration at 1 kHz
+#define BENCH_SETTLE_S  5           // not scored: the seed and first pull-in
+#define BENCH_ROLL_MAX  75.0        // roll isn't defined near ±90° pitch
+
+static const double PI  = 3.14159265358979;
+static const double RAD = PI / 180;
+
+static uint64_t nowNs() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static int16_t clamp16(double v) {
+  if (v >  32767) return  32767;
+  if (v < -32768) return -32768;
+  return (int16_t)lrint(v);
+}
+
+// ── Truth ────────────────────────────────────────────────────
+struct Quat { double w, x, y, z; };
+
+static Quat qmul(const Quat& a, const Quat& b) {
+  return { a.w * b.w - a.x * b.x - a.y * b.y - a.z * b.z,
+           a.w * b.x + a.x * b.w + a.y * b.z - a.z * b.y,
+           a.w * b.y - a.x * b.z + a.y * b.w + a.z * b.x,
+           a.w * b.z + a.x * b.y - a.y * b.x + a.z * b.w };
+}
+
+// World vector into sensor axes: q* v q
+static void toBody(const Quat& q, const double v[3], double out[3]) {
+  Quat p = qmul(qmul({ q.w, -q.x, -q.y, -q.z }, { 0, v[0], v[1], v[2] }), q);
+  out[0] = p.x; out[1] = p.y; out[2] = p.z;
+}
+
+static Quat axisAngle(double x, double y, double z, double deg) {
+  double n = sqrt(x * x + y * y + z * z), h = deg * RAD / 2;
+  return { cos(h), sin(h) * x / n, sin(h) * y / n, sin(h) * z / n };
+}
+
+struct Truth {
+  double pitch, roll;       // degrees, from the true up vector
+  double vert;              // linear acceleration along up, g
+};
+
+struct Trace {
+  std::vector<ImuSample> s;
+  std::vector<Truth>     truth;
+};
+
+// What moves: body rate (°/s) and world linear acceleration (g)
+// at time t
+typedef void (*MotionFn)(double t, double w[3], double lin[3]);
+
+static Trace makeTrace(MotionFn motion, Quat q, uint32_t seed) {
+  Trace tr;
+  uint32_t rng = seed;
+  auto gauss = [&rng]() {
+    double s = 0;
+    for (int k = 0; k < 4; k++) {
+      rng ^= rng << 13; rng ^= rng >> 17; rng ^= rng << 5;
+      s += (rng & 0xFFFFFF) / 16777216.0 - 0.5;
+    }
+    return s * 1.732;                         // ≈ unit variance
+  };
+  const double bias[3] = { 1.5, -1.0, 0.7 };  // °/s, as an untrimmed MPU6050
+  const double dt = 1.0 / IMU_RATE_HZ / BENCH_SUBSTEPS;
+  uint32_t n = BENCH_SECS * IMU_RATE_HZ;
+  for (uint32_t i = 0; i < n; i++) {
+    double w[3], lin[3];
+    for (int k = 0; k < BENCH_SUBSTEPS; k++) {
+      motion((i * BENCH_SUBSTEPS + k) * dt, w, lin);
+      double mag = sqrt(w[0] * w[0] + w[1] * w[1] + w[2] * w[2]);
+      if (mag > 0) q = qmul(q, axisAngle(w[0], w[1], w[2], mag * dt));
+    }
+    double t = (i + 1) * BENCH_SUBSTEPS * dt;
+    motion(t, w, lin);
+    const double upW[3] = { 0, 0, 1 };
+    double f[3] = { lin[0], lin[1], lin[2] + 1 }, fb[3], up[3];
+    toBody(q, f, fb);
+    toBody(q, upW, up);
+
+    ImuSample smp = {};
+    smp.idx = i;
+    smp.ax = clamp16((fb[0] + 0.008 * gauss()) * MOTION_LSB_PER_G);
+    smp.ay = clamp16((fb[1] + 0.008 * gauss()) * MOTION_LSB_PER_G);
+    smp.az = clamp16((fb[2] + 0.008 * gauss()) * MOTION_LSB_PER_G);
+    smp.gx = clamp16((w[0] + bias[0] + 0.3 * gauss()) * FUSION_GYRO_LSB_DPS);
+    smp.gy = clamp16((w[1] + bias[1] + 0.3 * gauss()) * FUSION_GYRO_LSB_DPS);
+    smp.gz = clamp16((w[2] + bias[2] + 0.3 * gauss()) * FUSION_GYRO_LSB_DPS);
+    smp.g2 = motionMag2(smp.ax, smp.ay, smp.az);
+    smp.g  = motionIsqrt(smp.g2);
+    smp.valid = true;
+    tr.s.push_back(smp);
+    tr.truth.push_back({ atan2(up[0], sqrt(up[1] * up[1] + up[2] * up[2])) / RAD,
+                         atan2(up[1], up[2]) / RAD, lin[2] });
+  }
+  return tr;
+}
+
+// ── Motions ──────────────────────────────────────────────────
+static void still(double, double w[3], double lin[3]) {
+  w[0] = w[1] = w[2] = 0;
+  lin[0] = lin[1] = lin[2] = 0;
+}
+
+static void turns(double t, double w[3], double lin[3]) {
+  w[0] = 40 * sin(2 * PI * 0.20 * t);
+  w[1] = 30 * sin(2 * PI * 0.13 * t);
+  w[2] = 20 * cos(2 * PI * 0.07 * t);
+  lin[0] = lin[1] = lin[2] = 0;
+}
+
+static void walking(double t, double w[3], double lin[3]) {
+  double f = 110 / 60.0, ph = 2 * PI * f * t;
+  w[0] = 12 * cos(ph);                         // forearm roll with each step
+  w[1] = 60 * cos(ph / 2);                     // arm swing, once per stride
+  w[2] = 15 * sin(ph / 2);
+  lin[0] = 0.25 * sin(ph / 2 + 1);             // fore and aft
+  lin[1] = 0.10 * sin(ph);                     // side to side
+  lin[2] = 0.30 * sin(ph) + 0.08 * sin(2 * ph);
+}
+
+static void fast(double t, double w[3], double lin[3]) {
+  // 0.5 s at 200°/s every 3 s, about an axis fixed per burst
+  uint32_t k = (uint32_t)(t / 3);
+  double   u = t - k * 3.0;
+  lin[0] = lin[1] = lin[2] = 0;
+  if (u >= 0.5) { w[0] = w[1] = w[2] = 0; return; }
+  uint32_t h = k * 2654435761u;
+  double ax = (double)(h & 0xFF) - 128, ay = (double)(h >> 8 & 0xFF) - 128, az = (double)(h >> 16 & 0xFF) - 128;
+  double n = sqrt(ax * ax + ay * ay + az * az) + 1e-9;
+  double s = (k & 1 ? -200 : 200) / n;
+  w[0] = ax * s; w[1] = ay * s; w[2] = az * s;
+}
+
+static void falls(double t, double w[3], double lin[3]) {
+  // Every 30 s: stand 10 s, fall (0.35 s free fall turning 80°,
+  // 50 ms impact), lie still, get up over 2 s
+  double u = fmod(t, 30.0);
+  w[0] = w[1] = w[2] = 0;
+  lin[0] = lin[1] = lin[2] = 0;
+  if (u >= 10 && u < 10.35) {
+    w[0] = 80 / 0.35;
+    lin[2] = -1;                               // free fall: nothing to feel
+  } else if (u >= 10.35 && u < 10.40) {
+    lin[0] = 1.5; lin[1] = 0.5; lin[2] = 2.5;  // impact
+  } else if (u >= 27 && u < 29) {
+    w[0] = -40;                                // back up
+  }
+}
+
+// ── Float reference ──────────────────────────────────────────
+// The same filter as tiga_fusion.h in plain float: what the fixed
+// point is checked against, and what it costs the other way.
+struct FloatMahony {
+  float q[4] = { 1, 0, 0, 0 }, bias[3] = { 0, 0, 0 }, up[3] = { 0, 0, 1 };
+  float vert = 0;
+  bool  ready = false;
+
+  void seed(float ax, float ay, float az) {
+    float n = sqrtf(ax * ax + ay * ay + az * az);
+    float vx = ax / n, vy = ay / n, vz = az / n;
+    if (vz > -0.99f) {
+      q[0] = sqrtf((1 + vz) / 2); q[1] = vy / (2 * q[0]); q[2] = -vx / (2 * q[0]);
+    } else {
+      q[0] = 0; q[1] = 1; q[2] = 0;
+    }
+    q[3] = 0;
+  }
+
+  void update(const ImuSample& s) {
+    const float dt = 1.0f / IMU_RATE_HZ, rps = 3.14159265f / 180 / FUSION_GYRO_LSB_DPS;
+    float ax = s.ax, ay = s.ay, az = s.az;
+    if (!ready) { seed(ax, ay, az); ready = true; }
+    float w[3] = { s.gx * rps, s.gy * rps, s.gz * rps };
+    float n = sqrtf(ax * ax + ay * ay + az * az);
+    if (fabsf(n / MOTION_LSB_PER_G - 1) < (float)FUSION_GATE_G) {
+      float a[3] = { ax / n, ay / n, az / n };
+      float e[3] = { a[1] * up[2] - a[2] * up[1], a[2] * up[0] - a[0] * up[2], a[0] * up[1] - a[1] * up[0] };
+      const float lim = (float)(FUSION_BIAS_MAX_DPS * 3.14159265 / 180);
+      for (int i = 0; i < 3; i++) {
+        bias[i] = fminf(lim, fmaxf(-lim, bias[i] + (float)FUSION_KI * e[i] * dt));
+        w[i] += (float)FUSION_KP * e[i];
+      }
+    }
+    float h[3];
+    for (int i = 0; i < 3; i++) h[i] = (w[i] + bias[i]) * dt / 2;
+    float qw = q[0], qx = q[1], qy = q[2], qz = q[3];
+    q[0] += -qx * h[0] - qy * h[1] - qz * h[2];
+    q[1] +=  qw * h[0] + qy * h[2] - qz * h[1];
+    q[2] +=  qw * h[1] - qx * h[2] + qz * h[0];
+    q[3] +=  qw * h[2] + qx * h[1] - qy * h[0];
+    float r = 1 / sqrtf(q[0] * q[0] + q[1] * q[1] + q[2] * q[2] + q[3] * q[3]);
+    for (float& c : q) c *= r;
+    up[0] = 2 * (q[1] * q[3] - q[0] * q[2]);
+    up[1] = 2 * (q[0] * q[1] + q[2] * q[3]);
+    up[2] = q[0] * q[0] - q[1] * q[1] - q[2] * q[2] + q[3] * q[3];
+    vert = (ax * up[0] + ay * up[1] + az * up[2]) / MOTION_LSB_PER_G - 1;
+  }
+
+  float pitch() const { return atan2f(up[0], sqrtf(up[1] * up[1] + up[2] * up[2])) * 180 / 3.14159265f; }
+  float roll()  const { return atan2f(up[1], up[2]) * 180 / 3.14159265f; }
+};
+
+// ── Scoring ──────────────────────────────────────────────────
+struct Err {
+  double sum2 = 0, max = 0;
+  uint32_t n = 0;
+  void add(double e) {
+    e = fabs(e);
+    sum2 += e * e; n++;
+    if (e > max) max = e;
+  }
+  double rms() const { return n ? sqrt(sum2 / n) : 0; }
+};
+
+static double angleDiff(double a, double b) {
+  double d = fmod(a - b + 540.0, 360.0) - 180.0;
+  return d;
+}
+
+struct Score {
+  Err pitch, roll;
+  Err vert;
+};
+
+static void scoreOne(Score& sc, const Truth& t, double pitch, double roll, double vert) {
+  sc.pitch.add(pitch - t.pitch);
+  if (fabs(t.pitch) < BENCH_ROLL_MAX) sc.roll.add(angleDiff(roll, t.roll));
+  sc.vert.add(vert - t.vert);
+}
+
+int main() {
+  struct Case { const char* name; MotionFn fn; Quat start; bool linear; };
+  const Case cases[] = {
+    { "still",   still,   qmul(axisAngle(1, 0, 0, 25), axisAngle(0, 1, 0, -15)), false },
+    { "turns",   turns,   axisAngle(0, 0, 1, 0),                                  false },
+    { "walking", walking, axisAngle(1, 0, 0, 6),                                  true  },
+    { "fast",    fast,    axisAngle(0, 1, 0, 10),                                 false },
+    { "falls",   falls,   axisAngle(1, 0, 0, 4),                                  true  },
+  };
+  int fail = 0;
+
+  printf("Attitude filter (tiga_fusion.h), %d s per trace at %d Hz, error vs truth in degrees\n",
+         BENCH_SECS, IMU_RATE_HZ);
+  printf("  %-8s %-9s %8s %8s %8s %8s %9s\n",
+         "", "", "pitch rms", "max", "roll rms", "max", "vert rms g");
+  double worstDiff = 0;
+  for (uint32_t c = 0; c < sizeof(cases) / sizeof(cases[0]); c++) {
+    Trace tr = makeTrace(cases[c].fn, cases[c].start, 17 + c);
+    Score acc, flt, fix;
+    FloatMahony ref;
+    FusionFilter fus;
+    double maxDiff = 0;
+    for (size_t i = 0; i < tr.s.size(); i++) {
+      const ImuSample& s = tr.s[i];
+      ref.update(s);
+      fus.update(s.ax, s.ay, s.az, s.gx, s.gy, s.gz, s.g);
+      if (i < (size_t)BENCH_SETTLE_S * IMU_RATE_HZ) continue;
+      const Truth& t = tr.truth[i];
+
+      double aPitch = motionTiltCdeg(s.ax, s.ay, s.az) / 100.0;
+      double aRoll  = atan2((double)s.ay, (double)s.az) / RAD;
+      scoreOne(acc, t, aPitch, aRoll, (double)s.g / MOTION_LSB_PER_G - 1);
+      scoreOne(flt, t, ref.pitch(), ref.roll(), ref.vert);
+      double p = fus.pitchCdeg() / 100.0, r = fus.rollCdeg() / 100.0;
+      scoreOne(fix, t, p, r, (double)fus.vert / MOTION_LSB_PER_G);
+
+      double d = fabs(p - ref.pitch());
+      if (fabs(t.pitch) < BENCH_ROLL_MAX) d = fmax(d, fabs(angleDiff(r, ref.roll())));
+      if (d > maxDiff) maxDiff = d;
+    }
+    const Score* rows[] = { &acc, &flt, &fix };
+    const char*  names[] = { "accel", "float", "fixed" };
+    for (int k = 0; k < 3; k++) {
+      const Score& sc = *rows[k];
+      printf("  %-8s %-9s %8.2f %8.2f %8.2f %8.2f %9.3f\n", k ? "" : cases[c].name, names[k],
+             sc.pitch.rms(), sc.pitch.max, sc.roll.rms(), sc.roll.max, sc.vert.rms());
+    }
+    if (maxDiff > worstDiff) worstDiff = maxDiff;
+    double limit = c == 0 ? 0.5 : 1.0;
+    if (cases[c].linear && fix.pitch.rms() + fix.roll.rms() >= acc.pitch.rms() + acc.roll.rms()) {
+      printf("    no better than the accelerometer alone\n");
+      fail = 1;
+    }
+    if (!cases[c].linear && (fix.pitch.rms() > limit || fix.roll.rms() > limit)) {
+      printf("    more than %.1f degrees RMS off\n", limit);
+      fail = 1;
+    }
+  }
+  printf("  fixed vs float: at most %.3f degrees apart\n", worstDiff);
+  if (worstDiff > 0.2) fail = 1;
+
+  // ── Cost ──
+  {
+    Trace tr = makeTrace(walking, axisAngle(1, 0, 0, 6), 5);
+    const int reps = 20;
+    FloatMahony ref;
+    FusionFilter fus;
+    volatile int32_t sink = 0;
+    uint64_t t0 = nowNs();
+    for (int r = 0; r < reps; r++)
+      for (const ImuSample& s : tr.s) sink += fus.update(s.ax, s.ay, s.az, s.gx, s.gy, s.gz, s.g);
+    uint64_t fixNs = nowNs() - t0;
+    volatile float fsink = 0;
+    t0 = nowNs();
+    for (int r = 0; r < reps; r++)
+      for (const ImuSample& s : tr.s) { ref.update(s); fsink += ref.vert; }
+    uint64_t fltNs = nowNs() - t0;
+    t0 = nowNs();
+    for (uint32_t i = 0; i < tr.s.size(); i++) {
+      fus.up[0] ^= i & 1;                       // keep it from being hoisted
+      sink += fus.pitchCdeg() + fus.rollCdeg();
+    }
+    uint64_t angNs = nowNs() - t0;
+    double n = (double)reps * tr.s.size();
+    printf("\n  per update: fixed %.3f us, float %.3f us; pitch + roll readout %.3f us\n",
+           fixNs / n / 1000, fltNs / n / 1000, angNs / (double)tr.s.size() / 1000);
+    printf("  (host FPU; the ESP32-S3 has no hardware sqrt or divide)\n");
+  }
+
+  printf("  %s\n", fail ? "FAILED" : "all checks passed");
+  return fail;
+}
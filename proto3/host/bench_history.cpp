@@ -0,0 +1,287 @@
+// ============================================================
+// bench_history.cpp — flash history store: size, wear, recovery
+// ============================================================
+// Runs tiga_history.h against the NOR emulator in flash_file.h,
+// backed by build/bench_history.flash:
+//
+//   size       bytes per hour at rest, walking and over a mixed
+//              day; flash bytes programmed per encoded byte and
+//              per raw 16-byte sample
+//   wear       erases per sector after the ring has wrapped
+//   recovery   begin() on a full partition: bytes read, host time
+//   seek       random timestamps: bytes read, host time
+//   power cut  cuts the power at every byte programmed (and every
+//              erase) of a one-hour run on a small partition,
+//              reboots, and checks that exactly the blocks whose
+//              write completed come back, in order, and that the
+//              store keeps appending afterwards
+//
+//   make bench
+// ============================================================
+
+#include "tiga_history.h"
+#include "flash_file.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <vector>
+
+#define BENCH_PART_BYTES  (1u << 20)       // as in partitions.csv
+#define BENCH_T0          1776124800u      // 2026-04-14 00:00 UTC
+#define BENCH_RAW_BYTES   16               // one HistSample, packed
+#define BENCH_S3_READ_MBS 20.0             // esp_partition_read, roughly
+
+static uint64_t nowNs() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+// ── Flash binding ────────────────────────────────────────────
+static FlashFile flash;
+
+static bool fRead(uint32_t off, void* dst, uint32_t n)        { return flash.read(off, dst, n); }
+static bool fWrite(uint32_t off, const void* src, uint32_t n) { return flash.write(off, src, n); }
+static bool fErase(uint32_t off)                              { return flash.erase(off, HIST_SECTOR); }
+
+static HistFlash binding() { return { flash.size(), fRead, fWrite, fErase }; }
+
+// ── Synthetic wearer ─────────────────────────────────────────
+// Deterministic in i, so any sample can be regenerated to check
+// what comes back. mode: 0 mixed day, 1 rest, 2 walking, 3 every
+// field changes every second (worst case, for the power-cut run).
+struct Wearer {
+  int mode;
+  uint32_t rng = 1;
+  int32_t  steps = 0, alt = 120, hr = 68;
+  uint32_t n = 0;
+
+  uint32_t rand() { rng ^= rng << 13; rng ^= rng >> 17; rng ^= rng << 5; return rng; }
+
+  bool walking(uint32_t i) const {
+    if (mode == 1) return false;
+    if (mode >= 2) return true;
+    uint32_t m = (i / 60) % 180;                 // 3 h cycle: 40 min walking
+    return m >= 20 && m < 60;
+  }
+
+  HistSample next() {
+    uint32_t i = n++;
+    HistSample s;
+    bool w = walking(i);
+    if (mode == 3 || (w && rand() % 3 == 0) || rand() % 20 == 0) hr += (int32_t)(rand() % 5) - 2;
+    if (hr < 50) hr = 50;
+    if (hr > 160) hr = 160;
+    if (mode == 3) steps += 1 + rand() % 3;
+    else if (w)    steps += (i % 5 < 3) ? 2 : 1;   // ~110 spm
+    if (mode == 3 || rand() % 40 == 0) alt += (int32_t)(rand() % 3) - 1;
+    s.t       = BENCH_T0 + i;
+    s.hr      = (uint8_t)hr;
+    s.spo2    = (uint8_t)(mode == 3 ? 90 + rand() % 9 : (rand() % 90 == 0 ? 96 : 97));
+    s.battery = (uint8_t)(100 - i / 2000);
+    s.worn    = mode == 3 ? (i / 7) % 2 : (i % 20000) > 300;
+    s.steps   = steps;
+    s.altDm   = alt;
+    return s;
+  }
+};
+
+static std::vector<HistSample> makeRun(int mode, uint32_t n) {
+  Wearer w = { mode };
+  std::vector<HistSample> v;
+  v.reserve(n);
+  for (uint32_t i = 0; i < n; i++) v.push_back(w.next());
+  return v;
+}
+
+// ── Size ─────────────────────────────────────────────────────
+static double bytesPerHour(int mode) {
+  std::vector<HistSample> run = makeRun(mode, 3600 * 4);
+  flash.open("build/bench_history.flash", BENCH_PART_BYTES);
+  flash.erase(0, BENCH_PART_BYTES);
+  HistoryStore st;
+  st.begin(binding());
+  for (const HistSample& s : run) st.append(s);
+  st.flush();
+  return st.flashBytes / 4.0;
+}
+
+// Everything from the oldest sample on must match the run exactly
+static int verify(HistoryStore& st, const std::vector<HistSample>& run, uint32_t* first, uint32_t* count) {
+  HistCursor c;
+  HistSample s;
+  *count = 0;
+  if (!st.seekOldest(c)) return 0;
+  uint32_t i = 0;
+  while (st.next(c, s)) {
+    if (*count == 0) {
+      i = s.t - BENCH_T0;
+      *first = i;
+    }
+    if (i >= run.size() || !(s == run[i])) return 1;
+    i++;
+    (*count)++;
+  }
+  return 0;
+}
+
+static int benchDay(std::vector<HistSample>& day, HistoryStore& st) {
+  double rest = bytesPerHour(1), walk = bytesPerHour(2);
+  day = makeRun(0, 86400);
+  flash.open("build/bench_history.flash", BENCH_PART_BYTES);
+  flash.erase(0, BENCH_PART_BYTES);
+  flash.resetCounters();
+  st.begin(binding());
+  st.prepare(HIST_ERASE_AHEAD);
+  uint64_t t0 = nowNs();
+  for (const HistSample& s : day) st.append(s);
+  st.flush();
+  uint64_t ns = nowNs() - t0;
+
+  printf("  %-26s %8.0f B/h\n", "at rest", rest);
+  printf("  %-26s %8.0f B/h\n", "walking", walk);
+  printf("  %-26s %8.0f B/h   %.1f days in %u KB\n", "mixed day (24 h)",
+         st.flashBytes / 24.0, (double)BENCH_PART_BYTES / (st.flashBytes / 24.0) / 24.0 *
+         (1.0 - (double)HIST_ERASE_AHEAD * HIST_SECTOR / BENCH_PART_BYTES),
+         BENCH_PART_BYTES / 1024);
+  printf("  %-26s %8.2f B   (raw %d B)\n", "per sample, programmed",
+         (double)st.flashBytes / st.samplesIn, BENCH_RAW_BYTES);
+  printf("  %-26s %8.3f    (headers + block framing)\n", "programmed / encoded",
+         (double)st.flashBytes / st.recordBytes);
+  printf("  %-26s %8.3f\n", "programmed / raw", (double)st.flashBytes / (st.samplesIn * (double)BENCH_RAW_BYTES));
+  printf("  %-26s %8.1f ns/sample on the host, %u blocks\n", "append",
+         (double)ns / day.size(), st.blocksOut);
+
+  uint32_t first = 0, count = 0;
+  int fail = verify(st, day, &first, &count);
+  printf("  %-26s %8u samples   %s\n", "read back", count,
+         fail || count != day.size() ? "MISMATCH" : "identical");
+  return fail || count != day.size();
+}
+
+// ── Wear ─────────────────────────────────────────────────────
+static int benchWear() {
+  const uint32_t part = 256 * 1024, days = 30;
+  std::vector<HistSample> run;
+  flash.open("build/bench_history.flash", part);
+  flash.erase(0, part);
+  std::fill(flash.eraseCount.begin(), flash.eraseCount.end(), 0);
+  HistoryStore st;
+  st.begin(binding());
+  Wearer w = { 0 };
+  for (uint32_t i = 0; i < days * 86400; i++) {
+    st.append(w.next());
+    if (i % 3600 == 0) st.prepare(HIST_ERASE_AHEAD);   // an hourly quiet moment
+  }
+  st.flush();
+  uint32_t lo = UINT32_MAX, hi = 0;
+  for (uint32_t e : flash.eraseCount) { if (e < lo) lo = e; if (e > hi) hi = e; }
+  printf("  %-26s %u days in %u KB: erases per sector %u..%u, %u forced\n", "ring wear",
+         days, part / 1024, lo, hi, st.forcedErases);
+  return hi - lo > 1;
+}
+
+// ── Recovery and seek ────────────────────────────────────────
+static int benchRecover(const std::vector<HistSample>& day) {
+  flash.open("build/bench_history.flash", BENCH_PART_BYTES);   // what benchDay left
+  flash.resetCounters();
+  HistoryStore st;
+  uint64_t t0 = nowNs();
+  st.begin(binding());
+  uint64_t ns = nowNs() - t0;
+  printf("  %-26s %8u B read in %llu ops, %.1f us host, ~%.1f ms on the S3\n", "begin() on a full day",
+         st.recoverReads, (unsigned long long)flash.readOps, ns / 1e3,
+         st.recoverReads / (BENCH_S3_READ_MBS * 1e3));
+
+  int fail = 0;
+  uint32_t rng = 7;
+  const uint32_t seeks = 2000;
+  flash.resetCounters();
+  t0 = nowNs();
+  for (uint32_t k = 0; k < seeks; k++) {
+    rng ^= rng << 13; rng ^= rng >> 17; rng ^= rng << 5;
+    uint32_t i = rng % day.size();
+    HistCursor c;
+    HistSample s;
+    if (!st.seek(BENCH_T0 + i, c) || !st.next(c, s) || !(s == day[i])) fail = 1;
+  }
+  ns = nowNs() - t0;
+  printf("  %-26s %8.0f B read, %.1f us host, ~%.2f ms on the S3   %s\n", "seek (mean)",
+         (double)flash.bytesRead / seeks, ns / 1e3 / seeks,
+         flash.bytesRead / (double)seeks / (BENCH_S3_READ_MBS * 1e3), fail ? "WRONG SAMPLE" : "exact");
+  return fail;
+}
+
+// ── Power cuts ───────────────────────────────────────────────
+// Three sectors, so the ring wraps and forced erases happen too.
+// A block whose write was cut can still come back whole: if only
+// the last CRC byte was missing and it happens to be 0xFF, the
+// block is intact. That is counted, not failed — verify() still
+// checks every sample against the run.
+static int benchPowerCut() {
+  const uint32_t part = 3 * HIST_SECTOR, n = 3600;
+  std::vector<HistSample> run = makeRun(3, n + 600);
+
+  // Clean run: how many units (bytes + erases) does it take?
+  flash.open(nullptr, part);
+  HistoryStore st;
+  st.begin(binding());
+  st.prepare(HIST_ERASE_AHEAD);
+  for (uint32_t i = 0; i < n; i++) st.append(run[i]);
+  st.flush();
+  uint64_t units = flash.bytesProgrammed + flash.sectorsErased;
+
+  uint32_t bad = 0, torn = 0, wrapped = 0, lucky = 0;
+  for (uint64_t cut = 0; cut <= units; cut++) {
+    flash.open(nullptr, part);
+    flash.cutAfter(cut);
+    HistoryStore a;
+    a.begin(binding());
+    a.prepare(HIST_ERASE_AHEAD);
+    int32_t durable = -1;                    // last sample a completed flush covers
+    for (uint32_t i = 0; i < n && !flash.dead(); i++) {
+      uint16_t before = a.pending();
+      if (a.append(run[i]) && a.pending() < before + 1) durable = (int32_t)i;
+    }
+    if (!flash.dead() && a.flush()) durable = n - 1;
+    int32_t inFlight = durable + a.pending();
+
+    // Reboot
+    flash.powerOn();
+    HistoryStore b;
+    b.begin(binding());
+    torn += b.tornFound;
+    uint32_t first = 0, count = 0;
+    int fail = verify(b, run, &first, &count);
+    int32_t last = count ? (int32_t)(first + count - 1) : -1;
+    if (!fail && last == inFlight && inFlight != durable) lucky++;
+    else if (fail || last != durable) {
+      bad++;
+      continue;
+    }
+    if (first > 0) wrapped++;
+
+    // Carry on from there
+    uint32_t from = (uint32_t)(last + 1);
+    b.prepare(HIST_ERASE_AHEAD);
+    for (uint32_t i = from; i < from + 600; i++) b.append(run[i]);
+    b.flush();
+    if (verify(b, run, &first, &count) || first + count != from + 600) bad++;
+  }
+  printf("  %-26s %llu cut points, %u torn blocks met, %u after a wrap, %u cut blocks intact: %u bad\n",
+         "power cut at every byte", (unsigned long long)units + 1, torn, wrapped, lucky, bad);
+  return bad != 0;
+}
+
+int main() {
+  printf("History store, %u KB partition, %d s blocks\n", BENCH_PART_BYTES / 1024, HIST_BLOCK_SAMPLES);
+  std::vector<HistSample> day;
+  HistoryStore st;
+  int fail = benchDay(day, st);
+  fail |= benchRecover(day);
+  fail |= benchWear();
+  fail |= benchPowerCut();
+  printf("  %s\n", fail ? "FAILED" : "all checks passed");
+  return fail;
+}
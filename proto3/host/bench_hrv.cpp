@@ -0,0 +1,258 @@
+// ============================================================
+// bench_hrv.cpp — HRV pipeline against known interval series
+// ============================================================
+// A beat-to-beat interval series with known variability —
+// breathing (RSA), a slow 0.1 Hz swing and beat-to-beat noise —
+// drives a synthetic PPG at 100 Hz: the simulator's pulse shape
+// at each true beat, respiration baseline, sensor noise. That
+// goes through checkForBeat() (the host stand-in) and
+// tiga_hrv.h exactly as processPpgSample() feeds them.
+//
+//   vagal      62 bpm, large RSA          RMSSD ~50 ms
+//   older      72 bpm, little variability RMSSD ~12 ms
+//   fast      110 bpm, almost none        RMSSD ~5 ms
+//   ectopic   vagal + 3% premature beats with compensatory pause
+//   weak      older + 2% beats too faint to detect
+//   motion    older + 3 s of arm movement every minute
+//   noisy     older, sensor noise ×4 (pulse 6× the noise σ)
+//
+// Truth is the same windows computed from the true normal
+// intervals (those not touching an ectopic beat). Every 10 s
+// from 5 minutes in: RMSSD, SDNN and pNN50 error for the 1- and
+// 5-minute windows. For the clean cases, also what RMSSD would be
+// from checkForBeat()'s whole-sample times — what v6a's
+// beatsPerMinute was built on.
+//
+// Checks: 5-minute RMSSD and SDNN within 10% or 2 ms (15% with
+// motion), pNN50 within 5 points, every window valid; in the
+// clean cases the 1-minute windows valid too and RMSSD within 25%
+// or 3 ms — fewer differences, and at 110 bpm the true RMSSD is
+// not far above the timing noise.
+//
+//   make bench
+// ============================================================
+
+#include "tiga_hrv.h"
+#include "arduino/heartRate.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <vector>
+
+#define BENCH_HZ      100
+#define BENCH_SECS    900
+#define BENCH_EVAL_S  300           // first evaluation: a full 5-minute window
+#define BENCH_EVAL_EVERY_S  10
+
+static const double PI = 3.14159265358979;
+
+static uint64_t nowNs() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static double gauss() {
+  double u = (rand() + 1.0) / ((double)RAND_MAX + 2), v = rand() / ((double)RAND_MAX + 1);
+  return sqrt(-2 * log(u)) * cos(2 * PI * v);
+}
+
+// ── Interval series ──────────────────────────────────────────
+struct Case {
+  const char* name;
+  double bpm;
+  double rsaMs, lfMs, whiteMs;    // amplitudes; white is σ
+  double ectopic;                 // fraction of beats premature
+  double weak;                    // fraction too faint to detect
+  bool   motion;
+  double noise;                   // PPG noise σ, counts
+  bool   clean;                   // no rejections expected
+};
+
+struct Beat {
+  double t;                       // s
+  bool   ectopic;
+  bool   weak;
+};
+
+static std::vector<Beat> makeBeats(const Case& c) {
+  std::vector<Beat> b;
+  double t = 1.0, base = 60.0 / c.bpm;
+  bool pendingComp = false;
+  double compS = 0;
+  while (t < BENCH_SECS + 2) {
+    double rr = base + c.rsaMs / 1000 * sin(2 * PI * 0.25 * t) + c.lfMs / 1000 * sin(2 * PI * 0.1 * t + 1)
+              + c.whiteMs / 1000 * gauss();
+    Beat nb = { 0, false, false };
+    if (pendingComp) {
+      rr = compS;                 // compensatory pause: two intervals sum to 2 rr
+      pendingComp = false;
+    } else if (rand() < c.ectopic * RAND_MAX) {
+      compS = rr * 2 - rr * 0.65;
+      rr *= 0.65;
+      nb.ectopic = true;
+      pendingComp = true;
+    }
+    nb.weak = !nb.ectopic && rand() < c.weak * RAND_MAX;
+    t += rr;
+    nb.t = t;
+    b.push_back(nb);
+  }
+  return b;
+}
+
+// The simulator's pulse shape, but with the upstroke fixed in
+// time: it takes the same time whatever the interval, so the beat
+// time is the true one. The dicrotic bump stays where the
+// simulator puts it, a fraction of the way into the interval.
+static double pulseShape(double dt, double rr) {
+  double a = (dt - 0.15) / 0.07, b = (dt / rr - 0.45) / 0.09;
+  return exp(-a * a) + 0.35 * exp(-b * b);
+}
+
+// IR counts, as the simulator's wearer: dips at each beat (the
+// previous beat's tail included)
+static std::vector<int32_t> makePpg(const Case& c, const std::vector<Beat>& beats) {
+  std::vector<int32_t> ir(BENCH_SECS * BENCH_HZ);
+  size_t bi = 0;
+  for (size_t i = 0; i < ir.size(); i++) {
+    double t = (double)i / BENCH_HZ;
+    while (bi + 1 < beats.size() && beats[bi + 1].t <= t) bi++;
+    double p = 0;
+    for (size_t j = bi > 0 ? bi - 1 : 0; j <= bi; j++)
+      if (t >= beats[j].t) p += pulseShape(t - beats[j].t, beats[j + 1].t - beats[j].t) * (beats[j].weak ? 0.02 : 1);
+    double v = 120000 + 300 * sin(2 * PI * 0.25 * t) - 700 * p + c.noise * gauss();
+    if (c.motion && fmod(t, 60) < 3) v += 1500 * sin(2 * PI * 1.7 * t) + 600 * sin(2 * PI * 3.1 * t);
+    ir[i] = (int32_t)lrint(v);
+  }
+  return ir;
+}
+
+// ── Truth ────────────────────────────────────────────────────
+// Same buckets as the tracker: the interval ending in bucket id
+// counts for windows whose newest bucket is id..id+buckets-1
+static HrvStats truth(const std::vector<Beat>& b, double nowS, uint8_t buckets) {
+  long now = (long)floor(nowS / HRV_BUCKET_S);
+  double s1 = 0, s2 = 0, d2 = 0;
+  int n = 0, nd = 0, nn50 = 0;
+  double prev = 0;
+  for (size_t i = 1; i < b.size(); i++) {
+    bool normal = !b[i].ectopic && !b[i - 1].ectopic;
+    double rr = (b[i].t - b[i - 1].t) * 1000;
+    long id = (long)floor(b[i].t / HRV_BUCKET_S);
+    bool in = normal && b[i].t <= nowS && id <= now && now - id < buckets;
+    if (in) {
+      n++; s1 += rr; s2 += rr * rr;
+      if (prev > 0) {
+        double d = fabs(rr - prev);
+        nd++; d2 += d * d;
+        if (d > 50) nn50++;
+      }
+    }
+    prev = in ? rr : 0;
+  }
+  HrvStats r = {};
+  r.nn = (uint16_t)n; r.diffs = (uint16_t)nd;
+  r.meanRrMs = (float)(s1 / n);
+  r.sdnnMs   = (float)sqrt((s2 - s1 * s1 / n) / (n - 1));
+  r.rmssdMs  = (float)sqrt(d2 / nd);
+  r.pnn50    = (float)(100.0 * nn50 / nd);
+  r.valid    = true;
+  return r;
+}
+
+struct Err {
+  double rmssd = 0, sdnn = 0, pnn50 = 0;   // worst: relative, relative, points
+  double rmssdMs = 0, sdnnMs = 0;          // worst absolute
+  int    windows = 0, invalid = 0;
+  double floorMs;                          // absolute error that always passes
+  explicit Err(double f) : floorMs(f) {}
+  void add(const HrvStats& e, const HrvStats& t) {
+    windows++;
+    if (!e.valid) { invalid++; return; }
+    double dr = fabs(e.rmssdMs - t.rmssdMs), ds = fabs(e.sdnnMs - t.sdnnMs);
+    // Relative, unless the absolute error is small anyway
+    rmssd   = fmax(rmssd, dr <= floorMs ? 0 : dr / t.rmssdMs);
+    sdnn    = fmax(sdnn,  ds <= floorMs ? 0 : ds / t.sdnnMs);
+    rmssdMs = fmax(rmssdMs, dr);
+    sdnnMs  = fmax(sdnnMs, ds);
+    pnn50   = fmax(pnn50, fabs(e.pnn50 - t.pnn50));
+  }
+};
+
+int main() {
+  const Case cases[] = {
+    // name       bpm  rsa  lf  white ect   weak  motion noise clean
+    { "vagal",     62,  45, 25, 22,   0,    0,    false, 30,   true  },
+    { "older",     72,  10,  8,  6,   0,    0,    false, 30,   true  },
+    { "fast",     110,   3,  4,  2.5, 0,    0,    false, 30,   true  },
+    { "ectopic",   62,  45, 25, 22,   0.03, 0,    false, 30,   false },
+    { "weak",      72,  10,  8,  6,   0,    0.02, false, 30,   false },
+    { "motion",    72,  10,  8,  6,   0,    0,    true,  30,   false },
+    { "noisy",     72,  10,  8,  6,   0,    0,    false, 60,   true  },
+  };
+  int fail = 0;
+  srand(31);
+
+  printf("HRV pipeline (tiga_hrv.h), %d s synthetic PPG at %d Hz per case\n", BENCH_SECS, BENCH_HZ);
+  printf("  worst error vs the true intervals, evaluated every %d s once 5 min is in\n\n",
+         BENCH_EVAL_EVERY_S);
+  printf("  %-8s %6s %6s  %-5s %9s %9s %7s %7s  %s\n", "", "RMSSD", "SDNN", "win",
+         "RMSSD err", "SDNN err", "pNN50", "invalid", "beats kept/rejected");
+  double costNs = 0;
+  uint64_t costSamples = 0;
+  for (const Case& c : cases) {
+    std::vector<Beat> beats = makeBeats(c);
+    std::vector<int32_t> ir = makePpg(c, beats);
+
+    HrvTracker hrv(BENCH_HZ);
+    Err e1(3), e5(2);
+    std::vector<uint32_t> trig;
+    HrvStats t5last = {};
+    uint64_t t0 = nowNs();
+    for (uint32_t i = 0; i < ir.size(); i++) {
+      bool beat = checkForBeat(ir[i]);
+      hrv.push(ir[i], i);
+      if (beat) trig.push_back(i);
+      if (i < BENCH_EVAL_S * BENCH_HZ || i % (BENCH_EVAL_EVERY_S * BENCH_HZ)) continue;
+      double nowS = (double)(i + 1) / BENCH_HZ;
+      e1.add(hrv.stats(i, HRV_SHORT_BUCKETS), truth(beats, nowS, HRV_SHORT_BUCKETS));
+      t5last = truth(beats, nowS, HRV_BUCKETS);
+      e5.add(hrv.stats(i, HRV_BUCKETS), t5last);
+    }
+    costNs += (double)(nowNs() - t0);
+    costSamples += ir.size();
+
+    double lim = c.motion ? 0.15 : 0.10;
+    bool bad = e5.rmssd > lim || e5.sdnn > lim || e5.pnn50 > 5 || e5.invalid ||
+               (c.clean && (e1.invalid || e1.rmssd > 0.25));
+    printf("  %-8s %6.1f %6.1f  %-5s %6.1f ms %6.1f ms %5.1f pt %4d/%-3d %lu/%lu\n",
+           c.name, t5last.rmssdMs, t5last.sdnnMs, "5 min", e5.rmssdMs, e5.sdnnMs, e5.pnn50,
+           e5.invalid, e5.windows, (unsigned long)hrv.accepted, (unsigned long)hrv.rejected);
+    printf("  %-8s %6s %6s  %-5s %6.1f ms %6.1f ms %5.1f pt %4d/%-3d%s\n",
+           "", "", "", "1 min", e1.rmssdMs, e1.sdnnMs, e1.pnn50, e1.invalid, e1.windows,
+           bad ? "  <- FAIL" : "");
+    if (bad) fail = 1;
+
+    // Whole-sample detector times over the last 5 minutes, no rejection
+    if (c.clean) {
+      double d2 = 0;
+      int nd = 0;
+      for (size_t k = 2; k < trig.size(); k++) {
+        if (trig[k] < (BENCH_SECS - 300) * BENCH_HZ) continue;
+        double d = ((double)trig[k] - 2.0 * trig[k - 1] + trig[k - 2]) * 1000 / BENCH_HZ;
+        d2 += d * d; nd++;
+      }
+      HrvStats tr = truth(beats, BENCH_SECS, HRV_BUCKETS);
+      printf("  %-8s %6s %6s  %-5s RMSSD from whole-sample beat times: %.1f ms (true %.1f)\n",
+             "", "", "", "", sqrt(d2 / nd), tr.rmssdMs);
+    }
+  }
+
+  printf("\n  per PPG sample, detector + tracker: %.1f ns; state %u bytes, no heap\n",
+         costNs / costSamples, (unsigned)sizeof(HrvTracker));
+  printf("  %s\n", fail ? "FAILED" : "all checks passed");
+  return fail;
+}
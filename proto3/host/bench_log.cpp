@@ -0,0 +1,239 @@
+// ============================================================
+// bench_log.cpp — LOG() on the hot path, and the frames round trip
+// ============================================================
+// What a sensor task pays per event with tiga_log.h, against what
+// it paid to Serial.printf() the same line: the formatting, then
+// the wire at 115200 baud once the 128-byte UART FIFO is full.
+//
+//   cost      ns per LOG() with 0, 2 and 4 arguments, as the
+//             median, 99th percentile and worst of batches; the
+//             drain's cost per line; snprintf() of the same lines
+//   full      a ring that nobody drains: every push past
+//             LOG_RING is dropped and counted, none waits
+//   order     a sink that takes a few bytes per call: every line
+//             arrives whole and in order
+//   frames    random events as binary frames, cut into random
+//             pieces and mixed with text: LogScanner gets back
+//             every event exactly, and formats it as the device
+//             would have; and how often random bytes pass for
+//             a frame
+//
+//   make bench
+// ============================================================
+
+#include "tiga_log.h"
+
+#include <algorithm>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <time.h>
+#include <vector>
+
+#define BENCH_BATCH     32        // events timed together, ≤ LOG_RING
+#define BENCH_BATCHES   20000
+#define BENCH_BAUD      115200
+#define BENCH_UART_FIFO 128
+
+static uint64_t nowNs() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static uint32_t benchClock() { return (uint32_t)(nowNs() / 1000); }
+
+static uint32_t rng = 99;
+static uint32_t rnd() { rng ^= rng << 13; rng ^= rng >> 17; rng ^= rng << 5; return rng; }
+
+// ── Sinks ────────────────────────────────────────────────────
+static std::string sinkOut;
+static uint16_t     sinkRoom = 0xFFFF;
+
+static uint16_t sinkNone(const uint8_t*, uint16_t n) { return n; }
+
+static uint16_t sinkSlow(const uint8_t* p, uint16_t n) {
+  if (n > sinkRoom) n = sinkRoom;
+  sinkOut.append((const char*)p, n);
+  return n;
+}
+
+struct Cost { double p50, p99, max; };
+
+static Cost percentiles(std::vector<double>& v) {
+  std::sort(v.begin(), v.end());
+  return { v[v.size() / 2], v[v.size() * 99 / 100], v.back() };
+}
+
+// ns per event over batches of BENCH_BATCH, drained between
+template <typename F>
+static Cost timeLog(EventLog& log, F push) {
+  std::vector<double> per;
+  for (int b = 0; b < BENCH_BATCHES; b++) {
+    uint64_t t0 = nowNs();
+    for (int i = 0; i < BENCH_BATCH; i++) push(i);
+    per.push_back((double)(nowNs() - t0) / BENCH_BATCH);
+    while (log.queued()) log.drain();
+  }
+  return percentiles(per);
+}
+
+int main() {
+  int fail = 0;
+  EventLog& log = eventLog();
+  log.begin(benchClock);
+  log.addSink({ sinkNone, true, false });
+
+  printf("LOG() against Serial.printf(), per event\n");
+  printf("  %-22s %8s %8s %8s\n", "", "p50 ns", "p99 ns", "max ns");
+
+  // ── cost ──
+  float hr = 72, alt = 3.5f;
+  Cost c0 = timeLog(log, [&](int) { LOG(SESSION_RESET); });
+  Cost c2 = timeLog(log, [&](int i) { LOG(FLOOR, i, alt); });
+  Cost c4 = timeLog(log, [&](int i) { LOG(PPG_TRACE, hr + i, 97, 1, 0.52f); });
+  printf("  %-22s %8.0f %8.0f %8.0f\n", "LOG, no arguments", c0.p50, c0.p99, c0.max);
+  printf("  %-22s %8.0f %8.0f %8.0f\n", "LOG, 2 arguments",  c2.p50, c2.p99, c2.max);
+  printf("  %-22s %8.0f %8.0f %8.0f\n", "LOG, 4 arguments",  c4.p50, c4.p99, c4.max);
+
+  // The drain: formatting moved off the hot path, not gone
+  {
+    std::vector<double> per;
+    for (int b = 0; b < BENCH_BATCHES / 4; b++) {
+      for (int i = 0; i < BENCH_BATCH; i++) LOG(PPG_TRACE, hr + i, 97, 1, 0.52f);
+      uint64_t t0 = nowNs();
+      while (log.queued()) log.drain();
+      per.push_back((double)(nowNs() - t0) / BENCH_BATCH);
+    }
+    Cost d = percentiles(per);
+    printf("  %-22s %8.0f %8.0f %8.0f   (core 1, low priority)\n", "drain, 4 arguments", d.p50, d.p99, d.max);
+  }
+
+  // What the sensor path used to do: format, then write
+  {
+    char line[LOG_LINE_MAX];
+    std::vector<double> per;
+    int len = 0;
+    for (int b = 0; b < BENCH_BATCHES / 4; b++) {
+      uint64_t t0 = nowNs();
+      for (int i = 0; i < BENCH_BATCH; i++)
+        len = snprintf(line, sizeof(line), "[MAX] HR=%.0f bpm  SpO2=%d%%  valid=%d  R=%.3f\n",
+                       (double)(hr + i), 97, 1, 0.52);
+      per.push_back((double)(nowNs() - t0) / BENCH_BATCH);
+    }
+    Cost s = percentiles(per);
+    printf("  %-22s %8.0f %8.0f %8.0f\n", "snprintf, 4 arguments", s.p50, s.p99, s.max);
+    double wireUs = len * 10 * 1e6 / BENCH_BAUD;
+    printf("  a %d-byte line is %.0f us on the wire at %d baud; past a %d-byte FIFO,\n"
+           "  Serial.printf() waits that long for each one\n",
+           len, wireUs, BENCH_BAUD, BENCH_UART_FIFO);
+  }
+
+  // ── full ──
+  {
+    EventLog full;
+    full.begin(benchClock);
+    uint64_t worst = 0;
+    for (int i = 0; i < 10 * LOG_RING; i++) {
+      uint64_t t0 = nowNs();
+      LogEvent e = {};
+      e.id = LOG_FLOOR;
+      e.nargs = 2;
+      full.push(e);
+      worst = std::max(worst, nowNs() - t0);
+    }
+    bool ok = full.dropped[0] == 9 * LOG_RING && full.queued() == LOG_RING;
+    printf("\nRing of %d nobody drains: %d pushes, %lu dropped, %lu queued, worst push %llu ns\n",
+           LOG_RING, 10 * LOG_RING, (unsigned long)full.dropped[0],
+           (unsigned long)full.queued(), (unsigned long long)worst);
+    fail |= !ok;
+  }
+
+  // ── order ──
+  {
+    EventLog slow;
+    slow.begin(benchClock);
+    slow.addSink({ sinkSlow, true, false });
+    sinkOut.clear();
+    std::string want;
+    char line[LOG_LINE_MAX];
+    int sent = 0;
+    for (int i = 0; i < 2000; i++) {
+      if (slow.queued() < LOG_RING) {
+        LogEvent e = {};
+        e.id = LOG_MPU_RECOVERED;
+        e.nargs = 1;
+        e.a[0] = (uint32_t)sent++;
+        slow.push(e);
+        logFormat(e, line, sizeof(line));
+        want += line;
+      }
+      sinkRoom = (uint16_t)(rnd() % 12);
+      slow.drain();
+    }
+    sinkRoom = 0xFFFF;
+    while (slow.queued()) slow.drain();
+    slow.drain();
+    bool ok = sinkOut == want && slow.dropped[0] == 0;
+    printf("Sink taking 0-11 bytes a call: %d lines, %s\n", sent,
+           ok ? "all whole and in order" : "MISMATCH");
+    fail |= !ok;
+  }
+
+  // ── frames ──
+  {
+    std::vector<LogEvent> in;
+    std::vector<uint8_t>  stream;
+    const char* noise = "[TIGA] v6a boot complete\r\n";
+    for (int i = 0; i < 20000; i++) {
+      LogEvent e = {};
+      e.id    = (uint8_t)(rnd() % LOG_IDS);
+      e.nargs = logArgCount(LOG_FORMATS[e.id].fmt);
+      e.core  = rnd() & 1;
+      e.tUs   = rnd();
+      for (uint8_t k = 0; k < e.nargs; k++)
+        e.a[k] = logArgKind(LOG_FORMATS[e.id].fmt, k) == 'f' ? logWord((float)(rnd() % 100000) / 7.0f)
+                                                            : rnd() % 5000;
+      in.push_back(e);
+      uint8_t f[LOG_FRAME_MAX];
+      uint8_t n = logFrame(e, f);
+      stream.insert(stream.end(), f, f + n);
+      if (rnd() % 8 == 0) stream.insert(stream.end(), noise, noise + strlen(noise));
+    }
+    LogScanner sc;
+    size_t got = 0, wrong = 0, textBytes = 0;
+    char a[LOG_LINE_MAX], b[LOG_LINE_MAX];
+    auto onFrame = [&](const LogEvent& e) {
+      if (got < in.size()) {
+        const LogEvent& w = in[got];
+        logFormat(e, a, sizeof(a));
+        logFormat(w, b, sizeof(b));
+        if (e.id != w.id || e.tUs != w.tUs || e.core != w.core || strcmp(a, b)) wrong++;
+      }
+      got++;
+    };
+    auto onText = [&](const uint8_t*, size_t n) { textBytes += n; };
+    for (size_t i = 0; i < stream.size();) {
+      size_t n = std::min(stream.size() - i, (size_t)(1 + rnd() % 40));
+      sc.feed(stream.data() + i, n, onFrame, onText);
+      i += n;
+    }
+    sc.feed(nullptr, 0, onFrame, onText, true);
+    bool ok = got == in.size() && !wrong;
+    printf("Frames in random pieces with text between: %zu sent, %zu decoded, %zu differ, "
+           "%zu text bytes\n", in.size(), got, wrong, textBytes);
+    fail |= !ok;
+
+    // Line noise instead of text: a sync byte followed by a CRC
+    // that happens to match passes for a frame, 1 in 256
+    LogScanner junk;
+    std::vector<uint8_t> bytes(1 << 20);
+    for (uint8_t& x : bytes) x = (uint8_t)rnd();
+    junk.feed(bytes.data(), bytes.size(), [](const LogEvent&) {}, [](const uint8_t*, size_t) {}, true);
+    printf("1 MB of random bytes: %u taken for frames\n", junk.frames);
+  }
+
+  printf("  %s\n", fail ? "FAILED" : "all checks passed");
+  return fail;
+}
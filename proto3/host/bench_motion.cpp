@@ -0,0 +1,315 @@
+// ============================================================
+// bench_motion.cpp — integer motion kernel vs the float maths
+// ============================================================
+// Runs synthetic MPU6050 samples (walking, tremor, random
+// orientations, near-threshold magnitudes) through the old float
+// code and through tiga_motion.h, checks the results agree within
+// the tolerance stated in that header, and reports ns/sample.
+//
+//   make bench
+//
+// Host CPUs have a hardware sqrt; the ESP32-S3 does not, so the
+// float column here flatters the float code.
+// ============================================================
+
+#include "tiga_motion.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <vector>
+
+#define BENCH_SAMPLES  400000     // ~33 min at 200 Hz
+#define BENCH_BURST    32         // samples per pipeline call
+
+static uint64_t nowNs() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static int16_t clamp16(float v) {
+  if (v >  32767.0f) return  32767;
+  if (v < -32768.0f) return -32768;
+  return (int16_t)lrintf(v);
+}
+
+static void synth(std::vector<ImuSample>& out) {
+  uint32_t rng = 2024;
+  auto uni = [&rng]() {
+    rng ^= rng << 13; rng ^= rng >> 17; rng ^= rng << 5;
+    return (rng & 0xFFFFFF) / 16777216.0f;
+  };
+  const float thresholds[] = { 0.5f, 1.05f, 1.15f, 1.3f, 3.0f, 6.0f };
+  for (uint32_t i = 0; i < BENCH_SAMPLES; i++) {
+    float t = i / 200.0f;
+    float x, y, z;
+    switch ((i / 20000) % 4) {
+      case 0: {                                  // walking, wrist swinging
+        float ph = 6.2832f * 1.8f * t;
+        x = 0.3f * sinf(ph * 0.5f);
+        y = 0.25f * sinf(ph + 1.0f);
+        z = 1.0f + 0.35f * sinf(ph);
+        break;
+      }
+      case 1:                                    // tremor at rest
+        x = 0.1f; y = 0.05f * sinf(6.2832f * 5.0f * t); z = 0.99f;
+        break;
+      case 2: {                                  // anything, up to 4.5g
+        float m = 4.5f * uni(), u = 2 * uni() - 1, a = 6.2832f * uni();
+        float s = sqrtf(1 - u * u);
+        x = m * s * cosf(a); y = m * s * sinf(a); z = m * u;
+        break;
+      }
+      default: {                                 // just either side of a threshold
+        float m = thresholds[i % 6] + (uni() - 0.5f) * 0.002f;
+        float u = 2 * uni() - 1, a = 6.2832f * uni(), s = sqrtf(1 - u * u);
+        x = m * s * cosf(a); y = m * s * sinf(a); z = m * u;
+        break;
+      }
+    }
+    ImuSample smp = {};
+    smp.idx = i;
+    smp.ax = clamp16(x * MOTION_LSB_PER_G + (uni() - 0.5f) * 40);
+    smp.ay = clamp16(y * MOTION_LSB_PER_G + (uni() - 0.5f) * 40);
+    smp.az = clamp16(z * MOTION_LSB_PER_G + (uni() - 0.5f) * 40);
+    smp.valid = true;
+    out.push_back(smp);
+  }
+}
+
+// ── The v6a float stages, as they were ───────────────────────
+// Fall, step, balance and activity from tiga_main_v6a.ino before
+// the integer kernel, with the firmware globals pulled into a
+// struct. Tilt is taken once per burst, as on the device.
+#define STEP_BUF    200
+#define BAL_WINDOW  1000
+
+struct Outcome {
+  uint32_t steps = 0, falls = 0, activeOn = 0, activeOff = 0, dropped = 0;
+  std::vector<int> balance;
+  std::vector<int32_t> tiltCdeg;
+};
+
+static float floatTilt(const ImuSample& s) {
+  float ay = s.ay, az = s.az;
+  return atan2f((float)s.ax, sqrtf(ay * ay + az * az)) * 180.0f / 3.14159f;
+}
+
+struct FloatPath {
+  float    g[BENCH_BURST];
+  float    buf[STEP_BUF], sum = STEP_BUF;
+  int      idx = 0;
+  bool     above = false, inFall = false, active = false;
+  uint32_t debounce = 0, fallT = 0;
+  float    wobble = 0;
+  int      wobbleN = 0;
+  Outcome  out;
+
+  FloatPath() { for (float& b : buf) b = 1.0f; }
+
+  void run(ImuSample* s, uint8_t n) {
+    const ImuSample* last = nullptr;
+    for (uint8_t i = 0; i < n; i++) {
+      float ax = s[i].ax, ay = s[i].ay, az = s[i].az;
+      g[i] = sqrtf(ax * ax + ay * ay + az * az) / 8192.0f;
+      s[i].valid = g[i] > 0 && g[i] <= 6.0f;
+      if (s[i].valid) last = &s[i];
+      else out.dropped++;
+    }
+    if (last) out.tiltCdeg.push_back((int32_t)lrintf(floatTilt(*last) * 100));
+
+    for (uint8_t i = 0; i < n; i++) {
+      if (!s[i].valid) continue;
+      float gi = g[i];
+      uint32_t t = imuSampleMs(s[i].idx);
+
+      if (gi > 3.0f && !inFall) { inFall = true; fallT = t; }
+      if (inFall && t - fallT > 250) { if (gi < 0.5f) out.falls++; inFall = false; }
+
+      sum += gi - buf[idx];
+      buf[idx] = gi;
+      idx = (idx + 1) % STEP_BUF;
+      if (idx == 0) { sum = 0; for (float b : buf) sum += b; }
+      float dev = gi - sum / STEP_BUF;
+      if (!above && dev > 0.15f && t - debounce > 300) { above = true; debounce = t; out.steps++; }
+      else if (above && dev < 0.08f) above = false;
+
+      wobble += fabsf(gi - 1.0f);
+      if (++wobbleN >= BAL_WINDOW) {
+        float sc = 100 - (wobble / wobbleN) * 200;
+        out.balance.push_back((int)(sc < 0 ? 0 : sc > 100 ? 100 : sc));
+        wobble = 0; wobbleN = 0;
+      }
+
+      if (gi > 1.15f && !active)      { active = true;  out.activeOn++; }
+      else if (gi < 1.05f && active)  { active = false; out.activeOff++; }
+    }
+  }
+};
+
+// ── The same stages on the integer kernel ────────────────────
+struct IntPath {
+  uint16_t buf[STEP_BUF];
+  int32_t  sum = STEP_BUF * MOTION_LSB_PER_G;
+  int      idx = 0;
+  bool     above = false, inFall = false, active = false;
+  uint32_t debounce = 0, fallT = 0;
+  int32_t  wobble = 0, wobbleN = 0;
+  Outcome  out;
+
+  IntPath() { for (uint16_t& b : buf) b = MOTION_LSB_PER_G; }
+
+  void run(ImuSample* s, uint8_t n) {
+    motionBatch(s, n);
+    const ImuSample* last = nullptr;
+    for (uint8_t i = 0; i < n; i++) {
+      s[i].valid = s[i].g2 != 0 && s[i].g2 <= motionG2(6.0f);
+      if (s[i].valid) last = &s[i];
+      else out.dropped++;
+    }
+    if (last) out.tiltCdeg.push_back(motionTiltCdeg(last->ax, last->ay, last->az));
+
+    for (uint8_t i = 0; i < n; i++) {
+      if (!s[i].valid) continue;
+      uint32_t g2 = s[i].g2;
+      int32_t  g  = s[i].g;
+      uint32_t t  = imuSampleMs(s[i].idx);
+
+      if (g2 > motionG2(3.0f) && !inFall) { inFall = true; fallT = t; }
+      if (inFall && t - fallT > 250) { if (g2 < motionG2(0.5f)) out.falls++; inFall = false; }
+
+      sum += g - buf[idx];
+      buf[idx] = (uint16_t)g;
+      idx = (idx + 1) % STEP_BUF;
+      int32_t dev = g - sum / STEP_BUF;
+      if (!above && dev > MOTION_G(0.15f) && t - debounce > 300) { above = true; debounce = t; out.steps++; }
+      else if (above && dev < MOTION_G(0.08f)) above = false;
+
+      int32_t d = g - MOTION_LSB_PER_G;
+      wobble += d < 0 ? -d : d;
+      if (++wobbleN >= BAL_WINDOW) {
+        int64_t full = (int64_t)wobbleN * MOTION_LSB_PER_G;
+        int32_t sc = (int32_t)((100 * full - 200 * (int64_t)wobble) / full);
+        out.balance.push_back(sc < 0 ? 0 : sc > 100 ? 100 : sc);
+        wobble = 0; wobbleN = 0;
+      }
+
+      if (g2 > motionG2(1.15f) && !active)      { active = true;  out.activeOn++; }
+      else if (g2 < motionG2(1.05f) && active)  { active = false; out.activeOff++; }
+    }
+  }
+};
+
+template <class Path>
+static uint64_t runPath(Path& p, std::vector<ImuSample> s) {
+  uint64_t t0 = nowNs();
+  for (size_t i = 0; i < s.size(); i += BENCH_BURST) {
+    size_t n = s.size() - i < BENCH_BURST ? s.size() - i : BENCH_BURST;
+    p.run(&s[i], (uint8_t)n);
+  }
+  return nowNs() - t0;
+}
+
+// ── Primitive accuracy ───────────────────────────────────────
+static int checkPrimitives(const std::vector<ImuSample>& s) {
+  static const float thresholds[] = { 0.5f, 1.05f, 1.15f, 1.3f, 3.0f, 6.0f };
+  double maxG = 0, maxTilt = 0;
+  size_t thrBad = 0, thrEdge = 0;
+  for (ImuSample x : s) {
+    motionBatch(&x, 1);
+    float ax = x.ax, ay = x.ay, az = x.az;
+    float gf = sqrtf(ax * ax + ay * ay + az * az) / 8192.0f;
+    double dg = gf * MOTION_LSB_PER_G - x.g;
+    if (dg > maxG) maxG = dg;
+    if (dg < -0.01) thrBad++;               // above the float value: not a floor
+
+    double dt = fabs(atan2((double)x.ax, sqrt((double)ay * ay + (double)az * az)) * 180 / M_PI
+                     - motionTiltCdeg(x.ax, x.ay, x.az) / 100.0);
+    if (dt > maxTilt) maxTilt = dt;
+
+    for (float t : thresholds) {
+      if ((gf > t) == (x.g2 > motionG2(t))) continue;
+      if (fabsf(gf - t) * MOTION_LSB_PER_G <= 1.0f) thrEdge++;
+      else                                          thrBad++;
+    }
+  }
+  printf("  |a| error          0 to -%.3f counts\n", maxG);
+  printf("  tilt error         %.4f deg max\n", maxTilt);
+  printf("  threshold tests    %zu differ within 1 count of the threshold, %zu beyond\n",
+         thrEdge, thrBad);
+  return maxG < 1.01 && maxTilt <= 0.01 && thrBad == 0 ? 0 : 1;
+}
+
+// ── Stage outcomes ───────────────────────────────────────────
+static int compare(const Outcome& f, const Outcome& i) {
+  int balMax = 0;
+  for (size_t k = 0; k < f.balance.size() && k < i.balance.size(); k++) {
+    int d = abs(f.balance[k] - i.balance[k]);
+    if (d > balMax) balMax = d;
+  }
+  int32_t tiltMax = 0;
+  for (size_t k = 0; k < f.tiltCdeg.size() && k < i.tiltCdeg.size(); k++) {
+    int32_t d = abs(f.tiltCdeg[k] - i.tiltCdeg[k]);
+    if (d > tiltMax) tiltMax = d;
+  }
+  printf("                     float  integer\n");
+  printf("  steps           %8u %8u\n", f.steps, i.steps);
+  printf("  falls           %8u %8u\n", f.falls, i.falls);
+  printf("  active on/off   %4u/%-4u %4u/%-4u\n", f.activeOn, f.activeOff, i.activeOn, i.activeOff);
+  printf("  dropped         %8u %8u\n", f.dropped, i.dropped);
+  printf("  balance scores  %8zu %8zu   max diff %d\n", f.balance.size(), i.balance.size(), balMax);
+  printf("  display tilt    %8zu %8zu   max diff %.2f deg\n",
+         f.tiltCdeg.size(), i.tiltCdeg.size(), tiltMax / 100.0);
+
+  // Near-threshold samples may land either side, so counts can
+  // differ by a hair; anything more is a bug.
+  auto near = [](uint32_t a, uint32_t b, uint32_t tol) { return (a > b ? a - b : b - a) <= tol; };
+  bool ok = near(f.steps, i.steps, f.steps / 1000 + 1) && f.falls == i.falls &&
+            near(f.activeOn, i.activeOn, f.activeOn / 100 + 1) && f.dropped == i.dropped &&
+            f.balance.size() == i.balance.size() && balMax <= 1 && tiltMax <= 1;
+  return ok ? 0 : 1;
+}
+
+// ── Speed of the primitives alone ────────────────────────────
+static volatile uint32_t sink;
+
+static void timePrimitives(const std::vector<ImuSample>& s) {
+  float acc = 0;
+  uint64_t t0 = nowNs();
+  for (const ImuSample& x : s) acc += floatTilt(x);
+  uint64_t floatNs = nowNs() - t0;
+  sink = (uint32_t)acc;
+
+  int32_t iacc = 0;
+  t0 = nowNs();
+  for (const ImuSample& x : s) iacc += motionTiltCdeg(x.ax, x.ay, x.az);
+  uint64_t intNs = nowNs() - t0;
+  sink = (uint32_t)iacc;
+
+  printf("  %-24s %8.2f %8.2f %7.2fx\n", "tilt (per call)",
+         (double)floatNs / s.size(), (double)intNs / s.size(),
+         intNs ? (double)floatNs / intNs : 0.0);
+}
+
+int main() {
+  std::vector<ImuSample> s;
+  synth(s);
+  printf("Motion kernel, %d samples\n", BENCH_SAMPLES);
+  int fail = checkPrimitives(s);
+
+  FloatPath fp;
+  IntPath   ip;
+  uint64_t floatNs = runPath(fp, s);
+  uint64_t intNs   = runPath(ip, s);
+  fail |= compare(fp.out, ip.out);
+
+  printf("  %-24s %8s %8s %8s\n", "ns/sample", "float", "integer", "speed-up");
+  printf("  %-24s %8.2f %8.2f %7.2fx\n", "stages 1-5 (per sample)",
+         (double)floatNs / s.size(), (double)intNs / s.size(),
+         intNs ? (double)floatNs / intNs : 0.0);
+  timePrimitives(s);
+  printf("  %s\n", fail ? "OUT OF TOLERANCE" : "within tolerance");
+  return fail;
+}
@@ -0,0 +1,484 @@
+// ============================================================
+// bench_ppg_sqi.cpp — PPG signal quality on walking traces
+// ============================================================
+// Six hours of wrist PPG (100 Hz, red + IR) and accelerometer
+// magnitude (200 Hz) from one synthetic wearer, replayed in
+// 250 ms blocks the way taskPpg() gets them, through two copies
+// of the HR / SpO2 / HRV path:
+//
+//   v6a     every sample into checkForBeat() (the host stand-in),
+//           the 4-beat average, tiga_hrv.h and tiga_spo2.h
+//   gated   tiga_ppg_sqi.h first; skipped blocks go nowhere,
+//           fair ones move HR and SpO2 slowly and don't count
+//           towards the alarm — as processPpgBlock() does now
+//
+// and the HR alarm as taskAlerts() raises it: once a second,
+// three readings in a row outside 45-110 bpm. A raised alarm
+// holds for 30 s (someone dismissing the emergency screen).
+//
+//   rest      sitting, 62-80 bpm
+//   walk      95-130 steps/min, HR up to 105. The arm swing puts
+//             0.8-2.5× the pulse into the IR, at the stride and
+//             step frequencies
+//   gesture   sitting, with 1-4 s of arm movement every few
+//             seconds: an aperiodic artefact up to 3× the pulse
+//   af        resting, beats irregular by ±25% (atrial
+//             fibrillation), the amplitude following each interval
+//   tachy     resting at 125-140 bpm: the alarm it should raise
+//
+// An alarm during a second whose true HR is inside 45-110 is
+// false. Per activity: false alarms per hour, the seconds with an
+// HR shown and its error, SpO2 error, blocks skipped. Also ns per
+// block for each path, and the CPU the skipped blocks saved.
+//
+// Checks: gated no more than 0.5 false alarms per hour, and under
+// a quarter of v6a's; every tachycardia still alarmed; HR shown
+// at rest and in AF at least 85% of the time and within 5 bpm;
+// gated cheaper per block than v6a; sizeof(PpgQuality) within
+// the header's figure.
+//
+//   make bench
+//   build/bench_ppg_sqi capture.tigc ...   alarms and CPU on
+//                                          recordings instead
+// ============================================================
+
+#include "tiga_ppg_sqi.h"
+#include "tiga_hrv.h"
+#include "tiga_spo2.h"
+#include "tiga_capture.h"
+#include "arduino/heartRate.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <vector>
+
+#define BENCH_HOURS      6
+#define PPG_HZ           100
+#define IMU_HZ           200
+#define BLOCK            25          // samples, as PPG_BLOCK_SAMPLES
+#define HR_LOW           45          // HR_WARN_LOW / HR_WARN_HIGH
+#define HR_HIGH          110
+#define ALARM_HOLD_S     30
+#define SETTLE_S         20          // after a change of activity, not scored for HR
+#define RATE_SIZE        4           // MAX_RATE_SIZE
+#define BENCH_RAM_MAX    450         // the header says ~430 B
+
+static uint64_t nowNs() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static double urand() { return (rand() + 0.5) / ((double)RAND_MAX + 1); }
+static double gauss() { return sqrt(-2 * log(urand())) * cos(6.283185307 * urand()); }
+
+// ── Traces ───────────────────────────────────────────────────
+enum Act : uint8_t { ACT_REST, ACT_WALK, ACT_GESTURE, ACT_AF, ACT_TACHY, ACTS };
+static const char* actName[ACTS] = { "rest", "walk", "gesture", "af", "tachy" };
+
+struct Trace {
+  std::vector<int32_t> ir, red;      // 100 Hz
+  std::vector<int32_t> g;            // 200 Hz, |a| in MOTION_LSB_PER_G counts
+  std::vector<float>   hr;           // per second, true
+  std::vector<uint8_t> act;          // per second
+  std::vector<uint32_t> episode;     // per second, tachy episode number + 1
+  float spo2 = 97;                   // throughout
+};
+
+static float pulseShape(float ph) {
+  float a = (ph - 0.15f) / 0.07f, b = (ph - 0.45f) / 0.09f;
+  return expf(-a * a) + 0.35f * expf(-b * b);
+}
+
+static void makeTrace(Trace& tr, uint32_t secs) {
+  const float irDc = 120000, redDc = 90000, twoPi = 6.2831853f;
+  float irAc = irDc * (0.0035f + 0.0035f * (float)urand());  // PI 0.35-0.7 %
+  float R = (110.0f - tr.spo2) / 25.0f;
+  float phase = 0, rr = 0.8f, amp = 1;
+  float lpArt = 0, lpAcc = 0;
+  uint32_t t = 0, episodes = 0;
+  float restHr = 70;
+
+  while (t < secs) {
+    // Next activity and how long
+    double u = urand();
+    Act a = u < 0.32 ? ACT_REST : u < 0.62 ? ACT_WALK : u < 0.82 ? ACT_GESTURE
+          : u < 0.92 ? ACT_AF : ACT_TACHY;
+    uint32_t len = a == ACT_TACHY ? 90 + rand() % 90 : 120 + rand() % 480;
+    if (t + len > secs) len = secs - t;
+    restHr = 62 + 18 * (float)urand();
+    float hrT = a == ACT_WALK ? restHr + 15 + 10 * (float)urand()
+              : a == ACT_AF   ? 70 + 15 * (float)urand()
+              : a == ACT_TACHY ? 125 + 15 * (float)urand()
+              : a == ACT_GESTURE ? restHr + 5 : restHr;
+    if (a == ACT_WALK && hrT > 105) hrT = 105;
+    float spm = 95 + 35 * (float)urand(), f = spm / 60;
+    float k = 0.8f + 1.7f * (float)urand();
+    float ph1 = twoPi * (float)urand(), ph2 = twoPi * (float)urand();
+    if (a == ACT_TACHY) episodes++;
+    float burstLeft = 0, quietLeft = 2;
+
+    for (uint32_t s = 0; s < len; s++, t++) {
+      tr.hr.push_back(hrT);
+      tr.act.push_back(a);
+      tr.episode.push_back(a == ACT_TACHY ? episodes : 0);
+      for (int i = 0; i < PPG_HZ; i++) {
+        float ts = t + (float)i / PPG_HZ, dt = 1.0f / PPG_HZ;
+        float mean = 60 / hrT;
+        phase += dt / rr;
+        if (phase >= 1) {
+          phase -= 1;
+          rr = a == ACT_AF ? mean * (0.75f + 0.5f * (float)urand())
+                           : mean + 0.03f * (float)gauss();
+          if (rr < 0.3f) rr = 0.3f;
+          amp = a == ACT_AF ? 0.6f + 0.4f * rr / mean : 1;
+        }
+        float p = amp * pulseShape(phase);
+        float resp = 0.3f * irAc * sinf(twoPi * 0.25f * ts);
+        float art = 0, acc = 1;
+
+        if (a == ACT_WALK) {
+          float w = twoPi * f * ts;
+          float env = 1 + 0.3f * sinf(twoPi * 0.05f * ts);
+          art = k * irAc * env * (0.8f * sinf(0.5f * w + ph1) + 0.5f * sinf(w + ph2) + 0.2f * sinf(2 * w));
+        } else if (a == ACT_GESTURE) {
+          if (burstLeft > 0) {
+            burstLeft -= dt;
+            lpArt += 0.08f * (3 * irAc * (float)gauss() - lpArt);
+            art = lpArt;
+          } else if ((quietLeft -= dt) <= 0) {
+            burstLeft = 1 + 3 * (float)urand();
+            quietLeft = 3 + 6 * (float)urand();
+          }
+        }
+
+        float fIr  = irDc + resp - irAc * p + art + 30 * (float)gauss();
+        float fRed = redDc + 0.75f * resp - R * irAc / irDc * redDc * p + 0.75f * art + 25 * (float)gauss();
+        tr.ir.push_back((int32_t)fIr);
+        tr.red.push_back((int32_t)fRed);
+
+        for (int j = 0; j < IMU_HZ / PPG_HZ; j++) {
+          float ta = ts + j * 0.5f / PPG_HZ;
+          if (a == ACT_WALK) {
+            float w = twoPi * f * ta;
+            acc = 1 + 0.28f * sinf(w) + 0.1f * sinf(2 * w) + 0.02f * (float)gauss();
+          } else if (a == ACT_GESTURE && burstLeft > 0) {
+            lpAcc += 0.1f * (1.1f * (float)gauss() - lpAcc);
+            acc = 1 + lpAcc;
+          } else {
+            acc = 1 + 0.01f * (float)gauss();
+          }
+          if (acc < 0) acc = -acc;
+          tr.g.push_back((int32_t)lroundf(acc * MOTION_LSB_PER_G));
+        }
+      }
+    }
+  }
+}
+
+// ── The two paths ────────────────────────────────────────────
+struct Path {
+  bool     gated;
+  uint8_t  rates[RATE_SIZE] = {};
+  uint8_t  rateSqi[RATE_SIZE] = {};
+  uint8_t  rateSpot = 0, rateCount = 0;
+  uint32_t lastBeat = 0, skipRun = 0, usableRun = 0;
+  float    beatAvg = 0, hr = 0;
+  uint8_t  rateQuality = 0, hrQuality = 0;
+  uint8_t  spo2 = 0;
+  bool     spo2Valid = false;
+  float    spo2R = 0;
+  HrvTracker    hrv{PPG_HZ};
+  Spo2Estimator spo2Est{PPG_HZ * 4};
+  PpgQuality    q;
+
+  explicit Path(bool g) : gated(g) {}
+
+  void sample(int32_t ir, int32_t red, uint32_t idx, uint8_t sqi) {
+    if (gated && sqi < PPG_SQI_USABLE) return;
+    if (checkForBeat(ir)) {
+      uint32_t delta = idx - lastBeat;
+      lastBeat = idx;
+      float bpm = 60.0f * PPG_HZ / (float)delta;
+      if (!gated) {
+        if (bpm >= 40 && bpm <= 180) {
+          rates[rateSpot++] = (uint8_t)bpm;
+          rateSpot %= RATE_SIZE;
+          beatAvg = 0;
+          for (int x = 0; x < RATE_SIZE; x++) beatAvg += rates[x];
+          beatAvg /= RATE_SIZE;
+          hr = beatAvg;
+        }
+      } else if (bpm >= 40 && bpm <= 180 && usableRun >= PPG_SQI_SETTLE &&
+                 (sqi >= PPG_SQI_GOOD || rateCount < RATE_SIZE ||
+                  fabsf(bpm - beatAvg) <= beatAvg * PPG_SQI_FAIR_JUMP)) {
+        rates[rateSpot] = (uint8_t)bpm;
+        rateSqi[rateSpot] = sqi;
+        rateSpot = (rateSpot + 1) % RATE_SIZE;
+        if (rateCount < RATE_SIZE) rateCount++;
+        if (rateCount == RATE_SIZE) {
+          beatAvg = 0;
+          rateQuality = 100;
+          for (int x = 0; x < RATE_SIZE; x++) {
+            beatAvg += rates[x];
+            if (rateSqi[x] < rateQuality) rateQuality = rateSqi[x];
+          }
+          beatAvg /= RATE_SIZE;
+          hr = beatAvg;
+        }
+      }
+    }
+    hrv.push(ir, idx);
+    spo2Est.push(red, ir);
+  }
+
+  void block(const int32_t* ir, const int32_t* red, uint32_t first) {
+    uint8_t sqi = 100;
+    if (gated) {
+      for (int i = 0; i < BLOCK; i++) q.push(ir[i]);
+      sqi = q.judge();
+      if (sqi < PPG_SQI_USABLE) {
+        usableRun = 0;
+        if (++skipRun == 1) spo2Est.reset();
+        if (skipRun == PPG_SQI_HOLD_BLOCKS) {
+          hr = beatAvg = 0; rateCount = 0;
+          spo2 = 0; spo2Valid = false;
+        }
+      } else {
+        skipRun = 0;
+        if (usableRun < 255) usableRun++;
+      }
+    }
+    for (int i = 0; i < BLOCK; i++) sample(ir[i], red[i], first + i, sqi);
+    hrQuality = hr > 0 ? (rateQuality < sqi ? rateQuality : sqi) : 0;
+
+    float pct;
+    if ((!gated || sqi >= PPG_SQI_USABLE) && spo2Est.estimate(&pct, &spo2R)) {
+      float w = !gated || sqi >= PPG_SQI_GOOD ? 0.3f : 0.1f;
+      spo2 = spo2Valid ? (uint8_t)((1 - w) * spo2 + w * pct) : (uint8_t)pct;
+      spo2Valid = true;
+    }
+    if (gated && sqi < PPG_SQI_USABLE && (skipRun & 3) != 1) return;
+    uint32_t last = first + BLOCK - 1;
+    HrvStats a = hrv.stats(last, HRV_SHORT_BUCKETS), b = hrv.stats(last, HRV_BUCKETS);
+    sink += a.rmssdMs + b.rmssdMs;
+  }
+
+  bool alarmReady() const { return hr > 0 && (!gated || hrQuality >= PPG_SQI_GOOD); }
+
+  float sink = 0;
+};
+
+// Once a second, as taskAlerts()
+struct Alarm {
+  int      bad = 0;
+  uint32_t holdUntil = 0;
+  bool tick(const Path& p, uint32_t sec) {
+    if (sec < holdUntil || !p.alarmReady()) return false;
+    if (p.hr > HR_HIGH || p.hr < HR_LOW) {
+      if (++bad >= 3) { bad = 0; holdUntil = sec + ALARM_HOLD_S; return true; }
+    } else {
+      bad = 0;
+    }
+    return false;
+  }
+};
+
+struct Score {
+  uint32_t secs = 0, settled = 0, falseAlarms = 0, trueAlarms = 0, shown = 0;
+  uint32_t blocks = 0, skipped = 0;
+  double   hrErr = 0;
+};
+
+struct Spo2Sec { uint8_t act, pct; };
+
+struct Run {
+  Score    act[ACTS];
+  std::vector<bool> caught;        // per tachy episode
+  std::vector<Spo2Sec> spo2;       // settled seconds with a reading
+
+  // Mean distance of the SpO2 shown during an activity from its
+  // mean at rest: the true SpO2 never changes, so this is swing,
+  // whatever the calibration
+  double spo2Swing(uint8_t act) const {
+    double rest = 0, d = 0;
+    uint32_t nr = 0, n = 0;
+    for (const Spo2Sec& s : spo2) if (s.act == ACT_REST) { rest += s.pct; nr++; }
+    if (nr) rest /= nr;
+    for (const Spo2Sec& s : spo2) if (s.act == act) { d += fabs(s.pct - rest); n++; }
+    return n ? d / n : 0;
+  }
+};
+
+static void replay(const Trace& tr, bool gated, Run& out) {
+  Path* p = new Path(gated);
+  Alarm alarm;
+  uint32_t blocks = (uint32_t)(tr.ir.size() / BLOCK), episodes = 0;
+  for (uint32_t e : tr.episode) if (e > episodes) episodes = e;
+  out.caught.assign(episodes + 1, false);
+
+  for (uint32_t b = 0; b < blocks; b++) {
+    uint32_t first = b * BLOCK, sec = first / PPG_HZ;
+    uint8_t a = tr.act[sec];
+    // The IMU samples of the same 250 ms went in first (taskImu)
+    if (gated)
+      for (uint32_t j = 0; j < BLOCK * IMU_HZ / PPG_HZ; j++) p->q.motion(tr.g[first * 2 + j]);
+
+    p->block(&tr.ir[first], &tr.red[first], first);
+    out.act[a].blocks++;
+    if (gated && !p->q.usable()) out.act[a].skipped++;
+
+    if ((b + 1) % (PPG_HZ / BLOCK)) continue;
+    Score& s = out.act[a];
+    s.secs++;
+    bool settled = sec >= SETTLE_S && tr.act[sec - SETTLE_S] == a;
+    if (settled) {
+      s.settled++;
+      if (p->hr > 0) { s.shown++; s.hrErr += fabs(p->hr - tr.hr[sec]); }
+      if (p->spo2Valid) out.spo2.push_back({ a, p->spo2 });
+    }
+    if (alarm.tick(*p, sec)) {
+      bool real = tr.hr[sec] > HR_HIGH || tr.hr[sec] < HR_LOW;
+      if (real) { s.trueAlarms++; out.caught[tr.episode[sec]] = true; }
+      else s.falseAlarms++;
+    }
+  }
+
+  if (p->sink < 0) printf("?");
+  delete p;
+}
+
+// ns per block over the whole trace: the path with the
+// accelerometer feed (gated), or the quality stage alone
+static double cost(const Trace& tr, bool gated, bool sqiOnly) {
+  uint32_t blocks = (uint32_t)(tr.ir.size() / BLOCK);
+  Path* p = new Path(gated);
+  uint64_t t0 = nowNs();
+  for (uint32_t b = 0; b < blocks; b++) {
+    uint32_t first = b * BLOCK;
+    if (gated)
+      for (uint32_t j = 0; j < BLOCK * IMU_HZ / PPG_HZ; j++) p->q.motion(tr.g[first * 2 + j]);
+    if (sqiOnly) {
+      for (int i = 0; i < BLOCK; i++) p->q.push(tr.ir[first + i]);
+      p->q.judge();
+    } else {
+      p->block(&tr.ir[first], &tr.red[first], first);
+    }
+  }
+  double ns = (double)(nowNs() - t0) / blocks;
+  if (p->sink < 0) printf("?");
+  delete p;
+  return ns;
+}
+
+// ── Recordings ───────────────────────────────────────────────
+// A capture carries both streams in time order; no truth, so
+// only alarms and cost
+static int replayCaptures(int argc, char** argv) {
+  printf("PPG signal quality (tiga_ppg_sqi.h) on %d capture(s)\n", argc - 1);
+  printf("  %-28s %8s  %10s  %10s  %8s  %8s\n", "capture", "minutes", "v6a alarms", "gated", "skipped", "saved");
+  for (int f = 1; f < argc; f++) {
+    Path* path[2] = { new Path(false), new Path(true) };
+    Alarm alarm[2];
+    uint32_t alarms[2] = { 0, 0 };
+    uint64_t ns[2] = { 0, 0 };
+    for (int k = 0; k < 2; k++) {
+      CaptureReader rd;
+      if (!rd.open(argv[f])) { fprintf(stderr, "bench_ppg_sqi: %s unreadable\n", argv[f]); return 2; }
+      CapRecord r;
+      ImuSample burst[CAP_IMU_MAX_SAMPLES];
+      int32_t ir[BLOCK], red[BLOCK];
+      uint32_t n = 0, first = 0, blocks = 0;
+      while (rd.next(r)) {
+        if (r.type == CAP_IMU && k == 1) {
+          uint8_t c = capImuCount(r);
+          for (uint8_t i = 0; i < c; i++) capImuSample(r, i, burst[i]);
+          motionBatch(burst, c);
+          for (uint8_t i = 0; i < c; i++) path[k]->q.motion(burst[i].g);
+        }
+        if (r.type != CAP_PPG) continue;
+        if (capPpgLost(r)) { n = 0; path[k]->q.reset(); path[k]->spo2Est.reset(); }
+        for (uint8_t i = 0; i < capPpgCount(r); i++) {
+          if (!n) first = capPpgFirst(r) + i;
+          ir[n] = (int32_t)capPpgIr(r, i); red[n] = (int32_t)capPpgRed(r, i);
+          if (++n < BLOCK) continue;
+          n = 0;
+          uint64_t t0 = nowNs();
+          path[k]->block(ir, red, first);
+          ns[k] += nowNs() - t0;
+          if (++blocks % (PPG_HZ / BLOCK) == 0 && alarm[k].tick(*path[k], blocks / 4)) alarms[k]++;
+        }
+      }
+      if (k == 1)
+        printf("  %-28s %8.1f  %10u  %10u  %7.0f%%  %7.0f%%\n", argv[f], blocks / 240.0,
+               alarms[0], alarms[1], 100.0 * path[1]->q.skipped / (blocks ? blocks : 1),
+               ns[0] ? 100.0 * (1 - (double)ns[1] / ns[0]) : 0.0);
+    }
+    delete path[0]; delete path[1];
+  }
+  return 0;
+}
+
+int main(int argc, char** argv) {
+  if (argc > 1) return replayCaptures(argc, argv);
+  int fail = 0;
+  srand(22);
+  Trace tr;
+  makeTrace(tr, BENCH_HOURS * 3600);
+
+  Run old, gated;
+  replay(tr, false, old);
+  replay(tr, true, gated);
+
+  printf("PPG signal quality (tiga_ppg_sqi.h): %d h of wrist PPG + accelerometer, "
+         "replayed in 250 ms blocks\n", BENCH_HOURS);
+  printf("  %-8s %5s | %-29s | %-37s\n", "", "", "            v6a", "             gated");
+  printf("  %-8s %5s | %8s %6s %6s %5s | %8s %6s %6s %5s %7s\n", "activity", "hours",
+         "alarms/h", "shown", "HR err", "swing", "alarms/h", "shown", "HR err", "swing", "skipped");
+  double oldFalse = 0, newFalse = 0, hours = 0;
+  for (int a = 0; a < ACTS; a++) {
+    const Score& o = old.act[a];
+    const Score& g = gated.act[a];
+    if (!o.secs) continue;
+    double h = o.secs / 3600.0;
+    hours += h;
+    oldFalse += o.falseAlarms; newFalse += g.falseAlarms;
+    printf("  %-8s %5.2f | %8.2f %5.0f%% %6.1f %5.1f | %8.2f %5.0f%% %6.1f %5.1f %6.0f%%\n",
+           actName[a], h,
+           o.falseAlarms / h, 100.0 * o.shown / o.settled, o.shown ? o.hrErr / o.shown : 0,
+           old.spo2Swing(a),
+           g.falseAlarms / h, 100.0 * g.shown / g.settled, g.shown ? g.hrErr / g.shown : 0,
+           gated.spo2Swing(a),
+           100.0 * g.skipped / (g.blocks ? g.blocks : 1));
+    if (a == ACT_REST || a == ACT_AF) {
+      if (g.shown < 0.85 * g.settled || g.hrErr / g.shown > o.hrErr / o.shown + 0.5) fail = 1;
+    }
+    if ((a == ACT_WALK || a == ACT_GESTURE) && gated.spo2Swing(a) > old.spo2Swing(a)) fail = 1;
+  }
+  uint32_t episodes = (uint32_t)old.caught.size() - 1, oldCaught = 0, newCaught = 0;
+  for (uint32_t e = 1; e <= episodes; e++) { oldCaught += old.caught[e]; newCaught += gated.caught[e]; }
+  printf("  false alarms: v6a %.0f (%.2f/h), gated %.0f (%.2f/h); tachycardias alarmed: "
+         "v6a %u/%u, gated %u/%u\n", oldFalse, oldFalse / hours, newFalse, newFalse / hours,
+         oldCaught, episodes, newCaught, episodes);
+  if (newFalse / hours > 0.5 || newFalse > oldFalse / 4 || newCaught < episodes) fail = 1;
+
+  // Best of five, taking turns, so both see the same machine
+  double oldNs = 1e18, newNs = 1e18, sqiNs = 1e18;
+  for (int pass = 0; pass < 5; pass++) {
+    oldNs = fmin(oldNs, cost(tr, false, false));
+    newNs = fmin(newNs, cost(tr, true, false));
+    sqiNs = fmin(sqiNs, cost(tr, true, true));
+  }
+  printf("  CPU per block: v6a %.0f ns, gated %.0f ns (quality stage %.0f ns) — %.0f%% saved\n",
+         oldNs, newNs, sqiNs, 100 * (1 - newNs / oldNs));
+  if (newNs >= oldNs) fail = 1;
+
+  size_t ram = sizeof(PpgQuality);
+  if (ram > BENCH_RAM_MAX) fail = 1;
+  printf("  RAM %zu bytes, no heap\n", ram);
+  printf("  %s\n", fail ? "FAILED" : "all checks passed");
+  return fail;
+}
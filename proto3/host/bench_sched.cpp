@@ -0,0 +1,317 @@
+// ============================================================
+// bench_sched.cpp — scheduler timing on a virtual clock
+// ============================================================
+// Scheduler runs against a virtual microsecond clock: the idle
+// hook moves it to the next due time, and a task "takes" as long
+// as it moves it. So every start time, jitter, overrun and missed
+// period is known exactly in advance, and checked:
+//
+//   idle tasks start on time, on their grid, and the idle time
+//   adds up; a more urgent task due at the same moment goes first
+//   and the other's jitter is exactly its run time; equal
+//   priorities go earliest-due first; runs over budget are
+//   counted as overruns and their times kept; a stall of several
+//   periods skips them, counted as missed, and the task comes back
+//   on its original grid, not late by the stall; a period-0 task
+//   runs whenever nothing else is due; trigger() and enable();
+//   the clock wrapping past 2^32 µs; add() past SCHED_MAX_TASKS
+//   refused and counted.
+//
+// Then ns of scheduler overhead per task run on the device's
+// core 1 table.
+//
+//   make bench
+// ============================================================
+
+#include "tiga_sched.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <vector>
+
+static uint32_t vnow = 0;
+static uint32_t vclock()          { return vnow; }
+static void     vidle(uint32_t us) { vnow += us; }
+static const SchedClock vclk = { vclock, vidle, nullptr };
+
+static uint64_t nowNs() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+// What each task does when it runs: take `costUs`, or `stallUs`
+// on its `stallRun`-th run; its start times are kept
+struct Probe {
+  uint32_t costUs  = 0;
+  uint32_t stallUs = 0, stallRun = 0;
+  std::vector<uint32_t> starts;
+};
+static Probe probes[SCHED_MAX_TASKS];
+
+template <int I> static void probeFn() {
+  Probe& p = probes[I];
+  p.starts.push_back(vnow);
+  vnow += (p.stallRun && p.starts.size() == p.stallRun) ? p.stallUs : p.costUs;
+}
+static const SchedTaskFn probeFns[] = {
+  probeFn<0>, probeFn<1>, probeFn<2>, probeFn<3>, probeFn<4>,
+  probeFn<5>, probeFn<6>, probeFn<7>, probeFn<8>, probeFn<9>,
+  probeFn<10>, probeFn<11>, probeFn<12>, probeFn<13>, probeFn<14>,
+  probeFn<15>, probeFn<16>, probeFn<17>, probeFn<18>, probeFn<19>,
+};
+
+static void clearProbes() {
+  for (Probe& p : probes) p = Probe();
+}
+
+// Through endUs, a task due then included. With nothing enabled
+// runOnce() doesn't wait: skip past it.
+static void runUntil(Scheduler& s, uint32_t endUs) {
+  while ((int32_t)(vnow - endUs) <= 0) {
+    uint32_t was = vnow;
+    if (!s.runOnce() && vnow == was) vnow = endUs + 1;
+  }
+}
+
+static int fail = 0;
+static void report(const char* name, bool ok, const char* detail) {
+  printf("  %-44s %-34s %s\n", name, detail, ok ? "ok" : "FAIL");
+  fail |= !ok;
+}
+
+// Idle tasks: on time, on their grid, idle adds up
+static void onTime() {
+  clearProbes();
+  vnow = 1000;
+  Scheduler s(vclk);
+  s.add("a", probeFns[0], 10, 0, 100);
+  s.add("b", probeFns[1], 25, 1, 100);
+  probes[0].costUs = 50;
+  probes[1].costUs = 80;
+  s.start();
+  runUntil(s, 1000 + 1000000 + 100);      // b's last, behind a's
+  const SchedTask& a = s.task(0);
+  const SchedTask& b = s.task(1);
+  bool grid = true;
+  for (size_t i = 0; i < probes[0].starts.size(); i++)
+    grid &= probes[0].starts[i] == 1000 + 10000 * (i + 1);
+  // b waits for a where their grids meet, every 50 ms
+  uint64_t busy = a.runs * 50ULL + b.runs * 80ULL;
+  bool ok = grid && a.runs == 100 && b.runs == 40 && a.missed == 0 && b.missed == 0 &&
+            a.overruns == 0 && a.maxJitterUs == 0 && b.maxJitterUs == 50 &&
+            s.idleTotalUs + busy == vnow - 1000;
+  char d[64];
+  snprintf(d, sizeof(d), "runs %u/%u, idle %llu ms", a.runs, b.runs,
+           (unsigned long long)(s.idleTotalUs / 1000));
+  report("on time, on the grid, idle adds up", ok, d);
+}
+
+// Same due time: priority first, the other waits exactly its run
+static void priorityJitter() {
+  clearProbes();
+  vnow = 0;
+  Scheduler s(vclk);
+  s.add("low",  probeFns[0], 20, 3, 5000);
+  s.add("high", probeFns[1], 20, 0, 5000);
+  probes[0].costUs = 700;
+  probes[1].costUs = 3000;
+  s.start();
+  runUntil(s, 200000 + 3000);
+  const SchedTask& lo = s.task(0);
+  const SchedTask& hi = s.task(1);
+  bool order = true;
+  for (size_t i = 0; i < probes[0].starts.size(); i++)
+    order &= probes[0].starts[i] == probes[1].starts[i] + 3000;
+  bool ok = order && lo.runs == 10 && hi.maxJitterUs == 0 &&
+            lo.maxJitterUs == 3000 && lo.sumJitterUs == 3000ULL * lo.runs;
+  char d[64];
+  snprintf(d, sizeof(d), "low jitter %u µs, high %u µs", lo.maxJitterUs, hi.maxJitterUs);
+  report("priority first; jitter is the wait", ok, d);
+}
+
+// Equal priority: the one due first runs first, whatever the
+// order they were added in
+static void earliestFirst() {
+  clearProbes();
+  vnow = 0;
+  Scheduler s(vclk);
+  s.add("b",   probeFns[0], 20, 2, 1000);   // due 20, 40, 60
+  s.add("a",   probeFns[1], 28, 2, 1000);   // due 28, 56
+  s.add("hog", probeFns[2], 50, 0, 1000);   // 50-62 ms
+  probes[0].costUs = 100;
+  probes[1].costUs = 100;
+  probes[2].costUs = 12000;
+  s.start();
+  runUntil(s, 63000);
+  // At 62 ms both are due: a (since 56) before b (since 60)
+  const std::vector<uint32_t>& a = probes[1].starts;
+  const std::vector<uint32_t>& b = probes[0].starts;
+  bool ok = a.size() == 2 && b.size() == 3 && a[1] == 62000 && b[2] == 62100 &&
+            s.task(1).maxJitterUs == 6000 && s.task(0).maxJitterUs == 2100;
+  char d[64];
+  snprintf(d, sizeof(d), "a at %u µs, b at %u µs", a.size() > 1 ? a[1] : 0, b.size() > 2 ? b[2] : 0);
+  report("equal priority: earliest due first", ok, d);
+}
+
+// Runs over budget are overruns; times kept
+static void overruns() {
+  clearProbes();
+  vnow = 0;
+  Scheduler s(vclk);
+  s.add("t", probeFns[0], 10, 0, 1000);
+  probes[0].costUs  = 600;
+  probes[0].stallUs = 1500;
+  probes[0].stallRun = 7;
+  s.start();
+  runUntil(s, 500000);
+  const SchedTask& t = s.task(0);
+  bool ok = t.overruns == 1 && t.maxRunUs == 1500 && t.missed == 0 &&
+            t.sumRunUs == 600ULL * (t.runs - 1) + 1500 && t.runs == 50;
+  char d[64];
+  snprintf(d, sizeof(d), "%u overrun, max %u µs of %u runs", t.overruns, t.maxRunUs, t.runs);
+  report("over budget counted, run times kept", ok, d);
+}
+
+// A stall of several periods: skipped, counted, back on the grid
+static void catchUp() {
+  clearProbes();
+  vnow = 500;
+  Scheduler s(vclk);
+  s.add("t", probeFns[0], 10, 0, 1000);
+  probes[0].costUs   = 200;
+  probes[0].stallUs  = 35000;      // runs at 50.5 ms, done at 85.5
+  probes[0].stallRun = 5;
+  s.start();
+  runUntil(s, 500 + 200000);
+  const SchedTask& t = s.task(0);
+  // Due 60.5, 70.5, 80.5 have gone by: 3 missed, next at 90.5
+  const std::vector<uint32_t>& st = probes[0].starts;
+  bool grid = true;
+  for (uint32_t x : st) grid &= (x - 500) % 10000 == 0;
+  bool ok = t.missed == 3 && grid && st.size() > 5 && st[5] == 500 + 90000 &&
+            t.runs == 20 - 3 && t.maxJitterUs == 0 && t.overruns == 1;
+  char d[64];
+  snprintf(d, sizeof(d), "%u missed, next run at %.1f ms", t.missed, st.size() > 5 ? (st[5] - 500) / 1000.0 : 0);
+  report("stall: periods skipped, back on the grid", ok, d);
+
+  // Late but inside its period: no period missed, grid kept
+  clearProbes();
+  vnow = 0;
+  Scheduler s2(vclk);
+  s2.add("t", probeFns[0], 10, 1, 1000);
+  s2.add("hog", probeFns[1], 50, 0, 1000);
+  probes[0].costUs = 100;
+  probes[1].costUs = 8000;         // t, due with it, starts 8 ms late
+  s2.start();
+  runUntil(s2, 200000 + 8000);
+  const SchedTask& t2 = s2.task(0);
+  grid = true;
+  for (uint32_t x : probes[0].starts) grid &= x % 10000 == 0 || x % 50000 == 8000;
+  ok = t2.missed == 0 && grid && t2.runs == 20 && t2.maxJitterUs == 8000;
+  snprintf(d, sizeof(d), "%u missed, jitter %u µs", t2.missed, t2.maxJitterUs);
+  report("late inside its period: nothing missed", ok, d);
+}
+
+// Period 0: whenever nothing else is due, never counted missed
+static void background() {
+  clearProbes();
+  vnow = 0;
+  Scheduler s(vclk);
+  s.add("t",  probeFns[0], 10, 0, 1000);
+  s.add("bg", probeFns[1], 0, 5, 0);
+  probes[0].costUs = 100;
+  probes[1].costUs = 1000;
+  s.start();
+  runUntil(s, 100000 + 1000);
+  const SchedTask& t = s.task(0);
+  const SchedTask& bg = s.task(1);
+  bool ok = t.missed == 0 && bg.missed == 0 && t.runs == 10 && s.idleTotalUs == 0 &&
+            bg.runs >= 85 && t.maxJitterUs < 1000;
+  char d[64];
+  snprintf(d, sizeof(d), "%u background runs, jitter %u µs", bg.runs, t.maxJitterUs);
+  report("period 0 fills the gaps", ok, d);
+}
+
+// trigger() runs it now; enable() re-anchors
+static void triggerEnable() {
+  clearProbes();
+  vnow = 0;
+  Scheduler s(vclk);
+  int id = s.add("t", probeFns[0], 100, 0, 1000);
+  s.start();
+  vnow = 30000;                    // due at 100 ms; wanted now
+  s.trigger(id);
+  s.runOnce();
+  bool ok = probes[0].starts.size() == 1 && probes[0].starts[0] == 30000 &&
+            s.task(0).dueUs == 130000;
+  s.enable(id, false);
+  runUntil(s, 500000);
+  ok &= probes[0].starts.size() == 1;
+  vnow = 503000;
+  s.enable(id, true);
+  runUntil(s, 603000);
+  ok &= probes[0].starts.size() == 2 && probes[0].starts[1] == 603000;
+  report("trigger() now, enable() a period on", ok, "");
+}
+
+// The clock wraps every ~71.6 min
+static void wrap() {
+  clearProbes();
+  vnow = 0xFFFFFFFFu - 45000;
+  Scheduler s(vclk);
+  s.add("t", probeFns[0], 10, 0, 1000);
+  probes[0].costUs = 100;
+  s.start();
+  runUntil(s, vnow + 100000);
+  const SchedTask& t = s.task(0);
+  bool ok = t.runs == 10 && t.missed == 0 && t.maxJitterUs == 0;
+  char d[64];
+  snprintf(d, sizeof(d), "%u runs across the wrap", t.runs);
+  report("micros() wrapping", ok, d);
+}
+
+static void tableFull() {
+  Scheduler s(vclk);
+  int last = 0;
+  for (int i = 0; i < SCHED_MAX_TASKS + 2; i++) last = s.add("t", probeFns[0], 10, 0, 0);
+  bool ok = last == -1 && s.count() == SCHED_MAX_TASKS && s.refused == 2;
+  char d[64];
+  snprintf(d, sizeof(d), "%u in, %u refused", s.count(), s.refused);
+  report("add() past SCHED_MAX_TASKS refused", ok, d);
+}
+
+// Host CPU: the device's core 1 table, each task a no-op
+static void overhead() {
+  clearProbes();
+  vnow = 0;
+  Scheduler s(vclk);
+  const uint32_t periods[16] = { 10, 10, 20, 10, 20, 20, 100, 100, 1000, 1000, 1000, 1000, 20, 10, 2000, 20 };
+  for (int i = 0; i < 16; i++) s.add("t", probeFns[i], periods[i], i % 6, 0);
+  s.start();
+  uint32_t runs = 0;
+  uint64_t t0 = nowNs();
+  for (int i = 0; i < 2000000; i++) runs += s.runOnce();
+  uint64_t ns = nowNs() - t0;
+  printf("  CPU (host): %.1f ns per runOnce(), %.1f ns per task run, 16 tasks\n",
+         (double)ns / 2000000, (double)ns / runs);
+  printf("  RAM %zu bytes (Scheduler, %d tasks)\n", sizeof(Scheduler), SCHED_MAX_TASKS);
+}
+
+int main() {
+  printf("Scheduler on a virtual clock\n");
+  onTime();
+  priorityJitter();
+  earliestFirst();
+  overruns();
+  catchUp();
+  background();
+  triggerEnable();
+  wrap();
+  tableFull();
+  clearProbes();
+  overhead();
+  printf("  %s\n", fail ? "FAILED" : "all checks passed");
+  return fail;
+}
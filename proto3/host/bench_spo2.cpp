@@ -0,0 +1,88 @@
+// ============================================================
+// bench_spo2.cpp — streaming vs rescan SpO2 window
+// ============================================================
+// Feeds a synthetic 100 Hz PPG (pulse, respiration, drift, noise,
+// a few motion spikes) through Spo2Estimator and through the
+// reference spo2Batch() rescan of the same window, checks they
+// agree on every sample, and reports ns/sample for each.
+//
+//   make bench
+// ============================================================
+
+#include "tiga_spo2.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <vector>
+
+#define BENCH_SAMPLES  200000     // ~33 min at 100 Hz
+
+static uint64_t nowNs() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static void synth(std::vector<int32_t>& red, std::vector<int32_t>& ir) {
+  uint32_t rng = 12345;
+  auto noise = [&rng]() {
+    rng ^= rng << 13; rng ^= rng >> 17; rng ^= rng << 5;
+    return (int32_t)(rng % 61) - 30;
+  };
+  for (uint32_t i = 0; i < BENCH_SAMPLES; i++) {
+    float t = i / 100.0f;
+    float ph = fmodf(t * 1.2f, 1.0f);
+    float a = (ph - 0.15f) / 0.07f, b = (ph - 0.45f) / 0.09f;
+    float p = expf(-a * a) + 0.35f * expf(-b * b);
+    float base = 300.0f * sinf(6.2832f * 0.25f * t) + 2000.0f * sinf(6.2832f * t / 600.0f);
+    float spike = (i % 9000) < 20 ? 5000.0f : 0.0f;
+    ir.push_back((int32_t)(120000 + base - 700 * p + spike) + noise());
+    red.push_back((int32_t)(90000 + 0.75f * base - 290 * p + 0.75f * spike) + noise());
+  }
+}
+
+static int run(const std::vector<int32_t>& red, const std::vector<int32_t>& ir, uint16_t window) {
+  static Spo2Estimator est(window);
+  est.setWindow(window);
+
+  // Streaming
+  std::vector<float> rs(red.size());
+  uint64_t t0 = nowNs();
+  for (size_t i = 0; i < red.size(); i++) {
+    est.push(red[i], ir[i]);
+    rs[i] = est.ratio();
+  }
+  uint64_t streamNs = nowNs() - t0;
+
+  // Rescan of the trailing window after every sample
+  std::vector<float> rb(red.size(), 0.0f);
+  t0 = nowNs();
+  for (size_t i = window - 1; i < red.size(); i++)
+    rb[i] = spo2Batch(&red[i + 1 - window], &ir[i + 1 - window], window);
+  uint64_t batchNs = nowNs() - t0;
+
+  size_t bad = 0;
+  for (size_t i = 0; i < red.size(); i++) {
+    if (fabsf(rs[i] - rb[i]) > 1e-6f * (1.0f + fabsf(rb[i]))) {
+      if (!bad) printf("  window %u: sample %zu streaming R %.6f, rescan R %.6f\n",
+                       window, i, rs[i], rb[i]);
+      bad++;
+    }
+  }
+  printf("  %6u %10.1f %10.1f %8.1fx   %s\n", window,
+         (double)streamNs / red.size(), (double)batchNs / red.size(),
+         streamNs ? (double)batchNs / streamNs : 0.0, bad ? "MISMATCH" : "match");
+  return bad ? 1 : 0;
+}
+
+int main() {
+  std::vector<int32_t> red, ir;
+  synth(red, ir);
+  printf("SpO2 window, %d samples\n", BENCH_SAMPLES);
+  printf("  window  stream ns  rescan ns  speed-up   check\n");
+  int fail = 0;
+  for (uint16_t w : {25, 100, 200, 400, 512}) fail |= run(red, ir, w);
+  return fail;
+}
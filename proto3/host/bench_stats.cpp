@@ -0,0 +1,211 @@
+// ============================================================
+// bench_stats.cpp — statistics store against brute force
+// ============================================================
+// 30 hours of per-second readings for every metric go through
+// tiga_stats.h as taskStats() pushes them: HR wandering with the
+// time of day and gaps where the finger was off, SpO2 with dips,
+// steps in walks, altitude in steps of stairs. Every second is
+// also kept in a plain array, and each check recomputes the
+// answer from that array.
+//
+//   session    count, min, max, sums since reset; mean and
+//              variance against two-pass doubles
+//   last       1 s to 24 h back, at random moments
+//   ranges     random [from, to) over 26 h: exact where the
+//              store holds seconds, otherwise the ends rounded
+//              out to the minute or hour — compared to brute
+//              force over the rounded range
+//   slots      every whole minute and hour still in its ring
+//
+// Also: ns per push() (all metrics), per range() over an hour
+// and a day, against v6a's running average (a multiply and a
+// divide per beat), and how far that float average drifts from
+// the exact mean over a day. sizeof(StatsStore) is checked
+// against the figure in the header.
+//
+//   make bench
+// ============================================================
+
+#include "tiga_stats.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <vector>
+
+#define BENCH_HOURS     30
+#define BENCH_RAM_MAX   9000          // the header says 8.8 KB
+
+static uint64_t nowNs() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static uint32_t rnd(uint32_t n) { return (uint32_t)(((uint64_t)rand() * n) / ((uint64_t)RAND_MAX + 1)); }
+
+// ── Readings ─────────────────────────────────────────────────
+static std::vector<int16_t> series[STAT_METRICS];
+
+static void makeSeries(uint32_t secs) {
+  int16_t alt = 0;
+  bool worn = true, walking = false;
+  for (uint32_t t = 0; t < secs; t++) {
+    if (rnd(1800) == 0) worn = !worn;
+    if (rnd(600) == 0) walking = !walking;
+    double day = sin(2 * 3.14159265 * t / 86400.0);
+    int16_t hr = (int16_t)lround(68 + 8 * day + (walking ? 25 : 0) + rnd(9) - 4.0);
+    int16_t spo2 = (int16_t)(97 - rnd(3) - (rnd(5000) == 0 ? 6 : 0));
+    int16_t steps = walking ? (int16_t)(1 + rnd(2)) : 0;
+    if (walking && rnd(400) == 0) alt += rnd(2) ? 30 : -30;
+    series[STAT_HR].push_back(worn ? hr : STATS_NONE);
+    series[STAT_SPO2].push_back(worn && rnd(4) ? spo2 : STATS_NONE);
+    series[STAT_STEPS].push_back(steps);
+    series[STAT_ALT].push_back(alt);
+  }
+}
+
+static StatAgg brute(int m, uint32_t from, uint32_t to) {
+  StatAgg a;
+  a.clear();
+  for (uint32_t t = from; t < to; t++)
+    if (series[m][t] != STATS_NONE) a.add(series[m][t]);
+  return a;
+}
+
+// The two-pass mean and variance in doubles, to check StatAgg's
+static void twoPass(int m, uint32_t from, uint32_t to, double* mean, double* var) {
+  double s = 0, ss = 0;
+  uint32_t n = 0;
+  for (uint32_t t = from; t < to; t++) if (series[m][t] != STATS_NONE) { s += series[m][t]; n++; }
+  *mean = n ? s / n : 0;
+  for (uint32_t t = from; t < to; t++)
+    if (series[m][t] != STATS_NONE) ss += (series[m][t] - *mean) * (series[m][t] - *mean);
+  *var = n > 1 ? ss / (n - 1) : 0;
+}
+
+static bool same(const StatAgg& a, const StatAgg& b) {
+  if (a.n != b.n) return false;
+  if (!a.n) return true;
+  return a.lo == b.lo && a.hi == b.hi && a.sum == b.sum && a.sq == b.sq;
+}
+
+// What range() should return, second by second: each second in
+// [from, to) brings in the finest slot still holding it — itself,
+// its minute or its hour — and each slot counts once
+static StatAgg expected(int m, uint32_t from, uint32_t to, uint32_t now) {
+  StatAgg a;
+  a.clear();
+  uint32_t done = 0;                     // seconds before this already in
+  for (uint32_t t = from; t < to; ) {
+    uint32_t s0, s1;
+    if (now - t <= STATS_SECS)                          { s0 = t; s1 = t + 1; }
+    else if (now / 60 - t / 60 <= STATS_MINS)           { s0 = t / 60 * 60; s1 = s0 + 60; }
+    else if (now / 3600 - t / 3600 <= STATS_HOURS)      { s0 = t / 3600 * 3600; s1 = s0 + 3600; }
+    else { t = (t / 3600 + 1) * 3600; done = t; continue; }
+    if (s0 < done) s0 = done;
+    if (s1 > s0) a.merge(brute(m, s0, s1));
+    done = t = s1;
+  }
+  return a;
+}
+
+int main() {
+  const uint32_t total = BENCH_HOURS * 3600;
+  int fail = 0;
+  srand(20);
+  makeSeries(total);
+
+  StatsStore* st = new StatsStore;
+  uint32_t checks = 0, bad = 0, slots = 0;
+  double worstMean = 0, worstVar = 0;
+  int16_t v[STAT_METRICS];
+
+  printf("Statistics store (tiga_stats.h): %d h of seconds, %d metrics, brute force alongside\n",
+         BENCH_HOURS, STAT_METRICS);
+
+  uint64_t pushNs = 0;
+  for (uint32_t t = 0; t < total; t++) {
+    for (int m = 0; m < STAT_METRICS; m++) v[m] = series[m][t];
+    uint64_t n0 = nowNs();
+    st->push(v);
+    pushNs += nowNs() - n0;
+    uint32_t now = t + 1;
+
+    if (rnd(60) == 0) {
+      int m = rnd(STAT_METRICS);
+      // last(): any span up to a day
+      uint32_t span = 1 + rnd(86400);
+      uint32_t from = span < now ? now - span : 0;
+      StatAgg got = st->last(m, span);
+      checks++;
+      if (!same(got, expected(m, from, now, now))) bad++;
+      // range(): anywhere in the last 26 h
+      uint32_t a = now > 26 * 3600 ? now - rnd(26 * 3600) : rnd(now);
+      uint32_t b = a + rnd(now - a + 1);
+      checks++;
+      if (!same(st->range(m, a, b), expected(m, a, b, now))) bad++;
+    }
+
+    // Every whole minute and hour still held, once an hour
+    if (now % 3600 == 0) {
+      for (int m = 0; m < STAT_METRICS; m++) {
+        StatAgg s;
+        for (uint32_t i = 0; i < now / 60; i++)
+          if (st->minute(m, i, &s)) { slots++; if (!same(s, brute(m, i * 60, i * 60 + 60))) bad++; }
+        for (uint32_t i = 0; i < now / 3600; i++)
+          if (st->hour(m, i, &s)) { slots++; if (!same(s, brute(m, i * 3600, i * 3600 + 3600))) bad++; }
+      }
+    }
+  }
+
+  for (int m = 0; m < STAT_METRICS; m++) {
+    checks++;
+    if (!same(st->session(m), brute(m, 0, total))) bad++;
+    double mean, var;
+    twoPass(m, 0, total, &mean, &var);
+    worstMean = fmax(worstMean, fabs(st->session(m).mean() - mean));
+    worstVar  = fmax(worstVar, fabs(st->session(m).var() - var) / fmax(var, 1.0));
+  }
+  if (bad) fail = 1;
+  printf("  %u ranges and session totals, %u minute / hour slots: %u wrong\n", checks, slots, bad);
+  if (worstMean > 1e-3 || worstVar > 1e-4) fail = 1;
+  printf("  mean within %.1e, variance within %.1e (relative) of two-pass doubles\n",
+         worstMean, worstVar);
+
+  // ── v6a's running average ──────────────────────────────────
+  // avgHR = (avgHR × n + hr) / (n + 1) per beat, ~1.2 beats a second
+  float avg = 0;
+  int n = 0;
+  uint64_t t0 = nowNs();
+  for (uint32_t t = 0; t < 24 * 3600; t++) {
+    if (series[STAT_HR][t] == STATS_NONE) continue;
+    avg = (avg * n + series[STAT_HR][t]) / (n + 1);
+    n++;
+  }
+  uint64_t oldNs = nowNs() - t0;
+  StatAgg day = brute(STAT_HR, 0, 24 * 3600);
+  printf("  v6a running average over a day: %.3f bpm off the exact mean, %.1f ns per update\n",
+         fabs(avg - (double)day.sum / day.n), (double)oldNs / n);
+
+  // ── Cost ───────────────────────────────────────────────────
+  volatile int64_t sink = 0;
+  const int Q = 100000;
+  t0 = nowNs();
+  for (int i = 0; i < Q; i++) sink = sink + st->last(STAT_HR, 3600 - (i & 63)).sum;
+  double hourNs = (double)(nowNs() - t0) / Q;
+  t0 = nowNs();
+  for (int i = 0; i < Q; i++) sink = sink + st->last(STAT_HR, 86400 - (i & 63)).sum;
+  double dayNs = (double)(nowNs() - t0) / Q;
+  printf("  push() %.1f ns for %d metrics; range() %.0f ns over an hour, %.0f ns over a day\n",
+         (double)pushNs / total, STAT_METRICS, hourNs, dayNs);
+
+  size_t ram = sizeof(StatsStore);
+  if (ram > BENCH_RAM_MAX) fail = 1;
+  printf("  RAM %zu bytes (%d s, %d min, %d h rings), no heap\n",
+         ram, STATS_SECS, STATS_MINS, STATS_HOURS);
+  printf("  %s\n", fail ? "FAILED" : "all checks passed");
+  delete st;
+  return fail;
+}
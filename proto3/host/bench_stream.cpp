@@ -0,0 +1,373 @@
+// ============================================================
+// bench_stream.cpp — raw waveform streaming over a modelled link
+// ============================================================
+// StreamSender on the watch, StreamReceiver on the phone, fed the
+// way the firmware feeds them: a 25-sample PPG block every 250 ms
+// and a 4-sample IMU drain every 20 ms, run() every 10 ms. The
+// signals are synthetic — a pulse with respiration and sensor
+// noise, gravity with a walking swing — at rest and walking.
+//
+// First the codec alone: bytes per second of signal per channel
+// against the 18-bit / int16 samples as tiga_capture.h stores
+// them and against byte varints of first- and second-order deltas
+// (as tiga_telemetry.h would send them, without framing), and
+// host CPU per sample and per frame on both ends.
+//
+// Then a loopback link on a virtual millisecond clock: the stack
+// holds a few notifications and each connection event carries a
+// fixed number of packets of the negotiated MTU. From a 2M PHY at
+// 7.5 ms down to a 23-byte MTU at 50 ms, and a link that fades
+// for half a minute: the level the sender settles at, frames
+// dropped, signal delivered and sample-to-phone latency. Checks
+// that every sample the phone gets is the sensor's (or the mean
+// of its group when decimated), that a fast link never decimates
+// or drops, that a slow one decimates rather than drop, and that
+// the rate comes back after a fade.
+//
+//   make bench
+// ============================================================
+
+#include "tiga_stream.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <algorithm>
+#include <deque>
+#include <vector>
+
+#define PPG_HZ          100
+#define IMU_HZ          IMU_RATE_HZ
+#define BENCH_SECS      120
+#define BENCH_TASK_MS   10              // firmware "stream" task period
+#define BENCH_STACK     8               // notifications the BLE stack queues
+#define BENCH_RAM_MAX   5200
+
+static uint64_t nowNs() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static double urand() { return (rand() + 0.5) / ((double)RAND_MAX + 1); }
+static double gauss() { return sqrt(-2 * log(urand())) * cos(6.283185307 * urand()); }
+
+// ── Signals ──────────────────────────────────────────────────
+struct Trace {
+  std::vector<int32_t> red, ir;                 // 100 Hz, 18-bit counts
+  std::vector<int16_t> ax, ay, az;              // 200 Hz, raw counts at ±4 g
+};
+
+static float pulseShape(float ph) {
+  float a = (ph - 0.15f) / 0.07f, b = (ph - 0.45f) / 0.09f;
+  return expf(-a * a) + 0.35f * expf(-b * b);
+}
+
+static void makeTrace(Trace& tr, uint32_t secs, bool walk) {
+  const float twoPi = 6.2831853f, irDc = 120000, redDc = 90000, irAc = 600;
+  float phase = 0, rr = 0.85f, f = 1.8f;
+  for (uint32_t i = 0; i < secs * PPG_HZ; i++) {
+    float t = (float)i / PPG_HZ;
+    phase += 1.0f / PPG_HZ / rr;
+    if (phase >= 1) { phase -= 1; rr = (walk ? 0.65f : 0.85f) + 0.03f * (float)gauss(); }
+    float p = pulseShape(phase), resp = 0.3f * irAc * sinf(twoPi * 0.25f * t);
+    float art = walk ? 1.5f * irAc * (0.8f * sinf(twoPi * f / 2 * t) + 0.5f * sinf(twoPi * f * t)) : 0;
+    tr.ir.push_back((int32_t)(irDc + resp - irAc * p + art + 30 * (float)gauss()));
+    tr.red.push_back((int32_t)(redDc + 0.75f * resp - 0.6f * irAc * p + 0.75f * art + 25 * (float)gauss()));
+  }
+  for (uint32_t i = 0; i < secs * IMU_HZ; i++) {
+    float t = (float)i / IMU_HZ, w = twoPi * f * t;
+    float x = 0.004f * (float)gauss(), y = 0.004f * (float)gauss(), z = 1 + 0.004f * (float)gauss();   // ~4 mg rms
+    if (walk) {
+      x += 0.35f * sinf(w / 2);
+      y += 0.15f * sinf(w + 1);
+      z += 0.28f * sinf(w) + 0.1f * sinf(2 * w);
+    }
+    tr.ax.push_back((int16_t)lroundf(x * 8192));
+    tr.ay.push_back((int16_t)lroundf(y * 8192));
+    tr.az.push_back((int16_t)lroundf(z * 8192));
+  }
+}
+
+// ── Link ─────────────────────────────────────────────────────
+struct LinkModel {
+  const char* name;
+  uint16_t mtu;
+  uint32_t intervalMs;       // connection interval
+  uint8_t  perEvent;         // packets per connection event
+  bool     fade;             // one packet every 16th event from 40 s to 70 s
+};
+
+static const LinkModel links[] = {
+  { "7.5 ms 2M, MTU 247",     247,  8, 6, false },
+  { "15 ms 1M, MTU 247",      247, 15, 4, false },
+  { "30 ms, MTU 185 (iOS)",   185, 30, 3, false },
+  { "30 ms, MTU 23",           23, 30, 4, false },
+  { "50 ms, MTU 23",           23, 50, 2, false },
+  { "15 ms, fades 40-70 s",   247, 15, 4, true  },
+};
+
+static uint32_t vms = 0;
+static const LinkModel* link;
+static std::deque<std::vector<uint8_t>> stack;
+static uint32_t fastOn = 0, fastOff = 0;
+
+static uint32_t  clockMs() { return vms; }
+static uint16_t  linkMtu() { return link->mtu; }
+static bool linkSend(const uint8_t* p, uint16_t n) {
+  if (stack.size() >= BENCH_STACK || n > link->mtu - 3) return false;
+  stack.emplace_back(p, p + n);
+  return true;
+}
+static void linkFast(bool on) { (on ? fastOn : fastOff)++; }
+
+// ── Phone ────────────────────────────────────────────────────
+struct Check {
+  const Trace* tr;
+  uint32_t samples[2] = {}, wrong = 0, byLevel[STREAM_LEVEL_MAX + 1] = {};
+  std::vector<uint32_t> latMs;        // PPG: arrival less the sample's time
+};
+static Check chk;
+
+// What the sample should be: the sensor's, or its group's mean
+static int32_t expected(uint8_t type, uint32_t idx, uint8_t lvl, uint8_t a) {
+  const Trace& tr = *chk.tr;
+  int64_t s = 0;
+  uint32_t n = 1u << lvl;
+  for (uint32_t k = 0; k < n; k++) {
+    uint32_t i = idx + k;
+    if (type == STREAM_PPG) s += a == 0 ? tr.red[i] : tr.ir[i];
+    else s += a == 0 ? tr.ax[i] : a == 1 ? tr.ay[i] : tr.az[i];
+  }
+  return (int32_t)((s + (n >> 1)) >> lvl);
+}
+
+static void phoneSample(uint8_t type, uint32_t idx, uint8_t lvl, const int32_t* v, void*) {
+  uint8_t axes = type == STREAM_PPG ? 2 : 3;
+  for (uint8_t a = 0; a < axes; a++)
+    if (v[a] != expected(type, idx, lvl, a)) { chk.wrong++; break; }
+  chk.samples[type - STREAM_PPG] += 1u << lvl;
+  chk.byLevel[lvl] += 1u << lvl;
+  if (type == STREAM_PPG) {
+    uint32_t at = (idx + (1u << lvl)) * 1000 / PPG_HZ;   // when its group was complete
+    chk.latMs.push_back(vms > at ? vms - at : 0);
+  }
+}
+
+// ── Feeding, as the firmware does ────────────────────────────
+static void feedPpg(StreamSender& tx, const Trace& tr, uint32_t first, uint16_t count) {
+  PpgBlock b = {};
+  b.firstSample = first;
+  b.count = count;
+  for (uint16_t i = 0; i < count; i++) { b.s[i].red = tr.red[first + i]; b.s[i].ir = tr.ir[first + i]; }
+  tx.ppg(b);
+}
+
+static void feedImu(StreamSender& tx, const Trace& tr, uint32_t first, uint8_t count) {
+  ImuSample s[IMU_MAX_PER_POLL] = {};
+  for (uint8_t i = 0; i < count; i++) {
+    s[i].idx = first + i;
+    s[i].ax = tr.ax[first + i]; s[i].ay = tr.ay[first + i]; s[i].az = tr.az[first + i];
+  }
+  tx.acc(s, count);
+}
+
+// ── Codec ────────────────────────────────────────────────────
+static uint8_t varLen(int32_t d) { return telVarintLen(telZig((uint32_t)d)); }
+
+// Bytes per second of deltas alone, no framing: each order as
+// varints, and first-order packed in groups as the frames carry them
+static void orderBytes(const std::vector<int32_t>* ch, uint8_t axes, uint32_t n, uint32_t hz,
+                       double* o1, double* o2, double* packed) {
+  uint64_t b1 = 0, b2 = 0, bits = 0;
+  for (uint8_t a = 0; a < axes; a++) {
+    const std::vector<int32_t>& x = ch[a];
+    for (uint32_t i = 2; i < n; i++) {
+      b1 += varLen(x[i] - x[i - 1]);
+      b2 += varLen(x[i] - 2 * x[i - 1] + x[i - 2]);
+    }
+    for (uint32_t i = 2; i < n; i += STREAM_GROUP) {
+      uint32_t k = std::min<uint32_t>(STREAM_GROUP, n - i);
+      uint8_t  w = 0;
+      for (uint32_t j = i; j < i + k; j++) w = std::max(w, streamBits(telZig((uint32_t)(x[j] - x[j - 1]))));
+      bits += STREAM_WIDTH_BITS + k * w;
+    }
+  }
+  *o1     = (double)b1 * hz / (n - 2);
+  *o2     = (double)b2 * hz / (n - 2);
+  *packed = bits / 8.0 * hz / (n - 2);
+}
+
+static bool codec(const char* name, const Trace& tr, uint16_t mtu) {
+  static LinkModel m;
+  m = { "codec", mtu, 1, 255, false };
+  link = &m;
+  vms = 0;
+  StreamSender   tx({ linkMtu, linkSend, linkFast }, PPG_HZ, IMU_HZ, clockMs);
+  StreamReceiver rx(phoneSample, nullptr);
+  chk = Check();
+  chk.tr = &tr;
+
+  uint8_t ctl[4];
+  uint8_t n = rx.start(ctl, STREAM_CH_PPG | STREAM_CH_ACC, 0);
+  tx.onControl(ctl, n);
+  tx.run();
+
+  uint32_t secs = (uint32_t)tr.ir.size() / PPG_HZ;
+  uint64_t encNs = 0, decNs = 0;
+  uint32_t bytes[2] = {};
+  for (uint32_t b = 0; b < secs * 4; b++) {
+    for (uint32_t k = 0; k <= 50; k += 5) {
+      uint64_t t0 = nowNs();
+      if (k < 50) feedImu(tx, tr, b * 50 + k, 5);
+      else        feedPpg(tx, tr, b * 25, 25);
+      encNs += nowNs() - t0;
+      do {                                   // a link that takes everything
+        tx.run();
+        while (!stack.empty()) {
+          const std::vector<uint8_t>& f = stack.front();
+          uint8_t type = f[0] & 0x0F;
+          if (type == STREAM_PPG || type == STREAM_ACC) bytes[type - 1] += f.size();
+          uint64_t t1 = nowNs();
+          rx.onFrame(f.data(), (uint16_t)f.size());
+          decNs += nowNs() - t1;
+          stack.pop_front();
+        }
+      } while (tx.queued());
+    }
+    vms += 250;
+  }
+
+  // Deltas alone, without framing, for the prediction order
+  std::vector<int32_t> ppg[2] = { tr.red, tr.ir };
+  std::vector<int32_t> acc[3] = { std::vector<int32_t>(tr.ax.begin(), tr.ax.end()),
+                                  std::vector<int32_t>(tr.ay.begin(), tr.ay.end()),
+                                  std::vector<int32_t>(tr.az.begin(), tr.az.end()) };
+  double p1, p2, pp, a1, a2, ap;
+  orderBytes(ppg, 2, (uint32_t)tr.ir.size(), PPG_HZ, &p1, &p2, &pp);
+  orderBytes(acc, 3, (uint32_t)tr.az.size(), IMU_HZ, &a1, &a2, &ap);
+
+  uint32_t made = tx.framesMade;
+  printf("  %-5s MTU %3u  PPG %4.0f B/s (raw %u; deltas: varint Δ1 %3.0f Δ2 %3.0f, packed %3.0f)"
+         "   ACC %4.0f B/s (raw %u; %4.0f %4.0f, %4.0f)"
+         "   %5.1f ns/sample  %5.2f µs/frame  decode %5.2f µs/frame\n",
+         name, mtu, (double)bytes[0] / secs, PPG_HZ * 6, p1, p2, pp,
+         (double)bytes[1] / secs, IMU_HZ * 6, a1, a2, ap,
+         (double)encNs / tx.samplesIn, encNs / 1e3 / made, decNs / 1e3 / rx.frames);
+
+  // All of it but the frames still open at the end
+  bool ok = chk.wrong == 0 && rx.lost == 0 && rx.bad == 0 && tx.dropped() == 0 &&
+            chk.samples[0] + PPG_HZ * STREAM_SPAN_MS / 1000 + 25 >= secs * PPG_HZ &&
+            chk.samples[1] + IMU_HZ * STREAM_SPAN_MS / 1000 + 50 >= secs * IMU_HZ;
+  if (!ok) printf("    FAIL: %u wrong, %u lost, %u bad, %u dropped, %u / %u samples\n",
+                  chk.wrong, rx.lost, rx.bad, tx.dropped(), chk.samples[0], chk.samples[1]);
+  // Packed under either varint, or it isn't earning its keep
+  if (pp >= std::min(p1, p2) || ap >= std::min(a1, a2)) {
+    printf("    FAIL: packing no smaller than varint deltas\n");
+    ok = false;
+  }
+  return ok;
+}
+
+// ── Link runs ────────────────────────────────────────────────
+struct LinkResult {
+  uint32_t made, dropped, busy, lost, wrong;
+  uint8_t  maxLevel, endLevel;
+  double   delivered, p50, p95, airBps;
+  uint32_t slower, faster;
+};
+
+static LinkResult runLink(const LinkModel& m, const Trace& tr) {
+  link = &m;
+  vms = 0;
+  stack.clear();
+  fastOn = fastOff = 0;
+  StreamSender   tx({ linkMtu, linkSend, linkFast }, PPG_HZ, IMU_HZ, clockMs);
+  StreamReceiver rx(phoneSample, nullptr);
+  chk = Check();
+  chk.tr = &tr;
+
+  uint8_t ctl[4];
+  tx.onControl(ctl, rx.start(ctl, STREAM_CH_PPG | STREAM_CH_ACC, 0));
+
+  LinkResult r = {};
+  uint64_t air = 0;
+  uint32_t end = BENCH_SECS * 1000;
+  for (vms = 0; vms < end; vms++) {
+    if (vms && vms % 250 == 0) feedPpg(tx, tr, vms / 10 - 25, 25);   // once its last sample is in
+    if (vms && vms % 20 == 0)  feedImu(tx, tr, vms / 5 - 4, 4);
+    if (vms % BENCH_TASK_MS == 0) tx.run();
+    if (vms % m.intervalMs == 0) {
+      uint8_t per = !m.fade || vms < 40000 || vms >= 70000 ? m.perEvent
+                  : vms / m.intervalMs % 16 == 0 ? 1 : 0;
+      for (uint8_t k = 0; k < per && !stack.empty(); k++) {
+        air += stack.front().size();
+        rx.onFrame(stack.front().data(), (uint16_t)stack.front().size());
+        stack.pop_front();
+      }
+    }
+    uint8_t l = tx.level();
+    if (l > r.maxLevel) r.maxLevel = l;
+  }
+  uint8_t stop = STREAM_STOP;
+  tx.onControl(&stop, 1);
+  tx.run();
+
+  std::sort(chk.latMs.begin(), chk.latMs.end());
+  r.made      = tx.framesMade;
+  r.dropped   = tx.dropped();
+  r.busy      = tx.busy;
+  r.lost      = rx.lost;
+  r.wrong     = chk.wrong + rx.bad;
+  r.endLevel  = tx.level();
+  r.delivered = 100.0 * (chk.samples[0] + chk.samples[1]) / ((double)tx.samplesIn);
+  r.p50       = chk.latMs.empty() ? 0 : chk.latMs[chk.latMs.size() / 2];
+  r.p95       = chk.latMs.empty() ? 0 : chk.latMs[chk.latMs.size() * 95 / 100];
+  r.airBps    = air / (double)BENCH_SECS;
+  r.slower    = tx.slower;
+  r.faster    = tx.faster;
+  if (fastOn != 1 || fastOff != 1) r.wrong++;        // fast once at START, back once at STOP
+  return r;
+}
+
+int main() {
+  srand(11);
+  int fail = 0;
+
+  Trace rest, walk;
+  makeTrace(rest, BENCH_SECS, false);
+  makeTrace(walk, BENCH_SECS, true);
+
+  printf("Stream codec (tiga_stream.h): 100 Hz red/IR and 200 Hz accel, %u s each, "
+         "bytes per second of signal on air\n", BENCH_SECS);
+  for (uint16_t mtu : { 247, 185, 23 }) {
+    if (!codec("rest", rest, mtu)) fail = 1;
+    if (!codec("walk", walk, mtu)) fail = 1;
+  }
+
+  printf("\nOver a modelled link, walking, both channels at full rate asked for\n");
+  printf("  %-24s %6s %6s %6s %6s  %5s %5s  %8s  %7s %7s  %8s\n",
+         "link", "made", "drop", "lost", "busy", "maxLv", "endLv", "signal", "p50 ms", "p95 ms", "air B/s");
+  for (const LinkModel& m : links) {
+    LinkResult r = runLink(m, walk);
+    printf("  %-24s %6u %6u %6u %6u  %5u %5u  %7.1f%%  %7.0f %7.0f  %8.0f\n",
+           m.name, r.made, r.dropped, r.lost, r.busy, r.maxLevel, r.endLevel,
+           r.delivered, r.p50, r.p95, r.airBps);
+    bool fastLink = m.mtu >= 185 && !m.fade;
+    bool ok = r.wrong == 0 && r.lost <= r.dropped;     // the last frames' loss can't show
+    if (fastLink) ok = ok && r.dropped == 0 && r.maxLevel == 0 && r.delivered > 99.0 && r.p95 <= 1500;
+    else          ok = ok && r.dropped * 50 <= r.made;              // decimates rather than drops
+    if (m.fade)   ok = ok && r.maxLevel > 0 && r.endLevel == 0;     // and comes back
+    if (m.mtu == 23 && m.intervalMs >= 50) ok = ok && r.maxLevel > 0;
+    if (!ok) {
+      printf("    FAIL (%u wrong, %u slower, %u faster)\n", r.wrong, r.slower, r.faster);
+      fail = 1;
+    }
+  }
+
+  printf("\n  RAM %zu bytes (StreamSender, %u-frame ring)\n", sizeof(StreamSender), STREAM_QUEUE);
+  if (sizeof(StreamSender) > BENCH_RAM_MAX) fail = 1;
+  printf("  %s\n", fail ? "FAILED" : "all checks passed");
+  return fail;
+}
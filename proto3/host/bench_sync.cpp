@@ -0,0 +1,297 @@
+// ============================================================
+// bench_sync.cpp — history backfill over a modelled BLE link
+// ============================================================
+// A day of history in a RAM flash store, streamed by SyncSender
+// to a SyncReceiver through a loopback link on a virtual clock:
+//
+//   connection events every interval, each carrying a limited
+//   number of link-layer packets (27 B, or 251 B with data length
+//   extension); a notification of MTU − 3 bytes takes as many as
+//   it needs. The watch's stack holds a few notifications; when
+//   it is full send() says no. Every notification and every
+//   phone write can be lost, and the link can drop and come back.
+//
+// For each link: time to backfill 24 h, notification payload
+// bytes per second, resends, and a check that the phone ends up
+// with every sample exactly once, in order. Then the link stays up
+// while the watch keeps recording, to check new blocks follow.
+//
+//   make bench
+// ============================================================
+
+#include "tiga_sync.h"
+#include "flash_file.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <deque>
+#include <vector>
+
+#define BENCH_PART_BYTES  (1u << 20)
+#define BENCH_T0          1776124800u      // 2026-04-14 00:00 UTC
+#define BENCH_DAY         86400
+#define BENCH_TASK_US     20000            // firmware "sync" task period
+#define BENCH_GIVE_UP_S   3600.0
+
+static uint64_t nowNs() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+// ── Store ────────────────────────────────────────────────────
+static FlashFile flash;
+
+static bool fRead(uint32_t off, void* dst, uint32_t n)        { return flash.read(off, dst, n); }
+static bool fWrite(uint32_t off, const void* src, uint32_t n) { return flash.write(off, src, n); }
+static bool fErase(uint32_t off)                              { return flash.erase(off, HIST_SECTOR); }
+
+// A mixed day: rest, walks every three hours, HR drifting
+static std::vector<HistSample> makeDay(uint32_t n) {
+  std::vector<HistSample> v(n);
+  uint32_t rng = 1;
+  auto rnd = [&rng]() { rng ^= rng << 13; rng ^= rng >> 17; rng ^= rng << 5; return rng; };
+  int32_t hr = 68, steps = 0, alt = 120;
+  for (uint32_t i = 0; i < n; i++) {
+    bool walking = (i / 60) % 180 >= 20 && (i / 60) % 180 < 60;
+    if ((walking && rnd() % 3 == 0) || rnd() % 20 == 0) hr += (int32_t)(rnd() % 5) - 2;
+    hr = hr < 50 ? 50 : hr > 160 ? 160 : hr;
+    if (walking) steps += (i % 5 < 3) ? 2 : 1;
+    if (rnd() % 40 == 0) alt += (int32_t)(rnd() % 3) - 1;
+    HistSample& s = v[i];
+    s.t       = BENCH_T0 + i;
+    s.hr      = (uint8_t)hr;
+    s.spo2    = rnd() % 90 == 0 ? 96 : 97;
+    s.battery = (uint8_t)(100 - i / 2000);
+    s.worn    = (i % 20000) > 300;
+    s.steps   = steps;
+    s.altDm   = alt;
+  }
+  return v;
+}
+
+// ── Loopback link ────────────────────────────────────────────
+struct LinkModel {
+  const char* name;
+  uint16_t mtu;            // negotiated ATT MTU
+  uint16_t llBytes;        // link-layer payload: 27, or 251 with DLE
+  uint8_t  perEvent;       // LL packets per connection event, one direction
+  uint32_t intervalUs;
+  float    loss;           // per notification and per phone write
+  uint32_t upS, downS;     // up for upS, down for downS; 0 = never drops
+};
+
+struct Packet { std::vector<uint8_t> b; };
+
+static const LinkModel* model;
+static uint64_t            vnow;           // virtual µs
+static bool                linkUp;
+static std::deque<Packet>  toPhone;        // watch stack's TX buffer
+static std::deque<Packet>  toWatch;        // phone writes waiting for an event
+static uint32_t            lossRng = 99;
+static uint64_t            payloadBytes;   // notification bytes delivered
+static uint16_t            headSent;       // LL packets of toPhone.front() already out
+static const unsigned      TX_QUEUE = 12;  // notifications the stack holds
+
+static uint32_t benchClockUs() { return (uint32_t)vnow; }
+static uint16_t linkMtu()      { return model->mtu; }
+
+static bool linkSend(const uint8_t* p, uint16_t n) {
+  if (!linkUp || toPhone.size() >= TX_QUEUE) return linkUp ? false : true;   // down: gone
+  toPhone.push_back({ std::vector<uint8_t>(p, p + n) });
+  return true;
+}
+
+static bool lost() {
+  lossRng ^= lossRng << 13; lossRng ^= lossRng >> 17; lossRng ^= lossRng << 5;
+  return (lossRng % 100000) < (uint32_t)(model->loss * 100000);
+}
+
+static uint16_t llPackets(uint16_t attBytes) {
+  uint16_t l2cap = attBytes + SYNC_ATT_HDR + 4;          // + ATT header, L2CAP header
+  return (uint16_t)((l2cap + model->llBytes - 1) / model->llBytes);
+}
+
+// ── Phone ────────────────────────────────────────────────────
+struct Phone {
+  std::vector<HistSample> got;
+  uint64_t lastRxUs = 0;
+};
+
+static void onSample(const HistSample& s, void* ctx) { ((Phone*)ctx)->got.push_back(s); }
+
+static void phoneWrite(const uint8_t* p, uint8_t n) {
+  if (n) toWatch.push_back({ std::vector<uint8_t>(p, p + n) });
+}
+
+// ── One run ──────────────────────────────────────────────────
+struct Result {
+  double   seconds;        // virtual time to caught-up
+  uint64_t bytes;
+  uint32_t resent, nacks, timeouts, sessions, samples;
+  bool     exact, follows;
+};
+
+static Result runLink(const LinkModel& m, const std::vector<HistSample>& day) {
+  model = &m;
+  vnow = 0;
+  toPhone.clear();
+  toWatch.clear();
+  headSent = 0;
+  payloadBytes = 0;
+  lossRng = 99;
+
+  flash.open(nullptr, BENCH_PART_BYTES);
+  HistoryStore store;
+  store.begin({ flash.size(), fRead, fWrite, fErase });
+  store.prepare(HIST_ERASE_AHEAD);
+  uint32_t fed = BENCH_DAY;
+  for (uint32_t i = 0; i < fed; i++) store.append(day[i]);
+
+  SyncSender   watch(store, { linkMtu, linkSend }, benchClockUs);
+  Phone        phone;
+  SyncReceiver rx(onSample, &phone);
+  uint8_t      reply[SYNC_CTL_MAX];
+
+  linkUp = true;
+  phoneWrite(reply, rx.start(reply));
+  uint64_t nextTask = 0, nextEvent = 0, upSince = 0, downSince = 0;
+  uint64_t giveUp = (uint64_t)(BENCH_GIVE_UP_S * 1e6);
+  Result r = {};
+  bool caught = false;
+  uint64_t followEnd = 0;
+
+  while (vnow < giveUp) {
+    vnow = nextTask < nextEvent ? nextTask : nextEvent;
+
+    // Drops and reconnects
+    if (m.upS && linkUp && vnow - upSince >= (uint64_t)m.upS * 1000000) {
+      linkUp = false;
+      downSince = vnow;
+      toPhone.clear();
+      toWatch.clear();
+      headSent = 0;
+      watch.disconnect();
+    } else if (m.upS && !linkUp && vnow - downSince >= (uint64_t)m.downS * 1000000) {
+      linkUp = true;
+      upSince = vnow;
+      phoneWrite(reply, rx.start(reply));
+    }
+
+    if (vnow == nextTask) {
+      // The watch keeps recording once the day is across
+      if (caught && fed < day.size() && vnow % 1000000 == 0) store.append(day[fed++]);
+      watch.run();
+      nextTask += BENCH_TASK_US;
+    }
+
+    if (vnow == nextEvent) {
+      nextEvent += m.intervalUs;
+      if (!linkUp) continue;
+      // Phone → watch first (writes are short: one LL packet each)
+      uint8_t budget = m.perEvent;
+      while (!toWatch.empty() && budget) {
+        Packet p = toWatch.front();
+        toWatch.pop_front();
+        budget--;
+        if (!lost()) watch.onControl(p.b.data(), (uint16_t)p.b.size());
+      }
+      // A notification longer than one event's worth carries on
+      // in the next one
+      budget = m.perEvent;
+      while (!toPhone.empty() && budget) {
+        uint16_t need = llPackets((uint16_t)toPhone.front().b.size()) - headSent;
+        if (need > budget) {
+          headSent += budget;
+          break;
+        }
+        budget -= need;
+        headSent = 0;
+        Packet p = toPhone.front();
+        toPhone.pop_front();
+        if (lost()) continue;
+        payloadBytes += p.b.size();
+        phone.lastRxUs = vnow;
+        phoneWrite(reply, rx.onChunk(p.b.data(), (uint16_t)p.b.size(), reply));
+      }
+      // Phone side timeout: nothing for 2 s and not caught up
+      if (!rx.caughtUp && vnow - phone.lastRxUs > 2000000) {
+        phone.lastRxUs = vnow;
+        phoneWrite(reply, rx.start(reply));
+      }
+    }
+
+    if (!caught && rx.caughtUp && phone.got.size() >= BENCH_DAY) {
+      caught = true;
+      r.seconds = vnow / 1e6;
+      r.bytes   = payloadBytes;
+      followEnd = vnow + 600000000ULL;              // then 10 more minutes live
+    }
+    if (caught && vnow >= followEnd) break;
+  }
+
+  store.flush();
+  if (!linkUp) {
+    linkUp = true;
+    phoneWrite(reply, rx.start(reply));
+  }
+  for (int k = 0; k < 200; k++) {                   // drain the last block
+    vnow += BENCH_TASK_US;
+    watch.run();
+    while (linkUp && !toPhone.empty()) {
+      Packet p = toPhone.front();
+      toPhone.pop_front();
+      phoneWrite(reply, rx.onChunk(p.b.data(), (uint16_t)p.b.size(), reply));
+    }
+    while (!toWatch.empty()) {
+      watch.onControl(toWatch.front().b.data(), (uint16_t)toWatch.front().b.size());
+      toWatch.pop_front();
+    }
+  }
+
+  r.resent   = watch.chunksAgain;
+  r.nacks    = watch.nacks;
+  r.timeouts = watch.timeouts;
+  r.sessions = watch.sessions;
+  r.samples  = (uint32_t)phone.got.size();
+  r.exact    = caught;
+  for (uint32_t i = 0; i < phone.got.size() && r.exact; i++)
+    if (i >= day.size() || !(phone.got[i] == day[i])) r.exact = false;
+  r.follows  = phone.got.size() == fed;
+  return r;
+}
+
+int main() {
+  static const LinkModel links[] = {
+    //  name                     mtu  ll  pkts interval  loss  up down
+    { "MTU 23, no DLE, 30 ms",    23,  27,  4, 30000, 0.00f,  0, 0 },
+    { "MTU 185, no DLE, 30 ms",  185,  27,  6, 30000, 0.00f,  0, 0 },
+    { "MTU 247, DLE, 30 ms",     247, 251,  4, 30000, 0.00f,  0, 0 },
+    { "MTU 517, DLE, 15 ms",     517, 251,  6, 15000, 0.00f,  0, 0 },
+    { "MTU 517, DLE, 1% loss",   517, 251,  6, 15000, 0.01f,  0, 0 },
+    { "MTU 517, DLE, 5% loss",   517, 251,  6, 15000, 0.05f,  0, 0 },
+    { "MTU 247, 2% loss, drops", 247, 251,  4, 30000, 0.02f, 20, 5 },
+  };
+
+  std::vector<HistSample> day = makeDay(BENCH_DAY + 700);
+  printf("History backfill, 24 h (%u samples) over a modelled link, sync task every %d ms\n",
+         BENCH_DAY, BENCH_TASK_US / 1000);
+  printf("  %-26s %9s %9s %8s %6s %5s %5s %5s  %s\n",
+         "link", "time (s)", "B/s", "samp/s", "resent", "nack", "t/o", "start", "result");
+  int fail = 0;
+  uint64_t t0 = nowNs();
+  for (const LinkModel& m : links) {
+    Result r = runLink(m, day);
+    bool ok = r.exact && r.follows;
+    printf("  %-26s %9.1f %9.0f %8.0f %6u %5u %5u %5u  %s\n",
+           m.name, r.seconds, r.seconds ? r.bytes / r.seconds : 0.0,
+           r.seconds ? BENCH_DAY / r.seconds : 0.0,
+           r.resent, r.nacks, r.timeouts, r.sessions,
+           !r.exact ? "MISSING OR WRONG SAMPLES" : !r.follows ? "LIVE DATA NOT FOLLOWED" : "exact, follows");
+    fail |= !ok;
+  }
+  printf("  host time %.2f s\n", (nowNs() - t0) / 1e9);
+  printf("  %s\n", fail ? "FAILED" : "all checks passed");
+  return fail;
+}
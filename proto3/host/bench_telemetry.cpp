@@ -0,0 +1,282 @@
+// ============================================================
+// bench_telemetry.cpp — telemetry codec vs the fixed 20-byte packet
+// ============================================================
+// Synthetic per-second readings (rest, walking, a mixed hour)
+// through tiga_telemetry.h's encoder and decoder, against the
+// original bleNotify() packet: 20 bytes every second.
+//
+// Reports payload and on-air bytes per minute and notifications
+// per minute, at the default 23-byte MTU and at 247, and checks
+// that after every second the decoder holds each field within its
+// deadband of the watch's value. Then the same with 2% of frames
+// lost: the decoder must drop out at each gap, never hold a wrong
+// value, and be exact again after the next key frame.
+//
+// Then sends refused in stretches, as when the BLE stack's buffers
+// are full under a history backfill or a stream: skipped before
+// encode(), as bleNotifyTelemetry() does, the phone sees no gap
+// and is back within its deadbands with the first frame after;
+// next to it, what encoding and then losing the frame would cost.
+// Last, a phone subscribing mid-stream gets a key frame on the
+// call it asks for and has every field at once.
+//
+//   make bench
+// ============================================================
+
+#include "tiga_telemetry.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <vector>
+
+#define BENCH_LEGACY_BYTES  20
+#define BENCH_AIR_OVERHEAD  17        // LL preamble, access address, header, CRC + L2CAP + ATT
+
+static uint64_t nowNs() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+// ── Readings ─────────────────────────────────────────────────
+// What the firmware's globals look like second to second: the
+// beat detector's HR wanders a few bpm, SpO2 flips between two
+// values, BMP280 altitude and pressure carry noise, battery falls
+// a percent every few minutes, HRV wanders a few ms over a
+// minute. Walking adds steps, a higher HR and a slow climb, and
+// drops HRV to no reading.
+enum Activity { REST, WALK, MIXED };
+
+static std::vector<TelSnapshot> makeReadings(Activity a, uint32_t secs) {
+  std::vector<TelSnapshot> out(secs);
+  uint32_t rng = 7;
+  auto rnd = [&rng]() { rng ^= rng << 13; rng ^= rng >> 17; rng ^= rng << 5; return rng; };
+  auto noise = [&rnd](int32_t span) { return (int32_t)(rnd() % (2 * span + 1)) - span; };
+  float hr = 68, alt = 1200, steps = 0, rmssd = 38;
+  for (uint32_t i = 0; i < secs; i++) {
+    bool walking = a == WALK || (a == MIXED && (i / 60) % 20 >= 12);
+    float target = walking ? 104 : 68;
+    hr += (target - hr) * 0.02f + noise(1) * 0.7f;
+    if (walking) {
+      steps += 1.85f;
+      alt   += 0.03f;
+    }
+    TelSnapshot& s = out[i];
+    s.v[TEL_HR]       = (int32_t)lroundf(hr) + noise(1);
+    s.v[TEL_SPO2]     = rnd() % 8 == 0 ? 96 : 97;
+    s.v[TEL_STEPS]    = (int32_t)steps;
+    s.v[TEL_ALT_DM]   = (int32_t)lroundf(alt) + noise(3);
+    s.v[TEL_FLOORS]   = (int32_t)((alt - 1200) / 30);
+    s.v[TEL_BATTERY]  = 96 - (int32_t)(i / 400);
+    s.v[TEL_FLAGS]    = TEL_WORN | TEL_SPO2_VALID | (walking && rnd() % 10 ? 0 : TEL_STABLE);
+    s.v[TEL_FALLS]    = 0;
+    s.v[TEL_GPS_SATS] = 0;
+    s.v[TEL_PRESSURE] = 10132 - (int32_t)lroundf((alt - 1200) * 0.12f) + noise(1);
+    rmssd += noise(1) * 0.3f;                          // a minute's window: slow
+    s.v[TEL_RMSSD]    = walking ? 0 : (int32_t)lroundf(rmssd);   // HRV reads only at rest
+    s.v[TEL_SDNN]     = walking ? 0 : (int32_t)lroundf(rmssd * 1.2f);
+    s.v[TEL_PNN50]    = walking ? 0 : (int32_t)lroundf(rmssd * 0.5f);
+  }
+  return out;
+}
+
+// ── One run ──────────────────────────────────────────────────
+struct Result {
+  uint64_t payload;         // frame bytes delivered
+  uint32_t notifies;
+  uint32_t deferred;
+  uint32_t outOfBand;       // seconds a synced decoder was past a deadband
+  uint32_t gapsSent, gapsSeen;
+  uint32_t maxBlindS;       // longest stretch not synced
+  uint32_t keysLost;        // key frames lost: the next is a minute off
+  bool     exactAfterKey;
+  double   encNs, decNs;
+};
+
+static Result run(const std::vector<TelSnapshot>& in, uint8_t room, float loss) {
+  TelEncoder enc;
+  TelDecoder dec;
+  Result r = {};
+  r.exactAfterKey = true;
+  uint32_t rng = 11, blind = 0;
+  uint64_t encNs = 0, decNs = 0;
+  uint32_t decoded = 0;
+  bool lastLost = false;
+  for (size_t i = 0; i < in.size(); i++) {
+    uint8_t frame[TEL_FRAME_MAX];
+    bool applied = false;
+    uint64_t t0 = nowNs();
+    uint8_t n = enc.encode(in[i], frame, room);
+    encNs += nowNs() - t0;
+    if (n) {
+      rng ^= rng << 13; rng ^= rng >> 17; rng ^= rng << 5;
+      bool lost = (rng % 10000) < (uint32_t)(loss * 10000);
+      if (lost) {
+        if (!lastLost) r.gapsSent++;
+        if (frame[0] & 0x08) r.keysLost++;
+        lastLost = true;
+      } else {
+        t0 = nowNs();
+        applied = dec.decode(frame, n) != 0;
+        decNs += nowNs() - t0;
+        decoded++;
+        r.payload += n;
+        r.notifies++;
+        lastLost = false;
+        if ((frame[0] & 0x08) && dec.have == (1u << TEL_FIELDS) - 1)
+          for (uint8_t f = 0; f < TEL_FIELDS; f++)
+            if (dec.cur.v[f] != in[i].v[f]) r.exactAfterKey = false;
+      }
+    }
+    if (!dec.synced) {
+      if (++blind > r.maxBlindS) r.maxBlindS = blind;
+      continue;
+    }
+    blind = 0;
+    // With loss, a lost frame only shows at the next one; until
+    // then the phone can't know. Check what each frame leaves.
+    if (loss && !applied) continue;
+    // A field a short key frame had no room for isn't held yet
+    // (dec.have); it follows in the next frame
+    for (uint8_t f = 0; f < TEL_FIELDS; f++) {
+      if (!(dec.have >> f & 1)) continue;
+      int32_t d = dec.cur.v[f] - in[i].v[f];
+      if ((uint32_t)abs(d) > TEL_FIELD_INFO[f].deadband) { r.outOfBand++; break; }
+    }
+  }
+  r.deferred = enc.deferred;
+  r.gapsSeen = dec.gaps;
+  r.encNs = (double)encNs / in.size();
+  r.decNs = decoded ? (double)decNs / decoded : 0;
+  return r;
+}
+
+// ── Refused sends ────────────────────────────────────────────
+// The stack refuses every send for stretches of 1-8 s, starting
+// about once every 30 s. `gate` skips encode() while refused;
+// otherwise the frame is encoded and then lost.
+struct Refused {
+  uint32_t refusedS, stretches;
+  uint32_t gaps, stale;
+  uint32_t outOfBand;       // accepting seconds a synced decoder was past a deadband
+  uint32_t maxBlindS;
+};
+
+static Refused runRefused(const std::vector<TelSnapshot>& in, bool gate) {
+  TelEncoder enc;
+  TelDecoder dec;
+  Refused r = {};
+  uint32_t rng = 23, busyLeft = 0, blind = 0;
+  for (size_t i = 0; i < in.size(); i++) {
+    rng ^= rng << 13; rng ^= rng >> 17; rng ^= rng << 5;
+    if (!busyLeft && rng % 30 == 0) { busyLeft = 1 + (rng >> 8) % 8; r.stretches++; }
+    bool refused = busyLeft > 0;
+    if (busyLeft) busyLeft--;
+    r.refusedS += refused;
+    uint8_t frame[TEL_FRAME_MAX];
+    if (!(gate && refused)) {
+      uint8_t n = enc.encode(in[i], frame, 20);
+      if (n && !refused) dec.decode(frame, n);
+    }
+    if (!dec.synced) {
+      if (++blind > r.maxBlindS) r.maxBlindS = blind;
+      continue;
+    }
+    blind = 0;
+    if (refused) continue;                     // the phone can't know yet
+    for (uint8_t f = 0; f < TEL_FIELDS; f++) {
+      if (!(dec.have >> f & 1)) continue;
+      int32_t d = dec.cur.v[f] - in[i].v[f];
+      if ((uint32_t)abs(d) > TEL_FIELD_INFO[f].deadband) { r.outOfBand++; break; }
+    }
+  }
+  r.gaps  = dec.gaps;
+  r.stale = dec.stale;
+  return r;
+}
+
+int main() {
+  struct Case { const char* name; Activity a; uint32_t secs; };
+  static const Case cases[] = {
+    { "rest",             REST,  3600 },
+    { "walking",          WALK,  3600 },
+    { "mixed day hour",   MIXED, 3600 },
+  };
+  int fail = 0;
+
+  printf("Telemetry codec v%d vs fixed %d-byte packet, per minute\n", TEL_VERSION, BENCH_LEGACY_BYTES);
+  printf("  %-16s %4s %10s %10s %9s %6s %9s %8s %8s\n",
+         "", "MTU", "payload B", "on-air B", "notifies", "ratio", "deferred", "enc ns", "dec ns");
+  printf("  %-16s %4s %10d %10d %9d %6s\n", "fixed packet", "23",
+         BENCH_LEGACY_BYTES * 60, (BENCH_LEGACY_BYTES + BENCH_AIR_OVERHEAD) * 60, 60, "1.00");
+  for (const Case& c : cases) {
+    std::vector<TelSnapshot> in = makeReadings(c.a, c.secs);
+    for (uint16_t mtu : { 23, 247 }) {
+      uint8_t room = mtu - 3 < TEL_FRAME_MAX ? mtu - 3 : TEL_FRAME_MAX;
+      Result r = run(in, room, 0);
+      double mins = c.secs / 60.0;
+      double air  = (r.payload + (double)r.notifies * BENCH_AIR_OVERHEAD) / mins;
+      printf("  %-16s %4u %10.0f %10.0f %9.1f %6.2f %9u %8.1f %8.1f\n",
+             c.name, mtu, r.payload / mins, air, r.notifies / mins,
+             air / ((BENCH_LEGACY_BYTES + BENCH_AIR_OVERHEAD) * 60), r.deferred, r.encNs, r.decNs);
+      if (r.outOfBand || !r.exactAfterKey) {
+        printf("    decoder left the deadband %u times%s\n", r.outOfBand,
+               r.exactAfterKey ? "" : ", key frame not exact");
+        fail = 1;
+      }
+    }
+  }
+
+  printf("\nWith 2%% of frames lost (mixed hour, MTU 23)\n");
+  {
+    std::vector<TelSnapshot> in = makeReadings(MIXED, 3600);
+    Result r = run(in, 20, 0.02f);
+    // A loss while already blind needs no second detection; what
+    // must never happen is a synced decoder holding a wrong value.
+    // Blind until the next key frame, or the one after if a key
+    // frame was the one lost.
+    bool ok = r.gapsSeen && r.gapsSeen <= r.gapsSent && r.outOfBand == 0
+              && r.exactAfterKey && r.maxBlindS <= TEL_KEY_EVERY * (r.keysLost ? 2 : 1);
+    printf("  losses %u (%u key frames), gaps detected %u; longest blind %u s (key frame every %d s); "
+           "out of deadband while synced %u\n",
+           r.gapsSent, r.keysLost, r.gapsSeen, r.maxBlindS, TEL_KEY_EVERY, r.outOfBand);
+    fail |= !ok;
+  }
+
+  printf("\nWith sends refused in stretches (mixed hour, MTU 23)\n");
+  {
+    std::vector<TelSnapshot> in = makeReadings(MIXED, 3600);
+    Refused g = runRefused(in, true);
+    Refused d = runRefused(in, false);
+    bool ok = g.stretches && g.gaps == 0 && g.stale == 0 && g.outOfBand == 0 && g.maxBlindS == 0 &&
+              d.gaps > 0;
+    printf("  %u s refused in %u stretches\n", g.refusedS, g.stretches);
+    printf("    skipped before encode():  gaps %u, stale frames %u, longest blind %u s, out of deadband %u   %s\n",
+           g.gaps, g.stale, g.maxBlindS, g.outOfBand, ok ? "ok" : "FAIL");
+    printf("    encoded, then lost:       gaps %u, stale frames %u, longest blind %u s\n",
+           d.gaps, d.stale, d.maxBlindS);
+    fail |= !ok;
+  }
+
+  printf("\nA phone subscribing mid-stream\n");
+  {
+    std::vector<TelSnapshot> in = makeReadings(WALK, 600);
+    TelEncoder enc;
+    uint8_t frame[TEL_FRAME_MAX];
+    for (uint32_t i = 0; i < 95; i++) enc.encode(in[i], frame, 20);   // nobody listening to these
+    TelDecoder dec;
+    uint8_t n = enc.encode(in[95], frame, 244, true);
+    dec.decode(frame, n);
+    bool ok = dec.synced && dec.have == (1u << TEL_FIELDS) - 1;
+    for (uint8_t f = 0; f < TEL_FIELDS; f++) ok &= dec.cur.v[f] == in[95].v[f];
+    n = enc.encode(in[96], frame, 244);
+    ok &= !(n && (frame[0] & 0x08)) && (!n || dec.decode(frame, n)) && dec.synced;
+    printf("  key frame on the call asked: %s, %u frame(s) applied, synced   %s\n",
+           dec.keyFrames == 1 ? "yes" : "no", dec.frames, ok ? "ok" : "FAIL");
+    fail |= !ok;
+  }
+  printf("  %s\n", fail ? "FAILED" : "all checks passed");
+  return fail;
+}
@@ -0,0 +1,261 @@
+// ============================================================
+// bench_tremor.cpp — tremor spectrum against known tones
+// ============================================================
+// Synthetic gyro at 200 Hz in MPU6050 counts: a tremor tone of
+// known frequency and RMS rate, spread over the three axes the
+// way a wrist turns, plus white noise and slow wrist drift.
+//
+//   accuracy     tones across 4-12 Hz at 1.5-30 °/s in 0.5-3 °/s
+//                noise: frequency error, band RMS error, how
+//                often found. Each window also against a direct
+//                DFT in double of the same samples.
+//   rejection    no tone — noise alone, noise plus slow drift, a
+//                tone outside the band — must not be found
+//   latency      noise, then a 5 °/s tone switched on: time until
+//                the first window that finds it
+//   cost         µs per analyze(), ns per push(), bytes
+//
+// Checks: frequency within 0.2 Hz once the tone is found; band
+// RMS within 15% where the tone is at least twice the noise in
+// the band (below that the noise's own power wanders); found in
+// every window at ≥ 3 °/s; engine within 1% of the DFT; no
+// window found in any rejection case; first detection within
+// 3 s of onset.
+//
+//   make bench
+// ============================================================
+
+#include "tiga_tremor.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <vector>
+
+#define BENCH_SECS     60
+#define BENCH_SEED     23
+
+static const double PI = 3.14159265358979;
+
+static uint64_t nowNs() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static double gauss() {
+  double u = (rand() + 1.0) / ((double)RAND_MAX + 2), v = rand() / ((double)RAND_MAX + 1);
+  return sqrt(-2 * log(u)) * cos(2 * PI * v);
+}
+
+static int16_t counts(double dps) {
+  double v = dps * TREMOR_LSB_DPS;
+  if (v >  32767) return  32767;
+  if (v < -32768) return -32768;
+  return (int16_t)lrint(v);
+}
+
+// ── Signal ───────────────────────────────────────────────────
+struct Signal {
+  double hz;          // tone, 0 = none
+  double rms;         // tone RMS rate, °/s, over the three axes
+  double noise;       // white noise σ per axis, °/s
+  double drift;       // slow wrist movement, peak °/s (0.3-1.5 Hz)
+  double onset;       // tone starts here, s
+};
+
+struct Trace { std::vector<int16_t> g[3]; };
+
+static Trace makeTrace(const Signal& sig, uint32_t seed) {
+  srand(seed);
+  Trace tr;
+  // The tremor axis: mostly about the forearm, some of the others
+  const double dir[3] = { 0.80, 0.48, 0.36 };
+  double ph = rand() * 2 * PI / RAND_MAX;
+  double amp = sig.rms * sqrt(2.0);
+  for (int i = 0; i < BENCH_SECS * IMU_RATE_HZ; i++) {
+    double t = (double)i / IMU_RATE_HZ;
+    // Frequency wanders ±2% over a few seconds, as tremor does
+    double tone = 0;
+    if (sig.hz > 0 && t >= sig.onset)
+      tone = amp * sin(2 * PI * sig.hz * t + ph + 0.02 * sig.hz / 0.2 * sin(2 * PI * 0.2 * t) / (2 * PI));
+    double drift = sig.drift * (0.6 * sin(2 * PI * 0.35 * t) + 0.4 * sin(2 * PI * 1.3 * t + 1));
+    for (int a = 0; a < 3; a++)
+      tr.g[a].push_back(counts(dir[a] * tone + (a == 1 ? drift : 0.5 * drift) + sig.noise * gauss()));
+  }
+  return tr;
+}
+
+// ── Reference ────────────────────────────────────────────────
+// The same analysis, straight from the definition: direct DFT in
+// double over the window the engine just analysed.
+static void reference(const Trace& tr, int end, double* hz, double* dps) {
+  const int N = TREMOR_N;
+  double pw[TREMOR_BIN_TOP + 2] = {};
+  double s2 = 0;
+  for (int n = 0; n < N; n++) {
+    double w = 0.5 - 0.5 * cos(2 * PI * n / (N - 1));
+    s2 += w * w;
+  }
+  for (int a = 0; a < 3; a++) {
+    double mean = 0;
+    for (int n = 0; n < N; n++) mean += tr.g[a][end - N + n];
+    mean /= N;
+    for (int k = 1; k <= TREMOR_BIN_TOP + 1; k++) {
+      double re = 0, im = 0;
+      for (int n = 0; n < N; n++) {
+        double x = (tr.g[a][end - N + n] - mean) * (0.5 - 0.5 * cos(2 * PI * n / (N - 1)));
+        re += x * cos(2 * PI * k * n / N);
+        im -= x * sin(2 * PI * k * n / N);
+      }
+      pw[k] += re * re + im * im;
+    }
+  }
+  double band = 0;
+  int pk = TREMOR_BIN_LO;
+  for (int k = TREMOR_BIN_LO; k <= TREMOR_BIN_HI; k++) {
+    band += pw[k];
+    if (pw[k] > pw[pk]) pk = k;
+  }
+  double a = sqrt(pw[pk - 1]), b = sqrt(pw[pk]), c = sqrt(pw[pk + 1]);
+  double den = a - 2 * b + c;
+  *hz  = (pk + (den < 0 ? 0.5 * (a - c) / den : 0)) * IMU_RATE_HZ / N;
+  *dps = sqrt(band * 2 / (N * s2)) / TREMOR_LSB_DPS;
+}
+
+struct Run {
+  int    windows = 0, found = 0;
+  double firstFound = -1;             // s
+};
+
+static Run run(TremorEngine& eng, const Trace& tr) {
+  Run r;
+  int n = (int)tr.g[0].size();
+  for (int i = 0; i < n; i++) {
+    eng.push(tr.g[0][i], tr.g[1][i], tr.g[2][i], true);
+    TremorResult res;
+    if (!eng.analyze(res)) continue;
+    r.windows++;
+    if (!res.present) continue;
+    if (r.firstFound < 0) r.firstFound = (double)(i + 1) / IMU_RATE_HZ;
+    r.found++;
+  }
+  return r;
+}
+
+int main() {
+  int fail = 0;
+
+  printf("Tremor spectrum (tiga_tremor.h), %d-point window every %.2f s, %d s per trace\n",
+         TREMOR_N, (double)TREMOR_HOP / IMU_RATE_HZ, BENCH_SECS);
+
+  // ── Accuracy ──
+  printf("\n  %6s %6s %6s %7s %8s %9s %8s\n",
+         "Hz", "dps", "noise", "found", "Hz err", "dps err", "vs DFT");
+  const double freqs[] = { 4.5, 5.5, 7.0, 9.0, 11.5 };
+  const double rmss[]  = { 1.5, 3.0, 10.0, 30.0 };
+  const double noises[] = { 0.5, 3.0 };
+  double worstRef = 0;
+  uint32_t seed = BENCH_SEED;
+  for (double hz : freqs) {
+    for (double rms : rmss) {
+      for (double noise : noises) {
+        Signal sig = { hz, rms, noise, 0, 0 };
+        Trace tr = makeTrace(sig, seed++);
+        TremorEngine eng;
+        // Noise in the band adds to the tone's power; its RMS over three axes
+        double bandNoise = noise * sqrt(3.0 * (TREMOR_BIN_HI - TREMOR_BIN_LO + 1) / (TREMOR_N / 2.0));
+        int n = (int)tr.g[0].size();
+        int windows = 0, found = 0;
+        double hzErr = 0, dpsErr = 0, refErr = 0;
+        for (int i = 0; i < n; i++) {
+          eng.push(tr.g[0][i], tr.g[1][i], tr.g[2][i], true);
+          TremorResult res;
+          if (!eng.analyze(res)) continue;
+          windows++;
+          if (windows % 8 == 1) {            // the DFT is slow; a sample of windows
+            double rhz, rdps;
+            reference(tr, i + 1, &rhz, &rdps);
+            refErr = fmax(refErr, fmax(fabs(res.dps - rdps) / rdps, fabs(res.hz - rhz) / rhz));
+          }
+          if (!res.present) continue;
+          found++;
+          hzErr = fmax(hzErr, fabs(res.hz - hz));
+          double expect = sqrt(rms * rms + bandNoise * bandNoise);
+          if (rms >= 2 * bandNoise) dpsErr = fmax(dpsErr, fabs(res.dps - expect) / expect);
+        }
+        worstRef = fmax(worstRef, refErr);
+        bool bad = (found && (hzErr > 0.2 || dpsErr > 0.15)) ||
+                   (rms >= 3 && found < windows) || refErr > 0.01;
+        printf("  %6.1f %6.1f %6.1f %3d/%-3d %8.3f %8.1f%% %7.3f%%%s\n", hz, rms, noise,
+               found, windows, hzErr, dpsErr * 100, refErr * 100, bad ? "  <- FAIL" : "");
+        if (bad) fail = 1;
+      }
+    }
+  }
+  printf("  engine vs direct DFT: at most %.3f%% apart\n", worstRef * 100);
+
+  // ── Rejection ──
+  struct Reject { const char* name; Signal sig; };
+  const Reject rejects[] = {
+    { "quiet",          { 0,   0,   0.5, 0,  0 } },
+    { "noisy",          { 0,   0,   3.0, 0,  0 } },
+    { "drift",          { 0,   0,   0.5, 40, 0 } },
+    { "2 Hz tone",      { 2.0, 10,  0.5, 0,  0 } },
+    { "16 Hz tone",     { 16,  10,  0.5, 0,  0 } },
+  };
+  printf("\n  rejection (no tremor in band)\n");
+  for (const Reject& rj : rejects) {
+    Trace tr = makeTrace(rj.sig, seed++);
+    TremorEngine eng;
+    Run r = run(eng, tr);
+    printf("    %-12s %3d/%-3d found%s\n", rj.name, r.found, r.windows, r.found ? "  <- FAIL" : "");
+    if (r.found) fail = 1;
+  }
+
+  // ── Latency ──
+  printf("\n  latency: 5 dps tone switched on mid-trace\n");
+  double worstLat = 0;
+  for (int k = 0; k < 8; k++) {
+    Signal sig = { 5.0 + k * 0.8, 5.0, 0.5, 0, 20.0 + k * 0.37 };
+    Trace tr = makeTrace(sig, seed++);
+    TremorEngine eng;
+    Run r = run(eng, tr);
+    double lat = r.firstFound < 0 ? 99 : r.firstFound - sig.onset;
+    worstLat = fmax(worstLat, lat);
+  }
+  printf("    first window to find it: at most %.2f s after onset\n", worstLat);
+  if (worstLat > 3.0) fail = 1;
+
+  // ── Cost ──
+  {
+    Signal sig = { 6.0, 5.0, 1.0, 0, 0 };
+    Trace tr = makeTrace(sig, seed++);
+    TremorEngine eng;
+    int n = (int)tr.g[0].size();
+    uint64_t pushNs = 0, anNs = 0;
+    int analyses = 0;
+    for (int rep = 0; rep < 20; rep++) {
+      for (int i = 0; i < n; i++) {
+        uint64_t t0 = nowNs();
+        eng.push(tr.g[0][i], tr.g[1][i], tr.g[2][i], true);
+        uint64_t t1 = nowNs();
+        pushNs += t1 - t0;
+        if (!eng.due()) continue;
+        TremorResult res;
+        eng.analyze(res);
+        anNs += nowNs() - t1;
+        analyses++;
+      }
+    }
+    printf("\n  per analyze(): %.1f us (3 axes); per push(): %.1f ns (incl. timer)\n",
+           anNs / 1000.0 / analyses, (double)pushNs / (20.0 * n));
+    printf("  state: %u bytes, no heap; a result every %.2f s\n",
+           (unsigned)sizeof(TremorEngine), (double)TREMOR_HOP / IMU_RATE_HZ);
+    printf("  (host FPU; the ESP32-S3 does single-precision floats in hardware)\n");
+  }
+
+  printf("  %s\n", fail ? "FAILED" : "all checks passed");
+  return fail;
+}
@@ -0,0 +1,721 @@
+// ============================================================
+// fall_eval.cpp — fall detector over labelled captures
+// ============================================================
+// Replays every .tigc capture in a directory through the IMU
+// pipeline as the firmware runs it (motionBatch, fusionBatch,
+// then tiga_fall.h), with v6a's two-sample rule alongside, and
+// scores both against the labels:
+//
+//   <name>.tigc   a capture: CAPTURE_MODE on the watch, or --make
+//   <name>.txt    its labels, one per line:   fall <seconds>
+//                 seconds from the first IMU sample to the impact.
+//                 No file, or no such line, means no falls in it;
+//                 anything else on a line after # is a comment
+//
+// A report from FALL_EVAL_BEFORE_S before to FALL_EVAL_AFTER_S
+// after a labelled impact is a hit, any other report a false
+// alarm. Out come precision, recall, false alarms per hour,
+// latency from the impact to the report, and CPU: ns per sample
+// for the fall stage and what that is per hour of data, next to
+// motion + fusion. -v prints every candidate's features and
+// verdict.
+//
+// --make DIR writes a synthetic labelled set to start from, made
+// the way bench_fusion.cpp makes wrist motion (body rates and
+// linear acceleration integrated into the true orientation,
+// turned into MPU6050 counts with offsets and noise):
+//
+//   falls   forward, backward, sideways, a soft slump, off a
+//           chair, and a fall followed by struggling to get up
+//   ADL     sitting down hard and normally, lying down on a bed,
+//           flopping onto a sofa, an arm dropped onto a table,
+//           knocks, a stumble caught, a jump; and ten-minute days
+//           of walking, standing, gestures, knocks and sitting
+//
+// The synthetic set only says the detector does what it was
+// built to do; the numbers that matter come from real captures
+// labelled the same way.
+//
+//   make falls                         synthetic set, with checks
+//   build/fall_eval [-v] DIR           any directory of captures
+//   build/fall_eval --min-recall 0.9 --min-precision 0.9 DIR
+// ============================================================
+
+#include "tiga_capture.h"
+#include "tiga_fall.h"
+#include "tiga_fusion.h"
+
+#include <dirent.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#define FALL_EVAL_BEFORE_S   1.0    // a report this early still counts
+#define FALL_EVAL_AFTER_S   10.0    // ...and this late
+#define MAKE_VARIANTS        6      // of each synthetic activity
+#define MAKE_SECS           40      // each, but the days
+#define MAKE_DAY_SECS      600
+#define MAKE_DAYS            6
+
+static const double PI  = 3.14159265358979;
+static const double RAD = PI / 180;
+
+static uint64_t nowNs() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+// ── v6a's rule ───────────────────────────────────────────────
+// As the sketch had it: above 3g, then 250 ms later below 0.5g
+// and turned 30° from the up vector of up to 400 ms before
+struct V6aFall {
+  bool     inFall = false;
+  uint32_t fallT = 0;
+  int16_t  ring[8][3] = {};
+  uint8_t  ringIdx = 0;
+  int16_t  ref[3] = {};
+
+  bool push(const ImuSample& s) {
+    static const int32_t cosTurn = (int32_t)(cosf(30 * 3.14159265f / 180) * 16384);
+    uint32_t t = imuSampleMs(s.idx);
+    bool fell = false;
+    if (s.g2 > motionG2(3.0f) && !inFall) {
+      inFall = true; fallT = t;
+      memcpy(ref, ring[ringIdx], sizeof(ref));
+    }
+    if (inFall && t - fallT > 250) {
+      int32_t dot = ((int32_t)s.up[0] * ref[0] + (int32_t)s.up[1] * ref[1]
+                   + (int32_t)s.up[2] * ref[2]) >> 14;
+      fell = s.g2 < motionG2(0.5f) && dot < cosTurn;
+      inFall = false;
+    }
+    if (s.idx % (IMU_RATE_HZ / 20) == 0) {
+      memcpy(ring[ringIdx], s.up, sizeof(ring[0]));
+      ringIdx = (ringIdx + 1) % 8;
+    }
+    return fell;
+  }
+};
+
+// ── Synthetic set ────────────────────────────────────────────
+static uint32_t rng = 1;
+
+static double uni() {
+  rng ^= rng << 13; rng ^= rng >> 17; rng ^= rng << 5;
+  return (rng & 0xFFFFFF) / 16777216.0;
+}
+
+static double gauss() {
+  double s = 0;
+  for (int k = 0; k < 4; k++) s += uni() - 0.5;
+  return s * 1.732;
+}
+
+static double vary(double v, double by) { return v * (1 + by * (2 * uni() - 1)); }
+
+static int16_t clamp16(double v) {
+  if (v >  32767) return  32767;
+  if (v < -32768) return -32768;
+  return (int16_t)lrint(v);
+}
+
+struct Quat { double w, x, y, z; };
+
+static Quat qmul(const Quat& a, const Quat& b) {
+  return { a.w * b.w - a.x * b.x - a.y * b.y - a.z * b.z,
+           a.w * b.x + a.x * b.w + a.y * b.z - a.z * b.y,
+           a.w * b.y - a.x * b.z + a.y * b.w + a.z * b.x,
+           a.w * b.z + a.x * b.y - a.y * b.x + a.z * b.w };
+}
+
+static void toBody(const Quat& q, const double v[3], double out[3]) {
+  Quat p = qmul(qmul({ q.w, -q.x, -q.y, -q.z }, { 0, v[0], v[1], v[2] }), q);
+  out[0] = p.x; out[1] = p.y; out[2] = p.z;
+}
+
+static Quat axisAngle(double x, double y, double z, double deg) {
+  double n = sqrt(x * x + y * y + z * z), h = deg * RAD / 2;
+  return { cos(h), sin(h) * x / n, sin(h) * y / n, sin(h) * z / n };
+}
+
+enum Before : uint8_t { BEFORE_WALK, BEFORE_SIT };
+enum After  : uint8_t { AFTER_LIE, AFTER_STRUGGLE, AFTER_SIT, AFTER_WALK, AFTER_STAND };
+
+// A body movement ending in (maybe) an impact: an optional push
+// up, a descent at -a g, braking at +b g, then an impact pulse
+// (half sine, ti s) taking out whatever speed is left — or of
+// height knockG when there's no descent. The wrist turns `turn`
+// degrees over the descent and braking. With recoil the hand is
+// pulled back down and stopped again just after the impact (off
+// a table edge, into the lap): below 0.5g a quarter of a second
+// on, which is what v6a took for a fall.
+struct Activity {
+  const char* name;
+  bool   fall;
+  double pre, tpre;
+  double a, ta;
+  double b, tb;
+  double ti;
+  double knockG;
+  double turn;
+  double axis[3];
+  Before before;
+  After  after;
+  bool   recoil;
+};
+
+static const Activity activities[] = {
+  //  name            fall  pre   tpre  a     ta    b     tb    ti    knock turn   axis        before       after
+  { "fall_forward",   true, 0,    0,    0.85, 0.42, 0,    0,    0.06, 0,    90,  { 0, 1, 0 }, BEFORE_WALK, AFTER_LIE },
+  { "fall_backward",  true, 0,    0,    0.80, 0.45, 0,    0,    0.08, 0,   -110, { 0, 1, 0.3 }, BEFORE_WALK, AFTER_LIE },
+  { "fall_sideways",  true, 0,    0,    0.75, 0.42, 0,    0,    0.07, 0,    80,  { 1, 0, 0 }, BEFORE_WALK, AFTER_LIE },
+  { "fall_slump",     true, 0,    0,    0.30, 0.50, 0.10, 0.40, 0.12, 0,    60,  { 1, 0.5, 0 }, BEFORE_WALK, AFTER_LIE },
+  { "fall_chair",     true, 0,    0,    0.80, 0.38, 0,    0,    0.06, 0,    70,  { 0, 1, 0.5 }, BEFORE_SIT,  AFTER_LIE },
+  { "fall_struggle",  true, 0,    0,    0.85, 0.42, 0,    0,    0.06, 0,    90,  { 0.3, 1, 0 }, BEFORE_WALK, AFTER_STRUGGLE },
+  { "adl_hard_sit",   false, 0,   0,    0.50, 0.42, 0,    0,    0.10, 0,    60,  { 0, 1, 0 }, BEFORE_WALK, AFTER_SIT },
+  { "adl_sit",        false, 0,   0,    0.25, 0.50, 0.25, 0.45, 0.10, 0,    60,  { 0, 1, 0 }, BEFORE_WALK, AFTER_SIT },
+  { "adl_bed",        false, 0,   0,    0.30, 0.60, 0.25, 0.60, 0.20, 0,    80,  { 1, 0, 0 }, BEFORE_SIT,  AFTER_LIE },
+  { "adl_sofa_flop",  false, 0,   0,    0.70, 0.40, 0,    0,    0.15, 0,    70,  { 1, 0.5, 0 }, BEFORE_WALK, AFTER_LIE },
+  { "adl_arm_drop",   false, 0,   0,    0.90, 0.25, 0,    0,    0.03, 0,    70,  { 0, 1, 0 }, BEFORE_SIT,  AFTER_SIT, true },
+  { "adl_knock",      false, 0,   0,    0,    0,    0,    0,    0.03, 2.8,  0,   { 0, 0, 1 }, BEFORE_WALK, AFTER_STAND },
+  { "adl_stumble",    false, 0,   0,    0.60, 0.25, 1.00, 0.15, 0.05, 0,    25,  { 0, 1, 0 }, BEFORE_WALK, AFTER_WALK },
+  { "adl_jump",       false, 1.2, 0.20, 1.00, 0.48, 0,    0,    0.08, 0,    10,  { 0, 1, 0 }, BEFORE_WALK, AFTER_WALK },
+};
+
+enum SegKind : uint8_t { SEG_STAND, SEG_WALK, SEG_SIT, SEG_LIE, SEG_STRUGGLE, SEG_GESTURE, SEG_EVENT };
+
+struct Seg {
+  SegKind   kind;
+  double    t0, t1;
+  Activity  act;            // SEG_EVENT: this instance's numbers
+  double    axis[3];        // SEG_GESTURE
+};
+
+// Seconds from the start of an event to its impact, and how long
+// it lasts
+static double eventImpact(const Activity& a) { return a.tpre + a.ta + a.tb; }
+static double eventLength(const Activity& a) { return eventImpact(a) + a.ti; }
+static double eventEnd(const Activity& a) { return eventLength(a) + (a.recoil ? 0.32 : 0); }
+
+// Speed left at the impact, m/s down
+static double eventSpeed(const Activity& a) {
+  return 9.80665 * (a.a * a.ta - a.b * a.tb - a.pre * a.tpre);
+}
+
+// Wrist drop from the top of the movement to the impact, m
+static double eventDrop(const Activity& a) {
+  double g = 9.80665, v = g * a.pre * a.tpre, h = v * a.tpre / 2, top = h;
+  double dt = 1e-4;
+  for (double t = 0; t < a.ta; t += dt) { v -= g * a.a * dt; h += v * dt; top = fmax(top, h); }
+  for (double t = 0; t < a.tb; t += dt) { v += g * a.b * dt; h += v * dt; }
+  return top - h;
+}
+
+static void eventMotion(const Activity& a, double u, double w[3], double lin[3]) {
+  double turnTime = a.ta + a.tb;
+  if (u >= a.tpre && u < a.tpre + turnTime && a.turn != 0) {
+    double n = sqrt(a.axis[0] * a.axis[0] + a.axis[1] * a.axis[1] + a.axis[2] * a.axis[2]);
+    double r = a.turn / turnTime / n;
+    for (int k = 0; k < 3; k++) w[k] = a.axis[k] * r;
+  }
+  if (u < a.tpre) lin[2] = a.pre;
+  else if (u < a.tpre + a.ta) lin[2] = -a.a;
+  else if (u < eventImpact(a)) lin[2] = a.b;
+  else if (u < eventLength(a)) {
+    double v = eventSpeed(a);
+    double p = a.knockG > 0 ? a.knockG : v > 0 ? v * PI / (2 * 9.80665 * a.ti) : 0;
+    double s = sin(PI * (u - eventImpact(a)) / a.ti);
+    lin[2] = p * s;
+    lin[0] = 0.5 * p * s;
+    lin[1] = -0.3 * p * s;
+  } else if (a.recoil && u < eventLength(a) + 0.32) {
+    double v = u - eventLength(a);
+    if (v >= 0.17) lin[2] = v < 0.245 ? -0.7 : 0.7;
+  }
+}
+
+static void walkMotion(double t, double spm, double w[3], double lin[3]) {
+  double f = spm / 60, ph = 2 * PI * f * t;
+  w[0] = 12 * cos(ph);
+  w[1] = 60 * cos(ph / 2);
+  w[2] = 15 * sin(ph / 2);
+  lin[0] = 0.25 * sin(ph / 2 + 1);
+  lin[1] = 0.10 * sin(ph);
+  lin[2] = 0.30 * sin(ph) + 0.08 * sin(2 * ph);
+}
+
+static void standMotion(double u, double w[3], double lin[3]) {
+  w[0] = 2.0 * sin(2 * PI * 0.30 * u);
+  w[1] = 1.5 * sin(2 * PI * 0.20 * u + 1);
+  w[2] = 1.0 * sin(2 * PI * 0.45 * u + 2);
+  lin[0] = 0.010 * sin(2 * PI * 0.5 * u);
+  lin[2] = 0.010 * sin(2 * PI * 0.7 * u);
+}
+
+// Still, a hand moved somewhere and back every 6 s
+static void sitMotion(double u, double w[3], double lin[3]) {
+  double v = fmod(u, 6.0);
+  if (v >= 4 && v < 5) w[2] = 40 * sin(2 * PI * (v - 4));
+  lin[2] = 0.005 * sin(2 * PI * 0.25 * u);
+}
+
+// Rocking to a stop, then breathing
+static void lieMotion(double u, double w[3], double lin[3]) {
+  if (u < 0.6) w[0] = 50 * exp(-u / 0.2) * sin(2 * PI * 2.5 * u);
+  lin[2] = 0.008 * sin(2 * PI * 0.25 * u);
+}
+
+static void struggleMotion(double u, double w[3], double lin[3]) {
+  if (u >= 2.5) { lieMotion(u - 2.5, w, lin); return; }
+  w[0] = 90 * sin(2 * PI * 1.3 * u);
+  w[1] = 60 * sin(2 * PI * 0.9 * u + 1);
+  w[2] = 40 * sin(2 * PI * 1.7 * u);
+  lin[0] = 0.30 * sin(2 * PI * 1.1 * u);
+  lin[1] = 0.20 * sin(2 * PI * 1.9 * u);
+  lin[2] = 0.35 * sin(2 * PI * 1.5 * u);
+}
+
+// Half a second at 150°/s about some axis, then back
+static void gestureMotion(double u, const double axis[3], double w[3]) {
+  if (u >= 1) return;
+  double r = u < 0.5 ? 150 : -150;
+  for (int k = 0; k < 3; k++) w[k] = axis[k] * r;
+}
+
+struct Script {
+  std::vector<Seg> segs;
+  double spm;
+  size_t cur = 0;
+
+  void add(SegKind k, double t0, double t1) {
+    Seg s = {};
+    s.kind = k; s.t0 = t0; s.t1 = t1;
+    segs.push_back(s);
+  }
+
+  // Segment in force at t (t only moves forward)
+  void motion(double t, double w[3], double lin[3]) {
+    w[0] = w[1] = w[2] = 0;
+    lin[0] = lin[1] = lin[2] = 0;
+    while (cur + 1 < segs.size() && t >= segs[cur].t1) cur++;
+    const Seg& s = segs[cur];
+    double u = t - s.t0;
+    switch (s.kind) {
+      case SEG_STAND:    standMotion(u, w, lin); break;
+      case SEG_WALK:     walkMotion(u, spm, w, lin); break;
+      case SEG_SIT:      sitMotion(u, w, lin); break;
+      case SEG_LIE:      lieMotion(u, w, lin); break;
+      case SEG_STRUGGLE: struggleMotion(u, w, lin); break;
+      case SEG_GESTURE:  gestureMotion(u, s.axis, w); break;
+      case SEG_EVENT:    eventMotion(s.act, u, w, lin); break;
+    }
+  }
+};
+
+static FILE*    makeOut;
+static uint32_t makeClockUs;
+
+static uint16_t makeWrite(const uint8_t* p, uint16_t n) { return (uint16_t)fwrite(p, 1, n, makeOut); }
+static uint32_t makeClock() { return makeClockUs; }
+
+// Integrates the script at 1 kHz and writes it as a capture
+static bool writeCapture(const char* path, Script& sc, double secs) {
+  makeOut = fopen(path, "wb");
+  if (!makeOut) return false;
+  CaptureRecorder* rec = new CaptureRecorder({ makeWrite }, makeClock);
+  makeClockUs = 0;
+  rec->begin(0);
+  rec->config(IMU_RATE_HZ, 0, MOTION_LSB_PER_G, FUSION_GYRO_LSB_DPS * 10);
+
+  const int sub = 5;
+  const double dt = 1.0 / IMU_RATE_HZ / sub;
+  double abias[3], gbias[3];
+  for (int k = 0; k < 3; k++) { abias[k] = 0.015 * (2 * uni() - 1); gbias[k] = 1.5 * (2 * uni() - 1); }
+  Quat q = axisAngle(uni() - 0.5, uni() - 0.5, 0.2 * (uni() - 0.5), 40 * uni());
+  ImuSample burst[CAP_IMU_MAX_SAMPLES];
+  uint8_t nb = 0;
+  uint32_t n = (uint32_t)(secs * IMU_RATE_HZ);
+  for (uint32_t i = 0; i < n; i++) {
+    double w[3], lin[3];
+    for (int k = 0; k < sub; k++) {
+      sc.motion((i * sub + k) * dt, w, lin);
+      double mag = sqrt(w[0] * w[0] + w[1] * w[1] + w[2] * w[2]);
+      if (mag > 0) q = qmul(q, axisAngle(w[0], w[1], w[2], mag * dt));
+    }
+    sc.motion((i + 1) * sub * dt, w, lin);
+    double f[3] = { lin[0], lin[1], lin[2] + 1 }, fb[3];
+    toBody(q, f, fb);
+    ImuSample& s = burst[nb++];
+    memset(&s, 0, sizeof(s));
+    s.idx = i;
+    s.ax = clamp16((fb[0] + abias[0] + 0.008 * gauss()) * MOTION_LSB_PER_G);
+    s.ay = clamp16((fb[1] + abias[1] + 0.008 * gauss()) * MOTION_LSB_PER_G);
+    s.az = clamp16((fb[2] + abias[2] + 0.008 * gauss()) * MOTION_LSB_PER_G);
+    s.gx = clamp16((w[0] + gbias[0] + 0.3 * gauss()) * FUSION_GYRO_LSB_DPS);
+    s.gy = clamp16((w[1] + gbias[1] + 0.3 * gauss()) * FUSION_GYRO_LSB_DPS);
+    s.gz = clamp16((w[2] + gbias[2] + 0.3 * gauss()) * FUSION_GYRO_LSB_DPS);
+    if (nb == CAP_IMU_MAX_SAMPLES || i + 1 == n) {
+      makeClockUs = (uint32_t)((uint64_t)(i + 1) * 1000000 / IMU_RATE_HZ);
+      rec->imu(burst, nb);
+      rec->drain();
+      nb = 0;
+    }
+  }
+  bool ok = rec->dropped == 0 && fclose(makeOut) == 0;
+  delete rec;
+  return ok;
+}
+
+static Activity instance(const Activity& base) {
+  Activity a = base;
+  a.a = vary(a.a, 0.08);  a.ta = vary(a.ta, 0.10);
+  a.b = vary(a.b, 0.10);  a.tb = vary(a.tb, 0.10);
+  a.pre = vary(a.pre, 0.08);
+  a.ti = vary(a.ti, 0.25);
+  a.knockG = vary(a.knockG, 0.2);
+  a.turn = vary(a.turn, 0.2) * (uni() < 0.5 ? -1 : 1);
+  for (int k = 0; k < 3; k++) a.axis[k] += 0.3 * (uni() - 0.5);
+  if (eventSpeed(a) < 0) a.tb = (a.a * a.ta - a.pre * a.tpre) / fmax(a.b, 1e-3);
+  return a;
+}
+
+static void pushEvent(Script& sc, const Activity& a, double t0) {
+  sc.add(SEG_EVENT, t0, t0 + eventEnd(a));
+  sc.segs.back().act = a;
+}
+
+static void pushAfter(Script& sc, After after, double t0, double end) {
+  switch (after) {
+    case AFTER_LIE:      sc.add(SEG_LIE, t0, end); break;
+    case AFTER_STRUGGLE: sc.add(SEG_STRUGGLE, t0, end); break;
+    case AFTER_SIT:      sc.add(SEG_SIT, t0, end); break;
+    case AFTER_STAND:    sc.add(SEG_STAND, t0, end); break;
+    case AFTER_WALK:
+      sc.add(SEG_STAND, t0, t0 + 1.5);
+      sc.add(SEG_WALK, t0 + 1.5, end);
+      break;
+  }
+}
+
+// A ten-minute day: walks, standing, sitting down and getting up,
+// gestures, knocks, the odd stumble or jump. No falls.
+static void makeDay(Script& sc, double secs) {
+  const Activity& knock   = activities[11];
+  const Activity& stumble = activities[12];
+  const Activity& jump    = activities[13];
+  const Activity& sitHard = activities[6];
+  const Activity& sit     = activities[7];
+  double t = 0;
+  sc.add(SEG_STAND, 0, 2);
+  t = 2;
+  while (t < secs - 30) {
+    double r = uni();
+    if (r < 0.35) {
+      double d = 20 + 60 * uni();
+      sc.add(SEG_WALK, t, t + d);
+      t += d;
+    } else if (r < 0.50) {
+      double d = 5 + 15 * uni();
+      sc.add(SEG_STAND, t, t + d);
+      t += d;
+    } else if (r < 0.65) {
+      Activity a = instance(uni() < 0.5 ? sitHard : sit);
+      pushEvent(sc, a, t);
+      t += eventEnd(a);
+      double d = 15 + 30 * uni();
+      sc.add(SEG_SIT, t, t + d);
+      t += d;
+      Activity up = instance(sit);           // getting up: the sit backwards
+      up.a = -up.a; up.b = -up.b; up.ti = 0.01;
+      up.turn = -a.turn;
+      pushEvent(sc, up, t);
+      t += eventEnd(up);
+    } else if (r < 0.80) {
+      Seg g = {};
+      g.kind = SEG_GESTURE; g.t0 = t; g.t1 = t + 1.5;
+      double ax = uni() - 0.5, ay = uni() - 0.5, az = uni() - 0.5;
+      double n = sqrt(ax * ax + ay * ay + az * az) + 1e-9;
+      g.axis[0] = ax / n; g.axis[1] = ay / n; g.axis[2] = az / n;
+      sc.segs.push_back(g);
+      t += 1.5;
+    } else {
+      const Activity& base = r < 0.9 ? knock : r < 0.95 ? stumble : jump;
+      sc.add(SEG_STAND, t, t + 2);
+      t += 2;
+      Activity a = instance(base);
+      pushEvent(sc, a, t);
+      t += eventEnd(a);
+      sc.add(SEG_STAND, t, t + 3);
+      t += 3;
+    }
+  }
+  sc.add(SEG_STAND, t, secs);
+}
+
+static int makeSet(const char* dir) {
+  mkdir(dir, 0755);
+  int files = 0;
+  char path[512];
+  for (const Activity& base : activities) {
+    for (int v = 1; v <= MAKE_VARIANTS; v++) {
+      rng = 0x9E3779B9u * (uint32_t)(files + 1);
+      Script sc;
+      sc.spm = 95 + 25 * uni();
+      Activity a = instance(base);
+      double te = 16 + 4 * uni();
+      if (a.before == BEFORE_WALK) {
+        sc.add(SEG_STAND, 0, 2);
+        sc.add(SEG_WALK, 2, te - 4);
+        sc.add(SEG_STAND, te - 4, te);
+      } else {
+        sc.add(SEG_SIT, 0, te);
+      }
+      pushEvent(sc, a, te);
+      pushAfter(sc, a.after, te + eventEnd(a), MAKE_SECS);
+
+      snprintf(path, sizeof(path), "%s/%s_%d.tigc", dir, base.name, v);
+      if (!writeCapture(path, sc, MAKE_SECS)) { fprintf(stderr, "fall_eval: can't write %s\n", path); return 2; }
+      snprintf(path, sizeof(path), "%s/%s_%d.txt", dir, base.name, v);
+      FILE* f = fopen(path, "w");
+      if (!f) { fprintf(stderr, "fall_eval: can't write %s\n", path); return 2; }
+      fprintf(f, "# %s: wrist drop %.2f m, %.1f m/s at the impact\n",
+              base.name, eventDrop(a), fmax(eventSpeed(a), 0.0));
+      if (a.fall) fprintf(f, "fall %.3f\n", te + eventImpact(a));
+      fclose(f);
+      files++;
+    }
+  }
+  for (int d = 1; d <= MAKE_DAYS; d++) {
+    rng = 0x85EBCA6Bu * (uint32_t)d;
+    Script sc;
+    sc.spm = 95 + 25 * uni();
+    makeDay(sc, MAKE_DAY_SECS);
+    snprintf(path, sizeof(path), "%s/adl_day_%d.tigc", dir, d);
+    if (!writeCapture(path, sc, MAKE_DAY_SECS)) { fprintf(stderr, "fall_eval: can't write %s\n", path); return 2; }
+    snprintf(path, sizeof(path), "%s/adl_day_%d.txt", dir, d);
+    FILE* f = fopen(path, "w");
+    if (f) { fprintf(f, "# ten minutes of ordinary activity, no falls\n"); fclose(f); }
+    files++;
+  }
+  printf("fall_eval: %d labelled captures in %s\n", files, dir);
+  return 0;
+}
+
+// ── Evaluation ───────────────────────────────────────────────
+struct Score {
+  uint32_t labels = 0, hits = 0, alarms = 0;
+  double   latSum = 0, latMax = 0;
+
+  void add(const Score& o) {
+    labels += o.labels; hits += o.hits; alarms += o.alarms;
+    latSum += o.latSum; latMax = fmax(latMax, o.latMax);
+  }
+};
+
+// Each report matches the first labelled impact it's in the
+// window of that isn't matched yet
+static Score score(const std::vector<double>& labels, const std::vector<double>& reports) {
+  Score s;
+  s.labels = (uint32_t)labels.size();
+  std::vector<bool> used(labels.size(), false);
+  for (double r : reports) {
+    bool hit = false;
+    for (size_t i = 0; i < labels.size() && !hit; i++) {
+      if (used[i] || r < labels[i] - FALL_EVAL_BEFORE_S || r > labels[i] + FALL_EVAL_AFTER_S) continue;
+      used[i] = hit = true;
+      s.hits++;
+      s.latSum += r - labels[i];
+      s.latMax = fmax(s.latMax, r - labels[i]);
+    }
+    if (!hit) s.alarms++;
+  }
+  return s;
+}
+
+struct Group {
+  std::string name;
+  uint32_t    captures = 0;
+  double      secs = 0;
+  Score       now, v6a;
+};
+
+static bool endsWith(const std::string& s, const char* tail) {
+  size_t n = strlen(tail);
+  return s.size() >= n && s.compare(s.size() - n, n, tail) == 0;
+}
+
+// "fall_forward_3" → "fall_forward": variants of one activity
+static std::string groupOf(const std::string& name) {
+  size_t u = name.find_last_of('_');
+  if (u == std::string::npos || u + 1 == name.size()) return name;
+  for (size_t i = u + 1; i < name.size(); i++) if (name[i] < '0' || name[i] > '9') return name;
+  return name.substr(0, u);
+}
+
+static std::vector<double> readLabels(const std::string& path) {
+  std::vector<double> out;
+  FILE* f = fopen(path.c_str(), "r");
+  if (!f) return out;
+  char line[256];
+  while (fgets(line, sizeof(line), f)) {
+    char* hash = strchr(line, '#');
+    if (hash) *hash = 0;
+    double t;
+    if (sscanf(line, " fall %lf", &t) == 1) out.push_back(t);
+  }
+  fclose(f);
+  std::sort(out.begin(), out.end());
+  return out;
+}
+
+static const char* verdictName(uint8_t v) {
+  switch (v) {
+    case FALL_NO_DROP:    return "no drop";
+    case FALL_NOT_STILL:  return "not still";
+    case FALL_NOT_TURNED: return "not turned";
+    case FALL_CONFIRMED:  return "FALL";
+    default:              return "?";
+  }
+}
+
+static void usage() {
+  fprintf(stderr,
+          "usage: fall_eval [-v] [--min-precision P] [--min-recall R] DIR\n"
+          "       fall_eval --make DIR      write a synthetic labelled set\n");
+}
+
+int main(int argc, char** argv) {
+  const char* dir = nullptr;
+  bool verbose = false;
+  double minPrecision = 0, minRecall = 0;
+  for (int i = 1; i < argc; i++) {
+    if (!strcmp(argv[i], "--make") && i + 1 < argc) return makeSet(argv[i + 1]);
+    else if (!strcmp(argv[i], "-v")) verbose = true;
+    else if (!strcmp(argv[i], "--min-precision") && i + 1 < argc) minPrecision = atof(argv[++i]);
+    else if (!strcmp(argv[i], "--min-recall") && i + 1 < argc) minRecall = atof(argv[++i]);
+    else if (argv[i][0] != '-' && !dir) dir = argv[i];
+    else { usage(); return 2; }
+  }
+  if (!dir) { usage(); return 2; }
+
+  std::vector<std::string> names;
+  DIR* d = opendir(dir);
+  if (!d) { fprintf(stderr, "fall_eval: can't open %s\n", dir); return 2; }
+  while (struct dirent* e = readdir(d)) {
+    std::string n = e->d_name;
+    if (endsWith(n, ".tigc")) names.push_back(n.substr(0, n.size() - 5));
+  }
+  closedir(d);
+  std::sort(names.begin(), names.end());
+  if (names.empty()) { fprintf(stderr, "fall_eval: no .tigc captures in %s\n", dir); return 2; }
+
+  std::vector<Group> groups;
+  Group all;
+  uint64_t samples = 0, pipeNs = 0, fallNs = 0, oldNs = 0;
+  uint32_t candidates = 0, noDrop = 0, notStill = 0, notTurned = 0;
+
+  for (const std::string& name : names) {
+    std::string base = std::string(dir) + "/" + name;
+    CaptureReader rd;
+    if (!rd.open((base + ".tigc").c_str())) { fprintf(stderr, "fall_eval: %s.tigc unreadable\n", name.c_str()); continue; }
+    std::vector<double> labels = readLabels(base + ".txt"), reports, old;
+
+    FusionFilter* fusion = new FusionFilter;
+    FallDetector fall;
+    V6aFall v6a;
+    ImuSample burst[CAP_IMU_MAX_SAMPLES];
+    CapRecord r;
+    bool first = true, rateOk = true;
+    uint32_t idx0 = 0, idxLast = 0, judged = 0;
+    while (rd.next(r)) {
+      if (r.type == CAP_CONFIG && capGet16(r.payload) != IMU_RATE_HZ) rateOk = false;
+      if (r.type != CAP_IMU) continue;
+      uint8_t n = capImuCount(r);
+      for (uint8_t i = 0; i < n; i++) capImuSample(r, i, burst[i]);
+      if (first) { idx0 = burst[0].idx; first = false; }
+      idxLast = burst[n - 1].idx;
+      samples += n;
+
+      uint64_t t0 = nowNs();
+      motionBatch(burst, n);
+      fusionBatch(*fusion, burst, n);
+      uint64_t t1 = nowNs();
+      for (uint8_t i = 0; i < n; i++)
+        if (fall.push(burst[i])) reports.push_back((burst[i].idx - idx0) / (double)IMU_RATE_HZ);
+      uint64_t t2 = nowNs();
+      for (uint8_t i = 0; i < n; i++)
+        if (v6a.push(burst[i])) old.push_back((burst[i].idx - idx0) / (double)IMU_RATE_HZ);
+      uint64_t t3 = nowNs();
+      pipeNs += t1 - t0; fallNs += t2 - t1; oldNs += t3 - t2;
+
+      uint32_t done = fall.noDrop + fall.notStill + fall.notTurned + fall.falls;
+      if (verbose && done != judged) {
+        const FallFeatures& f = fall.last;
+        printf("  %-22s %7.2f s  peak %.2f g  drop %.2f m  free %3u ms  still %3u%%  turn %3.0f°  %s\n",
+               name.c_str(), (f.idx - idx0) / (double)IMU_RATE_HZ, f.peakMg / 1000.0, f.dropCm / 100.0,
+               f.freeMs, f.stillPct, acos(f.turnCos / 16384.0) / RAD, verdictName(f.verdict));
+      }
+      judged = done;
+    }
+    delete fusion;
+    if (!rateOk) fprintf(stderr, "fall_eval: %s was not recorded at %d Hz\n", name.c_str(), IMU_RATE_HZ);
+    candidates += fall.candidates; noDrop += fall.noDrop;
+    notStill += fall.notStill; notTurned += fall.notTurned;
+
+    std::string g = groupOf(name);
+    if (groups.empty() || groups.back().name != g) { groups.push_back(Group()); groups.back().name = g; }
+    Group& gr = groups.back();
+    gr.captures++;
+    gr.secs += first ? 0 : (idxLast - idx0 + 1) / (double)IMU_RATE_HZ;
+    gr.now.add(score(labels, reports));
+    gr.v6a.add(score(labels, old));
+  }
+
+  printf("Fall detector (tiga_fall.h) against v6a's rule: %zu captures in %s\n", names.size(), dir);
+  printf("  %-18s %4s %7s %6s  %9s %9s  %9s %9s\n",
+         "", "caps", "min", "falls", "hits", "alarms", "v6a hits", "alarms");
+  for (const Group& g : groups) {
+    printf("  %-18s %4u %7.1f %6u  %9u %9u  %9u %9u\n", g.name.c_str(), g.captures, g.secs / 60,
+           g.now.labels, g.now.hits, g.now.alarms, g.v6a.hits, g.v6a.alarms);
+    all.captures += g.captures; all.secs += g.secs;
+    all.now.add(g.now); all.v6a.add(g.v6a);
+  }
+
+  double hours = all.secs / 3600;
+  auto line = [&](const char* what, const Score& s) {
+    double p = s.hits + s.alarms ? (double)s.hits / (s.hits + s.alarms) : 1;
+    double rc = s.labels ? (double)s.hits / s.labels : 1;
+    printf("  %-8s precision %5.1f%%  recall %5.1f%%  (%u of %u falls, %u false alarms, %.1f per hour)",
+           what, p * 100, rc * 100, s.hits, s.labels, s.alarms, hours > 0 ? s.alarms / hours : 0);
+    if (s.hits) printf("  latency %.1f s mean, %.1f s max", s.latSum / s.hits, s.latMax);
+    printf("\n");
+  };
+  printf("  %.2f h of data, %u falls labelled\n", hours, all.now.labels);
+  line("tiga_fall", all.now);
+  line("v6a", all.v6a);
+  printf("  candidates %u: %u without the drop, %u not still after, %u not turned\n",
+         candidates, noDrop, notStill, notTurned);
+
+  double perHour = IMU_RATE_HZ * 3600.0;
+  printf("  CPU (host): fall stage %.1f ns/sample, %.1f ms per hour of data; v6a's %.1f ns/sample;"
+         " motion + fusion %.1f ns/sample\n",
+         (double)fallNs / samples, fallNs / (double)samples * perHour / 1e6,
+         (double)oldNs / samples, (double)pipeNs / samples);
+  printf("  RAM %zu bytes\n", sizeof(FallDetector));
+
+  double p = all.now.hits + all.now.alarms ? (double)all.now.hits / (all.now.hits + all.now.alarms) : 1;
+  double rc = all.now.labels ? (double)all.now.hits / all.now.labels : 1;
+  if (minPrecision > 0 || minRecall > 0) {
+    bool fail = p < minPrecision || rc < minRecall;
+    printf("  %s\n", fail ? "FAILED" : "all checks passed");
+    return fail;
+  }
+  return 0;
+}
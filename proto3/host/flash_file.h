@@ -0,0 +1,151 @@
+// ============================================================
+// flash_file.h — NOR flash emulator, RAM- or file-backed
+// ============================================================
+// Erase sets 4 KB sectors to 0xFF; programming can only clear
+// bits, as on the ESP32's SPI flash. Backed by a file (mmap'd,
+// shared) the contents outlive the process, so a second run boots
+// on what the first one left — reboot and deep-sleep testing.
+//
+// Power cuts: cutAfter(n) lets n more bytes be programmed (an
+// erase counts as one) and then the power is gone. The write in
+// flight keeps the bytes that made it; an erase in flight leaves
+// its sector scrambled. Every later operation fails until
+// powerOn().
+//
+// Used by sim.cpp for the esp_partition stand-in and by the
+// store benchmarks directly.
+// ============================================================
+
+#pragma once
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <vector>
+
+#define FLASH_SECTOR  4096
+
+class FlashFile {
+public:
+  // Counters since open()
+  uint64_t bytesRead = 0, bytesProgrammed = 0, sectorsErased = 0;
+  uint64_t readOps = 0, writeOps = 0;
+  std::vector<uint32_t> eraseCount;      // per sector, for wear
+
+  ~FlashFile() { close(); }
+
+  // path == nullptr: RAM only. A new or short file is extended
+  // and the extension reads as erased flash.
+  bool open(const char* path, uint32_t size) {
+    close();
+    if (size == 0 || size % FLASH_SECTOR) return false;
+    size_ = size;
+    if (path) {
+      int fd = ::open(path, O_RDWR | O_CREAT, 0644);
+      if (fd < 0) return false;
+      off_t old = lseek(fd, 0, SEEK_END);
+      if (old < (off_t)size) {
+        std::vector<uint8_t> blank(FLASH_SECTOR, 0xFF);
+        for (off_t o = old < 0 ? 0 : old; o < (off_t)size; ) {
+          size_t n = (size_t)((off_t)size - o) < blank.size() ? (size_t)((off_t)size - o) : blank.size();
+          if (pwrite(fd, blank.data(), n, o) != (ssize_t)n) { ::close(fd); return false; }
+          o += (off_t)n;
+        }
+      }
+      void* m = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+      ::close(fd);
+      if (m == MAP_FAILED) return false;
+      mem_ = (uint8_t*)m;
+      mapped_ = true;
+    } else {
+      mem_ = (uint8_t*)malloc(size);
+      if (!mem_) return false;
+      memset(mem_, 0xFF, size);
+    }
+    eraseCount.assign(size / FLASH_SECTOR, 0);
+    resetCounters();
+    powerOn();
+    return true;
+  }
+
+  void close() {
+    if (mem_) {
+      if (mapped_) munmap(mem_, size_);
+      else         free(mem_);
+    }
+    mem_ = nullptr; size_ = 0; mapped_ = false;
+  }
+
+  void resetCounters() {
+    bytesRead = bytesProgrammed = sectorsErased = readOps = writeOps = 0;
+  }
+
+  uint8_t*       mem()        { return mem_; }
+  const uint8_t* mem()  const { return mem_; }
+  uint32_t       size() const { return size_; }
+
+  // ── Power ──
+  void cutAfter(uint64_t units) { budget_ = units; armed_ = true; }
+  void powerOn()                { armed_ = false; dead_ = false; }
+  bool dead() const             { return dead_; }
+
+  // ── NOR operations; false on bad range or no power ──
+  bool read(uint32_t off, void* dst, uint32_t len) {
+    if (dead_ || !inRange(off, len)) return false;
+    memcpy(dst, mem_ + off, len);
+    bytesRead += len;
+    readOps++;
+    return true;
+  }
+
+  bool write(uint32_t off, const void* src, uint32_t len) {
+    if (dead_ || !inRange(off, len)) return false;
+    const uint8_t* s = (const uint8_t*)src;
+    writeOps++;
+    for (uint32_t i = 0; i < len; i++) {
+      if (!spend()) return false;
+      mem_[off + i] &= s[i];
+      bytesProgrammed++;
+    }
+    return true;
+  }
+
+  bool erase(uint32_t off, uint32_t len) {
+    if (dead_ || off % FLASH_SECTOR || len % FLASH_SECTOR || !inRange(off, len)) return false;
+    for (uint32_t o = off; o < off + len; o += FLASH_SECTOR) {
+      if (!spend()) {
+        uint32_t x = o * 2654435761u + 1;       // half-erased: junk
+        for (uint32_t i = 0; i < FLASH_SECTOR; i++) {
+          x = x * 1664525u + 1013904223u;
+          mem_[o + i] = (uint8_t)(x >> 24);
+        }
+        return false;
+      }
+      memset(mem_ + o, 0xFF, FLASH_SECTOR);
+      eraseCount[o / FLASH_SECTOR]++;
+      sectorsErased++;
+    }
+    return true;
+  }
+
+private:
+  uint8_t* mem_    = nullptr;
+  uint32_t size_   = 0;
+  bool     mapped_ = false;
+  bool     armed_  = false, dead_ = false;
+  uint64_t budget_ = 0;
+
+  bool inRange(uint32_t off, uint32_t len) const {
+    return mem_ && off <= size_ && len <= size_ - off;
+  }
+
+  bool spend() {
+    if (!armed_) return true;
+    if (budget_ == 0) { dead_ = true; return false; }
+    budget_--;
+    return true;
+  }
+};
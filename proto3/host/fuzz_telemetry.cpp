@@ -0,0 +1,188 @@
+// ============================================================
+// fuzz_telemetry.cpp — the telemetry decoder against hostile input
+// ============================================================
+// Built with AddressSanitizer and UBSan (`make fuzz`), through the
+// host library's C interface (telemetry_lib.h), so what is fuzzed
+// is what apps link. Four passes:
+//
+//   random     arbitrary bytes, half with a valid version nibble
+//   mutated    real encoder frames with bits flipped, bytes cut,
+//              inserted or appended
+//   round trip any int32 readings, including the extremes, at any
+//              room from 20 to TEL_FRAME_MAX: frames never exceed
+//              room, and the decoder stays within each field's
+//              deadband
+//   newer      frames carrying fields this decoder doesn't know
+//              decode to the same values
+//
+// Any crash, sanitizer report or failed check exits non-zero.
+// With clang, -DTIGA_LIBFUZZER -fsanitize=fuzzer builds the same
+// file as a libFuzzer target instead.
+//
+//   make fuzz                      default iterations
+//   build/fuzz_telemetry 50000000  longer
+// ============================================================
+
+#include "telemetry_lib.h"
+#include "tiga_telemetry.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static uint32_t rng = 12345;
+static uint32_t rnd() { rng ^= rng << 13; rng ^= rng >> 17; rng ^= rng << 5; return rng; }
+
+static int32_t anyValue() {
+  switch (rnd() % 6) {
+    case 0:  return (int32_t)rnd();
+    case 1:  return rnd() & 1 ? INT32_MAX : INT32_MIN;
+    case 2:  return (int32_t)(rnd() % 3) - 1;
+    default: return (int32_t)(rnd() % 20000) - 10000;
+  }
+}
+
+// One decode through the C API; checks what must hold whatever
+// the input
+static bool decodeChecked(TigaTel* d, const uint8_t* p, uint16_t n) {
+  uint32_t changed = tiga_tel_decode(d, p, n);
+  if (changed && !tiga_tel_synced(d)) return false;
+  if (changed & ~tiga_tel_have(d))    return false;
+  return true;
+}
+
+#ifdef TIGA_LIBFUZZER
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+  static TigaTel* d = tiga_tel_new();
+  if (!decodeChecked(d, data, (uint16_t)(size > 0xFFFF ? 0xFFFF : size))) abort();
+  return 0;
+}
+#else
+
+int main(int argc, char** argv) {
+  uint32_t iters = argc > 1 ? (uint32_t)strtoul(argv[1], nullptr, 10) : 2000000;
+  int fail = 0;
+  TigaTel* d = tiga_tel_new();
+  uint8_t buf[128];
+  printf("Telemetry decoder v%d fuzz, %u iterations a pass\n", tiga_tel_version(), iters);
+
+  // ── random ──
+  for (uint32_t i = 0; i < iters; i++) {
+    uint16_t n = rnd() % 70;
+    for (uint16_t k = 0; k < n; k++) buf[k] = (uint8_t)rnd();
+    if (n && rnd() & 1) buf[0] = (uint8_t)(TEL_VERSION << 4 | (buf[0] & 0x0F));
+    if (!decodeChecked(d, buf, n)) { fail = 1; break; }
+  }
+  TigaTelStats st;
+  tiga_tel_stats(d, &st);
+  printf("  random      %u frames: %u applied, %u rejected, %u stale\n",
+         iters, st.frames, st.rejected, st.stale);
+
+  // ── mutated ──
+  {
+    TelEncoder enc;
+    TelSnapshot s = {};
+    tiga_tel_reset(d);
+    uint32_t sent = 0;
+    for (uint32_t i = 0; i < iters; i++) {
+      for (uint8_t f = 0; f < TEL_FIELDS; f++)
+        if (rnd() % 4 == 0) s.v[f] += (int32_t)(rnd() % 21) - 10;
+      uint8_t n = enc.encode(s, buf, (uint8_t)(20 + rnd() % (TEL_FRAME_MAX - 19)));
+      if (!n) continue;
+      switch (rnd() % 5) {
+        case 0: buf[rnd() % n] ^= (uint8_t)(1 << (rnd() % 8)); break;
+        case 1: n = (uint8_t)(rnd() % n); break;
+        case 2: {
+          uint8_t at = rnd() % n;
+          memmove(buf + at + 1, buf + at, n - at);
+          buf[at] = (uint8_t)rnd();
+          n++;
+          break;
+        }
+        case 3: while (n < 100 && rnd() % 3) buf[n++] = (uint8_t)rnd(); break;
+        default: break;                               // untouched
+      }
+      sent++;
+      if (!decodeChecked(d, buf, n)) { fail = 1; break; }
+    }
+    tiga_tel_stats(d, &st);
+    printf("  mutated     %u frames: %u applied, %u rejected, %u gaps, %u stale\n",
+           sent, st.frames, st.rejected, st.gaps, st.stale);
+  }
+
+  // ── round trip ──
+  {
+    TelEncoder enc;
+    tiga_tel_reset(d);
+    uint32_t frames = 0, bad = 0, tooBig = 0;
+    TelSnapshot s = {};
+    for (uint32_t i = 0; i < iters; i++) {
+      for (uint8_t f = 0; f < TEL_FIELDS; f++)
+        if (rnd() % 3 == 0)                           // steps wrap, as the codec's deltas do
+          s.v[f] = rnd() % 4 ? (int32_t)((uint32_t)s.v[f] + rnd() % 7 - 3) : anyValue();
+      if (rnd() % 500 == 0) enc.reset();
+      // Half the frames get full room; a smaller room can leave a
+      // field owed until the next frame, so only full ones are checked
+      bool    full = rnd() & 1;
+      uint8_t room = full ? TEL_FRAME_MAX : (uint8_t)(20 + rnd() % (TEL_FRAME_MAX - 19));
+      uint8_t n = enc.encode(s, buf, room);
+      if (n > room) tooBig++;
+      if (n) {
+        frames++;
+        if (!decodeChecked(d, buf, n)) { fail = 1; break; }
+      }
+      if (!full || !tiga_tel_synced(d)) continue;
+      for (int f = 0; f < TEL_FIELDS; f++) {
+        uint32_t diff = (uint32_t)tiga_tel_value(d, f) - (uint32_t)s.v[f];
+        uint32_t mag  = (int32_t)diff < 0 ? 0u - diff : diff;
+        if (mag > TEL_FIELD_INFO[f].deadband) bad++;
+      }
+    }
+    printf("  round trip  %u frames: %u over room, %u outside a deadband\n", frames, tooBig, bad);
+    if (tooBig || bad) fail = 1;
+  }
+
+  // ── newer ──
+  {
+    TelEncoder enc;
+    TigaTel* plain = tiga_tel_new();
+    tiga_tel_reset(d);
+    uint32_t frames = 0, differ = 0;
+    TelSnapshot s = {};
+    for (uint32_t i = 0; i < iters / 10; i++) {
+      for (uint8_t f = 0; f < TEL_FIELDS; f++)
+        if (rnd() % 3 == 0) s.v[f] += (int32_t)(rnd() % 41) - 20;
+      uint8_t n = enc.encode(s, buf, TEL_FRAME_MAX);
+      if (!n) continue;
+      frames++;
+      decodeChecked(plain, buf, n);
+
+      // Same frame as a later firmware might send it: extra
+      // presence bits above TEL_FIELDS, their values appended
+      uint32_t mask;
+      const uint8_t* q = telGetVarint(buf + 1, buf + n, &mask);
+      uint8_t ext[128];
+      uint32_t extra = ((rnd() & 0xFF) | 1u) << TEL_FIELDS;
+      uint8_t m = 1 + telPutVarint(ext + 1, mask | extra);
+      ext[0] = buf[0];
+      memcpy(ext + m, q, buf + n - q);
+      m += (uint8_t)(buf + n - q);
+      for (uint8_t f = TEL_FIELDS; f < 32; f++)
+        if (extra >> f & 1) m += telPutVarint(ext + m, rnd() >> (rnd() % 32));
+      decodeChecked(d, ext, m);
+      for (int f = 0; f < TEL_FIELDS; f++)
+        if (tiga_tel_value(d, f) != tiga_tel_value(plain, f)) { differ++; break; }
+    }
+    tiga_tel_stats(d, &st);
+    printf("  newer       %u frames: %u decode differently, %u unknown values skipped\n",
+           frames, differ, st.unknown);
+    if (differ) fail = 1;
+    tiga_tel_free(plain);
+  }
+
+  tiga_tel_free(d);
+  printf("  %s\n", fail ? "FAILED" : "all checks passed");
+  return fail;
+}
+
+#endif
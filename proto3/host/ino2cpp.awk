@@ -0,0 +1,42 @@
+# ============================================================
+# ino2cpp.awk — .ino → .cpp the way arduino-builder does it
+# ============================================================
+# Adds #include <Arduino.h> and a prototype for every top-level
+# function, placed just before the first function definition so
+# the sketch's own types are already declared. #line directives
+# keep compiler errors and the profiler pointing at the .ino.
+#
+#   awk -f ino2cpp.awk -v src=../tiga_main_v6a.ino \
+#       ../tiga_main_v6a.ino ../tiga_main_v6a.ino > build/tiga_main_v6a.cpp
+#
+# The file is read twice: pass 1 collects signatures, pass 2
+# prints. Only column-0 definitions of the form
+#   type name(args) {
+# count, which is the sketch's style throughout.
+# ============================================================
+
+FNR == 1 { pass++ }
+
+pass == 1 {
+  if ($0 ~ /^[A-Za-z_][A-Za-z0-9_<>:*& ]*[ *&]+[A-Za-z_][A-Za-z0-9_]*\([^;]*\)[ \t]*\{/ &&
+      $0 !~ /^(if|for|while|switch|else|return|struct|class|enum|union|namespace)[ (]/) {
+    sig = $0
+    sub(/[ \t]*\{.*$/, "", sig)
+    gsub(/[ \t]*=[ \t]*[^,)]*/, "", sig)      # prototypes take no default values
+    protos[++np] = sig ";"
+    if (!first) first = FNR
+  }
+  next
+}
+
+FNR == 1 {
+  print "#include <Arduino.h>"
+  print "#line 1 \"" src "\""
+}
+
+FNR == first {
+  for (i = 1; i <= np; i++) print protos[i]
+  print "#line " FNR " \"" src "\""
+}
+
+{ print }
@@ -0,0 +1,55 @@
+// ============================================================
+// logcat.cpp — print a TIGA event log as text
+// ============================================================
+// Reads what a LOG_SERIAL_BINARY build sent over USB serial, or
+// the log characteristic's notifications saved end to end, and
+// prints each event as the line the firmware would have, with its
+// time and core. Text between frames (boot messages, the session
+// report) passes through unchanged.
+//
+//   make logcat
+//   build/logcat serial.bin
+//   build/logcat < /dev/ttyACM0          follows a live port
+//
+// Times are micros() since boot, unwrapped across its 71-minute
+// rollover.
+// ============================================================
+
+#include "tiga_log.h"
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+int main(int argc, char** argv) {
+  int fd = 0;
+  if (argc > 1 && strcmp(argv[1], "-")) {
+    fd = open(argv[1], O_RDONLY);
+    if (fd < 0) { perror(argv[1]); return 1; }
+  }
+
+  uint32_t lastUs = 0, wraps = 0;
+  bool     first = true;
+  auto onFrame = [&](const LogEvent& e) {
+    if (!first && e.tUs < lastUs && lastUs - e.tUs > 0x80000000UL) wraps++;
+    first  = false;
+    lastUs = e.tUs;
+    char line[LOG_LINE_MAX];
+    logFormat(e, line, sizeof(line));
+    double t = (((uint64_t)wraps << 32) | e.tUs) / 1e6;
+    printf("[%11.6f c%u] %s", t, e.core, line);
+  };
+  auto onText = [](const uint8_t* p, size_t n) { fwrite(p, 1, n, stdout); };
+
+  LogScanner sc;
+  uint8_t buf[4096];
+  ssize_t n;
+  while ((n = read(fd, buf, sizeof(buf))) > 0) {
+    sc.feed(buf, (size_t)n, onFrame, onText);
+    fflush(stdout);
+  }
+  sc.feed(nullptr, 0, onFrame, onText, true);
+  if (fd) close(fd);
+  return 0;
+}
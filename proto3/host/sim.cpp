@@ -0,0 +1,598 @@
+// ============================================================
+// sim.cpp — virtual clock, I/O stand-ins and the profiler
+// ============================================================
+
+#include <Arduino.h>
+#include <Wire.h>
+#include <WiFi.h>
+#include <BLEDevice.h>
+#include <esp_partition.h>
+#include "flash_file.h"
+
+#include <cxxabi.h>
+#include <dlfcn.h>
+#include <algorithm>
+#include <vector>
+
+#define NOINSTR __attribute__((no_instrument_function))
+
+HardwareSerial Serial(0);
+TwoWire        Wire(0);
+WiFiClass      WiFi;
+
+SimWorld simWorld;
+SimIo    simIo;
+SimPins  simPins = {-1, -1, -1, -1, -1, -1, -1};
+
+// ── Virtual clock ────────────────────────────────────────────
+// One clock per core. loop() is core 1; a loop started through
+// coreStart() (tiga_cores.h) is core 0 and gets its own. The
+// world and script events follow whichever core is furthest on,
+// and simCoreStep() always runs the one behind, so the two stay
+// within a task of each other.
+static uint64_t   coreUs[2] = {0, 0};
+static int        core      = 1;          // whose clock micros() reads
+static uint64_t   frontUs   = 0;          // the world's time: the later core
+static bool       advancing = false;
+static void     (*core0Loop)() = nullptr;
+
+uint64_t simNowUs() { return coreUs[core]; }
+
+void simSetStartUs(uint64_t us) { coreUs[0] = coreUs[1] = frontUs = us; }
+
+// The world only moves forward, to the later of the two cores
+static void worldTo(uint64_t t) {
+  if (t <= frontUs) return;
+  simWorldTick(frontUs, t);
+  frontUs = t;
+}
+
+void simDelayUs(uint64_t us) {
+  simIo.delayCalls++;
+  simIo.delayUs += us;
+  simAdvanceUs(us);
+}
+
+// Step through any script events that fall inside the wait, so a
+// button press during a 3s delay() lands at the right moment.
+// Events behind the front have run already.
+void simAdvanceUs(uint64_t us) {
+  uint64_t& now = coreUs[core];
+  uint64_t target = now + us;
+  if (!advancing) {
+    advancing = true;
+    for (;;) {
+      uint64_t ev = simNextEventUs();
+      if (ev > target) break;
+      if (ev > now) { worldTo(ev); now = ev; }
+      simRunEvents(now);
+    }
+    advancing = false;
+  }
+  worldTo(target);
+  now = target;
+}
+
+// ── Second core ──────────────────────────────────────────────
+void simCoreStart(void (*fn)()) {
+  core0Loop = fn;
+  coreUs[0] = coreUs[1];
+}
+
+bool simCoreStep() {
+  if (!core0Loop || coreUs[0] > coreUs[1]) return false;
+  // A loop that never idles would never hand core 1 its turn
+  static uint32_t still = 0;
+  uint64_t before = coreUs[0];
+  core = 0;
+  core0Loop();
+  core = 1;
+  if (coreUs[0] != before) still = 0;
+  else if (++still > 100000) throw SimHalt{ "core 0 loop is spinning without idling" };
+  return true;
+}
+
+uint64_t simCoreUs(int c) { return coreUs[c]; }
+
+int simCoreId() { return core; }
+
+// ── Noise (xorshift32 + Box-Muller) ──────────────────────────
+static uint32_t rng = 0x7167A5u;
+
+void simSeed(uint32_t seed) { rng = seed ? seed : 0x7167A5u; }
+
+uint32_t simRand() {
+  rng ^= rng << 13; rng ^= rng >> 17; rng ^= rng << 5;
+  return rng;
+}
+
+float simGauss(float sigma) {
+  if (sigma == 0) return 0;
+  float u1 = (simRand() + 1.0f) / 4294967296.0f;
+  float u2 = simRand() / 4294967296.0f;
+  return sigma * sqrtf(-2.0f * logf(u1)) * cosf(6.2831853f * u2);
+}
+
+// ── Bus / display cost ───────────────────────────────────────
+static uint32_t i2cHz    = 100000;
+static uint64_t i2cDebtNs = 0;
+static uint64_t lcdDebtNs = 0;
+
+void simI2cSetClock(uint32_t hz) { if (hz) i2cHz = hz; }
+
+void simI2cCost(uint16_t bytes) {
+  uint64_t bits = (uint64_t)bytes * 9 + SIM_I2C_OVERHEAD_BITS;
+  i2cDebtNs += bits * 1000000000ULL / i2cHz;
+  uint64_t us = i2cDebtNs / 1000;
+  i2cDebtNs -= us * 1000;
+  simIo.i2cTransfers++;
+  simIo.i2cBytes  += bytes;
+  simIo.i2cBusyUs += us;
+  simAdvanceUs(us);
+}
+
+// A slave stretching SCL: the controller waits out its timeout
+static void i2cStall(uint16_t ms) {
+  uint64_t us = (uint64_t)ms * 1000;
+  simIo.i2cTransfers++;
+  simIo.i2cTimeouts++;
+  simIo.i2cBusyUs += us;
+  simAdvanceUs(us);
+}
+
+uint8_t simI2cFault(uint8_t addr) {
+  if (simWorld.sdaStuck) return 4;
+  addr &= 0x7F;
+  uint8_t f = simWorld.i2cFault[addr];
+  if (f == SIM_I2C_OK || simRand() / 4294967296.0f >= simWorld.i2cFaultRate[addr]) return 0;
+  return f == SIM_I2C_NACK ? 2 : 5;
+}
+
+bool simI2cAck(uint8_t addr) {
+  uint8_t e = simI2cFault(addr);
+  if (e == 5) i2cStall(Wire.getTimeOut());
+  else if (e) simI2cCost(0);
+  if (e == 2) simIo.i2cNacks++;
+  if (e == 4) simIo.i2cBusErrors++;
+  return e == 0;
+}
+
+void simLcdCost(uint32_t bytes) {
+  lcdDebtNs += (uint64_t)bytes * 1000 / SIM_LCD_BYTES_PER_US;
+  uint64_t us = lcdDebtNs / 1000;
+  lcdDebtNs -= us * 1000;
+  simIo.lcdBytes  += bytes;
+  simIo.lcdBusyUs += us;
+  simAdvanceUs(us);
+}
+
+// ── LCD panel ────────────────────────────────────────────────
+static const uint16_t* lcdPx = nullptr;
+static int16_t  lcdW = 0, lcdH = 0;
+static bool     lcdChanged = false;
+static uint64_t lcdDmaDoneUs = 0;
+
+void simLcdAttach(const uint16_t* px, int16_t w, int16_t h) {
+  lcdPx = px;
+  lcdW  = w;
+  lcdH  = h;
+  lcdChanged = true;
+}
+
+void simLcdTouch()   { lcdChanged = true; }
+bool simLcdChanged() { return lcdChanged; }
+
+// Counted like a blocking push, but the clock is not held: the
+// transfer queues behind any still in flight and the caller gets
+// its finish time.
+uint64_t simLcdDma(uint32_t bytes) {
+  uint64_t start = lcdDmaDoneUs > simNowUs() ? lcdDmaDoneUs : simNowUs();
+  uint64_t us = ((uint64_t)bytes + SIM_LCD_BYTES_PER_US - 1) / SIM_LCD_BYTES_PER_US;
+  simIo.lcdBytes  += bytes;
+  simIo.lcdBusyUs += us;
+  lcdDmaDoneUs = start + us;
+  return lcdDmaDoneUs;
+}
+
+uint32_t simLcdCrc() {
+  uint32_t crc = 0xFFFFFFFF;
+  for (int32_t i = 0; lcdPx && i < (int32_t)lcdW * lcdH; i++) {
+    uint8_t b[2] = { (uint8_t)(lcdPx[i] >> 8), (uint8_t)lcdPx[i] };
+    for (uint8_t k = 0; k < 2; k++) {
+      crc ^= b[k];
+      for (uint8_t j = 0; j < 8; j++) crc = (crc >> 1) ^ (0xEDB88320 & -(crc & 1));
+    }
+  }
+  return ~crc;
+}
+
+bool simLcdWritePpm(const char* path) {
+  if (!lcdPx) return false;
+  FILE* f = fopen(path, "wb");
+  if (!f) return false;
+  fprintf(f, "P6\n%d %d\n255\n", lcdW, lcdH);
+  for (int32_t i = 0; i < (int32_t)lcdW * lcdH; i++) {
+    uint16_t c = lcdPx[i];
+    uint8_t rgb[3] = { (uint8_t)((c >> 8 & 0xF8) | c >> 13),
+                       (uint8_t)((c >> 3 & 0xFC) | (c >> 9 & 3)),
+                       (uint8_t)((c << 3 & 0xF8) | (c >> 2 & 7)) };
+    fwrite(rgb, 1, 3, f);
+  }
+  fclose(f);
+  lcdChanged = false;
+  return true;
+}
+
+// ── TwoWire ──────────────────────────────────────────────────
+bool TwoWire::begin(int, int, uint32_t freq) {
+  if (freq) setClock(freq);
+  return true;
+}
+
+void TwoWire::setClock(uint32_t hz) {
+  clockHz_ = hz;
+  simI2cSetClock(hz);
+}
+
+void TwoWire::beginTransmission(uint8_t addr) {
+  txAddr_ = addr & 0x7F;
+  txLen_  = 0;
+}
+
+size_t TwoWire::write(uint8_t b) {
+  if (txLen_ >= I2C_BUFFER_LENGTH) return 0;
+  txBuf_[txLen_++] = b;
+  return 1;
+}
+
+size_t TwoWire::write(const uint8_t* p, size_t n) {
+  size_t done = 0;
+  while (done < n && write(p[done])) done++;
+  return done;
+}
+
+uint8_t TwoWire::endTransmission(bool) {
+  uint8_t e = simI2cFault(txAddr_);
+  if (e == 5) { i2cStall(timeOutMs_); return 5; }
+  simI2cCost(e == 4 ? 0 : txLen_);
+  if (e == 4) { simIo.i2cBusErrors++; return 4; }            // SDA held: no start
+  SimI2cDevice* d = devs_[txAddr_];
+  if (e == 2 || !d || !d->present()) { simIo.i2cNacks++; return 2; }   // address NACK
+  d->write(txBuf_, txLen_);
+  return 0;
+}
+
+uint8_t TwoWire::requestFrom(uint8_t addr, uint8_t n, bool) {
+  if (n > I2C_BUFFER_LENGTH) n = I2C_BUFFER_LENGTH;
+  rxLen_ = rxPos_ = 0;
+  uint8_t e = simI2cFault(addr);
+  if (e == 5) { i2cStall(timeOutMs_); return 0; }
+  simI2cCost(e == 4 ? 0 : n);
+  if (e == 4) { simIo.i2cBusErrors++; return 0; }
+  SimI2cDevice* d = devs_[addr & 0x7F];
+  if (e == 2 || !d || !d->present()) { simIo.i2cNacks++; return 0; }
+  d->read(rxBuf_, n);
+  rxLen_ = n;
+  return n;
+}
+
+// ── GPIO / outputs ───────────────────────────────────────────
+static uint64_t toneOnAt  = SIM_NEVER;
+static uint64_t motorOnAt = SIM_NEVER;
+
+void simPinWrite(uint8_t pin, bool high) {
+  // Bus recovery clocks SCL; the stuck slave lets go after its bits
+  if (pin == simPins.scl && high && simWorld.sdaStuck && !--simWorld.sdaClocks)
+    simWorld.sdaStuck = false;
+  if (pin != simPins.motor) return;
+  if (high && motorOnAt == SIM_NEVER) {
+    motorOnAt = simNowUs();
+    simIo.motorStarts++;
+  } else if (!high && motorOnAt != SIM_NEVER) {
+    simIo.motorOnUs += simNowUs() - motorOnAt;
+    motorOnAt = SIM_NEVER;
+  }
+}
+
+bool simPinRead(uint8_t pin) {
+  // Buttons pull to GND when pressed; everything else idles high
+  if (pin == simPins.button1) return !simWorld.btn[0];
+  if (pin == simPins.button2) return !simWorld.btn[1];
+  if (pin == simPins.sda)     return !simWorld.sdaStuck;
+  return true;
+}
+
+static void (*pinIsr[64])() = {};
+
+void simAttachInterrupt(uint8_t pin, void (*fn)()) {
+  if (pin < 64) pinIsr[pin] = fn;
+}
+
+// The ISR is core 1's, where setup() attached it, and reads its
+// clock: up to a task behind the edge if core 0 is the one ahead
+void simButton(int button, bool down) {
+  if (simWorld.btn[button - 1] == down) return;
+  simWorld.btn[button - 1] = down;
+  int pin = button == 1 ? simPins.button1 : simPins.button2;
+  if (pin < 0 || pin >= 64 || !pinIsr[pin]) return;
+  int was = core;
+  core = 1;
+  pinIsr[pin]();
+  core = was;
+}
+
+uint16_t simAnalogRead(uint8_t pin) {
+  if (pin != simPins.battery) return 0;
+  // 1:2 divider, 3.2V = empty, 4.2V = full
+  float v = 3.2f + simWorld.batteryPct / 100.0f;
+  return (uint16_t)constrain(v / 6.6f * 4095.0f, 0.0f, 4095.0f);
+}
+
+void simTone(uint8_t pin, unsigned hz) {
+  if (pin != simPins.buzzer) return;
+  if (hz && toneOnAt == SIM_NEVER) {
+    toneOnAt = simNowUs();
+    simIo.toneStarts++;
+  } else if (!hz && toneOnAt != SIM_NEVER) {
+    simIo.buzzerOnUs += simNowUs() - toneOnAt;
+    toneOnAt = SIM_NEVER;
+  }
+}
+
+// ── Serial ───────────────────────────────────────────────────
+// A UART at the Serial.begin() baud, 10 bits a byte, behind a
+// SIM_SERIAL_ROOM-byte TX buffer. write() returns once its bytes
+// are in the buffer, so a line that doesn't fit holds the caller
+// until the wire has made room, as the driver does.
+static bool     serialEcho   = false;
+static uint64_t serialByteNs = 10ULL * 1000000000ULL / 115200;
+static uint64_t serialIdleNs = 0;       // when the TX buffer will be empty
+
+void simSerialEcho(bool on) { serialEcho = on; }
+
+void simSerialBegin(uint32_t baud) {
+  if (baud) serialByteNs = 10ULL * 1000000000ULL / baud;
+}
+
+static uint32_t serialQueued(uint64_t nowNs) {
+  if (serialIdleNs <= nowNs) return 0;
+  return (uint32_t)((serialIdleNs - nowNs + serialByteNs - 1) / serialByteNs);
+}
+
+int simSerialRoom() { return SIM_SERIAL_ROOM - (int)serialQueued(simNowUs() * 1000); }
+
+size_t simSerialWrite(const uint8_t* p, size_t n) {
+  simIo.serialBytes += n;
+  for (size_t i = 0; i < n; i++) if (p[i] == '\n') simIo.serialLines++;
+  if (serialEcho) fwrite(p, 1, n, stdout);
+  uint64_t nowNs = simNowUs() * 1000;
+  serialIdleNs = (serialIdleNs > nowNs ? serialIdleNs : nowNs) + n * serialByteNs;
+  uint64_t fitsNs = serialIdleNs - SIM_SERIAL_ROOM * serialByteNs;
+  if (fitsNs > nowNs) {
+    uint64_t us = (fitsNs - nowNs + 999) / 1000;
+    simIo.serialBlockedUs += us;
+    simAdvanceUs(us);
+  }
+  return n;
+}
+
+// ── Time of day ──────────────────────────────────────────────
+static time_t epochAtBoot = 1776124800;   // 2026-04-14 00:00 UTC = 08:00 GMT+8
+static long   tzOffsetSec = 0;
+static bool   ntpSynced   = false;
+
+void simSetEpoch(time_t t) { epochAtBoot = t; }
+
+void simConfigTime(long offsetSec) {
+  tzOffsetSec = offsetSec;
+  ntpSynced   = true;
+}
+
+// time() as the firmware sees it: seconds since boot until NTP
+// has run (the ESP32's RTC starts at 0), Unix time after. Stands
+// in for libc's, so runs don't depend on the host clock.
+extern "C" time_t time(time_t* out) {
+  time_t t = (time_t)(simNowUs() / 1000000ULL);
+  if (ntpSynced) t += epochAtBoot;
+  if (out) *out = t;
+  return t;
+}
+
+bool simLocalTime(struct tm* out) {
+  if (!ntpSynced) return false;
+  time_t t = epochAtBoot + (time_t)(simNowUs() / 1000000ULL) + tzOffsetSec;
+  gmtime_r(&t, out);
+  return true;
+}
+
+// ── BLE link ─────────────────────────────────────────────────
+void (*simBleNotifyHook)(BLECharacteristic*, const uint8_t*, size_t) = nullptr;
+
+void simBleLink(bool up) {
+  bool was = simWorld.bleLink;
+  BLEServer* s = BLEDevice::server();
+  if (s) s->simLink(up);
+  else   simWorld.bleLink = up;
+  if (up && !was) simPhoneLinkUp();
+}
+
+void simBleSubscribe(bool on) {
+  BLEServer* s = BLEDevice::server();
+  if (s && simWorld.bleLink) s->simSubscribe(on);
+}
+
+// ── Flash partitions ─────────────────────────────────────────
+#define SIM_CAPTURE_BYTES  (4u << 20)
+#define SIM_HISTORY_BYTES  (1u << 20)
+#define SIM_ALERTS_BYTES   (8u << 10)
+
+static FlashFile flashImage;
+
+static esp_partition_t partitions[] = {
+  { ESP_PARTITION_TYPE_DATA, 0x40, 0x400000, SIM_CAPTURE_BYTES, "capture", 0 },
+  { ESP_PARTITION_TYPE_DATA, 0x41, 0x800000, SIM_HISTORY_BYTES, "history", SIM_CAPTURE_BYTES },
+  { ESP_PARTITION_TYPE_DATA, 0x42, 0x900000, SIM_ALERTS_BYTES,  "alerts",
+    SIM_CAPTURE_BYTES + SIM_HISTORY_BYTES },
+};
+
+bool simFlashImage(const char* path) {
+  return flashImage.open(path, SIM_CAPTURE_BYTES + SIM_HISTORY_BYTES + SIM_ALERTS_BYTES);
+}
+
+const esp_partition_t* esp_partition_find_first(esp_partition_type_t type,
+                                                esp_partition_subtype_t subtype,
+                                                const char* label) {
+  if (type != ESP_PARTITION_TYPE_DATA && type != ESP_PARTITION_TYPE_ANY) return nullptr;
+  if (!flashImage.size() && !simFlashImage(nullptr)) return nullptr;
+  for (const esp_partition_t& p : partitions) {
+    if (subtype != p.subtype) continue;
+    if (label && strcmp(label, p.label) != 0) continue;
+    return &p;
+  }
+  return nullptr;
+}
+
+esp_err_t esp_partition_erase_range(const esp_partition_t* p, size_t off, size_t len) {
+  if (off % FLASH_SECTOR || len % FLASH_SECTOR) return ESP_ERR_INVALID_ARG;
+  if (off + len > p->size) return ESP_ERR_INVALID_SIZE;
+  flashImage.erase(p->image + off, len);
+  uint64_t us = (uint64_t)(len / FLASH_SECTOR) * 45000;   // ~45ms per sector
+  simIo.flashErases  += len / FLASH_SECTOR;
+  simIo.flashBusyUs  += us;
+  simAdvanceUs(us);
+  return ESP_OK;
+}
+
+esp_err_t esp_partition_write(const esp_partition_t* p, size_t off, const void* src, size_t len) {
+  if (off + len > p->size) return ESP_ERR_INVALID_SIZE;
+  flashImage.write(p->image + off, src, len);             // NOR: clear bits only
+  uint64_t us = len / 256 * 700 + 20;                      // ~0.7ms per page
+  simIo.flashWrites++;
+  simIo.flashBytes  += len;
+  simIo.flashBusyUs += us;
+  simAdvanceUs(us);
+  return ESP_OK;
+}
+
+esp_err_t esp_partition_read(const esp_partition_t* p, size_t off, void* dst, size_t len) {
+  if (off + len > p->size) return ESP_ERR_INVALID_SIZE;
+  flashImage.read(p->image + off, dst, len);
+  simIo.flashReadBytes += len;
+  return ESP_OK;
+}
+
+// ============================================================
+// Profiler
+// ============================================================
+// GCC calls the hooks below on entry/exit of every function in
+// the firmware unit (-finstrument-functions). A shadow stack
+// splits time into self and inclusive. Host time stands in for
+// CPU time: the simulator is single-threaded and never sleeps.
+// Each hook costs ~20ns, which lands in the caller's self time.
+
+struct ProfFn {
+  void*    fn;
+  uint64_t calls;
+  uint64_t selfNs;
+  uint64_t inclNs;
+};
+
+struct ProfFrame {
+  void*    fn;
+  uint64_t t0;
+  uint64_t childNs;
+};
+
+#define PROF_SLOTS  4096     // power of two
+#define PROF_DEPTH   256
+
+static bool      profOn = false;
+static ProfFn    profTab[PROF_SLOTS];
+static ProfFrame profStack[PROF_DEPTH];
+static int       profDepth = 0;
+
+static inline uint64_t profNowNs() NOINSTR;
+static inline uint64_t profNowNs() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static ProfFn* profSlot(void* fn) NOINSTR;
+static ProfFn* profSlot(void* fn) {
+  uint32_t h = (uint32_t)(((uintptr_t)fn >> 4) * 2654435761u) & (PROF_SLOTS - 1);
+  for (uint32_t i = 0; i < PROF_SLOTS; i++) {
+    ProfFn& e = profTab[(h + i) & (PROF_SLOTS - 1)];
+    if (e.fn == fn) return &e;
+    if (!e.fn) { e.fn = fn; return &e; }
+  }
+  return nullptr;
+}
+
+extern "C" void __cyg_profile_func_enter(void* fn, void*) NOINSTR;
+extern "C" void __cyg_profile_func_enter(void* fn, void*) {
+  if (!profOn) return;
+  if (profDepth < PROF_DEPTH) profStack[profDepth] = {fn, profNowNs(), 0};
+  profDepth++;
+}
+
+extern "C" void __cyg_profile_func_exit(void* fn, void*) NOINSTR;
+extern "C" void __cyg_profile_func_exit(void* fn, void*) {
+  if (!profOn || profDepth == 0) return;
+  profDepth--;
+  if (profDepth >= PROF_DEPTH) return;
+  ProfFrame& f = profStack[profDepth];
+  if (f.fn != fn) return;                      // unbalanced (exception unwind)
+  uint64_t dt = profNowNs() - f.t0;
+  if (ProfFn* e = profSlot(fn)) {
+    e->calls++;
+    e->inclNs += dt;
+    e->selfNs += dt > f.childNs ? dt - f.childNs : 0;
+  }
+  if (profDepth > 0 && profDepth <= PROF_DEPTH) profStack[profDepth - 1].childNs += dt;
+}
+
+void simProfileEnable(bool on) {
+  profOn = on;
+  profDepth = 0;
+}
+
+static void profName(void* fn, char* out, size_t n) {
+  Dl_info info;
+  if (dladdr(fn, &info) && info.dli_sname) {
+    int st = 0;
+    char* dem = abi::__cxa_demangle(info.dli_sname, nullptr, nullptr, &st);
+    snprintf(out, n, "%s", st == 0 && dem ? dem : info.dli_sname);
+    free(dem);
+  } else {
+    snprintf(out, n, "%p", fn);
+  }
+}
+
+void simProfileReport(int top) {
+  std::vector<ProfFn> fns;
+  uint64_t totalSelf = 0;
+  for (const ProfFn& e : profTab) {
+    if (!e.fn) continue;
+    fns.push_back(e);
+    totalSelf += e.selfNs;
+  }
+  if (fns.empty()) { printf("  (no samples — built without -finstrument-functions?)\n"); return; }
+  std::sort(fns.begin(), fns.end(),
+            [](const ProfFn& a, const ProfFn& b) { return a.selfNs > b.selfNs; });
+
+  printf("  %-40s %10s %10s %10s %9s %6s\n",
+         "function", "calls", "self ms", "incl ms", "ns/call", "self%");
+  int shown = 0;
+  for (const ProfFn& e : fns) {
+    if (shown++ >= top) break;
+    char name[256];
+    profName(e.fn, name, sizeof(name));
+    if (strlen(name) > 40) strcpy(name + 37, "...");
+    printf("  %-40s %10llu %10.2f %10.2f %9.0f %5.1f%%\n", name,
+           (unsigned long long)e.calls, e.selfNs / 1e6, e.inclNs / 1e6,
+           e.calls ? (double)e.selfNs / e.calls : 0.0,
+           totalSelf ? 100.0 * e.selfNs / totalSelf : 0.0);
+  }
+  printf("  %d functions, %.1f ms total self time\n", (int)fns.size(), totalSelf / 1e6);
+}
@@ -0,0 +1,209 @@
+// ============================================================
+// sim.h — TIGA host simulator core
+// ============================================================
+// Runs tiga_main_v6a.ino on Linux. The stand-in libraries in
+// host/arduino/ talk to the pieces declared here:
+//
+//   clock     64-bit virtual µs. Only delay(), I2C transfers and
+//             LCD pushes move it — firmware code itself runs in
+//             zero virtual time, so a run is deterministic and
+//             limited only by host CPU speed. Each core has its
+//             own; the one behind always runs next.
+//   world     the wearer and the environment (SimWorld). Scenario
+//             scripts and capture replays change it over time;
+//             sensor models sample it at their own output rates.
+//   panel     the LCD's pixels, dumpable as PPM frames and
+//             checksummed for scenario expectations.
+//   io        transfer counters for the bus, display, BLE, serial
+//             and alert outputs (SimIo), reported at the end.
+//   profile   per-function host CPU time, collected through
+//             -finstrument-functions on the firmware unit.
+//
+// Cost model: I2C bytes cost 9 bit-times at the Wire clock plus
+// start/stop, LCD bytes go at SIM_LCD_BYTES_PER_US. Both block
+// the caller exactly as the device drivers do.
+// ============================================================
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <time.h>
+
+#define SIM_LCD_BYTES_PER_US  20     // i80 8-bit bus ≈ 20 MB/s
+#define SIM_I2C_OVERHEAD_BITS 20     // start + address + ack + stop
+#define SIM_SERIAL_ROOM       128    // UART TX FIFO; Arduino sets no TX ring
+
+// ── Virtual clock ────────────────────────────────────────────
+uint64_t simNowUs();
+void     simAdvanceUs(uint64_t us);   // time passes (runs due script events)
+void     simDelayUs(uint64_t us);     // delay() / delayMicroseconds()
+void     simSetStartUs(uint64_t us);  // e.g. just before micros() wraps
+
+// ── Cores ────────────────────────────────────────────────────
+// Core 1 runs setup() / loop(); coreStart() (tiga_cores.h) puts a
+// loop on core 0 with a clock of its own. simNowUs() is the clock
+// of the core running.
+void     simCoreStart(void (*fn)());
+bool     simCoreStep();               // one pass of core 0 if it is behind
+uint64_t simCoreUs(int core);
+int      simCoreId();                 // the core running now
+
+// ── Deterministic noise ──────────────────────────────────────
+void     simSeed(uint32_t seed);
+uint32_t simRand();
+float    simGauss(float sigma);
+
+// ── The simulated world ──────────────────────────────────────
+#define SIM_NEVER  UINT64_MAX
+
+struct SimWorld {
+  // Wearer
+  bool     worn        = true;
+  float    hrBpm       = 72;
+  float    rrJitterMs  = 25;      // beat-to-beat spread (HRV)
+  float    spo2        = 97;
+  float    cadence     = 0;       // steps per minute, 0 = still
+  float    tremorHz    = 0;
+  float    tremorG     = 0;
+  uint64_t fallAtUs    = SIM_NEVER;   // then lying still until "stand"
+  uint64_t knockAtUs   = SIM_NEVER;   // wrist bump, no fall
+
+  // Environment
+  float    altFromM    = 0;       // altitude ramp
+  float    altToM      = 0;
+  uint64_t altT0Us     = 0;
+  uint64_t altT1Us     = 0;
+  float    seaLevelPa  = 101325;
+  float    driftPaPerH = 0;       // weather
+  float    batteryPct  = 90;
+  bool     gpsFix      = false;
+  double   lat         = 0;
+  double   lng         = 0;
+  int      sats        = 0;
+
+  // Device
+  bool     btn[2]      = {false, false};
+  bool     mpuPresent  = true;
+  bool     mpuZeros    = false;   // alive on the bus, FIFO full of zeros
+  bool     maxPresent  = true;
+  bool     bmpPresent  = true;
+  uint8_t  i2cFault[128]     = {};    // SimI2cFault per 7-bit address
+  float    i2cFaultRate[128] = {};    // chance per transaction
+  bool     sdaStuck    = false;   // a slave holding SDA low...
+  uint8_t  sdaClocks   = 0;       // ...until this many SCL pulses
+  bool     wifi        = true;
+  bool     bleLink     = false;
+  uint16_t bleMtu      = 23;      // the central's ATT MTU ask
+  uint16_t bleInterval = 24;      // connection interval, 1.25 ms units
+  bool     ble2M       = false;   // 2M PHY in use
+};
+
+extern SimWorld simWorld;
+
+enum SimI2cFault : uint8_t { SIM_I2C_OK, SIM_I2C_NACK, SIM_I2C_STRETCH };
+
+float simAltitudeM(uint64_t tUs);
+void  simWorldTick(uint64_t fromUs, uint64_t toUs);   // GPS position integration
+
+// Pins the sketch uses, set by sim_main from the .ino's own defines
+struct SimPins {
+  int button1, button2, battery, buzzer, motor, sda, scl;
+};
+extern SimPins simPins;
+
+// ── I/O accounting ───────────────────────────────────────────
+struct SimIo {
+  uint64_t i2cTransfers, i2cBytes, i2cNacks, i2cBusyUs;
+  uint64_t i2cTimeouts, i2cBusErrors;
+  uint64_t lcdCalls, lcdBytes, lcdBusyUs;
+  uint64_t bleNotifies, bleBytes;
+  uint64_t serialBytes, serialLines, serialBlockedUs;
+  uint64_t toneStarts, buzzerOnUs;
+  uint64_t motorStarts, motorOnUs;
+  uint64_t flashWrites, flashBytes, flashReadBytes, flashErases, flashBusyUs;
+  uint64_t delayCalls, delayUs;
+};
+
+extern SimIo simIo;
+
+// Bus time for one transaction of `bytes` data bytes at the Wire clock
+void simI2cCost(uint16_t bytes);
+void simI2cSetClock(uint32_t hz);
+// Scripted fault for one transaction to addr: a Wire status code
+uint8_t simI2cFault(uint8_t addr);
+// For library-level stand-ins: false when the transaction failed;
+// a stretched clock costs the Wire timeout
+bool simI2cAck(uint8_t addr);
+void simLcdCost(uint32_t bytes);
+
+// ── LCD panel ────────────────────────────────────────────────
+// The TFT_eSPI stand-in owns the pixels (RGB565, as the panel
+// holds them) and registers them here.
+void     simLcdAttach(const uint16_t* px, int16_t w, int16_t h);
+void     simLcdTouch();                      // pixels changed
+bool     simLcdChanged();                    // since the last dump
+uint64_t simLcdDma(uint32_t bytes);          // background transfer; returns done time
+uint32_t simLcdCrc();                        // CRC-32 of the panel contents
+bool     simLcdWritePpm(const char* path);   // P6 image; clears the changed flag
+
+// ── GPIO / outputs / serial ──────────────────────────────────
+void     simPinWrite(uint8_t pin, bool high);
+bool     simPinRead(uint8_t pin);
+void     simAttachInterrupt(uint8_t pin, void (*fn)());
+void     simButton(int button, bool down);     // 1 or 2; runs its ISR
+uint16_t simAnalogRead(uint8_t pin);
+void     simTone(uint8_t pin, unsigned hz);
+void     simSerialBegin(uint32_t baud);
+int      simSerialRoom();
+size_t   simSerialWrite(const uint8_t* p, size_t n);
+void     simSerialEcho(bool on);             // copy firmware Serial to stdout
+
+// ── Flash ────────────────────────────────────────────────────
+// Backing for the esp_partition stand-in. Call before setup() to
+// keep the partitions in a file; otherwise RAM, opened on first use.
+bool     simFlashImage(const char* path);
+
+// ── Time of day (NTP stand-in) ───────────────────────────────
+void     simSetEpoch(time_t epochAtBoot);
+void     simConfigTime(long offsetSec);        // also moves time() onto Unix time
+bool     simLocalTime(struct tm* out);
+
+// ── Sensors (sim_sensors.cpp) ────────────────────────────────
+void     simSensorsInit();                   // attach bus devices; before setup()
+bool     simLoadReplay(const char* path);    // capture file → IMU/PPG/baro/buttons
+void     simReplayStart();                   // recorded time 0 = now
+bool     simReplayActive();
+uint64_t simReplayEndUs();
+void     simPpgBeatStats(uint32_t* beats, float* meanRrMs);
+
+// ── BLE link (stand-in stack) ────────────────────────────────
+void     simBleLink(bool up);
+void     simBleSubscribe(bool on);      // the phone writing every CCCD
+// The phone's side of history sync, next to the firmware
+// (sim_main.cpp). "ble sync" starts it; after that it resumes by
+// itself whenever the link comes back.
+void     simPhoneSync();
+void     simPhoneLinkUp();
+// Its side of a waveform stream; neither channel stops it
+void     simPhoneStream(bool ppg, bool acc);
+
+// ── Deep sleep ends the run ──────────────────────────────────
+struct SimHalt { const char* why; };
+
+// ── Scenario scripts (sim_script.cpp) ────────────────────────
+bool     simLoadScript(const char* path);
+void     simRunEvents(uint64_t nowUs);       // apply everything due
+uint64_t simNextEventUs();                   // SIM_NEVER when none left
+void     simQueueButton(uint64_t tUs, int button, bool down);
+uint64_t simScriptEndUs();                   // "end" command, or SIM_NEVER
+uint32_t simExpectFailures();
+uint32_t simExpectCount();
+
+// Implemented next to the firmware (sim_main.cpp): reads a named
+// firmware value for "expect" lines. Returns false for unknown keys.
+bool     simProbe(const char* key, double* out);
+
+// ── Profiler (sim.cpp) ───────────────────────────────────────
+void     simProfileEnable(bool on);
+void     simProfileReport(int top);
@@ -0,0 +1,481 @@
+// ============================================================
+// sim_main.cpp — runs tiga_main_v6a.ino on the host
+// ============================================================
+// The sketch is compiled into this unit (build/tiga_main_v6a.cpp,
+// made by ino2cpp.awk) so the probes below can read its globals
+// directly. This unit alone is built with -finstrument-functions,
+// which is what the per-function CPU profile is taken from.
+//
+//   ./tiga_sim --script scenarios/walk_fall.txt
+//   ./tiga_sim --replay walk.tigc --serial
+//   ./tiga_sim --script scenarios/ui_frames.txt --frames build/frames
+//   ./tiga_sim --flash build/flash.img --duration 3600   (twice: reboot)
+//
+// Exit status: 0 all expectations held, 1 one or more failed,
+// 2 bad arguments or unreadable input.
+// ============================================================
+
+#include "sim.h"
+#include "tiga_main_v6a.cpp"
+
+#include <chrono>
+
+// ── Phone ────────────────────────────────────────────────────
+// What a phone app does with the notifications: telemetry frames
+// into tiga_telemetry.h's TelDecoder, and for history sync
+// tiga_sync.h's SyncReceiver, its replies written back to the
+// control characteristic; and for a clinician session
+// tiga_stream.h's StreamReceiver. The link here is lossless and
+// instant; bench_sync and bench_stream cover slow and lossy ones.
+static uint32_t phoneGot = 0, phoneOrder = 0, phonePrevT = 0;
+static bool     phoneSyncing = false;
+
+static void phoneSample(const HistSample& s, void*) {
+  if (phoneGot && s.t <= phonePrevT) phoneOrder++;    // repeated or out of order
+  phonePrevT = s.t;
+  phoneGot++;
+}
+
+static uint32_t phoneStreamPpg = 0, phoneStreamAcc = 0;
+static uint8_t  phoneStreamCh = 0;
+
+static void phoneStreamSample(uint8_t type, uint32_t, uint8_t, const int32_t*, void*) {
+  if (type == STREAM_PPG) phoneStreamPpg++;
+  else                    phoneStreamAcc++;
+}
+
+static SyncReceiver  phoneRx(phoneSample, nullptr);
+static StreamReceiver phoneStream(phoneStreamSample, nullptr);
+static TelDecoder    phoneTel;
+static AlertReceiver phoneAlerts;
+static AlertEvent    phoneLastAlert;
+
+static void phoneWrite(const uint8_t* p, uint8_t n, const char* uuid = TIGA_SYNC_CTL_UUID) {
+  if (!n || !pServer || !simWorld.bleLink) return;
+  for (BLEService* sv : pServer->services())
+    for (BLECharacteristic* c : sv->characteristics())
+      if (!strcmp(c->getUUID(), uuid)) c->simWrite(p, n);
+}
+
+static void phoneNotify(BLECharacteristic* c, const uint8_t* p, size_t n) {
+  if (!strcmp(c->getUUID(), TIGA_TEL_CHAR_UUID)) phoneTel.decode(p, (uint16_t)n);
+  if (!strcmp(c->getUUID(), TIGA_ALERT_CHAR_UUID)) {
+    AlertEvent e;
+    if (phoneAlerts.onIndication(p, (uint16_t)n, e)) phoneLastAlert = e;
+  }
+  if (!strcmp(c->getUUID(), TIGA_STREAM_DATA_UUID)) phoneStream.onFrame(p, (uint16_t)n);
+  if (!phoneSyncing || strcmp(c->getUUID(), TIGA_SYNC_DATA_UUID)) return;
+  uint8_t reply[SYNC_CTL_MAX];
+  phoneWrite(reply, phoneRx.onChunk(p, (uint16_t)n, reply));
+}
+
+void simPhoneSync() {
+  phoneSyncing = true;
+  simPhoneLinkUp();
+}
+
+// "ble stream ppg|acc|both|off": a clinician session starting or
+// ending; asked again whenever the link comes back
+void simPhoneStream(bool ppg, bool acc) {
+  phoneStreamCh = (uint8_t)((ppg ? STREAM_CH_PPG : 0) | (acc ? STREAM_CH_ACC : 0));
+  uint8_t ctl[3] = { STREAM_STOP };
+  phoneWrite(ctl, phoneStreamCh ? phoneStream.start(ctl, phoneStreamCh, 0) : 1, TIGA_STREAM_CTL_UUID);
+}
+
+// What the watch had at its last once-a-second telemetry call,
+// frame or not. Between calls the watch moves on and the phone
+// can't know, so that's what the phone is held to.
+static uint32_t telCalls = 0;
+static int32_t  telWatchHr = 0, telWatchSteps = 0, telWatchRmssd = 0;
+
+static void telWatchNote() {
+  uint32_t calls = bleTel.frames + bleTel.quiet;
+  if (calls == telCalls) return;
+  telCalls      = calls;
+  telWatchHr    = lroundf(data.heartRate);
+  telWatchSteps = data.steps;
+  telWatchRmssd = lroundf(data.rmssdMs);
+}
+
+// What the phone shows minus what the watch sent it from
+static double phoneOff(TelField f, int32_t watch) {
+  return phoneTel.synced ? (double)phoneTel.cur.v[f] - watch : NAN;
+}
+
+void simPhoneLinkUp() {
+  phoneTel = TelDecoder();                     // a new connection, a new decoder
+  if (phoneStreamCh) simPhoneStream(phoneStreamCh & STREAM_CH_PPG, phoneStreamCh & STREAM_CH_ACC);
+  if (!phoneSyncing) return;
+  uint8_t start[SYNC_CTL_MAX];
+  phoneWrite(start, phoneRx.start(start));
+}
+
+// ── Probes for "expect" / "show" ─────────────────────────────
+// Both cores' tasks
+static uint32_t schedSum(uint32_t SchedTask::*field) {
+  uint32_t n = 0;
+  for (const Scheduler* s : { &acqSched, &sched })
+    for (uint8_t i = 0; i < s->count(); i++) n += s->task(i).*field;
+  return n;
+}
+
+static uint32_t i2cSum(uint32_t I2cDevice::*field) {
+  uint32_t n = 0;
+  for (uint8_t i = 0; i < i2c.count(); i++) n += i2c.device(i).*field;
+  return n;
+}
+
+struct SimProbeKey {
+  const char* key;
+  double    (*read)();
+  const char* help;
+};
+
+static const SimProbeKey probes[] = {
+  { "steps",      [] { return (double)data.steps; },          "step count" },
+  { "hr",         [] { return (double)data.heartRate; },      "heart rate, bpm" },
+  { "spo2",       [] { return (double)data.spO2; },           "SpO2 %, 0 = no reading" },
+  { "ppg_sqi",    [] { return (double)data.ppgQuality; },     "PPG signal quality of the last block, 0-100" },
+  { "hr_quality", [] { return (double)data.hrQuality; },      "worst PPG block behind the HR shown, 0-100" },
+  { "ppg_skipped",[] { return (double)ppgQuality.skipped; },  "PPG blocks skipped as unusable" },
+  { "ppg_moving", [] { return (double)ppgQuality.byMotion; }, "of those, skipped for arm movement" },
+  { "worn",       [] { return (double)data.wearing; },        "1 when the PPG sees skin" },
+  { "tilt",       [] { return (double)data.tiltAngle; },      "pitch of the watch face, degrees" },
+  { "roll",       [] { return (double)data.rollAngle; },      "roll about the forearm, degrees" },
+  { "vert_g",     [] { return (double)data.vertAccelG; },     "acceleration along gravity less 1g" },
+  { "tremor_hz",  [] { return (double)data.tremorHz; },       "tremor in the last still window, Hz (0 = none)" },
+  { "tremor_dps", [] { return (double)data.tremorDps; },      "4-12 Hz band RMS rotation, deg/s" },
+  { "tremor_found",[] { return (double)tremorSession.found; }, "still windows with tremor this session" },
+  { "tremor_windows",[] { return (double)tremorSession.windows; }, "still windows analysed this session" },
+  { "tremor_skipped",[] { return (double)tremorSkipped; },    "windows skipped for a step" },
+  { "tremor_change",[] { float p = 0; tremorPast.change(tremorSession, &p); return (double)p; },
+                  "tremor RMS vs earlier sessions, % (0 = nothing to compare)" },
+  { "hr_avg",     [] { return (double)stats.session(STAT_HR).mean(); }, "session HR average from the stats store" },
+  { "hr_sd",      [] { return (double)sqrtf(stats.session(STAT_HR).var()); }, "session HR standard deviation" },
+  { "hr_avg_10m", [] { return (double)stats.last(STAT_HR, 600).mean(); }, "HR average over the last 10 minutes" },
+  { "stats_s",    [] { return (double)stats.seconds(); },     "seconds in the stats store" },
+  { "stats_steps",[] { return (double)stats.session(STAT_STEPS).sum; }, "steps summed from the per-second store" },
+  { "hrv_rmssd",  [] { return (double)data.rmssdMs; },        "HRV RMSSD over the last minute, ms (0 = no reading)" },
+  { "hrv_sdnn",   [] { return (double)data.sdnnMs; },         "HRV SDNN over the last minute, ms" },
+  { "hrv_pnn50",  [] { return (double)data.pnn50; },          "successive differences over 50 ms, last minute, %" },
+  { "hrv_valid",  [] { return (double)hrvShort.valid; },      "1 when the last minute had enough clean beats" },
+  { "hrv_rmssd5", [] { return (double)(hrvLong.valid ? hrvLong.rmssdMs : 0); }, "RMSSD over five minutes, ms" },
+  { "hrv_rejected",[] { return (double)hrvRejected; },        "intervals thrown out as ectopic or movement" },
+  { "falls",      [] { return (double)daily.fallCount; },     "confirmed falls today" },
+  { "fall_state", [] { return (double)(state == STATE_FALL_CONFIRM); }, "1 during the fall countdown" },
+  { "fall_candidates",[] { return (double)fallDetector.candidates; }, "impacts the fall detector judged" },
+  { "fall_drop",  [] { return fallDetector.last.dropCm / 100.0; }, "wrist drop into the last judged impact, m" },
+  { "emergency",  [] { return (double)(state == STATE_EMERGENCY); },    "1 on the emergency screen" },
+  { "sos",        [] { return (double)daily.sosCount; },      "SOS activations today" },
+  { "alerts_raised",   [] { return (double)alertLink.raised; },    "alert events raised for the phone" },
+  { "alerts_waiting",  [] { return (double)alertLink.waiting(); }, "alert events not yet confirmed" },
+  { "alerts_confirmed",[] { return (double)alertLink.confirmed; }, "alert events the phone confirmed" },
+  { "alert_ms",        [] { return (double)alertLink.latLastMs; }, "raise-to-confirmation of the last one confirmed, ms" },
+  { "alert_ms_max",    [] { return (double)alertLink.latMaxMs; },  "longest raise-to-confirmation, ms" },
+  { "phone_alerts",    [] { return (double)phoneAlerts.events; },  "alert events the phone took, resends dropped" },
+  { "phone_alert_type",[] { return (double)phoneLastAlert.type; }, "AlertType of the last one" },
+  { "phone_alert_lat", [] { return phoneLastAlert.lat7 / 1e7; },   "its GPS latitude, degrees" },
+  { "stream_frames",   [] { return (double)stream.framesMade; },  "waveform frames made this boot" },
+  { "stream_dropped",  [] { return (double)stream.dropped(); },   "of those, dropped with the ring full" },
+  { "stream_level",    [] { return (double)stream.level(); },     "stream decimation, rate halved this many times" },
+  { "phone_stream_ppg",[] { return (double)phoneStreamPpg; },     "PPG samples the phone decoded" },
+  { "phone_stream_acc",[] { return (double)phoneStreamAcc; },     "accel samples the phone decoded" },
+  { "phone_stream_lost",[] { return (double)(phoneStream.lost + phoneStream.bad); }, "stream frames the phone missed or rejected" },
+  { "ble_interval_ms", [] { return simWorld.bleInterval * 1.25; }, "connection interval the watch last asked for, ms" },
+  { "ble_2m",          [] { return (double)simWorld.ble2M; },      "1 on the 2M PHY" },
+  { "state",      [] { return (double)state; },               "AppState value" },
+  { "floors",     [] { return (double)data.floorsUp; },       "floors climbed" },
+  { "floors_down",[] { return (double)data.floorsDown; },     "floors descended" },
+  { "altitude",   [] { return (double)data.altitudeM; },      "altitude climbed on foot, m" },
+  { "baro_alt",   [] { return (double)altitude.baroM(); },    "filtered barometer altitude since the baseline, m" },
+  { "alt_offset", [] { return (double)altitude.offsetM(); },  "barometer moved but not climbed (lifts, weather), m" },
+  { "alt_drift",  [] { return (double)altitude.driftMph(); }, "weather drift estimate, m/h" },
+  { "balance",    [] { return (double)data.balanceScore; },   "balance score" },
+  { "activity",   [] { return (double)data.activityMins; },   "active minutes" },
+  { "battery",    [] { return (double)data.battery; },        "battery %" },
+  { "gps_fix",    [] { return (double)gpsData.hasFix; },      "1 with a GPS fix" },
+  { "distance",   [] { return (double)gpsData.distanceM; },   "GPS distance, m" },
+  { "mpu_ok",     [] { return (double)mpuOK; },               "MPU6050 considered alive" },
+  { "mpu_resets", [] { return (double)mpuReconnectCount; },   "MPU6050 recoveries" },
+  { "max_ok",     [] { return (double)maxOK; },               "MAX30102 considered alive" },
+  { "bmp_ok",     [] { return (double)bmpOK; },               "BMP280 considered alive" },
+  { "i2c_errors", [] { return (double)i2cSum(&I2cDevice::errors); },   "sensor bus transfers failed after retries" },
+  { "i2c_retries",[] { return (double)i2cSum(&I2cDevice::retries); },  "sensor bus transfers attempted again" },
+  { "i2c_timeouts",[] { return (double)i2cSum(&I2cDevice::timeouts); }, "sensor bus attempts that timed out" },
+  { "i2c_reinits",[] { return (double)i2cSum(&I2cDevice::reinits); },  "sensors re-initialised by the bus engine" },
+  { "i2c_recoveries",[] { return (double)i2c.recoveries; },   "sensor bus recoveries (SDA clocked free)" },
+  { "imu_lat_ms", [] { return i2c.device(I2C_DEV_MPU).maxLatUs / 1e3; }, "longest MPU drain, post to done, ms" },
+  { "imu_in",     [] { return (double)imuPipe.samplesIn; },   "IMU samples processed" },
+  { "imu_lost",   [] { return (double)imuPipe.samplesLost; }, "IMU samples lost to overflow" },
+  { "ppg_in",     [] { return (double)ppgAcq.samplesIn; },    "PPG samples read" },
+  { "ppg_lost",   [] { return (double)ppgAcq.samplesLost; },  "PPG samples lost to overflow" },
+  { "overruns",   [] { return (double)schedSum(&SchedTask::overruns); }, "task runs over budget" },
+  { "missed",     [] { return (double)schedSum(&SchedTask::missed); },   "task periods skipped" },
+  { "refused",    [] { return (double)(acqSched.refused + sched.refused); }, "tasks the schedulers had no room for" },
+  { "alerts",     [] { return (double)alerts.played; },       "alert patterns started" },
+  { "buzzer_s",   [] { return simIo.buzzerOnUs / 1e6; },      "buzzer on-time, s" },
+  { "motor_s",    [] { return simIo.motorOnUs / 1e6; },       "motor on-time, s" },
+  { "ble",        [] { return (double)bleConnected; },        "1 with a central connected" },
+  { "ble_tx",     [] { return (double)simIo.bleNotifies; },   "BLE notifications sent" },
+  { "lcd_crc",    [] { return (double)simLcdCrc(); },         "CRC-32 of the panel pixels" },
+  { "frames",     [] { return (double)gfx.frames; },          "frames committed with changes" },
+  { "frame_bytes",[] { return (double)gfx.lastBytes; },       "pixel bytes of the last changed frame" },
+  { "frame_rects",[] { return (double)gfx.lastRects; },       "rectangles in the last changed frame" },
+  { "hist_in",    [] { return (double)history.samplesIn; },   "samples appended to the history" },
+  { "hist_blocks",[] { return (double)history.blocksOut; },   "history blocks written" },
+  { "hist_bytes", [] { return (double)history.flashBytes; },  "history bytes programmed" },
+  { "hist_used",  [] { return (double)history.used(); },      "history sectors holding data" },
+  { "hist_pending",[] { return (double)history.pending(); },  "history seconds not yet in flash" },
+  { "hist_forced",[] { return (double)history.forcedErases; }, "history erases done inside a task" },
+  { "tel_bytes",  [] { return (double)bleTel.bytes; },        "telemetry frame bytes sent" },
+  { "tel_frames", [] { return (double)bleTel.frames; },       "telemetry frames sent" },
+  { "tel_gaps",   [] { return (double)(phoneTel.gaps + phoneTel.rejected); }, "telemetry frames the phone lost or refused" },
+  { "tel_steps",  [] { return phoneOff(TEL_STEPS, telWatchSteps); }, "phone's steps minus the watch's at its last telemetry second" },
+  { "tel_hr",     [] { return phoneOff(TEL_HR, telWatchHr); }, "phone's HR minus the watch's at its last telemetry second, bpm" },
+  { "tel_rmssd",  [] { return phoneOff(TEL_RMSSD, telWatchRmssd); }, "phone's RMSSD minus the watch's at its last telemetry second, ms" },
+  { "sync_chunks",[] { return (double)historySync.chunksSent; }, "history sync chunks notified" },
+  { "sync_again", [] { return (double)historySync.chunksAgain; }, "history sync chunks sent again" },
+  { "sync_rx",    [] { return (double)phoneGot; },            "history samples the phone has" },
+  { "sync_lag",   [] { return history.empty() || !phoneRx.haveT ? -1.0
+                              : (double)history.last().t - phoneRx.lastT; }, "newest sample minus phone's newest, s" },
+  { "sync_order", [] { return (double)phoneOrder; },          "samples the phone got twice or out of order" },
+  { "flash_erase",[] { return (double)simIo.flashErases; },  "flash sectors erased, all partitions" },
+  { "btn_events", [] { return (double)buttons.events; },     "button events handled" },
+  { "btn_lat_ms", [] { return buttons.latMaxUs / 1000.0; },   "worst press-to-handled, ms" },
+  { "btn_bounces",[] { return (double)buttons.bounces; },     "button edges thrown away as chatter" },
+  { "btn_dropped",[] { return (double)buttons.dropped(); },   "button events the ring had no room for" },
+  { "time_s",     [] { return simNowUs() / 1e6; },            "virtual time, s" },
+};
+
+bool simProbe(const char* key, double* out) {
+  for (const SimProbeKey& p : probes) {
+    if (strcmp(p.key, key) == 0) { *out = p.read(); return true; }
+  }
+  return false;
+}
+
+// ── Report ───────────────────────────────────────────────────
+static double pct(uint64_t part, uint64_t whole) {
+  return whole ? 100.0 * part / whole : 0.0;
+}
+
+static void report(uint64_t simUs, double wallS, bool profile, int top) {
+  printf("\n== TIGA host simulator ==============================================\n");
+  printf("  simulated %.1f s in %.2f s wall  (%.0fx real time)\n",
+         simUs / 1e6, wallS, wallS > 0 ? simUs / 1e6 / wallS : 0.0);
+
+  printf("\n-- Outcome --\n");
+  printf("  steps %d  hr %.0f  spo2 %u  falls %d  sos %d  floors +%d -%d  alt %.1f m\n",
+         data.steps, data.heartRate, data.spO2, daily.fallCount, daily.sosCount,
+         data.floorsUp, data.floorsDown, data.altitudeM);
+  printf("  state %d  balance %d  activity %d min  battery %.0f%%  worn %d\n",
+         (int)state, data.balanceScore, data.activityMins, data.battery, data.wearing);
+
+  uint32_t beats; float meanRr;
+  simPpgBeatStats(&beats, &meanRr);
+  printf("\n-- Sensors --\n");
+  printf("  IMU  in %lu  lost %lu  overflows %lu  bursts %lu  read errors %lu\n",
+         (unsigned long)imuPipe.samplesIn, (unsigned long)imuPipe.samplesLost,
+         (unsigned long)imuPipe.overflows, (unsigned long)imuPipe.burstReads,
+         (unsigned long)imuPipe.readErrors);
+  printf("  PPG  in %lu  lost %lu  blocks %lu  dropped %lu  max fill %u/%u\n",
+         (unsigned long)ppgAcq.samplesIn, (unsigned long)ppgAcq.samplesLost,
+         (unsigned long)ppgAcq.blocksOut, (unsigned long)ppgAcq.blocksDropped,
+         ppgAcq.maxFifoFill, PPG_FIFO_DEPTH);
+  if (!simReplayActive())
+    printf("  model beats %lu  mean RR %.0f ms\n", (unsigned long)beats, meanRr);
+
+  printf("\n-- Sensor bus (%u kHz, %lu recoveries) --\n",
+         Wire.getClock() / 1000, (unsigned long)i2c.recoveries);
+  printf("  dev   up   jobs  xfers  err  retry  tmo  down  reinit  dropped  avgLat(us)  maxLat(us)\n");
+  for (uint8_t i = 0; i < i2c.count(); i++) {
+    const I2cDevice& d = i2c.device(i);
+    printf("  %-4s %3d %6lu %6lu %4lu %6lu %4lu %5lu %7lu %8lu %11lu %11lu\n",
+           d.name, d.up ? 1 : 0, (unsigned long)d.jobs, (unsigned long)d.xfers,
+           (unsigned long)d.errors, (unsigned long)d.retries, (unsigned long)d.timeouts,
+           (unsigned long)d.downs, (unsigned long)d.reinits, (unsigned long)d.dropped,
+           (unsigned long)(d.jobs ? d.sumLatUs / d.jobs : 0), (unsigned long)d.maxLatUs);
+  }
+
+  printf("\n-- Buses and outputs --\n");
+  printf("  I2C  %llu transfers  %llu bytes  %llu NACKs  %llu timeouts  %llu bus errors  busy %.1f%%\n",
+         (unsigned long long)simIo.i2cTransfers, (unsigned long long)simIo.i2cBytes,
+         (unsigned long long)simIo.i2cNacks, (unsigned long long)simIo.i2cTimeouts,
+         (unsigned long long)simIo.i2cBusErrors, pct(simIo.i2cBusyUs, simUs));
+  printf("  LCD  %llu calls  %.1f MB  busy %.1f%%\n",
+         (unsigned long long)simIo.lcdCalls, simIo.lcdBytes / 1e6, pct(simIo.lcdBusyUs, simUs));
+  printf("       %lu frames  %lu bands  last %lu B  max %lu B  (full screen %u B)\n",
+         (unsigned long)gfx.frames, (unsigned long)gfx.bandsOut,
+         (unsigned long)gfx.lastBytes, (unsigned long)gfx.maxBytes, W * H * 2);
+  printf("  BLE  %llu notifications  %llu bytes\n",
+         (unsigned long long)simIo.bleNotifies, (unsigned long long)simIo.bleBytes);
+  if (bleTel.frames)
+    printf("       telemetry %lu frames  %lu key  %llu bytes  %lu quiet s\n",
+           (unsigned long)bleTel.frames, (unsigned long)bleTel.keyFrames,
+           (unsigned long long)bleTel.bytes, (unsigned long)bleTel.quiet);
+  if (historySync.sessions)
+    printf("       sync %lu sessions  %lu chunks  %lu resent  %lu samples  %.1f kB  phone has %lu\n",
+           (unsigned long)historySync.sessions, (unsigned long)historySync.chunksSent,
+           (unsigned long)historySync.chunksAgain, (unsigned long)historySync.samplesSent,
+           historySync.bytesSent / 1e3, (unsigned long)phoneGot);
+  printf("  Serial  %llu bytes  %llu lines  writers blocked %.2f s\n",
+         (unsigned long long)simIo.serialBytes, (unsigned long long)simIo.serialLines,
+         simIo.serialBlockedUs / 1e6);
+  printf("  Alerts  %lu played  %lu preempted  %lu rejected  buzzer %.1f s  motor %.1f s\n",
+         (unsigned long)alerts.played, (unsigned long)alerts.preempted,
+         (unsigned long)alerts.rejected, simIo.buzzerOnUs / 1e6, simIo.motorOnUs / 1e6);
+  printf("  Flash  %llu writes  %llu B programmed  %llu B read  %llu erases  busy %.1f%%\n",
+         (unsigned long long)simIo.flashWrites, (unsigned long long)simIo.flashBytes,
+         (unsigned long long)simIo.flashReadBytes, (unsigned long long)simIo.flashErases,
+         pct(simIo.flashBusyUs, simUs));
+  if (historyOK)
+    printf("       history %lu samples  %lu blocks  %.0f B/h  %u/%u sectors  %lu forced erases\n",
+           (unsigned long)history.samplesIn, (unsigned long)history.blocksOut,
+           simUs ? history.flashBytes * 3.6e9 / simUs : 0.0,
+           history.used(), history.sectors(), (unsigned long)history.forcedErases);
+  printf("  delay()  %llu calls  %.1f s\n",
+         (unsigned long long)simIo.delayCalls, simIo.delayUs / 1e6);
+
+  printf("\n-- Scheduler (virtual device time) --\n");
+  printf("  task      runs   miss  over  maxJit(us)  avgRun(us)  maxRun(us)\n");
+  struct { const char* name; const Scheduler* s; } cores[] = {
+    { "core 0, sensors", &acqSched }, { "core 1, UI and BLE", &sched }
+  };
+  for (const auto& c : cores) {
+    printf("  %s\n", c.name);
+    for (uint8_t i = 0; i < c.s->count(); i++) {
+      const SchedTask& t = c.s->task(i);
+      printf("  %-8s %6lu %5lu %5lu %10lu %11lu %11lu\n",
+             t.name, (unsigned long)t.runs, (unsigned long)t.missed,
+             (unsigned long)t.overruns, (unsigned long)t.maxJitterUs,
+             (unsigned long)(t.runs ? t.sumRunUs / t.runs : 0),
+             (unsigned long)t.maxRunUs);
+    }
+    printf("  idle %.1f%%\n", pct(c.s->idleTotalUs, simUs));
+  }
+  printf("  cross-core  %lu events  %lu commands dropped  %lu snapshots copied\n",
+         (unsigned long)acqEvents.dropped, (unsigned long)acqCmds.dropped, (unsigned long)acqPulls);
+
+  if (profile) {
+    printf("\n-- Host CPU by function (self time) --\n");
+    simProfileReport(top);
+  }
+}
+
+// ── Frame dump ───────────────────────────────────────────────
+// One PPM per settled frame: the panel changed and nothing is
+// left queued, so half-sent frames are never written.
+static const char* framesDir = nullptr;
+static uint32_t    framesOut = 0;
+
+static void dumpFrame() {
+  if (!framesDir || !simLcdChanged() || gfx.busy()) return;
+  char path[512];
+  snprintf(path, sizeof(path), "%s/%05lu_%010.3f.ppm", framesDir,
+           (unsigned long)framesOut, simNowUs() / 1e6);
+  if (simLcdWritePpm(path)) framesOut++;
+  else fprintf(stderr, "[sim] cannot write %s\n", path);
+}
+
+// ── Main ─────────────────────────────────────────────────────
+static void usage() {
+  fprintf(stderr,
+    "usage: tiga_sim [options]\n"
+    "  --script FILE     scenario script (see sim_script.cpp)\n"
+    "  --replay FILE     capture file (.tigc) as sensor input\n"
+    "  --duration SECS   run length (default: script end, replay end or 600)\n"
+    "  --seed N          noise seed\n"
+    "  --start-us N      initial virtual time, e.g. 4290000000 to cross the micros() wrap\n"
+    "  --serial          echo firmware Serial output\n"
+    "  --frames DIR      write each finished LCD frame to DIR as PPM\n"
+    "  --flash FILE      keep the flash partitions in FILE across runs\n"
+    "  --no-profile      skip per-function timing (runs ~4x faster)\n"
+    "  --top N           rows in the profile (default 25)\n"
+    "  --keys            list expect/show keys\n");
+}
+
+int main(int argc, char** argv) {
+  const char* script = nullptr;
+  const char* replay = nullptr;
+  const char* flashPath = nullptr;
+  double   durationS = 0;
+  uint64_t startUs   = 0;
+  bool     profile   = true;
+  int      top       = 25;
+
+  for (int i = 1; i < argc; i++) {
+    const char* a = argv[i];
+    bool more = i + 1 < argc;
+    if      (!strcmp(a, "--script") && more)   script = argv[++i];
+    else if (!strcmp(a, "--replay") && more)   replay = argv[++i];
+    else if (!strcmp(a, "--duration") && more) durationS = atof(argv[++i]);
+    else if (!strcmp(a, "--seed") && more)     simSeed((uint32_t)strtoul(argv[++i], nullptr, 0));
+    else if (!strcmp(a, "--start-us") && more) startUs = strtoull(argv[++i], nullptr, 0);
+    else if (!strcmp(a, "--top") && more)      top = atoi(argv[++i]);
+    else if (!strcmp(a, "--frames") && more)   framesDir = argv[++i];
+    else if (!strcmp(a, "--flash") && more)    flashPath = argv[++i];
+    else if (!strcmp(a, "--serial"))           simSerialEcho(true);
+    else if (!strcmp(a, "--no-profile"))       profile = false;
+    else if (!strcmp(a, "--keys")) {
+      for (const SimProbeKey& p : probes) printf("  %-11s %s\n", p.key, p.help);
+      return 0;
+    }
+    else { usage(); return 2; }
+  }
+
+  simSetStartUs(startUs);              // script times count from here
+  if (script && !simLoadScript(script)) return 2;
+  if (replay && !simLoadReplay(replay)) {
+    fprintf(stderr, "[sim] cannot read capture %s\n", replay);
+    return 2;
+  }
+
+  if (flashPath && !simFlashImage(flashPath)) {
+    fprintf(stderr, "[sim] cannot open flash image %s\n", flashPath);
+    return 2;
+  }
+
+  simPins = { BUTTON1_PIN, BUTTON2_PIN, BAT_ADC_PIN, BUZZER_PIN, MOTOR_PIN, I2C_SDA, I2C_SCL };
+  simSensorsInit();
+  simBleNotifyHook = phoneNotify;
+  simRunEvents(simNowUs());
+
+  auto wall0 = std::chrono::steady_clock::now();
+  simProfileEnable(profile);
+
+  uint64_t endUs = 0;
+  const char* halted = nullptr;
+  try {
+    setup();
+    dumpFrame();
+    simReplayStart();
+
+    uint64_t runUs = (uint64_t)(durationS * 1e6);
+    if (!runUs) {
+      uint64_t e = std::min(simScriptEndUs(), simReplayEndUs());
+      runUs = e != SIM_NEVER ? (e > simNowUs() ? e - startUs : 0) : 600000000ULL;
+    }
+    endUs = startUs + runUs;
+    while (simNowUs() < endUs) {
+      if (simCoreStep()) continue;     // core 0 first while it is behind
+      simRunEvents(simNowUs());
+      loop();
+      telWatchNote();
+      dumpFrame();
+    }
+  } catch (const SimHalt& h) {
+    halted = h.why;
+  }
+
+  simProfileEnable(false);
+  double wallS = std::chrono::duration<double>(std::chrono::steady_clock::now() - wall0).count();
+  if (halted) printf("[sim] halted at %.3f s: %s\n", simNowUs() / 1e6, halted);
+  report(simNowUs() - startUs, wallS, profile, top);
+
+  if (simExpectCount()) {
+    printf("\n-- Expectations --\n");
+    printf("  %lu checked, %lu failed\n",
+           (unsigned long)simExpectCount(), (unsigned long)simExpectFailures());
+  }
+  return simExpectFailures() ? 1 : 0;
+}
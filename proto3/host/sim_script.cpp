@@ -0,0 +1,272 @@
+// ============================================================
+// sim_script.cpp — scenario scripts
+// ============================================================
+// One event per line, '#' starts a comment:
+//
+//   <time> <command> [args]      time = s | m:ss | h:mm:ss
+//
+//   wear on|off                  hr <bpm> [rrJitterMs]
+//   spo2 <pct>                   walk <steps/min>     (0 = stop)
+//   tremor <hz> <g>              fall | knock | stand
+//   climb <metres> <secs>        weather <Pa per hour>
+//   battery <pct>                gps <lat> <lng> [sats] | gps off
+//   press 1|2|both [hold_s]      (default hold 0.2s)
+//   mpu ok|zeros|off             max ok|off     bmp ok|off
+//   i2c mpu|max|bmp|<addr> ok|nack|stretch [rate]
+//   i2c stuck                    (a slave holds SDA until clocked)
+//   wifi on|off                  ble connect [mtu]|disconnect|sync
+//   ble stream ppg|acc|both|off  (the phone's clinician session)
+//   ble subscribe|unsubscribe    (the phone's CCCD writes; connect
+//                                 subscribes at once)
+//   expect <key> <value>         expect <key> <min> <max>
+//   show <key> [key...]          end
+//
+// Events at the same time run in file order. Keys for expect/show
+// are listed by sim_main --keys.
+// ============================================================
+
+#include <Arduino.h>
+
+#include <string>
+#include <vector>
+
+struct SimEvent {
+  uint64_t    tUs;
+  uint32_t    seq;          // file order for events at the same time
+  int         line;
+  std::string cmd;
+  std::vector<std::string> args;
+};
+
+static std::vector<SimEvent> events;   // sorted by (tUs, seq)
+static size_t   nextEv      = 0;
+static uint32_t seqCounter  = 0;
+static uint64_t scriptEnd   = SIM_NEVER;
+static uint32_t expectFails = 0, expectRuns = 0;
+static const char* scriptPath = "";
+
+// ── Parsing ──────────────────────────────────────────────────
+static bool parseTime(const std::string& s, uint64_t* us) {
+  double parts[3] = {0, 0, 0};
+  int n = 0;
+  const char* p = s.c_str();
+  while (*p && n < 3) {
+    char* end;
+    parts[n++] = strtod(p, &end);
+    if (end == p) return false;
+    p = end;
+    if (*p == ':') p++;
+    else if (*p) return false;
+  }
+  if (*p) return false;
+  double secs = 0;
+  for (int i = 0; i < n; i++) secs = secs * 60 + parts[i];
+  if (secs < 0) return false;
+  *us = (uint64_t)(secs * 1e6 + 0.5);
+  return true;
+}
+
+static void insertEvent(SimEvent ev) {
+  ev.seq = seqCounter++;
+  auto at = events.end();
+  while (at != events.begin() + nextEv && (at - 1)->tUs > ev.tUs) --at;
+  events.insert(at, std::move(ev));
+}
+
+static size_t argCount(const char* cmd) {
+  static const struct { const char* cmd; size_t min, max; } table[] = {
+    {"wear", 1, 1},  {"hr", 1, 2},      {"spo2", 1, 1},    {"walk", 1, 1},
+    {"tremor", 2, 2}, {"fall", 0, 0},   {"knock", 0, 0},   {"stand", 0, 0},
+    {"climb", 2, 2}, {"weather", 1, 1}, {"battery", 1, 1}, {"gps", 1, 3},
+    {"press", 1, 2}, {"mpu", 1, 1},     {"max", 1, 1},     {"bmp", 1, 1},
+    {"i2c", 1, 3},   {"wifi", 1, 1},    {"ble", 1, 2},     {"expect", 2, 3},
+    {"show", 1, 32}, {"end", 0, 0},
+  };
+  for (const auto& e : table) if (!strcmp(e.cmd, cmd)) return e.min << 8 | e.max;
+  return 0xFFFF;
+}
+
+bool simLoadScript(const char* path) {
+  FILE* f = fopen(path, "r");
+  if (!f) { fprintf(stderr, "[sim] cannot open script %s\n", path); return false; }
+  scriptPath = path;
+  char buf[512];
+  int line = 0;
+  bool ok = true;
+  while (fgets(buf, sizeof(buf), f)) {
+    line++;
+    if (char* hash = strchr(buf, '#')) *hash = 0;
+    std::vector<std::string> tok;
+    for (char* t = strtok(buf, " \t\r\n"); t; t = strtok(nullptr, " \t\r\n")) tok.push_back(t);
+    if (tok.empty()) continue;
+
+    SimEvent ev;
+    ev.line = line;
+    if (tok.size() < 2 || !parseTime(tok[0], &ev.tUs)) {
+      fprintf(stderr, "%s:%d: expected '<time> <command>'\n", path, line);
+      ok = false;
+      continue;
+    }
+    ev.tUs += simNowUs();
+    ev.cmd.assign(tok[1]);
+    ev.args.assign(tok.begin() + 2, tok.end());
+    size_t range = argCount(ev.cmd.c_str());
+    if (range == 0xFFFF) {
+      fprintf(stderr, "%s:%d: unknown command '%s'\n", path, line, ev.cmd.c_str());
+      ok = false;
+      continue;
+    }
+    if (ev.args.size() < (range >> 8) || ev.args.size() > (range & 0xFF)) {
+      fprintf(stderr, "%s:%d: wrong number of arguments to '%s'\n", path, line, ev.cmd.c_str());
+      ok = false;
+      continue;
+    }
+    if (ev.cmd == "end" && ev.tUs < scriptEnd) scriptEnd = ev.tUs;
+    insertEvent(std::move(ev));
+  }
+  fclose(f);
+  return ok;
+}
+
+// ── Applying ─────────────────────────────────────────────────
+static float argF(const SimEvent& ev, size_t i, float def = 0) {
+  return i < ev.args.size() ? strtof(ev.args[i].c_str(), nullptr) : def;
+}
+
+static double argD(const SimEvent& ev, size_t i) {   // exact for 32-bit keys like lcd_crc
+  return i < ev.args.size() ? strtod(ev.args[i].c_str(), nullptr) : 0;
+}
+
+static bool argIs(const SimEvent& ev, size_t i, const char* s) {
+  return i < ev.args.size() && ev.args[i] == s;
+}
+
+static void checkExpect(const SimEvent& ev) {
+  expectRuns++;
+  const char* key = ev.args[0].c_str();
+  double lo = argD(ev, 1), hi = ev.args.size() > 2 ? argD(ev, 2) : lo;
+  double v;
+  if (!simProbe(key, &v)) {
+    printf("[sim] FAIL %s:%d unknown key '%s'\n", scriptPath, ev.line, key);
+    expectFails++;
+    return;
+  }
+  bool pass = v >= lo - 1e-6 && v <= hi + 1e-6;
+  if (!pass) expectFails++;
+  if (lo == hi)
+    printf("[sim] %s %s:%d %s = %.10g (want %.10g)\n", pass ? "ok  " : "FAIL",
+           scriptPath, ev.line, key, v, lo);
+  else
+    printf("[sim] %s %s:%d %s = %.10g (want %.10g..%.10g)\n", pass ? "ok  " : "FAIL",
+           scriptPath, ev.line, key, v, lo, hi);
+}
+
+static void apply(const SimEvent& ev) {
+  SimWorld& w = simWorld;
+  const std::string& c = ev.cmd;
+  uint64_t t = ev.tUs;
+
+  if      (c == "wear")    w.worn = argIs(ev, 0, "on");
+  else if (c == "hr")      { w.hrBpm = argF(ev, 0); if (ev.args.size() > 1) w.rrJitterMs = argF(ev, 1); }
+  else if (c == "spo2")    w.spo2 = argF(ev, 0);
+  else if (c == "walk")    w.cadence = argF(ev, 0);
+  else if (c == "tremor")  { w.tremorHz = argF(ev, 0); w.tremorG = argF(ev, 1); }
+  else if (c == "fall")    w.fallAtUs = t;
+  else if (c == "knock")   w.knockAtUs = t;
+  else if (c == "stand")   w.fallAtUs = SIM_NEVER;
+  else if (c == "climb") {
+    float from = simAltitudeM(t);
+    w.altFromM = from;
+    w.altToM   = from + argF(ev, 0);
+    w.altT0Us  = t;
+    w.altT1Us  = t + (uint64_t)(argF(ev, 1) * 1e6f);
+  }
+  else if (c == "weather") {
+    // Fold the drift so far into sea level so pressure stays continuous
+    w.seaLevelPa += (w.driftPaPerH - argF(ev, 0)) * (t / 3.6e9f);
+    w.driftPaPerH = argF(ev, 0);
+  }
+  else if (c == "battery") w.batteryPct = argF(ev, 0);
+  else if (c == "gps") {
+    if (argIs(ev, 0, "off")) { w.gpsFix = false; return; }
+    w.gpsFix = true;
+    w.lat  = strtod(ev.args[0].c_str(), nullptr);
+    w.lng  = ev.args.size() > 1 ? strtod(ev.args[1].c_str(), nullptr) : 0;
+    w.sats = ev.args.size() > 2 ? atoi(ev.args[2].c_str()) : 8;
+  }
+  else if (c == "press") {
+    uint64_t hold = (uint64_t)(argF(ev, 1, 0.2f) * 1e6f);
+    bool both = argIs(ev, 0, "both");
+    for (int b = 1; b <= 2; b++) {
+      if (!both && atoi(ev.args[0].c_str()) != b) continue;
+      simButton(b, true);
+      simQueueButton(t + hold, b, false);
+    }
+  }
+  else if (c == "mpu")     { w.mpuPresent = !argIs(ev, 0, "off"); w.mpuZeros = argIs(ev, 0, "zeros"); }
+  else if (c == "max")     w.maxPresent = argIs(ev, 0, "ok");
+  else if (c == "bmp")     w.bmpPresent = argIs(ev, 0, "ok");
+  else if (c == "i2c") {
+    if (argIs(ev, 0, "stuck")) {
+      w.sdaStuck  = true;
+      w.sdaClocks = (uint8_t)(1 + simRand() % 8);   // bits left of the byte it was sending
+      return;
+    }
+    uint8_t addr = argIs(ev, 0, "mpu") ? 0x68 : argIs(ev, 0, "max") ? 0x57 :
+                   argIs(ev, 0, "bmp") ? 0x76 : (uint8_t)(strtoul(ev.args[0].c_str(), nullptr, 0) & 0x7F);
+    w.i2cFault[addr]     = argIs(ev, 1, "nack") ? SIM_I2C_NACK :
+                           argIs(ev, 1, "stretch") ? SIM_I2C_STRETCH : SIM_I2C_OK;
+    w.i2cFaultRate[addr] = argF(ev, 2, 1.0f);
+  }
+  else if (c == "wifi")    w.wifi = argIs(ev, 0, "on");
+  else if (c == "ble") {
+    if (argIs(ev, 0, "sync")) simPhoneSync();
+    else if (argIs(ev, 0, "subscribe") || argIs(ev, 0, "unsubscribe")) {
+      simBleSubscribe(argIs(ev, 0, "subscribe"));
+    }
+    else if (argIs(ev, 0, "stream")) {
+      bool both = argIs(ev, 1, "both");
+      simPhoneStream(both || argIs(ev, 1, "ppg"), both || argIs(ev, 1, "acc"));
+    }
+    else {
+      if (ev.args.size() > 1) w.bleMtu = (uint16_t)atoi(ev.args[1].c_str());
+      simBleLink(argIs(ev, 0, "connect"));
+    }
+  }
+  else if (c == "expect")  checkExpect(ev);
+  else if (c == "show") {
+    printf("[sim] %8.3fs", t / 1e6);
+    for (const std::string& k : ev.args) {
+      double v;
+      if (simProbe(k.c_str(), &v)) printf("  %s=%.10g", k.c_str(), v);
+      else                         printf("  %s=?", k.c_str());
+    }
+    printf("\n");
+  }
+  else if (c == "btn")     simButton(atoi(ev.args[0].c_str()), argIs(ev, 1, "down"));
+}
+
+void simRunEvents(uint64_t nowUs) {
+  while (nextEv < events.size() && events[nextEv].tUs <= nowUs) {
+    SimEvent ev = events[nextEv++];   // apply() may insert behind us
+    apply(ev);
+  }
+}
+
+uint64_t simNextEventUs() {
+  return nextEv < events.size() ? events[nextEv].tUs : SIM_NEVER;
+}
+
+// Button edges from "press" and from capture replay
+void simQueueButton(uint64_t tUs, int button, bool down) {
+  SimEvent ev;
+  ev.tUs  = tUs;
+  ev.line = 0;
+  ev.cmd  = "btn";
+  ev.args = { std::to_string(button), down ? "down" : "up" };
+  insertEvent(std::move(ev));
+}
+
+uint64_t simScriptEndUs()    { return scriptEnd; }
+uint32_t simExpectFailures() { return expectFails; }
+uint32_t simExpectCount()    { return expectRuns; }
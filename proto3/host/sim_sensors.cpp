@@ -0,0 +1,673 @@
+// ============================================================
+// sim_sensors.cpp — wearer model and sensor stand-ins
+// ============================================================
+// The wearer is synthesised from SimWorld at each sensor's own
+// output rate:
+//
+//   accel   gravity on the current orientation, walking bounce
+//           at the step cadence (vertical) and arm swing at half
+//           of it, tremor, and the fall sequence: 350ms free
+//           fall → 50ms impact near 4g → tumble → lying still
+//   gyro    arm swing, tremor and the fall rotation
+//   PPG     beats with RR jitter, systolic + dicrotic shape,
+//           red/IR AC ratio from SpO2 (R = (110 - SpO2) / 25),
+//           respiration wander and motion artefact while walking
+//   baro    altitude ramp through the barometric formula, plus
+//           weather drift and ~1 Pa noise
+//
+// With a capture loaded (--replay) the IMU, PPG and baro streams
+// come from the recording instead and buttons are re-pressed at
+// their recorded times.
+// ============================================================
+
+#include <Arduino.h>
+#include <Wire.h>
+#include <MPU6050.h>
+#include <MAX30105.h>
+#include <Adafruit_BMP280.h>
+#include <TinyGPSPlus.h>
+#include "tiga_capture.h"
+
+#include <vector>
+
+// ── Recorded input ───────────────────────────────────────────
+struct BaroPoint {
+  uint64_t tUs;
+  float    pa;
+};
+
+static std::vector<ImuSample> repImu;
+static std::vector<PpgSample> repPpg;
+static std::vector<BaroPoint> repBaro;
+static size_t   repImuPos = 0, repPpgPos = 0, repBaroPos = 0;
+static bool     repLoaded = false, repRunning = false;
+static uint64_t repT0Us = 0, repSpanUs = 0;
+
+struct ButtonPoint {
+  uint64_t tUs;
+  int      button;
+  bool     down;
+};
+static std::vector<ButtonPoint> repButtons;
+
+bool simLoadReplay(const char* path) {
+  CaptureReader rd;
+  if (!rd.open(path)) return false;
+  CapRecord r;
+  uint64_t first = 0, last = 0;
+  bool any = false;
+  while (rd.next(r)) {
+    if (!any) { first = r.t64Us; any = true; }
+    last = r.t64Us;
+    uint64_t t = r.t64Us - first;
+    switch (r.type) {
+      case CAP_IMU:
+        for (uint8_t i = 0; i < capImuCount(r); i++) {
+          ImuSample s;
+          capImuSample(r, i, s);
+          repImu.push_back(s);
+        }
+        break;
+      case CAP_PPG:
+        for (uint8_t i = 0; i < capPpgCount(r); i++)
+          repPpg.push_back({capPpgRed(r, i), capPpgIr(r, i)});
+        break;
+      case CAP_BARO:
+        repBaro.push_back({t, capGet32(r.payload) / 10.0f});
+        break;
+      case CAP_BUTTON:
+        repButtons.push_back({t, r.payload[0], r.payload[1] != 0});
+        break;
+    }
+  }
+  repSpanUs = last - first;
+  repLoaded = any;
+  printf("[sim] replay %s: %zu IMU, %zu PPG, %zu baro, %zu button records, %.1f s\n",
+         path, repImu.size(), repPpg.size(), repBaro.size(), repButtons.size(),
+         repSpanUs / 1e6);
+  if (rd.skippedBytes)
+    printf("[sim] replay: skipped %llu bytes while resyncing\n",
+           (unsigned long long)rd.skippedBytes);
+  return any;
+}
+
+void simReplayStart() {
+  if (!repLoaded) return;
+  repRunning = true;
+  repT0Us = simNowUs();
+  for (const ButtonPoint& b : repButtons) simQueueButton(repT0Us + b.tUs, b.button, b.down);
+}
+
+bool     simReplayActive() { return repRunning; }
+uint64_t simReplayEndUs()  { return repRunning ? repT0Us + repSpanUs : SIM_NEVER; }
+
+// ── World helpers ────────────────────────────────────────────
+float simAltitudeM(uint64_t t) {
+  const SimWorld& w = simWorld;
+  if (t <= w.altT0Us || w.altT1Us <= w.altT0Us) return t < w.altT1Us ? w.altFromM : w.altToM;
+  if (t >= w.altT1Us) return w.altToM;
+  float f = (float)(t - w.altT0Us) / (float)(w.altT1Us - w.altT0Us);
+  return w.altFromM + (w.altToM - w.altFromM) * f;
+}
+
+#define SIM_STRIDE_M  0.65f
+
+void simWorldTick(uint64_t fromUs, uint64_t toUs) {
+  SimWorld& w = simWorld;
+  if (!w.gpsFix || w.cadence <= 0 || toUs <= fromUs) return;
+  // Walk due north at cadence × stride
+  double m = w.cadence / 60.0 * SIM_STRIDE_M * (toUs - fromUs) / 1e6;
+  w.lat += m / 111320.0;
+}
+
+static bool lyingAt(uint64_t t) {
+  return simWorld.fallAtUs != SIM_NEVER && t >= simWorld.fallAtUs + 400000;
+}
+
+// Acceleration in g and rotation in °/s at time t.
+//
+// The wrist's attitude is a pitch θ and a roll φ (yaw never shows
+// in either sensor's gravity term). Gravity in sensor axes is then
+// (sin θ, cos θ sin φ, cos θ cos φ) and the gyro reads
+// (φ', -θ' cos φ, θ' sin φ), so anything that turns the wrist goes
+// through θ and φ and the two sensors agree, as on a real part.
+// Step bounce, tremor, impact and knocks are linear accelerations
+// added on top.
+#define SIM_UPRIGHT_PITCH   2.87f     // face up on the wrist: (0.05, 0.10, 0.99)
+#define SIM_UPRIGHT_ROLL    5.77f
+#define SIM_LYING_PITCH    66.9f      // on its side after a fall: (0.92, 0.30, 0.25)
+#define SIM_LYING_ROLL     50.2f
+#define SIM_FALL_TURN_S     0.40f     // free fall + impact: turned over by then
+
+static const float simGyroBias[3] = { 0.8f, -0.5f, 0.3f };   // °/s zero-rate offset
+
+static void wearerImu(uint64_t tUs, float a[3], float g[3]) {
+  const SimWorld& w = simWorld;
+  float t = tUs / 1e6f;
+  const float twoPi = 6.2831853f, rad = twoPi / 360;
+  bool  falling = w.fallAtUs != SIM_NEVER && tUs >= w.fallAtUs;
+  float dt = falling ? (tUs - w.fallAtUs) / 1e6f : 0;
+
+  // Attitude in degrees and its rate in °/s
+  float pitch = SIM_UPRIGHT_PITCH, roll = SIM_UPRIGHT_ROLL, dPitch = 0, dRoll = 0;
+  float lin[3] = { 0, 0, 0 };
+  g[0] = g[1] = g[2] = 0;
+  if (lyingAt(tUs)) {
+    pitch = SIM_LYING_PITCH; roll = SIM_LYING_ROLL;
+  } else if (falling) {                     // turning over, steadily
+    dPitch = (SIM_LYING_PITCH - SIM_UPRIGHT_PITCH) / SIM_FALL_TURN_S;
+    dRoll  = (SIM_LYING_ROLL  - SIM_UPRIGHT_ROLL)  / SIM_FALL_TURN_S;
+    pitch += dPitch * dt; roll += dRoll * dt;
+  }
+
+  if (w.cadence > 0 && !lyingAt(tUs)) {
+    float f = w.cadence / 60.0f, ph = twoPi * f * t;
+    pitch  += 6.9f * sinf(0.5f * ph);       // arm swing, one per stride
+    dPitch += 6.9f * 0.5f * twoPi * f * cosf(0.5f * ph);
+    roll   += 2.9f * cosf(ph);
+    dRoll  -= 2.9f * twoPi * f * sinf(ph);
+    lin[2] += 0.30f * sinf(ph) + 0.08f * sinf(2 * ph);
+  }
+
+  if (falling && dt >= SIM_FALL_TURN_S && dt < 1.2f) {   // rocking to a stop
+    float u = dt - SIM_FALL_TURN_S, k = expf(-u * 5.0f), wr = twoPi * 4.0f;
+    pitch  += 6.0f * k * sinf(wr * u);
+    dPitch += 6.0f * k * (wr * cosf(wr * u) - 5.0f * sinf(wr * u));
+    lin[0] += 0.8f * k * sinf(twoPi * 6.0f * u);
+    lin[2] += 0.5f * k * cosf(twoPi * 6.0f * u);
+  }
+
+  if (w.tremorG > 0) {
+    float s = sinf(twoPi * w.tremorHz * t);
+    lin[0] += w.tremorG * s;
+    lin[1] += 0.6f * w.tremorG * cosf(twoPi * w.tremorHz * t);
+    g[2]   += 120.0f * w.tremorG * s;
+  }
+
+  float th = pitch * rad, phi = roll * rad;
+  a[0] = sinf(th) + lin[0];
+  a[1] = cosf(th) * sinf(phi) + lin[1];
+  a[2] = cosf(th) * cosf(phi) + lin[2];
+  g[0] += dRoll;
+  g[1] -= dPitch * cosf(phi);
+  g[2] += dPitch * sinf(phi);
+
+  if (falling && dt < 0.35f) {              // free fall
+    a[0] *= 0.12f; a[1] *= 0.12f; a[2] *= 0.12f;
+  } else if (falling && dt < SIM_FALL_TURN_S) {   // impact
+    a[0] = 2.6f; a[1] = 1.4f; a[2] = 2.7f;
+  }
+
+  if (w.knockAtUs != SIM_NEVER && tUs >= w.knockAtUs && tUs < w.knockAtUs + 30000) {
+    a[2] += 2.6f;                           // sharp bump, stays upright
+  }
+
+  for (int i = 0; i < 3; i++) {
+    a[i] += simGauss(0.008f);
+    g[i] += simGyroBias[i] + simGauss(0.5f);
+  }
+}
+
+// ── PPG wearer model ─────────────────────────────────────────
+static float    beatPhase = 0;
+static float    beatRrS   = 60.0f / 72;
+static uint32_t beatCount = 0;
+static double   beatRrSum = 0;
+
+static float pulseShape(float ph) {
+  float a = (ph - 0.15f) / 0.07f, b = (ph - 0.45f) / 0.09f;
+  return expf(-a * a) + 0.35f * expf(-b * b);
+}
+
+static void wearerPpg(uint64_t tUs, float dtS, uint32_t* red, uint32_t* ir) {
+  const SimWorld& w = simWorld;
+  float t = tUs / 1e6f;
+  if (!w.worn) {
+    *ir  = (uint32_t)(4000 + simGauss(150));
+    *red = (uint32_t)(3500 + simGauss(150));
+    return;
+  }
+
+  beatPhase += dtS / beatRrS;
+  if (beatPhase >= 1.0f) {
+    beatPhase -= 1.0f;
+    beatCount++;
+    beatRrSum += beatRrS;
+    float rr = 60.0f / (w.hrBpm > 20 ? w.hrBpm : 20) + simGauss(w.rrJitterMs / 1000.0f);
+    beatRrS = rr < 0.25f ? 0.25f : rr;
+  }
+  float p = pulseShape(beatPhase);
+
+  const float irDc = 120000, redDc = 90000, irAc = 700;
+  float R     = (110.0f - w.spo2) / 25.0f;
+  float redAc = R * irAc / irDc * redDc;
+  float resp  = 300.0f * sinf(6.2831853f * 0.25f * t);
+
+  float fIr  = irDc + resp - irAc * p;
+  float fRed = redDc + resp * 0.75f - redAc * p;
+  if (w.cadence > 0) {
+    float m = 350.0f * sinf(6.2831853f * w.cadence / 60.0f * t + 0.7f);
+    fIr += m; fRed += 0.75f * m;
+  }
+  if (w.tremorG > 0) {
+    float m = 4000.0f * w.tremorG * sinf(6.2831853f * w.tremorHz * t);
+    fIr += m; fRed += 0.75f * m;
+  }
+  fIr  += simGauss(30);
+  fRed += simGauss(25);
+  *ir  = (uint32_t)constrain(fIr,  0.0f, 262143.0f);
+  *red = (uint32_t)constrain(fRed, 0.0f, 262143.0f);
+}
+
+void simPpgBeatStats(uint32_t* beats, float* meanRrMs) {
+  *beats    = beatCount;
+  *meanRrMs = beatCount ? (float)(beatRrSum / beatCount * 1000.0) : 0;
+}
+
+// ============================================================
+// MPU6050 model
+// ============================================================
+struct SimMpu {
+  uint8_t  fsAccel = 0, fsGyro = 0, dlpf = 0, div = 0;
+  bool     fifoOn = false, accelFifo = false, tempFifo = false;
+  bool     gyroFifo[3] = {false, false, false};
+  bool     ovf = false;
+  uint8_t  ring[MPU6050_FIFO_BYTES];
+  uint16_t head = 0, count = 0;
+  uint64_t t0Us = 0;
+  uint64_t k = 0;          // next sample index since t0Us
+
+  uint32_t rateHz() const { return (dlpf == 0 || dlpf == 7 ? 8000 : 1000) / (1 + div); }
+
+  void retime() { t0Us = simNowUs(); k = 1; }
+
+  void push(uint8_t b) {
+    if (count == MPU6050_FIFO_BYTES) {        // overwrite oldest, flag it
+      ovf = true;
+      head = (head + 1) % MPU6050_FIFO_BYTES;
+      count--;
+    }
+    ring[(head + count) % MPU6050_FIFO_BYTES] = b;
+    count++;
+  }
+
+  void push16(int16_t v) { push((uint8_t)(v >> 8)); push((uint8_t)v); }
+
+  void frame(uint64_t tUs) {
+    int16_t a[3], g[3];
+    if (simWorld.mpuZeros) {
+      a[0] = a[1] = a[2] = g[0] = g[1] = g[2] = 0;
+    } else if (repRunning) {
+      if (repImuPos >= repImu.size()) return;
+      const ImuSample& s = repImu[repImuPos++];
+      a[0] = s.ax; a[1] = s.ay; a[2] = s.az;
+      g[0] = s.gx; g[1] = s.gy; g[2] = s.gz;
+    } else {
+      float af[3], gf[3];
+      wearerImu(tUs, af, gf);
+      float lsbG = (float)(16384 >> fsAccel), lsbDps = 131.0f / (1 << fsGyro);
+      for (int i = 0; i < 3; i++) {
+        a[i] = (int16_t)constrain(af[i] * lsbG,   -32768.0f, 32767.0f);
+        g[i] = (int16_t)constrain(gf[i] * lsbDps, -32768.0f, 32767.0f);
+      }
+    }
+    if (accelFifo) { push16(a[0]); push16(a[1]); push16(a[2]); }
+    if (tempFifo)  push16((int16_t)((31.0f - 36.53f) * 340));
+    for (int i = 0; i < 3; i++) if (gyroFifo[i]) push16(g[i]);
+  }
+
+  // Produce every sample due up to now
+  void update() {
+    uint64_t now = simNowUs();
+    uint32_t hz = rateHz();
+    bool feeding = fifoOn && (accelFifo || tempFifo || gyroFifo[0] || gyroFifo[1] || gyroFifo[2]);
+    for (;;) {
+      uint64_t t = t0Us + k * 1000000ULL / hz;
+      if (t > now) break;
+      if (!feeding) { k = (now - t0Us) * hz / 1000000ULL + 1; break; }
+      frame(t);
+      k++;
+    }
+  }
+
+  uint8_t pop() {
+    if (!count) return 0;
+    uint8_t b = ring[head];
+    head = (head + 1) % MPU6050_FIFO_BYTES;
+    count--;
+    return b;
+  }
+};
+
+static SimMpu mpuModel;
+
+#define MPU_COST(n)  simI2cCost((uint16_t)(n) + 1)   // register byte + data
+
+void MPU6050::initialize() {
+  MPU_COST(3);
+  mpuModel.fsAccel = MPU6050_ACCEL_FS_2;
+  mpuModel.fsGyro  = MPU6050_GYRO_FS_250;
+  mpuModel.retime();
+}
+
+bool MPU6050::testConnection() {
+  MPU_COST(1);
+  return simWorld.mpuPresent && simI2cAck(MPU6050_ADDR);
+}
+
+void MPU6050::setFullScaleAccelRange(uint8_t r) { MPU_COST(1); mpuModel.fsAccel = r & 3; }
+void MPU6050::setFullScaleGyroRange(uint8_t r)  { MPU_COST(1); mpuModel.fsGyro  = r & 3; }
+void MPU6050::setDLPFMode(uint8_t m) { MPU_COST(1); mpuModel.update(); mpuModel.dlpf = m & 7; mpuModel.retime(); }
+void MPU6050::setRate(uint8_t d)     { MPU_COST(1); mpuModel.update(); mpuModel.div  = d;     mpuModel.retime(); }
+
+void MPU6050::getAcceleration(int16_t* x, int16_t* y, int16_t* z) {
+  int16_t gx, gy, gz;
+  getMotion6(x, y, z, &gx, &gy, &gz);
+}
+
+void MPU6050::getRotation(int16_t* x, int16_t* y, int16_t* z) {
+  int16_t ax, ay, az;
+  getMotion6(&ax, &ay, &az, x, y, z);
+}
+
+void MPU6050::getMotion6(int16_t* ax, int16_t* ay, int16_t* az,
+                         int16_t* gx, int16_t* gy, int16_t* gz) {
+  MPU_COST(14);
+  *ax = *ay = *az = *gx = *gy = *gz = 0;
+  if (!simWorld.mpuPresent || simWorld.mpuZeros) return;
+  float af[3], gf[3];
+  wearerImu(simNowUs(), af, gf);
+  float lsbG = (float)(16384 >> mpuModel.fsAccel), lsbDps = 131.0f / (1 << mpuModel.fsGyro);
+  *ax = (int16_t)constrain(af[0] * lsbG, -32768.0f, 32767.0f);
+  *ay = (int16_t)constrain(af[1] * lsbG, -32768.0f, 32767.0f);
+  *az = (int16_t)constrain(af[2] * lsbG, -32768.0f, 32767.0f);
+  *gx = (int16_t)constrain(gf[0] * lsbDps, -32768.0f, 32767.0f);
+  *gy = (int16_t)constrain(gf[1] * lsbDps, -32768.0f, 32767.0f);
+  *gz = (int16_t)constrain(gf[2] * lsbDps, -32768.0f, 32767.0f);
+}
+
+int16_t MPU6050::getTemperature() {
+  MPU_COST(2);
+  if (!simWorld.mpuPresent) return 0;
+  return (int16_t)((31.0f + simGauss(0.05f) - 36.53f) * 340);
+}
+
+void MPU6050::setAccelFIFOEnabled(bool on) { MPU_COST(1); mpuModel.update(); mpuModel.accelFifo   = on; }
+void MPU6050::setXGyroFIFOEnabled(bool on) { MPU_COST(1); mpuModel.update(); mpuModel.gyroFifo[0] = on; }
+void MPU6050::setYGyroFIFOEnabled(bool on) { MPU_COST(1); mpuModel.update(); mpuModel.gyroFifo[1] = on; }
+void MPU6050::setZGyroFIFOEnabled(bool on) { MPU_COST(1); mpuModel.update(); mpuModel.gyroFifo[2] = on; }
+void MPU6050::setTempFIFOEnabled(bool on)  { MPU_COST(1); mpuModel.update(); mpuModel.tempFifo    = on; }
+void MPU6050::setFIFOEnabled(bool on)      { MPU_COST(1); mpuModel.update(); mpuModel.fifoOn      = on; }
+
+void MPU6050::resetFIFO() {
+  MPU_COST(1);
+  mpuModel.update();
+  mpuModel.head = mpuModel.count = 0;
+}
+
+uint16_t MPU6050::getFIFOCount() {
+  MPU_COST(2);
+  if (!simWorld.mpuPresent) return 0;
+  mpuModel.update();
+  return mpuModel.count;
+}
+
+void MPU6050::getFIFOBytes(uint8_t* data, uint8_t len) {
+  MPU_COST(len);
+  if (!simWorld.mpuPresent) { memset(data, 0, len); return; }
+  mpuModel.update();
+  for (uint8_t i = 0; i < len; i++) data[i] = mpuModel.pop();
+}
+
+bool MPU6050::getIntFIFOBufferOverflowStatus() {
+  MPU_COST(1);
+  if (!simWorld.mpuPresent) return false;
+  mpuModel.update();
+  bool o = mpuModel.ovf;
+  mpuModel.ovf = false;                  // INT_STATUS clears on read
+  return o;
+}
+
+// The registers the firmware reads the FIFO through, on the Wire
+// bus at 0x68; setup still goes through the library calls above
+class SimMpuBus : public SimI2cDevice {
+public:
+  bool present() override { return simWorld.mpuPresent; }
+
+  void write(const uint8_t* p, uint8_t n) override {
+    if (!n) return;
+    reg_ = p[0];
+    for (uint8_t i = 1; i < n; i++, reg_++) {
+      if (reg_ != MPU6050_USER_CTRL) continue;
+      mpuModel.update();
+      mpuModel.fifoOn = p[i] & MPU6050_UC_FIFO_EN;
+      if (p[i] & MPU6050_UC_FIFO_RESET) mpuModel.head = mpuModel.count = 0;
+    }
+  }
+
+  // The register pointer advances, except on the FIFO port
+  void read(uint8_t* out, uint8_t n) override {
+    mpuModel.update();
+    for (uint8_t i = 0; i < n; i++) {
+      switch (reg_) {
+        case MPU6050_INT_STATUS:
+          out[i] = mpuModel.ovf ? MPU6050_INT_FIFO_OFLOW : 0;
+          mpuModel.ovf = false;                // clears on read
+          break;
+        case MPU6050_USER_CTRL:       out[i] = mpuModel.fifoOn ? MPU6050_UC_FIFO_EN : 0; break;
+        case MPU6050_FIFO_COUNTH:     out[i] = (uint8_t)(mpuModel.count >> 8); break;
+        case MPU6050_FIFO_COUNTH + 1: out[i] = (uint8_t)mpuModel.count; break;
+        case MPU6050_FIFO_R_W:        out[i] = mpuModel.pop(); continue;
+        default:                      out[i] = 0; break;
+      }
+      reg_++;
+    }
+  }
+
+private:
+  uint8_t reg_ = 0;
+};
+
+static SimMpuBus mpuBus;
+
+// ============================================================
+// MAX30102 register model (on the Wire bus at 0x57)
+// ============================================================
+#define MAXM_PART_ID   0xFF
+
+class SimMax30102 : public SimI2cDevice {
+public:
+  bool present() override { return simWorld.maxPresent; }
+
+  void configure(uint16_t rateHz) {
+    rateHz_ = rateHz ? rateHz : 100;
+    clear();
+    t0Us_ = simNowUs();
+    k_ = 1;
+    running_ = true;
+  }
+
+  void clear() {
+    update();                                // what was queued is discarded
+    wr_ = rd_ = ovf_ = count_ = 0;
+    stagePos_ = sizeof(stage_);
+  }
+
+  void write(const uint8_t* p, uint8_t n) override {
+    if (!n) return;
+    reg_ = p[0];
+    for (uint8_t i = 1; i < n; i++, reg_++) {
+      // The SparkFun clearFIFO() zeroes the three pointer registers
+      if (reg_ == MAX30102_FIFO_WR_PTR) { wr_ = p[i] & 31; count_ = (wr_ - rd_) & 31; }
+      if (reg_ == MAX30102_OVF_COUNTER) ovf_ = p[i] & 31;
+      if (reg_ == MAX30102_FIFO_RD_PTR) { rd_ = p[i] & 31; count_ = (wr_ - rd_) & 31; }
+    }
+  }
+
+  void read(uint8_t* out, uint8_t n) override {
+    update();
+    for (uint8_t i = 0; i < n; i++) {
+      if (reg_ == MAX30102_FIFO_DATA) { out[i] = dataByte(); continue; }
+      switch (reg_) {
+        case MAX30102_FIFO_WR_PTR: out[i] = wr_;  break;
+        case MAX30102_OVF_COUNTER: out[i] = ovf_; break;
+        case MAX30102_FIFO_RD_PTR: out[i] = rd_;  break;
+        case MAXM_PART_ID:         out[i] = 0x15; break;
+        default:                   out[i] = 0;    break;
+      }
+      reg_++;
+    }
+  }
+
+private:
+  PpgSample fifo_[PPG_FIFO_DEPTH];
+  uint8_t   wr_ = 0, rd_ = 0, ovf_ = 0, count_ = 0;
+  uint8_t   reg_ = 0;
+  uint8_t   stage_[PPG_BYTES_PER_SAMPLE];
+  uint8_t   stagePos_ = PPG_BYTES_PER_SAMPLE;
+  uint16_t  rateHz_ = 100;
+  uint64_t  t0Us_ = 0, k_ = 1;
+  bool      running_ = false;
+
+  void update() {
+    if (!running_) return;
+    uint64_t now = simNowUs();
+    float dt = 1.0f / rateHz_;
+    for (;;) {
+      uint64_t t = t0Us_ + k_ * 1000000ULL / rateHz_;
+      if (t > now) break;
+      PpgSample s;
+      if (repRunning) {
+        if (repPpgPos >= repPpg.size()) { k_++; continue; }
+        s = repPpg[repPpgPos++];
+      } else {
+        wearerPpg(t, dt, &s.red, &s.ir);
+      }
+      push(s);
+      k_++;
+    }
+  }
+
+  // Rollover on: a full FIFO overwrites its oldest sample
+  void push(const PpgSample& s) {
+    if (count_ == PPG_FIFO_DEPTH) {
+      rd_ = (rd_ + 1) & 31;
+      count_--;
+      if (ovf_ < 31) ovf_++;
+    }
+    fifo_[wr_] = s;
+    wr_ = (wr_ + 1) & 31;
+    count_++;
+  }
+
+  uint8_t dataByte() {
+    if (stagePos_ >= sizeof(stage_)) {
+      PpgSample s = {0, 0};
+      if (count_) {
+        s = fifo_[rd_];
+        rd_ = (rd_ + 1) & 31;
+        count_--;
+        ovf_ = 0;                            // cleared when a sample is popped
+      }
+      stage_[0] = (uint8_t)(s.red >> 16); stage_[1] = (uint8_t)(s.red >> 8); stage_[2] = (uint8_t)s.red;
+      stage_[3] = (uint8_t)(s.ir >> 16);  stage_[4] = (uint8_t)(s.ir >> 8);  stage_[5] = (uint8_t)s.ir;
+      stagePos_ = 0;
+    }
+    return stage_[stagePos_++];
+  }
+};
+
+static SimMax30102 maxModel;
+
+bool MAX30105::begin(TwoWire& bus, uint32_t i2cSpeed, uint8_t addr) {
+  bus.setClock(i2cSpeed);
+  bus.beginTransmission(addr);
+  bus.write(MAXM_PART_ID);
+  if (bus.endTransmission(false) != 0) return false;
+  bus.requestFrom(addr, (uint8_t)1);
+  return bus.available() && bus.read() == 0x15;
+}
+
+void MAX30105::setup(uint8_t, uint8_t sampleAverage, uint8_t, int sampleRate, int, int) {
+  simI2cCost(2 * 8);                       // ~8 register writes
+  maxModel.configure((uint16_t)(sampleRate / (sampleAverage ? sampleAverage : 1)));
+}
+
+void MAX30105::clearFIFO() {
+  simI2cCost(2 * 3);
+  maxModel.clear();
+}
+
+// ============================================================
+// BMP280
+// ============================================================
+static bool bmpBegun = false;
+
+bool Adafruit_BMP280::begin(uint8_t addr, uint8_t) {
+  simI2cCost(2 + 24);                      // chip id + calibration block
+  bmpBegun = simWorld.bmpPresent && addr == 0x76 && simI2cAck(addr);
+  return bmpBegun;
+}
+
+float Adafruit_BMP280::readTemperature() {
+  simI2cCost(1 + 3);
+  return 24.5f + simGauss(0.02f);
+}
+
+float Adafruit_BMP280::readPressure() {
+  readTemperature();                       // t_fine first, as the library does
+  simI2cCost(1 + 3);
+  if (!bmpBegun || !simWorld.bmpPresent || !simI2cAck(0x76)) return NAN;
+  uint64_t now = simNowUs();
+  if (repRunning && !repBaro.empty()) {
+    while (repBaroPos + 1 < repBaro.size() && repT0Us + repBaro[repBaroPos + 1].tUs <= now)
+      repBaroPos++;
+    return repBaro[repBaroPos].pa;
+  }
+  float alt = simAltitudeM(now);
+  float p = simWorld.seaLevelPa * powf(1.0f - 2.25577e-5f * alt, 5.25588f);
+  p += simWorld.driftPaPerH * (now / 3.6e9f);
+  return p + simGauss(1.0f);
+}
+
+float Adafruit_BMP280::readAltitude(float seaLevelhPa) {
+  float hPa = readPressure() / 100.0f;
+  return 44330.0f * (1.0f - powf(hPa / seaLevelhPa, 0.1903f));
+}
+
+// ============================================================
+// GPS
+// ============================================================
+bool     TinyGPSLocation::isValid() const { return simWorld.gpsFix; }
+uint32_t TinyGPSLocation::age() const     { return simWorld.gpsFix ? (uint32_t)(simNowUs() / 1000 % 1000) : 0xFFFFFFFF; }
+double   TinyGPSLocation::lat() const     { return simWorld.lat; }
+double   TinyGPSLocation::lng() const     { return simWorld.lng; }
+
+bool   TinyGPSSpeed::isValid() const { return simWorld.gpsFix; }
+double TinyGPSSpeed::kmph() const    { return simWorld.cadence / 60.0 * SIM_STRIDE_M * 3.6; }
+
+bool     TinyGPSInteger::isValid() const { return simWorld.gpsFix; }
+uint32_t TinyGPSInteger::value() const   { return simWorld.gpsFix ? (uint32_t)simWorld.sats : 0; }
+
+double TinyGPSPlus::distanceBetween(double lat1, double long1, double lat2, double long2) {
+  // Great-circle distance, as in TinyGPS++
+  double delta = radians(long1 - long2);
+  double sdlong = sin(delta), cdlong = cos(delta);
+  lat1 = radians(lat1);
+  lat2 = radians(lat2);
+  double slat1 = sin(lat1), clat1 = cos(lat1);
+  double slat2 = sin(lat2), clat2 = cos(lat2);
+  delta = (clat1 * slat2) - (slat1 * clat2 * cdlong);
+  delta = delta * delta;
+  delta += (clat2 * sdlong) * (clat2 * sdlong);
+  delta = sqrt(delta);
+  double denom = (slat1 * slat2) + (clat1 * clat2 * cdlong);
+  delta = atan2(delta, denom);
+  return delta * 6372795;
+}
+
+// ── Bus wiring ───────────────────────────────────────────────
+void simSensorsInit() {
+  Wire.attach(MPU6050_ADDR, &mpuBus);
+  Wire.attach(MAX30102_ADDR, &maxModel);
+}
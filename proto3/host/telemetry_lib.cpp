@@ -0,0 +1,45 @@
+// ============================================================
+// telemetry_lib.cpp — C interface to the TIGA telemetry decoder
+// ============================================================
+// See telemetry_lib.h. All the decoding is tiga_telemetry.h.
+// ============================================================
+
+#include "telemetry_lib.h"
+#include "tiga_telemetry.h"
+
+#include <new>
+
+struct TigaTel {
+  TelDecoder dec;
+};
+
+int tiga_tel_version(void) { return TEL_VERSION; }
+int tiga_tel_fields(void)  { return TEL_FIELDS; }
+
+const char* tiga_tel_field_name(int field) {
+  return field >= 0 && field < TEL_FIELDS ? TEL_FIELD_INFO[field].name : nullptr;
+}
+
+TigaTel* tiga_tel_new(void)       { return new (std::nothrow) TigaTel(); }
+void     tiga_tel_free(TigaTel* d) { delete d; }
+void     tiga_tel_reset(TigaTel* d) { d->dec = TelDecoder(); }
+
+uint32_t tiga_tel_decode(TigaTel* d, const uint8_t* frame, uint16_t len) {
+  return frame ? d->dec.decode(frame, len) : 0;
+}
+
+int      tiga_tel_synced(const TigaTel* d) { return d->dec.synced; }
+uint32_t tiga_tel_have(const TigaTel* d)   { return d->dec.have; }
+
+int32_t tiga_tel_value(const TigaTel* d, int field) {
+  return field >= 0 && field < TEL_FIELDS ? d->dec.cur.v[field] : 0;
+}
+
+void tiga_tel_stats(const TigaTel* d, TigaTelStats* out) {
+  out->frames    = d->dec.frames;
+  out->keyFrames = d->dec.keyFrames;
+  out->gaps      = d->dec.gaps;
+  out->stale     = d->dec.stale;
+  out->rejected  = d->dec.rejected;
+  out->unknown   = d->dec.unknown;
+}
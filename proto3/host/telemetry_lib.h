@@ -0,0 +1,48 @@
+// ============================================================
+// telemetry_lib.h — C interface to the TIGA telemetry decoder
+// ============================================================
+// tiga_telemetry.h's TelDecoder behind a C ABI, so apps and tools
+// that aren't C++ (Python ctypes, a Flutter FFI plugin, test rigs)
+// decode frames with exactly the firmware's code.
+//
+//   make lib     → build/libtigatel.a, build/libtigatel.so
+//
+//   TigaTel* d = tiga_tel_new();
+//   uint32_t changed = tiga_tel_decode(d, frame, len);
+//   int32_t hr = tiga_tel_value(d, 0);     // field numbers as in
+//   tiga_tel_free(d);                      // tiga_telemetry.h
+// ============================================================
+
+#pragma once
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct TigaTel TigaTel;
+
+typedef struct {
+  uint32_t frames, keyFrames, gaps, stale, rejected, unknown;
+} TigaTelStats;
+
+int         tiga_tel_version(void);               // TEL_VERSION this library decodes
+int         tiga_tel_fields(void);                // fields it knows
+const char* tiga_tel_field_name(int field);       // NULL past the last
+
+TigaTel*    tiga_tel_new(void);
+void        tiga_tel_free(TigaTel* d);
+void        tiga_tel_reset(TigaTel* d);           // new connection: wait for a key frame
+
+// Fields the frame updated (bit f = field f), 0 if it was dropped
+uint32_t    tiga_tel_decode(TigaTel* d, const uint8_t* frame, uint16_t len);
+
+int         tiga_tel_synced(const TigaTel* d);     // values current
+uint32_t    tiga_tel_have(const TigaTel* d);       // fields received since the last key frame
+int32_t     tiga_tel_value(const TigaTel* d, int field);
+void        tiga_tel_stats(const TigaTel* d, TigaTelStats* out);
+
+#ifdef __cplusplus
+}
+#endif
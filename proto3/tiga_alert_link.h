@@ -0,0 +1,450 @@
+// ============================================================
+// tiga_alert_link.h — alerts to the phone, acknowledged
+// ============================================================
+// Falls, SOS and HR emergencies reached the phone only as the
+// falls byte of the once-a-second snapshot: no acknowledgement,
+// nothing about what happened or where, and lost if the link was
+// down at the time. Each alert is now an event of its own, sent
+// the moment it is raised as a BLE indication — the phone's stack
+// confirms every one — and kept in flash until it is confirmed, so
+// it outlives a dropped link, a reboot or deep sleep.
+//
+// ── Event (one indication, little-endian) ───────────────────
+//     [0-3]   id        uint32, +1 per alert, carried across reboots
+//     [4]     kind      bits 3-0 AlertType, bits 7-4 AlertSeverity
+//     [5-8]   t         Unix seconds when raised
+//     [9-12]  lat       int32, degrees × 1e7, of the last GPS fix
+//     [13-16] lng       int32, degrees × 1e7
+//     [17-18] fixAge    seconds from that fix to the alert,
+//                       ALERT_NO_FIX = none since boot
+//     [19]    sats      satellites in that fix
+// 20 bytes: one indication at the default 23-byte MTU, so an
+// alert never waits on an MTU exchange. A resend carries the same
+// id and the phone drops ids it has already seen — a confirmation
+// lost with the link means the indication itself arrived.
+//
+// ── Flash ────────────────────────────────────────────────────
+// An "alerts" partition, a ring of 4 KB sectors of 32-byte slots:
+//     [0]     magic     ALERT_MAGIC; a blank slot is all 0xFF
+//     [1]     acked     0xFF until confirmed, then programmed 0x00
+//     [2-21]  event     as sent
+//     [22-23] crc16     over bytes 0 and 2-21
+// Raising an alert is one slot write and its confirmation one
+// byte programmed over the slot — no erase for either, and a power
+// cut leaves at worst a slot that fails its CRC. When the head
+// sector fills, the next is erased (~45 ms, once per 128 alerts)
+// and the alerts still waiting are copied into it first, so the
+// sector after that is free to erase in turn. begin() orders the
+// sectors by their newest id and replays them: the latest copy of
+// each alert says whether it is still waiting.
+//
+// ── Sending ──────────────────────────────────────────────────
+// ATT allows one indication outstanding, so alerts go one at a
+// time, oldest first. With no confirmation after ALERT_ACK_MS, or
+// after a disconnect, the same alert goes again; on connect
+// everything waiting follows. At most ALERT_WAITING are held; past
+// that the oldest of the least severe is given up (counted in
+// `dropped`). Confirmations and link changes arrive in the BLE
+// stack's task and are only flagged there; run(), from a
+// scheduler task, does the work.
+//
+// Memory: ~760 bytes. Host test: host/bench_alert.cpp
+// ============================================================
+
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+#include "tiga_sync.h"          // HistFlash, histCrc16, syncPut/Get
+
+#define ALERT_EVENT_BYTES   20
+#define ALERT_SLOT          32
+#define ALERT_SLOTS         (HIST_SECTOR / ALERT_SLOT)
+#define ALERT_MAGIC         0xA7
+#define ALERT_SECTORS_MAX   4         // of the partition, at most
+#define ALERT_WAITING       16        // unconfirmed alerts held
+#define ALERT_ACK_MS        5000      // no confirmation for this long: send again
+#define ALERT_NO_FIX        0xFFFF
+#define ALERT_LAT_BUCKETS   5         // < 0.25 s, < 1 s, < 5 s, < 60 s, longer
+
+enum AlertType : uint8_t {
+  ALERT_EV_FALL    = 1,
+  ALERT_EV_SOS     = 2,
+  ALERT_EV_HR_HIGH = 3,
+  ALERT_EV_HR_LOW  = 4,
+  ALERT_EV_BATTERY = 5
+};
+
+enum AlertSeverity : uint8_t {
+  ALERT_SEV_INFO     = 1,
+  ALERT_SEV_WARNING  = 2,
+  ALERT_SEV_CRITICAL = 3
+};
+
+struct AlertEvent {
+  uint32_t id       = 0;
+  uint8_t  type     = 0;
+  uint8_t  severity = 0;
+  uint32_t t        = 0;
+  int32_t  lat7     = 0, lng7 = 0;
+  uint16_t fixAgeS  = ALERT_NO_FIX;
+  uint8_t  sats     = 0;
+};
+
+inline bool operator==(const AlertEvent& a, const AlertEvent& b) {
+  return a.id == b.id && a.type == b.type && a.severity == b.severity && a.t == b.t &&
+         a.lat7 == b.lat7 && a.lng7 == b.lng7 && a.fixAgeS == b.fixAgeS && a.sats == b.sats;
+}
+
+inline void alertPack(uint8_t* p, const AlertEvent& e) {
+  syncPut32(p, e.id);
+  p[4] = (uint8_t)((e.type & 0x0F) | e.severity << 4);
+  syncPut32(p + 5, e.t);
+  syncPut32(p + 9, (uint32_t)e.lat7);
+  syncPut32(p + 13, (uint32_t)e.lng7);
+  syncPut16(p + 17, e.fixAgeS);
+  p[19] = e.sats;
+}
+
+inline void alertUnpack(const uint8_t* p, AlertEvent& e) {
+  e.id       = syncGet32(p);
+  e.type     = p[4] & 0x0F;
+  e.severity = p[4] >> 4;
+  e.t        = syncGet32(p + 5);
+  e.lat7     = (int32_t)syncGet32(p + 9);
+  e.lng7     = (int32_t)syncGet32(p + 13);
+  e.fixAgeS  = syncGet16(p + 17);
+  e.sats     = p[19];
+}
+
+// ── Link ─────────────────────────────────────────────────────
+struct AlertChannel {
+  // One indication; false = can't now (not subscribed, stack busy)
+  bool (*indicate)(const uint8_t* p, uint16_t n);
+};
+
+// ── Watch side ───────────────────────────────────────────────
+class AlertLink {
+public:
+  // Counters since boot
+  uint32_t raised     = 0;
+  uint32_t recovered  = 0;      // waiting in flash at begin()
+  uint32_t sent       = 0;      // indications, resends included
+  uint32_t resent     = 0;
+  uint32_t confirmed  = 0;
+  uint32_t timeouts   = 0;      // no confirmation within ALERT_ACK_MS
+  uint32_t linkDrops  = 0;      // link went with one in flight
+  uint32_t dropped    = 0;      // given up: ALERT_WAITING full
+  uint32_t flashFails = 0;      // held in RAM only
+  uint32_t erases     = 0;
+  uint32_t tornSlots  = 0;      // failed their CRC at begin()
+
+  // Raise to confirmation, alerts raised since boot, ms
+  uint32_t latCount = 0, latLastMs = 0, latMaxMs = 0;
+  uint64_t latSumMs = 0;
+  uint32_t latHist[ALERT_LAT_BUCKETS] = {};
+
+  AlertLink(const AlertChannel& ch, uint32_t (*nowMs)()) : ch_(ch), nowMs_(nowMs) {}
+
+  // Read the partition back; false (and RAM only) without one
+  bool begin(const HistFlash& f) {
+    f_ = f;
+    n_ = (uint16_t)(f.size / HIST_SECTOR);
+    if (n_ > ALERT_SECTORS_MAX) n_ = ALERT_SECTORS_MAX;
+    nWait_ = 0;
+    head_ = 0;
+    slot_ = 0;
+    nextId_ = 1;
+    inFlight_ = false;
+    if (n_ < 2 || !f.read || !f.write || !f.erase) { n_ = 0; return false; }
+
+    // Pass 1: each sector's newest id and first free slot
+    uint32_t newest[ALERT_SECTORS_MAX];
+    uint16_t used[ALERT_SECTORS_MAX];
+    bool     any[ALERT_SECTORS_MAX];
+    uint8_t  order[ALERT_SECTORS_MAX], nOrder = 0;
+    for (uint16_t s = 0; s < n_; s++) {
+      newest[s] = 0; used[s] = 0; any[s] = false;
+      for (uint16_t k = 0; k < ALERT_SLOTS; k++) {
+        uint8_t b[ALERT_SLOT];
+        AlertEvent e;
+        int8_t st = readSlot(s, k, b, e);
+        if (st == SLOT_BLANK) continue;
+        used[s] = k + 1;
+        if (st == SLOT_TORN) continue;
+        if (!any[s] || e.id > newest[s]) newest[s] = e.id;
+        any[s] = true;
+      }
+      if (!any[s]) continue;
+      uint8_t i = nOrder++;
+      while (i && newest[order[i - 1]] > newest[s]) { order[i] = order[i - 1]; i--; }
+      order[i] = (uint8_t)s;
+    }
+
+    // Pass 2: replay oldest sector first; the last word on an id wins
+    for (uint8_t i = 0; i < nOrder; i++) {
+      uint16_t s = order[i];
+      for (uint16_t k = 0; k < used[s]; k++) {
+        uint8_t b[ALERT_SLOT];
+        AlertEvent e;
+        int8_t st = readSlot(s, k, b, e);
+        if (st == SLOT_TORN) tornSlots++;
+        if (st != SLOT_OK) continue;
+        int8_t w = find(e.id);
+        if (b[1] != 0xFF) {
+          if (w >= 0) remove((uint8_t)w);
+          continue;
+        }
+        if (w < 0) {
+          if (nWait_ == ALERT_WAITING) remove(0);
+          w = (int8_t)nWait_++;
+        }
+        wait_[w] = { e, slotOff(s, k), 0, false };
+      }
+    }
+    // Copies land ahead of newer alerts: back into id order
+    for (uint8_t i = 1; i < nWait_; i++) {
+      Held h = wait_[i];
+      uint8_t j = i;
+      while (j && wait_[j - 1].e.id > h.e.id) { wait_[j] = wait_[j - 1]; j--; }
+      wait_[j] = h;
+    }
+
+    if (nOrder) {
+      head_   = order[nOrder - 1];
+      nextId_ = newest[head_] + 1;
+    }
+    slot_ = used[head_];
+    recovered = nWait_;
+    return true;
+  }
+
+  // Core 1, where the alert is decided. Fills in e.id; the alert
+  // is in flash (or held in RAM if that failed) when this returns.
+  uint32_t raise(AlertEvent e) {
+    e.id = nextId_++;
+    if (nWait_ == ALERT_WAITING) giveUp();
+    Held& h = wait_[nWait_++];
+    h = { e, ALERT_NOT_STORED, nowMs_(), true };
+    store(h);
+    raised++;
+    return e.id;
+  }
+
+  // From the BLE stack's task
+  void onConfirm()    { __atomic_add_fetch(&confirms_, 1, __ATOMIC_RELEASE); }
+  void onConnect()    { __atomic_store_n(&up_, true, __ATOMIC_RELEASE); }
+  void onDisconnect() {
+    __atomic_store_n(&up_, false, __ATOMIC_RELEASE);
+    __atomic_add_fetch(&drops_, 1, __ATOMIC_RELEASE);
+  }
+
+  // From a scheduler task: take a confirmation, then send the
+  // oldest waiting alert if nothing is in flight
+  void run() {
+    uint32_t now = nowMs_();
+    uint32_t drops = __atomic_load_n(&drops_, __ATOMIC_ACQUIRE);
+    uint32_t confirms = __atomic_load_n(&confirms_, __ATOMIC_ACQUIRE);
+    if (drops != seenDrops_) {
+      seenDrops_ = drops;
+      seenConfirms_ = confirms;           // any from the old link are stale
+      if (inFlight_) linkDrops++;
+      inFlight_ = false;
+    }
+    if (confirms != seenConfirms_) {
+      seenConfirms_ = confirms;
+      if (inFlight_ && nWait_ && wait_[0].e.id == flightId_) done(now);
+      inFlight_ = false;
+    }
+    if (inFlight_ && now - sentMs_ >= ALERT_ACK_MS) {
+      timeouts++;
+      inFlight_ = false;
+    }
+    if (inFlight_ || !nWait_ || !__atomic_load_n(&up_, __ATOMIC_ACQUIRE)) return;
+
+    uint8_t p[ALERT_EVENT_BYTES];
+    alertPack(p, wait_[0].e);
+    if (!ch_.indicate(p, ALERT_EVENT_BYTES)) return;
+    if (wait_[0].tries++) resent++;
+    sent++;
+    inFlight_ = true;
+    flightId_ = wait_[0].e.id;
+    sentMs_   = now;
+  }
+
+  uint8_t  waiting() const  { return nWait_; }
+  bool     inFlight() const { return inFlight_; }
+  bool     stored() const   { return n_ != 0; }
+  uint32_t latMeanMs() const { return latCount ? (uint32_t)(latSumMs / latCount) : 0; }
+  const AlertEvent& oldest() const { return wait_[0].e; }
+
+private:
+  static const uint32_t ALERT_NOT_STORED = 0xFFFFFFFF;
+  enum { SLOT_BLANK = 0, SLOT_OK = 1, SLOT_TORN = -1 };
+
+  struct Held {
+    AlertEvent e;
+    uint32_t   off;          // slot in flash, ALERT_NOT_STORED if none
+    uint32_t   raisedMs;
+    bool       timed;        // raised this boot: latency counts
+    uint8_t    tries;
+  };
+
+  AlertChannel ch_;
+  uint32_t   (*nowMs_)();
+  HistFlash    f_ = {};
+  uint16_t     n_ = 0, head_ = 0, slot_ = 0;
+  uint32_t     nextId_ = 1;
+  Held         wait_[ALERT_WAITING];
+  uint8_t      nWait_ = 0;
+  bool         inFlight_ = false;
+  uint32_t     flightId_ = 0, sentMs_ = 0;
+  bool         up_ = false;                   // written by the BLE task
+  uint32_t     confirms_ = 0, drops_ = 0;     // likewise
+  uint32_t     seenConfirms_ = 0, seenDrops_ = 0;
+
+  uint32_t slotOff(uint16_t s, uint16_t k) const { return (uint32_t)s * HIST_SECTOR + (uint32_t)k * ALERT_SLOT; }
+
+  static uint16_t slotCrc(const uint8_t* b) {
+    return histCrc16(histCrc16(0xFFFF, b, 1), b + 2, ALERT_EVENT_BYTES);
+  }
+
+  int8_t readSlot(uint16_t s, uint16_t k, uint8_t* b, AlertEvent& e) {
+    if (!f_.read(slotOff(s, k), b, ALERT_SLOT)) return SLOT_TORN;
+    bool blank = true;
+    for (uint8_t i = 0; i < ALERT_SLOT && blank; i++) blank = b[i] == 0xFF;
+    if (blank) return SLOT_BLANK;
+    if (b[0] != ALERT_MAGIC || slotCrc(b) != syncGet16(b + 22)) return SLOT_TORN;
+    alertUnpack(b + 2, e);
+    return SLOT_OK;
+  }
+
+  int8_t find(uint32_t id) const {
+    for (uint8_t i = 0; i < nWait_; i++) if (wait_[i].e.id == id) return (int8_t)i;
+    return -1;
+  }
+
+  void remove(uint8_t i) {
+    for (uint8_t j = i; j + 1 < nWait_; j++) wait_[j] = wait_[j + 1];
+    nWait_--;
+  }
+
+  // Into the next free slot, moving to a fresh sector when full
+  void store(Held& h) {
+    h.off = ALERT_NOT_STORED;
+    if (!n_) { flashFails++; return; }
+    if (slot_ >= ALERT_SLOTS && !advance(&h)) { flashFails++; return; }
+    uint8_t b[ALERT_SLOT];
+    memset(b, 0xFF, sizeof b);
+    b[0] = ALERT_MAGIC;
+    alertPack(b + 2, h.e);
+    syncPut16(b + 22, slotCrc(b));
+    uint32_t off = slotOff(head_, slot_++);
+    if (f_.write(off, b, ALERT_SLOT)) h.off = off;
+    else flashFails++;
+  }
+
+  // Erase the next sector and carry the waiting alerts into it,
+  // all but `next`, which the caller is storing
+  bool advance(const Held* next) {
+    head_ = (uint16_t)((head_ + 1) % n_);
+    slot_ = 0;
+    erases++;
+    if (!f_.erase(slotOff(head_, 0))) {
+      slot_ = ALERT_SLOTS;                 // try the one after, next time
+      return false;
+    }
+    for (uint8_t i = 0; i < nWait_; i++) if (&wait_[i] != next) store(wait_[i]);
+    return true;
+  }
+
+  void markAcked(const Held& h) {
+    if (h.off == ALERT_NOT_STORED) return;
+    const uint8_t zero = 0x00;
+    if (!f_.write(h.off + 1, &zero, 1)) flashFails++;
+  }
+
+  void done(uint32_t now) {
+    const Held& h = wait_[0];
+    if (h.timed) {
+      uint32_t ms = now - h.raisedMs;
+      latCount++;
+      latLastMs = ms;
+      latSumMs += ms;
+      if (ms > latMaxMs) latMaxMs = ms;
+      latHist[ms < 250 ? 0 : ms < 1000 ? 1 : ms < 5000 ? 2 : ms < 60000 ? 3 : 4]++;
+    }
+    markAcked(h);
+    confirmed++;
+    remove(0);
+  }
+
+  // Full: the oldest of the least severe goes, never the one in flight
+  void giveUp() {
+    uint8_t pick = 0xFF;
+    for (uint8_t i = 0; i < nWait_; i++) {
+      if (inFlight_ && i == 0) continue;
+      if (pick == 0xFF || wait_[i].e.severity < wait_[pick].e.severity) pick = i;
+    }
+    if (pick == 0xFF) pick = 0;
+    markAcked(wait_[pick]);
+    remove(pick);
+    dropped++;
+  }
+};
+
+// ── Phone side ───────────────────────────────────────────────
+// Reference receiver, as the app would implement it: decode, and
+// drop resends of an id already taken. Confirmation is the phone
+// stack's job and needs nothing here.
+class AlertReceiver {
+public:
+  uint32_t events = 0, dupes = 0, bad = 0;
+
+  // True for an alert not seen before
+  bool onIndication(const uint8_t* p, uint16_t n, AlertEvent& e) {
+    if (n < ALERT_EVENT_BYTES) { bad++; return false; }
+    alertUnpack(p, e);
+    for (uint8_t i = 0; i < ALERT_RX_SEEN; i++)
+      if (seen_[i] == e.id && e.id) { dupes++; return false; }
+    seen_[next_++ % ALERT_RX_SEEN] = e.id;
+    events++;
+    return true;
+  }
+
+private:
+  static const uint8_t ALERT_RX_SEEN = 32;
+  uint32_t seen_[ALERT_RX_SEEN] = {};
+  uint8_t  next_ = 0;
+};
+
+// ── Device flash ─────────────────────────────────────────────
+#ifdef ARDUINO
+#include <esp_partition.h>
+
+// A data partition named "alerts" (subtype 0x42) in
+// partitions.csv, e.g.   alerts, data, 0x42, , 8K
+inline const esp_partition_t*& alertPartition() {
+  static const esp_partition_t* part = nullptr;
+  return part;
+}
+
+inline bool alertFlashRead(uint32_t off, void* dst, uint32_t n) {
+  return esp_partition_read(alertPartition(), off, dst, n) == ESP_OK;
+}
+inline bool alertFlashWrite(uint32_t off, const void* src, uint32_t n) {
+  return esp_partition_write(alertPartition(), off, src, n) == ESP_OK;
+}
+inline bool alertFlashErase(uint32_t off) {
+  return esp_partition_erase_range(alertPartition(), off, HIST_SECTOR) == ESP_OK;
+}
+
+inline bool alertFlashBegin(HistFlash* out) {
+  const esp_partition_t*& part = alertPartition();
+  part = esp_partition_find_first(ESP_PARTITION_TYPE_DATA,
+                                  (esp_partition_subtype_t)0x42, "alerts");
+  if (!part) return false;
+  *out = { part->size - part->size % HIST_SECTOR, alertFlashRead, alertFlashWrite, alertFlashErase };
+  return true;
+}
+#endif
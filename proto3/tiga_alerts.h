@@ -0,0 +1,200 @@
+// ============================================================
+// tiga_alerts.h — non-blocking alert sequencer for TIGA v6a
+// ============================================================
+// Plays buzzer + vibration motor patterns from compact tables
+// without ever calling delay(). The old helpers (tone + delay)
+// froze sensor reads and buttons for up to a second — exactly
+// when a fall was happening.
+//
+// A pattern has two independent channels that play together:
+//   buzzer  steps of { freqHz, ms }   freqHz 0 = silence
+//   motor   steps of { on,     ms }   on 0/1
+//
+// Priority: a new pattern replaces the current one only if its
+// priority is equal or higher (SOS overrides a goal chime; a goal
+// chime during an SOS is dropped and counted in `rejected`).
+//
+// Usage:
+//   AlertSequencer alerts({ buzzerTone, motorDrive });
+//   alerts.play(ALERT_SOS, millis());
+//   alerts.update(millis());          // every ~10ms
+//
+// Outputs go through plain function pointers, so on a Linux host
+// they record edges against a virtual clock.
+// Host bench: host/bench_alerts.cpp
+// ============================================================
+
+#pragma once
+
+#include <stdint.h>
+
+struct AlertStep {
+  uint16_t value;     // buzzer: frequency Hz (0 = off) / motor: 1 = on
+  uint16_t ms;
+};
+
+struct AlertPattern {
+  const char*      name;
+  uint8_t          priority;   // higher wins
+  const AlertStep* buzzer;
+  uint8_t          buzzerLen;
+  const AlertStep* motor;
+  uint8_t          motorLen;
+};
+
+// ── Priorities ───────────────────────────────────────────────
+#define ALERT_PRIO_INFO    1   // worn / floor / boot confirmation
+#define ALERT_PRIO_GOAL    2
+#define ALERT_PRIO_WARN    3   // low battery, medium alerts
+#define ALERT_PRIO_FALL    4   // fall suspected — countdown starting
+#define ALERT_PRIO_HIGH    5   // fall confirmed, HR emergency
+#define ALERT_PRIO_SOS     6
+
+#define ALERT_LEN(a) ((uint8_t)(sizeof(a) / sizeof((a)[0])))
+
+// ── Buzzer tables ────────────────────────────────────────────
+// Three rising tones — celebratory
+static const AlertStep BUZ_GOAL[] = {
+  { 880, 100}, {0, 30}, {1047, 100}, {0, 30}, {1319, 200}, {0, 20}
+};
+
+// Urgent descending double-beep, three times
+static const AlertStep BUZ_FALL[] = {
+  {1500, 150}, {0, 30}, {800, 150}, {0, 30},
+  {1500, 150}, {0, 30}, {800, 150}, {0, 30},
+  {1500, 150}, {0, 30}, {800, 150}, {0, 30}
+};
+
+// SOS in morse: ... --- ...   dot 100, dash 300, gap 120, letter gap 360
+static const AlertStep BUZ_SOS[] = {
+  {1000, 100}, {0, 120}, {1000, 100}, {0, 120}, {1000, 100}, {0, 120},
+  {0, 360},
+  {1000, 300}, {0, 120}, {1000, 300}, {0, 120}, {1000, 300}, {0, 120},
+  {0, 360},
+  {1000, 100}, {0, 120}, {1000, 100}, {0, 120}, {1000, 100}, {0, 120}
+};
+
+// Two slow low beeps
+static const AlertStep BUZ_LOWBAT[] = {
+  {400, 400}, {0, 100}, {400, 400}, {0, 100}
+};
+
+// Short tone after the motor's triple buzz
+static const AlertStep BUZ_MEDIUM[] = {
+  {0, 640}, {1000, 200}
+};
+
+// ── Motor tables ─────────────────────────────────────────────
+// Single soft pulse — worn confirmation, goal nudge
+static const AlertStep MOT_GENTLE[] = { {1, 80} };
+
+// Three short pulses — attention getter
+static const AlertStep MOT_TRIPLE[] = {
+  {1, 80}, {0, 100}, {1, 80}, {0, 100}, {1, 80}, {0, 100}
+};
+
+// Double-tap like a heartbeat — for HR / fall pre-alerts
+static const AlertStep MOT_HEARTBEAT[] = {
+  {1, 60}, {0, 80}, {1, 60}
+};
+
+// Long continuous buzz — SOS / fall
+static const AlertStep MOT_LONG[] = { {1, 600} };
+
+// ── Patterns ─────────────────────────────────────────────────
+//                                      name         priority          buzzer                          motor
+static const AlertPattern ALERT_LOW    = {"low",     ALERT_PRIO_INFO, nullptr,    0,                  MOT_GENTLE,    ALERT_LEN(MOT_GENTLE)};
+static const AlertPattern ALERT_MEDIUM = {"medium",  ALERT_PRIO_WARN, BUZ_MEDIUM, ALERT_LEN(BUZ_MEDIUM), MOT_TRIPLE,    ALERT_LEN(MOT_TRIPLE)};
+static const AlertPattern ALERT_HIGH   = {"high",    ALERT_PRIO_HIGH, BUZ_FALL,   ALERT_LEN(BUZ_FALL),   MOT_LONG,      ALERT_LEN(MOT_LONG)};
+static const AlertPattern ALERT_GOAL   = {"goal",    ALERT_PRIO_GOAL, BUZ_GOAL,   ALERT_LEN(BUZ_GOAL),   MOT_TRIPLE,    ALERT_LEN(MOT_TRIPLE)};
+static const AlertPattern ALERT_SOS    = {"sos",     ALERT_PRIO_SOS,  BUZ_SOS,    ALERT_LEN(BUZ_SOS),    MOT_LONG,      ALERT_LEN(MOT_LONG)};
+static const AlertPattern ALERT_LOWBAT = {"lowbat",  ALERT_PRIO_WARN, BUZ_LOWBAT, ALERT_LEN(BUZ_LOWBAT), MOT_GENTLE,    ALERT_LEN(MOT_GENTLE)};
+static const AlertPattern ALERT_FALL   = {"fall",    ALERT_PRIO_FALL, nullptr,    0,                  MOT_HEARTBEAT, ALERT_LEN(MOT_HEARTBEAT)};
+
+// ── Outputs ──────────────────────────────────────────────────
+struct AlertOutput {
+  void (*tone)(uint16_t hz);     // 0 = silence
+  void (*motor)(bool on);
+};
+
+// ── Sequencer ────────────────────────────────────────────────
+class AlertSequencer {
+public:
+  explicit AlertSequencer(const AlertOutput& out)
+    : played(0), preempted(0), rejected(0), out_(out), cur_(nullptr) {}
+
+  // Start a pattern. Returns false if something more urgent is playing.
+  bool play(const AlertPattern& p, uint32_t nowMs) {
+    if (cur_) {
+      if (p.priority < cur_->priority) { rejected++; return false; }
+      preempted++;
+    }
+    cur_ = &p;
+    played++;
+    startChannel(buz_, p.buzzer, p.buzzerLen, nowMs);
+    startChannel(mot_, p.motor,  p.motorLen,  nowMs);
+    applyBuzzer();
+    applyMotor();
+    return true;
+  }
+
+  // Advance both channels. Call at least every 10ms.
+  void update(uint32_t nowMs) {
+    if (!cur_) return;
+    if (advance(buz_, nowMs)) applyBuzzer();
+    if (advance(mot_, nowMs)) applyMotor();
+    if (buz_.done && mot_.done) cur_ = nullptr;
+  }
+
+  void stop() {
+    cur_ = nullptr;
+    buz_.done = mot_.done = true;
+    out_.tone(0);
+    out_.motor(false);
+  }
+
+  bool                busy()    const { return cur_ != nullptr; }
+  const AlertPattern* current() const { return cur_; }
+
+  // Counters
+  uint32_t played;
+  uint32_t preempted;
+  uint32_t rejected;
+
+private:
+  struct Channel {
+    const AlertStep* steps;
+    uint8_t          len;
+    uint8_t          idx;
+    uint32_t         stepStartMs;
+    bool             done;
+  };
+
+  AlertOutput         out_;
+  const AlertPattern* cur_;
+  Channel             buz_ = {nullptr, 0, 0, 0, true};
+  Channel             mot_ = {nullptr, 0, 0, 0, true};
+
+  static void startChannel(Channel& c, const AlertStep* s, uint8_t len, uint32_t now) {
+    c.steps = s; c.len = len; c.idx = 0;
+    c.stepStartMs = now;
+    c.done = (s == nullptr || len == 0);
+  }
+
+  // Returns true when the channel's output level changed step
+  static bool advance(Channel& c, uint32_t now) {
+    if (c.done) return false;
+    bool moved = false;
+    // Step boundaries are measured from the previous boundary, not
+    // from `now`, so late updates never stretch the pattern.
+    while (!c.done && now - c.stepStartMs >= c.steps[c.idx].ms) {
+      c.stepStartMs += c.steps[c.idx].ms;
+      if (++c.idx >= c.len) c.done = true;
+      moved = true;
+    }
+    return moved;
+  }
+
+  void applyBuzzer() { out_.tone(buz_.done ? 0 : buz_.steps[buz_.idx].value); }
+  void applyMotor()  { out_.motor(!mot_.done && mot_.steps[mot_.idx].value != 0); }
+};
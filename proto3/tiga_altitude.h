@@ -0,0 +1,346 @@
+// ============================================================
+// tiga_altitude.h — barometric–inertial altitude for TIGA v6a
+// ============================================================
+// Turns BMP280 pressure and the fused vertical acceleration into
+// altitude climbed on foot, and counts floors up and down.
+//
+//   accel()     every IMU sample, O(1): vertical accel into a sum
+//   step()      each step the step stage counts
+//   pressure()  each BMP280 reading (10 Hz): convert, filter,
+//               look for stairs. Returns floors counted, ±
+//
+// ── Pressure → altitude ──────────────────────────────────────
+// The barometric formula is a powf per reading. Here it is a
+// table of altitude (mm) every 1024 Pa from 30 to 110 kPa, built
+// once, and a linear step between two entries in integers:
+// within 12 cm of the formula below 1000 m, and its slope within
+// 0.5%, so a 3 m floor reads 3 m ± 2 cm.
+//
+// ── Filter ───────────────────────────────────────────────────
+// A three-state Kalman filter per reading: altitude h, vertical
+// speed v, and the accelerometer's vertical offset b. The mean
+// vertical accel since the last reading (less b) drives h and v;
+// the baro altitude corrects them. The accelerometer carries the
+// short term, so arm movement and pressure noise don't swing v,
+// and the barometer the long term, which also pins b. So the
+// BMP280's own IIR filter is off: it only adds lag.
+//
+// A reading more than ALT_JUMP_M from the prediction is a
+// pressure step nobody climbed — a door, a car's ventilation, a
+// gust on the sensor port: even a lift moves 15 cm a reading,
+// and the accelerometer sees it start. The step goes into the
+// baseline instead of h, and comes out again when it reverses.
+//
+// ── Stairs ───────────────────────────────────────────────────
+// The climb rate is v smoothed over ALT_RATE_TAU_S (walking
+// bounce averages out) less the weather drift. A stair segment
+// starts when the wearer is stepping and that rate is over
+// ALT_CLIMB_ON, and ends ALT_END_MS after steps stop or the rate
+// falls under ALT_CLIMB_OFF. Only segments move the altitude,
+// from h where the rate was last level to h at the last reading
+// with steps — stepping into a lift off the stairs doesn't carry
+// the lift's climb with it. A floor is counted each
+// time that altitude gets ALT_FLOOR_COUNT_M from the last count,
+// up or down, and no sooner than ALT_FLOOR_MIN_MS after it — a
+// flight of stairs takes longer than a door slam. A segment that
+// ends within half of that of the last count ends on that floor's
+// landing, and moves the count's mark there: counting from the
+// landing, not from 85% of the way up, keeps floors on the grid
+// going back down.
+//
+// So a lift, a car or the weather moves the barometer but not
+// the altitude: nobody climbed. offsetM() is the difference.
+//
+// ── Drift ────────────────────────────────────────────────────
+// Weather moves pressure by up to ~25 m an hour. Over each
+// ALT_DRIFT_BLOCK_S outside a segment, h's change is a drift
+// sample if it is under ALT_DRIFT_MAX (a lift is far faster);
+// driftMps follows those samples and is taken off the climb rate
+// and off each segment's altitude, so a slow climb in bad
+// weather is measured against the weather, not against zero.
+//
+// Memory: 320 B of table, 160 B of state, no heap. Floats in the
+// filter only (10 Hz). Accuracy and cost on synthetic stair,
+// lift, weather and slope traces: host/bench_altitude.cpp.
+// ============================================================
+
+#pragma once
+
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+#include "tiga_motion.h"
+
+// ── Config ───────────────────────────────────────────────────
+#define ALT_P_MIN_PA        30000     // table start
+#define ALT_P_SHIFT         10        // 1024 Pa between entries
+#define ALT_TABLE           80        // to 30000 + 79 × 1024 = 110896 Pa
+#define ALT_SEA_LEVEL_PA    101325.0f
+#define ALT_BARO_SIGMA_M    0.15f     // reading noise, wrist height included
+#define ALT_ACCEL_SIGMA     0.5f      // m/s², error of the mean vertical accel
+#define ALT_BIAS_WALK       0.002f    // m/s² per √s, accel offset wander
+#define ALT_GAP_MS          2000      // longer without a reading: start again
+#define ALT_JUMP_M          1.0f      // innovation larger: a pressure step, not height
+#define ALT_RATE_TAU_S      2.0f      // climb rate smoothing
+#define ALT_STEP_GAP_MS     1500      // steps further apart: not stepping (40/min)
+#define ALT_CLIMB_ON        0.06f     // m/s: a slow stair climb is ~0.1
+#define ALT_CLIMB_OFF       0.03f
+#define ALT_END_MS          3000      // not climbing this long ends a segment
+#define ALT_FLOOR_COUNT_M   2.55f     // 0.85 × 3 m: low ceilings still count
+#define ALT_FLOOR_MIN_MS    4000      // between counted floors
+#define ALT_DRIFT_BLOCK_S   30
+#define ALT_DRIFT_MAX       0.01f     // m/s, 36 m/h: faster is not weather
+#define ALT_DRIFT_K         4         // drift follows a new sample by 1/4
+
+static_assert(ALT_P_MIN_PA + ((ALT_TABLE - 1) << ALT_P_SHIFT) >= 110000,
+              "table must reach the BMP280 check's 110 kPa");
+
+class AltitudeEngine {
+public:
+  // Counters
+  uint32_t readings;        // pressure() calls that were used
+  uint32_t reseeds;         // filter restarted after a gap
+  uint32_t jumps;           // pressure steps taken into the baseline
+  uint32_t segments;        // stair segments seen
+  uint32_t driftSamples;    // blocks taken as weather
+  int16_t  floorsUp;
+  int16_t  floorsDown;
+  bool     seeded;          // a baseline is set
+
+  AltitudeEngine() {
+    for (int i = 0; i < ALT_TABLE; i++) {
+      float p = (float)(ALT_P_MIN_PA + (i << ALT_P_SHIFT));
+      table_[i] = (int32_t)lroundf(44330000.0f * (1.0f - powf(p / ALT_SEA_LEVEL_PA, 0.1903f)));
+    }
+    driftMps_ = 0;
+    reset();
+  }
+
+  // New session: the next reading is the baseline. The weather
+  // estimate is kept — the weather hasn't changed.
+  void reset() {
+    readings = reseeds = jumps = segments = driftSamples = 0;
+    floorsUp = floorsDown = 0;
+    seeded = false;
+    sumVert_ = 0;
+    nVert_ = 0;
+    lastStepMs_ = 0;
+    stepped_ = false;
+    climbedM_ = markM_ = 0;
+    inSeg_ = false;
+    memset(x_, 0, sizeof(x_));
+    rate_ = 0;
+  }
+
+  // Altitude in mm for pressure in Pa × 16, from the table
+  int32_t baroMm(int32_t pa16) const {
+    int32_t off = pa16 - (ALT_P_MIN_PA << 4);
+    int32_t top = (ALT_TABLE - 1) << (ALT_P_SHIFT + 4);
+    if (off < 0) off = 0;
+    if (off >= top) off = top - 1;
+    int32_t i = off >> (ALT_P_SHIFT + 4);
+    int32_t f = off & ((1 << (ALT_P_SHIFT + 4)) - 1);
+    return table_[i] + (int32_t)(((int64_t)(table_[i + 1] - table_[i]) * f) >> (ALT_P_SHIFT + 4));
+  }
+
+  // Vertical acceleration, counts along gravity less 1g
+  void accel(int16_t vert) {
+    sumVert_ += vert;
+    nVert_++;
+  }
+
+  void step(uint32_t tMs) {
+    lastStepMs_ = tMs;
+    stepped_ = true;
+  }
+
+  // One reading. Returns +n for floors up, -n for floors down.
+  int8_t pressure(float pa, uint32_t tMs) {
+    int32_t mm = baroMm((int32_t)lroundf(pa * 16));
+    if (!seeded) {
+      baseMm_ = mm;
+      seed(0, tMs);
+      seeded = true;
+      readings++;
+      return 0;
+    }
+    float z = (mm - baseMm_) / 1000.0f;
+    uint32_t dtMs = tMs - lastMs_;
+    if (dtMs > ALT_GAP_MS) {                 // sensor was away: carry on from here
+      endSegment();
+      seed(z, tMs);
+      reseeds++;
+      readings++;
+      return 0;
+    }
+    if (dtMs == 0) return 0;
+    float dt = dtMs / 1000.0f;
+    lastMs_ = tMs;
+    readings++;
+
+    float a = nVert_ ? (float)sumVert_ / nVert_ * (9.80665f / MOTION_LSB_PER_G) : 0;
+    sumVert_ = 0;
+    nVert_ = 0;
+    predict(dt, a);
+    float y = z - x_[0];
+    if (y > ALT_JUMP_M || y < -ALT_JUMP_M) {
+      baseMm_ += (int32_t)lroundf(y * 1000);
+      jumps++;
+    } else {
+      correct(y);
+    }
+
+    rate_ += (x_[1] - rate_) * (dt / (ALT_RATE_TAU_S + dt));
+    float climb = rate_ - driftMps_;
+    bool stepping = stepped_ && tMs - lastStepMs_ < ALT_STEP_GAP_MS;
+    return stairs(tMs, climb, stepping);
+  }
+
+  // Climbed altitude since the baseline, m
+  float altitudeM() const { return climbedM_ + (inSeg_ ? segM() : 0); }
+  // Filtered baro altitude since the baseline, m
+  float baroM() const { return x_[0]; }
+  // What moved the barometer but wasn't climbed: weather, lifts
+  float offsetM() const { return x_[0] - altitudeM(); }
+  float climbMps() const { return rate_ - driftMps_; }
+  float driftMph() const { return driftMps_ * 3600; }
+  float baseM() const { return baseMm_ / 1000.0f; }
+  bool  climbing() const { return inSeg_; }
+
+private:
+  int32_t  table_[ALT_TABLE];   // mm at ALT_P_MIN_PA + i × 1024
+  int32_t  baseMm_;
+  float    x_[3];               // h m, v m/s, accel offset m/s²
+  float    P_[3][3];
+  float    rate_;               // smoothed v
+  float    driftMps_;
+  int32_t  sumVert_;
+  uint16_t nVert_;
+  uint32_t lastMs_;
+  uint32_t lastStepMs_;
+  bool     stepped_;
+  // Stairs
+  bool     inSeg_;
+  uint32_t segT0_;
+  float    segH0_;              // h where the segment began
+  float    segH1_;              // h at its last reading with steps...
+  uint32_t segT1_;              // ...and when
+  float    levelH_;             // h while the rate was last level
+  bool     quiet_;              // stepping and climbing stopped...
+  uint32_t quietT0_;            // ...at this time
+  float    climbedM_;           // committed segments
+  float    markM_;              // altitude at the last floor counted
+  uint32_t markMs_;
+  // Drift
+  uint32_t blockT0_;
+  float    blockH0_;
+  bool     blockLevel_;
+
+  void seed(float z, uint32_t tMs) {
+    x_[0] = z; x_[1] = 0; x_[2] = 0;
+    memset(P_, 0, sizeof(P_));
+    P_[0][0] = ALT_BARO_SIGMA_M * ALT_BARO_SIGMA_M;
+    P_[1][1] = 0.1f;
+    P_[2][2] = 0.05f;
+    rate_ = 0;
+    lastMs_ = tMs;
+    sumVert_ = 0;
+    nVert_ = 0;
+    inSeg_ = false;
+    levelH_ = z;
+    quiet_ = false;
+    markMs_ = tMs - ALT_FLOOR_MIN_MS;
+    blockT0_ = tMs;
+    blockH0_ = z;
+    blockLevel_ = true;
+  }
+
+  // x = F x + G (a - b);  P = F P Fᵀ + Q
+  void predict(float dt, float a) {
+    float u = a - x_[2], dt2 = dt * dt / 2;
+    x_[0] += x_[1] * dt + u * dt2;
+    x_[1] += u * dt;
+
+    const float F[3][3] = { { 1, dt, -dt2 }, { 0, 1, -dt }, { 0, 0, 1 } };
+    float FP[3][3];
+    for (int i = 0; i < 3; i++)
+      for (int j = 0; j < 3; j++)
+        FP[i][j] = F[i][0] * P_[0][j] + F[i][1] * P_[1][j] + F[i][2] * P_[2][j];
+    for (int i = 0; i < 3; i++)
+      for (int j = 0; j < 3; j++)
+        P_[i][j] = FP[i][0] * F[j][0] + FP[i][1] * F[j][1] + FP[i][2] * F[j][2];
+
+    const float qa = ALT_ACCEL_SIGMA * ALT_ACCEL_SIGMA, g[2] = { dt2, dt };
+    for (int i = 0; i < 2; i++)
+      for (int j = 0; j < 2; j++) P_[i][j] += qa * g[i] * g[j];
+    P_[2][2] += ALT_BIAS_WALK * ALT_BIAS_WALK * dt;
+  }
+
+  // Baro altitude measures h alone; y is its innovation
+  void correct(float y) {
+    float s = P_[0][0] + ALT_BARO_SIGMA_M * ALT_BARO_SIGMA_M;
+    float k[3] = { P_[0][0] / s, P_[1][0] / s, P_[2][0] / s };
+    for (int i = 0; i < 3; i++) x_[i] += k[i] * y;
+    float row[3] = { P_[0][0], P_[0][1], P_[0][2] };
+    for (int i = 0; i < 3; i++)
+      for (int j = 0; j < 3; j++) P_[i][j] -= k[i] * row[j];
+  }
+
+  float segM() const {
+    return segH1_ - segH0_ - driftMps_ * ((segT1_ - segT0_) / 1000.0f);
+  }
+
+  void endSegment() {
+    if (!inSeg_) return;
+    climbedM_ += segM();
+    inSeg_ = false;
+    float d = climbedM_ - markM_;
+    if (d < ALT_FLOOR_COUNT_M / 2 && d > -ALT_FLOOR_COUNT_M / 2) markM_ = climbedM_;
+    levelH_ = x_[0];
+  }
+
+  int8_t stairs(uint32_t tMs, float climb, bool stepping) {
+    float mag = climb < 0 ? -climb : climb;
+    if (!inSeg_) {
+      if (mag < ALT_CLIMB_OFF) levelH_ = x_[0];
+      if (stepping && mag > ALT_CLIMB_ON) {
+        inSeg_ = true;
+        segments++;
+        segT0_ = tMs;
+        segH0_ = levelH_;
+        segH1_ = x_[0];
+        segT1_ = tMs;
+        quiet_ = false;
+        blockLevel_ = false;
+      }
+    } else {
+      if (stepping) { segH1_ = x_[0]; segT1_ = tMs; }
+      if (stepping && mag > ALT_CLIMB_OFF) quiet_ = false;
+      else if (!quiet_) { quiet_ = true; quietT0_ = tMs; }
+      if (quiet_ && tMs - quietT0_ >= ALT_END_MS) endSegment();
+    }
+    drift(tMs);
+
+    float alt = altitudeM();
+    int8_t n = 0;
+    if (tMs - markMs_ >= ALT_FLOOR_MIN_MS) {
+      if (alt - markM_ >= ALT_FLOOR_COUNT_M)       { floorsUp++;   n = 1; }
+      else if (markM_ - alt >= ALT_FLOOR_COUNT_M)  { floorsDown++; n = -1; }
+      if (n) { markM_ = alt; markMs_ = tMs; }
+    }
+    return n;
+  }
+
+  void drift(uint32_t tMs) {
+    if (inSeg_) blockLevel_ = false;
+    if (tMs - blockT0_ < ALT_DRIFT_BLOCK_S * 1000u) return;
+    float r = (x_[0] - blockH0_) / ((tMs - blockT0_) / 1000.0f);
+    if (blockLevel_ && r < ALT_DRIFT_MAX && r > -ALT_DRIFT_MAX) {
+      driftMps_ += (r - driftMps_) / ALT_DRIFT_K;
+      driftSamples++;
+    }
+    blockT0_ = tMs;
+    blockH0_ = x_[0];
+    blockLevel_ = !inSeg_;
+  }
+};
@@ -0,0 +1,428 @@
+// ============================================================
+// tiga_ble.h — BLE service for TIGA v6a
+// ============================================================
+// Drop this file into the same folder as tiga_main_v6a.ino
+// Then add  #include "tiga_ble.h"  after the data / daily / gpsData
+// globals in the .ino (bleNotify() reads them)
+// and call  bleSetup()  at the end of setup()
+// and call  bleNotify()  once per second in loop()
+//
+// Service UUID:   4fafc201-1fb5-459e-8fcc-c5c9c331914b  (TIGA custom)
+// Characteristic: beb54841-36e1-4688-b7f5-ea07361b26a8  (telemetry)
+//   Frames from tiga_telemetry.h: versioned, only the fields that
+//   changed, as varint deltas; a key frame once the phone has
+//   subscribed and once a minute. A quiet second sends nothing,
+//   and nothing is encoded while the phone isn't subscribed or the
+//   stack's buffers are full, so no frame the phone misses counts
+//   as sent.
+// Characteristic: beb54842-36e1-4688-b7f5-ea07361b26a8  (log)
+//   Event frames from tiga_log.h, one per notification, while
+//   subscribed and the stack has room; host/logcat decodes them.
+// Characteristic: beb54843-36e1-4688-b7f5-ea07361b26a8  (alerts)
+//   Indications from tiga_alert_link.h, one 20-byte event per
+//   fall, SOS or HR emergency, sent as soon as it is raised and
+//   again until the phone's stack confirms it. Sent past the
+//   Arduino wrapper, whose indicate() blocks for the confirmation;
+//   ESP_GATTS_CONF_EVT for the alert handle is the acknowledgement.
+//   The .ino owns the AlertLink and points bleAlerts at it.
+// Characteristic: beb5483e-36e1-4688-b7f5-ea07361b26a8  (TIGA data)
+//   The original fixed packet, kept while BLE_LEGACY_PACKET is 1
+//   because the v05 PWA reads it. Drop it once the app decodes
+//   telemetry frames.
+//
+// Legacy packet format — 20 bytes, little-endian:
+//   [0]    HR          uint8   bpm  (0 = no reading)
+//   [1]    SpO2        uint8   %    (0 = no reading)
+//   [2]    SpO2 valid  uint8   0|1
+//   [3-4]  Steps       uint16  count
+//   [5-6]  AltM x10   int16   e.g. 12.3m → 123
+//   [7]    Floors      uint8   count
+//   [8]    Battery     uint8   %
+//   [9]    Worn        uint8   0|1
+//   [10]   Falls       uint8   count this session
+//   [11]   Stable      uint8   0|1
+//   [12]   GPS fix     uint8   0|1
+//   [13]   GPS sats    uint8   count
+//   [14-15] Pressure x10 uint16  e.g. 1013.2 → 10132
+//   [16-19] Reserved   uint8 x4 (future use)
+//
+// Total: 20 bytes — fits in a single BLE notification (MTU 23).
+//
+// History sync service (tiga_sync.h — formats and flow there):
+//   Service:  4fafc202-1fb5-459e-8fcc-c5c9c331914b
+//   Control:  beb5483f-36e1-4688-b7f5-ea07361b26a8  write / write NR
+//   Data:     beb54840-36e1-4688-b7f5-ea07361b26a8  notify
+// The .ino owns the SyncSender and points bleSync at it before
+// bleSetup(). The ATT MTU asked for is SYNC_MTU_WANT; what the
+// phone agrees to sets the chunk size.
+//
+// Waveform stream service (tiga_stream.h — frames and pacing there):
+//   Service:  4fafc203-1fb5-459e-8fcc-c5c9c331914b
+//   Control:  beb54844-36e1-4688-b7f5-ea07361b26a8  write / write NR
+//   Data:     beb54845-36e1-4688-b7f5-ea07361b26a8  notify
+// Raw PPG / accel for clinician sessions, off until the phone
+// writes START. While on, the link is asked for 7.5-15 ms events,
+// 251-byte packets and the 2M PHY; STOP hands the interval back.
+// The .ino owns the StreamSender and points bleStream at it.
+// ============================================================
+
+#pragma once
+
+#include <BLEDevice.h>
+#include <BLEServer.h>
+#include <BLEUtils.h>
+#include <BLE2902.h>
+#include "tiga_sync.h"
+#include "tiga_telemetry.h"
+#include "tiga_alert_link.h"
+#include "tiga_stream.h"
+
+#ifndef BLE_LEGACY_PACKET
+#define BLE_LEGACY_PACKET 1
+#endif
+
+// ── UUIDs ────────────────────────────────────────────────────
+#define TIGA_SERVICE_UUID        "4fafc201-1fb5-459e-8fcc-c5c9c331914b"
+#define TIGA_DATA_CHAR_UUID      "beb5483e-36e1-4688-b7f5-ea07361b26a8"
+#define TIGA_TEL_CHAR_UUID       "beb54841-36e1-4688-b7f5-ea07361b26a8"
+#define TIGA_LOG_CHAR_UUID       "beb54842-36e1-4688-b7f5-ea07361b26a8"
+#define TIGA_ALERT_CHAR_UUID     "beb54843-36e1-4688-b7f5-ea07361b26a8"
+#define TIGA_SYNC_SERVICE_UUID   "4fafc202-1fb5-459e-8fcc-c5c9c331914b"
+#define TIGA_SYNC_CTL_UUID       "beb5483f-36e1-4688-b7f5-ea07361b26a8"
+#define TIGA_SYNC_DATA_UUID      "beb54840-36e1-4688-b7f5-ea07361b26a8"
+#define TIGA_STREAM_SERVICE_UUID "4fafc203-1fb5-459e-8fcc-c5c9c331914b"
+#define TIGA_STREAM_CTL_UUID     "beb54844-36e1-4688-b7f5-ea07361b26a8"
+#define TIGA_STREAM_DATA_UUID    "beb54845-36e1-4688-b7f5-ea07361b26a8"
+
+// Connection interval in 1.25 ms units: streaming, and the
+// phone-friendly default it goes back to
+#define BLE_FAST_INT_MIN   6      // 7.5 ms
+#define BLE_FAST_INT_MAX   12     // 15 ms
+#define BLE_SLOW_INT_MIN   24     // 30 ms
+#define BLE_SLOW_INT_MAX   48     // 60 ms
+#define BLE_SUPERVISION    400    // 4 s, 10 ms units
+
+// ── Globals ──────────────────────────────────────────────────
+BLEServer*         pServer        = nullptr;
+BLECharacteristic* pDataChar      = nullptr;
+BLECharacteristic* pTelChar       = nullptr;
+BLE2902*           pTelCccd       = nullptr;
+BLECharacteristic* pLogChar       = nullptr;
+BLECharacteristic* pAlertChar     = nullptr;
+BLE2902*           pAlertCccd     = nullptr;
+AlertLink*         bleAlerts      = nullptr;   // set by the .ino
+TelEncoder         bleTel;
+bool               bleTelKeyWanted = true;     // set on connect, taken by core 1
+bool               bleTelListening = false;    // core 1: subscribed at the last call
+bool               bleConnected   = false;
+bool               bleOldConnected = false;
+BLECharacteristic* pSyncData      = nullptr;
+SyncSender*        bleSync        = nullptr;   // set by the .ino
+volatile bool      bleCongested   = false;     // stack's TX buffers full
+BLECharacteristic* pStreamData    = nullptr;
+StreamSender*      bleStream      = nullptr;   // set by the .ino
+esp_bd_addr_t      blePeer        = {};        // for the GAP calls
+
+// ── Connection callbacks ──────────────────────────────────────
+class TIGAServerCallbacks : public BLEServerCallbacks {
+  void onConnect(BLEServer* pSvr) override {
+    bleConnected = true;
+    __atomic_store_n(&bleTelKeyWanted, true, __ATOMIC_RELEASE);
+    if (bleAlerts) bleAlerts->onConnect();
+    Serial.println("[BLE] Client connected");
+  }
+  void onConnect(BLEServer* pSvr, esp_ble_gatts_cb_param_t* param) override {
+    memcpy(blePeer, param->connect.remote_bda, sizeof(blePeer));
+  }
+  void onDisconnect(BLEServer* pSvr) override {
+    bleConnected = false;
+    bleCongested = false;
+    // The stack keeps the CCCD's last value; the next phone has to
+    // subscribe again before it gets frames
+    if (pTelCccd) pTelCccd->setNotifications(false);
+    if (bleSync) bleSync->disconnect();
+    if (bleStream) bleStream->disconnect();
+    if (bleAlerts) bleAlerts->onDisconnect();
+    Serial.println("[BLE] Client disconnected — restarting advertising");
+    // Restart advertising so phone can reconnect
+    BLEDevice::startAdvertising();
+  }
+};
+
+// What the phone agreed to at MTU exchange; 23 until it asks
+uint16_t blePeerMtu() {
+  return bleConnected ? pServer->getPeerMTU(pServer->getConnId()) : 23;
+}
+
+// ── History sync ──────────────────────────────────────────────
+// Runs in the BLE stack's task: queue only, SyncSender::run() does
+// the work
+class TIGASyncCallbacks : public BLECharacteristicCallbacks {
+  void onWrite(BLECharacteristic* pChar) override {
+    if (bleSync) bleSync->onControl(pChar->getData(), (uint16_t)pChar->getLength());
+  }
+};
+
+// The stack reports when its notification buffers fill and drain;
+// while full, send() says no and SyncSender holds the chunk. It
+// also reports every notification sent and every indication
+// confirmed, so only the alert handle's count.
+void bleGattsEvent(esp_gatts_cb_event_t event, esp_gatt_if_t, esp_ble_gatts_cb_param_t* param) {
+  if (event == ESP_GATTS_CONGEST_EVT) bleCongested = param->congest.congested;
+  if (event == ESP_GATTS_CONF_EVT && bleAlerts && pAlertChar &&
+      param->conf.handle == pAlertChar->getHandle() && param->conf.status == ESP_GATT_OK)
+    bleAlerts->onConfirm();
+}
+
+bool bleSyncSend(const uint8_t* p, uint16_t n) {
+  if (!bleConnected) return true;          // gone; the phone's START resumes
+  if (bleCongested)  return false;
+  pSyncData->setValue((uint8_t*)p, n);
+  pSyncData->notify();
+  return true;
+}
+
+// ── Waveform stream ───────────────────────────────────────────
+class TIGAStreamCallbacks : public BLECharacteristicCallbacks {
+  void onWrite(BLECharacteristic* pChar) override {
+    if (bleStream) bleStream->onControl(pChar->getData(), (uint16_t)pChar->getLength());
+  }
+};
+
+// StreamLink::send — a full stack holds the frame in StreamSender
+bool bleStreamSend(const uint8_t* p, uint16_t n) {
+  if (!bleConnected) return true;
+  if (bleCongested)  return false;
+  pStreamData->setValue((uint8_t*)p, n);
+  pStreamData->notify();
+  return true;
+}
+
+// StreamLink::fast — asks only; the phone may settle on less.
+// The 2M PHY needs a core built with the BLE 5 features.
+void bleStreamFast(bool on) {
+  if (!bleConnected) return;
+  esp_ble_conn_update_params_t cp = {};
+  memcpy(cp.bda, blePeer, sizeof(blePeer));
+  cp.min_int = on ? BLE_FAST_INT_MIN : BLE_SLOW_INT_MIN;
+  cp.max_int = on ? BLE_FAST_INT_MAX : BLE_SLOW_INT_MAX;
+  cp.latency = 0;
+  cp.timeout = BLE_SUPERVISION;
+  esp_ble_gap_update_conn_params(&cp);
+  if (!on) return;
+  esp_ble_gap_set_pkt_data_len(blePeer, 251);
+#ifdef CONFIG_BT_BLE_50_FEATURES_SUPPORTED
+  esp_ble_gap_set_preferred_phy(blePeer, 0, ESP_BLE_GAP_PHY_2M_PREF_MASK,
+                                ESP_BLE_GAP_PHY_2M_PREF_MASK, ESP_BLE_GAP_PHY_OPTIONS_NO_PREF);
+#endif
+}
+
+// ── Alerts ────────────────────────────────────────────────────
+// AlertChannel::indicate — the phone has to have subscribed; the
+// confirmation comes back through bleGattsEvent()
+bool bleAlertIndicate(const uint8_t* p, uint16_t n) {
+  if (!pAlertChar || !bleConnected || bleCongested || !pAlertCccd->getIndications()) return false;
+  pAlertChar->setValue((uint8_t*)p, n);
+  return esp_ble_gatts_send_indicate(pServer->getGattsIf(), pServer->getConnId(),
+                                     pAlertChar->getHandle(), n, (uint8_t*)p, true) == ESP_OK;
+}
+
+// ── Setup ─────────────────────────────────────────────────────
+void bleSetup() {
+  BLEDevice::init("TIGA-1");   // device name visible during BLE scan
+  BLEDevice::setMTU(SYNC_MTU_WANT);
+  BLEDevice::setCustomGattsHandler(bleGattsEvent);
+
+  pServer = BLEDevice::createServer();
+  pServer->setCallbacks(new TIGAServerCallbacks());
+
+  BLEService* pService = pServer->createService(TIGA_SERVICE_UUID);
+
+  // Data characteristic — notify only (device → phone)
+  pDataChar = pService->createCharacteristic(
+    TIGA_DATA_CHAR_UUID,
+    BLECharacteristic::PROPERTY_NOTIFY
+  );
+  // CCCD descriptor — required for BLE notify to work
+  pDataChar->addDescriptor(new BLE2902());
+
+  pTelChar = pService->createCharacteristic(
+    TIGA_TEL_CHAR_UUID,
+    BLECharacteristic::PROPERTY_NOTIFY
+  );
+  pTelCccd = new BLE2902();
+  pTelChar->addDescriptor(pTelCccd);
+
+  pLogChar = pService->createCharacteristic(
+    TIGA_LOG_CHAR_UUID,
+    BLECharacteristic::PROPERTY_NOTIFY
+  );
+  pLogChar->addDescriptor(new BLE2902());
+
+  pAlertChar = pService->createCharacteristic(
+    TIGA_ALERT_CHAR_UUID,
+    BLECharacteristic::PROPERTY_INDICATE
+  );
+  pAlertCccd = new BLE2902();
+  pAlertChar->addDescriptor(pAlertCccd);
+
+  pService->start();
+
+  // History sync — a second service so the live one stays 20 bytes
+  BLEService* pSync = pServer->createService(TIGA_SYNC_SERVICE_UUID);
+  BLECharacteristic* pSyncCtl = pSync->createCharacteristic(
+    TIGA_SYNC_CTL_UUID,
+    BLECharacteristic::PROPERTY_WRITE | BLECharacteristic::PROPERTY_WRITE_NR
+  );
+  pSyncCtl->setCallbacks(new TIGASyncCallbacks());
+  pSyncData = pSync->createCharacteristic(
+    TIGA_SYNC_DATA_UUID,
+    BLECharacteristic::PROPERTY_NOTIFY
+  );
+  pSyncData->addDescriptor(new BLE2902());
+  pSync->start();
+
+  // Waveform stream — its own service, silent until START
+  BLEService* pStream = pServer->createService(TIGA_STREAM_SERVICE_UUID);
+  BLECharacteristic* pStreamCtl = pStream->createCharacteristic(
+    TIGA_STREAM_CTL_UUID,
+    BLECharacteristic::PROPERTY_WRITE | BLECharacteristic::PROPERTY_WRITE_NR
+  );
+  pStreamCtl->setCallbacks(new TIGAStreamCallbacks());
+  pStreamData = pStream->createCharacteristic(
+    TIGA_STREAM_DATA_UUID,
+    BLECharacteristic::PROPERTY_NOTIFY
+  );
+  pStreamData->addDescriptor(new BLE2902());
+  pStream->start();
+
+  // Advertise
+  BLEAdvertising* pAdv = BLEDevice::getAdvertising();
+  pAdv->addServiceUUID(TIGA_SERVICE_UUID);
+  pAdv->setScanResponse(true);
+  pAdv->setMinPreferred(0x06);  // helps with iPhone connection
+  pAdv->setMinPreferred(0x12);
+  BLEDevice::startAdvertising();
+
+  Serial.println("[BLE] Advertising as TIGA-1");
+  Serial.println("[BLE] Service UUID: " TIGA_SERVICE_UUID);
+}
+
+// ── Log frames ────────────────────────────────────────────────
+// A LogSink (tiga_log.h), lossy: a frame that can't go now —
+// nobody connected, buffers full, MTU too small — is dropped
+uint16_t bleLogWrite(const uint8_t* p, uint16_t n) {
+  if (!pLogChar || !bleConnected || bleCongested) return 0;
+  if (n > blePeerMtu() - SYNC_ATT_HDR) return 0;
+  pLogChar->setValue((uint8_t*)p, n);
+  pLogChar->notify();
+  return n;
+}
+
+// ── Telemetry frame ───────────────────────────────────────────
+// Reads the data / daily / gpsData globals from tiga_main_v6a.ino;
+// sends nothing when no field moved past its deadband. Encodes
+// nothing the phone wouldn't get: not before it has subscribed
+// (it is still discovering services just after connect) and not
+// while the stack is full, where notify() would drop the frame
+// after encode() had counted it sent. A key frame goes out on the
+// first call after it subscribes or reconnects.
+void bleNotifyTelemetry() {
+  if (!pTelCccd || !pTelCccd->getNotifications()) { bleTelListening = false; return; }
+  if (bleCongested) return;
+  bool key = !bleTelListening;
+  bleTelListening = true;
+  if (__atomic_exchange_n(&bleTelKeyWanted, false, __ATOMIC_ACQ_REL)) key = true;
+
+  TelSnapshot s;
+  s.v[TEL_HR]       = constrain(lroundf(data.heartRate), 0, 255);
+  s.v[TEL_SPO2]     = constrain((int)data.spO2, 0, 100);
+  s.v[TEL_STEPS]    = data.steps;
+  s.v[TEL_ALT_DM]   = lroundf(data.altitudeM * 10);
+  s.v[TEL_FLOORS]   = data.floorsUp;
+  s.v[TEL_BATTERY]  = constrain(lroundf(data.battery), 0, 100);
+  s.v[TEL_FLAGS]    = (data.wearing    ? TEL_WORN       : 0) |
+                      (data.isStable   ? TEL_STABLE     : 0) |
+                      (data.spO2Valid  ? TEL_SPO2_VALID : 0) |
+                      (gpsData.hasFix  ? TEL_GPS_FIX    : 0);
+  s.v[TEL_FALLS]    = daily.fallCount;
+  s.v[TEL_GPS_SATS] = gpsData.satellites;
+  s.v[TEL_PRESSURE] = lroundf(data.pressureHPa * 10);
+  s.v[TEL_RMSSD]    = lroundf(data.rmssdMs);
+  s.v[TEL_SDNN]     = lroundf(data.sdnnMs);
+  s.v[TEL_PNN50]    = lroundf(data.pnn50);
+
+  uint16_t room = blePeerMtu() - SYNC_ATT_HDR;
+  uint8_t  frame[TEL_FRAME_MAX];
+  uint8_t  n = bleTel.encode(s, frame, room < TEL_FRAME_MAX ? room : TEL_FRAME_MAX, key);
+  if (!n) return;
+  pTelChar->setValue(frame, n);
+  pTelChar->notify();
+}
+
+// ── Legacy packet ─────────────────────────────────────────────
+// Reads from the global `data` struct defined in tiga_main_v6a.ino
+// and packs it into a 20-byte notification.
+void bleNotifyLegacy() {
+  uint8_t pkt[20] = {0};
+
+  // [0]  HR
+  pkt[0] = (uint8_t)constrain((int)data.heartRate, 0, 255);
+
+  // [1]  SpO2
+  pkt[1] = (uint8_t)constrain((int)data.spO2, 0, 100);
+
+  // [2]  SpO2 valid flag
+  pkt[2] = data.spO2Valid ? 1 : 0;
+
+  // [3-4] Steps (uint16 little-endian)
+  uint16_t steps = (uint16_t)constrain(data.steps, 0, 65535);
+  pkt[3] = steps & 0xFF;
+  pkt[4] = (steps >> 8) & 0xFF;
+
+  // [5-6] Altitude x10 as int16 (allows ±3276.7m range)
+  int16_t altX10 = (int16_t)constrain((int)(data.altitudeM * 10), -32768, 32767);
+  pkt[5] = altX10 & 0xFF;
+  pkt[6] = (altX10 >> 8) & 0xFF;
+
+  // [7]  Floors
+  pkt[7] = (uint8_t)constrain(data.floorsUp, 0, 255);
+
+  // [8]  Battery
+  pkt[8] = (uint8_t)constrain((int)data.battery, 0, 100);
+
+  // [9]  Worn
+  pkt[9] = data.wearing ? 1 : 0;
+
+  // [10] Falls this session
+  pkt[10] = (uint8_t)constrain(daily.fallCount, 0, 255);
+
+  // [11] Stable
+  pkt[11] = data.isStable ? 1 : 0;
+
+  // [12] GPS fix
+  pkt[12] = gpsData.hasFix ? 1 : 0;
+
+  // [13] GPS satellites
+  pkt[13] = (uint8_t)constrain(gpsData.satellites, 0, 255);
+
+  // [14-15] Pressure x10 as uint16 (e.g. 1013.2 → 10132)
+  uint16_t presX10 = (uint16_t)constrain((int)(data.pressureHPa * 10), 0, 65535);
+  pkt[14] = presX10 & 0xFF;
+  pkt[15] = (presX10 >> 8) & 0xFF;
+
+  // [16-19] Reserved — zero
+  pkt[16] = pkt[17] = pkt[18] = pkt[19] = 0;
+
+  pDataChar->setValue(pkt, 20);
+  pDataChar->notify();
+}
+
+// ── Notify — call once per second ────────────────────────────
+void bleNotify() {
+  if (!bleConnected) return;
+  bleNotifyTelemetry();
+#if BLE_LEGACY_PACKET
+  bleNotifyLegacy();
+#endif
+}
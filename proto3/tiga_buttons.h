@@ -0,0 +1,191 @@
+// ============================================================
+// tiga_buttons.h — button events from GPIO interrupts
+// ============================================================
+// readButtons() sampled both pins from the input task, so a press
+// was only seen when that task next ran — after a full redraw, an
+// alert pattern or a flash erase — and one shorter than the gap
+// was missed. The press it did see ran exportSession(),
+// resetSession() or goToSleep() there and then, each for seconds.
+// Each pin now interrupts on every edge; the ISR debounces it and
+// queues a timestamped press or release, and handleInput() takes
+// them, with long presses and chords worked out, in order.
+//
+// ── Debouncing (ISR) ─────────────────────────────────────────
+// The first edge that differs from the settled level is the
+// press or release, timestamped then: a contact that closes has
+// closed, however much it chatters after. Edges within
+// BTN_LOCKOUT_US of it are bounce and only counted. A real change
+// inside the lockout (a tap shorter than the lockout, or the
+// release edge lost in the chatter) leaves the last edge's level
+// different from the settled one with no edge to come; settle(),
+// from core 1, takes that level once it has held for the lockout,
+// timed at its edge; so does the ISR at the next edge on either
+// button, if that comes first, to keep the ring in time order.
+// settle() runs with interrupts masked, so the ring still has
+// one producer at a time.
+//
+// ── Events (core 1) ──────────────────────────────────────────
+//   BTN_PRESS     a button settles down
+//   BTN_RELEASE   settles up; `tap` unless it went long or chorded
+//   BTN_LONG      held BTN_LONG_US alone, timed at the threshold
+//   BTN_CHORD     the other button pressed while one is down;
+//                 neither goes long or taps until both are up
+// Each carries the microsecond it happened at. next() hands them
+// over oldest first — a long press before a release queued behind
+// it, if it was due first — and times press-to-handled: now minus
+// that stamp (latency, and its worst case, below).
+//
+// On the ESP32 the ISR runs on the core that attached it, so
+// attach from setup() on core 1, where settle() and next() run.
+// Non-IRAM interrupts are held off while flash is busy; the edge
+// is taken late, but its stamp is read in the ISR.
+//
+// Memory: ~300 bytes. Host bench: host/bench_buttons.cpp
+// ============================================================
+
+#pragma once
+
+#include <stdint.h>
+#include "tiga_cores.h"
+
+#ifndef IRAM_ATTR
+#define IRAM_ATTR
+#endif
+
+#define BTN_COUNT          2
+#define BTN_LOCKOUT_US     20000     // contact bounce is under ~10 ms
+#define BTN_LONG_US        3000000   // sleep and session reset
+#define BTN_QUEUE          32        // ≥ 0.3 s of both buttons mashed
+
+enum ButtonEventType : uint8_t { BTN_PRESS, BTN_RELEASE, BTN_LONG, BTN_CHORD };
+
+struct ButtonEvent {
+  uint32_t        us;         // micros() when it happened
+  ButtonEventType type;
+  uint8_t         button;     // 0 or 1; BTN_CHORD: the one pressed second
+  bool            tap;        // BTN_RELEASE only: a short press on its own
+};
+
+class ButtonInput {
+public:
+  // Counters since boot
+  uint32_t edges    = 0;      // ISR calls
+  uint32_t bounces  = 0;      // edges thrown away as chatter
+  uint32_t resyncs  = 0;      // changes settle() found the ISR missed
+  uint32_t events   = 0;      // handed to next()'s caller
+  uint32_t latMaxUs = 0;      // press-to-handled, worst
+  uint32_t latLastUs = 0;
+  uint64_t latSumUs = 0;
+
+  // ── ISR: every edge on button b, down = pin low ───────────
+  void IRAM_ATTR isr(uint8_t b, bool down, uint32_t us) {
+    edges++;
+    catchUp(us);                 // settle() hasn't run since
+    Pin& p = pin_[b];
+    p.raw   = down;
+    p.rawUs = us;
+    if (down == p.level || (p.locked && us - p.settledUs < BTN_LOCKOUT_US)) {
+      bounces++;
+      return;
+    }
+    accept(b, down, us);
+  }
+
+  // ── Core 1, interrupts masked ─────────────────────────────
+  // Picks up a level the lockout swallowed
+  void settle(uint32_t nowUs) {
+    for (Pin& p : pin_)
+      if (p.locked && nowUs - p.settledUs >= BTN_LOCKOUT_US) p.locked = false;
+    catchUp(nowUs);
+  }
+
+  // ── Core 1: the next event, or false ──────────────────────
+  bool next(uint32_t nowUs, ButtonEvent* e) {
+    const ButtonEvent* f = q_.front();
+    ButtonEvent r;
+    if (longFor(f ? f->us : nowUs, e)) {
+      // due before whatever comes next
+    } else if (q_.pop(r)) {
+      *e = gesture(r);
+    } else {
+      return false;
+    }
+    uint32_t lat = nowUs - e->us;
+    events++;
+    latLastUs = lat;
+    latSumUs += lat;
+    if (lat > latMaxUs) latMaxUs = lat;
+    return true;
+  }
+
+  // As core 1 has seen it: down, and since when
+  bool     isDown(uint8_t b) const    { return down_[b]; }
+  uint32_t changedUs(uint8_t b) const { return changedUs_[b]; }
+
+  uint32_t dropped() const  { return q_.dropped; }
+  uint32_t latMeanUs() const { return events ? (uint32_t)(latSumUs / events) : 0; }
+
+private:
+  struct Pin {
+    bool     level = false;    // settled
+    bool     locked = false;   // within BTN_LOCKOUT_US of settling
+    bool     raw = false;      // at the last edge
+    uint32_t settledUs = 0, rawUs = 0;
+  };
+  Pin pin_[BTN_COUNT];
+  SpscRing<ButtonEvent, BTN_QUEUE> q_;
+
+  bool     down_[BTN_COUNT] = {};
+  uint32_t changedUs_[BTN_COUNT] = {};
+  bool     longDone_[BTN_COUNT] = {};   // went long, or part of a chord
+  bool     chord_ = false;              // until both are up
+
+  // Levels the lockout swallowed that have held since
+  void IRAM_ATTR catchUp(uint32_t nowUs) {
+    for (uint8_t b = 0; b < BTN_COUNT; b++) {
+      Pin& p = pin_[b];
+      if (p.raw == p.level || nowUs - p.rawUs < BTN_LOCKOUT_US) continue;
+      resyncs++;
+      accept(b, p.raw, p.rawUs);
+    }
+  }
+
+  void IRAM_ATTR accept(uint8_t b, bool down, uint32_t us) {
+    Pin& p = pin_[b];
+    p.level     = down;
+    p.locked    = true;
+    p.settledUs = us;
+    q_.push({ us, down ? BTN_PRESS : BTN_RELEASE, b, false });
+  }
+
+  // A press or release from the ring, turned into what it means.
+  // A press that completes a chord is handed over as the chord.
+  ButtonEvent gesture(ButtonEvent e) {
+    uint8_t b = e.button, o = (uint8_t)(b ^ 1);
+    down_[b]      = e.type == BTN_PRESS;
+    changedUs_[b] = e.us;
+    if (e.type == BTN_PRESS) {
+      longDone_[b] = chord_;
+      if (down_[o] && !chord_) {
+        chord_ = true;
+        longDone_[0] = longDone_[1] = true;
+        e.type = BTN_CHORD;
+      }
+      return e;
+    }
+    e.tap = !longDone_[b];
+    if (!down_[o]) chord_ = false;
+    return e;
+  }
+
+  // A button held alone to BTN_LONG_US by `uptoUs`, once per press
+  bool longFor(uint32_t uptoUs, ButtonEvent* e) {
+    for (uint8_t b = 0; b < BTN_COUNT; b++) {
+      if (!down_[b] || longDone_[b] || (int32_t)(uptoUs - changedUs_[b]) < (int32_t)BTN_LONG_US) continue;
+      longDone_[b] = true;
+      *e = { changedUs_[b] + BTN_LONG_US, BTN_LONG, b, false };
+      return true;
+    }
+    return false;
+  }
+};
@@ -0,0 +1,452 @@
+// ============================================================
+// tiga_capture.h — raw sensor capture format + recorder
+// ============================================================
+// Records every raw sample the firmware sees so field issues can
+// be replayed offline. Until now the only data leaving the device
+// was Serial.printf text and the exportSession() report.
+//
+// ── File layout (all little-endian) ─────────────────────────
+//   File header, 16 bytes:
+//     [0-3]   magic     "TIGC"
+//     [4-5]   version   uint16  (CAP_VERSION)
+//     [6-7]   hdrSize   uint16  (16)
+//     [8-11]  startMs   uint32  millis() when recording began
+//     [12-15] reserved
+//
+//   Then a stream of records, each an 8-byte header + payload:
+//     [0]     sync      0xA7
+//     [1]     type      CAP_*
+//     [2]     len       payload bytes (0-255)
+//     [3]     crc8      over bytes [1..2], [4..7] and the payload
+//     [4-7]   tUs       uint32 micros() — reader unwraps at 2^32
+//
+//   The sync byte + CRC let a reader resync after corruption or
+//   past text from Serial.printf between records on the same port.
+//
+// ── Record payloads ──────────────────────────────────────────
+//   CAP_CONFIG  imuHz u16, ppgHz u16, accelLsbPerG u16, gyroLsbPerDps10 u16
+//   CAP_IMU     firstIdx u32, count u8, then count × {ax,ay,az,gx,gy,gz} int16
+//   CAP_PPG     firstIdx u32, lost u16, count u8, then count × {red,ir} 3 bytes each
+//   CAP_BARO    pressurePa×10 u32, tempC×100 int16
+//   CAP_GPS     lat×1e7 int32, lng×1e7 int32, speed cm/s u16, sats u8, fix u8
+//   CAP_BUTTON  button u8 (1|2), down u8 (1 = pressed)
+//
+// ── Recorder ─────────────────────────────────────────────────
+// Producers append into a RAM ring (never block). A drain task
+// pushes the ring to a sink — USB serial or a flash partition —
+// taking only what the sink will accept without blocking. If the
+// ring is full the record is dropped and counted.
+//
+// A sink with room() gets a record only once all of it fits, in
+// one write(), so another writer on the port can only land between
+// records. The serial port needs a TX buffer of CAP_SERIAL_TX_BYTES
+// for that (Serial.setTxBufferSize() before begin()); the UART's
+// 128-byte FIFO is smaller than the largest record.
+// Host bench: host/bench_capture.cpp
+//
+// ── Reader (Linux/macOS) ─────────────────────────────────────
+// CaptureReader memory-maps a capture and iterates records in
+// place: CapRecord.payload points straight into the mapping.
+// ============================================================
+
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+#include "tiga_imu_fifo.h"
+#include "tiga_ppg_fifo.h"
+
+#define CAP_VERSION      1
+#define CAP_SYNC         0xA7
+#define CAP_FILE_HDR     16
+#define CAP_REC_HDR      8
+#define CAP_RING_BYTES   8192      // ~2.3s at the full sensor rate
+#define CAP_REC_MAX      (CAP_REC_HDR + 255)
+#define CAP_SERIAL_TX_BYTES 1024   // Serial TX buffer with CAPTURE_USB
+
+enum CapType : uint8_t {
+  CAP_CONFIG = 1,
+  CAP_IMU    = 2,
+  CAP_PPG    = 3,
+  CAP_BARO   = 4,
+  CAP_GPS    = 5,
+  CAP_BUTTON = 6
+};
+
+#define CAP_IMU_SAMPLE_BYTES  12
+#define CAP_IMU_MAX_SAMPLES   20     // (255 - 5) / 12
+#define CAP_PPG_SAMPLE_BYTES   6
+#define CAP_PPG_MAX_SAMPLES   41     // (255 - 7) / 6
+
+// ── Little-endian helpers ────────────────────────────────────
+inline void capPut16(uint8_t* p, uint16_t v) { p[0] = v; p[1] = v >> 8; }
+inline void capPut32(uint8_t* p, uint32_t v) { p[0] = v; p[1] = v >> 8; p[2] = v >> 16; p[3] = v >> 24; }
+inline void capPut24(uint8_t* p, uint32_t v) { p[0] = v; p[1] = v >> 8; p[2] = v >> 16; }
+inline uint16_t capGet16(const uint8_t* p) { return (uint16_t)(p[0] | (p[1] << 8)); }
+inline uint32_t capGet24(const uint8_t* p) { return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16); }
+inline uint32_t capGet32(const uint8_t* p) {
+  return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+inline uint8_t capCrc8(uint8_t crc, const uint8_t* p, uint16_t n) {
+  while (n--) {
+    crc ^= *p++;
+    for (uint8_t b = 0; b < 8; b++) crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x07) : (uint8_t)(crc << 1);
+  }
+  return crc;
+}
+
+inline uint8_t capRecordCrc(const uint8_t* hdr, const uint8_t* payload, uint8_t len) {
+  uint8_t crc = capCrc8(0, hdr + 1, 2);
+  crc = capCrc8(crc, hdr + 4, 4);
+  return capCrc8(crc, payload, len);
+}
+
+inline void capFileHeader(uint8_t* out, uint32_t startMs) {
+  memset(out, 0, CAP_FILE_HDR);
+  memcpy(out, "TIGC", 4);
+  capPut16(out + 4, CAP_VERSION);
+  capPut16(out + 6, CAP_FILE_HDR);
+  capPut32(out + 8, startMs);
+}
+
+// ── Sink ─────────────────────────────────────────────────────
+// write() takes what it can without blocking and returns it.
+// room(), if set, is what write() would take now; the recorder
+// waits until the whole of the next record fits.
+struct CaptureSink {
+  uint16_t (*write)(const uint8_t* p, uint16_t n);
+  uint16_t (*room)();
+};
+
+// ── Recorder ─────────────────────────────────────────────────
+class CaptureRecorder {
+public:
+  CaptureRecorder(const CaptureSink& sink, uint32_t (*clockUs)())
+    : sink_(sink), clockUs_(clockUs) { clear(); }
+
+  void begin(uint32_t startMs) {
+    clear();
+    uint8_t hdr[CAP_FILE_HDR];
+    capFileHeader(hdr, startMs);
+    append(hdr, CAP_FILE_HDR);
+    active_ = true;
+  }
+
+  void end()            { active_ = false; }
+  bool active() const   { return active_; }
+
+  void config(uint16_t imuHz, uint16_t ppgHz, uint16_t accelLsbPerG, uint16_t gyroLsbPerDps10) {
+    uint8_t p[8];
+    capPut16(p, imuHz); capPut16(p + 2, ppgHz);
+    capPut16(p + 4, accelLsbPerG); capPut16(p + 6, gyroLsbPerDps10);
+    record(CAP_CONFIG, p, sizeof(p));
+  }
+
+  // One IMU burst — consecutive samples, raw accel + gyro counts
+  void imu(const ImuSample* s, uint8_t n) {
+    if (!active_) return;
+    while (n > 0) {
+      uint8_t k = n > CAP_IMU_MAX_SAMPLES ? CAP_IMU_MAX_SAMPLES : n;
+      uint8_t p[5 + CAP_IMU_MAX_SAMPLES * CAP_IMU_SAMPLE_BYTES];
+      capPut32(p, s[0].idx);
+      p[4] = k;
+      uint8_t* w = p + 5;
+      for (uint8_t i = 0; i < k; i++, w += CAP_IMU_SAMPLE_BYTES) {
+        capPut16(w,      (uint16_t)s[i].ax);
+        capPut16(w + 2,  (uint16_t)s[i].ay);
+        capPut16(w + 4,  (uint16_t)s[i].az);
+        capPut16(w + 6,  (uint16_t)s[i].gx);
+        capPut16(w + 8,  (uint16_t)s[i].gy);
+        capPut16(w + 10, (uint16_t)s[i].gz);
+      }
+      record(CAP_IMU, p, (uint8_t)(w - p));
+      s += k; n -= k;
+    }
+  }
+
+  // One PPG block — 18-bit red / IR pairs
+  void ppg(const PpgBlock& b) {
+    if (!active_) return;
+    const PpgSample* s = b.s;
+    uint32_t first = b.firstSample;
+    uint16_t lost  = b.lost;
+    uint16_t n     = b.count;
+    while (n > 0) {
+      uint8_t k = n > CAP_PPG_MAX_SAMPLES ? CAP_PPG_MAX_SAMPLES : (uint8_t)n;
+      uint8_t p[7 + CAP_PPG_MAX_SAMPLES * CAP_PPG_SAMPLE_BYTES];
+      capPut32(p, first);
+      capPut16(p + 4, lost);
+      p[6] = k;
+      uint8_t* w = p + 7;
+      for (uint8_t i = 0; i < k; i++, w += CAP_PPG_SAMPLE_BYTES) {
+        capPut24(w,     s[i].red);
+        capPut24(w + 3, s[i].ir);
+      }
+      record(CAP_PPG, p, (uint8_t)(w - p));
+      first += k; s += k; n -= k; lost = 0;
+    }
+  }
+
+  void baro(float pressurePa, float tempC) {
+    uint8_t p[6];
+    capPut32(p, (uint32_t)(pressurePa * 10.0f + 0.5f));
+    capPut16(p + 4, (uint16_t)(int16_t)(tempC * 100.0f));
+    record(CAP_BARO, p, sizeof(p));
+  }
+
+  void gps(double lat, double lng, float speedKmh, uint8_t sats, bool fix) {
+    uint8_t p[12];
+    capPut32(p,     (uint32_t)(int32_t)(lat * 1e7));
+    capPut32(p + 4, (uint32_t)(int32_t)(lng * 1e7));
+    float cms = speedKmh * (100000.0f / 3600.0f);
+    capPut16(p + 8, cms > 65535.0f ? 65535 : (uint16_t)cms);
+    p[10] = sats;
+    p[11] = fix ? 1 : 0;
+    record(CAP_GPS, p, sizeof(p));
+  }
+
+  void button(uint8_t id, bool down) {
+    uint8_t p[2] = { id, (uint8_t)(down ? 1 : 0) };
+    record(CAP_BUTTON, p, sizeof(p));
+  }
+
+  // Push buffered records to the sink, one write() each. Call
+  // often (every ~10ms).
+  void drain() {
+    while (count_ > 0) {
+      // The file header first, then each record's length from its
+      // header; sent_ is what a sink without room() has taken of it
+      if (!curLen_) curLen_ = hdrOut_ ? CAP_REC_HDR + ring_[(tail_ + 2) % CAP_RING_BYTES] : CAP_FILE_HDR;
+      uint16_t left = curLen_ - sent_;
+      if (sink_.room && sink_.room() < left) break;   // wait for room for all of it
+      const uint8_t* p = &ring_[tail_];
+      if (tail_ + left > CAP_RING_BYTES) {            // wraps — copy it out whole
+        uint16_t run = (uint16_t)(CAP_RING_BYTES - tail_);
+        memcpy(out_, p, run);
+        memcpy(out_ + run, ring_, left - run);
+        p = out_;
+      }
+      uint16_t took = sink_.write(p, left);
+      tail_  = (tail_ + took) % CAP_RING_BYTES;
+      count_ -= took;
+      bytesOut += took;
+      sent_  += took;
+      if (sent_ == curLen_) { curLen_ = sent_ = 0; hdrOut_ = true; }
+      if (took < left) break;       // sink is full — try next time
+    }
+  }
+
+  uint32_t buffered() const { return count_; }
+
+  // Counters
+  uint32_t records;
+  uint32_t dropped;       // records lost because the ring was full
+  uint32_t bytesOut;
+  uint32_t maxBuffered;   // ring high-water mark
+
+private:
+  CaptureSink sink_;
+  uint32_t (*clockUs_)();
+  uint8_t  ring_[CAP_RING_BYTES];
+  uint8_t  out_[CAP_REC_MAX];      // a record that wraps the ring
+  uint32_t head_, tail_, count_;
+  uint16_t curLen_, sent_;         // record at tail_: length, bytes taken
+  bool     hdrOut_;                // file header gone, records follow
+  bool     active_;
+
+  void clear() {
+    head_ = tail_ = count_ = 0;
+    curLen_ = sent_ = 0;
+    hdrOut_ = false;
+    records = dropped = bytesOut = maxBuffered = 0;
+    active_ = false;
+  }
+
+  void append(const uint8_t* p, uint16_t n) {
+    for (uint16_t i = 0; i < n; i++) {
+      ring_[head_] = p[i];
+      head_ = (head_ + 1) % CAP_RING_BYTES;
+    }
+    count_ += n;
+    if (count_ > maxBuffered) maxBuffered = count_;
+  }
+
+  void record(uint8_t type, const uint8_t* payload, uint8_t len) {
+    if (!active_) return;
+    if (count_ + CAP_REC_HDR + len > CAP_RING_BYTES) { dropped++; return; }
+    uint8_t hdr[CAP_REC_HDR];
+    hdr[0] = CAP_SYNC;
+    hdr[1] = type;
+    hdr[2] = len;
+    capPut32(hdr + 4, clockUs_());
+    hdr[3] = capRecordCrc(hdr, payload, len);
+    append(hdr, CAP_REC_HDR);
+    append(payload, len);
+    records++;
+  }
+};
+
+// ── Device sinks ─────────────────────────────────────────────
+#ifdef ARDUINO
+#include <esp_partition.h>
+
+// USB serial: only what fits in the TX buffer right now. The
+// recorder asks captureSerialRoom() first, so a record goes in one
+// Serial.write() — the driver's lock keeps a Serial.printf from
+// the other core out of it, and the reader resyncs past the text.
+inline uint16_t captureSerialWrite(const uint8_t* p, uint16_t n) {
+  int room = Serial.availableForWrite();
+  if (room <= 0) return 0;
+  if (n > room) n = (uint16_t)room;
+  return (uint16_t)Serial.write(p, n);
+}
+
+inline uint16_t captureSerialRoom() {
+  int room = Serial.availableForWrite();
+  return room > 0 ? (uint16_t)room : 0;
+}
+
+// Flash: a data partition named "capture" (subtype 0x40) in
+// partitions.csv, e.g.   capture, data, 0x40, , 4M
+// Sectors are erased just ahead of the write pointer; recording
+// stops when the partition is full. Read back with
+//   esptool.py read_flash <offset> <size> capture.bin
+struct CapFlashState {
+  const esp_partition_t* part = nullptr;
+  uint32_t               off  = 0;
+};
+
+inline CapFlashState& capFlashState() {
+  static CapFlashState st;
+  return st;
+}
+
+inline bool captureFlashBegin() {
+  CapFlashState& st = capFlashState();
+  st.part = esp_partition_find_first(ESP_PARTITION_TYPE_DATA,
+                                     (esp_partition_subtype_t)0x40, "capture");
+  st.off = 0;
+  return st.part != nullptr;
+}
+
+inline uint16_t captureFlashWrite(const uint8_t* p, uint16_t n) {
+  CapFlashState& st = capFlashState();
+  if (!st.part || st.off >= st.part->size) return 0;
+  const uint32_t sector = 4096;
+  if (st.off % sector == 0 &&
+      esp_partition_erase_range(st.part, st.off, sector) != ESP_OK) return 0;
+  // Never cross into a sector that hasn't been erased yet
+  uint32_t room = sector - (st.off % sector);
+  if (n > room) n = (uint16_t)room;
+  if (st.off + n > st.part->size) n = (uint16_t)(st.part->size - st.off);
+  if (esp_partition_write(st.part, st.off, p, n) != ESP_OK) return 0;
+  st.off += n;
+  return n;
+}
+#endif
+
+// ── Reader (host only) ───────────────────────────────────────
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+struct CapRecord {
+  uint8_t        type;
+  uint8_t        len;
+  uint32_t       tUs;       // as recorded
+  uint64_t       t64Us;     // unwrapped across micros() rollover
+  const uint8_t* payload;   // points into the mapping
+};
+
+// Payload accessors — read in place, nothing is copied out
+inline uint32_t capImuFirst(const CapRecord& r) { return capGet32(r.payload); }
+inline uint8_t  capImuCount(const CapRecord& r) { return r.payload[4]; }
+inline int16_t  capImuAxis(const CapRecord& r, uint8_t i, uint8_t axis) {
+  return (int16_t)capGet16(r.payload + 5 + i * CAP_IMU_SAMPLE_BYTES + axis * 2);
+}
+inline uint32_t capPpgFirst(const CapRecord& r) { return capGet32(r.payload); }
+inline uint16_t capPpgLost(const CapRecord& r)  { return capGet16(r.payload + 4); }
+inline uint8_t  capPpgCount(const CapRecord& r) { return r.payload[6]; }
+inline uint32_t capPpgRed(const CapRecord& r, uint8_t i) { return capGet24(r.payload + 7 + i * 6); }
+inline uint32_t capPpgIr(const CapRecord& r, uint8_t i)  { return capGet24(r.payload + 10 + i * 6); }
+
+// Unpack one IMU sample (12 bytes) for feeding a replay source
+inline void capImuSample(const CapRecord& r, uint8_t i, ImuSample& out) {
+  memset(&out, 0, sizeof(out));
+  out.ax = capImuAxis(r, i, 0); out.ay = capImuAxis(r, i, 1); out.az = capImuAxis(r, i, 2);
+  out.gx = capImuAxis(r, i, 3); out.gy = capImuAxis(r, i, 4); out.gz = capImuAxis(r, i, 5);
+  out.idx   = capImuFirst(r) + i;
+  out.valid = true;
+}
+
+class CaptureReader {
+public:
+  ~CaptureReader() { close(); }
+
+  bool open(const char* path) {
+    close();
+    int fd = ::open(path, O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < CAP_FILE_HDR) { ::close(fd); return false; }
+    void* m = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (m == MAP_FAILED) return false;
+    base_ = (const uint8_t*)m;
+    size_ = (size_t)st.st_size;
+    if (memcmp(base_, "TIGC", 4) != 0 || capGet16(base_ + 4) > CAP_VERSION) { close(); return false; }
+    rewind();
+    return true;
+  }
+
+  void close() {
+    if (base_) munmap((void*)base_, size_);
+    base_ = nullptr; size_ = 0;
+  }
+
+  void rewind() {
+    pos_ = base_ ? capGet16(base_ + 6) : 0;
+    lastTUs_ = 0; wraps_ = 0; first_ = true;
+    skippedBytes = 0;
+  }
+
+  uint16_t version() const { return base_ ? capGet16(base_ + 4) : 0; }
+  uint32_t startMs() const { return base_ ? capGet32(base_ + 8) : 0; }
+
+  // Next valid record; skips anything that fails sync or CRC.
+  bool next(CapRecord& r) {
+    while (pos_ + CAP_REC_HDR <= size_) {
+      const uint8_t* h = base_ + pos_;
+      if (h[0] != CAP_SYNC) { pos_++; skippedBytes++; continue; }
+      uint8_t len = h[2];
+      if (pos_ + CAP_REC_HDR + len > size_ || capRecordCrc(h, h + CAP_REC_HDR, len) != h[3]) {
+        pos_++; skippedBytes++; continue;
+      }
+      r.type    = h[1];
+      r.len     = len;
+      r.tUs     = capGet32(h + 4);
+      r.payload = h + CAP_REC_HDR;
+      if (!first_ && r.tUs < lastTUs_ && lastTUs_ - r.tUs > 0x80000000UL) wraps_++;
+      first_   = false;
+      lastTUs_ = r.tUs;
+      r.t64Us  = ((uint64_t)wraps_ << 32) | r.tUs;
+      pos_ += CAP_REC_HDR + len;
+      return true;
+    }
+    return false;
+  }
+
+  uint64_t skippedBytes = 0;   // bytes discarded while resyncing
+
+private:
+  const uint8_t* base_ = nullptr;
+  size_t         size_ = 0;
+  size_t         pos_  = 0;
+  uint32_t       lastTUs_ = 0;
+  uint32_t       wraps_   = 0;
+  bool           first_   = true;
+};
+#endif
@@ -0,0 +1,198 @@
+// ============================================================
+// tiga_cores.h — core split for TIGA v6a
+// ============================================================
+// The ESP32-S3 has two cores; until v6a everything ran in
+// loop() on one of them, so an LCD push, a BLE notify or a
+// report on Serial held up the sensor drains behind it. Now
+// acquisition and signal processing run in a loop pinned to
+// core 0 and loop() keeps the screen, buttons, BLE and flash on
+// core 1. They share nothing but what is in this file:
+//
+//   SpscRing<T, N>  lock-free queue, one producer core, one
+//                   consumer core. Events up (fall, floor),
+//                   commands down (session reset, capture input).
+//   Seqlock<T>      one writer, any readers. The writer never
+//                   waits; a reader retries the copy if a write
+//                   overlapped it, so it never sees a torn value.
+//   coreStart()     run a loop body forever on a given core.
+//   coreId()        which core the caller is on.
+//
+// Both are built on 32-bit std::atomic, which is lock-free on
+// Xtensa and x86 alike; nothing here takes a lock or disables
+// interrupts. The seqlock copies its value as atomic words so
+// the copy itself is race-free under the C++ memory model, and
+// ThreadSanitizer agrees (host `make stress`).
+//
+// coreStart() by build:
+//   ESP32       a FreeRTOS task pinned to the core
+//   TIGA_HOST   the simulator steps the loop on core 0's own
+//               virtual clock (host/sim.cpp)
+//   otherwise   a std::thread; coreStopAll() ends the loops
+// ============================================================
+
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+#include <atomic>
+#include <type_traits>
+
+typedef void (*CoreLoopFn)();
+
+// ── SPSC ring ────────────────────────────────────────────────
+// N is a power of two. head_ and tail_ run free and wrap in 32
+// bits; only the producer stores tail_, only the consumer head_.
+template <typename T, uint16_t N>
+class SpscRing {
+  static_assert((N & (N - 1)) == 0, "SpscRing size must be a power of two");
+
+public:
+  uint32_t dropped = 0;        // producer side: pushes that found it full
+
+  // Producer only. False (and counted) when the consumer is N behind.
+  bool push(const T& v) {
+    uint32_t t = tail_.load(std::memory_order_relaxed);
+    if (t - head_.load(std::memory_order_acquire) >= N) {
+      dropped++;
+      return false;
+    }
+    slots_[t & (N - 1)] = v;
+    tail_.store(t + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Consumer only
+  bool pop(T& out) {
+    uint32_t h = head_.load(std::memory_order_relaxed);
+    if (h == tail_.load(std::memory_order_acquire)) return false;
+    out = slots_[h & (N - 1)];
+    head_.store(h + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Consumer only: the next pop() without taking it, or null
+  const T* front() const {
+    uint32_t h = head_.load(std::memory_order_relaxed);
+    if (h == tail_.load(std::memory_order_acquire)) return nullptr;
+    return &slots_[h & (N - 1)];
+  }
+
+  // Either side; a snapshot that may already be out of date
+  uint32_t size() const {
+    return tail_.load(std::memory_order_acquire) - head_.load(std::memory_order_acquire);
+  }
+
+private:
+  T                     slots_[N];
+  std::atomic<uint32_t> head_{0};
+  std::atomic<uint32_t> tail_{0};
+};
+
+// ── Seqlock ──────────────────────────────────────────────────
+// seq_ is odd while a write is in progress. A reader copies
+// between two loads of seq_ and keeps the copy only if both saw
+// the same even number. Each word is a release store / acquire
+// load, so a reader that saw any word of a newer write also sees
+// its odd seq_ on the second load — no fences, which TSan can't
+// follow.
+template <typename T>
+class Seqlock {
+  static_assert(std::is_trivially_copyable<T>::value, "Seqlock needs a plain struct");
+
+public:
+  uint32_t retries = 0;        // reader side: copies thrown away
+
+  // Writer only
+  void write(const T& v) {
+    uint32_t w[WORDS] = {};
+    memcpy(w, &v, sizeof(T));
+    uint32_t s = seq_.load(std::memory_order_relaxed);
+    seq_.store(s + 1, std::memory_order_relaxed);
+    for (uint16_t i = 0; i < WORDS; i++) words_[i].store(w[i], std::memory_order_release);
+    seq_.store(s + 2, std::memory_order_release);
+  }
+
+  // Copies the latest whole value into `out`; returns its version
+  // (0 = never written). One reader per Seqlock: `retries` is
+  // the reader's.
+  uint32_t read(T& out) {
+    uint32_t w[WORDS];
+    for (;;) {
+      uint32_t s0 = seq_.load(std::memory_order_acquire);
+      if (s0 & 1) { retries++; continue; }
+      for (uint16_t i = 0; i < WORDS; i++) w[i] = words_[i].load(std::memory_order_acquire);
+      if (seq_.load(std::memory_order_relaxed) == s0) {
+        memcpy(&out, w, sizeof(T));
+        return s0;
+      }
+      retries++;
+    }
+  }
+
+  // Cheap check before a read(): unchanged since `seen`?
+  uint32_t version() const { return seq_.load(std::memory_order_acquire) & ~1u; }
+
+private:
+  static const uint16_t WORDS = (sizeof(T) + 3) / 4;
+  std::atomic<uint32_t> seq_{0};
+  std::atomic<uint32_t> words_[WORDS] = {};
+};
+
+// ── Core loops ───────────────────────────────────────────────
+// `fn` is one pass of the loop — e.g. one Scheduler::runOnce()
+// — and must give the core up when idle (delay() does).
+#if defined(TIGA_HOST)
+
+void simCoreStart(CoreLoopFn fn);
+int  simCoreId();
+
+inline uint8_t coreId() { return (uint8_t)simCoreId(); }
+
+inline bool coreStart(const char*, CoreLoopFn fn, uint8_t, uint32_t, uint8_t) {
+  simCoreStart(fn);
+  return true;
+}
+
+#elif defined(ESP32)
+
+inline uint8_t coreId() { return (uint8_t)xPortGetCoreID(); }
+
+inline void coreTaskMain(void* arg) {
+  CoreLoopFn fn = (CoreLoopFn)arg;
+  for (;;) fn();
+}
+
+inline bool coreStart(const char* name, CoreLoopFn fn, uint8_t core,
+                      uint32_t stackBytes, uint8_t priority) {
+  return xTaskCreatePinnedToCore(coreTaskMain, name, stackBytes, (void*)fn,
+                                 priority, nullptr, core) == pdPASS;
+}
+
+#else
+
+#include <thread>
+#include <vector>
+
+inline std::atomic<bool>&        coreRunning() { static std::atomic<bool> r{true}; return r; }
+inline std::vector<std::thread>& coreThreads() { static std::vector<std::thread> t; return t; }
+
+// Threads aren't pinned; everything reports core 0
+inline uint8_t coreId() { return 0; }
+
+// Core number, stack and priority are left to the host scheduler
+inline bool coreStart(const char*, CoreLoopFn fn, uint8_t, uint32_t, uint8_t) {
+  coreRunning() = true;
+  coreThreads().emplace_back([fn] {
+    while (coreRunning().load(std::memory_order_acquire)) fn();
+  });
+  return true;
+}
+
+// Ends every loop after its current pass and waits for it
+inline void coreStopAll() {
+  coreRunning() = false;
+  for (std::thread& t : coreThreads()) t.join();
+  coreThreads().clear();
+}
+
+#endif
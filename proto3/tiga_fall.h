@@ -0,0 +1,330 @@
+// ============================================================
+// tiga_fall.h — multi-stage fall detector for TIGA v6a
+// ============================================================
+// Decides whether an impact at the wrist was a fall. v6a looked
+// at two samples: one above 3g, and one 250 ms later below 0.5g.
+// A real fall ends lying at 1g, soft falls rarely reach 3g at the
+// wrist, and an arm dropped onto a table passes both, so it
+// missed falls and sent wearers into the 10 s countdown for
+// nothing. Here every sample updates a few running features and
+// an impact is judged in stages:
+//
+//   descent   the wrist's drop into the impact: vertical
+//             acceleration (from tiga_fusion.h) less its slow
+//             mean, integrated to velocity with a leak, and
+//             distance summed while the wrist goes down faster
+//             than FALL_DESCENT_MPS — slower than that is drift
+//             or an arm lowered, and ends the descent
+//   free fall the run of samples with |a| under FALL_FREE_G
+//             that ended last
+//   impact    |a| ≥ FALL_IMPACT_G opens a window; the drop and
+//             free fall are taken as they were then, the peak
+//             over FALL_IMPACT_MS. A candidate needs
+//             FALL_DROP_M of drop, or FALL_DROP_FREE_M with
+//             FALL_FREE_MS of free fall behind it — a clap, a
+//             knock, a jump or a hand slapped on a table doesn't
+//             come down that far
+//   settle    FALL_SETTLE_MS after the impact are not scored:
+//             tumbling, rocking, the arm flung out
+//   still     then a window of FALL_STILL_MS in which
+//             FALL_STILL_PCT of samples are near 1g with the gyro
+//             quiet; up to FALL_STILL_TRIES windows one after
+//             another, so someone who struggles for a few seconds
+//             and stays down is still found. Whoever sat down hard
+//             gets up, or was never down
+//   turned    and the mean up vector over that window at least
+//             FALL_TURN_DEG from where it was FALL_UP_SLOTS × 50 ms
+//             before the impact
+//
+// push() does the same few adds and compares on every sample
+// whatever the stage; the one divide and square roots happen
+// once per still window. A fall is reported FALL_SETTLE_MS +
+// FALL_STILL_MS after the impact, a window later for each one
+// that wasn't still.
+//
+// The features of the last candidate stay in `last`, and each
+// stage counts what it threw out, for tuning on real captures.
+//
+// Memory: 192 B of up vectors, ~110 B of state. No heap.
+// Precision, recall, latency and CPU per hour of data over a
+// directory of labelled captures: host/fall_eval.cpp.
+// ============================================================
+
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+#include "tiga_imu_fifo.h"
+#include "tiga_motion.h"
+
+// ── Config ───────────────────────────────────────────────────
+#define FALL_FREE_G        0.45f   // |a| under this is falling freely
+#define FALL_FREE_MS       150     // free fall that lowers the drop needed
+#define FALL_IMPACT_G      1.8f    // |a| that opens an impact window
+#define FALL_IMPACT_MS     200     // peak taken over this
+#define FALL_GAP_MS        300     // descent / free fall may end this long before
+#define FALL_DROP_M        0.60f   // wrist drop into the impact
+#define FALL_DROP_FREE_M   0.45f   // ...or this much after free fall
+#define FALL_DESCENT_MPS   0.3f    // going down faster than this is a descent
+#define FALL_SETTLE_MS     1000    // after the impact, not scored
+#define FALL_STILL_MS      2000    // then scored for stillness
+#define FALL_STILL_PCT     70      // share of it that must be still
+#define FALL_STILL_TRIES   3       // windows before giving up
+#define FALL_STILL_G       0.15f   // still: ||a| - 1g| within this...
+#define FALL_STILL_DPS     30      // ...and |gx| + |gy| + |gz| under this
+#define FALL_TURN_DEG      35      // mean attitude this far from before
+#define FALL_UP_SLOTS      32      // up vector every 50 ms: 1.6 s back
+#define FALL_GYRO_LSB_DPS  131     // MPU6050 at ±250°/s
+#define FALL_BIAS_SHIFT    10      // slow mean of vert: 5 s at 200 Hz
+#define FALL_VEL_SHIFT     9       // velocity leak: 2.6 s
+
+#define FALL_UP_EVERY      (IMU_RATE_HZ / 20)
+
+// Velocity is vert summed per sample (counts·samples) and drop is
+// velocity summed per sample (counts·samples²); a metre of drop,
+// and a metre a second:
+constexpr float FALL_DROP_PER_M = (float)MOTION_LSB_PER_G * IMU_RATE_HZ * IMU_RATE_HZ / 9.80665f;
+constexpr float FALL_VEL_PER_MPS = (float)MOTION_LSB_PER_G * IMU_RATE_HZ / 9.80665f;
+
+constexpr uint32_t fallSamples(uint32_t ms) { return ms * IMU_RATE_HZ / 1000; }
+
+// cos at compile time (Taylor series), for the turn threshold
+constexpr double fallCos(double deg) {
+  double x = deg * 3.14159265358979 / 180, term = 1, sum = 1;
+  for (int k = 1; k < 12; k++) { term *= -x * x / ((2 * k - 1) * (2 * k)); sum += term; }
+  return sum;
+}
+
+enum FallStage : uint8_t { FALL_IDLE, FALL_IMPACT, FALL_SETTLE, FALL_STILL };
+
+enum FallVerdict : uint8_t {
+  FALL_NONE,             // no candidate yet
+  FALL_NO_DROP,          // impact without the descent of a fall
+  FALL_NOT_STILL,        // moving afterwards, every window
+  FALL_NOT_TURNED,       // still, but as before
+  FALL_CONFIRMED
+};
+
+// What the last candidate looked like
+struct FallFeatures {
+  uint32_t idx;          // sample index of the impact
+  uint16_t peakMg;       // |a| peak in the impact window
+  uint16_t dropCm;       // wrist drop into it
+  uint16_t freeMs;       // free fall before it
+  uint8_t  stillPct;     // of the last stillness window
+  int16_t  turnCos;      // cos of the turn, Q14 (16384 = none)
+  uint8_t  verdict;      // FallVerdict
+};
+
+class FallDetector {
+public:
+  FallDetector() { reset(); }
+
+  // Counters
+  uint32_t candidates;   // impacts judged
+  uint32_t noDrop;       // thrown out per stage
+  uint32_t notStill;
+  uint32_t notTurned;
+  uint32_t falls;
+  FallFeatures last;
+
+  void reset() {
+    candidates = noDrop = notStill = notTurned = falls = 0;
+    memset(&last, 0, sizeof(last));
+    last.turnCos = 16384;
+    stage_ = FALL_IDLE;
+    primed_ = false;
+    biasSum_ = vel_ = 0;
+    drop_ = lastDrop_ = 0;
+    freeRun_ = lastFree_ = 0;
+    lastDropIdx_ = lastFreeIdx_ = 0;
+    upIdx_ = 0;
+  }
+
+  FallStage stage() const { return (FallStage)stage_; }
+
+  // Every valid sample, after motionBatch() and fusionBatch().
+  // True on the sample a fall is confirmed.
+  bool push(const ImuSample& s) {
+    if (!primed_) prime(s);
+    track(s);
+
+    switch (stage_) {
+      case FALL_IDLE:
+        if (s.g >= IMPACT) open(s);
+        return false;
+
+      case FALL_IMPACT:
+        if (s.g > peak_) peak_ = s.g;
+        if (clipped(s)) clip_ = true;
+        if (s.idx - t0_ < fallSamples(FALL_IMPACT_MS)) return false;
+        // An impact past ±4g clips, so integrating it can't bring the
+        // velocity back to rest; it did stop, so say so
+        if (clip_) { vel_ = 0; drop_ = lastDrop_ = 0; }
+        judgeImpact();
+        return false;
+
+      case FALL_SETTLE:
+        if (s.idx - t0_ >= fallSamples(FALL_SETTLE_MS)) stage_ = FALL_STILL;
+        return false;
+
+      default:                              // FALL_STILL
+        n_++;
+        if (isStill(s)) {
+          still_++;
+          for (int k = 0; k < 3; k++) upSum_[k] += s.up[k];
+        }
+        if (n_ < fallSamples(FALL_STILL_MS)) return false;
+        return judgeStill();
+    }
+  }
+
+private:
+  static constexpr uint16_t FREE   = (uint16_t)(FALL_FREE_G * MOTION_LSB_PER_G);
+  static constexpr uint16_t IMPACT = (uint16_t)(FALL_IMPACT_G * MOTION_LSB_PER_G);
+  static constexpr uint16_t STILL_G = (uint16_t)(FALL_STILL_G * MOTION_LSB_PER_G);
+  static constexpr int32_t  STILL_GYRO = FALL_STILL_DPS * FALL_GYRO_LSB_DPS;
+  static constexpr int32_t  DESCENT = (int32_t)(FALL_DESCENT_MPS * FALL_VEL_PER_MPS);
+  static constexpr uint32_t DROP_MAX = 0xF0000000u;
+
+  uint8_t  stage_;
+  bool     primed_;
+
+  // Running features, every sample
+  int32_t  biasSum_;               // vert × 2^FALL_BIAS_SHIFT, leaky
+  int32_t  vel_;                   // counts·samples, + up
+  uint32_t drop_;                  // this descent, counts·samples²
+  uint32_t lastDrop_, lastDropIdx_;
+  uint16_t freeRun_;               // samples
+  uint16_t lastFree_;
+  uint32_t lastFreeIdx_;
+  int16_t  up_[FALL_UP_SLOTS][3];  // Q14, oldest at upIdx_
+  uint8_t  upIdx_;
+
+  // The impact being judged
+  uint32_t t0_;
+  uint16_t peak_;
+  bool     clip_;                  // an axis at full scale
+  uint32_t dropAt_;
+  uint16_t freeAt_;
+  int16_t  ref_[3];
+  uint16_t n_, still_;             // this window
+  uint8_t  tries_;
+  int32_t  upSum_[3];
+
+  void prime(const ImuSample& s) {
+    for (int i = 0; i < FALL_UP_SLOTS; i++) memcpy(up_[i], s.up, sizeof(up_[0]));
+    primed_ = true;
+  }
+
+  void track(const ImuSample& s) {
+    // Descent: vert less its slow mean (the accelerometer's offset
+    // along gravity), to velocity, the downward part to distance
+    biasSum_ += s.vert - (biasSum_ >> FALL_BIAS_SHIFT);
+    vel_ += s.vert - (biasSum_ >> FALL_BIAS_SHIFT);
+    vel_ -= vel_ >> FALL_VEL_SHIFT;
+    if (vel_ < -DESCENT) {
+      if (drop_ < DROP_MAX) drop_ += (uint32_t)-vel_;
+    } else if (drop_) {
+      lastDrop_ = drop_; lastDropIdx_ = s.idx;
+      drop_ = 0;
+    }
+
+    if (s.g < FREE) {
+      if (freeRun_ < UINT16_MAX) freeRun_++;
+    } else if (freeRun_) {
+      lastFree_ = freeRun_; lastFreeIdx_ = s.idx;
+      freeRun_ = 0;
+    }
+
+    if (s.idx % FALL_UP_EVERY == 0) {
+      memcpy(up_[upIdx_], s.up, sizeof(up_[0]));
+      upIdx_ = (upIdx_ + 1) % FALL_UP_SLOTS;
+    }
+  }
+
+  void open(const ImuSample& s) {
+    stage_ = FALL_IMPACT;
+    t0_    = s.idx;
+    peak_  = s.g;
+    clip_  = clipped(s);
+    bool recent = s.idx - lastDropIdx_ <= fallSamples(FALL_GAP_MS);
+    dropAt_ = drop_ > lastDrop_ || !recent ? drop_ : lastDrop_;
+    recent  = s.idx - lastFreeIdx_ <= fallSamples(FALL_GAP_MS);
+    freeAt_ = freeRun_ > lastFree_ || !recent ? freeRun_ : lastFree_;
+    memcpy(ref_, up_[upIdx_], sizeof(ref_));
+  }
+
+  void judgeImpact() {
+    candidates++;
+    last.idx      = t0_;
+    last.peakMg   = (uint16_t)((uint32_t)peak_ * 1000 / MOTION_LSB_PER_G);
+    float m       = dropAt_ / FALL_DROP_PER_M;
+    last.dropCm   = (uint16_t)(m < 600 ? m * 100 : 60000);
+    last.freeMs   = (uint16_t)((uint32_t)freeAt_ * 1000 / IMU_RATE_HZ);
+    last.stillPct = 0;
+    last.turnCos  = 16384;
+    bool dropped = dropAt_ >= (uint32_t)(FALL_DROP_M * FALL_DROP_PER_M) ||
+                   (freeAt_ >= fallSamples(FALL_FREE_MS) &&
+                    dropAt_ >= (uint32_t)(FALL_DROP_FREE_M * FALL_DROP_PER_M));
+    if (!dropped) {
+      last.verdict = FALL_NO_DROP;
+      noDrop++;
+      stage_ = FALL_IDLE;
+      return;
+    }
+    last.verdict = FALL_NONE;               // until the stillness is in
+    stage_ = FALL_SETTLE;
+    tries_ = 0;
+    newWindow();
+  }
+
+  void newWindow() {
+    n_ = still_ = 0;
+    upSum_[0] = upSum_[1] = upSum_[2] = 0;
+  }
+
+  static bool clipped(const ImuSample& s) {
+    return s.ax <= -32767 || s.ax >= 32767 || s.ay <= -32767 || s.ay >= 32767 ||
+           s.az <= -32767 || s.az >= 32767;
+  }
+
+  bool isStill(const ImuSample& s) const {
+    int32_t dg = (int32_t)s.g - MOTION_LSB_PER_G;
+    if (dg > STILL_G || dg < -(int32_t)STILL_G) return false;
+    int32_t w = (s.gx < 0 ? -s.gx : s.gx) + (s.gy < 0 ? -s.gy : s.gy) + (s.gz < 0 ? -s.gz : s.gz);
+    return w < STILL_GYRO;
+  }
+
+  // At the end of each still window: another window, or a verdict
+  bool judgeStill() {
+    last.stillPct = (uint8_t)((uint32_t)still_ * 100 / n_);
+    if (still_ * 100 < (uint32_t)n_ * FALL_STILL_PCT) {
+      if (++tries_ < FALL_STILL_TRIES) { newWindow(); return false; }
+      last.verdict = FALL_NOT_STILL;
+      notStill++;
+      stage_ = FALL_IDLE;
+      return false;
+    }
+    stage_ = FALL_IDLE;
+    // Mean up over the still samples against the one from before:
+    // cos = m·r / (|m| |r|), all Q14
+    int32_t m[3];
+    for (int k = 0; k < 3; k++) m[k] = upSum_[k] / still_;
+    int64_t dot = (int64_t)m[0] * ref_[0] + (int64_t)m[1] * ref_[1] + (int64_t)m[2] * ref_[2];
+    uint32_t lm = motionIsqrt((uint32_t)(m[0] * m[0] + m[1] * m[1] + m[2] * m[2]));
+    uint32_t lr = motionIsqrt((uint32_t)(ref_[0] * ref_[0] + ref_[1] * ref_[1] + ref_[2] * ref_[2]));
+    int32_t c = lm && lr ? (int32_t)((dot << 14) / ((int64_t)lm * lr)) : 16384;
+    last.turnCos = (int16_t)(c > 16384 ? 16384 : c < -16384 ? -16384 : c);
+    if (last.turnCos > COS_TURN) {
+      last.verdict = FALL_NOT_TURNED;
+      notTurned++;
+      return false;
+    }
+    last.verdict = FALL_CONFIRMED;
+    falls++;
+    return true;
+  }
+
+  static constexpr int16_t COS_TURN = (int16_t)(fallCos(FALL_TURN_DEG) * 16384);
+};
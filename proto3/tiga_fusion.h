@@ -0,0 +1,209 @@
+// ============================================================
+// tiga_fusion.h — fixed-point attitude filter for TIGA v6a
+// ============================================================
+// Fuses the MPU6050 gyro with its accelerometer (Mahony's
+// complementary filter on a quaternion) into:
+//
+//   pitch     of the watch face, as motionTiltCdeg() gave from
+//             accel alone — same sign, same zero
+//   roll      about the forearm, atan2(up.y, up.z), ±180°
+//   up        gravity's direction in sensor axes, Q14
+//   vert      acceleration along gravity less 1g, counts —
+//             what the wearer's body does, not how the wrist
+//             is turned
+//
+// Why: accel-only tilt is the direction of gravity *plus*
+// whatever the arm is doing, so it swings tens of degrees while
+// walking and means nothing during a fall — when the stability
+// and fall code need it. The gyro sees rotation directly; the
+// accelerometer only pulls the estimate back slowly (FUSION_KP),
+// and not at all while |a| is far from 1g. A PI term learns the
+// gyro's zero-rate offset so the estimate doesn't drift.
+//
+// Fixed point throughout the update: quaternion and unit
+// vectors in Q30, 64-bit products, one divide (to scale the
+// accel to unit length). Angles come from tiga_motion.h's atan
+// table and are only worked out when asked for.
+//
+// Usage:
+//   FusionFilter fusion;
+//   fusion.update(ax, ay, az, gx, gy, gz, g);   // every sample
+//   fusion.pitchCdeg(); fusion.rollCdeg(); fusion.vert;
+//
+// Accuracy on synthetic motion with known orientation
+// (host/bench_fusion.cpp): within 0.1° of the same filter in
+// float; walking with arm swing 0.7° pitch / 1.2° roll RMS,
+// against 9.5° / 4.2° from the accelerometer alone.
+// ============================================================
+
+#pragma once
+
+#include <math.h>
+#include <stdint.h>
+#include "tiga_imu_fifo.h"
+#include "tiga_motion.h"
+
+// ── Config ───────────────────────────────────────────────────
+#define FUSION_GYRO_LSB_DPS  131      // MPU6050 gyro at ±250°/s
+#define FUSION_KP            1.0      // 1/s: how hard accel pulls the estimate
+#define FUSION_KI            0.1     // 1/s²: how fast the gyro offset is learnt
+#define FUSION_GATE_G        0.2      // accel ignored when ||a| - 1g| is larger
+#define FUSION_BIAS_MAX_DPS  10.0     // learnt gyro offset is clamped here
+
+#define FUSION_ONE   (1 << 30)        // 1.0 in Q30
+
+// The filter works in half the rotation over one sample, radians,
+// Q30: then q += q ⊗ (0, h) is the whole integration step.
+constexpr double FUSION_DT = 1.0 / IMU_RATE_HZ;
+constexpr double FUSION_HALF_RAD_PER_COUNT =
+    3.14159265358979 / 180 / FUSION_GYRO_LSB_DPS * FUSION_DT / 2;
+
+// gyro counts → h, Q30, with 4 extra bits (≈ 358 per count at 200 Hz)
+constexpr int32_t FUSION_GYRO_Q4  = (int32_t)(FUSION_HALF_RAD_PER_COUNT * FUSION_ONE * 16 + 0.5);
+// accel error (Q30 sine) → h, and → the offset integral per sample
+constexpr int32_t FUSION_KP_Q16   = (int32_t)(FUSION_KP * FUSION_DT / 2 * 65536 + 0.5);
+constexpr int32_t FUSION_KI_Q32   = (int32_t)(FUSION_KI * FUSION_DT * FUSION_DT / 2 * 4294967296.0 + 0.5);
+constexpr int32_t FUSION_BIAS_MAX = (int32_t)(FUSION_BIAS_MAX_DPS * FUSION_GYRO_LSB_DPS *
+                                              FUSION_HALF_RAD_PER_COUNT * FUSION_ONE);
+#define FUSION_GATE  MOTION_G(FUSION_GATE_G)
+
+// ── Filter ───────────────────────────────────────────────────
+class FusionFilter {
+public:
+  int32_t  q[4];            // body → world, Q30: w, x, y, z
+  int32_t  up[3];           // gravity's direction in sensor axes, Q30
+  int32_t  bias[3];         // learnt gyro offset, as h (Q30)
+  int16_t  vert;            // newest vertical acceleration, counts
+  bool     ready;           // false until the first sample
+
+  uint32_t updates;
+  uint32_t gated;           // samples whose accel was ignored
+
+  FusionFilter() { reset(); }
+
+  void reset() {
+    q[0] = FUSION_ONE; q[1] = q[2] = q[3] = 0;
+    up[0] = up[1] = 0; up[2] = FUSION_ONE;
+    bias[0] = bias[1] = bias[2] = 0;
+    vert = 0;
+    ready = false;
+    updates = gated = 0;
+  }
+
+  // One sample: raw counts, and |a| in counts (ImuSample::g).
+  // Returns vertical acceleration in counts.
+  int16_t update(int16_t ax, int16_t ay, int16_t az,
+                 int16_t gx, int16_t gy, int16_t gz, uint16_t g) {
+    if (!ready) {
+      if (!g) return 0;
+      seed(ax, ay, az);
+      ready = true;
+    }
+    updates++;
+
+    int32_t h[3] = {
+      (int32_t)(((int32_t)gx * FUSION_GYRO_Q4) >> 4),
+      (int32_t)(((int32_t)gy * FUSION_GYRO_Q4) >> 4),
+      (int32_t)(((int32_t)gz * FUSION_GYRO_Q4) >> 4),
+    };
+
+    int32_t dg = (int32_t)g - MOTION_LSB_PER_G;
+    if (g && dg < FUSION_GATE && dg > -FUSION_GATE) {
+      // Unit accel, Q30; error = measured × estimated gravity
+      int64_t inv = ((int64_t)1 << 44) / g;
+      int64_t a0 = (ax * inv) >> 14, a1 = (ay * inv) >> 14, a2 = (az * inv) >> 14;
+      int64_t e[3] = {
+        (a1 * up[2] - a2 * up[1]) >> 30,
+        (a2 * up[0] - a0 * up[2]) >> 30,
+        (a0 * up[1] - a1 * up[0]) >> 30,
+      };
+      // The offset step is a fraction of a unit: rounded, not
+      // floored, or the learnt offset creeps negative
+      for (int i = 0; i < 3; i++) {
+        int64_t b = bias[i] + ((e[i] * FUSION_KI_Q32 + (1LL << 31)) >> 32);
+        bias[i] = (int32_t)(b > FUSION_BIAS_MAX ? FUSION_BIAS_MAX : b < -FUSION_BIAS_MAX ? -FUSION_BIAS_MAX : b);
+        h[i] += (int32_t)((e[i] * FUSION_KP_Q16) >> 16);
+      }
+    } else {
+      gated++;
+    }
+    for (int i = 0; i < 3; i++) h[i] += bias[i];
+
+    // q += q ⊗ (0, h)
+    int64_t w = q[0], x = q[1], y = q[2], z = q[3];
+    int64_t nw = w + ((-x * h[0] - y * h[1] - z * h[2]) >> 30);
+    int64_t nx = x + (( w * h[0] + y * h[2] - z * h[1]) >> 30);
+    int64_t ny = y + (( w * h[1] - x * h[2] + z * h[0]) >> 30);
+    int64_t nz = z + (( w * h[2] + x * h[1] - y * h[0]) >> 30);
+
+    // Back to unit length: one Newton step of 1/√n, n ≈ 1
+    int64_t n = (nw * nw + nx * nx + ny * ny + nz * nz) >> 30;
+    int64_t f = ((3LL << 30) - n) >> 1;
+    q[0] = (int32_t)((nw * f) >> 30);
+    q[1] = (int32_t)((nx * f) >> 30);
+    q[2] = (int32_t)((ny * f) >> 30);
+    q[3] = (int32_t)((nz * f) >> 30);
+    updateUp();
+
+    int64_t along = ((int64_t)ax * up[0] + (int64_t)ay * up[1] + (int64_t)az * up[2]) >> 30;
+    int64_t v = along - MOTION_LSB_PER_G;
+    vert = (int16_t)(v > 32767 ? 32767 : v < -32768 ? -32768 : v);
+    return vert;
+  }
+
+  // Gravity direction, Q14 (unit = 16384)
+  int16_t upQ14(uint8_t axis) const { return (int16_t)(up[axis] >> 16); }
+
+  // Hundredths of a degree
+  int32_t pitchCdeg() const { return motionTiltCdeg(upQ14(0), upQ14(1), upQ14(2)); }
+
+  int32_t rollCdeg() const {
+    int32_t y = upQ14(1), z = upQ14(2);
+    if (z >= 0) return motionAtan2Cdeg(y, z);
+    return (y >= 0 ? 18000 : -18000) - motionAtan2Cdeg(y, -z);   // face down
+  }
+
+private:
+  // Start from the accelerometer alone, yaw 0. Once per reset,
+  // so float is fine here.
+  void seed(int16_t ax, int16_t ay, int16_t az) {
+    float n = sqrtf((float)ax * ax + (float)ay * ay + (float)az * az);
+    float vx = ax / n, vy = ay / n, vz = az / n;
+    float qw, qx, qy;
+    if (vz > -0.99f) {
+      qw = sqrtf((1 + vz) / 2);
+      qx = vy / (2 * qw);
+      qy = -vx / (2 * qw);
+    } else {
+      qw = 0; qx = 1; qy = 0;               // face down: half a turn about x
+    }
+    q[0] = (int32_t)lrintf(qw * FUSION_ONE);
+    q[1] = (int32_t)lrintf(qx * FUSION_ONE);
+    q[2] = (int32_t)lrintf(qy * FUSION_ONE);
+    q[3] = 0;
+    updateUp();
+  }
+
+  // Third row of the rotation matrix: world up in sensor axes
+  void updateUp() {
+    int64_t w = q[0], x = q[1], y = q[2], z = q[3];
+    up[0] = (int32_t)((x * z - w * y) >> 29);
+    up[1] = (int32_t)((w * x + y * z) >> 29);
+    up[2] = (int32_t)((w * w - x * x - y * y + z * z) >> 30);
+  }
+};
+
+// ── Burst kernel ─────────────────────────────────────────────
+// Runs the filter over a burst and leaves each sample's up
+// vector and vertical acceleration on it for the later stages.
+// Dropped samples are skipped (their rotation is lost; the
+// accelerometer takes it back out).
+inline void fusionBatch(FusionFilter& f, ImuSample* s, uint8_t n) {
+  for (uint8_t i = 0; i < n; i++) {
+    if (!s[i].valid) continue;
+    s[i].vert  = f.update(s[i].ax, s[i].ay, s[i].az, s[i].gx, s[i].gy, s[i].gz, s[i].g);
+    s[i].up[0] = f.upQ14(0);
+    s[i].up[1] = f.upQ14(1);
+    s[i].up[2] = f.upQ14(2);
+  }
+}
@@ -0,0 +1,222 @@
+// ============================================================
+// tiga_gfx.h — dirty-tile frame renderer for TIGA v6a
+// ============================================================
+// Screens are drawn into an off-screen RGB565 canvas the size of
+// the panel, never straight onto the LCD. When a frame is done,
+// commit() compares the canvas with what the panel last received,
+// one 16×10 tile at a time, and queues only the tiles that changed,
+// merged into rectangles. next() hands those out a band at a time,
+// copied into a bounce buffer that the bus (or its DMA) reads.
+//
+// Why: v6a cleared the panel with fillScreen() on every state
+// change and then drew on it — a visible black flash, and 30-40 ms
+// of bus time inside one blocking call. Off-screen drawing removes
+// the flash (the panel only ever gets finished pixels), the diff
+// sends a menu move as two rows instead of the whole screen, and
+// band-sized pushes let the scheduler run the sensor tasks between
+// them.
+//
+// What the panel holds is kept as one 32-bit hash per tile, taken
+// from exactly the pixels that went out. If the canvas changes
+// again while a frame is still being sent, the next commit sees
+// the difference and sends it.
+//
+// Usage:
+//   GfxFrame gfx;
+//   gfx.begin((const uint16_t*)canvas.getPointer(), W, H);
+//   ... draw into the canvas ...
+//   gfx.commit();                              // frame finished
+//   while (const GfxBand* b = gfx.next())      // a few per task run
+//     tft.pushImage(b->x, b->y, b->w, b->h, b->px);
+//
+// Pixels are copied exactly as stored; byte order is between the
+// canvas and the bus driver.
+// ============================================================
+
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+
+#define GFX_TILE_W     16
+#define GFX_TILE_H     10
+#define GFX_MAX_W      320
+#define GFX_MAX_H      170
+#define GFX_TILES_X    ((GFX_MAX_W + GFX_TILE_W - 1) / GFX_TILE_W)
+#define GFX_TILES_Y    ((GFX_MAX_H + GFX_TILE_H - 1) / GFX_TILE_H)
+#define GFX_MAX_RECTS  48
+#define GFX_BAND_PX    (GFX_MAX_W * GFX_TILE_H)   // 6.4 KB bounce buffer
+
+// A run of pixels ready for the bus; px is valid until the next next()
+struct GfxBand {
+  int16_t         x, y, w, h;
+  const uint16_t* px;
+};
+
+class GfxFrame {
+public:
+  // Counters since begin()
+  uint32_t frames    = 0;    // commits that changed something
+  uint32_t bandsOut  = 0;
+  uint64_t bytesOut  = 0;    // pixel bytes handed to the bus
+  uint32_t lastBytes = 0;    // pixel bytes of the last frame that changed
+  uint32_t maxBytes  = 0;
+  uint8_t  lastRects = 0;    // and its rectangles
+
+  bool begin(const uint16_t* canvas, int16_t w, int16_t h) {
+    fb_ = nullptr;
+    if (!canvas || w <= 0 || h <= 0 || w > GFX_MAX_W || h > GFX_MAX_H) return false;
+    fb_ = canvas;
+    w_  = w;
+    h_  = h;
+    tx_ = (w + GFX_TILE_W - 1) / GFX_TILE_W;
+    ty_ = (h + GFX_TILE_H - 1) / GFX_TILE_H;
+    invalidate();
+    return true;
+  }
+
+  // Panel contents unknown (power-up, wake): the next commit sends all
+  void invalidate() {
+    memset(known_, 0, sizeof(known_));
+    nRects_ = 0;
+    cur_    = 0;
+  }
+
+  // Diff the canvas against the panel and queue what changed.
+  // Anything still queued from an earlier commit is re-planned.
+  // Returns the number of rectangles queued.
+  uint8_t commit() {
+    nRects_ = 0;
+    cur_    = 0;
+    rowOff_ = 0;
+    if (!fb_) return 0;
+
+    uint32_t bytes = 0;
+    uint8_t  open0 = 0;              // rects that reached the row above start here
+    for (uint8_t ty = 0; ty < ty_; ty++) {
+      uint8_t openEnd = nRects_;
+      uint8_t tx = 0;
+      while (tx < tx_) {
+        if (!tileDirty(tx, ty)) { tx++; continue; }
+        uint8_t x0 = tx;
+        while (tx < tx_ && tileDirty(tx, ty)) tx++;
+        addRun(x0, tx, ty, open0, openEnd);
+      }
+      open0 = openEnd;
+    }
+
+    for (uint8_t i = 0; i < nRects_; i++) {
+      Rect r = pixels(rects_[i]);
+      bytes += (uint32_t)r.w * r.h * 2;
+    }
+    if (nRects_) {
+      frames++;
+      lastRects = nRects_;
+      lastBytes = bytes;
+      if (bytes > maxBytes) maxBytes = bytes;
+    }
+    return nRects_;
+  }
+
+  bool busy() const { return cur_ < nRects_; }
+
+  // Next band of the queued frame, or nullptr when it has all gone
+  const GfxBand* next() {
+    if (cur_ >= nRects_) return nullptr;
+    const Rect& t = rects_[cur_];               // tile units
+    Rect r = pixels(t);
+
+    // Whole tile rows only, as many as fit the bounce buffer
+    uint8_t rowsFit = GFX_BAND_PX / ((uint32_t)r.w * GFX_TILE_H);
+    if (rowsFit == 0) rowsFit = 1;
+    uint8_t rows = t.h - rowOff_;
+    if (rows > rowsFit) rows = rowsFit;
+
+    int16_t y0 = (t.y + rowOff_) * GFX_TILE_H;
+    int16_t y1 = (t.y + rowOff_ + rows) * GFX_TILE_H;
+    if (y1 > h_) y1 = h_;
+    for (int16_t y = y0; y < y1; y++)
+      memcpy(&bounce_[(y - y0) * r.w], &fb_[y * w_ + r.x], r.w * sizeof(uint16_t));
+
+    // Record what the panel is about to hold, from the copy itself
+    for (uint8_t ty = t.y + rowOff_; ty < t.y + rowOff_ + rows; ty++) {
+      for (uint8_t tx = t.x; tx < t.x + t.w; tx++) {
+        int16_t ox = tx * GFX_TILE_W - r.x, oy = ty * GFX_TILE_H - y0;
+        shown_[ty][tx] = hashTile(&bounce_[oy * r.w + ox], r.w, tileW(tx), tileH(ty));
+        known_[ty][tx] = 1;
+      }
+    }
+
+    band_ = { r.x, y0, r.w, (int16_t)(y1 - y0), bounce_ };
+    bandsOut++;
+    bytesOut += (uint32_t)r.w * (y1 - y0) * 2;
+
+    rowOff_ += rows;
+    if (rowOff_ >= t.h) { cur_++; rowOff_ = 0; }
+    return &band_;
+  }
+
+private:
+  struct Rect { int16_t x, y, w, h; };
+
+  const uint16_t* fb_ = nullptr;
+  int16_t  w_ = 0, h_ = 0;
+  uint8_t  tx_ = 0, ty_ = 0;
+  uint32_t shown_[GFX_TILES_Y][GFX_TILES_X];
+  uint8_t  known_[GFX_TILES_Y][GFX_TILES_X];
+  Rect     rects_[GFX_MAX_RECTS];
+  uint8_t  nRects_ = 0, cur_ = 0, rowOff_ = 0;
+  uint16_t bounce_[GFX_BAND_PX];
+  GfxBand  band_;
+
+  int16_t tileW(uint8_t tx) const {
+    int16_t x = tx * GFX_TILE_W;
+    return x + GFX_TILE_W > w_ ? w_ - x : GFX_TILE_W;
+  }
+  int16_t tileH(uint8_t ty) const {
+    int16_t y = ty * GFX_TILE_H;
+    return y + GFX_TILE_H > h_ ? h_ - y : GFX_TILE_H;
+  }
+
+  // FNV-1a over the tile's pixels
+  static uint32_t hashTile(const uint16_t* p, int16_t stride, int16_t w, int16_t h) {
+    uint32_t hash = 2166136261u;
+    for (int16_t y = 0; y < h; y++, p += stride)
+      for (int16_t x = 0; x < w; x++) hash = (hash ^ p[x]) * 16777619u;
+    return hash;
+  }
+
+  bool tileDirty(uint8_t tx, uint8_t ty) const {
+    if (!known_[ty][tx]) return true;
+    const uint16_t* p = &fb_[ty * GFX_TILE_H * w_ + tx * GFX_TILE_W];
+    return hashTile(p, w_, tileW(tx), tileH(ty)) != shown_[ty][tx];
+  }
+
+  // Dirty tiles [x0, x1) on row ty. Grows a rect from the row above
+  // with the same span, else starts one; when the table is full the
+  // last rect swallows the run.
+  void addRun(uint8_t x0, uint8_t x1, uint8_t ty, uint8_t open0, uint8_t openEnd) {
+    for (uint8_t i = open0; i < openEnd; i++) {
+      Rect& r = rects_[i];
+      if (r.x == x0 && r.w == x1 - x0 && r.y + r.h == ty) { r.h++; return; }
+    }
+    if (nRects_ < GFX_MAX_RECTS) {
+      rects_[nRects_++] = { x0, ty, (int16_t)(x1 - x0), 1 };
+      return;
+    }
+    Rect& r = rects_[nRects_ - 1];
+    int16_t rx1 = r.x + r.w;
+    if (x0 < r.x) r.x = x0;
+    r.w = (rx1 > x1 ? rx1 : x1) - r.x;
+    r.h = ty + 1 - r.y;
+  }
+
+  // Tile units → pixels, clipped to the canvas
+  Rect pixels(const Rect& t) const {
+    Rect r = { (int16_t)(t.x * GFX_TILE_W), (int16_t)(t.y * GFX_TILE_H),
+               (int16_t)(t.w * GFX_TILE_W), (int16_t)(t.h * GFX_TILE_H) };
+    if (r.x + r.w > w_) r.w = w_ - r.x;
+    if (r.y + r.h > h_) r.h = h_ - r.y;
+    return r;
+  }
+};
@@ -0,0 +1,568 @@
+// ============================================================
+// tiga_history.h — crash-safe per-second health history in flash
+// ============================================================
+// Until now HealthData / DailyData lived only in RAM: deep sleep,
+// a brownout or resetSession() lost them, and exportSession()'s
+// Serial text was the only copy. This keeps one sample per second
+// (HR, SpO2, steps, altitude, battery, worn) in an append-only log
+// across a dedicated flash partition, used as a ring.
+//
+// ── Layout ───────────────────────────────────────────────────
+// The partition is a ring of 4 KB sectors, each opened with a
+// 16-byte header (all little-endian):
+//     [0-1]   magic     "TH"
+//     [2]     version   HIST_VERSION
+//     [3]     hdrSize   16
+//     [4-7]   seq       uint32, +1 per sector opened
+//     [8-11]  t0        time of the sector's first sample
+//     [12-13] reserved  0xFFFF
+//     [14-15] crc16     over bytes 0-13
+//
+// then blocks, one per HIST_BLOCK_SAMPLES seconds:
+//     [0-1]   len       payload bytes; 0xFFFF = nothing written yet
+//     [2..]   payload   records
+//     [+len]  crc16     over len and payload
+//
+// A record is a mask byte plus a zigzag varint per changed field,
+// each a delta from the record before it:
+//     bit 0-4  hr, spo2, battery, steps, altitude (dm) changed
+//     bit 5    worn
+//     bit 6    time step is not 1 s — varint seconds follow
+// A quiet second is 1 byte, a walking one 2-3. Deltas restart from
+// zero in every sector, so any sector decodes on its own.
+//
+// ── Crash safety ─────────────────────────────────────────────
+// Flash is only ever appended to. A block is written in one go and
+// only counts once its CRC checks, so a power cut at any byte
+// leaves either the whole block or a torn tail that recovery
+// stops at. The sector holding a torn block is sealed and writing
+// moves on to a fresh one. A torn sector header fails its CRC and
+// the sector is treated as free. Samples still in RAM (at most
+// HIST_BLOCK_SAMPLES seconds) are what a cut can lose.
+//
+// begin() recovers by reading every sector header and decoding
+// only the newest sector. Sectors carry their seq and t0, so seek()
+// is a binary search over headers plus a scan of one sector.
+//
+// ── Erasing ──────────────────────────────────────────────────
+// A sector erase blocks the CPU for ~45 ms. prepare() erases
+// ahead of the write pointer — HIST_ERASE_AHEAD sectors, at most a
+// quarter of the ring (one on a tiny ring), oldest data first once
+// the ring is full —
+// so it can be called where a stall doesn't matter: boot, sleep,
+// session reset. If the reserve runs dry the erase happens inside
+// flush() and is counted in forcedErases.
+//
+// Timestamps should only move forward (time() on the ESP32 keeps
+// counting through deep sleep). A step backwards, e.g. a reboot
+// before NTP, closes the sector so each sector stays in order.
+// ============================================================
+
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+
+#define HIST_VERSION        1
+#define HIST_SECTOR         4096
+#define HIST_SECTOR_HDR     16
+#define HIST_BLOCK_SAMPLES  30        // one flash write per 30 s
+#define HIST_REC_MAX        22        // mask + 6 varints, worst case
+#define HIST_BLOCK_MAX      (HIST_BLOCK_SAMPLES * HIST_REC_MAX)
+#define HIST_BLOCK_FRAME    4         // len + crc16
+#define HIST_ERASE_AHEAD    32        // 128 KB ≈ 14 h of walking, a day of mixed wear
+
+struct HistSample {
+  uint32_t t;          // seconds (Unix time once NTP has set the clock)
+  uint8_t  hr;         // bpm, 0 = no reading
+  uint8_t  spo2;       // %, 0 = no reading
+  uint8_t  battery;    // %
+  bool     worn;
+  int32_t  steps;
+  int32_t  altDm;      // altitude, decimetres
+};
+
+inline bool operator==(const HistSample& a, const HistSample& b) {
+  return a.t == b.t && a.hr == b.hr && a.spo2 == b.spo2 && a.battery == b.battery &&
+         a.worn == b.worn && a.steps == b.steps && a.altDm == b.altDm;
+}
+
+// ── Encoding ─────────────────────────────────────────────────
+inline uint16_t histCrc16(uint16_t crc, const uint8_t* p, uint32_t n) {   // CCITT
+  while (n--) {
+    crc ^= (uint16_t)(*p++) << 8;
+    for (uint8_t b = 0; b < 8; b++) crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+  }
+  return crc;
+}
+
+inline uint32_t histZig(int32_t v)   { return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31); }
+inline int32_t  histUnzig(uint32_t v) { return (int32_t)(v >> 1) ^ -(int32_t)(v & 1); }
+
+inline uint8_t* histPutVarint(uint8_t* p, uint32_t v) {
+  while (v >= 0x80) { *p++ = (uint8_t)(v | 0x80); v >>= 7; }
+  *p++ = (uint8_t)v;
+  return p;
+}
+
+// nullptr if the varint runs past end
+inline const uint8_t* histGetVarint(const uint8_t* p, const uint8_t* end, uint32_t* v) {
+  uint32_t x = 0;
+  for (uint8_t shift = 0; shift < 35; shift += 7) {
+    if (p >= end) return nullptr;
+    uint8_t b = *p++;
+    x |= (uint32_t)(b & 0x7F) << shift;
+    if (!(b & 0x80)) { *v = x; return p; }
+  }
+  return nullptr;
+}
+
+// The state a sector's deltas start from
+inline HistSample histSectorBase(uint32_t t0) {
+  HistSample s;
+  memset(&s, 0, sizeof(s));
+  s.t = t0 - 1;
+  return s;
+}
+
+inline uint8_t* histEncode(uint8_t* p, const HistSample& s, const HistSample& prev) {
+  int32_t d[5] = { s.hr - prev.hr, s.spo2 - prev.spo2, s.battery - prev.battery,
+                   s.steps - prev.steps, s.altDm - prev.altDm };
+  uint32_t dt = s.t - prev.t;
+  uint8_t mask = 0;
+  for (uint8_t i = 0; i < 5; i++) if (d[i]) mask |= 1 << i;
+  if (s.worn)  mask |= 1 << 5;
+  if (dt != 1) mask |= 1 << 6;
+  *p++ = mask;
+  if (dt != 1) p = histPutVarint(p, dt);
+  for (uint8_t i = 0; i < 5; i++) if (d[i]) p = histPutVarint(p, histZig(d[i]));
+  return p;
+}
+
+// s holds the previous sample on entry; nullptr on a bad record
+inline const uint8_t* histDecode(const uint8_t* p, const uint8_t* end, HistSample& s) {
+  if (p >= end || (*p & 0x80)) return nullptr;
+  uint8_t  mask = *p++;
+  uint32_t v = 1;
+  if (mask & (1 << 6) && !(p = histGetVarint(p, end, &v))) return nullptr;
+  s.t   += v;
+  s.worn = mask & (1 << 5);
+  int32_t d[5] = { 0, 0, 0, 0, 0 };
+  for (uint8_t i = 0; i < 5; i++) {
+    if (!(mask & (1 << i))) continue;
+    if (!(p = histGetVarint(p, end, &v))) return nullptr;
+    d[i] = histUnzig(v);
+  }
+  s.hr      = (uint8_t)(s.hr + d[0]);
+  s.spo2    = (uint8_t)(s.spo2 + d[1]);
+  s.battery = (uint8_t)(s.battery + d[2]);
+  s.steps  += d[3];
+  s.altDm  += d[4];
+  return p;
+}
+
+// ── Flash access ─────────────────────────────────────────────
+// Offsets are partition-relative. erase() clears one HIST_SECTOR.
+struct HistFlash {
+  uint32_t size;
+  bool (*read)(uint32_t off, void* dst, uint32_t n);
+  bool (*write)(uint32_t off, const void* src, uint32_t n);
+  bool (*erase)(uint32_t off);
+};
+
+// Read position for seek() / next()
+struct HistCursor {
+  uint16_t   sector;
+  uint32_t   seq;
+  uint16_t   off;                // next block in the sector
+  uint16_t   pos, len;           // within buf
+  HistSample state;
+  bool       staged;             // state is a sample not yet returned
+  uint8_t    buf[HIST_BLOCK_MAX];
+};
+
+// ── Store ────────────────────────────────────────────────────
+class HistoryStore {
+public:
+  // Counters since begin()
+  uint32_t samplesIn     = 0;
+  uint32_t samplesLost   = 0;    // pending buffer full and flash failing
+  uint32_t blocksOut     = 0;
+  uint32_t flushFails    = 0;
+  uint32_t sectorsOpened = 0;
+  uint32_t erases        = 0;
+  uint32_t forcedErases  = 0;    // erased inside flush(): a ~45 ms stall
+  uint32_t tornFound     = 0;    // torn blocks met by begin()
+  uint64_t recordBytes   = 0;    // encoded samples
+  uint64_t flashBytes    = 0;    // everything programmed: headers, framing, records
+  uint32_t recoverReads  = 0;    // bytes begin() read
+
+  // Scan the partition and pick up where the last run stopped
+  bool begin(const HistFlash& f) {
+    f_ = f;
+    n_ = (uint16_t)(f.size / HIST_SECTOR);
+    nPending_ = 0;
+    backwards_ = false;
+    has_ = false;
+    count_ = 0;
+    headOpen_ = false;
+    reserve_ = 0;
+    samplesIn = samplesLost = blocksOut = flushFails = sectorsOpened = 0;
+    erases = forcedErases = tornFound = recoverReads = 0;
+    recordBytes = flashBytes = 0;
+    if (n_ < 3 || !f.read || !f.write || !f.erase) { n_ = 0; return false; }
+
+    bool     any = false;
+    uint32_t maxSeq = 0, minSeq = 0;
+    uint16_t head = 0, tail = 0;
+    for (uint16_t i = 0; i < n_; i++) {
+      uint32_t seq, t0;
+      if (!readHeader(i, &seq, &t0)) continue;
+      if (!any || seq > maxSeq) { maxSeq = seq; head = i; }
+      if (!any || seq < minSeq) { minSeq = seq; tail = i; }
+      any = true;
+    }
+    if (!any) {
+      head_ = n_ - 1;             // first sector opened will be 0
+      headSeq_ = 0;
+    } else {
+      head_    = head;
+      headSeq_ = maxSeq;
+      tail_    = tail;
+      count_   = (uint16_t)((head - tail + n_) % n_ + 1);
+      recoverHead();
+    }
+
+    // Blank sectors already waiting after the head
+    while (reserve_ < reserveTarget() && !isLive(ahead(reserve_)) && isBlank(ahead(reserve_)))
+      reserve_++;
+    return true;
+  }
+
+  bool ready() const { return n_ != 0; }
+
+  // Buffer one sample; every HIST_BLOCK_SAMPLES it goes to flash.
+  // False if the sample or an earlier block couldn't be stored.
+  bool append(const HistSample& s) {
+    if (!n_) return false;
+    if (has_ && s.t < last_.t) {            // clock went back
+      flush();
+      backwards_ = true;
+    }
+    if (nPending_ == HIST_BLOCK_SAMPLES && !flush()) {
+      samplesLost++;
+      return false;
+    }
+    pending_[nPending_++] = s;
+    last_ = s;
+    has_  = true;
+    samplesIn++;
+    return nPending_ < HIST_BLOCK_SAMPLES || flush();
+  }
+
+  // Write out whatever is buffered, e.g. before deep sleep
+  bool flush() {
+    if (!n_ || nPending_ == 0) return true;
+    uint16_t len = 0;
+    if (headOpen_ && !backwards_) len = encode(wstate_);
+    if (!headOpen_ || backwards_ || headOff_ + HIST_BLOCK_FRAME + len > HIST_SECTOR) {
+      if (!openSector(pending_[0].t)) { flushFails++; return false; }
+      len = encode(wstate_);
+    }
+
+    // len, payload, crc — a single program operation
+    block_[0] = (uint8_t)len;
+    block_[1] = (uint8_t)(len >> 8);
+    uint16_t crc = histCrc16(0xFFFF, block_, 2 + len);
+    block_[2 + len] = (uint8_t)crc;
+    block_[3 + len] = (uint8_t)(crc >> 8);
+    if (!f_.write(sectorOff(head_) + headOff_, block_, len + HIST_BLOCK_FRAME)) {
+      headOpen_ = false;                  // whatever landed is torn; seal
+      flushFails++;
+      return false;
+    }
+    headOff_    += len + HIST_BLOCK_FRAME;
+    wstate_      = pending_[nPending_ - 1];
+    nPending_    = 0;
+    blocksOut++;
+    recordBytes += len;
+    flashBytes  += len + HIST_BLOCK_FRAME;
+    return true;
+  }
+
+  // Erase up to maxErases sectors ahead of the write pointer.
+  // Each one blocks ~45 ms; returns how many were done.
+  uint8_t prepare(uint8_t maxErases) {
+    uint8_t done = 0;
+    while (n_ && done < maxErases && reserve_ < reserveTarget()) {
+      uint16_t e = ahead(reserve_);
+      if (!f_.erase(sectorOff(e))) break;
+      if (count_ && e == tail_) {         // oldest data goes
+        tail_ = (uint16_t)((tail_ + 1) % n_);
+        count_--;
+      }
+      reserve_++;
+      erases++;
+      done++;
+    }
+    return done;
+  }
+
+  uint8_t  reserve() const  { return reserve_; }
+  uint16_t sectors() const  { return n_; }
+  uint16_t used() const     { return count_; }
+  uint16_t pending() const  { return nPending_; }
+  bool     empty() const    { return !count_ && !nPending_; }
+  const HistSample& last() const { return last_; }   // newest, flushed or not; valid unless empty()
+
+  // Oldest time still in flash
+  bool firstTime(uint32_t* t) {
+    uint32_t seq;
+    return count_ && readHeader(tail_, &seq, t);
+  }
+
+  // ── Reading ──
+  // Position c at the first flashed sample at or after t (or the
+  // oldest there is). flush() first to include the last seconds.
+  bool seek(uint32_t t, HistCursor& c) {
+    if (!count_) return false;
+    uint16_t lo = 0, hi = count_ - 1;     // last sector with t0 <= t
+    uint32_t seq, t0;
+    while (lo < hi) {
+      uint16_t mid = (uint16_t)((lo + hi + 1) / 2);
+      if (!readHeader(at(mid), &seq, &t0)) return false;
+      if (t0 <= t) lo = mid;
+      else         hi = mid - 1;
+    }
+    if (!loadSector(c, at(lo), 0, false)) return false;
+    HistSample s;
+    while (next(c, s)) {
+      if (s.t >= t) {
+        c.state  = s;
+        c.staged = true;
+        return true;
+      }
+    }
+    return false;
+  }
+
+  bool seekOldest(HistCursor& c) { return count_ && loadSector(c, tail_, 0, false); }
+
+  // Next sample; false at the end of what is in flash. A cursor
+  // at the end picks up blocks flushed later.
+  bool next(HistCursor& c, HistSample& out) {
+    if (c.staged) { c.staged = false; out = c.state; return true; }
+    for (;;) {
+      if (c.pos < c.len) {
+        const uint8_t* p = histDecode(c.buf + c.pos, c.buf + c.len, c.state);
+        if (p) {
+          c.pos = (uint16_t)(p - c.buf);
+          out = c.state;
+          return true;
+        }
+        c.len = 0;                        // bad record: rest of block lost
+      }
+      uint16_t len;
+      int8_t r = readBlock(c.sector, c.off, c.buf, &len);
+      if (r > 0) {
+        c.off += len + HIST_BLOCK_FRAME;
+        c.pos  = 0;
+        c.len  = len;
+        continue;
+      }
+      // End of this sector: on to the next only if it follows on
+      uint16_t nx = (uint16_t)((c.sector + 1) % n_);
+      if (r == 0 && c.sector == head_ && headOpen_) return false;
+      if (!loadSector(c, nx, c.seq + 1, true)) return false;
+    }
+  }
+
+private:
+  HistFlash  f_ = { 0, nullptr, nullptr, nullptr };
+  uint16_t   n_ = 0;
+  uint16_t   head_ = 0, tail_ = 0, count_ = 0;
+  uint32_t   headSeq_ = 0;
+  uint16_t   headOff_ = 0;
+  bool       headOpen_ = false;
+  uint8_t    reserve_ = 0;
+  HistSample wstate_;                     // last sample in the head sector
+  HistSample last_;
+  bool       has_ = false;
+  bool       backwards_ = false;
+  HistSample pending_[HIST_BLOCK_SAMPLES];
+  uint16_t   nPending_ = 0;
+  uint8_t    block_[HIST_BLOCK_MAX + HIST_BLOCK_FRAME];
+
+  uint32_t sectorOff(uint16_t i) const { return (uint32_t)i * HIST_SECTOR; }
+  uint16_t ahead(uint8_t k) const      { return (uint16_t)((head_ + 1 + k) % n_); }   // k-th after the head
+  uint16_t at(uint16_t k) const        { return (uint16_t)((tail_ + k) % n_); }   // k-th oldest
+  uint8_t  reserveTarget() const {
+    uint16_t q = n_ / 4 ? n_ / 4 : 1;
+    return q < HIST_ERASE_AHEAD ? (uint8_t)q : HIST_ERASE_AHEAD;
+  }
+
+  bool isLive(uint16_t i) const {
+    return count_ && (uint16_t)((i - tail_ + n_) % n_) < count_;
+  }
+
+  bool readHeader(uint16_t i, uint32_t* seq, uint32_t* t0) {
+    uint8_t h[HIST_SECTOR_HDR];
+    if (!f_.read(sectorOff(i), h, sizeof(h))) return false;
+    recoverReads += sizeof(h);
+    if (h[0] != 'T' || h[1] != 'H' || h[2] != HIST_VERSION || h[3] != HIST_SECTOR_HDR) return false;
+    if (histCrc16(0xFFFF, h, 14) != (uint16_t)(h[14] | h[15] << 8)) return false;
+    *seq = (uint32_t)h[4] | (uint32_t)h[5] << 8 | (uint32_t)h[6] << 16 | (uint32_t)h[7] << 24;
+    *t0  = (uint32_t)h[8] | (uint32_t)h[9] << 8 | (uint32_t)h[10] << 16 | (uint32_t)h[11] << 24;
+    return true;
+  }
+
+  bool isBlank(uint16_t i) {
+    uint8_t buf[256];
+    for (uint32_t o = 0; o < HIST_SECTOR; o += sizeof(buf)) {
+      if (!f_.read(sectorOff(i) + o, buf, sizeof(buf))) return false;
+      recoverReads += sizeof(buf);
+      for (uint16_t k = 0; k < sizeof(buf); k++) if (buf[k] != 0xFF) return false;
+    }
+    return true;
+  }
+
+  // 1 = block read and checked, 0 = nothing written here yet,
+  // -1 = torn or unreadable
+  int8_t readBlock(uint16_t sector, uint16_t off, uint8_t* buf, uint16_t* lenOut) {
+    uint8_t lb[2];
+    if (off + HIST_BLOCK_FRAME > HIST_SECTOR) return 0;
+    if (!f_.read(sectorOff(sector) + off, lb, 2)) return -1;
+    uint16_t len = (uint16_t)(lb[0] | lb[1] << 8);
+    if (len == 0xFFFF) return 0;
+    if (len == 0 || len > HIST_BLOCK_MAX || off + HIST_BLOCK_FRAME + len > HIST_SECTOR) return -1;
+    uint8_t cb[2];
+    if (!f_.read(sectorOff(sector) + off + 2, buf, len) ||
+        !f_.read(sectorOff(sector) + off + 2 + len, cb, 2)) return -1;
+    uint16_t crc = histCrc16(histCrc16(0xFFFF, lb, 2), buf, len);
+    if (crc != (uint16_t)(cb[0] | cb[1] << 8)) return -1;
+    *lenOut = len;
+    return 1;
+  }
+
+  bool loadSector(HistCursor& c, uint16_t i, uint32_t wantSeq, bool checkSeq) {
+    uint32_t seq, t0;
+    if (!readHeader(i, &seq, &t0) || (checkSeq && seq != wantSeq)) return false;
+    c.sector = i;
+    c.seq    = seq;
+    c.off    = HIST_SECTOR_HDR;
+    c.pos    = c.len = 0;
+    c.state  = histSectorBase(t0);
+    c.staged = false;
+    return true;
+  }
+
+  // Replay the newest sector to find the write point and delta base
+  void recoverHead() {
+    uint32_t seq = 0, t0 = 0;
+    readHeader(head_, &seq, &t0);
+    wstate_  = histSectorBase(t0);
+    headOff_ = HIST_SECTOR_HDR;
+    headOpen_ = true;
+    for (;;) {
+      uint16_t len;
+      int8_t r = readBlock(head_, headOff_, block_, &len);
+      if (r == 0) break;
+      recoverReads += len + HIST_BLOCK_FRAME;
+      HistSample s = wstate_;
+      const uint8_t* p = block_;
+      const uint8_t* end = block_ + len;
+      while (r > 0 && p < end) {
+        p = histDecode(p, end, s);
+        if (!p) r = -1;
+      }
+      if (r < 0) {                        // torn: seal, write on elsewhere
+        tornFound++;
+        headOpen_ = false;
+        break;
+      }
+      wstate_   = s;
+      headOff_ += len + HIST_BLOCK_FRAME;
+    }
+    last_ = wstate_;                      // for the clock-went-back check
+    has_  = true;
+  }
+
+  bool openSector(uint32_t t0) {
+    if (reserve_ == 0) {
+      if (!prepare(1)) return false;
+      forcedErases++;
+    }
+    uint16_t s = ahead(0);
+    reserve_--;
+
+    uint8_t h[HIST_SECTOR_HDR];
+    uint32_t seq = headSeq_ + 1;
+    h[0] = 'T'; h[1] = 'H'; h[2] = HIST_VERSION; h[3] = HIST_SECTOR_HDR;
+    for (uint8_t i = 0; i < 4; i++) {
+      h[4 + i] = (uint8_t)(seq >> (8 * i));
+      h[8 + i] = (uint8_t)(t0 >> (8 * i));
+    }
+    h[12] = h[13] = 0xFF;
+    uint16_t crc = histCrc16(0xFFFF, h, 14);
+    h[14] = (uint8_t)crc;
+    h[15] = (uint8_t)(crc >> 8);
+
+    headOpen_ = false;
+    if (!f_.write(sectorOff(s), h, sizeof(h))) {
+      reserve_ = 0;                        // s is dirty now: erase it again first
+      return false;
+    }
+    head_    = s;
+    headSeq_ = seq;
+    if (!count_) tail_ = s;
+    count_++;
+    headOff_   = HIST_SECTOR_HDR;
+    headOpen_  = true;
+    backwards_ = false;
+    wstate_    = histSectorBase(t0);
+    sectorsOpened++;
+    flashBytes += HIST_SECTOR_HDR;
+    return true;
+  }
+
+  uint16_t encode(const HistSample& base) {
+    uint8_t* p = block_ + 2;
+    HistSample prev = base;
+    for (uint16_t i = 0; i < nPending_; i++) {
+      p = histEncode(p, pending_[i], prev);
+      prev = pending_[i];
+    }
+    return (uint16_t)(p - (block_ + 2));
+  }
+};
+
+// ── Device flash ─────────────────────────────────────────────
+#ifdef ARDUINO
+#include <esp_partition.h>
+
+// A data partition named "history" (subtype 0x41) in
+// partitions.csv, e.g.   history, data, 0x41, , 1M
+inline const esp_partition_t*& histPartition() {
+  static const esp_partition_t* part = nullptr;
+  return part;
+}
+
+inline bool histFlashRead(uint32_t off, void* dst, uint32_t n) {
+  return esp_partition_read(histPartition(), off, dst, n) == ESP_OK;
+}
+inline bool histFlashWrite(uint32_t off, const void* src, uint32_t n) {
+  return esp_partition_write(histPartition(), off, src, n) == ESP_OK;
+}
+inline bool histFlashErase(uint32_t off) {
+  return esp_partition_erase_range(histPartition(), off, HIST_SECTOR) == ESP_OK;
+}
+
+inline bool historyFlashBegin(HistFlash* out) {
+  const esp_partition_t*& part = histPartition();
+  part = esp_partition_find_first(ESP_PARTITION_TYPE_DATA,
+                                  (esp_partition_subtype_t)0x41, "history");
+  if (!part) return false;
+  *out = { part->size - part->size % HIST_SECTOR, histFlashRead, histFlashWrite, histFlashErase };
+  return true;
+}
+#endif
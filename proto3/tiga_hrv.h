@@ -0,0 +1,322 @@
+// ============================================================
+// tiga_hrv.h — beat-to-beat intervals and HRV for TIGA v6a
+// ============================================================
+// Heart rate variability from the PPG stream: each beat timed to
+// a fraction of a sample, intervals that can't be normal beats
+// thrown out, and the standard short-term measures over rolling
+// windows:
+//
+//   RMSSD   root mean square of successive interval differences
+//   SDNN    standard deviation of the intervals
+//   pNN50   % of successive differences over 50 ms
+//
+// ── Beat time ────────────────────────────────────────────────
+// checkForBeat() only says which sample a beat was noticed on —
+// 10 ms steps at 100 Hz, as coarse as the RMSSD of a resting
+// older adult — and it fires again on a strong dicrotic notch.
+// So push() times beats itself, at the steepest point of the
+// pulse's upstroke: IR counts fall as blood arrives, and that
+// edge is the sharpest, most repeatable part of the wave.
+//
+//   slope     Σ x[k-j] - x[k+j], j = 1..10: a differentiator
+//             over the whole edge that averages out sample noise
+//             (100 ms delay)
+//   beat      each run of positive slope that gets above half
+//             the recent beats' slope, at least HRV_RR_MIN_MS
+//             after the last one, timed at the centroid of the
+//             part above (slope less threshold as weight) —
+//             every sample of the edge votes, where the single
+//             steepest one sits on a flat top and wanders with
+//             the noise
+//   level     follows the beats' slope (1/8 per beat) and halves
+//             after HRV_RR_MAX_MS with no beat, so it re-finds a
+//             weaker pulse after a knock. Once locked on, a beat
+//             over HRV_JUMP × level is movement, not a pulse
+//
+// ── Rejection ────────────────────────────────────────────────
+// An interval counts as normal-to-normal (NN) when it is within
+// HRV_RR_MIN_MS..HRV_RR_MAX_MS and within HRV_TOLERANCE of the
+// median of the last HRV_REF accepted ones. An ectopic beat
+// (short, then a compensatory long interval), a missed beat
+// (double length) and motion artefact all fail that. After
+// HRV_RELOCK rejections in a row the reference is dropped, so a
+// real change of rate is picked up again. A successive
+// difference is only taken between two NN intervals in a row.
+// A gap in the samples (finger off, FIFO overflow) ends the
+// chain the same way. A new reference needs HRV_SEED intervals
+// that agree with each other before anything counts, so a burst
+// of movement can't seed it.
+//
+// ── Windows ──────────────────────────────────────────────────
+// NN intervals are summed into HRV_BUCKET_S buckets by the time
+// of the beat that ends them: count, Σrr, Σrr², Σ(Δrr)², count
+// over 50 ms — integers in µs, so nothing drifts. stats() merges
+// the newest buckets: 6 for one minute, 30 for five, each
+// covering the current bucket and the whole ones before it.
+// Memory: 30 buckets × 32 B + a 32-sample ring, no heap. O(1)
+// per sample and per beat, O(buckets) per stats().
+//
+// Accuracy against known interval series through a synthetic
+// PPG: host/bench_hrv.cpp.
+// ============================================================
+
+#pragma once
+
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+
+// ── Config ───────────────────────────────────────────────────
+#define HRV_SLOPE_SPAN     10        // slope over ±10 samples (±100 ms at 100 Hz)
+#define HRV_RING           32        // samples kept, power of two
+#define HRV_RR_MIN_MS      300       // 200 bpm; also the refractory time
+#define HRV_RR_MAX_MS      2000      // 30 bpm
+#define HRV_JUMP           2         // beat slope over this × level_ is movement
+#define HRV_TOLERANCE      0.20f     // vs the reference interval
+#define HRV_REF            5         // accepted intervals in the reference median
+#define HRV_RELOCK         4         // rejections in a row drop the reference
+#define HRV_SEED           3         // agreeing intervals before a reference counts
+#define HRV_NN50_US        50000
+#define HRV_BUCKET_S       10
+#define HRV_BUCKETS        30        // 5 minutes
+#define HRV_SHORT_BUCKETS  6         // 1 minute
+
+static_assert((HRV_RING & (HRV_RING - 1)) == 0, "HRV_RING must be a power of two");
+
+struct HrvStats {
+  uint16_t nn;              // intervals in the window
+  uint16_t diffs;           // successive differences
+  float    meanRrMs;
+  float    sdnnMs;
+  float    rmssdMs;
+  float    pnn50;           // %
+  bool     valid;           // enough of the window had clean beats
+};
+
+class HrvTracker {
+public:
+  // Counters
+  uint32_t beats;           // beats timed
+  uint32_t accepted;        // intervals kept as NN
+  uint32_t rejected;        // out of range or too far from the reference
+  uint32_t gaps;            // sample gaps that broke the chain
+  float    lastRrMs;        // newest NN interval, 0 = none yet
+
+  explicit HrvTracker(uint16_t sampleHz)
+    : hz_(sampleHz),
+      refractory_((uint32_t)HRV_RR_MIN_MS * sampleHz / 1000),
+      lost_((uint32_t)HRV_RR_MAX_MS * sampleHz / 1000),
+      bucketSamples_((uint32_t)HRV_BUCKET_S * sampleHz) {
+    reset();
+  }
+
+  void reset() {
+    memset(bucket_, 0, sizeof(bucket_));
+    for (HrvBucket& b : bucket_) b.id = UINT32_MAX;
+    beats = accepted = rejected = gaps = 0;
+    lastRrMs = 0;
+    restart(0);
+  }
+
+  // Every PPG sample in order: raw IR and its sample index. A
+  // jump in the index (samples lost, or not pushed while the
+  // finger was off) starts the detector again.
+  void push(int32_t ir, uint32_t idx) {
+    if (fill_ && idx != lastIdx_ + 1) {
+      gaps++;
+      restart(idx);
+    }
+    lastIdx_ = idx;
+    x_[idx & (HRV_RING - 1)] = ir;
+    if (fill_ <= 2 * HRV_SLOPE_SPAN) { fill_++; return; }
+
+    // Slope at k, HRV_SLOPE_SPAN samples back: positive while IR falls
+    uint32_t k = idx - HRV_SLOPE_SPAN;
+    int32_t s = 0;
+    for (uint8_t j = 1; j <= HRV_SLOPE_SPAN; j++) s += x(k - j) - x(k + j);
+
+    if (k - lastPeak_ > lost_ && level_ > 1) {  // nothing for a while: lower the bar
+      level_ /= 2;
+      lastPeak_ = k;
+    }
+    // A run starts above the threshold and lasts while IR falls
+    int32_t thr = level_ / 2;
+    if (inRun_ ? s > 0 : s > thr) {
+      if (!inRun_) {
+        inRun_ = true;
+        runStart_ = k;
+        runMax_ = 0;
+        runW_ = runWk_ = 0;
+      }
+      if (s > runMax_) runMax_ = s;
+      if (s > thr) {
+        runW_  += s - thr;
+        runWk_ += (int64_t)(s - thr) * (k - runStart_);
+      }
+      return;
+    }
+    if (!inRun_) return;
+    inRun_ = false;
+    float at = (float)runWk_ / (float)runW_;
+    uint32_t whole = runStart_ + (uint32_t)at;
+    if (haveBeat_ && whole - beatIdx_ < refractory_) return;
+    beat(whole, at - (uint32_t)at, runMax_);
+  }
+
+  // Statistics over the newest `buckets` buckets as of sample
+  // `nowIdx`. Valid with NN intervals covering half the window
+  // and half of those in successive pairs.
+  HrvStats stats(uint32_t nowIdx, uint8_t buckets) const {
+    uint32_t now = nowIdx / bucketSamples_;
+    uint32_t n = 0, nd = 0, nn50 = 0;
+    uint64_t s1 = 0, s2 = 0, d2 = 0;
+    for (const HrvBucket& b : bucket_) {
+      if (b.id == UINT32_MAX || b.id > now || now - b.id >= buckets) continue;
+      n += b.n; nd += b.nd; nn50 += b.nn50;
+      s1 += b.sum; s2 += b.sum2; d2 += b.sumD2;
+    }
+    HrvStats r = {};
+    r.nn    = (uint16_t)n;
+    r.diffs = (uint16_t)nd;
+    if (n >= 2) {
+      double mean = (double)s1 / n;
+      double var  = ((double)s2 - (double)s1 * mean) / (n - 1);
+      r.meanRrMs = (float)(mean / 1000);
+      r.sdnnMs   = (float)(sqrt(var > 0 ? var : 0) / 1000);
+    }
+    if (nd) {
+      r.rmssdMs = (float)(sqrt((double)d2 / nd) / 1000);
+      r.pnn50   = 100.0f * nn50 / nd;
+    }
+    // Half the window at the interval's own rate
+    float span = r.meanRrMs > 0 ? (float)buckets * HRV_BUCKET_S * 1000 / r.meanRrMs : 0;
+    r.valid = n >= 8 && n >= span / 2 && nd >= n / 2;
+    return r;
+  }
+
+private:
+  struct HrvBucket {
+    uint32_t id;            // beat sample / bucket length
+    uint16_t n, nd, nn50;
+    uint32_t sum;           // Σ rr, µs
+    uint64_t sum2;          // Σ rr², µs²
+    uint64_t sumD2;         // Σ Δrr², µs²
+  };
+
+  uint16_t  hz_;
+  uint32_t  refractory_;    // samples
+  uint32_t  lost_;          // samples without a beat before level_ halves
+  uint32_t  bucketSamples_;
+  int32_t   x_[HRV_RING];   // raw IR
+  uint8_t   fill_;
+  uint32_t  lastIdx_;
+  int32_t   level_;         // typical beat slope
+  bool      inRun_;
+  uint32_t  runStart_;
+  int32_t   runMax_;
+  int64_t   runW_, runWk_;  // Σ weight, Σ weight × offset in the run
+  uint32_t  lastPeak_;      // sample of the last beat, or of the last level drop
+  bool      haveBeat_;
+  uint32_t  beatIdx_;       // last beat: whole sample + fraction
+  float     beatFrac_;
+  uint32_t  ref_[HRV_REF];  // accepted intervals, µs, newest at refNext_
+  uint8_t   refCount_, refNext_;
+  uint8_t   misses_;        // rejections in a row
+  uint32_t  prevNN_;        // previous interval if it was NN, else 0
+  HrvBucket bucket_[HRV_BUCKETS];
+
+  int32_t x(uint32_t k) const { return x_[k & (HRV_RING - 1)]; }
+
+  void restart(uint32_t idx) {
+    fill_ = 0;
+    level_ = 0;
+    inRun_ = false;
+    haveBeat_ = false;
+    lastPeak_ = idx;
+    breakChain();
+  }
+
+  void breakChain() {
+    refCount_ = refNext_ = 0;
+    misses_ = 0;
+    prevNN_ = 0;
+  }
+
+  // A beat at sample k + frac, its run peaking at slope `peak`
+  void beat(uint32_t k, float frac, int32_t peak) {
+    lastPeak_ = k;
+    beats++;
+    if (refCount_ >= HRV_SEED && peak > HRV_JUMP * level_) {
+      // Locked on, and this is far steeper than the pulse:
+      // movement. No interval either side of it; level_ still
+      // creeps up in case the pulse itself got stronger
+      level_ += level_ / 8;
+      haveBeat_ = false;
+      reject();
+      return;
+    }
+    level_ = level_ ? level_ + (peak - level_) / 8 : peak;
+    if (haveBeat_) interval(((float)(k - beatIdx_) + (frac - beatFrac_)) * 1000.0f / hz_, k);
+    beatIdx_  = k;
+    beatFrac_ = frac;
+    haveBeat_ = true;
+  }
+
+  uint32_t reference() const {
+    uint32_t v[HRV_REF];
+    memcpy(v, ref_, sizeof(v));
+    for (uint8_t i = 1; i < refCount_; i++)            // insertion sort, ≤ 5
+      for (uint8_t j = i; j > 0 && v[j] < v[j - 1]; j--) {
+        uint32_t t = v[j]; v[j] = v[j - 1]; v[j - 1] = t;
+      }
+    return v[refCount_ / 2];
+  }
+
+  void interval(float rrMs, uint32_t k) {
+    if (rrMs < HRV_RR_MIN_MS || rrMs > HRV_RR_MAX_MS) { reject(); return; }
+    uint32_t rr = (uint32_t)(rrMs * 1000 + 0.5f);
+    if (refCount_) {
+      uint32_t ref = reference();
+      uint32_t off = rr > ref ? rr - ref : ref - rr;
+      if (off > (uint32_t)(HRV_TOLERANCE * ref)) {
+        if (refCount_ >= HRV_SEED) { reject(); return; }
+        refCount_ = refNext_ = 0;                    // not settled: start again from this one
+      }
+    }
+    misses_ = 0;
+    ref_[refNext_] = rr;
+    refNext_ = (refNext_ + 1) % HRV_REF;
+    if (refCount_ < HRV_REF) refCount_++;
+    if (refCount_ < HRV_SEED) { prevNN_ = 0; return; }
+    accepted++;
+    lastRrMs = rrMs;
+
+    HrvBucket& b = bucketFor(k);
+    b.n++;
+    b.sum  += rr;
+    b.sum2 += (uint64_t)rr * rr;
+    if (prevNN_) {
+      uint32_t d = rr > prevNN_ ? rr - prevNN_ : prevNN_ - rr;
+      b.nd++;
+      b.sumD2 += (uint64_t)d * d;
+      if (d > HRV_NN50_US) b.nn50++;
+    }
+    prevNN_ = rr;
+  }
+
+  void reject() {
+    rejected++;
+    prevNN_ = 0;
+    if (++misses_ >= HRV_RELOCK) breakChain();
+  }
+
+  HrvBucket& bucketFor(uint32_t k) {
+    uint32_t id = k / bucketSamples_;
+    HrvBucket& b = bucket_[id % HRV_BUCKETS];
+    if (b.id != id) {
+      memset(&b, 0, sizeof(b));
+      b.id = id;
+    }
+    return b;
+  }
+};
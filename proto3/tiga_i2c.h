@@ -0,0 +1,328 @@
+// ============================================================
+// tiga_i2c.h — queued I2C engine for the shared sensor bus
+// ============================================================
+// MPU6050, MAX30102 and BMP280 share SDA 18 / SCL 17. Each driver
+// used to call Wire from its own task, recovery lived inside the
+// MPU reader, and a MAX30102 read hanging for Wire's 50 ms timeout
+// held IMU sampling up behind it. One engine now owns the bus:
+//
+//   devices   registered with an address, a priority (0 = first)
+//             and an init hook that configures the part from
+//             power-on state and says whether it answered
+//   jobs      a device's bus work (FIFO drain, slow reads). Sensor
+//             tasks post() them and return; run(), from a single
+//             bus task, executes the queue most urgent device
+//             first, oldest first within a device, until its
+//             budget is spent. A job posted again before it ran
+//             stays one job: a late drain reads everything anyway.
+//   transfers register reads and writes go through the engine:
+//             timed, counted, and after a NACK retried up to
+//             I2C_RETRIES times. On the device Wire's timeout is
+//             cut to I2C_TIMEOUT_MS and a timeout isn't retried, so
+//             a stretched clock costs a few ms, not 50.
+//   recovery  I2C_DOWN_AFTER failed jobs in a row take a device
+//             down and its queued jobs are dropped. After a
+//             backoff (I2C_BACKOFF_MIN_MS, doubling to
+//             I2C_BACKOFF_MAX_MS) the bus is recovered — stuck SDA
+//             clocked free, controller restarted — and the init
+//             hook runs again. A part missing at boot is retried
+//             the same way.
+//
+// Register-level parts (MPU6050 FIFO, MAX30102) use readRegs() /
+// writeReg(), burst-reading adjacent registers in one transfer.
+// Library-level access (Adafruit BMP280, the MPU6050 setup calls)
+// runs inside a job or init hook and reports trouble with fail().
+//
+// Per device: jobs, transfers, errors, retries, timeouts, times
+// down, re-inits, bytes, and latency from post() to the job done.
+//
+// Wire blocks, so a transfer still holds the core while it runs;
+// what the queue buys is order — the IMU drain is never behind a
+// slow part — and a bound on what a slow part can cost.
+//
+// Storage is static (I2C_MAX_DEVICES, I2C_QUEUE_DEPTH). No heap.
+// Host builds: the simulator's Wire stand-in injects NACKs,
+// clock stretching and a stuck SDA line (proto3/host).
+// ============================================================
+
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+
+#define I2C_BUS_HZ          400000    // fast mode — all three parts support it
+#define I2C_TIMEOUT_MS      5         // per transfer; a 96 B burst takes 2.3 ms
+#define I2C_RETRIES         1         // extra attempts per transfer
+#define I2C_DOWN_AFTER      3         // failed jobs in a row
+#define I2C_BACKOFF_MIN_MS  250
+#define I2C_BACKOFF_MAX_MS  30000
+#define I2C_BURST_MAX       128       // ESP32 Wire buffer
+#define I2C_MAX_DEVICES     4
+#define I2C_QUEUE_DEPTH     8
+
+typedef void (*I2cJobFn)();
+typedef bool (*I2cInitFn)();
+
+// The wire under the engine. write() with stop = false leaves the
+// bus held for the read that follows (repeated start).
+struct I2cBusOps {
+  bool     (*write)(uint8_t addr, const uint8_t* p, uint8_t n, bool stop);
+  bool     (*read)(uint8_t addr, uint8_t* p, uint8_t n);
+  void     (*recover)();      // free a stuck SDA, restart the controller
+  uint32_t (*nowUs)();
+  void     (*kick)();         // post() wants run() soon; nullptr = next period
+};
+
+struct I2cDevice {
+  const char* name;
+  uint8_t     addr;
+  uint8_t     priority;       // 0 = most urgent
+  I2cInitFn   init;
+  bool*       okFlag;         // kept equal to up, for code that reads a flag
+  bool        up;
+
+  // Recovery
+  uint8_t     failStreak;
+  uint32_t    backoffMs;
+  uint32_t    retryAtUs;
+
+  // Accounting
+  uint32_t    jobs;
+  uint32_t    dropped;        // jobs discarded while down
+  uint32_t    xfers;          // register-level attempts; library calls aren't seen
+  uint32_t    errors;         // transfers failed after retries, plus fail()
+  uint32_t    retries;
+  uint32_t    timeouts;       // attempts that ran into I2C_TIMEOUT_MS
+  uint32_t    downs;
+  uint32_t    reinits;        // successful inits after the first
+  uint32_t    bytes;
+  uint32_t    maxLatUs;
+  uint64_t    sumLatUs;
+};
+
+class I2cEngine {
+public:
+  explicit I2cEngine(const I2cBusOps& ops)
+    : recoveries(0), ops_(ops), count_(0), queued_(0), cur_(-1), jobFailed_(false) {}
+
+  // Returns the device id, or -1 when the table is full
+  int addDevice(const char* name, uint8_t addr, uint8_t priority,
+                I2cInitFn init, bool* okFlag = nullptr) {
+    if (count_ >= I2C_MAX_DEVICES) return -1;
+    I2cDevice& d = devs_[count_];
+    memset(&d, 0, sizeof(d));
+    d.name = name; d.addr = addr; d.priority = priority;
+    d.init = init; d.okFlag = okFlag;
+    setUp(d, false);
+    return count_++;
+  }
+
+  // Run a device's init hook now (boot). On failure the device is
+  // down and run() retries it after the first backoff.
+  bool start(int id) {
+    if (!valid(id)) return false;
+    I2cDevice& d = devs_[id];
+    bool ok = callInit(id);
+    if (ok) {
+      setUp(d, true);
+      d.failStreak = 0;
+    } else {
+      takeDown(d);
+    }
+    return ok;
+  }
+
+  // Queue a job for a device. Dropped when the device is down or
+  // the queue is full; a job already queued is left where it is.
+  bool post(int id, I2cJobFn fn) {
+    if (!valid(id) || !fn) return false;
+    I2cDevice& d = devs_[id];
+    if (!d.up) { d.dropped++; return false; }
+    for (uint8_t i = 0; i < queued_; i++) if (queue_[i].fn == fn) return true;
+    if (queued_ >= I2C_QUEUE_DEPTH) { d.dropped++; return false; }
+    queue_[queued_++] = { fn, (uint8_t)id, ops_.nowUs() };
+    if (ops_.kick) ops_.kick();
+    return true;
+  }
+
+  // Bring back devices whose backoff is over, then run queued jobs
+  // in priority order until the queue is empty or budgetUs (0 = no
+  // limit) is spent. Returns jobs run.
+  uint8_t run(uint32_t budgetUs = 0) {
+    uint32_t t0 = ops_.nowUs();
+    retryDown(t0);
+
+    uint8_t ran = 0;
+    while (queued_) {
+      uint8_t pick = 0;
+      for (uint8_t i = 1; i < queued_; i++)
+        if (devs_[queue_[i].dev].priority < devs_[queue_[pick].dev].priority) pick = i;
+      Job j = queue_[pick];
+      memmove(&queue_[pick], &queue_[pick + 1], (queued_ - pick - 1) * sizeof(Job));
+      queued_--;
+
+      I2cDevice& d = devs_[j.dev];
+      if (!d.up) { d.dropped++; continue; }
+      cur_ = j.dev;
+      jobFailed_ = false;
+      j.fn();
+      cur_ = -1;
+
+      uint32_t end = ops_.nowUs();
+      uint32_t lat = end - j.postedUs;
+      d.jobs++;
+      d.sumLatUs += lat;
+      if (lat > d.maxLatUs) d.maxLatUs = lat;
+      if (!d.up) {
+        // markDown() from inside the job
+      } else if (!jobFailed_) {
+        d.failStreak = 0;
+        d.backoffMs  = 0;
+      } else if (++d.failStreak >= I2C_DOWN_AFTER) {
+        takeDown(d);
+      }
+      ran++;
+      if (budgetUs && end - t0 >= budgetUs) break;
+    }
+    return ran;
+  }
+
+  // ── Transfers (from a job or an init hook) ──
+  // Read n ≤ I2C_BURST_MAX bytes from consecutive registers
+  bool readRegs(int id, uint8_t reg, uint8_t* buf, uint8_t n) {
+    return transfer(id, reg, nullptr, 0, buf, n);
+  }
+
+  bool writeReg(int id, uint8_t reg, uint8_t v) {
+    return transfer(id, reg, &v, 1, nullptr, 0);
+  }
+
+  // A library call inside the running job or init hook went wrong
+  // (NaN reading, dead samples): counts as a failed transfer
+  void fail(int id) {
+    if (!valid(id)) return;
+    devs_[id].errors++;
+    if (cur_ == id) jobFailed_ = true;
+  }
+
+  // Take a device down now, e.g. alive on the bus but returning
+  // nothing but zeros
+  void markDown(int id) {
+    if (!valid(id) || !devs_[id].up) return;
+    takeDown(devs_[id]);
+  }
+
+  // Clear accounting (session reset). Device state is kept.
+  void resetStats() {
+    for (uint8_t i = 0; i < count_; i++) {
+      I2cDevice& d = devs_[i];
+      d.jobs = d.dropped = d.xfers = d.errors = d.retries = d.timeouts = 0;
+      d.downs = d.reinits = d.bytes = d.maxLatUs = 0;
+      d.sumLatUs = 0;
+    }
+    recoveries = 0;
+  }
+
+  bool             up(int id) const { return valid(id) && devs_[id].up; }
+  uint8_t          count() const { return count_; }
+  const I2cDevice& device(uint8_t i) const { return devs_[i]; }
+  uint8_t          queued() const { return queued_; }
+
+  uint32_t recoveries;      // bus restarts (stuck SDA clocked free) before re-inits
+
+private:
+  struct Job {
+    I2cJobFn fn;
+    uint8_t  dev;
+    uint32_t postedUs;
+  };
+
+  I2cBusOps ops_;
+  I2cDevice devs_[I2C_MAX_DEVICES];
+  uint8_t   count_;
+  Job       queue_[I2C_QUEUE_DEPTH];
+  uint8_t   queued_;
+  int       cur_;           // device whose job or init is running
+  bool      jobFailed_;
+
+  bool valid(int id) const { return id >= 0 && id < count_; }
+
+  void setUp(I2cDevice& d, bool up) {
+    d.up = up;
+    if (d.okFlag) *d.okFlag = up;
+  }
+
+  bool callInit(int id) {
+    int prev = cur_;
+    cur_ = id;
+    jobFailed_ = false;
+    bool ok = devs_[id].init() && !jobFailed_;
+    cur_ = prev;
+    jobFailed_ = false;
+    return ok;
+  }
+
+  void takeDown(I2cDevice& d) {
+    bool wasUp = d.up;
+    setUp(d, false);
+    if (wasUp) d.downs++;
+    d.failStreak = 0;
+    d.backoffMs  = d.backoffMs ? d.backoffMs * 2 : I2C_BACKOFF_MIN_MS;
+    if (d.backoffMs > I2C_BACKOFF_MAX_MS) d.backoffMs = I2C_BACKOFF_MAX_MS;
+    d.retryAtUs  = ops_.nowUs() + d.backoffMs * 1000UL;
+    uint8_t id = (uint8_t)(&d - devs_);
+    uint8_t keep = 0;
+    for (uint8_t i = 0; i < queued_; i++) {
+      if (queue_[i].dev == id) d.dropped++;
+      else queue_[keep++] = queue_[i];
+    }
+    queued_ = keep;
+  }
+
+  // One bus recovery covers every device due this run
+  void retryDown(uint32_t now) {
+    bool recovered = false;
+    for (uint8_t i = 0; i < count_; i++) {
+      I2cDevice& d = devs_[i];
+      if (d.up || (int32_t)(now - d.retryAtUs) < 0) continue;
+      if (!recovered) {
+        ops_.recover();
+        recoveries++;
+        recovered = true;
+      }
+      if (callInit(i)) {
+        setUp(d, true);
+        d.reinits++;
+      } else {
+        takeDown(d);
+      }
+    }
+  }
+
+  bool transfer(int id, uint8_t reg, const uint8_t* tx, uint8_t ntx, uint8_t* rx, uint8_t nrx) {
+    if (!valid(id) || ntx >= I2C_BURST_MAX || nrx > I2C_BURST_MAX) return false;
+    I2cDevice& d = devs_[id];
+    uint8_t msg[I2C_BURST_MAX];
+    msg[0] = reg;
+    if (ntx) memcpy(msg + 1, tx, ntx);
+    for (uint8_t attempt = 0; ; attempt++) {
+      uint32_t t0 = ops_.nowUs();
+      bool ok = ops_.write(d.addr, msg, 1 + ntx, nrx == 0) &&
+                (nrx == 0 || ops_.read(d.addr, rx, nrx));
+      d.xfers++;
+      if (ok) {
+        d.bytes += 1 + ntx + nrx;
+        return true;
+      }
+      // A part holding the clock won't let go in the next few ms
+      // either: only a NACK or a bus error gets another attempt
+      bool timedOut = ops_.nowUs() - t0 >= I2C_TIMEOUT_MS * 1000UL;
+      if (timedOut) d.timeouts++;
+      if (timedOut || attempt >= I2C_RETRIES) break;
+      d.retries++;
+    }
+    d.errors++;
+    if (cur_ == id) jobFailed_ = true;
+    return false;
+  }
+};
@@ -0,0 +1,358 @@
+// ============================================================
+// tiga_imu_fifo.h — MPU6050 FIFO pipeline for TIGA v6a
+// ============================================================
+// Runs the MPU6050 at IMU_RATE_HZ into its 1 KB on-chip FIFO,
+// accel and gyro together, burst-reads it, and hands every sample
+// to a chain of stages (motion, fusion, fall, steps, balance,
+// activity).
+//
+// Why: readMPUSensor() used to sample once per 100ms. A fall
+// impact peak is often shorter than that, so the detector could
+// miss it completely. At 200 Hz every peak is seen.
+//
+// Stages take a batch:  void stage(ImuSample* s, uint8_t n)
+// They run stage-by-stage over each burst, so each stage's cost
+// is timed once per burst and reported per sample. A poll never
+// takes more than IMU_MAX_PER_POLL samples — the rest stays in
+// the FIFO for the next loop() pass, so the UI is never starved.
+//
+// Usage:
+//   MpuFifoSource imuSrc(mpu, i2c, I2C_DEV_MPU);   // via tiga_i2c.h
+//   ImuPipeline   imuPipe(imuSrc, clockUs);  // any uint32_t µs clock
+//   imuPipe.addStage("fall", imuFallStage, 40);
+//   imuPipe.poll();                       // every loop() pass
+//
+// Host builds: ImuReplaySource plays a CSV trace of raw counts
+// ("ax,ay,az" or "ax,ay,az,gx,gy,gz") into a modelled FIFO.
+// Host bench: host/bench_imu_fifo.cpp
+// ============================================================
+
+#pragma once
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// ── Config ───────────────────────────────────────────────────
+#define IMU_RATE_HZ         200   // 1kHz gyro clock / (1 + 4)
+#define IMU_PERIOD_US      (1000000UL / IMU_RATE_HZ)
+#define IMU_FIFO_BYTES     1024
+#define IMU_FRAME_BYTES      12   // accel X/Y/Z then gyro X/Y/Z, big-endian int16
+#define IMU_FIFO_FRAMES    (IMU_FIFO_BYTES / IMU_FRAME_BYTES)
+#define IMU_BURST_SAMPLES    10   // 120 bytes per I2C read (I2C_BURST_MAX)
+#define IMU_MAX_PER_POLL     64   // 320ms of data — bounds one poll
+#define IMU_MAX_STAGES       10
+
+// ── MPU6050 registers ────────────────────────────────────────
+#define MPU6050_ADDR          0x68
+#define MPU6050_INT_STATUS    0x3A
+#define MPU6050_USER_CTRL     0x6A
+#define MPU6050_FIFO_COUNTH   0x72    // COUNTL follows
+#define MPU6050_FIFO_R_W      0x74
+#define MPU6050_INT_FIFO_OFLOW  0x10
+#define MPU6050_UC_FIFO_EN      0x40
+#define MPU6050_UC_FIFO_RESET   0x04
+
+struct ImuSample {
+  int16_t  ax, ay, az;      // raw counts
+  int16_t  gx, gy, gz;      // raw counts
+  uint32_t idx;             // absolute sample index
+  uint32_t g2;              // |a|² in counts², filled by the first stage
+  uint16_t g;               // |a| in counts, filled by the first stage
+  int16_t  up[3];           // gravity's direction, Q14, filled by fusion
+  int16_t  vert;            // vertical accel less 1g, counts, filled by fusion
+  bool     valid;           // cleared by a stage to drop the sample
+};
+
+// Sample index → milliseconds on the sensor's own clock
+inline uint32_t imuSampleMs(uint32_t idx) {
+  return (uint32_t)((uint64_t)idx * 1000 / IMU_RATE_HZ);
+}
+
+// ── Sample source ────────────────────────────────────────────
+// pending() returns whole frames waiting. If the FIFO overflowed
+// it must reset it (frames are no longer aligned) and set *overflow.
+class ImuSource {
+public:
+  virtual ~ImuSource() {}
+  virtual uint16_t pending(bool* overflow) = 0;
+  virtual bool     read(ImuSample* out, uint8_t n) = 0;
+};
+
+typedef void (*ImuStageFn)(ImuSample* s, uint8_t n);
+
+struct ImuStage {
+  const char* name;
+  ImuStageFn  fn;
+  uint16_t    budgetUs;     // per-sample budget
+  uint32_t    samples;
+  uint32_t    totalUs;
+  uint16_t    maxBurstUs;
+  uint32_t    overBudget;   // bursts whose per-sample cost broke the budget
+};
+
+// ── Pipeline ─────────────────────────────────────────────────
+class ImuPipeline {
+public:
+  ImuPipeline(ImuSource& src, uint32_t (*clockUs)())
+    : src_(src), clockUs_(clockUs), stageCount_(0), nextIdx_(0), lastDrainUs_(0) {
+    samplesIn = samplesLost = overflows = 0;
+    burstReads = readErrors = deferredPolls = 0;
+  }
+
+  bool addStage(const char* name, ImuStageFn fn, uint16_t budgetUs) {
+    if (stageCount_ >= IMU_MAX_STAGES) return false;
+    ImuStage& st = stages_[stageCount_++];
+    memset(&st, 0, sizeof(st));
+    st.name = name; st.fn = fn; st.budgetUs = budgetUs;
+    return true;
+  }
+
+  // Call once the FIFO has been configured and cleared.
+  void reset() {
+    nextIdx_ = 0;
+    lastDrainUs_ = clockUs_();
+    samplesIn = samplesLost = overflows = 0;
+    burstReads = readErrors = deferredPolls = 0;
+    for (uint8_t i = 0; i < stageCount_; i++) {
+      ImuStage& st = stages_[i];
+      st.samples = st.totalUs = st.overBudget = 0;
+      st.maxBurstUs = 0;
+    }
+  }
+
+  // Read up to IMU_MAX_PER_POLL samples and run them through all
+  // stages. Returns samples processed.
+  uint16_t poll() {
+    bool ovf = false;
+    uint16_t avail = src_.pending(&ovf);
+    uint32_t now = clockUs_();
+    if (ovf) {
+      // FIFO was reset — estimate what we lost from elapsed time so
+      // sample indices (and therefore sample time) stay honest.
+      uint32_t lost = (now - lastDrainUs_) / IMU_PERIOD_US;
+      nextIdx_     += lost;
+      samplesLost  += lost;
+      overflows++;
+      lastDrainUs_ += lost * IMU_PERIOD_US;
+      return 0;
+    }
+
+    bool partial = avail > IMU_MAX_PER_POLL;
+    if (partial) { avail = IMU_MAX_PER_POLL; deferredPolls++; }
+
+    uint16_t done = 0;
+    ImuSample burst[IMU_BURST_SAMPLES];
+    while (avail > 0) {
+      uint8_t n = avail > IMU_BURST_SAMPLES ? IMU_BURST_SAMPLES : avail;
+      if (!src_.read(burst, n)) { readErrors++; break; }
+      burstReads++;
+      for (uint8_t i = 0; i < n; i++) {
+        burst[i].idx   = nextIdx_++;
+        burst[i].g2    = 0;
+        burst[i].g     = 0;
+        burst[i].vert  = 0;
+        burst[i].up[0] = burst[i].up[1] = burst[i].up[2] = 0;
+        burst[i].valid = true;
+      }
+      runStages(burst, n);
+      samplesIn += n;
+      avail -= n;
+      done  += n;
+    }
+    // The newest sample indexed came out a period per sample after
+    // the last: counted, so an overflow's estimate keeps the sample
+    // phase, and a deferred poll's unread samples aren't taken as
+    // read. Emptied, it's within a period of now, which stops the
+    // sensor's oscillator drifting away from ours.
+    lastDrainUs_ += done * IMU_PERIOD_US;
+    if ((int32_t)(lastDrainUs_ - now) > 0) lastDrainUs_ = now;
+    else if (!partial && !avail && now - lastDrainUs_ >= IMU_PERIOD_US)
+      lastDrainUs_ = now - IMU_PERIOD_US + 1;
+    return done;
+  }
+
+  uint8_t         stageCount() const { return stageCount_; }
+  const ImuStage& stage(uint8_t i) const { return stages_[i]; }
+  uint32_t        sampleIndex() const { return nextIdx_; }
+
+  // Counters
+  uint32_t samplesIn;
+  uint32_t samplesLost;     // estimated, from overflow resets
+  uint32_t overflows;
+  uint32_t burstReads;
+  uint32_t readErrors;
+  uint32_t deferredPolls;   // polls that left data in the FIFO
+
+private:
+  ImuSource& src_;
+  uint32_t (*clockUs_)();
+  ImuStage   stages_[IMU_MAX_STAGES];
+  uint8_t    stageCount_;
+  uint32_t   nextIdx_;
+  uint32_t   lastDrainUs_;      // when the newest sample indexed came out
+
+  void runStages(ImuSample* s, uint8_t n) {
+    for (uint8_t i = 0; i < stageCount_; i++) {
+      ImuStage& st = stages_[i];
+      uint32_t t0 = clockUs_();
+      st.fn(s, n);
+      uint32_t dt = clockUs_() - t0;
+      st.samples += n;
+      st.totalUs += dt;
+      if (dt > st.maxBurstUs) st.maxBurstUs = dt > 0xFFFF ? 0xFFFF : (uint16_t)dt;
+      if (dt > (uint32_t)st.budgetUs * n) st.overBudget++;
+    }
+  }
+};
+
+inline void imuDecodeFrame(const uint8_t* b, ImuSample& s) {
+  s.ax = (int16_t)((b[0] << 8) | b[1]);
+  s.ay = (int16_t)((b[2] << 8) | b[3]);
+  s.az = (int16_t)((b[4] << 8) | b[5]);
+  s.gx = (int16_t)((b[6] << 8) | b[7]);
+  s.gy = (int16_t)((b[8] << 8) | b[9]);
+  s.gz = (int16_t)((b[10] << 8) | b[11]);
+}
+
+// ── Device source: MPU6050 ───────────────────────────────────
+// Setup through the Electronic Cats library; the FIFO itself is
+// read at register level through the bus engine, so every poll
+// is timed, retried and counted against the MPU.
+#ifdef ARDUINO
+#include <MPU6050.h>
+#include "tiga_i2c.h"
+
+class MpuFifoSource : public ImuSource {
+public:
+  MpuFifoSource(MPU6050& dev, I2cEngine& bus, int busId)
+    : dev_(dev), bus_(bus), id_(busId) {}
+
+  // DLPF 20Hz keeps the gyro clock at 1kHz; divide down to IMU_RATE_HZ
+  // and route accel and gyro samples into the FIFO. The part writes
+  // them in register order, so each frame is accel then gyro.
+  void configure() {
+    dev_.setDLPFMode(MPU6050_DLPF_BW_20);
+    dev_.setRate(1000 / IMU_RATE_HZ - 1);
+    dev_.setAccelFIFOEnabled(true);
+    dev_.setXGyroFIFOEnabled(true);
+    dev_.setYGyroFIFOEnabled(true);
+    dev_.setZGyroFIFOEnabled(true);
+    dev_.setFIFOEnabled(true);
+    dev_.resetFIFO();
+    dev_.getIntFIFOBufferOverflowStatus();   // clear-on-read: drop a stale latch
+  }
+
+  // A failed transfer reads as an empty FIFO; the engine counts it
+  uint16_t pending(bool* overflow) override {
+    *overflow = false;
+    uint8_t st, cnt[2];
+    if (!bus_.readRegs(id_, MPU6050_INT_STATUS, &st, 1)) return 0;   // clears on read
+    if (st & MPU6050_INT_FIFO_OFLOW) {
+      bus_.writeReg(id_, MPU6050_USER_CTRL, MPU6050_UC_FIFO_EN | MPU6050_UC_FIFO_RESET);
+      *overflow = true;
+      return 0;
+    }
+    if (!bus_.readRegs(id_, MPU6050_FIFO_COUNTH, cnt, 2)) return 0;
+    return (uint16_t)(cnt[0] << 8 | cnt[1]) / IMU_FRAME_BYTES;
+  }
+
+  bool read(ImuSample* out, uint8_t n) override {
+    uint8_t buf[IMU_BURST_SAMPLES * IMU_FRAME_BYTES];
+    if (!bus_.readRegs(id_, MPU6050_FIFO_R_W, buf, n * IMU_FRAME_BYTES)) return false;
+    for (uint8_t i = 0; i < n; i++) imuDecodeFrame(&buf[i * IMU_FRAME_BYTES], out[i]);
+    return true;
+  }
+
+private:
+  MPU6050&   dev_;
+  I2cEngine& bus_;
+  int        id_;
+};
+#endif
+
+// ── Replay source: CSV trace into a modelled FIFO ────────────
+// Produces one frame every 1e6/IMU_RATE_HZ µs of the supplied
+// clock. More than IMU_FIFO_FRAMES unread frames is an overflow,
+// and — like the real part — the whole FIFO is thrown away.
+// Loops at the end of the trace.
+class ImuReplaySource : public ImuSource {
+public:
+  explicit ImuReplaySource(uint32_t (*clockUs)()) : clockUs_(clockUs) {}
+  ~ImuReplaySource() { if (owned_) free(trace_); }
+
+  void setTrace(const ImuSample* s, uint32_t n) {
+    if (owned_) free(trace_);
+    trace_ = (ImuSample*)s; len_ = n; owned_ = false;
+    restart();
+  }
+
+  // Raw counts per line, '#' lines are comments. Returns samples loaded.
+  uint32_t loadCsv(const char* path) {
+    FILE* f = fopen(path, "r");
+    if (!f) return 0;
+    uint32_t cap = 1024, n = 0;
+    ImuSample* buf = (ImuSample*)malloc(cap * sizeof(ImuSample));
+    char line[96];
+    while (buf && fgets(line, sizeof(line), f)) {
+      int v[6] = {0, 0, 0, 0, 0, 0};
+      if (line[0] == '#') continue;
+      int got = sscanf(line, "%d,%d,%d,%d,%d,%d", &v[0], &v[1], &v[2], &v[3], &v[4], &v[5]);
+      if (got < 3) continue;
+      if (n == cap) {
+        cap *= 2;
+        ImuSample* grown = (ImuSample*)realloc(buf, cap * sizeof(ImuSample));
+        if (!grown) break;
+        buf = grown;
+      }
+      memset(&buf[n], 0, sizeof(ImuSample));
+      buf[n].ax = (int16_t)v[0]; buf[n].ay = (int16_t)v[1]; buf[n].az = (int16_t)v[2];
+      buf[n].gx = (int16_t)v[3]; buf[n].gy = (int16_t)v[4]; buf[n].gz = (int16_t)v[5];
+      n++;
+    }
+    fclose(f);
+    if (owned_) free(trace_);
+    trace_ = buf; len_ = n; owned_ = true;
+    restart();
+    return n;
+  }
+
+  void restart() {
+    produced_ = consumed_ = 0;
+    overflowed_ = false;
+    startUs_ = clockUs_();
+  }
+
+  uint16_t pending(bool* overflow) override {
+    update();
+    *overflow = overflowed_;
+    overflowed_ = false;
+    return (uint16_t)(produced_ - consumed_);
+  }
+
+  bool read(ImuSample* out, uint8_t n) override {
+    if (!len_ || produced_ - consumed_ < n) return false;
+    for (uint8_t i = 0; i < n; i++) out[i] = trace_[(consumed_++) % len_];
+    return true;
+  }
+
+  uint32_t totalProduced() const { return produced_; }
+
+private:
+  uint32_t (*clockUs_)();
+  ImuSample* trace_ = nullptr;
+  uint32_t   len_   = 0;
+  bool       owned_ = false;
+  uint32_t   startUs_ = 0;
+  uint32_t   produced_ = 0, consumed_ = 0;
+  bool       overflowed_ = false;
+
+  void update() {
+    produced_ = (uint32_t)((uint64_t)(clockUs_() - startUs_) * IMU_RATE_HZ / 1000000UL);
+    if (produced_ - consumed_ > IMU_FIFO_FRAMES) {
+      consumed_   = produced_;    // FIFO reset: everything unread is gone
+      overflowed_ = true;
+    }
+  }
+};
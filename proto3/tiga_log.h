@@ -0,0 +1,419 @@
+// ============================================================
+// tiga_log.h — binary event log for TIGA v6a
+// ============================================================
+// Serial.printf() in a sensor path formats floats and then waits
+// on the UART: at 115200 baud a 60-byte line is 5 ms of wire,
+// and the TX FIFO holds 128 bytes. LOG() instead records a fixed
+// 24-byte event — format id, micros(), up to four 32-bit
+// arguments — into a RAM ring and returns. Nothing is formatted
+// and nothing waits: a full ring drops the event and counts it.
+// A low-priority task drains the rings later and hands each event
+// to the sinks, as text or as binary frames.
+//
+//   LOG(FLOOR, floors, altM);
+//
+// ── Events ───────────────────────────────────────────────────
+// TIGA_LOG_EVENTS below is the one table of format strings; the
+// firmware stores only the index. Arguments are checked against
+// the conversions at compile time: %d %i %u %x %c take integers,
+// %f %e %g floats, and %s is not allowed (an event can't carry a
+// pointer). Ids go on the wire: add new events at the end and
+// never reuse one.
+//
+// Each event has a level. Anything above LOG_LEVEL compiles to
+// nothing, arguments included:
+//   -DLOG_LEVEL=LOG_INFO   drops the per-second traces
+//
+// ── Rings ────────────────────────────────────────────────────
+// One SpscRing (tiga_cores.h) per core, so each has a single
+// producer; the drain runs on core 1 and merges the two in time
+// order. Not for interrupt handlers. Off the device and the
+// simulator every caller counts as core 0: log from one thread.
+//
+// ── Binary frame (little-endian) ─────────────────────────────
+//   [0]     sync      0xA5
+//   [1]     crc8      over [2..] (capCrc8, as capture records)
+//   [2]     id        LogId
+//   [3]     core << 4 | argument count
+//   [4-7]   tUs       uint32 micros()
+//   [8..]   arguments, 4 bytes each: int32, uint32 or float bits
+//
+// 8 to 24 bytes. Frames can share a port with plain text; a
+// reader skips anything that isn't a whole frame with a good CRC
+// (host/logcat.cpp prints those bytes through as they are).
+// ============================================================
+
+#pragma once
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <type_traits>
+#include "tiga_capture.h"
+#include "tiga_cores.h"
+
+#define LOG_ERROR     1
+#define LOG_WARN      2
+#define LOG_INFO      3
+#define LOG_DEBUG     4
+
+#ifndef LOG_LEVEL
+#define LOG_LEVEL     LOG_DEBUG
+#endif
+
+#define LOG_MAX_ARGS  4
+#define LOG_RING      64          // events per core
+#define LOG_SYNC      0xA5
+#define LOG_FRAME_HDR 8
+#define LOG_FRAME_MAX (LOG_FRAME_HDR + 4 * LOG_MAX_ARGS)
+#define LOG_LINE_MAX  112         // one formatted line, with its newline
+#define LOG_SINKS     2
+#define LOG_DRAIN_MAX 16          // events per drain() call
+
+// ── Event table ──────────────────────────────────────────────
+#define TIGA_LOG_EVENTS(X)                                                                 \
+  X(FLOOR,          LOG_INFO,  "[BMP] Floor climbed! Total: %d  Alt: %.1f m")              \
+  X(BARO_BASELINE,  LOG_INFO,  "[BMP] Altitude baseline set: %.1f m")                      \
+  X(BARO_TRACE,     LOG_DEBUG, "[BMP] Pressure: %.1f hPa  Altitude: %.1f m  Floors: %d")   \
+  X(PPG_TRACE,      LOG_DEBUG, "[MAX] HR=%.0f bpm  SpO2=%d%%  valid=%d  R=%.3f")           \
+  X(PPG_OVERFLOW,   LOG_WARN,  "[MAX] FIFO overflow: %u samples lost before block %u")     \
+  X(I2C_STUCK,      LOG_ERROR, "[TIGA] I2C SDA stuck — recovering")                        \
+  X(MPU_RECOVERED,  LOG_WARN,  "[TIGA] MPU recovered (#%u)")                               \
+  X(SESSION_RESET,  LOG_INFO,  "[TIGA] Session reset by user")                             \
+  X(FLOOR_DOWN,     LOG_INFO,  "[BMP] Floor descended. Total: %d  Alt: %.1f m")            \
+  X(FALL,           LOG_WARN,  "[MPU] Fall: %d cm drop, peak %.1f g")                      \
+  X(ALERT_RAISED,   LOG_WARN,  "[BLE] Alert %u raised: type %u, severity %u, %u waiting")  \
+  X(ALERT_CONFIRMED,LOG_INFO,  "[BLE] Alert confirmed after %u ms, %u waiting")
+
+enum LogId : uint8_t {
+#define LOG_ENUM(name, level, fmt) LOG_##name,
+  TIGA_LOG_EVENTS(LOG_ENUM)
+#undef LOG_ENUM
+  LOG_IDS
+};
+
+struct LogFormat {
+  uint8_t     level;
+  const char* fmt;
+};
+
+constexpr LogFormat LOG_FORMATS[] = {
+#define LOG_ENTRY(name, level, fmt) { level, fmt },
+  TIGA_LOG_EVENTS(LOG_ENTRY)
+#undef LOG_ENTRY
+};
+
+// ── Format strings at compile time ───────────────────────────
+// Walks a format the way printf does, to count its conversions
+// and say which kind of argument each one takes.
+constexpr bool logIsModifier(char c) {
+  return c == '-' || c == '+' || c == ' ' || c == '#' || c == '.' ||
+         (c >= '0' && c <= '9') || c == 'l' || c == 'h' || c == 'z';
+}
+constexpr const char* logSkipModifiers(const char* f) {
+  return logIsModifier(*f) ? logSkipModifiers(f + 1) : f;
+}
+// The conversion character of the next argument at or after f,
+// or the terminating '\0'
+constexpr const char* logNextConv(const char* f) {
+  return *f == 0     ? f
+       : *f != '%'   ? logNextConv(f + 1)
+       : f[1] == '%' ? logNextConv(f + 2)
+       :               logSkipModifiers(f + 1);
+}
+constexpr uint8_t logCountFrom(const char* c) {
+  return *c ? 1 + logCountFrom(logNextConv(c + 1)) : 0;
+}
+constexpr uint8_t logArgCount(const char* f) { return logCountFrom(logNextConv(f)); }
+
+// 'f' float, 'd' signed, 'u' unsigned, 0 not allowed
+constexpr char logKind(char c) {
+  return c == 'f' || c == 'e' || c == 'g'             ? 'f'
+       : c == 'd' || c == 'i'                         ? 'd'
+       : c == 'u' || c == 'x' || c == 'X' || c == 'c' ? 'u'
+       :                                                0;
+}
+constexpr char logKindFrom(const char* c, uint8_t i) {
+  return !*c ? 0 : i == 0 ? logKind(*c) : logKindFrom(logNextConv(c + 1), i - 1);
+}
+constexpr char logArgKind(const char* f, uint8_t i) { return logKindFrom(logNextConv(f), i); }
+
+template <typename... A> struct LogArgsFit;
+template <> struct LogArgsFit<> {
+  static constexpr bool check(const char*, uint8_t) { return true; }
+};
+template <typename T, typename... R> struct LogArgsFit<T, R...> {
+  static constexpr bool check(const char* f, uint8_t i) {
+    return (std::is_floating_point<T>::value
+              ? logArgKind(f, i) == 'f'
+              : (std::is_integral<T>::value || std::is_enum<T>::value) &&
+                (logArgKind(f, i) == 'd' || logArgKind(f, i) == 'u')) &&
+           LogArgsFit<R...>::check(f, i + 1);
+  }
+};
+
+// ── Event ────────────────────────────────────────────────────
+struct LogEvent {
+  uint32_t tUs;
+  uint8_t  id;
+  uint8_t  nargs;
+  uint8_t  core;
+  uint8_t  pad;
+  uint32_t a[LOG_MAX_ARGS];
+};
+
+inline uint32_t logWord(float v)  { uint32_t w; memcpy(&w, &v, 4); return w; }
+inline uint32_t logWord(double v) { return logWord((float)v); }
+template <typename T>
+inline uint32_t logWord(T v)      { return (uint32_t)(int32_t)v; }
+
+// ── Sinks ────────────────────────────────────────────────────
+// write() takes what it can without blocking and returns it.
+// A lossy sink gets whole frames or nothing (a BLE notify); the
+// others keep the unsent rest of a line and hold the drain until
+// it has gone (a UART, where order matters and the text is read).
+struct LogSink {
+  uint16_t (*write)(const uint8_t* p, uint16_t n);
+  bool     text;              // formatted lines, else binary frames
+  bool     lossy;
+};
+
+// ── Formatting ───────────────────────────────────────────────
+// One line, newline included, into out; returns its length. Each
+// conversion is handed to snprintf with its length modifiers
+// dropped and the argument widened to what the kind expects.
+// Unknown ids (a newer firmware's) print as numbers.
+inline uint16_t logFormat(const LogEvent& e, char* out, uint16_t size) {
+  uint16_t n = 0;
+  auto room = [&]() { return n < size ? size - n : 0; };
+  auto add  = [&](int k) { if (k > 0) n = (uint16_t)(n + k < size ? n + k : size - 1); };
+  if (e.id >= LOG_IDS) {
+    add(snprintf(out, size, "[LOG] event %u", e.id));
+    for (uint8_t i = 0; i < e.nargs; i++) add(snprintf(out + n, room(), " %lu", (unsigned long)e.a[i]));
+  } else {
+    const char* f = LOG_FORMATS[e.id].fmt;
+    uint8_t arg = 0;
+    while (*f && n + 1 < size) {
+      if (*f != '%') { out[n++] = *f++; continue; }
+      if (f[1] == '%') { out[n++] = '%'; f += 2; continue; }
+      char spec[16];
+      uint8_t s = 0;
+      spec[s++] = *f++;
+      while (logIsModifier(*f)) {
+        if (*f != 'l' && *f != 'h' && *f != 'z' && s < sizeof(spec) - 2) spec[s++] = *f;
+        f++;
+      }
+      char conv = *f ? *f++ : 'd';
+      spec[s++] = conv;
+      spec[s]   = 0;
+      uint32_t w = arg < e.nargs ? e.a[arg] : 0;
+      arg++;
+      switch (logKind(conv)) {
+        case 'f': { float v; memcpy(&v, &w, 4); add(snprintf(out + n, room(), spec, (double)v)); break; }
+        case 'd': add(snprintf(out + n, room(), spec, (int)(int32_t)w)); break;
+        default:  add(snprintf(out + n, room(), spec, (unsigned)w)); break;
+      }
+    }
+  }
+  if (n + 1 >= size) n = size - 2;
+  out[n++] = '\n';
+  out[n]   = 0;
+  return n;
+}
+
+// ── Frames ───────────────────────────────────────────────────
+inline uint8_t logFrame(const LogEvent& e, uint8_t* out) {
+  uint8_t n = LOG_FRAME_HDR + 4 * e.nargs;
+  out[0] = LOG_SYNC;
+  out[2] = e.id;
+  out[3] = (uint8_t)(e.core << 4 | e.nargs);
+  capPut32(out + 4, e.tUs);
+  for (uint8_t i = 0; i < e.nargs; i++) capPut32(out + LOG_FRAME_HDR + 4 * i, e.a[i]);
+  out[1] = capCrc8(0, out + 2, n - 2);
+  return n;
+}
+
+// A whole frame at p, n bytes available: its length, or 0 if
+// there isn't one there
+inline uint8_t logParseFrame(const uint8_t* p, size_t n, LogEvent& e) {
+  if (n < LOG_FRAME_HDR || p[0] != LOG_SYNC) return 0;
+  uint8_t nargs = p[3] & 0x0F;
+  if (nargs > LOG_MAX_ARGS) return 0;
+  uint8_t len = LOG_FRAME_HDR + 4 * nargs;
+  if (n < len || capCrc8(0, p + 2, len - 2) != p[1]) return 0;
+  e.id    = p[2];
+  e.core  = p[3] >> 4;
+  e.nargs = nargs;
+  e.tUs   = capGet32(p + 4);
+  for (uint8_t i = 0; i < nargs; i++) e.a[i] = capGet32(p + LOG_FRAME_HDR + 4 * i);
+  return len;
+}
+
+// ── Log ──────────────────────────────────────────────────────
+class EventLog {
+public:
+  uint32_t (*clockUs)() = nullptr;
+
+  // Counters. dropped[] is written by its core only; the rest by
+  // the drain.
+  uint32_t dropped[2]   = {};     // ring full
+  uint32_t drained      = 0;
+  uint32_t lossyDropped = 0;      // frames a lossy sink refused
+  uint32_t maxQueued    = 0;      // both rings, high-water mark
+
+  void begin(uint32_t (*clock)()) { clockUs = clock; }
+
+  bool addSink(const LogSink& s) {
+    if (sinks_ == LOG_SINKS) return false;
+    sink_[sinks_++] = { s, {}, 0, 0 };
+    return true;
+  }
+
+  // Hot path: a copy into this core's ring, or a count if it's full
+  void push(LogEvent& e) {
+    uint8_t c = coreId() & 1;
+    e.core = c;
+    e.tUs  = clockUs ? clockUs() : 0;
+    if (!ring_[c].push(e)) dropped[c]++;
+  }
+
+  // Core 1, low priority. Oldest first across both rings; stops
+  // after LOG_DRAIN_MAX events or when a sink that keeps order is
+  // full.
+  void drain() {
+    uint32_t q = ring_[0].size() + ring_[1].size();
+    if (q > maxQueued) maxQueued = q;
+    for (uint16_t k = 0; k < LOG_DRAIN_MAX; k++) {
+      if (!flush()) return;
+      const LogEvent* a = ring_[0].front();
+      const LogEvent* b = ring_[1].front();
+      if (!a && !b) return;
+      uint8_t c = !a ? 1 : !b ? 0 : (int32_t)(b->tUs - a->tUs) < 0 ? 1 : 0;
+      LogEvent e;
+      ring_[c].pop(e);
+      deliver(e);
+      drained++;
+    }
+    flush();
+  }
+
+  uint32_t queued() const { return ring_[0].size() + ring_[1].size(); }
+
+private:
+  struct Out {
+    LogSink  sink;
+    uint8_t  buf[LOG_LINE_MAX];
+    uint8_t  len, off;            // unsent bytes are buf[off..len)
+  };
+
+  SpscRing<LogEvent, LOG_RING> ring_[2];
+  Out     sink_[LOG_SINKS];
+  uint8_t sinks_ = 0;
+
+  // True once nothing is held back
+  bool flush() {
+    bool clear = true;
+    for (uint8_t i = 0; i < sinks_; i++) {
+      Out& o = sink_[i];
+      if (o.off < o.len) o.off += (uint8_t)o.sink.write(o.buf + o.off, o.len - o.off);
+      if (o.off < o.len) clear = false;
+    }
+    return clear;
+  }
+
+  void deliver(const LogEvent& e) {
+    uint8_t frame[LOG_FRAME_MAX];
+    uint8_t frameLen = 0;
+    for (uint8_t i = 0; i < sinks_; i++) {
+      Out& o = sink_[i];
+      uint16_t n;
+      if (o.sink.text) n = logFormat(e, (char*)o.buf, sizeof(o.buf));
+      else {
+        if (!frameLen) frameLen = logFrame(e, frame);
+        memcpy(o.buf, frame, frameLen);
+        n = frameLen;
+      }
+      if (o.sink.lossy) {
+        if (o.sink.write(o.buf, n) < n) lossyDropped++;
+        continue;
+      }
+      o.len = (uint8_t)n;
+      o.off = (uint8_t)o.sink.write(o.buf, n);
+    }
+  }
+};
+
+inline EventLog& eventLog() {
+  static EventLog log;
+  return log;
+}
+
+// ── LOG() ────────────────────────────────────────────────────
+template <uint8_t Id, typename... A>
+inline void logWrite(A... args) {
+  static_assert(Id < LOG_IDS, "no such log event");
+  static_assert(sizeof...(A) == logArgCount(LOG_FORMATS[Id].fmt),
+                "LOG() arguments don't match the event's format");
+  static_assert(LogArgsFit<A...>::check(LOG_FORMATS[Id].fmt, 0),
+                "LOG() argument types don't match the event's format");
+  LogEvent e;
+  uint32_t words[sizeof...(A) + 1] = { logWord(args)... };
+  e.id    = Id;
+  e.nargs = sizeof...(A);
+  memcpy(e.a, words, sizeof...(A) * 4);
+  eventLog().push(e);
+}
+
+#define LOG(name, ...)                                                     \
+  do {                                                                     \
+    if (LOG_FORMATS[LOG_##name].level <= LOG_LEVEL)                        \
+      logWrite<LOG_##name>(__VA_ARGS__);                                   \
+  } while (0)
+
+// ── Reader (host only) ───────────────────────────────────────
+// Splits a byte stream — a serial capture, a file of BLE
+// notifications — into frames and the text between them. Bytes
+// can arrive in any pieces; a frame cut at the end of one feed()
+// is finished by the next.
+#if defined(__unix__) || defined(__APPLE__)
+#include <vector>
+
+class LogScanner {
+public:
+  uint32_t frames = 0;
+
+  // frame(const LogEvent&) for each whole frame, text(p, n) for
+  // everything else. end = no more bytes coming.
+  template <typename OnFrame, typename OnText>
+  void feed(const uint8_t* p, size_t n, OnFrame frame, OnText text, bool end = false) {
+    buf_.insert(buf_.end(), p, p + n);
+    const uint8_t* b = buf_.data();
+    size_t m = buf_.size(), i = 0, from = 0;
+    while (i < m) {
+      if (b[i] == LOG_SYNC) {
+        size_t avail = m - i;
+        if (!end && (avail < LOG_FRAME_HDR ||
+                     ((b[i + 3] & 0x0F) <= LOG_MAX_ARGS &&
+                      avail < (size_t)LOG_FRAME_HDR + 4 * (b[i + 3] & 0x0F))))
+          break;                                  // may be a frame still arriving
+        LogEvent e;
+        uint8_t len = logParseFrame(b + i, avail, e);
+        if (len) {
+          if (i > from) text(b + from, i - from);
+          frame(e);
+          frames++;
+          i += len;
+          from = i;
+          continue;
+        }
+      }
+      i++;
+    }
+    if (i > from) text(b + from, i - from);
+    buf_.erase(buf_.begin(), buf_.begin() + i);
+  }
+
+private:
+  std::vector<uint8_t> buf_;
+};
+#endif
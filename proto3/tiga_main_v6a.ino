@@ -9,7 +9,44 @@
 //       Replaces v5.2 analog pulse sensor on GPIO01 entirely
 //   - BMP280 driver (Adafruit BMP280 library)
 //       Pressure → altitude (metres above sea level)
-//       Floor counting (±3m threshold per floor)
+//   - Altitude from pressure and vertical acceleration
+//       together (tiga_altitude.h): a table instead of powf,
+//       a Kalman filter at 10 Hz, floors up and down counted
+//       only on stairs taken on foot; lifts and the weather
+//       move the barometer, not the count
+//   - Falls judged in stages (tiga_fall.h): the wrist's drop
+//       and free fall into an impact, then stillness and a turn
+//       from the attitude before; replaces the 3g-then-0.5g rule
+//       that missed falls ending at 1g and took dropped arms for
+//       falls. host/fall_eval scores it on labelled captures
+//   - PPG signal quality (tiga_ppg_sqi.h) scored per 250 ms
+//       block from arm motion, perfusion index and each beat's
+//       shape against a template: blocks spoilt by movement skip
+//       beat detection, HRV and SpO2, doubtful ones move the
+//       readings slowly, and only clean beats count towards the
+//       HR alarm — walking no longer raises it
+//   - Falls, SOS and HR emergencies go to the phone as their own
+//       BLE indications the moment they are raised, with an id,
+//       severity, time and the last GPS fix; kept in flash and
+//       sent again until the phone confirms (tiga_alert_link.h).
+//       Needs a partition in partitions.csv:
+//         alerts, data, 0x42, , 8K
+//   - Per-second, per-minute and per-hour statistics of HR,
+//       SpO2, steps and altitude (tiga_stats.h) behind the
+//       summary, doctor's report and session export; replaces
+//       the running HR average updated on every beat
+//   - Raw PPG and accel streamed to the phone for clinician
+//       sessions (tiga_stream.h), on a third BLE service and
+//       only while asked: delta-packed frames at the MTU, the
+//       fastest link the phone allows, halving the rate while
+//       the link falls behind; dropped frames counted
+//   - Buttons on GPIO interrupts (tiga_buttons.h): debounced
+//       in the ISR and queued with the time they happened, so a
+//       press during a redraw or flash erase still counts, in
+//       order; long presses and both-together worked out from
+//       the queue. Reset, export and sleep run from taskUI() a
+//       step at a time instead of blocking the loop for seconds;
+//       press-to-handled time in the report
 //   - Buzzer alert patterns (GPIO13, passive buzzer via 100Ω)
 //       goal_reached, fall_alert, sos_confirm, low_battery
 //   - Vibration motor patterns (GPIO12, 2N2222 switch)
@@ -17,6 +54,58 @@
 //   - Multi-modal alert system
 //       Severity tiers combining buzzer + motor + display
 //   - Wearing detection now real — MAX30102 IR validity
+//   - MAX30102 FIFO drained in burst reads (tiga_ppg_fifo.h)
+//       Every 100 Hz sample reaches beat detection and SpO2,
+//       beat timing uses sample index instead of millis()
+//   - MPU6050 FIFO at 200 Hz (tiga_imu_fifo.h)
+//       Fall, step, balance and activity see every sample,
+//       in integer maths (tiga_motion.h) — no sqrtf/atan2f
+//   - Gyro read with the accelerometer and fused into pitch,
+//       roll and vertical acceleration (tiga_fusion.h) for the
+//       stability screen, balance score and fall check
+//   - Tremor spectrum from the gyro (tiga_tremor.h) on the
+//       Dexterity screen: 4-12 Hz peak, its strength, and the
+//       trend over past sessions; measured only between walks
+//   - Heart rate variability (tiga_hrv.h): each beat timed to a
+//       fraction of a sample from the PPG upstroke, ectopic and
+//       movement intervals thrown out, RMSSD / SDNN / pNN50 over
+//       1 and 5 minutes on the Heart screen, report and BLE
+//   - Cooperative scheduler (tiga_sched.h) replaces the
+//       millis() timers and delay(20) in loop()
+//   - Alert patterns play from tables via a non-blocking
+//       sequencer (tiga_alerts.h); SOS preempts lower alerts
+//   - SpO2 over a 4s sliding window, O(1) per sample
+//       (tiga_spo2.h) — was a 25-sample rescan per sample
+//   - Raw sensor capture (tiga_capture.h) to USB or flash,
+//       set CAPTURE_MODE below; read back on a PC for replay
+//   - Screens draw into an off-screen canvas; only the 16×10
+//       tiles that changed go to the LCD, a band per scheduler
+//       run (tiga_gfx.h) — no fillScreen flash, no 30ms stall.
+//       Needs PSRAM enabled (Tools → PSRAM → OPI PSRAM)
+//   - Per-second HR, SpO2, steps, altitude, battery and worn
+//       history kept in flash across sleep and power loss
+//       (tiga_history.h). Needs a partition in partitions.csv:
+//         history, data, 0x41, , 1M
+//   - History backfill over a second BLE service, as fast as
+//       the link takes it and resuming after a disconnect
+//       (tiga_sync.h)
+//   - Live BLE telemetry as versioned delta frames, only what
+//       changed (tiga_telemetry.h); the 20-byte packet stays for
+//       the v05 app
+//   - One queued engine owns the sensor bus, now at 400 kHz
+//       (tiga_i2c.h): MPU drains go first, transfers time out in
+//       5 ms, a failing part is backed off, the bus recovered and
+//       the part re-initialised; per-sensor counters in the report
+//   - Sensors and signal processing run on core 0 under their
+//       own scheduler (tiga_cores.h); screen, buttons, BLE and
+//       flash stay in loop() on core 1. Readings cross in a
+//       seqlock snapshot, events and commands in SPSC rings
+//   - Runtime messages are LOG() events (tiga_log.h): a 24-byte
+//       copy into a RAM ring, formatted later by a low-priority
+//       task that never waits on the UART. LOG_SERIAL_BINARY
+//       sends frames instead, for host/logcat
+//   - Runs on Linux under the host simulator (proto3/host),
+//       against a virtual clock and scripted or recorded input
 //
 // What was removed vs v5.2:
 //   - Analog pulse sensor on PULSE_PIN (GPIO01) — gone
@@ -64,7 +153,26 @@
 #include "MAX30105.h"         // SparkFun MAX3010x library
 #include "heartRate.h"        // SparkFun beat detection helper
 #include <Adafruit_BMP280.h>
-#include "tiga_ble.h"
+#include "tiga_i2c.h"
+#include "tiga_ppg_fifo.h"
+#include "tiga_imu_fifo.h"
+#include "tiga_motion.h"
+#include "tiga_fusion.h"
+#include "tiga_fall.h"
+#include "tiga_tremor.h"
+#include "tiga_hrv.h"
+#include "tiga_ppg_sqi.h"
+#include "tiga_altitude.h"
+#include "tiga_stats.h"
+#include "tiga_sched.h"
+#include "tiga_alerts.h"
+#include "tiga_capture.h"
+#include "tiga_spo2.h"
+#include "tiga_gfx.h"
+#include "tiga_history.h"
+#include "tiga_cores.h"
+#include "tiga_log.h"
+#include "tiga_buttons.h"
 
 // ── GPS ──────────────────────────────────────────────────────
 #define GPS_RX_PIN   44
@@ -84,10 +192,19 @@ struct GPSData {
   double  lastLat     = 0;
   double  lastLng     = 0;
   bool    lastValid   = false;
+  unsigned long fixMs = 0;      // millis() of the last fix, 0 = none yet
+  int     fixSats     = 0;      // satellites in it
 } gpsData;
 
-// ── Deep sleep ───────────────────────────────────────────────
-#define SLEEP_HOLD_MS  3000
+// ── Sleep, reset, export ─────────────────────────────────────
+// Button 1 held BTN_LONG_US (tiga_buttons.h) sleeps once it's let
+// go, button 2 held resets, both export; taskUI() steps each
+#define SLEEP_SHOW_MS  1200          // "sleeping..." at least this long
+#define SLEEP_UP_MS    200           // button 1 up this long, or it wakes us
+#define RESET_BAR_MS   2000          // the progress bar fills in this
+#define RESET_SHOW_MS  2600          // then back to the clock
+#define EXPORT_PARTS   11            // report sections, one per taskUI() pass
+#define EXPORT_SHOW_MS 3000          // the screen stays after the last
 #define WAKE_PIN       GPIO_NUM_21
 
 // ── WiFi / NTP ───────────────────────────────────────────────
@@ -107,12 +224,25 @@ const int   DAYLIGHT_OFFSET  = 0;
 #define MOTOR_PIN    12
 #define I2C_SDA      18
 #define I2C_SCL      17
+#define BMP280_ADDR  0x76
 
 // ── Display ──────────────────────────────────────────────────
 TFT_eSPI tft = TFT_eSPI();
+TFT_eSprite canvas = TFT_eSprite(&tft);   // whole screen, 106 KB in PSRAM
+GfxFrame gfx;
 #define W 320
 #define H 170
 
+// TFT_eSPI has DMA on SPI panels only; the T-Display-S3's 8-bit
+// parallel bus is driven by the CPU, so there each band is a short
+// blocking push and the slice below is what bounds one run
+#if defined(ESP32_DMA) && !defined(TFT_PARALLEL_8_BIT)
+#define LCD_DMA       1
+#else
+#define LCD_DMA       0
+#endif
+#define LCD_SLICE_US  3000   // bus time per taskLcd() run
+
 // ── Colours (RGB565) ─────────────────────────────────────────
 #define C_BG      0x0000
 #define C_CARD    0x18E3
@@ -134,9 +264,14 @@ TFT_eSPI tft = TFT_eSPI();
 #define HR_WARN_LOW   45
 #define HR_WARN_HIGH 110
 #define STEPS_GOAL  3000
-#define FALL_G       3.0f
 #define STABLE_G     1.3f
 
+// Per-sample motion tests run on |a|² in counts² (tiga_motion.h)
+#define STABLE_G2    motionG2(STABLE_G)
+#define SPIKE_G2     motionG2(6.0f)     // unphysical at ±4g — drop
+#define ACTIVE_ON_G2  motionG2(1.15f)
+#define ACTIVE_OFF_G2 motionG2(1.05f)
+
 // ── App states ───────────────────────────────────────────────
 enum AppState {
   STATE_CLOCK,
@@ -151,7 +286,10 @@ enum AppState {
   STATE_SETTINGS,
   STATE_EMERGENCY,
   STATE_SOS,
-  STATE_FALL_CONFIRM
+  STATE_FALL_CONFIRM,
+  STATE_RESET,          // long actions, stepped by taskUI()
+  STATE_EXPORT,
+  STATE_SLEEP
 };
 
 AppState state     = STATE_CLOCK;
@@ -161,11 +299,21 @@ bool needsFullDraw = true;
 // ── Health data ──────────────────────────────────────────────
 struct HealthData {
   float heartRate    = 0;
+  uint8_t hrQuality  = 0;       // 0-100, worst PPG block behind heartRate (tiga_ppg_sqi.h)
+  uint8_t ppgQuality = 0;       // 0-100, last PPG block
   uint8_t spO2       = 0;       // % oxygen saturation (0 = no reading)
   bool  spO2Valid    = false;
   int   steps        = 0;
   float accelG       = 1.0f;
-  float tiltAngle    = 0;
+  float tiltAngle    = 0;       // pitch, degrees (tiga_fusion.h)
+  float rollAngle    = 0;       // degrees, ±180
+  float vertAccelG   = 0;       // along gravity, less 1g
+  float tremorHz     = 0;       // last still window; 0 = no tremor
+  float tremorDps    = 0;       // 4-12 Hz RMS rotation, °/s
+  float tremorAmpDeg = 0;       // ± degrees of swing at tremorHz
+  float rmssdMs      = 0;       // HRV over the last minute; 0 = no reading
+  float sdnnMs       = 0;
+  float pnn50        = 0;       // %
   bool  isStable     = true;
   bool  fallDetected = false;
   float battery      = 100.0f;
@@ -175,15 +323,14 @@ struct HealthData {
   int   hrZone       = 0;
   int   activityMins = 0;
   int   balanceScore = 100;
-  float altitudeM    = 0;       // BMP280 altitude metres
+  float altitudeM    = 0;       // climbed on foot this session, m
   int   floorsUp     = 0;       // floors climbed this session
+  int   floorsDown   = 0;       // floors descended this session
   float pressureHPa  = 1013.0f; // BMP280 raw pressure
 } data;
 
 struct DailyData {
   int   peakSteps    = 0;
-  float avgHR        = 0;
-  int   hrSamples    = 0;
   int   fallCount    = 0;
   int   activityMins = 0;
   int   sosCount     = 0;
@@ -202,78 +349,262 @@ struct PrevData {
   float altitudeM    = -1;
 } prev;
 
+// ── Core split (tiga_cores.h) ────────────────────────────────
+// Core 0 keeps its readings in `acq` and publishes all of it
+// after every task it runs. Core 1 copies that into data, daily
+// and the sensor flags (acqPull) and never touches acq itself,
+// so a draw or a BLE packet always sees one consistent moment.
+struct AcqSnapshot {
+  HealthData data;
+  DailyData  daily;
+  float      peakHR      = 0;       // this session
+  float      lowHR       = 999;
+  float      spo2R       = 0;       // last red/IR ratio, for the trace
+  uint32_t   firstStepMs = 0;       // millis() of the session's first step
+  bool       mpuOK       = false;   // the bus engine's view of each part
+  bool       maxOK       = false;
+  bool       bmpOK       = false;
+  bool       mpuDegraded = false;
+  TremorSession tremor      = {};   // this session, still windows only
+  TremorTrend   tremorTrend = {};   // past sessions
+  uint32_t   tremorWindows = 0;     // analysed / skipped for walking
+  uint32_t   tremorSkipped = 0;
+  HrvStats   hrv1        = {};      // last minute
+  HrvStats   hrv5        = {};      // last five
+  uint32_t   hrvAccepted = 0;       // intervals kept / thrown out
+  uint32_t   hrvRejected = 0;
+};
+AcqSnapshot          acq;           // core 0 only
+Seqlock<AcqSnapshot> acqPub;
+uint32_t             acqSeen  = 0;  // core 1: version last copied
+uint32_t             acqPulls = 0;  // core 1: snapshots copied
+
+// Core 0 → core 1: things only the UI can act on
+enum AcqEventType : uint8_t { EV_FALL, EV_FLOOR, EV_FLOOR_DOWN };
+struct AcqEvent {
+  uint8_t type;
+  int16_t count;       // EV_FLOOR(_DOWN): floors so far that way; EV_FALL: drop, cm
+  float   value;       // EV_FLOOR(_DOWN): climbed altitude, m; EV_FALL: peak, g
+};
+
+// Core 1 → core 0: changes to state core 0 owns
+enum AcqCmdType : uint8_t {
+  CMD_SESSION_RESET, CMD_FALL_CONFIRMED, CMD_SOS, CMD_CAPTURE_BUTTON, CMD_CAPTURE_GPS,
+  CMD_SLEEP
+};
+struct AcqCmd {
+  uint8_t type;
+  uint8_t button;      // CMD_CAPTURE_BUTTON: 1 or 2
+  bool    on;          // pressed / GPS fix
+  uint8_t sats;
+  float   speedKmh;
+  double  lat, lng;
+};
+
+SpscRing<AcqEvent, 16> acqEvents;
+SpscRing<AcqCmd,   16> acqCmds;
+
+// BLE reads data / daily / gpsData, so it comes after them
+#include "tiga_ble.h"
+
 // ── Sensors ──────────────────────────────────────────────────
 MPU6050         mpu;
 MAX30105        max30102;
 Adafruit_BMP280 bmp280;
 
+// Clock for the sensor engines (they take a plain uint32_t µs source)
+uint32_t clockUs() { return (uint32_t)micros(); }
+uint32_t clockMs() { return (uint32_t)millis(); }
+
+// ── Sensor bus (tiga_i2c.h) ──────────────────────────────────
+// The sensor tasks post their bus work; the "i2c" task runs it,
+// MPU first. Ids are in addDevice() order, see setup().
+enum { I2C_DEV_MPU, I2C_DEV_MAX, I2C_DEV_BMP };
+bool i2cWrite(uint8_t addr, const uint8_t* p, uint8_t n, bool stop);
+bool i2cRead(uint8_t addr, uint8_t* p, uint8_t n);
+void i2cRestart();
+void i2cKick();
+I2cEngine i2c({ i2cWrite, i2cRead, i2cRestart, clockUs, i2cKick });
+int       i2cTask = -1;
+
+// 200Hz FIFO pipeline — replaces the 10Hz getAcceleration() poll
+MpuFifoSource imuSrc(mpu, i2c, I2C_DEV_MPU);
+ImuPipeline   imuPipe(imuSrc, clockUs);
+FusionFilter  fusion;                        // core 0: the fusion stage
+TremorEngine  tremor;                        // core 0: tremor stage and task
+#define MPU_ZERO_LIMIT  (IMU_RATE_HZ / 2)   // 0.5s of all-zero frames = dead
+
+// ── Schedulers ───────────────────────────────────────────────
+// One per core: sched is loop()'s on core 1, acqSched runs the
+// sensor tasks on core 0 (setupTasks)
+void schedIdle(uint32_t us);
+Scheduler sched({ clockUs, schedIdle, nullptr });
+Scheduler acqSched({ clockUs, schedIdle, nullptr });
+#define ACQ_CORE        0
+#define ACQ_STACK       8192
+#define ACQ_PRIORITY    5      // above loop()'s 1, below the BLE / WiFi stacks
+
+// ── Raw capture ──────────────────────────────────────────────
+// CAPTURE_USB streams binary records over the USB serial port,
+// whole records only, and keeps LOG() events off it (the phone
+// still gets them); Serial.printf text lands between records and
+// the reader skips it. CAPTURE_FLASH needs a "capture" partition
+// — see tiga_capture.h.
+#define CAPTURE_OFF    0
+#define CAPTURE_USB    1
+#define CAPTURE_FLASH  2
+#define CAPTURE_MODE   CAPTURE_OFF
+
+#if CAPTURE_MODE == CAPTURE_FLASH
+CaptureRecorder capture({ captureFlashWrite }, clockUs);
+#else
+CaptureRecorder capture({ captureSerialWrite, captureSerialRoom }, clockUs);
+#endif
+
+// ── Event log ────────────────────────────────────────────────
+// LOG() events go to the USB serial port as text lines, or as
+// binary frames for host/logcat with LOG_SERIAL_BINARY 1 (smaller,
+// timestamped, and tagged with the core). A phone subscribed to
+// the log characteristic gets frames either way.
+#ifndef LOG_SERIAL_BINARY
+#define LOG_SERIAL_BINARY 0
+#endif
+
+// ── Health history ───────────────────────────────────────────
+// One HistSample a second into the "history" partition. Sector
+// erases (~45 ms each) are done ahead at boot, sleep and session
+// reset, so the 1 s task only ever programs.
+HistoryStore history;
+bool         historyOK = false;
+
+// ── Statistics ───────────────────────────────────────────────
+// Core 1: a second of HR, SpO2, steps and altitude from `data`
+// per second since the session began (tiga_stats.h)
+StatsStore    stats;
+unsigned long statsStartMs = 0;
+int           statsLastSteps = 0;
+
+// Backfill to the phone over the BLE sync service (tiga_sync.h)
+SyncSender   historySync(history, { blePeerMtu, bleSyncSend }, clockUs);
+
+// Alert events to the phone, kept in the "alerts" partition until
+// it confirms them (tiga_alert_link.h)
+AlertLink    alertLink({ bleAlertIndicate }, clockMs);
+
+// FIFO burst reader — replaces per-loop getIR()/getRed()
+Max30102FifoSource ppgSrc(i2c, I2C_DEV_MAX);
+PpgAcquisition     ppgAcq(ppgSrc);
+
+// Core 1's copies of acq.mpuOK / maxOK / bmpOK
 bool mpuOK    = false;
 bool maxOK    = false;
 bool bmpOK    = false;
 
-// MPU health tracking
+// MPU health tracking — core 0, but for the copy of degraded
 unsigned long mpuReconnectCount   = 0;
 unsigned long mpuLastFailMs       = 0;
 unsigned long mpuConsecutiveZeros = 0;
 bool          mpuHealthDegraded   = false;
 
-// Step detection
-#define STEP_BUF_SIZE 10
-float         stepMagBuf[STEP_BUF_SIZE];
+// Step detection — 1s baseline window at the IMU rate
+#define STEP_BUF_SIZE IMU_RATE_HZ
+#define STEP_RISE     MOTION_G(0.15f)   // above the 1s baseline
+#define STEP_FALL     MOTION_G(0.08f)
+uint16_t      stepMagBuf[STEP_BUF_SIZE];      // |a| in counts
+int32_t       stepMagSum    = STEP_BUF_SIZE * MOTION_LSB_PER_G;  // starts at 1g
 int           stepBufIdx    = 0;
-float         stepBaseline  = 1.0f;
 bool          stepAboveThr  = false;
-unsigned long stepDebounce  = 0;
+uint32_t      stepDebounce  = 0;              // IMU sample ms
+
+// Balance score window — 5s of samples
+#define BALANCE_WINDOW (IMU_RATE_HZ * 5)
 
 // Session
 bool          sessionAnchored = false;
-unsigned long btn2HoldStart   = 0;
-bool          btn2Held        = false;
-#define RESET_HOLD_MS 3000
 
 // ── MAX30102 beat detection ───────────────────────────────────
 // SparkFun heartRate.h uses a circular buffer of recent IR peaks
 // to estimate BPM. We feed it one sample at a time.
 #define MAX_RATE_SIZE 4          // rolling average over last 4 beats
 byte    rates[MAX_RATE_SIZE];    // BPM values ring buffer
+byte    rateSqi[MAX_RATE_SIZE];  // quality of the block each came from
 byte    rateSpot    = 0;
-long    lastBeatMax = 0;         // millis of last beat
+byte    rateCount   = 0;         // HR is shown once the ring is full
+byte    rateQuality = 0;         // worst of rateSqi
+uint32_t lastBeatSample = 0;     // PPG sample index of last beat
 float   beatsPerMinute  = 0;
 float   beatAvg         = 0;
+float   spo2LastR       = 0;     // core 1's copy of acq.spo2R
+
+// The FIFO delivers ADC rate / sampleAverage samples per second.
+// 400 Hz averaged by 4 = 100 Hz out (411µs pulse allows up to 400).
+#define MAX_ADC_RATE     400
+#define MAX_SAMPLE_AVG   4
+#define SPO2_SAMPLE_RATE (MAX_ADC_RATE / MAX_SAMPLE_AVG)
+
+// SpO2 window — 4s holds several whole beats (tiga_spo2.h)
+#define SPO2_WINDOW      (SPO2_SAMPLE_RATE * 4)
+Spo2Estimator spo2Est(SPO2_WINDOW);
 
-// SpO2 algorithm needs 100-sample buffers
-// Using 25 samples at 25Hz = ~4s per reading (lighter on RAM)
-#define SPO2_SAMPLES   100
-#define SPO2_SAMPLE_RATE 100     // must match what we tell the sensor
+// Beat-to-beat intervals (tiga_hrv.h), core 0. Core 1 sees the
+// windows through acq.
+HrvTracker hrv(SPO2_SAMPLE_RATE);
+HrvStats   hrvShort = {};        // core 1's copies
+HrvStats   hrvLong  = {};
+uint32_t   hrvAccepted = 0, hrvRejected = 0;
 
 // IR threshold: below this = no finger present
 #define IR_FINGER_THRESHOLD  50000UL
 
+// Signal quality per block (tiga_ppg_sqi.h), core 0. The IMU
+// motion stage feeds it the accelerometer; both run on core 0.
+PpgQuality ppgQuality;
+uint16_t   ppgSkipRun   = 0;     // blocks skipped in a row
+uint8_t    ppgUsableRun = 0;     // usable blocks in a row, to PPG_SQI_SETTLE
+
+// Raw waveforms to the phone while a clinician session asks for
+// them (tiga_stream.h). Fed on core 0, sent from core 1.
+StreamSender stream({ blePeerMtu, bleStreamSend, bleStreamFast },
+                    SPO2_SAMPLE_RATE, IMU_RATE_HZ, clockMs);
+
 // ── BMP280 altitude tracking ─────────────────────────────────
-float altitudeBaseline  = 0;    // set on first valid reading
-bool  altBaselineSet    = false;
-float lastFloorAlt      = 0;
-#define FLOOR_HEIGHT_M  3.0f    // metres per floor
+// Core 0: fed by the fusion and step stages and readBMP280()
+AltitudeEngine altitude;
 
 // ── Step counter ─────────────────────────────────────────────
 int   stepCount  = 0;
 unsigned long lastStep = 0;
 
 // ── Fall detection ───────────────────────────────────────────
-bool  inFall     = false;
-unsigned long fallTime        = 0;
+// Core 0: every sample through imuFallStage (tiga_fall.h)
+FallDetector fallDetector;
 unsigned long fallConfirmStart = 0;
 int   fallCountdown = 10;
 
 // ── Activity timing ──────────────────────────────────────────
-unsigned long activityStart = 0;
+uint32_t activityStart = 0;          // IMU sample ms
 bool inActivity = false;
 
+// ── Tremor ───────────────────────────────────────────────────
+// Past sessions are kept in RTC memory, so they survive deep
+// sleep (not power loss). Core 1 sees them through acq.
+#define TREMOR_STILL_MS  2000                // no step for this long
+RTC_DATA_ATTR TremorTrend tremorTrend;       // core 0
+TremorSession tremorSession  = {};           // core 1's copies
+TremorTrend   tremorPast     = {};
+uint32_t      tremorChecks   = 0;            // windows analysed + skipped
+uint32_t      tremorSkipped  = 0;
+
 // ── Buttons ──────────────────────────────────────────────────
-bool btn1Last = false, btn2Last = false;
-bool btn1Pressed = false, btn2Pressed = false;
-unsigned long btn1HoldStart = 0;
-bool btn1Held = false;
+// Edges from the pin interrupts, events to handleInput() on core 1
+// (tiga_buttons.h). Reset, export and sleep run as screens of
+// their own from taskUI(), started at actionMs.
+ButtonInput   buttons;
+unsigned long actionMs   = 0;
+uint8_t       exportPart = 0;          // next report section to print
+
+void IRAM_ATTR button1Isr() { buttons.isr(0, digitalRead(BUTTON1_PIN) == LOW, micros()); }
+void IRAM_ATTR button2Isr() { buttons.isr(1, digitalRead(BUTTON2_PIN) == LOW, micros()); }
 
 // ── Menu ─────────────────────────────────────────────────────
 const char* menuItems[] = {
@@ -289,6 +620,7 @@ unsigned long lastPulse = 0;
 bool pulseOn = true;
 
 // ── Session tracking ─────────────────────────────────────────
+// Core 1; the HR extremes are copies of acq.peakHR / lowHR
 unsigned long sessionStart = 0;
 float   sessionPeakHR  = 0;
 float   sessionLowHR   = 999;
@@ -310,107 +642,35 @@ const char* monthNames[] = {"","Jan","Feb","Mar","Apr","May","Jun",
 //   HIGH   — full buzzer pattern + strong motor
 // ============================================================
 
-// ── Buzzer patterns ──────────────────────────────────────────
-// Each call is non-blocking-friendly via millis() but we use
-// simple blocking here — patterns are short (<1s) and only
-// fire on discrete events, not in the sensor loop.
-
-void buzzerGoalReached() {
-  // Three rising tones — celebratory
-  tone(BUZZER_PIN, 880, 100);  delay(130);
-  tone(BUZZER_PIN, 1047, 100); delay(130);
-  tone(BUZZER_PIN, 1319, 200); delay(220);
-  noTone(BUZZER_PIN);
-}
-
-void buzzerFallAlert() {
-  // Urgent descending double-beep
-  for (int i = 0; i < 3; i++) {
-    tone(BUZZER_PIN, 1500, 150); delay(180);
-    tone(BUZZER_PIN, 800, 150);  delay(180);
-  }
-  noTone(BUZZER_PIN);
-}
-
-void buzzerSosConfirm() {
-  // SOS in morse: ... --- ...
-  int dot = 100, dash = 300, gap = 120, letterGap = 360;
-  // S (...)
-  for (int i=0;i<3;i++){tone(BUZZER_PIN,1000,dot);delay(dot+gap);}
-  delay(letterGap);
-  // O (---)
-  for (int i=0;i<3;i++){tone(BUZZER_PIN,1000,dash);delay(dash+gap);}
-  delay(letterGap);
-  // S (...)
-  for (int i=0;i<3;i++){tone(BUZZER_PIN,1000,dot);delay(dot+gap);}
-  noTone(BUZZER_PIN);
-}
-
-void buzzerLowBattery() {
-  // Two slow low beeps
-  tone(BUZZER_PIN, 400, 400); delay(500);
-  tone(BUZZER_PIN, 400, 400); delay(500);
-  noTone(BUZZER_PIN);
-}
-
-// ── Motor patterns ───────────────────────────────────────────
-void motorGentlePulse() {
-  // Single soft pulse — worn confirmation, goal nudge
-  digitalWrite(MOTOR_PIN, HIGH); delay(80);
-  digitalWrite(MOTOR_PIN, LOW);
-}
+// Patterns live in tiga_alerts.h as step tables. The sequencer
+// plays buzzer and motor together from a 10ms task, so none of
+// these calls block — they return immediately.
 
-void motorTripleBuzz() {
-  // Three short pulses — attention getter
-  for (int i = 0; i < 3; i++) {
-    digitalWrite(MOTOR_PIN, HIGH); delay(80);
-    digitalWrite(MOTOR_PIN, LOW);  delay(100);
-  }
+// ── Output drivers ───────────────────────────────────────────
+void buzzerTone(uint16_t hz) {
+  if (hz) tone(BUZZER_PIN, hz);
+  else    noTone(BUZZER_PIN);
 }
 
-void motorHeartbeat() {
-  // Double-tap like a heartbeat — for HR alerts
-  digitalWrite(MOTOR_PIN, HIGH); delay(60);
-  digitalWrite(MOTOR_PIN, LOW);  delay(80);
-  digitalWrite(MOTOR_PIN, HIGH); delay(60);
-  digitalWrite(MOTOR_PIN, LOW);
+void motorDrive(bool on) {
+  digitalWrite(MOTOR_PIN, on ? HIGH : LOW);
 }
 
-void motorLongBuzz() {
-  // Long continuous buzz — SOS / fall
-  digitalWrite(MOTOR_PIN, HIGH); delay(600);
-  digitalWrite(MOTOR_PIN, LOW);
-}
+AlertSequencer alerts({ buzzerTone, motorDrive });
 
-// ── Alert tier functions ──────────────────────────────────────
-void alertLow() {
-  // Motor only — gentle, non-intrusive
-  motorGentlePulse();
-}
+void taskAlertSeq() { alerts.update(millis()); }
 
-void alertMedium() {
-  // Motor + short buzzer
-  motorTripleBuzz();
-  delay(100);
-  tone(BUZZER_PIN, 1000, 200);
-  noTone(BUZZER_PIN);
-}
+// ── Single-channel patterns ──────────────────────────────────
+void motorGentlePulse() { alerts.play(ALERT_LOW,  millis()); }
+void motorHeartbeat()   { alerts.play(ALERT_FALL, millis()); }
 
-void alertHigh() {
-  // Full buzzer pattern + strong motor — for fall / HR emergency
-  motorLongBuzz();
-  buzzerFallAlert();
-}
-
-void alertGoal() {
-  motorTripleBuzz();
-  buzzerGoalReached();
-}
-
-void alertSOS() {
-  motorLongBuzz();
-  buzzerSosConfirm();
-}
+// ── Alert tier functions ──────────────────────────────────────
+void alertLow()    { alerts.play(ALERT_LOW,    millis()); }  // motor only
+void alertMedium() { alerts.play(ALERT_MEDIUM, millis()); }  // motor + short tone
+void alertHigh()   { alerts.play(ALERT_HIGH,   millis()); }  // fall / HR emergency
+void alertGoal()   { alerts.play(ALERT_GOAL,   millis()); }
+void alertSOS()    { alerts.play(ALERT_SOS,    millis()); }
+void alertLowBattery() { alerts.play(ALERT_LOWBAT, millis()); }
 
 // Track goal alert so we only fire it once per session
 bool goalAlertFired = false;
@@ -422,7 +682,15 @@ bool lowBatAlertFired = false;
 // SETUP
 // ============================================================
 void setup() {
+#if CAPTURE_MODE == CAPTURE_USB
+  Serial.setTxBufferSize(CAP_SERIAL_TX_BYTES);   // room for the largest record
+#endif
   Serial.begin(115200);
+  eventLog().begin(clockUs);
+#if CAPTURE_MODE != CAPTURE_USB
+  // Only what fits in the UART FIFO now, as the USB capture does
+  eventLog().addSink({ captureSerialWrite, !LOG_SERIAL_BINARY, false });
+#endif
 
   pinMode(LCD_PWR_PIN, OUTPUT);
   digitalWrite(LCD_PWR_PIN, HIGH);
@@ -435,80 +703,63 @@ void setup() {
 
   tft.init();
   tft.setRotation(1);
-  tft.setSwapBytes(true);
-  tft.fillScreen(C_BG);
+  tft.setSwapBytes(false);     // canvas pixels are already in bus order
+  if (canvas.createSprite(W, H)) {
+    gfx.begin((const uint16_t*)canvas.getPointer(), W, H);
+  } else {
+    Serial.println("[TIGA] No RAM for the frame canvas — enable PSRAM");
+  }
+#if LCD_DMA
+  tft.initDMA(true);
+#endif
   pinMode(TFT_BL, OUTPUT);
   digitalWrite(TFT_BL, HIGH);
 
   drawSplash();
+  lcdFlush();
   delay(2500);
 
   // ── I2C + sensors ────────────────────────────────────────
-  i2cBusRecover();
-  Wire.begin(I2C_SDA, I2C_SCL);
-  Wire.setClock(100000);
+  // A part that fails here is retried by the bus engine
+  i2cRestart();
   delay(200);
+  i2c.addDevice("mpu", MPU6050_ADDR,  0, mpuInit, &acq.mpuOK);
+  i2c.addDevice("max", MAX30102_ADDR, 1, maxInit, &acq.maxOK);
+  i2c.addDevice("bmp", BMP280_ADDR,   2, bmpInit, &acq.bmpOK);
 
   // MPU6050
-  mpuOK = false;
-  for (int attempt = 1; attempt <= 3 && !mpuOK; attempt++) {
-    mpu.initialize();
-    mpu.setFullScaleAccelRange(MPU6050_ACCEL_FS_4);
-    mpu.setDLPFMode(MPU6050_DLPF_BW_20);
-    delay(100);
-    mpuOK = mpu.testConnection();
-    Serial.printf("[TIGA] MPU6050 init attempt %d: %s\n",
-                  attempt, mpuOK ? "OK" : "FAIL");
-    if (!mpuOK) delay(200);
-  }
+  Serial.printf("[TIGA] MPU6050 init: %s\n", i2c.start(I2C_DEV_MPU) ? "OK" : "FAIL");
+  imuPipe.addStage("motion",   imuMotionStage,   20);
+  imuPipe.addStage("fusion",   imuFusionStage,   10);
+  imuPipe.addStage("fall",     imuFallStage,      5);
+  imuPipe.addStage("steps",    imuStepStage,      5);
+  imuPipe.addStage("balance",  imuBalanceStage,   5);
+  imuPipe.addStage("activity", imuActivityStage,  5);
+  imuPipe.addStage("tremor",   imuTremorStage,    5);
+  imuPipe.addStage("capture",  imuCaptureStage,   5);
+  imuPipe.addStage("stream",   imuStreamStage,    5);
+  acq.tremorTrend = tremorTrend;   // from before the last deep sleep
 
   // MAX30102
-  // begin() returns false if sensor not found on I2C bus
-  if (max30102.begin(Wire, I2C_SPEED_STANDARD)) {
-    maxOK = true;
-    // Sample rate 100Hz, 16 bit ADC, 411µs pulse width, range 16384
-    max30102.setup(60,           // LED brightness 0-255 (60 = moderate)
-                   4,            // sampleAverage: average 4 samples
-                   2,            // ledMode: 2 = red + IR
-                   SPO2_SAMPLE_RATE, // sampleRate: 100 Hz
-                   411,          // pulseWidth: 411µs (best resolution)
-                   16384);       // adcRange: 16384
-    max30102.setPulseAmplitudeRed(60);
-    max30102.setPulseAmplitudeIR(60);
-    Serial.println("[TIGA] MAX30102 init OK");
-  } else {
-    maxOK = false;
-    Serial.println("[TIGA] MAX30102 not found — check wiring at 0x57");
-  }
+  if (i2c.start(I2C_DEV_MAX)) Serial.println("[TIGA] MAX30102 init OK");
+  else Serial.println("[TIGA] MAX30102 not found — check wiring at 0x57");
 
   // BMP280
-  // Default I2C address for Adafruit BMP280 breakout is 0x76
-  if (bmp280.begin(0x76)) {
-    bmpOK = true;
-    // Recommended settings for indoor navigation / altitude
-    bmp280.setSampling(
-      Adafruit_BMP280::MODE_NORMAL,
-      Adafruit_BMP280::SAMPLING_X2,   // temperature oversampling
-      Adafruit_BMP280::SAMPLING_X16,  // pressure oversampling (high res)
-      Adafruit_BMP280::FILTER_X16,    // IIR filter (smooths noise)
-      Adafruit_BMP280::STANDBY_MS_500 // 500ms standby
-    );
-    Serial.println("[TIGA] BMP280 init OK");
-  } else {
-    bmpOK = false;
-    Serial.println("[TIGA] BMP280 not found — check wiring at 0x76");
-  }
+  if (i2c.start(I2C_DEV_BMP)) Serial.println("[TIGA] BMP280 init OK");
+  else Serial.println("[TIGA] BMP280 not found — check wiring at 0x76");
 
   // Step detection baseline
-  for (int i = 0; i < STEP_BUF_SIZE; i++) stepMagBuf[i] = 1.0f;
+  for (int i = 0; i < STEP_BUF_SIZE; i++) stepMagBuf[i] = MOTION_LSB_PER_G;
+  stepMagSum = STEP_BUF_SIZE * MOTION_LSB_PER_G;
 
   // WiFi + NTP
   if (strlen(WIFI_SSID) > 0) {
-    tft.fillScreen(C_BG);
-    tft.setTextDatum(MC_DATUM);
-    tft.setTextColor(C_MUTED);
-    tft.setTextSize(1);
-    tft.drawString("Connecting to WiFi...", W/2, H/2);
+    canvas.fillScreen(C_BG);
+    canvas.setTextDatum(MC_DATUM);
+    canvas.setTextColor(C_MUTED);
+    canvas.setTextSize(1);
+    canvas.drawString("Connecting to WiFi...", W/2, H/2);
+    lcdFlush();
     WiFi.begin(WIFI_SSID, WIFI_PASS);
     int tries = 0;
     while (WiFi.status() != WL_CONNECTED && tries < 20) {
@@ -530,50 +781,322 @@ void setup() {
   needsFullDraw = true;
   state = STATE_CLOCK;
   sessionStart = millis();
+  statsStartMs = sessionStart;
 
   // Startup confirmation buzz
   motorGentlePulse();
 
+  // Core 0 isn't running yet: take its first snapshot by hand
+  acqPublish();
+  acqPull();
+
   Serial.println("[TIGA] v6a boot complete");
   Serial.printf("[TIGA] Sensors: MPU=%s  MAX=%s  BMP=%s\n",
                 mpuOK?"OK":"FAIL", maxOK?"OK":"FAIL", bmpOK?"OK":"FAIL");
 
+  HistFlash alertFlash;
+  if (alertFlashBegin(&alertFlash) && alertLink.begin(alertFlash))
+    Serial.printf("[TIGA] Alerts: %u waiting for the phone\n", alertLink.waiting());
+  else
+    Serial.println("[TIGA] Alerts: no 'alerts' partition — held in RAM only");
+  bleAlerts = &alertLink;
+  bleStream = &stream;
+
   bleSetup();
+  eventLog().addSink({ bleLogWrite, false, true });
+
+#if CAPTURE_MODE != CAPTURE_OFF
+  bool capOK = (CAPTURE_MODE != CAPTURE_FLASH) || captureFlashBegin();
+  if (capOK) {
+    capture.begin(millis());
+    capture.config(IMU_RATE_HZ, SPO2_SAMPLE_RATE, 8192, 1310);  // ±4g, ±250°/s
+    Serial.println("[TIGA] Raw capture started");
+  } else {
+    Serial.println("[TIGA] Raw capture: no 'capture' partition");
+  }
+#endif
+
+  HistFlash histFlash;
+  historyOK = historyFlashBegin(&histFlash) && history.begin(histFlash);
+  if (historyOK) {
+    history.prepare(HIST_ERASE_AHEAD);
+    Serial.printf("[TIGA] History: %u of %u sectors used, %u erased ahead\n",
+                  history.used(), history.sectors(), history.reserve());
+    bleSync = &historySync;
+  } else {
+    Serial.println("[TIGA] History: no 'history' partition");
+  }
+
+  // Both FIFOs have been overflowing through the splash, WiFi and
+  // NTP delays — drop that backlog so counting starts at sample 0
+  if (mpuOK) {
+    imuSrc.configure();
+    imuPipe.reset();
+  }
+  if (maxOK) {
+    max30102.clearFIFO();
+    ppgAcq.reset();
+  }
+
+  // Presses from here on; the ISRs run on this core, as taskInput does
+  attachInterrupt(digitalPinToInterrupt(BUTTON1_PIN), button1Isr, CHANGE);
+  attachInterrupt(digitalPinToInterrupt(BUTTON2_PIN), button2Isr, CHANGE);
+
+  setupTasks();
+  if (!coreStart("acq", acqLoop, ACQ_CORE, ACQ_STACK, ACQ_PRIORITY))
+    Serial.println("[TIGA] Could not start the sensor core");
 }
 
 // ============================================================
 // MAIN LOOP
 // ============================================================
 void loop() {
-  readButtons();
+  // Runs the most urgent due task, or idles the core until one is due
+  sched.runOnce();
+}
+
+// Core 0's loop: one sensor task, then publish what it changed
+void acqLoop() {
+  if (acqSched.runOnce()) acqPublish();
+}
+
+// ============================================================
+// TASKS
+// Period / priority / budget live in setupTasks(). Budgets are
+// the normal worst case — anything slower is counted as an
+// overrun in the scheduler report (see exportSession()).
+// imu, ppg, i2c, capture, sensors and cmds run on core 0 and
+// write only acq; the rest run in loop() on core 1.
+// ============================================================
+void taskInput() {
+  noInterrupts();
+  buttons.settle(micros());
+  interrupts();
   handleInput();
+}
 
-  static unsigned long lastSensor = 0;
-  if (millis() - lastSensor >= 100) {
-    lastSensor = millis();
-    readMPUSensor();
-    readBMP280();
-    readBattery();
+void taskSensors() {
+  readMPUSlow();
+  i2c.post(I2C_DEV_BMP, readBMP280);
+  readBattery();
+}
+
+// The tremor stage only fills the ring; the FFTs run here, one
+// window every 1.28 s, where they can't hold up an IMU drain
+void taskTremor() {
+  TremorResult r;
+  if (!tremor.due()) return;
+  if (tremor.analyze(r)) {
+    acq.data.tremorHz     = r.present ? r.hz : 0;
+    acq.data.tremorDps    = r.present ? r.dps : 0;
+    acq.data.tremorAmpDeg = r.present ? r.ampDeg : 0;
+    acq.tremor            = tremor.session();
   }
+  acq.tremorWindows = tremor.windows;
+  acq.tremorSkipped = tremor.skipped;
+}
 
-  // MAX30102 needs faster sampling — run every loop iteration
-  readMAX30102();
+// ── Crossing between the cores ───────────────────────────────
+// Core 0, after each task
+void acqPublish() {
+  acqPub.write(acq);
+}
 
-  // GPS
-  while (gpsSerial.available()) gps.encode(gpsSerial.read());
-  static unsigned long lastGPS = 0;
-  if (millis() - lastGPS >= 2000) {
-    lastGPS = millis();
-    readGPS();
+// Core 0 posts; drops (counted in acqEvents.dropped) only if
+// core 1 has stalled for 16 of them
+void acqEvent(uint8_t type, int16_t count = 0, float value = 0) {
+  acqEvents.push({ type, count, value });
+}
+
+// Core 1
+void acqCommand(const AcqCmd& c) {
+  acqCmds.push(c);
+}
+
+// Core 1: copy the newest snapshot, then act on events
+void acqPull() {
+  uint32_t v = acqPub.version();
+  if (v != acqSeen) {
+    AcqSnapshot snap;
+    acqSeen           = acqPub.read(snap);
+    acqPulls++;
+    data              = snap.data;
+    daily             = snap.daily;
+    sessionPeakHR     = snap.peakHR;
+    sessionLowHR      = snap.lowHR;
+    spo2LastR         = snap.spo2R;
+    mpuOK             = snap.mpuOK;
+    maxOK             = snap.maxOK;
+    bmpOK             = snap.bmpOK;
+    mpuHealthDegraded = snap.mpuDegraded;
+    tremorSession     = snap.tremor;
+    tremorPast        = snap.tremorTrend;
+    tremorSkipped     = snap.tremorSkipped;
+    hrvLong           = snap.hrv5;
+    hrvAccepted       = snap.hrvAccepted;
+    hrvRejected       = snap.hrvRejected;
+    if (snap.hrv1.valid != hrvShort.valid ||
+        lroundf(snap.hrv1.rmssdMs) != lroundf(hrvShort.rmssdMs)) {
+      if (state == STATE_HEART) needsFullDraw = true;
+    }
+    hrvShort          = snap.hrv1;
+    if (snap.tremorWindows + snap.tremorSkipped != tremorChecks) {
+      tremorChecks = snap.tremorWindows + snap.tremorSkipped;
+      if (state == STATE_DEXTERITY) needsFullDraw = true;
+    }
+    if (!sessionAnchored && snap.firstStepMs) {
+      sessionStart    = snap.firstStepMs;
+      sessionAnchored = true;
+    }
+  }
+
+  AcqEvent e;
+  while (acqEvents.pop(e)) {
+    switch (e.type) {
+      case EV_FALL:
+        LOG(FALL, e.count, e.value);
+        // Another fall during the countdown changes nothing
+        if (state == STATE_FALL_CONFIRM) break;
+        fallConfirmStart = millis();
+        fallCountdown = 10;
+        state = STATE_FALL_CONFIRM;
+        needsFullDraw = true;
+        motorHeartbeat();  // alert user before countdown starts
+        break;
+      case EV_FLOOR:
+        LOG(FLOOR, e.count, e.value);
+        alertLow();        // gentle motor pulse on floor climbed
+        break;
+      case EV_FLOOR_DOWN:
+        LOG(FLOOR_DOWN, e.count, e.value);
+        break;
+    }
   }
+}
+
+void taskPull() {
+  acqPull();
+}
 
-  // Time tick
-  static unsigned long lastTimeTick = 0;
-  if (millis() - lastTimeTick >= 1000) {
-    lastTimeTick = millis();
-    tickTime();
+// Core 0
+void taskCmds() {
+  AcqCmd c;
+  while (acqCmds.pop(c)) {
+    switch (c.type) {
+      case CMD_SESSION_RESET:  acqResetSession(); break;
+      case CMD_FALL_CONFIRMED: acq.daily.fallCount++; break;
+      case CMD_SOS:            acq.daily.sosCount++; break;
+      case CMD_CAPTURE_BUTTON: capture.button(c.button, c.on); break;
+      case CMD_CAPTURE_GPS:    capture.gps(c.lat, c.lng, c.speedKmh, c.sats, c.on); break;
+      case CMD_SLEEP:          tremorCloseSession(); break;
+    }
   }
+}
+
+void taskImu() {
+  i2c.post(I2C_DEV_MPU, readMPUSensor);
+}
+
+// Blocks the last drain completed, then ask for the next one
+void taskPpg() {
+  while (const PpgBlock* blk = ppgAcq.front()) {
+    processPpgBlock(*blk);
+    ppgAcq.pop();
+  }
+  i2c.post(I2C_DEV_MAX, readMAX30102);
+}
 
+void taskI2c() {
+  i2c.run(3000);
+}
+
+void taskCapture() {
+  capture.drain();
+}
+
+void taskHistory() {
+  if (!historyOK) return;
+  HistSample s;
+  s.t       = (uint32_t)time(nullptr);     // keeps counting through deep sleep
+  s.hr      = (uint8_t)constrain(lroundf(data.heartRate), 0, 255);
+  s.spo2    = data.spO2Valid ? data.spO2 : 0;
+  s.battery = (uint8_t)constrain(lroundf(data.battery), 0, 100);
+  s.worn    = data.wearing;
+  s.steps   = data.steps;
+  s.altDm   = bmpOK ? lroundf(data.altitudeM * 10) : 0;
+  // One sample per second at most: sync resumes by timestamp
+  if (!history.empty() && s.t == history.last().t) return;
+  history.append(s);
+}
+
+// One push per second since the session began; a late run
+// catches up with the same readings
+void taskStats() {
+  int16_t v[STAT_METRICS];
+  v[STAT_HR]    = data.wearing && data.heartRate > 0 ? (int16_t)lroundf(data.heartRate) : STATS_NONE;
+  v[STAT_SPO2]  = data.spO2Valid ? data.spO2 : STATS_NONE;
+  v[STAT_STEPS] = (int16_t)constrain(data.steps - statsLastSteps, 0, 100);
+  v[STAT_ALT]   = bmpOK ? (int16_t)constrain(lroundf(data.altitudeM * 10), -32000, 32000) : STATS_NONE;
+  statsLastSteps = data.steps;
+  uint32_t due = (millis() - statsStartMs) / 1000;
+  while (stats.seconds() < due) {
+    stats.push(v);
+    v[STAT_STEPS] = 0;
+  }
+}
+
+void taskSync() {
+  if (historyOK) historySync.run();
+}
+
+void taskStream() {
+  stream.run();
+}
+
+void taskLog() {
+  eventLog().drain();
+}
+
+// Write out the buffered seconds and erase ahead — a stall of up
+// to HIST_ERASE_AHEAD × 45 ms, so only where nothing is timed
+void historyCheckpoint() {
+  if (!historyOK) return;
+  history.flush();
+  history.prepare(HIST_ERASE_AHEAD);
+  historySync.reseek();
+}
+
+void taskGpsRx() {
+  while (gpsSerial.available()) gps.encode(gpsSerial.read());
+}
+
+// An alert for the phone (tiga_alert_link.h): when, and where the
+// watch last knew it was. Sent by taskBleAlert() as soon as a
+// phone is listening.
+void raiseAlert(AlertType type, AlertSeverity severity) {
+  AlertEvent e;
+  e.type     = type;
+  e.severity = severity;
+  e.t        = (uint32_t)time(nullptr);
+  if (gpsData.fixMs) {
+    unsigned long age = (millis() - gpsData.fixMs) / 1000;
+    e.lat7    = (int32_t)lround(gpsData.lat * 1e7);
+    e.lng7    = (int32_t)lround(gpsData.lng * 1e7);
+    e.fixAgeS = (uint16_t)(age < ALERT_NO_FIX ? age : ALERT_NO_FIX - 1);
+    e.sats    = (uint8_t)constrain(gpsData.fixSats, 0, 255);
+  }
+  uint32_t id = alertLink.raise(e);
+  LOG(ALERT_RAISED, id, (unsigned)type, (unsigned)severity, (unsigned)alertLink.waiting());
+}
+
+void taskBleAlert() {
+  uint32_t before = alertLink.confirmed;
+  alertLink.run();
+  if (alertLink.confirmed != before)
+    LOG(ALERT_CONFIRMED, alertLink.latLastMs, (unsigned)alertLink.waiting());
+}
+
+void taskAlerts() {
   // Goal alert — fire once when steps cross the goal
   if (!goalAlertFired && data.steps >= STEPS_GOAL) {
     goalAlertFired = true;
@@ -583,10 +1106,31 @@ void loop() {
   // Low battery alert — fire once per session
   if (!lowBatAlertFired && data.battery > 0 && data.battery < 15.0f) {
     lowBatAlertFired = true;
-    alertLow();
-    buzzerLowBattery();
+    alertLowBattery();
+    raiseAlert(ALERT_EV_BATTERY, ALERT_SEV_INFO);
+  }
+
+  // HR emergency — 3 consecutive bad readings. A reading with a
+  // doubtful beat or block behind it (tiga_ppg_sqi.h) counts
+  // neither way: arm swing read as a pulse isn't an emergency.
+  static int consecutiveBadHR = 0;
+  if (mpuOK && data.heartRate > 0 && data.hrQuality >= PPG_SQI_GOOD &&
+      (state == STATE_CLOCK || state == STATE_HEALTH)) {
+    if (data.heartRate > HR_WARN_HIGH || data.heartRate < HR_WARN_LOW) {
+      if (++consecutiveBadHR >= 3) {
+        alertHigh();
+        raiseAlert(data.heartRate > HR_WARN_HIGH ? ALERT_EV_HR_HIGH : ALERT_EV_HR_LOW, ALERT_SEV_WARNING);
+        state = STATE_EMERGENCY;
+        needsFullDraw = true;
+        consecutiveBadHR = 0;
+      }
+    } else {
+      consecutiveBadHR = 0;
+    }
   }
+}
 
+void taskUI() {
   // State change → full redraw
   if (state != lastState) {
     needsFullDraw = true;
@@ -595,27 +1139,19 @@ void loop() {
 
   if (needsFullDraw) {
     drawScreenFull();
+    gfx.commit();
     needsFullDraw = false;
     copyPrev();
     return;
   }
 
-  // Partial updates every second
-  static unsigned long lastUpdate = 0;
-  if (millis() - lastUpdate >= 1000) {
-    lastUpdate = millis();
-    if (state == STATE_CLOCK)  drawClockPartial();
-    if (state == STATE_HEALTH) drawHealthPartial();
-    copyPrev();
-    bleNotify();
-  }
-
   // Emergency pulse animation
   if ((state == STATE_EMERGENCY || state == STATE_SOS) &&
       millis() - lastPulse > 800) {
     lastPulse = millis();
     pulseOn = !pulseOn;
     drawEmergency();
+    gfx.commit();
   }
 
   // Fall confirm countdown
@@ -625,16 +1161,142 @@ void loop() {
     if (remaining != fallCountdown) {
       fallCountdown = remaining;
       drawFallConfirm();
+      gfx.commit();
     }
     if (remaining <= 0) {
-      daily.fallCount++;
+      acqCommand({ CMD_FALL_CONFIRMED });   // daily is core 0's
       alertHigh();
+      raiseAlert(ALERT_EV_FALL, ALERT_SEV_CRITICAL);
       state = STATE_EMERGENCY;
       needsFullDraw = true;
     }
   }
 
-  delay(20);
+  // Export keeps going if a fall takes the screen; the others
+  // give way to it
+  if (exportPart < EXPORT_PARTS && (state == STATE_EXPORT || exportPart > 0)) {
+    exportSection(exportPart++);
+    if (exportPart == EXPORT_PARTS) {
+      actionMs = millis();
+      if (state == STATE_EXPORT) needsFullDraw = true;
+    }
+  } else if (state == STATE_EXPORT && millis() - actionMs >= EXPORT_SHOW_MS) {
+    state = STATE_CLOCK;
+    needsFullDraw = true;
+  }
+  if (state == STATE_RESET) {
+    if (millis() - actionMs >= RESET_SHOW_MS) { state = STATE_CLOCK; needsFullDraw = true; }
+    else if (drawResetBar(false)) gfx.commit();
+  }
+  if (state == STATE_SLEEP) sleepStep();
+}
+
+// Sends the committed frame a band at a time. On a DMA bus the
+// transfer runs on while the sensor tasks do; without DMA each
+// band blocks for its bus time, so stop once a slice is used up.
+void lcdPushBand(const GfxBand* b) {
+#if LCD_DMA
+  tft.pushImageDMA(b->x, b->y, b->w, b->h, (uint16_t*)b->px);
+#else
+  tft.pushImage(b->x, b->y, b->w, b->h, b->px);
+#endif
+}
+
+void taskLcd() {
+  uint32_t t0 = micros();
+  while (micros() - t0 < LCD_SLICE_US) {
+#if LCD_DMA
+    if (tft.dmaBusy()) break;          // bounce buffer still in use
+#endif
+    const GfxBand* b = gfx.next();
+    if (!b) break;
+    lcdPushBand(b);
+  }
+}
+
+// Whole frame, blocking — for screens shown outside the scheduler
+// (splash, WiFi)
+void lcdFlush() {
+  gfx.commit();
+  for (;;) {
+#if LCD_DMA
+    tft.dmaWait();                     // bounce buffer free again
+#endif
+    const GfxBand* b = gfx.next();
+    if (!b) break;
+    lcdPushBand(b);
+  }
+}
+
+// Partial updates + BLE snapshot every second
+void taskRefresh() {
+  if (needsFullDraw) return;   // taskUI repaints everything first
+  if (state == STATE_CLOCK)  drawClockPartial();
+  if (state == STATE_HEALTH) drawHealthPartial();
+  gfx.commit();
+  copyPrev();
+  bleNotify();
+  traceSensors();
+}
+
+void setupTasks() {
+  // Core 0 — sensors and signal processing
+  //           name       fn            period ms  prio  budget µs
+  acqSched.add("cmds",    taskCmds,         10,    0,    500);
+  acqSched.add("imu",     taskImu,          20,    1,    200);  // 4 samples/drain
+  acqSched.add("capture", taskCapture,      10,    1,   1000);
+  acqSched.add("ppg",     taskPpg,          50,    1,   3000);  // 5 samples/drain
+  acqSched.add("sensors", taskSensors,     100,    2,   5000);
+  acqSched.add("tremor",  taskTremor,      100,    3,   3000);  // 3 FFTs per 1.28 s
+  // Posted bus jobs, MPU first; a post makes it due at once
+  i2cTask = acqSched.add("i2c", taskI2c,    10,    1,   3000);
+
+  // Core 1 — everything the wearer sees, BLE and flash
+  //        name        fn            period ms  prio  budget µs
+  sched.add("input",    taskInput,        10,    0,   2000);
+  sched.add("alertSeq", taskAlertSeq,     10,    0,    200);
+  sched.add("bleAlert", taskBleAlert,     20,    1,   1000);  // one indication at a time
+  sched.add("pull",     taskPull,         10,    0,    500);  // core 0's snapshot + events
+  sched.add("lcd",      taskLcd,          20,    2,   4000);  // ≤ LCD_SLICE_US of bus
+  sched.add("ui",       taskUI,           20,    2,  10000);  // full redraw, RAM only
+  sched.add("gpsRx",    taskGpsRx,       100,    3,   1000);
+  sched.add("alerts",   taskAlerts,      100,    3,   1000);
+  sched.add("time",     tickTime,       1000,    3,   1000);
+  sched.add("refresh",  taskRefresh,    1000,    4,   5000);
+  sched.add("history",  taskHistory,    1000,    4,   2000);  // a flash block every 30 s
+  sched.add("stats",    taskStats,      1000,    4,    500);
+  sched.add("sync",     taskSync,         20,    3,   3000);  // ≤ SYNC_BURST chunks
+  sched.add("stream",   taskStream,       10,    1,   2000);  // ≤ STREAM_BURST frames
+  sched.add("gps",      readGPS,        2000,    4,   1000);
+  sched.add("log",      taskLog,          20,    5,   2000);  // ≤ LOG_DRAIN_MAX events
+
+  // A task the table had no room for would never run
+  if (acqSched.refused || sched.refused)
+    Serial.printf("[TIGA] %u tasks refused: over SCHED_MAX_TASKS (%d)\n",
+                  acqSched.refused + sched.refused, SCHED_MAX_TASKS);
+
+  acqSched.start();
+  sched.start();
+}
+
+// Idle hook — delay() blocks in vTaskDelay, so the core sleeps in
+// the FreeRTOS idle task. The sub-millisecond remainder is spun
+// off in one go rather than by re-scanning the task table.
+void schedIdle(uint32_t us) {
+  if (us >= 1000) delay(us / 1000);
+  else            delayMicroseconds(us);
+}
+
+void printSchedReport(const Scheduler& sc) {
+  Serial.println("  task      runs   miss  over  maxJit(us)  avgRun(us)  maxRun(us)");
+  for (uint8_t i = 0; i < sc.count(); i++) {
+    const SchedTask& t = sc.task(i);
+    Serial.printf ("  %-8s %6lu %5lu %5lu %10lu %11lu %11lu\n",
+                   t.name, (unsigned long)t.runs, (unsigned long)t.missed,
+                   (unsigned long)t.overruns, (unsigned long)t.maxJitterUs,
+                   (unsigned long)(t.runs ? t.sumRunUs / t.runs : 0),
+                   (unsigned long)t.maxRunUs);
+  }
 }
 
 // ── copyPrev ─────────────────────────────────────────────────
@@ -687,6 +1349,8 @@ void readGPS() {
     double lng = gps.location.lng();
     gpsData.lat = lat;
     gpsData.lng = lng;
+    gpsData.fixMs   = millis() - gps.location.age();
+    gpsData.fixSats = gpsData.satellites;
     if (gps.speed.isValid()) {
       float raw = gps.speed.kmph();
       gpsData.speedKmh = (raw < 0.5f) ? 0.0f : raw;
@@ -707,16 +1371,67 @@ void readGPS() {
   } else {
     gpsData.speedKmh = 0;
   }
+
+  AcqCmd c = { CMD_CAPTURE_GPS };
+  c.on       = gpsData.hasFix;
+  c.sats     = (uint8_t)gpsData.satellites;
+  c.speedKmh = gpsData.speedKmh;
+  c.lat      = gpsData.lat;
+  c.lng      = gpsData.lng;
+  acqCommand(c);
 }
 
 // ============================================================
-// I2C BUS RECOVERY (unchanged from v5.2)
+// I2C BUS
+// The engine's wire: plain Wire transfers, and a restart that
+// clocks a stuck slave off SDA first. Wire's own timeout is cut
+// to I2C_TIMEOUT_MS so a stretched clock can't hold the core.
 // ============================================================
+bool i2cWrite(uint8_t addr, const uint8_t* p, uint8_t n, bool stop) {
+  Wire.beginTransmission(addr);
+  Wire.write(p, n);
+  return Wire.endTransmission(stop) == 0;
+}
+
+bool i2cRead(uint8_t addr, uint8_t* p, uint8_t n) {
+  if (Wire.requestFrom(addr, n) != n) return false;
+  for (uint8_t i = 0; i < n; i++) p[i] = (uint8_t)Wire.read();
+  return true;
+}
+
+void i2cRestart() {
+  i2cBusRecover();
+  Wire.begin(I2C_SDA, I2C_SCL);
+  Wire.setClock(I2C_BUS_HZ);
+  Wire.setTimeOut(I2C_TIMEOUT_MS);
+}
+
+// A job was posted: run the bus task now rather than next period.
+// Posts only come from core 0, so this is its own scheduler.
+void i2cKick() {
+  acqSched.trigger(i2cTask);
+}
+
+void printI2cReport() {
+  Serial.println("  dev   up   jobs  xfers  err  retry  tmo  down  reinit  avgLat(us)  maxLat(us)");
+  for (uint8_t i = 0; i < i2c.count(); i++) {
+    const I2cDevice& d = i2c.device(i);
+    Serial.printf ("  %-4s %3d %6lu %6lu %4lu %6lu %4lu %5lu %7lu %11lu %11lu\n",
+                   d.name, d.up ? 1 : 0, (unsigned long)d.jobs, (unsigned long)d.xfers,
+                   (unsigned long)d.errors, (unsigned long)d.retries,
+                   (unsigned long)d.timeouts, (unsigned long)d.downs,
+                   (unsigned long)d.reinits,
+                   (unsigned long)(d.jobs ? d.sumLatUs / d.jobs : 0),
+                   (unsigned long)d.maxLatUs);
+  }
+}
+
+// Unchanged from v5.2
 void i2cBusRecover() {
   pinMode(I2C_SCL, OUTPUT_OPEN_DRAIN);
   pinMode(I2C_SDA, INPUT_PULLUP);
   if (digitalRead(I2C_SDA) == HIGH) return;
-  Serial.println("[TIGA] I2C SDA stuck — recovering");
+  LOG(I2C_STUCK);
   for (int i = 0; i < 9; i++) {
     digitalWrite(I2C_SCL, LOW);  delayMicroseconds(5);
     pinMode(I2C_SCL, INPUT_PULLUP); delayMicroseconds(5);
@@ -731,306 +1446,429 @@ void i2cBusRecover() {
 }
 
 // ============================================================
-// MPU6050 (largely unchanged from v5.2)
+// MPU6050 — 200Hz FIFO pipeline (tiga_imu_fifo.h)
+// Every sample runs through motion → fusion → fall → steps →
+// balance → activity. Stage times are on the sensor's own sample clock
+// (imuSampleMs), so a stalled loop() doesn't skew them.
 // ============================================================
-bool readMPURaw(int16_t* ax, int16_t* ay, int16_t* az) {
-  if (!mpuOK) {
-    static unsigned long lastRecovery = 0;
-    if (millis() - lastRecovery > 30000) {
-      lastRecovery = millis();
-      i2cBusRecover();
-      Wire.begin(I2C_SDA, I2C_SCL);
-      Wire.setClock(100000);
-      delay(50);
-      mpu.initialize();
-      mpu.setFullScaleAccelRange(MPU6050_ACCEL_FS_4);
-      mpu.setDLPFMode(MPU6050_DLPF_BW_20);
-      delay(50);
-      if (mpu.testConnection()) {
-        mpuOK = true;
-        mpuReconnectCount++;
-        mpuConsecutiveZeros = 0;
-        Serial.printf("[TIGA] MPU recovered (#%lu)\n", mpuReconnectCount);
-      }
-    }
-    *ax = 0; *ay = 0; *az = 0;
-    return false;
-  }
-  mpu.getAcceleration(ax, ay, az);
-  if (*ax == 0 && *ay == 0 && *az == 0) {
-    if (++mpuConsecutiveZeros >= 5) {
-      mpuOK = false;
-      mpuLastFailMs = millis();
-      mpuHealthDegraded = true;
-      mpuConsecutiveZeros = 0;
-    }
-    return false;
-  }
+void mpuConfigure() {
+  mpu.initialize();
+  mpu.setFullScaleAccelRange(MPU6050_ACCEL_FS_4);
+  imuSrc.configure();          // DLPF 20Hz, 200Hz rate, accel + gyro → FIFO
+}
+
+// Bus engine init hook, at boot and after the MPU went down
+bool mpuInit() {
+  static bool booted = false;
+  mpuConfigure();
+  delay(50);
+  if (!mpu.testConnection()) return false;
   mpuConsecutiveZeros = 0;
+  imuSrc.configure();          // clears anything queued during the delay
+  fusion.reset();              // re-seeds from the next sample
+  if (booted) {
+    mpuReconnectCount++;
+    LOG(MPU_RECOVERED, mpuReconnectCount);
+  }
+  booted = true;
   return true;
 }
 
+// Bus job — drains up to IMU_MAX_PER_POLL samples
 void readMPUSensor() {
-  int16_t ax, ay, az;
-  if (!readMPURaw(&ax, &ay, &az)) return;
-
-  float g = sqrtf((float)ax*ax + (float)ay*ay + (float)az*az) / 8192.0f;
-  if (g > 6.0f) return;  // reject unphysical spike
-
-  data.accelG = g;
-  float pitch = atan2f((float)ax, sqrtf((float)ay*ay + (float)az*az))
-                * 180.0f / 3.14159f;
-  data.tiltAngle = pitch;
-
-  // Fall detection
-  if (g > FALL_G && !inFall && state != STATE_FALL_CONFIRM) {
-    inFall = true; fallTime = millis();
-  }
-  if (inFall && millis() - fallTime > 250) {
-    if (g < 0.5f) {
-      inFall = false;
-      fallConfirmStart = millis();
-      fallCountdown = 10;
-      state = STATE_FALL_CONFIRM;
-      needsFullDraw = true;
-      motorHeartbeat();  // alert user before countdown starts
-    } else {
-      inFall = false;
+  imuPipe.poll();
+}
+
+// ── Stage 1: magnitude, dead-sensor check ────────────────────
+// Integer kernel (tiga_motion.h): |a|² and |a| for the whole burst
+// first, then the checks. Float only for the display values.
+void imuMotionStage(ImuSample* s, uint8_t n) {
+  motionBatch(s, n);
+  const ImuSample* last = nullptr;
+  for (uint8_t i = 0; i < n; i++) {
+    if (s[i].g2 == 0) {        // all three axes read 0
+      s[i].valid = false;
+      if (++mpuConsecutiveZeros >= MPU_ZERO_LIMIT) {
+        i2c.markDown(I2C_DEV_MPU);   // re-initialised after a backoff
+        mpuLastFailMs = millis();
+        acq.mpuDegraded = true;
+        mpuConsecutiveZeros = 0;
+      }
+      continue;
     }
+    mpuConsecutiveZeros = 0;
+    if (s[i].g2 > SPIKE_G2) { s[i].valid = false; continue; }  // unphysical spike
+    ppgQuality.motion(s[i].g);     // arm movement for the PPG's quality score
+    last = &s[i];
   }
+  if (!last) return;
 
-  // Adaptive step detection
-  stepMagBuf[stepBufIdx] = g;
-  stepBufIdx = (stepBufIdx + 1) % STEP_BUF_SIZE;
-  float sum = 0;
-  for (int i = 0; i < STEP_BUF_SIZE; i++) sum += stepMagBuf[i];
-  stepBaseline = sum / STEP_BUF_SIZE;
-  float deviation = g - stepBaseline;
-
-  if (!stepAboveThr && deviation > 0.15f && millis() - stepDebounce > 300) {
-    stepAboveThr = true;
-    stepDebounce = millis();
-    stepCount++;
-    lastStep = millis();
-    if (stepCount > daily.peakSteps) daily.peakSteps = stepCount;
-    if (!sessionAnchored) {
-      sessionStart   = millis();
-      sessionAnchored = true;
+  // Display values only need the newest sample
+  acq.data.accelG    = (float)last->g / MOTION_LSB_PER_G;
+  acq.data.isStable  = (last->g2 < STABLE_G2);
+}
+
+// ── Stage 2: attitude ────────────────────────────────────────
+// Gyro + accel through the fixed-point filter (tiga_fusion.h);
+// leaves up and vert on every sample for the stages after it.
+void imuFusionStage(ImuSample* s, uint8_t n) {
+  fusionBatch(fusion, s, n);
+  if (!fusion.ready) return;
+  for (uint8_t i = 0; i < n; i++)
+    if (s[i].valid) altitude.accel(s[i].vert);
+  acq.data.tiltAngle  = fusion.pitchCdeg() / 100.0f;
+  acq.data.rollAngle  = fusion.rollCdeg() / 100.0f;
+  acq.data.vertAccelG = (float)fusion.vert / MOTION_LSB_PER_G;
+}
+
+// ── Stage 3: fall detection ──────────────────────────────────
+// Descent, impact, then stillness with the watch turned from
+// where it was before (tiga_fall.h), ~3 s after the impact, posts
+// EV_FALL; core 1 starts the countdown unless one is already
+// running. Needs the fusion stage's up and vert on each sample.
+void imuFallStage(ImuSample* s, uint8_t n) {
+  if (!fusion.ready) return;
+  for (uint8_t i = 0; i < n; i++) {
+    if (!s[i].valid || !fallDetector.push(s[i])) continue;
+    acqEvent(EV_FALL, fallDetector.last.dropCm, fallDetector.last.peakMg / 1000.0f);
+  }
+}
+
+// ── Stage 4: adaptive step detection ─────────────────────────
+// Baseline is a 1s running mean, kept as an integer running sum
+// so each sample costs O(1) and nothing drifts.
+void imuStepStage(ImuSample* s, uint8_t n) {
+  for (uint8_t i = 0; i < n; i++) {
+    if (!s[i].valid) continue;
+    int32_t  g = s[i].g;
+    uint32_t t = imuSampleMs(s[i].idx);
+
+    stepMagSum += g - stepMagBuf[stepBufIdx];
+    stepMagBuf[stepBufIdx] = (uint16_t)g;
+    stepBufIdx = (stepBufIdx + 1) % STEP_BUF_SIZE;
+    int32_t deviation = g - stepMagSum / STEP_BUF_SIZE;
+
+    if (!stepAboveThr && deviation > STEP_RISE && t - stepDebounce > 300) {
+      stepAboveThr = true;
+      stepDebounce = t;
+      stepCount++;
+      lastStep = millis();
+      altitude.step(lastStep);
+      if (stepCount > acq.daily.peakSteps) acq.daily.peakSteps = stepCount;
+      if (!acq.firstStepMs) acq.firstStepMs = millis();   // anchors the session
+    } else if (stepAboveThr && deviation < STEP_FALL) {
+      stepAboveThr = false;
     }
-  } else if (stepAboveThr && deviation < 0.08f) {
-    stepAboveThr = false;
   }
+  acq.data.steps = stepCount;
+}
 
-  data.steps    = stepCount;
-  data.isStable = (g < STABLE_G);
+// ── Stage 5: balance score (5s of wobble) ────────────────────
+// score = 100 - 200 × mean |vertical accel|, in counts. Along
+// gravity rather than |a| - 1g, so turning the wrist isn't wobble.
+void imuBalanceStage(ImuSample* s, uint8_t n) {
+  static int32_t wobbleAccum   = 0;
+  static int32_t wobbleSamples = 0;
+  for (uint8_t i = 0; i < n; i++) {
+    if (!s[i].valid) continue;
+    int32_t d = s[i].vert;
+    wobbleAccum += d < 0 ? -d : d;
+    if (++wobbleSamples >= BALANCE_WINDOW) {
+      int64_t full = (int64_t)wobbleSamples * MOTION_LSB_PER_G;
+      int32_t score = (int32_t)((100 * full - 200 * (int64_t)wobbleAccum) / full);
+      acq.data.balanceScore = constrain(score, 0, 100);
+      wobbleAccum = 0; wobbleSamples = 0;
+    }
+  }
+}
 
-  // Balance score
-  static float wobbleAccum   = 0;
-  static int   wobbleSamples = 0;
-  wobbleAccum += fabsf(g - 1.0f);
-  if (++wobbleSamples >= 50) {
-    data.balanceScore = (int)constrain(100 - (wobbleAccum/wobbleSamples)*200, 0, 100);
-    wobbleAccum = 0; wobbleSamples = 0;
+// ── Stage 6: activity timing ─────────────────────────────────
+void imuActivityStage(ImuSample* s, uint8_t n) {
+  for (uint8_t i = 0; i < n; i++) {
+    if (!s[i].valid) continue;
+    uint32_t g2 = s[i].g2;
+    uint32_t t  = imuSampleMs(s[i].idx);
+    if (g2 > ACTIVE_ON_G2 && !inActivity) { inActivity = true; activityStart = t; }
+    else if (g2 < ACTIVE_OFF_G2 && inActivity) {
+      inActivity = false;
+      acq.daily.activityMins += (t - activityStart) / 60000;
+      acq.data.activityMins = acq.daily.activityMins;
+    }
   }
+}
 
-  // Activity timing
-  if (g > 1.15f && !inActivity) { inActivity = true; activityStart = millis(); }
-  else if (g < 1.05f && inActivity) {
-    inActivity = false;
-    daily.activityMins += (millis() - activityStart) / 60000;
-    data.activityMins = daily.activityMins;
+// ── Stage 7: tremor window ───────────────────────────────────
+// Gyro into the spectrum ring (tiga_tremor.h); taskTremor does
+// the analysis. A window with a step in it is skipped: walking
+// puts its cadence right across the tremor band.
+void imuTremorStage(ImuSample* s, uint8_t n) {
+  for (uint8_t i = 0; i < n; i++) {
+    if (!s[i].valid) continue;
+    uint32_t t = imuSampleMs(s[i].idx);
+    tremor.push(s[i].gx, s[i].gy, s[i].gz, t - stepDebounce > TREMOR_STILL_MS);
   }
+}
 
-  // MPU die temperature
-  data.tempC = (mpu.getTemperature() / 340.0f) + 36.53f;
+// ── Stage 8: raw capture (no-op unless recording) ────────────
+void imuCaptureStage(ImuSample* s, uint8_t n) {
+  capture.imu(s, n);
+}
 
-  data.healthScore = calcScore();
+void imuStreamStage(ImuSample* s, uint8_t n) {
+  stream.acc(s, n);
+}
 
-  // HR emergency — 3 consecutive bad readings
-  static int consecutiveBadHR = 0;
-  if (data.heartRate > 0 && (state == STATE_CLOCK || state == STATE_HEALTH)) {
-    if (data.heartRate > HR_WARN_HIGH || data.heartRate < HR_WARN_LOW) {
-      if (++consecutiveBadHR >= 3) {
-        alertHigh();
-        state = STATE_EMERGENCY;
-        needsFullDraw = true;
-        consecutiveBadHR = 0;
-      }
-    } else {
-      consecutiveBadHR = 0;
-    }
-  }
+// ── Slow MPU housekeeping — every 100ms ──────────────────────
+void readMPUTemp() {
+  acq.data.tempC = (mpu.getTemperature() / 340.0f) + 36.53f;
+}
+
+void readMPUSlow() {
+  if (!acq.mpuOK) return;
+
+  // MPU die temperature, on the bus task
+  i2c.post(I2C_DEV_MPU, readMPUTemp);
+
+  acq.data.healthScore = calcScore(acq.data);
 }
 
 // ============================================================
 // MAX30102
-// Strategy: fill 100-sample buffer, then run SpO2 algorithm.
-// Between algorithm runs, use beat detection for live BPM.
+// Strategy: drain the sensor FIFO into 25-sample blocks, then run
+// beat detection and the SpO2 window over every sample in order.
 // Wearing detection: IR value < IR_FINGER_THRESHOLD = no finger.
 // ============================================================
+// Bus engine init hook
+bool maxInit() {
+  if (!max30102.begin(Wire, I2C_SPEED_FAST)) return false;
+  // ADC 400Hz averaged x4 = 100Hz into the FIFO, 18 bit, 411µs, range 16384
+  max30102.setup(60,           // LED brightness 0-255 (60 = moderate)
+                 MAX_SAMPLE_AVG, // sampleAverage: average 4 samples
+                 2,            // ledMode: 2 = red + IR
+                 MAX_ADC_RATE, // sampleRate: 400 Hz ADC
+                 411,          // pulseWidth: 411µs (best resolution)
+                 16384);       // adcRange: 16384
+  max30102.setPulseAmplitudeRed(60);
+  max30102.setPulseAmplitudeIR(60);
+  return true;
+}
+
+// Bus job — blocks are processed by taskPpg()
 void readMAX30102() {
-  if (!maxOK) return;
+  ppgAcq.poll();
+}
 
-  long irValue  = max30102.getIR();
-  long redValue = max30102.getRed();
+void processPpgBlock(const PpgBlock& blk) {
+  capture.ppg(blk);
+  stream.ppg(blk);
+  if (blk.lost > 0) {
+    LOG(PPG_OVERFLOW, blk.lost, blk.seq);
+    spo2Est.reset();           // a gap would splice two pulses into one window
+    ppgQuality.reset();
+  }
 
+  // Quality first, so a block that can't hold a pulse skips the
+  // stages after it (tiga_ppg_sqi.h)
+  for (uint16_t i = 0; i < blk.count; i++) ppgQuality.push((int32_t)blk.s[i].ir);
+  uint8_t sqi = ppgQuality.judge();
+  acq.data.ppgQuality = sqi;
+  if (sqi < PPG_SQI_USABLE) {
+    ppgUsableRun = 0;
+    if (++ppgSkipRun == 1) spo2Est.reset();
+    if (ppgSkipRun == PPG_SQI_HOLD_BLOCKS) clearPpgReadings();
+  } else {
+    ppgSkipRun = 0;
+    if (ppgUsableRun < PPG_SQI_SETTLE) ppgUsableRun++;
+  }
+
+  for (uint16_t i = 0; i < blk.count; i++) {
+    processPpgSample((long)blk.s[i].ir, (long)blk.s[i].red,
+                     blk.firstSample + i, sqi);
+  }
+  acq.data.hrQuality = acq.data.heartRate > 0 ? min(rateQuality, sqi) : 0;
+
+  if (sqi >= PPG_SQI_USABLE) {
+    if (acq.data.wearing) updateSpO2(sqi);   // traced from core 1, see traceSensors()
+    updateHrv(blk.firstSample + blk.count - 1);
+  } else if ((ppgSkipRun & 3) == 1) {
+    updateHrv(blk.firstSample + blk.count - 1);   // once a second, so the windows age
+  }
+
+  // HR zone update
+  float hr = acq.data.heartRate;
+  if      (hr == 0)             acq.data.hrZone = 0;
+  else if (hr < 60)             acq.data.hrZone = 0;
+  else if (hr < 75)             acq.data.hrZone = 1;
+  else if (hr <= HR_SAFE_MAX)   acq.data.hrZone = 2;
+  else                          acq.data.hrZone = 3;
+}
+
+// HR and SpO2 to "no reading": finger off, or moving too long
+void clearPpgReadings() {
+  acq.data.heartRate = 0;
+  acq.data.hrQuality = 0;
+  beatsPerMinute = 0;
+  beatAvg        = 0;
+  rateCount      = 0;
+  acq.data.spO2      = 0;
+  acq.data.spO2Valid = false;
+  spo2Est.reset();
+}
+
+void processPpgSample(long irValue, long redValue, uint32_t sampleIdx, uint8_t sqi) {
   // Wearing detection — IR signal validity
-  data.wearing = (irValue >= (long)IR_FINGER_THRESHOLD);
+  bool wasWearing = acq.data.wearing;
+  acq.data.wearing = (irValue >= (long)IR_FINGER_THRESHOLD);
 
-  if (!data.wearing) {
-    data.heartRate = 0;
-    beatsPerMinute = 0;
-    beatAvg        = 0;
-    data.spO2      = 0;
-    data.spO2Valid = false;
+  if (!acq.data.wearing) {
+    clearPpgReadings();
     return;
   }
+  if (!wasWearing) ppgQuality.reset();   // judge the new contact on its own
+  if (sqi < PPG_SQI_USABLE) return;      // readings held; see processPpgBlock()
 
   // ── Beat detection for live BPM ────────────────────────────
+  // The average is shown once it holds MAX_RATE_SIZE beats, and
+  // only from PPG_SQI_SETTLE blocks after a skip, when
+  // checkForBeat()'s filters have caught up. In a doubtful block
+  // a beat far off the average is dropped.
   if (checkForBeat(irValue)) {
-    long delta = millis() - lastBeatMax;
-    lastBeatMax = millis();
-    beatsPerMinute = 60.0f / (delta / 1000.0f);
-
-    if (beatsPerMinute >= 40 && beatsPerMinute <= 180) {
-      rates[rateSpot++] = (byte)beatsPerMinute;
-      rateSpot %= MAX_RATE_SIZE;
-      beatAvg = 0;
-      for (byte x = 0; x < MAX_RATE_SIZE; x++) beatAvg += rates[x];
+    // Beat spacing in samples — exact to 10ms, immune to loop stalls
+    uint32_t delta = sampleIdx - lastBeatSample;
+    lastBeatSample = sampleIdx;
+    beatsPerMinute = 60.0f * SPO2_SAMPLE_RATE / (float)delta;
+
+    if (beatsPerMinute >= 40 && beatsPerMinute <= 180 && ppgUsableRun >= PPG_SQI_SETTLE &&
+        (sqi >= PPG_SQI_GOOD || rateCount < MAX_RATE_SIZE ||
+         fabsf(beatsPerMinute - beatAvg) <= beatAvg * PPG_SQI_FAIR_JUMP)) {
+      rates[rateSpot]   = (byte)beatsPerMinute;
+      rateSqi[rateSpot] = sqi;
+      rateSpot = (rateSpot + 1) % MAX_RATE_SIZE;
+      if (rateCount < MAX_RATE_SIZE) rateCount++;
+    }
+    if (rateCount == MAX_RATE_SIZE) {
+      beatAvg     = 0;
+      rateQuality = 100;
+      for (byte x = 0; x < MAX_RATE_SIZE; x++) {
+        beatAvg += rates[x];
+        if (rateSqi[x] < rateQuality) rateQuality = rateSqi[x];
+      }
       beatAvg /= MAX_RATE_SIZE;
-      data.heartRate = beatAvg;
-
-      // Daily HR tracking
-      daily.avgHR = (daily.avgHR * daily.hrSamples + data.heartRate)
-                    / (daily.hrSamples + 1);
-      daily.hrSamples++;
-      if (data.heartRate > sessionPeakHR) sessionPeakHR = data.heartRate;
-      if (data.heartRate < sessionLowHR)  sessionLowHR  = data.heartRate;
+      acq.data.heartRate = beatAvg;
+
+      // Daily HR tracking — the average is taskStats()'s, per second
+      if (acq.data.heartRate > acq.peakHR) acq.peakHR = acq.data.heartRate;
+      if (acq.data.heartRate < acq.lowHR)  acq.lowHR  = acq.data.heartRate;
     }
   }
 
-  // ── SpO2 from red/IR ratio ──────────────────────────────────
-  // We maintain a rolling window of 25 samples (~1s at ~25 reads/loop).
-  // AC component = peak - valley over the window.
-  // DC component = mean over the window.
-  // R = (redAC / redDC) / (irAC / irDC)
-  // SpO2 ≈ 110 - 25 * R  (Maxim application note approximation)
-
-  #define SPO2_WIN 25
-  static long irWin[SPO2_WIN];
-  static long redWin[SPO2_WIN];
-  static uint8_t winIdx = 0;
-  static bool winFull   = false;
-
-  irWin[winIdx]  = irValue;
-  redWin[winIdx] = redValue;
-  winIdx++;
-  if (winIdx >= SPO2_WIN) { winIdx = 0; winFull = true; }
-
-  if (winFull) {
-    long irMin = irWin[0],  irMax = irWin[0],  irSum = 0;
-    long redMin = redWin[0], redMax = redWin[0], redSum = 0;
-
-    for (int i = 0; i < SPO2_WIN; i++) {
-      if (irWin[i]  < irMin)  irMin  = irWin[i];
-      if (irWin[i]  > irMax)  irMax  = irWin[i];
-      if (redWin[i] < redMin) redMin = redWin[i];
-      if (redWin[i] > redMax) redMax = redWin[i];
-      irSum  += irWin[i];
-      redSum += redWin[i];
-    }
+  // ── Beat-to-beat timing for HRV ────────────────────────────
+  // Samples skipped while not worn or in a skipped block show up
+  // as a gap in sampleIdx
+  hrv.push((int32_t)irValue, sampleIdx);
 
-    float irAC  = (float)(irMax  - irMin);
-    float redAC = (float)(redMax - redMin);
-    float irDC  = (float)(irSum  / SPO2_WIN);
-    float redDC = (float)(redSum / SPO2_WIN);
-
-    // Guard: avoid divide-by-zero and reject tiny signals
-    if (irDC > 1000 && redDC > 1000 && irAC > 50 && redAC > 50) {
-      float R = (redAC / redDC) / (irAC / irDC);
-      float spo2 = 110.0f - 25.0f * R;
-
-      // Plausibility gate — physiologically valid range only
-      if (spo2 >= 80.0f && spo2 <= 100.0f) {
-        // Smooth with previous reading
-        if (data.spO2Valid) {
-          data.spO2 = (uint8_t)(0.7f * data.spO2 + 0.3f * spo2);
-        } else {
-          data.spO2 = (uint8_t)spo2;
-        }
-        data.spO2Valid = true;
-      }
-      // If out of range, keep last valid reading rather than flashing 0
-    }
+  // ── SpO2 window — O(1) per sample, read once per block ─────
+  spo2Est.push((int32_t)redValue, (int32_t)irValue);
+}
 
-    Serial.printf("[MAX] HR=%.0f bpm  SpO2=%d%%  valid=%d  R=%.3f\n",
-                  data.heartRate, data.spO2, data.spO2Valid ? 1 : 0,
-                  (irDC > 0 && redDC > 0)
-                    ? (redAC / redDC) / (irAC / irDC) : 0.0f);
-  }
+// HRV windows as of the block's last sample. The 1-minute one is
+// what the screen and BLE show, and only once it's valid.
+void updateHrv(uint32_t lastIdx) {
+  acq.hrv1        = hrv.stats(lastIdx, HRV_SHORT_BUCKETS);
+  acq.hrv5        = hrv.stats(lastIdx, HRV_BUCKETS);
+  acq.hrvAccepted = hrv.accepted;
+  acq.hrvRejected = hrv.rejected;
+  acq.data.rmssdMs = acq.hrv1.valid ? acq.hrv1.rmssdMs : 0;
+  acq.data.sdnnMs  = acq.hrv1.valid ? acq.hrv1.sdnnMs : 0;
+  acq.data.pnn50   = acq.hrv1.valid ? acq.hrv1.pnn50 : 0;
+}
 
-  // HR zone update
-  if      (data.heartRate == 0)             data.hrZone = 0;
-  else if (data.heartRate < 60)             data.hrZone = 0;
-  else if (data.heartRate < 75)             data.hrZone = 1;
-  else if (data.heartRate <= HR_SAFE_MAX)   data.hrZone = 2;
-  else                                      data.hrZone = 3;
+// SpO2 from the red/IR ratio over the last SPO2_WINDOW samples.
+// Out-of-range readings keep the last valid value rather than
+// flashing 0. A doubtful block (sqi under PPG_SQI_GOOD) moves it
+// a third as far.
+void updateSpO2(uint8_t sqi) {
+  float spo2;
+  bool ok = spo2Est.estimate(&spo2, &acq.spo2R);
+  if (!ok) return;
+  if (acq.data.spO2Valid) {
+    float w = sqi >= PPG_SQI_GOOD ? 0.3f : 0.1f;
+    acq.data.spO2 = (uint8_t)((1 - w) * acq.data.spO2 + w * spo2);   // smooth
+  } else {
+    acq.data.spO2 = (uint8_t)spo2;
+  }
+  acq.data.spO2Valid = true;
 }
 
 
 // ============================================================
 // BMP280
-// Reads pressure, computes altitude, tracks floors climbed.
+// Reads pressure; tiga_altitude.h turns it into altitude and
+// floors.
 // ============================================================
-void readBMP280() {
-  if (!bmpOK) return;
-
-  data.pressureHPa = bmp280.readPressure() / 100.0f; // Pa → hPa
-
-  // Altitude from sea-level pressure formula
-  // Using standard sea level pressure 1013.25 hPa
-  float alt = bmp280.readAltitude(1013.25f);
-
-  // Set baseline on first valid read
-  if (!altBaselineSet && alt > -500 && alt < 9000) {
-    altitudeBaseline = alt;
-    lastFloorAlt     = alt;
-    altBaselineSet   = true;
-    Serial.printf("[BMP] Altitude baseline set: %.1f m\n", alt);
-  }
-
-  if (altBaselineSet) {
-    data.altitudeM = alt - altitudeBaseline; // relative to start
+// Bus engine init hook
+// Default I2C address for Adafruit BMP280 breakout is 0x76
+bool bmpInit() {
+  if (!bmp280.begin(BMP280_ADDR)) return false;
+  // A fresh reading for every 100 ms job. The IIR filter is off:
+  // at x16 it lagged a stair climb by seconds, and the altitude
+  // filter does the smoothing with the accelerometer's help.
+  bmp280.setSampling(
+    Adafruit_BMP280::MODE_NORMAL,
+    Adafruit_BMP280::SAMPLING_X2,   // temperature oversampling
+    Adafruit_BMP280::SAMPLING_X16,  // pressure oversampling (high res)
+    Adafruit_BMP280::FILTER_OFF,
+    Adafruit_BMP280::STANDBY_MS_63  // ~45 ms measuring + 63 ms standby
+  );
+  return true;
+}
 
-    // Floor counting — count up only (don't count descents)
-    if ((alt - lastFloorAlt) >= FLOOR_HEIGHT_M) {
-      data.floorsUp++;
-      lastFloorAlt = alt;
-      Serial.printf("[BMP] Floor climbed! Total: %d  Alt: %.1f m\n",
-                    data.floorsUp, alt);
-      alertLow();  // gentle motor pulse on floor climbed
-    }
+// Bus job
+void readBMP280() {
+  float pressurePa = bmp280.readPressure();
+  // The library can't report a failed read; out of range is one
+  if (!(pressurePa > 30000 && pressurePa < 110000)) {
+    i2c.fail(I2C_DEV_BMP);
+    return;
   }
-
-  Serial.printf("[BMP] Pressure: %.1f hPa  Altitude: %.1f m  Floors: %d\n",
-                data.pressureHPa, data.altitudeM, data.floorsUp);
+  acq.data.pressureHPa = pressurePa / 100.0f; // Pa → hPa
+  if (capture.active()) capture.baro(pressurePa, bmp280.readTemperature());
+
+  bool seeded = altitude.seeded;
+  int8_t floors = altitude.pressure(pressurePa, millis());
+  if (!seeded) LOG(BARO_BASELINE, altitude.baseM());
+
+  acq.data.altitudeM  = altitude.altitudeM();     // climbed since the session began
+  acq.data.floorsUp   = altitude.floorsUp;
+  acq.data.floorsDown = altitude.floorsDown;
+  if (floors > 0) acqEvent(EV_FLOOR, altitude.floorsUp, acq.data.altitudeM);   // core 1 logs it and pulses
+  if (floors < 0) acqEvent(EV_FLOOR_DOWN, altitude.floorsDown, acq.data.altitudeM);
 }
 
 // ============================================================
 // HEALTH SCORE
 // ============================================================
-int calcScore() {
+// On core 0, from acq.data
+int calcScore(const HealthData& d) {
   int hr=50, act=50, stab=50;
-  if (data.heartRate > 0) {
-    if      (data.heartRate >= HR_SAFE_MIN && data.heartRate <= HR_SAFE_MAX) hr = 100;
-    else if (data.heartRate >= HR_WARN_LOW  && data.heartRate <= HR_WARN_HIGH) hr = 65;
+  if (d.heartRate > 0) {
+    if      (d.heartRate >= HR_SAFE_MIN && d.heartRate <= HR_SAFE_MAX) hr = 100;
+    else if (d.heartRate >= HR_WARN_LOW  && d.heartRate <= HR_WARN_HIGH) hr = 65;
     else hr = 20;
   }
-  act  = (int)(min((float)data.steps / STEPS_GOAL, 1.0f) * 100);
-  stab = data.isStable ? 100 : 40;
+  act  = (int)(min((float)d.steps / STEPS_GOAL, 1.0f) * 100);
+  stab = d.isStable ? 100 : 40;
   return (int)(hr*0.35f + act*0.25f + stab*0.40f);
 }
 
+// Once a second from core 1: what the sensor core last published
+void traceSensors() {
+  if (data.wearing)
+    LOG(PPG_TRACE, data.heartRate, data.spO2, data.spO2Valid ? 1 : 0, spo2LastR);
+  if (bmpOK)
+    LOG(BARO_TRACE, data.pressureHPa, data.altitudeM, data.floorsUp);
+}
+
 // ── Label helpers ────────────────────────────────────────────
 const char* hrZoneLabel() {
   switch(data.hrZone) {
@@ -1082,209 +1920,396 @@ uint16_t healthDot() {
 }
 
 // ============================================================
-// BUTTONS (unchanged from v5.2)
+// BUTTONS
+// Reset, export and sleep start here and go on from taskUI() a
+// step at a time, so presses and the other tasks keep going.
 // ============================================================
+// Button 2 held on the clock or health screen: everything is
+// cleared now, the screen then says so for RESET_SHOW_MS
 void resetSession() {
-  tft.fillScreen(C_BG);
-  tft.setTextDatum(MC_DATUM);
-  tft.setTextColor(C_GREEN);
-  tft.setTextSize(3);
-  tft.drawString("SESSION", W/2, 45);
-  tft.drawString("RESET", W/2, 78);
-  tft.setTextSize(1);
-  tft.setTextColor(C_TEXT);
-  tft.drawString("Timer and counters cleared", W/2, 110);
-  tft.setTextColor(C_MUTED);
-  tft.drawString("Tracking starts from now", W/2, 126);
-  int barY = H-22, barW = 200, barX = (W-barW)/2;
-  tft.drawRect(barX, barY, barW, 6, C_MUTED);
-  for (int i = 0; i <= barW; i += 4) {
-    tft.fillRect(barX, barY, i, 6, C_GREEN);
-    delay(40);
-  }
-
   sessionStart       = millis();
   sessionAnchored    = true;
-  stepCount          = 0;
+  stats.reset();
+  statsStartMs       = sessionStart;
+  statsLastSteps     = 0;
   sessionSteps       = 0;
-  sessionPeakHR      = 0;
-  sessionLowHR       = 999;
-  daily.activityMins = 0;
-  daily.fallCount    = 0;
-  daily.hrSamples    = 0;
-  daily.avgHR        = 0;
   gpsData.distanceM  = 0;
   gpsData.lastValid  = false;
-  mpuReconnectCount  = 0;
-  mpuLastFailMs      = 0;
-  mpuHealthDegraded  = false;
   goalAlertFired     = false;
   lowBatAlertFired   = false;
-  // Reset altitude baseline for new session
-  altBaselineSet     = false;
-  data.floorsUp      = 0;
-  lastFloorAlt       = 0;
+  sched.resetStats();
+  acqCommand({ CMD_SESSION_RESET });   // counters, baseline: acqResetSession()
+  historyCheckpoint();
 
-  Serial.println("[TIGA] Session reset by user");
-  delay(600);
-  state = STATE_CLOCK;
+  LOG(SESSION_RESET);
+  actionMs = millis();
+  state = STATE_RESET;
   needsFullDraw = true;
 }
 
-void exportSession() {
-  unsigned long dur = (millis() - sessionStart) / 1000;
-  int durMin = dur / 60, durSec = dur % 60;
-
-  tft.fillScreen(C_BG);
-  tft.setTextDatum(MC_DATUM);
-  tft.setTextColor(C_ACCENT);
-  tft.setTextSize(1);
-  tft.drawString("Exporting to Serial Monitor...", W/2, H/2 - 10);
-  tft.setTextColor(C_MUTED);
-  tft.drawString("Open Serial Monitor at 115200", W/2, H/2 + 8);
-
-  Serial.println();
-  Serial.println("=================================================");
-  Serial.println("  TIGA WALK TEST REPORT — v6a");
-  Serial.println("=================================================");
-  Serial.printf ("  Date:      %02d/%02d/%04d  %02d:%02d\n",
-                  displayDay, displayMonth, displayYear,
-                  displayHour, displayMin);
-  Serial.printf ("  Duration:  %d min %d sec\n", durMin, durSec);
-  Serial.println("-------------------------------------------------");
-
-  Serial.println("  [1] HEART RATE (MAX30102)");
-  if (daily.hrSamples > 0) {
-    Serial.printf ("  Average:   %.0f bpm\n", daily.avgHR);
-    Serial.printf ("  Peak:      %.0f bpm\n", sessionPeakHR);
-    Serial.printf ("  Low:       %.0f bpm\n", sessionLowHR > 900 ? 0 : sessionLowHR);
-    Serial.printf ("  Samples:   %d readings\n", daily.hrSamples);
-  } else {
-    Serial.println("  No HR readings — finger not on sensor.");
-  }
+void drawResetScreen() {
+  canvas.setTextDatum(MC_DATUM);
+  canvas.setTextColor(C_GREEN);
+  canvas.setTextSize(3);
+  canvas.drawString("SESSION", W/2, 45);
+  canvas.drawString("RESET", W/2, 78);
+  canvas.setTextSize(1);
+  canvas.setTextColor(C_TEXT);
+  canvas.drawString("Timer and counters cleared", W/2, 110);
+  canvas.setTextColor(C_MUTED);
+  canvas.drawString("Tracking starts from now", W/2, 126);
+  canvas.drawRect((W-200)/2, H-22, 200, 6, C_MUTED);
+  drawResetBar(true);
+}
 
-  Serial.println();
-  Serial.println("  [2] OXYGEN SATURATION (MAX30102 SpO2)");
-  if (data.spO2Valid) {
-    Serial.printf ("  SpO2:      %d%%\n", data.spO2);
-    if (data.spO2 < 95)
-      Serial.println("  >> FLAG: SpO2 below 95% — check reading or seek advice.");
-    else
-      Serial.println("  >> Normal range (95-100%).");
-  } else {
-    Serial.println("  No valid SpO2 reading — hold finger still for ~4s.");
-  }
-
-  Serial.println();
-  Serial.println("  [3] ACTIVITY");
-  Serial.printf ("  Steps:     %d of %d goal (%d%%)\n",
-                  data.steps, STEPS_GOAL,
-                  (int)min((float)data.steps/STEPS_GOAL*100, 100.0f));
-  Serial.printf ("  Active:    %d minutes\n", daily.activityMins);
-  if (gpsData.distanceM > 0) {
-    Serial.printf ("  Distance:  %.0f m (%.2f km)\n",
-                    gpsData.distanceM, gpsData.distanceM/1000.0f);
-    if (data.steps > 0)
-      Serial.printf ("  Stride:    ~%.2f m per step\n",
-                      gpsData.distanceM / data.steps);
-  } else {
-    Serial.println("  Distance:  No GPS fix");
+// Fills in 4 px steps over RESET_BAR_MS; true if it moved
+bool drawResetBar(bool full) {
+  static int drawn = -1;
+  int barW = 200;
+  int w = min((int)((millis() - actionMs) * barW / RESET_BAR_MS), barW) / 4 * 4;
+  if (!full && w == drawn) return false;
+  canvas.fillRect((W-barW)/2, H-22, w, 6, C_GREEN);
+  drawn = w;
+  return true;
+}
+
+// Core 0's half of a session reset
+void acqResetSession() {
+  stepCount              = 0;
+  acq.peakHR             = 0;
+  acq.lowHR              = 999;
+  acq.firstStepMs        = 0;
+  acq.daily.activityMins = 0;
+  acq.daily.fallCount    = 0;
+  mpuReconnectCount      = 0;
+  mpuLastFailMs          = 0;
+  acq.mpuDegraded        = false;
+  acqSched.resetStats();
+  i2c.resetStats();
+  // Reset altitude baseline for new session
+  altitude.reset();
+  acq.data.altitudeM     = 0;
+  acq.data.floorsUp      = 0;
+  acq.data.floorsDown    = 0;
+  hrv.reset();
+  tremorCloseSession();
+}
+
+// Core 0: the session's tremor into the trend, before a reset or
+// deep sleep
+void tremorCloseSession() {
+  tremorTrend.add(tremor.session());
+  tremor.resetSession();
+  acq.tremor             = tremor.session();
+  acq.tremorTrend        = tremorTrend;
+  acq.data.tremorHz      = 0;
+  acq.data.tremorDps     = 0;
+  acq.data.tremorAmpDeg  = 0;
+}
+
+// Session in rows from the statistics store: 10-minute rows for
+// the first two hours, hourly after that, the last 24 h at most
+void exportTrends() {
+  uint32_t now = stats.seconds();
+  uint32_t step = now > 2 * 3600 ? 3600 : 600;
+  uint32_t from = now > 24 * 3600 ? now - 24 * 3600 : 0;
+  from = from / step * step;
+  if (now < 60) { Serial.println("  Under a minute recorded."); return; }
+  Serial.printf ("  %-7s%6s %4s  %-9s %8s  %-5s %6s  %s\n",
+                 "From", "HR", "SD", "low-high", "SpO2", "low", "Steps", "Alt");
+  for (uint32_t t = from; t < now; t += step) {
+    StatAgg hr = stats.range(STAT_HR, t, t + step);
+    StatAgg ox = stats.range(STAT_SPO2, t, t + step);
+    StatAgg st = stats.range(STAT_STEPS, t, t + step);
+    StatAgg al = stats.range(STAT_ALT, t, t + step);
+    char hrS[32] = "    --", oxS[24] = "      --", alS[12] = "--";
+    if (hr.n) snprintf(hrS, sizeof(hrS), "%6.0f %4.0f  %3d-%-3d", hr.mean(), sqrtf(hr.var()), hr.lo, hr.hi);
+    if (ox.n) snprintf(oxS, sizeof(oxS), "%8.1f  %3d", ox.mean(), ox.lo);
+    if (al.n) snprintf(alS, sizeof(alS), "%.0f m", al.mean() / 10);
+    char at[12];
+    snprintf(at, sizeof(at), "+%lu:%02lu", (unsigned long)(t / 3600), (unsigned long)(t / 60 % 60));
+    Serial.printf ("  %-7s%-22s %-15s %6ld  %s\n", at, hrS, oxS, (long)st.sum, alS);
   }
+}
 
-  Serial.println();
-  Serial.println("  [4] ALTITUDE & FLOORS (BMP280)");
-  if (bmpOK) {
-    Serial.printf ("  Altitude:  %.1f m (relative to session start)\n", data.altitudeM);
-    Serial.printf ("  Floors up: %d\n", data.floorsUp);
-    Serial.printf ("  Pressure:  %.1f hPa\n", data.pressureHPa);
-  } else {
-    Serial.println("  BMP280 not available.");
-  }
-
-  Serial.println();
-  Serial.println("  [5] STABILITY & FALL RISK");
-  Serial.printf ("  Falls detected:  %d\n", daily.fallCount);
-  Serial.printf ("  Balance score:   %d / 100\n", data.balanceScore);
-  Serial.printf ("  Tilt angle:      %.1f degrees\n", data.tiltAngle);
-  Serial.printf ("  MPU health:      %s\n",
-                 mpuHealthDegraded ? "DEGRADED" : "OK");
-
-  Serial.println();
-  Serial.println("  [6] DEVICE");
-  Serial.printf ("  Battery:   %.0f%%\n", data.battery);
-  Serial.printf ("  Worn:      %s (MAX30102 IR)\n",
-                 data.wearing ? "Yes" : "No");
-  Serial.printf ("  Sensors:   MPU=%s  MAX=%s  BMP=%s\n",
-                 mpuOK?"OK":"FAIL", maxOK?"OK":"FAIL", bmpOK?"OK":"FAIL");
-
-  Serial.println();
-  Serial.println("=================================================");
-  Serial.println("  END OF REPORT");
-  Serial.println("=================================================");
-  Serial.println();
-
-  delay(3000);
-  state = STATE_CLOCK;
+// Buttons 1 + 2 together: the report goes to Serial a section
+// per taskUI() pass (exportSection()) while the screen says so
+void exportSession() {
+  exportPart = 0;
+  state = STATE_EXPORT;
   needsFullDraw = true;
 }
 
+void drawExportScreen() {
+  canvas.setTextDatum(MC_DATUM);
+  canvas.setTextColor(C_ACCENT);
+  canvas.setTextSize(1);
+  canvas.drawString(exportPart < EXPORT_PARTS ? "Exporting to Serial Monitor..."
+                                              : "Exported to Serial Monitor", W/2, H/2 - 10);
+  canvas.setTextColor(C_MUTED);
+  canvas.drawString("Open Serial Monitor at 115200", W/2, H/2 + 8);
+}
+
+// Section `part` of the report: 0 the header, 1-9 as numbered,
+// 10 the footer
+void exportSection(uint8_t part) {
+  switch (part) {
+    case 0: {
+      unsigned long dur = (millis() - sessionStart) / 1000;
+      int durMin = dur / 60, durSec = dur % 60;
+      Serial.println();
+      Serial.println("=================================================");
+      Serial.println("  TIGA WALK TEST REPORT — v6a");
+      Serial.println("=================================================");
+      Serial.printf ("  Date:      %02d/%02d/%04d  %02d:%02d\n",
+                      displayDay, displayMonth, displayYear,
+                      displayHour, displayMin);
+      Serial.printf ("  Duration:  %d min %d sec\n", durMin, durSec);
+      Serial.println("-------------------------------------------------");
+      break;
+    }
+    case 1: {
+      Serial.println("  [1] HEART RATE (MAX30102)");
+      const StatAgg& hr = stats.session(STAT_HR);
+      if (hr.n > 0) {
+        Serial.printf ("  Average:   %.0f bpm (SD %.1f)\n", hr.mean(), sqrtf(hr.var()));
+        Serial.printf ("  Peak:      %.0f bpm\n", sessionPeakHR);
+        Serial.printf ("  Low:       %.0f bpm\n", sessionLowHR > 900 ? 0 : sessionLowHR);
+        Serial.printf ("  Samples:   %lu s with a reading\n", (unsigned long)hr.n);
+      } else {
+        Serial.println("  No HR readings — finger not on sensor.");
+      }
+      if (hrvShort.valid || hrvLong.valid) {
+        const HrvStats* w[] = { &hrvShort, &hrvLong };
+        const char* name[]  = { "1 min", "5 min" };
+        for (int i = 0; i < 2; i++) {
+          if (!w[i]->valid) continue;
+          Serial.printf ("  HRV %s: RMSSD %.0f ms, SDNN %.0f ms, pNN50 %.0f%% (%u beats)\n",
+                         name[i], w[i]->rmssdMs, w[i]->sdnnMs, w[i]->pnn50, w[i]->nn);
+        }
+      } else {
+        Serial.println("  HRV:       no reading — needs a minute of steady pulse.");
+      }
+      Serial.printf ("  Intervals: %lu kept, %lu thrown out (ectopic / movement)\n",
+                     (unsigned long)hrvAccepted, (unsigned long)hrvRejected);
+      break;
+    }
+    case 2: {
+      Serial.println();
+      Serial.println("  [2] OXYGEN SATURATION (MAX30102 SpO2)");
+      if (data.spO2Valid) {
+        Serial.printf ("  SpO2:      %d%%\n", data.spO2);
+        if (data.spO2 < 95)
+          Serial.println("  >> FLAG: SpO2 below 95% — check reading or seek advice.");
+        else
+          Serial.println("  >> Normal range (95-100%).");
+      } else {
+        Serial.println("  No valid SpO2 reading — hold finger still for ~4s.");
+      }
+      break;
+    }
+    case 3: {
+      Serial.println();
+      Serial.println("  [3] ACTIVITY");
+      Serial.printf ("  Steps:     %d of %d goal (%d%%)\n",
+                      data.steps, STEPS_GOAL,
+                      (int)min((float)data.steps/STEPS_GOAL*100, 100.0f));
+      Serial.printf ("  Active:    %d minutes\n", daily.activityMins);
+      if (gpsData.distanceM > 0) {
+        Serial.printf ("  Distance:  %.0f m (%.2f km)\n",
+                        gpsData.distanceM, gpsData.distanceM/1000.0f);
+        if (data.steps > 0)
+          Serial.printf ("  Stride:    ~%.2f m per step\n",
+                          gpsData.distanceM / data.steps);
+      } else {
+        Serial.println("  Distance:  No GPS fix");
+      }
+      break;
+    }
+    case 4: {
+      Serial.println();
+      Serial.println("  [4] ALTITUDE & FLOORS (BMP280)");
+      if (bmpOK) {
+        Serial.printf ("  Altitude:  %.1f m (relative to session start)\n", data.altitudeM);
+        Serial.printf ("  Floors up: %d   down: %d\n", data.floorsUp, data.floorsDown);
+        Serial.printf ("  Pressure:  %.1f hPa\n", data.pressureHPa);
+      } else {
+        Serial.println("  BMP280 not available.");
+      }
+      break;
+    }
+    case 5: {
+      Serial.println();
+      Serial.println("  [5] STABILITY & FALL RISK");
+      Serial.printf ("  Falls detected:  %d\n", daily.fallCount);
+      Serial.printf ("  Balance score:   %d / 100\n", data.balanceScore);
+      Serial.printf ("  Tilt angle:      %.1f degrees pitch, %.1f roll\n", data.tiltAngle, data.rollAngle);
+      Serial.printf ("  Tremor:          in %d of %d still windows (%lu skipped walking)\n",
+                     tremorSession.found, tremorSession.windows, (unsigned long)tremorSkipped);
+      if (tremorSession.found) {
+        float pct;
+        Serial.printf ("  Tremor average:  %.1f Hz, %.1f deg/s RMS\n",
+                       tremorSession.meanHz, tremorSession.meanDps);
+        if (tremorPast.change(tremorSession, &pct))
+          Serial.printf ("  Tremor trend:    %+.0f%% vs %d earlier sessions\n", pct, tremorPast.count);
+      }
+      Serial.printf ("  MPU health:      %s\n",
+                     mpuHealthDegraded ? "DEGRADED" : "OK");
+      break;
+    }
+    case 6: {
+      Serial.println();
+      Serial.println("  [6] TRENDS");
+      exportTrends();
+      break;
+    }
+    case 7: {
+      Serial.println();
+      Serial.println("  [7] DEVICE");
+      Serial.printf ("  Battery:   %.0f%%\n", data.battery);
+      Serial.printf ("  Worn:      %s (MAX30102 IR)\n",
+                     data.wearing ? "Yes" : "No");
+      Serial.printf ("  Sensors:   MPU=%s  MAX=%s  BMP=%s\n",
+                     mpuOK?"OK":"FAIL", maxOK?"OK":"FAIL", bmpOK?"OK":"FAIL");
+      if (mpuOK) {
+        Serial.printf ("  IMU FIFO:  %lu samples, ~%lu lost, %lu overflows\n",
+                       (unsigned long)imuPipe.samplesIn,
+                       (unsigned long)imuPipe.samplesLost,
+                       (unsigned long)imuPipe.overflows);
+      }
+      if (maxOK) {
+        Serial.printf ("  PPG FIFO:  %lu samples, %lu lost, %lu blocks dropped\n",
+                       (unsigned long)ppgAcq.samplesIn,
+                       (unsigned long)ppgAcq.samplesLost,
+                       (unsigned long)ppgAcq.blocksDropped);
+        Serial.printf ("  PPG:       %lu blocks, %lu skipped (%lu moving), %lu doubtful, %lu template relocks\n",
+                       (unsigned long)ppgQuality.blocks,
+                       (unsigned long)ppgQuality.skipped,
+                       (unsigned long)ppgQuality.byMotion,
+                       (unsigned long)ppgQuality.fair,
+                       (unsigned long)ppgQuality.relocks);
+      }
+      if (capture.active()) {
+        Serial.printf ("  Capture:   %lu records, %lu dropped, %lu bytes\n",
+                       (unsigned long)capture.records,
+                       (unsigned long)capture.dropped,
+                       (unsigned long)capture.bytesOut);
+      }
+      if (historyOK) {
+        Serial.printf ("  History:   %lu samples, %lu blocks, %lu bytes, %u/%u sectors, %lu forced erases\n",
+                       (unsigned long)history.samplesIn,
+                       (unsigned long)history.blocksOut,
+                       (unsigned long)history.flashBytes,
+                       history.used(), history.sectors(),
+                       (unsigned long)history.forcedErases);
+      }
+      Serial.printf ("  Alerts:    %lu raised, %lu confirmed, %u waiting, %lu resent, to the phone in %lu ms mean, %lu max\n",
+                     (unsigned long)alertLink.raised, (unsigned long)alertLink.confirmed,
+                     alertLink.waiting(), (unsigned long)alertLink.resent,
+                     (unsigned long)alertLink.latMeanMs(), (unsigned long)alertLink.latMaxMs);
+      Serial.printf ("  Stream:    %lu sessions, %lu frames made, %lu sent, %lu dropped, %lu bytes, level %u, %lu slower %lu faster\n",
+                     (unsigned long)stream.sessions, (unsigned long)stream.framesMade,
+                     (unsigned long)stream.framesSent, (unsigned long)stream.dropped(),
+                     (unsigned long)stream.bytesSent, stream.level(),
+                     (unsigned long)stream.slower, (unsigned long)stream.faster);
+      Serial.printf ("  Buttons:   %lu events, press to handled %.1f ms mean, %.1f max, %lu bounces, %lu resyncs, %lu dropped\n",
+                     (unsigned long)buttons.events, buttons.latMeanUs() / 1000.0f, buttons.latMaxUs / 1000.0f,
+                     (unsigned long)buttons.bounces, (unsigned long)buttons.resyncs,
+                     (unsigned long)buttons.dropped());
+      break;
+    }
+    case 8: {
+      Serial.println();
+      // Core 0's figures are read as they stand: report numbers,
+      // at worst a task out of date
+      Serial.println("  [8] SCHEDULERS");
+      Serial.printf ("  Core 0 (sensors) idle: %lu ms\n", (unsigned long)(acqSched.idleTotalUs / 1000));
+      printSchedReport(acqSched);
+      Serial.printf ("  Core 1 (UI, BLE) idle: %lu ms\n", (unsigned long)(sched.idleTotalUs / 1000));
+      printSchedReport(sched);
+      Serial.printf ("  Cross-core: %lu events, %lu commands dropped, %lu snapshot retries\n",
+                     (unsigned long)acqEvents.dropped, (unsigned long)acqCmds.dropped,
+                     (unsigned long)acqPub.retries);
+      Serial.printf ("  Log: %lu events, dropped %lu on core 0 and %lu on core 1, %lu not sent to BLE, max %lu queued\n",
+                     (unsigned long)eventLog().drained, (unsigned long)eventLog().dropped[0],
+                     (unsigned long)eventLog().dropped[1], (unsigned long)eventLog().lossyDropped,
+                     (unsigned long)eventLog().maxQueued);
+      break;
+    }
+    case 9: {
+      Serial.println();
+      Serial.println("  [9] SENSOR BUS");
+      Serial.printf ("  Recoveries: %lu\n", (unsigned long)i2c.recoveries);
+      printI2cReport();
+      break;
+    }
+    case 10: {
+      Serial.println();
+      Serial.println("=================================================");
+      Serial.println("  END OF REPORT");
+      Serial.println("=================================================");
+      Serial.println();
+      break;
+    }
+  }
+}
+
+// Button 1 held: the screen says so for SLEEP_SHOW_MS, then
+// sleepStep() powers down once the button is up
 void goToSleep() {
-  tft.fillScreen(0x0000);
-  tft.setTextDatum(MC_DATUM);
-  tft.setTextColor(0x2104);
-  tft.setTextSize(1);
-  tft.drawString("sleeping...", W/2, H/2 - 10);
-  tft.drawString("press any button to wake", W/2, H/2 + 8);
-  delay(1200);
-  while (digitalRead(BUTTON1_PIN) == LOW) delay(10);
-  delay(200);
+  historyCheckpoint();
+  acqCommand({ CMD_SLEEP });   // core 0 keeps the tremor session
+  actionMs = millis();
+  state = STATE_SLEEP;
+  needsFullDraw = true;
+}
+
+void drawSleepScreen() {
+  canvas.fillScreen(0x0000);
+  canvas.setTextDatum(MC_DATUM);
+  canvas.setTextColor(0x2104);
+  canvas.setTextSize(1);
+  canvas.drawString("sleeping...", W/2, H/2 - 10);
+  canvas.drawString("press any button to wake", W/2, H/2 + 8);
+}
+
+// A button still down would wake it straight away
+void sleepStep() {
+  if (millis() - actionMs < SLEEP_SHOW_MS) return;
+  if (buttons.isDown(0) || micros() - buttons.changedUs(0) < SLEEP_UP_MS * 1000UL) return;
   digitalWrite(TFT_BL, LOW);
   digitalWrite(LCD_PWR_PIN, LOW);
   esp_sleep_enable_ext0_wakeup(WAKE_PIN, 0);
   esp_deep_sleep_start();
 }
 
-void readButtons() {
-  bool b1 = (digitalRead(BUTTON1_PIN) == LOW);
-  bool b2 = (digitalRead(BUTTON2_PIN) == LOW);
-
-  static bool bothLast = false;
-  bool both = (b1 && b2);
-  if (both && !bothLast) { bothLast = true; exportSession(); return; }
-  bothLast = both;
-
-  bool b1Falling = (!b1 && btn1Last);
-  bool b2Falling = (!b2 && btn2Last);
-  btn1Pressed = false;
-  btn2Pressed = false;
-
-  if (b1) {
-    if (btn1HoldStart == 0) btn1HoldStart = millis();
-    if (!btn1Held && millis() - btn1HoldStart >= SLEEP_HOLD_MS) {
-      btn1Held = true; goToSleep();
-    }
-  } else {
-    if (b1Falling && !btn1Held && btn1HoldStart > 0) btn1Pressed = true;
-    btn1HoldStart = 0; btn1Held = false;
-  }
-
-  bool b2HoldScreen = (state == STATE_CLOCK || state == STATE_HEALTH);
-  if (b2) {
-    if (btn2HoldStart == 0) btn2HoldStart = millis();
-    if (!btn2Held && b2HoldScreen && millis() - btn2HoldStart >= RESET_HOLD_MS) {
-      btn2Held = true; resetSession();
+// Events from tiga_buttons.h, oldest first. A tap acts on its
+// release, so a press that goes long or chords does nothing else.
+void handleInput() {
+  ButtonEvent e;
+  while (buttons.next(micros(), &e)) {
+    if (e.type != BTN_LONG)   // the recorder lives on core 0
+      acqCommand({ CMD_CAPTURE_BUTTON, (uint8_t)(e.button + 1), e.type != BTN_RELEASE });
+    bool busy = state == STATE_RESET || state == STATE_EXPORT || state == STATE_SLEEP;
+    switch (e.type) {
+      case BTN_CHORD:
+        if (!busy) exportSession();
+        break;
+      case BTN_LONG:
+        if (busy) break;
+        if (e.button == 0) goToSleep();
+        else if (state == STATE_CLOCK || state == STATE_HEALTH) resetSession();
+        break;
+      case BTN_RELEASE:
+        if (e.tap) handleTap(e.button == 0, e.button == 1);
+        break;
+      case BTN_PRESS:
+        break;
     }
-  } else {
-    if (b2Falling && !btn2Held && btn2HoldStart > 0) btn2Pressed = true;
-    btn2HoldStart = 0; btn2Held = false;
   }
-
-  btn1Last = b1;
-  btn2Last = b2;
 }
 
-void handleInput() {
-  if (!btn1Pressed && !btn2Pressed) return;
+void handleTap(bool btn1Pressed, bool btn2Pressed) {
   switch (state) {
     case STATE_CLOCK:
       if (btn1Pressed) { state = STATE_HEALTH; needsFullDraw = true; }
@@ -1301,7 +2326,7 @@ void handleInput() {
           STATE_HEART, STATE_FITNESS, STATE_STABILITY, STATE_DEXTERITY,
           STATE_SUMMARY, STATE_DOCTOR, STATE_SETTINGS, STATE_SOS, STATE_CLOCK
         };
-        if (menuSel == 7) daily.sosCount++;
+        if (menuSel == 7) { acqCommand({ CMD_SOS }); alertSOS(); raiseAlert(ALERT_EV_SOS, ALERT_SEV_CRITICAL); }
         state = targets[menuSel];
         needsFullDraw = true;
       }
@@ -1316,20 +2341,21 @@ void handleInput() {
       if (btn1Pressed || btn2Pressed) { state = STATE_MENU; needsFullDraw = true; }
       break;
     case STATE_FALL_CONFIRM:
-      if (btn2Pressed) { inFall = false; state = STATE_CLOCK; needsFullDraw = true; }
+      if (btn2Pressed) { state = STATE_CLOCK; needsFullDraw = true; }
       break;
     case STATE_EMERGENCY:
     case STATE_SOS:
       if (btn2Pressed) { data.fallDetected = false; state = STATE_CLOCK; needsFullDraw = true; }
       break;
+    case STATE_RESET:
+    case STATE_EXPORT:
+    case STATE_SLEEP:
+      break;
   }
 }
 
-// ============================================================
-// DRAWING
-// ============================================================
 void drawScreenFull() {
-  tft.fillScreen(C_BG);
+  canvas.fillScreen(C_BG);
   switch(state) {
     case STATE_CLOCK:        drawClockFull();    break;
     case STATE_HEALTH:       drawHealthFull();   break;
@@ -1344,111 +2370,114 @@ void drawScreenFull() {
     case STATE_FALL_CONFIRM: drawFallConfirm();  break;
     case STATE_EMERGENCY:
     case STATE_SOS:          drawEmergency();    break;
+    case STATE_RESET:        drawResetScreen();  break;
+    case STATE_EXPORT:       drawExportScreen(); break;
+    case STATE_SLEEP:        drawSleepScreen();  break;
   }
 }
 
 void drawTopBar(const char* title, uint16_t col = C_CARD) {
-  tft.fillRect(0, 0, W, 22, col);
-  tft.setTextDatum(MC_DATUM);
-  tft.setTextColor(C_TEXT);
-  tft.setTextSize(1);
-  tft.drawString(title, W/2, 11);
+  canvas.fillRect(0, 0, W, 22, col);
+  canvas.setTextDatum(MC_DATUM);
+  canvas.setTextColor(C_TEXT);
+  canvas.setTextSize(1);
+  canvas.drawString(title, W/2, 11);
 }
 
 void drawBottomHint(const char* hint) {
-  tft.fillRect(0, H-14, W, 14, C_CARD);
-  tft.setTextDatum(MC_DATUM);
-  tft.setTextColor(C_MUTED);
-  tft.setTextSize(1);
-  tft.drawString(hint, W/2, H-7);
+  canvas.fillRect(0, H-14, W, 14, C_CARD);
+  canvas.setTextDatum(MC_DATUM);
+  canvas.setTextColor(C_MUTED);
+  canvas.setTextSize(1);
+  canvas.drawString(hint, W/2, H-7);
 }
 
 void drawSplash() {
-  tft.fillScreen(C_BG);
-  tft.setTextDatum(MC_DATUM);
-  tft.setTextColor(C_ACCENT);
-  tft.setTextSize(4);
-  tft.drawString("tiga", W/2, H/2 - 18);
-  tft.setTextSize(1);
-  tft.setTextColor(C_MUTED);
-  tft.drawString("health tracker for mom", W/2, H/2 + 18);
-  tft.setTextColor(C_DIM);
-  tft.drawString("v6a", W/2, H/2 + 34);
+  canvas.fillScreen(C_BG);
+  canvas.setTextDatum(MC_DATUM);
+  canvas.setTextColor(C_ACCENT);
+  canvas.setTextSize(4);
+  canvas.drawString("tiga", W/2, H/2 - 18);
+  canvas.setTextSize(1);
+  canvas.setTextColor(C_MUTED);
+  canvas.drawString("health tracker for mom", W/2, H/2 + 18);
+  canvas.setTextColor(C_DIM);
+  canvas.drawString("v6a", W/2, H/2 + 34);
 }
 
 // ── CLOCK ────────────────────────────────────────────────────
 void drawClockFull() {
-  tft.fillCircle(12, 12, 5, healthDot());
+  canvas.fillCircle(12, 12, 5, healthDot());
 
   char batStr[8]; sprintf(batStr, "%.0f%%", data.battery);
-  tft.setTextDatum(MR_DATUM);
-  tft.setTextSize(1);
-  tft.setTextColor(data.battery < 20 ? C_ORANGE : C_DIM);
-  tft.drawString(batStr, W-8, 12);
+  canvas.setTextDatum(MR_DATUM);
+  canvas.setTextSize(1);
+  canvas.setTextColor(data.battery < 20 ? C_ORANGE : C_DIM);
+  canvas.drawString(batStr, W-8, 12);
 
   if (!data.wearing) {
-    tft.setTextDatum(MC_DATUM);
-    tft.setTextColor(C_DIM);
-    tft.setTextSize(1);
-    tft.drawString("not worn", W/2, 12);
+    canvas.setTextDatum(MC_DATUM);
+    canvas.setTextColor(C_DIM);
+    canvas.setTextSize(1);
+    canvas.drawString("not worn", W/2, 12);
   }
 
   char timeStr[8];
   sprintf(timeStr, "%02d:%02d", displayHour, displayMin);
-  tft.setTextDatum(MC_DATUM);
-  tft.setTextColor(C_TEXT);
-  tft.setTextSize(5);
-  tft.drawString(timeStr, W/2, 78);
+  canvas.setTextDatum(MC_DATUM);
+  canvas.setTextColor(C_TEXT);
+  canvas.setTextSize(5);
+  canvas.drawString(timeStr, W/2, 78);
 
   char dateStr[24];
-  struct tm ti; getLocalTime(&ti);
+  struct tm ti = {}; getLocalTime(&ti);   // stays Sunday until NTP has set the clock
   sprintf(dateStr, "%s, %d %s %d",
           dayNames[ti.tm_wday], displayDay, monthNames[displayMonth], displayYear);
-  tft.setTextSize(1);
-  tft.setTextColor(C_MUTED);
-  tft.drawString(dateStr, W/2, 120);
-
-  tft.setTextColor(C_DIM);
-  tft.setTextDatum(ML_DATUM);
-  tft.drawString("BTN1: health  hold: sleep", 8, H-8);
-  tft.setTextDatum(MR_DATUM);
-  tft.drawString("BTN2 hold: reset  both: export", W-8, H-8);
+  canvas.setTextSize(1);
+  canvas.setTextColor(C_MUTED);
+  canvas.drawString(dateStr, W/2, 120);
+
+  canvas.setTextColor(C_DIM);
+  canvas.setTextDatum(ML_DATUM);
+  canvas.drawString("BTN1: health  hold: sleep", 8, H-8);
+  canvas.setTextDatum(MR_DATUM);
+  canvas.drawString("BTN2 hold: reset  both: export", W-8, H-8);
 }
 
 void drawClockPartial() {
   if (displayMin == prev.minute) return;
-  tft.fillRect(20, 52, W-40, 60, C_BG);
+  canvas.fillRect(20, 52, W-40, 60, C_BG);
   char timeStr[8];
   sprintf(timeStr, "%02d:%02d", displayHour, displayMin);
-  tft.setTextDatum(MC_DATUM);
-  tft.setTextColor(C_TEXT);
-  tft.setTextSize(5);
-  tft.drawString(timeStr, W/2, 78);
+  canvas.setTextDatum(MC_DATUM);
+  canvas.setTextColor(C_TEXT);
+  canvas.setTextSize(5);
+  canvas.drawString(timeStr, W/2, 78);
   if (data.healthScore != prev.healthScore) {
-    tft.fillCircle(12, 12, 6, C_BG);
-    tft.fillCircle(12, 12, 5, healthDot());
+    canvas.fillCircle(12, 12, 6, C_BG);
+    canvas.fillCircle(12, 12, 5, healthDot());
   }
 }
 
 // ── HEALTH DASHBOARD ─────────────────────────────────────────
 void drawHealthFull() {
-  tft.fillRect(0, 0, W, 22, C_CARD);
-  tft.setTextDatum(ML_DATUM);
-  tft.setTextSize(1);
-  tft.setTextColor(data.wearing ? C_GREEN : C_MUTED);
-  tft.drawString(data.wearing ? "wearing" : "not worn", 6, 11);
+  canvas.fillRect(0, 0, W, 22, C_CARD);
+  canvas.setTextDatum(ML_DATUM);
+  canvas.setTextSize(1);
+  canvas.setTextColor(data.wearing ? C_GREEN : C_MUTED);
+  canvas.drawString(data.wearing ? "wearing" : "not worn", 6, 11);
 
   char scoreStr[16]; sprintf(scoreStr, "score %d", data.healthScore);
   uint16_t sc = data.healthScore >= 75 ? C_GREEN :
                 data.healthScore >= 50 ? C_ORANGE : C_RED;
-  tft.setTextDatum(MC_DATUM);
-  tft.setTextColor(sc);
-  tft.drawString(scoreStr, W/2, 11);
+  canvas.setTextDatum(MC_DATUM);
+  canvas.setTextColor(sc);
+  canvas.drawString(scoreStr, W/2, 11);
 
   char batStr[8]; sprintf(batStr, "%.0f%%", data.battery);
-  tft.setTextDatum(MR_DATUM);
-  tft.setTextColor(data.battery < 20 ? C_ORANGE : C_MUTED);
-  tft.drawString(batStr, W-6, 11);
+  canvas.setTextDatum(MR_DATUM);
+  canvas.setTextColor(data.battery < 20 ? C_ORANGE : C_MUTED);
+  canvas.drawString(batStr, W-6, 11);
 
   drawHealthCards();
   drawBottomHint("BTN1: clock   BTN2: menu");
@@ -1458,55 +2487,55 @@ void drawHealthCards() {
   int cx=4, cy=26, cw=(W-12)/2, ch=(H-cy-18)/2, gap=4;
 
   // Heart card
-  tft.fillRect(cx, cy, cw, ch, C_CARD);
-  tft.setTextDatum(ML_DATUM); tft.setTextSize(1); tft.setTextColor(C_MUTED);
-  tft.drawString("HEART", cx+6, cy+10);
-  tft.setTextDatum(MC_DATUM); tft.setTextSize(1);
-  tft.setTextColor(hrStatusColor());
-  tft.drawString(hrStatusLabel(), cx+cw/2, cy+ch/2+6);
+  canvas.fillRect(cx, cy, cw, ch, C_CARD);
+  canvas.setTextDatum(ML_DATUM); canvas.setTextSize(1); canvas.setTextColor(C_MUTED);
+  canvas.drawString("HEART", cx+6, cy+10);
+  canvas.setTextDatum(MC_DATUM); canvas.setTextSize(1);
+  canvas.setTextColor(hrStatusColor());
+  canvas.drawString(hrStatusLabel(), cx+cw/2, cy+ch/2+6);
 
   // Steps card
-  tft.fillRect(cx+cw+gap, cy, cw, ch, C_CARD);
-  tft.setTextDatum(ML_DATUM); tft.setTextColor(C_MUTED);
-  tft.drawString("STEPS", cx+cw+gap+6, cy+10);
+  canvas.fillRect(cx+cw+gap, cy, cw, ch, C_CARD);
+  canvas.setTextDatum(ML_DATUM); canvas.setTextColor(C_MUTED);
+  canvas.drawString("STEPS", cx+cw+gap+6, cy+10);
   char stepsStr[12]; sprintf(stepsStr, "%d", data.steps);
   float prog = min((float)data.steps/STEPS_GOAL, 1.0f);
   uint16_t stCol = prog>=1.0f ? C_GREEN : prog>=0.5f ? C_ACCENT : C_TEXT;
-  tft.setTextDatum(MC_DATUM); tft.setTextSize(2); tft.setTextColor(stCol);
-  tft.drawString(stepsStr, cx+cw+gap+cw/2, cy+ch/2+2);
+  canvas.setTextDatum(MC_DATUM); canvas.setTextSize(2); canvas.setTextColor(stCol);
+  canvas.drawString(stepsStr, cx+cw+gap+cw/2, cy+ch/2+2);
   int bx=cx+cw+gap+4, by=cy+ch-10, bw=cw-8, bh=5;
-  tft.fillRect(bx, by, bw, bh, C_BG);
-  tft.fillRect(bx, by, (int)(bw*prog), bh, stCol);
+  canvas.fillRect(bx, by, bw, bh, C_BG);
+  canvas.fillRect(bx, by, (int)(bw*prog), bh, stCol);
 
   // SpO2 card (replaces Stability on this dashboard)
-  tft.fillRect(cx, cy+ch+gap, cw, ch, C_CARD);
-  tft.setTextDatum(ML_DATUM); tft.setTextSize(1); tft.setTextColor(C_MUTED);
-  tft.drawString("SPO2", cx+6, cy+ch+gap+10);
-  tft.setTextDatum(MC_DATUM); tft.setTextSize(1);
+  canvas.fillRect(cx, cy+ch+gap, cw, ch, C_CARD);
+  canvas.setTextDatum(ML_DATUM); canvas.setTextSize(1); canvas.setTextColor(C_MUTED);
+  canvas.drawString("SPO2", cx+6, cy+ch+gap+10);
+  canvas.setTextDatum(MC_DATUM); canvas.setTextSize(1);
   if (data.spO2Valid) {
     char spo2Str[8]; sprintf(spo2Str, "%d%%", data.spO2);
     uint16_t sCol = data.spO2 >= 95 ? C_GREEN :
                     data.spO2 >= 90 ? C_ORANGE : C_RED;
-    tft.setTextColor(sCol); tft.setTextSize(2);
-    tft.drawString(spo2Str, cx+cw/2, cy+ch+gap+ch/2+6);
+    canvas.setTextColor(sCol); canvas.setTextSize(2);
+    canvas.drawString(spo2Str, cx+cw/2, cy+ch+gap+ch/2+6);
   } else {
-    tft.setTextColor(C_MUTED);
-    tft.drawString(data.wearing ? "reading..." : "no finger", cx+cw/2, cy+ch+gap+ch/2+6);
+    canvas.setTextColor(C_MUTED);
+    canvas.drawString(data.wearing ? "reading..." : "no finger", cx+cw/2, cy+ch+gap+ch/2+6);
   }
 
   // Altitude card
-  tft.fillRect(cx+cw+gap, cy+ch+gap, cw, ch, C_CARD);
-  tft.setTextDatum(ML_DATUM); tft.setTextColor(C_MUTED);
-  tft.drawString("ALT / FLOOR", cx+cw+gap+6, cy+ch+gap+10);
-  tft.setTextDatum(MC_DATUM); tft.setTextSize(1);
+  canvas.fillRect(cx+cw+gap, cy+ch+gap, cw, ch, C_CARD);
+  canvas.setTextDatum(ML_DATUM); canvas.setTextColor(C_MUTED);
+  canvas.drawString("ALT / FLOOR", cx+cw+gap+6, cy+ch+gap+10);
+  canvas.setTextDatum(MC_DATUM); canvas.setTextSize(1);
   if (bmpOK) {
     char altStr[20];
     sprintf(altStr, "%.0fm  F:%d", data.altitudeM, data.floorsUp);
-    tft.setTextColor(C_ACCENT);
-    tft.drawString(altStr, cx+cw+gap+cw/2, cy+ch+gap+ch/2+6);
+    canvas.setTextColor(C_ACCENT);
+    canvas.drawString(altStr, cx+cw+gap+cw/2, cy+ch+gap+ch/2+6);
   } else {
-    tft.setTextColor(C_DIM);
-    tft.drawString("no sensor", cx+cw+gap+cw/2, cy+ch+gap+ch/2+6);
+    canvas.setTextColor(C_DIM);
+    canvas.drawString("no sensor", cx+cw+gap+cw/2, cy+ch+gap+ch/2+6);
   }
 }
 
@@ -1514,61 +2543,61 @@ void drawHealthPartial() {
   int cx=4, cy=26, cw=(W-12)/2, ch=(H-cy-18)/2, gap=4;
 
   if ((int)data.heartRate != (int)prev.heartRate) {
-    tft.fillRect(cx+1, cy+16, cw-2, ch-17, C_CARD);
-    tft.setTextDatum(MC_DATUM); tft.setTextSize(1);
-    tft.setTextColor(hrStatusColor());
-    tft.drawString(hrStatusLabel(), cx+cw/2, cy+ch/2+6);
+    canvas.fillRect(cx+1, cy+16, cw-2, ch-17, C_CARD);
+    canvas.setTextDatum(MC_DATUM); canvas.setTextSize(1);
+    canvas.setTextColor(hrStatusColor());
+    canvas.drawString(hrStatusLabel(), cx+cw/2, cy+ch/2+6);
   }
   if (data.steps != prev.steps) {
-    tft.fillRect(cx+cw+gap+1, cy+16, cw-2, ch-17, C_CARD);
+    canvas.fillRect(cx+cw+gap+1, cy+16, cw-2, ch-17, C_CARD);
     char stepsStr[12]; sprintf(stepsStr, "%d", data.steps);
     float prog = min((float)data.steps/STEPS_GOAL, 1.0f);
     uint16_t stCol = prog>=1.0f ? C_GREEN : prog>=0.5f ? C_ACCENT : C_TEXT;
-    tft.setTextDatum(MC_DATUM); tft.setTextSize(2); tft.setTextColor(stCol);
-    tft.drawString(stepsStr, cx+cw+gap+cw/2, cy+ch/2+2);
+    canvas.setTextDatum(MC_DATUM); canvas.setTextSize(2); canvas.setTextColor(stCol);
+    canvas.drawString(stepsStr, cx+cw+gap+cw/2, cy+ch/2+2);
     int bx=cx+cw+gap+4, by=cy+ch-10, bw=cw-8, bh=5;
-    tft.fillRect(bx, by, bw, bh, C_BG);
-    tft.fillRect(bx, by, (int)(bw*prog), bh, stCol);
+    canvas.fillRect(bx, by, bw, bh, C_BG);
+    canvas.fillRect(bx, by, (int)(bw*prog), bh, stCol);
   }
   if (data.spO2 != prev.spO2 || data.wearing != prev.wearing) {
-    tft.fillRect(cx+1, cy+ch+gap+16, cw-2, ch-17, C_CARD);
-    tft.setTextDatum(MC_DATUM);
+    canvas.fillRect(cx+1, cy+ch+gap+16, cw-2, ch-17, C_CARD);
+    canvas.setTextDatum(MC_DATUM);
     if (data.spO2Valid) {
       char spo2Str[8]; sprintf(spo2Str, "%d%%", data.spO2);
       uint16_t sCol = data.spO2 >= 95 ? C_GREEN :
                       data.spO2 >= 90 ? C_ORANGE : C_RED;
-      tft.setTextColor(sCol); tft.setTextSize(2);
-      tft.drawString(spo2Str, cx+cw/2, cy+ch+gap+ch/2+6);
+      canvas.setTextColor(sCol); canvas.setTextSize(2);
+      canvas.drawString(spo2Str, cx+cw/2, cy+ch+gap+ch/2+6);
     } else {
-      tft.setTextColor(C_MUTED); tft.setTextSize(1);
-      tft.drawString(data.wearing ? "reading..." : "no finger", cx+cw/2, cy+ch+gap+ch/2+6);
+      canvas.setTextColor(C_MUTED); canvas.setTextSize(1);
+      canvas.drawString(data.wearing ? "reading..." : "no finger", cx+cw/2, cy+ch+gap+ch/2+6);
     }
   }
   if (data.altitudeM != prev.altitudeM) {
-    tft.fillRect(cx+cw+gap+1, cy+ch+gap+16, cw-2, ch-17, C_CARD);
-    tft.setTextDatum(MC_DATUM); tft.setTextSize(1);
+    canvas.fillRect(cx+cw+gap+1, cy+ch+gap+16, cw-2, ch-17, C_CARD);
+    canvas.setTextDatum(MC_DATUM); canvas.setTextSize(1);
     if (bmpOK) {
       char altStr[20];
       sprintf(altStr, "%.0fm  F:%d", data.altitudeM, data.floorsUp);
-      tft.setTextColor(C_ACCENT);
-      tft.drawString(altStr, cx+cw+gap+cw/2, cy+ch+gap+ch/2+6);
+      canvas.setTextColor(C_ACCENT);
+      canvas.drawString(altStr, cx+cw+gap+cw/2, cy+ch+gap+ch/2+6);
     }
   }
   if (data.healthScore != prev.healthScore || data.wearing != prev.wearing ||
       (int)data.battery != (int)prev.battery) {
-    tft.fillRect(0, 0, W, 22, C_CARD);
-    tft.setTextDatum(ML_DATUM); tft.setTextSize(1);
-    tft.setTextColor(data.wearing ? C_GREEN : C_MUTED);
-    tft.drawString(data.wearing ? "wearing" : "not worn", 6, 11);
+    canvas.fillRect(0, 0, W, 22, C_CARD);
+    canvas.setTextDatum(ML_DATUM); canvas.setTextSize(1);
+    canvas.setTextColor(data.wearing ? C_GREEN : C_MUTED);
+    canvas.drawString(data.wearing ? "wearing" : "not worn", 6, 11);
     char scoreStr[16]; sprintf(scoreStr, "score %d", data.healthScore);
     uint16_t sc = data.healthScore >= 75 ? C_GREEN :
                   data.healthScore >= 50 ? C_ORANGE : C_RED;
-    tft.setTextDatum(MC_DATUM); tft.setTextColor(sc);
-    tft.drawString(scoreStr, W/2, 11);
+    canvas.setTextDatum(MC_DATUM); canvas.setTextColor(sc);
+    canvas.drawString(scoreStr, W/2, 11);
     char batStr[8]; sprintf(batStr, "%.0f%%", data.battery);
-    tft.setTextDatum(MR_DATUM);
-    tft.setTextColor(data.battery < 20 ? C_ORANGE : C_MUTED);
-    tft.drawString(batStr, W-6, 11);
+    canvas.setTextDatum(MR_DATUM);
+    canvas.setTextColor(data.battery < 20 ? C_ORANGE : C_MUTED);
+    canvas.drawString(batStr, W-6, 11);
   }
 }
 
@@ -1579,10 +2608,10 @@ void drawMenu() {
   for (int i=0; i<MENU_COUNT; i++) {
     bool sel = (i==menuSel);
     int y = startY + i*itemH;
-    if (sel) { tft.fillRect(8, y, W-16, itemH-1, C_ACCENT); tft.setTextColor(C_BG); }
-    else tft.setTextColor(i==7 ? C_RED : C_TEXT);
-    tft.setTextDatum(ML_DATUM); tft.setTextSize(1);
-    tft.drawString(menuItems[i], 18, y+itemH/2);
+    if (sel) { canvas.fillRect(8, y, W-16, itemH-1, C_ACCENT); canvas.setTextColor(C_BG); }
+    else canvas.setTextColor(i==7 ? C_RED : C_TEXT);
+    canvas.setTextDatum(ML_DATUM); canvas.setTextSize(1);
+    canvas.drawString(menuItems[i], 18, y+itemH/2);
   }
   drawBottomHint("BTN1: scroll   BTN2: select");
 }
@@ -1590,58 +2619,69 @@ void drawMenu() {
 // ── HEART DETAIL ─────────────────────────────────────────────
 void drawHeart() {
   drawTopBar("HEART");
-  tft.setTextDatum(MC_DATUM);
+  canvas.setTextDatum(MC_DATUM);
 
-  tft.setTextSize(1);
-  tft.setTextColor(hrStatusColor());
-  tft.drawString(hrStatusLabel(), W/2, 38);
+  canvas.setTextSize(1);
+  canvas.setTextColor(hrStatusColor());
+  canvas.drawString(hrStatusLabel(), W/2, 38);
 
   if (data.heartRate > 0) {
     char bpmStr[16]; sprintf(bpmStr, "%.0f bpm", data.heartRate);
-    tft.setTextColor(C_MUTED);
-    tft.drawString(bpmStr, W/2, 54);
+    canvas.setTextColor(C_MUTED);
+    canvas.drawString(bpmStr, W/2, 54);
   }
 
   // Zone bar
-  tft.fillRect(20, 68, W-40, 14, C_CARD);
+  canvas.fillRect(20, 68, W-40, 14, C_CARD);
   const char* zones[] = {"Rest","Light","Moderate","High"};
   uint16_t zoneColors[] = {C_ACCENT, C_GREEN, C_ORANGE, C_RED};
   int zw = (W-40)/4;
   for (int i=0; i<4; i++) {
     uint16_t col = (i==data.hrZone) ? zoneColors[i] : C_CARD2;
-    tft.fillRect(20+i*zw, 68, zw-2, 14, col);
-    tft.setTextDatum(MC_DATUM);
-    tft.setTextColor(i==data.hrZone ? C_BG : C_MUTED);
-    tft.setTextSize(1);
-    tft.drawString(zones[i], 20+i*zw+zw/2, 75);
+    canvas.fillRect(20+i*zw, 68, zw-2, 14, col);
+    canvas.setTextDatum(MC_DATUM);
+    canvas.setTextColor(i==data.hrZone ? C_BG : C_MUTED);
+    canvas.setTextSize(1);
+    canvas.drawString(zones[i], 20+i*zw+zw/2, 75);
   }
 
-  tft.setTextColor(C_TEXT);
-  tft.drawString(hrZoneLabel(), W/2, 94);
+  canvas.setTextColor(C_TEXT);
+  canvas.drawString(hrZoneLabel(), W/2, 94);
 
   // SpO2 line
   if (data.spO2Valid) {
     char spo2Str[20]; sprintf(spo2Str, "SpO2: %d%%", data.spO2);
     uint16_t sCol = data.spO2 >= 95 ? C_GREEN :
                     data.spO2 >= 90 ? C_ORANGE : C_RED;
-    tft.setTextColor(sCol);
-    tft.drawString(spo2Str, W/2, 110);
+    canvas.setTextColor(sCol);
+    canvas.drawString(spo2Str, W/2, 107);
+  } else {
+    canvas.setTextColor(C_DIM);
+    canvas.drawString(data.wearing ? "SpO2: reading..." : "SpO2: place finger", W/2, 107);
+  }
+
+  // HRV line — last minute
+  if (hrvShort.valid) {
+    char hrvStr[40];
+    sprintf(hrvStr, "HRV: RMSSD %.0f ms  SDNN %.0f ms", hrvShort.rmssdMs, hrvShort.sdnnMs);
+    canvas.setTextColor(C_ACCENT);
+    canvas.drawString(hrvStr, W/2, 120);
   } else {
-    tft.setTextColor(C_DIM);
-    tft.drawString(data.wearing ? "SpO2: reading..." : "SpO2: place finger", W/2, 110);
+    canvas.setTextColor(C_DIM);
+    canvas.drawString(data.wearing ? "HRV: keep still for a minute" : "HRV: place finger", W/2, 120);
   }
 
   char rng[32]; sprintf(rng, "safe: %d - %d bpm", HR_SAFE_MIN, HR_SAFE_MAX);
-  tft.setTextColor(C_DIM);
-  tft.drawString(rng, W/2, 126);
+  canvas.setTextColor(C_DIM);
+  canvas.drawString(rng, W/2, 133);
 
-  tft.setTextColor(C_MUTED);
+  canvas.setTextColor(C_MUTED);
   if (data.hrZone >= 3)
-    tft.drawString("Slow down and breathe deeply.", W/2, 142);
+    canvas.drawString("Slow down and breathe deeply.", W/2, 146);
   else if (data.hrZone == 0 && data.heartRate > 0)
-    tft.drawString("Good resting heart rate.", W/2, 142);
+    canvas.drawString("Good resting heart rate.", W/2, 146);
   else
-    tft.drawString("Keep going — you're doing well.", W/2, 142);
+    canvas.drawString("Keep going — you're doing well.", W/2, 146);
 
   drawBottomHint("any button: back");
 }
@@ -1649,37 +2689,37 @@ void drawHeart() {
 // ── FITNESS ──────────────────────────────────────────────────
 void drawFitness() {
   drawTopBar("FITNESS");
-  tft.setTextDatum(MC_DATUM);
-  tft.setTextColor(C_TEXT); tft.setTextSize(1);
-  tft.drawString(stepsLabel(), W/2, 38);
+  canvas.setTextDatum(MC_DATUM);
+  canvas.setTextColor(C_TEXT); canvas.setTextSize(1);
+  canvas.drawString(stepsLabel(), W/2, 38);
 
   char stepsStr[20]; sprintf(stepsStr, "%d of %d steps", data.steps, STEPS_GOAL);
-  tft.setTextColor(C_MUTED);
-  tft.drawString(stepsStr, W/2, 54);
+  canvas.setTextColor(C_MUTED);
+  canvas.drawString(stepsStr, W/2, 54);
 
   float prog = min((float)data.steps/STEPS_GOAL, 1.0f);
   uint16_t stCol = prog>=1.0f ? C_GREEN : prog>=0.5f ? C_ACCENT : C_TEXT;
-  tft.fillRect(20, 66, W-40, 12, C_CARD);
-  tft.fillRect(20, 66, (int)((W-40)*prog), 12, stCol);
+  canvas.fillRect(20, 66, W-40, 12, C_CARD);
+  canvas.fillRect(20, 66, (int)((W-40)*prog), 12, stCol);
 
   char pctStr[16]; sprintf(pctStr, "%.0f%%", prog*100);
-  tft.setTextColor(stCol);
-  tft.drawString(pctStr, W/2, 92);
+  canvas.setTextColor(stCol);
+  canvas.drawString(pctStr, W/2, 92);
 
   // Altitude row
   if (bmpOK) {
-    char altStr[32];
-    sprintf(altStr, "Altitude: %.0fm  Floors: %d", data.altitudeM, data.floorsUp);
-    tft.setTextColor(C_ACCENT);
-    tft.drawString(altStr, W/2, 108);
+    char altStr[48];
+    sprintf(altStr, "Altitude: %.0fm  Floors: +%d -%d", data.altitudeM, data.floorsUp, data.floorsDown);
+    canvas.setTextColor(C_ACCENT);
+    canvas.drawString(altStr, W/2, 108);
   }
 
-  tft.setTextColor(C_MUTED);
+  canvas.setTextColor(C_MUTED);
   char actStr[32]; sprintf(actStr, "Active time: %d min", daily.activityMins);
-  tft.drawString(actStr, W/2, bmpOK ? 124 : 108);
+  canvas.drawString(actStr, W/2, bmpOK ? 124 : 108);
 
-  tft.setTextColor(fabsf(data.tiltAngle) < 20 ? C_GREEN : C_ORANGE);
-  tft.drawString(postureLabel(), W/2, bmpOK ? 140 : 124);
+  canvas.setTextColor(fabsf(data.tiltAngle) < 20 ? C_GREEN : C_ORANGE);
+  canvas.drawString(postureLabel(), W/2, bmpOK ? 140 : 124);
 
   if (gpsData.hasFix) {
     char distStr[32];
@@ -1687,12 +2727,12 @@ void drawFitness() {
       sprintf(distStr, "%.0f m  %.1f km/h", gpsData.distanceM, gpsData.speedKmh);
     else
       sprintf(distStr, "%.2f km  %.1f km/h", gpsData.distanceM/1000.0f, gpsData.speedKmh);
-    tft.setTextColor(C_ACCENT);
-    tft.drawString(distStr, W/2, 156);
+    canvas.setTextColor(C_ACCENT);
+    canvas.drawString(distStr, W/2, 156);
   } else {
-    tft.setTextColor(C_DIM);
+    canvas.setTextColor(C_DIM);
     char satStr[32]; sprintf(satStr, "GPS searching (%d sats)", gpsData.satellites);
-    tft.drawString(satStr, W/2, 156);
+    canvas.drawString(satStr, W/2, 156);
   }
 
   drawBottomHint("any button: back");
@@ -1701,110 +2741,168 @@ void drawFitness() {
 // ── STABILITY ────────────────────────────────────────────────
 void drawStability() {
   drawTopBar("STABILITY & SAFETY");
-  tft.setTextDatum(MC_DATUM);
+  canvas.setTextDatum(MC_DATUM);
 
   uint16_t stabCol = data.isStable ? C_GREEN : C_ORANGE;
-  tft.setTextSize(2); tft.setTextColor(stabCol);
-  tft.drawString(data.isStable ? "Moving well" : "Watch your step", W/2, 50);
+  canvas.setTextSize(2); canvas.setTextColor(stabCol);
+  canvas.drawString(data.isStable ? "Moving well" : "Watch your step", W/2, 50);
 
-  tft.setTextSize(1); tft.setTextColor(C_MUTED);
+  canvas.setTextSize(1); canvas.setTextColor(C_MUTED);
   char balStr[24]; sprintf(balStr, "Balance score: %d / 100", data.balanceScore);
-  tft.drawString(balStr, W/2, 72);
+  canvas.drawString(balStr, W/2, 72);
 
   uint16_t balCol = data.balanceScore>70 ? C_GREEN :
                     data.balanceScore>40 ? C_ORANGE : C_RED;
-  tft.fillRect(40, 82, W-80, 10, C_CARD);
-  tft.fillRect(40, 82, (int)((W-80)*(data.balanceScore/100.0f)), 10, balCol);
+  canvas.fillRect(40, 82, W-80, 10, C_CARD);
+  canvas.fillRect(40, 82, (int)((W-80)*(data.balanceScore/100.0f)), 10, balCol);
 
-  tft.setTextColor(fabsf(data.tiltAngle)<20 ? C_GREEN : C_ORANGE);
-  tft.drawString(postureLabel(), W/2, 104);
+  canvas.setTextColor(fabsf(data.tiltAngle)<20 ? C_GREEN : C_ORANGE);
+  canvas.drawString(postureLabel(), W/2, 104);
 
-  tft.setTextColor(C_DIM);
-  char motionStr[32]; sprintf(motionStr, "Fall detection: active  %.2fG", data.accelG);
-  tft.drawString(motionStr, W/2, 120);
+  canvas.setTextColor(C_DIM);
+  char motionStr[48];
+  sprintf(motionStr, "Pitch %+.0f  Roll %+.0f  Vert %+.2fG",
+          data.tiltAngle, data.rollAngle, data.vertAccelG);
+  canvas.drawString(motionStr, W/2, 120);
 
   char fallStr[24]; sprintf(fallStr, "Falls today: %d", daily.fallCount);
-  tft.setTextColor(daily.fallCount>0 ? C_ORANGE : C_MUTED);
-  tft.drawString(fallStr, W/2, 136);
+  canvas.setTextColor(daily.fallCount>0 ? C_ORANGE : C_MUTED);
+  canvas.drawString(fallStr, W/2, 136);
 
-  tft.setTextColor(C_DIM);
-  tft.drawString(daily.fallCount>0 ? "Please take extra care today."
+  canvas.setTextColor(C_DIM);
+  canvas.drawString(daily.fallCount>0 ? "Please take extra care today."
                                     : "Stay safe. Take your time on stairs.", W/2, 152);
   drawBottomHint("any button: back");
 }
 
 // ── DEXTERITY ────────────────────────────────────────────────
+// Tremor from the gyro spectrum (tiga_tremor.h): the last still
+// window, this session, and a bar per past session
 void drawDexterity() {
-  drawTopBar("DEXTERITY TEST");
-  tft.setTextDatum(MC_DATUM); tft.setTextSize(1); tft.setTextColor(C_MUTED);
-  tft.drawString("Dexterity tests coming in v6b", W/2, 60);
-  tft.drawString("with button-tap reaction test.", W/2, 78);
+  drawTopBar("DEXTERITY: TREMOR");
+  canvas.setTextDatum(MC_DATUM); canvas.setTextSize(1);
+
+  if (!tremorSession.windows) {
+    canvas.setTextColor(C_MUTED);
+    canvas.drawString("Rest your arm and hold still", W/2, 60);
+    canvas.setTextColor(C_DIM);
+    canvas.drawString(tremorSkipped ? "Paused while you walk" : "Measuring...", W/2, 78);
+    drawBottomHint("any button: back");
+    return;
+  }
+
+  char s[48];
+  bool now = data.tremorHz > 0;
+  canvas.setTextSize(2); canvas.setTextColor(now ? C_ORANGE : C_GREEN);
+  if (now) sprintf(s, "%.1f Hz tremor", data.tremorHz); else strcpy(s, "Steady hand");
+  canvas.drawString(s, W/2, 42);
+
+  canvas.setTextSize(1); canvas.setTextColor(C_MUTED);
+  if (now) sprintf(s, "%.1f deg/s, about +/-%.1f deg", data.tremorDps, data.tremorAmpDeg);
+  else     strcpy(s, "No 4-12 Hz tremor just now");
+  canvas.drawString(s, W/2, 62);
+
+  sprintf(s, "This session: in %d of %d checks", tremorSession.found, tremorSession.windows);
+  canvas.drawString(s, W/2, 78);
+  if (tremorSession.found) {
+    sprintf(s, "Average %.1f Hz, %.1f deg/s", tremorSession.meanHz, tremorSession.meanDps);
+    canvas.drawString(s, W/2, 92);
+  }
+
+  float pct;
+  if (tremorPast.change(tremorSession, &pct)) {
+    sprintf(s, "%+.0f%% vs earlier sessions", pct);
+    canvas.setTextColor(pct > 20 ? C_ORANGE : pct < -20 ? C_GREEN : C_MUTED);
+  } else {
+    strcpy(s, tremorPast.count ? "Nothing to compare yet" : "First session on record");
+    canvas.setTextColor(C_DIM);
+  }
+  canvas.drawString(s, W/2, 108);
+
+  // Oldest on the left, this session last; height is mean °/s
+  float top = tremorSession.meanDps;
+  for (uint8_t i = 0; i < tremorPast.count; i++) top = fmaxf(top, tremorPast.ago(i).meanDps);
+  if (top > 0) {
+    int n = tremorPast.count + 1, bw = 18, x = W/2 - (n * (bw + 4)) / 2;
+    for (int i = n - 1; i >= 0; i--, x += bw + 4) {
+      const TremorSession& t = i ? tremorPast.ago(i - 1) : tremorSession;
+      int h = (int)(30 * t.meanDps / top);
+      canvas.fillRect(x, 118, bw, 30, C_CARD);
+      canvas.fillRect(x, 148 - h, bw, h, i ? C_MUTED : C_ACCENT);
+    }
+  }
   drawBottomHint("any button: back");
 }
 
 // ── SUMMARY ──────────────────────────────────────────────────
 void drawSummary() {
   drawTopBar("TODAY'S SUMMARY");
-  tft.setTextDatum(ML_DATUM); tft.setTextSize(1);
+  canvas.setTextDatum(ML_DATUM); canvas.setTextSize(1);
   int y=30;
   auto row = [&](const char* label, const char* val, uint16_t col){
-    tft.setTextColor(C_MUTED); tft.drawString(label, 16, y);
-    tft.setTextColor(col);     tft.drawString(val, 180, y);
+    canvas.setTextColor(C_MUTED); canvas.drawString(label, 16, y);
+    canvas.setTextColor(col);     canvas.drawString(val, 180, y);
     y+=18;
   };
   char s[32];
   sprintf(s, "%d steps", data.steps);
   row("Steps today:", s, data.steps>=STEPS_GOAL ? C_GREEN : C_TEXT);
-  if (daily.hrSamples>0) {
-    sprintf(s, "%.0f bpm avg", daily.avgHR); row("Heart avg:", s, C_TEXT);
+  const StatAgg& hr = stats.session(STAT_HR);
+  if (hr.n) {
+    sprintf(s, "%.0f bpm avg (%d-%d)", hr.mean(), hr.lo, hr.hi); row("Heart avg:", s, C_TEXT);
   } else { row("Heart avg:", "no reading", C_MUTED); }
+  const StatAgg& ox = stats.session(STAT_SPO2);
   if (data.spO2Valid) {
-    sprintf(s, "%d%%", data.spO2);
+    if (ox.n) sprintf(s, "%d%% (low %d%%)", data.spO2, ox.lo); else sprintf(s, "%d%%", data.spO2);
     row("SpO2:", s, data.spO2>=95 ? C_GREEN : C_ORANGE);
   } else { row("SpO2:", "no reading", C_MUTED); }
   if (bmpOK) {
-    sprintf(s, "%.0fm / %d floors", data.altitudeM, data.floorsUp);
+    sprintf(s, "%.0fm / +%d -%d floors", data.altitudeM, data.floorsUp, data.floorsDown);
     row("Altitude:", s, C_ACCENT);
   }
   sprintf(s, "%d min", daily.activityMins); row("Active:", s, C_TEXT);
   sprintf(s, "%d detected", daily.fallCount);
   row("Falls:", s, daily.fallCount>0 ? C_ORANGE : C_GREEN);
-  tft.fillRect(0, y+4, W, 2, C_CARD);
-  tft.setTextDatum(MC_DATUM); tft.setTextColor(C_MUTED);
+  canvas.fillRect(0, y+4, W, 2, C_CARD);
+  canvas.setTextDatum(MC_DATUM); canvas.setTextColor(C_MUTED);
   if (data.steps>=STEPS_GOAL && daily.fallCount==0)
-    tft.drawString("Great day! Your doctor would be pleased.", W/2, y+16);
+    canvas.drawString("Great day! Your doctor would be pleased.", W/2, y+16);
   else if (data.steps<1000)
-    tft.drawString("Try to get some steps in today.", W/2, y+16);
+    canvas.drawString("Try to get some steps in today.", W/2, y+16);
   else
-    tft.drawString("Good effort. Rest well tonight.", W/2, y+16);
+    canvas.drawString("Good effort. Rest well tonight.", W/2, y+16);
   drawBottomHint("any button: back");
 }
 
 // ── DOCTOR'S REPORT ──────────────────────────────────────────
 void drawDoctor() {
   drawTopBar("DOCTOR'S REPORT");
-  tft.setTextDatum(ML_DATUM); tft.setTextSize(1);
-  tft.setTextColor(C_MUTED);
-  tft.drawString("Medical data — share with doctor", 10, 30);
+  canvas.setTextDatum(ML_DATUM); canvas.setTextSize(1);
+  canvas.setTextColor(C_MUTED);
+  canvas.drawString("Medical data — share with doctor", 10, 30);
   int y=46;
   auto drow = [&](const char* label, const char* val){
-    tft.setTextColor(C_DIM);    tft.drawString(label, 10,  y);
-    tft.setTextColor(C_ACCENT); tft.drawString(val,   170, y);
+    canvas.setTextColor(C_DIM);    canvas.drawString(label, 10,  y);
+    canvas.setTextColor(C_ACCENT); canvas.drawString(val,   170, y);
     y+=15;
   };
   char s[32];
-  if (data.heartRate>0) sprintf(s,"%.0f bpm",data.heartRate); else strcpy(s,"no reading");
+  StatAgg hrHour = stats.last(STAT_HR, 3600);
+  if (data.heartRate>0 && hrHour.n) sprintf(s,"%.0f bpm, %.0f last hr",data.heartRate,hrHour.mean());
+  else if (data.heartRate>0) sprintf(s,"%.0f bpm",data.heartRate);
+  else strcpy(s,"no reading");
   drow("Heart Rate:", s);
-  if (daily.hrSamples>0) sprintf(s,"%.0f bpm (n=%d)",daily.avgHR,daily.hrSamples);
+  const StatAgg& hr = stats.session(STAT_HR);
+  if (hr.n) sprintf(s,"%.0f +/-%.0f (%d-%d)",hr.mean(),sqrtf(hr.var()),hr.lo,hr.hi);
   else strcpy(s,"no data"); drow("HR Average:", s);
   if (data.spO2Valid) sprintf(s,"%d%%",data.spO2); else strcpy(s,"no reading");
   drow("SpO2:", s);
   sprintf(s,"%d steps",data.steps);   drow("Steps:", s);
   sprintf(s,"%.2fG",data.accelG);     drow("Accel:", s);
-  sprintf(s,"%.1f deg",data.tiltAngle); drow("Tilt:", s);
+  sprintf(s,"%.1f / %.1f deg",data.tiltAngle,data.rollAngle); drow("Pitch/Roll:", s);
   sprintf(s,"%d/100",data.balanceScore); drow("Balance:", s);
   sprintf(s,"%d today",daily.fallCount); drow("Falls:", s);
-  if (bmpOK) { sprintf(s,"%.0fm / %dF",data.altitudeM,data.floorsUp); drow("Alt/Floors:", s); }
+  if (bmpOK) { sprintf(s,"%.0fm / +%d-%dF",data.altitudeM,data.floorsUp,data.floorsDown); drow("Alt/Floors:", s); }
   sprintf(s,"%.1fC (chip)",data.tempC); drow("Temp:", s);
   sprintf(s,"%.0f%%",data.battery);   drow("Battery:", s);
   drawBottomHint("any button: back");
@@ -1813,11 +2911,11 @@ void drawDoctor() {
 // ── SETTINGS ─────────────────────────────────────────────────
 void drawSettings() {
   drawTopBar("SETTINGS");
-  tft.setTextDatum(ML_DATUM); tft.setTextSize(1);
+  canvas.setTextDatum(ML_DATUM); canvas.setTextSize(1);
   int y=38;
   auto srow = [&](const char* label, const char* val, uint16_t col){
-    tft.setTextColor(C_TEXT);  tft.drawString(label, 16, y);
-    tft.setTextColor(col);     tft.drawString(val, 130, y);
+    canvas.setTextColor(C_TEXT);  canvas.drawString(label, 16, y);
+    canvas.setTextColor(col);     canvas.drawString(val, 130, y);
     y+=20;
   };
   char s[32];
@@ -1833,63 +2931,63 @@ void drawSettings() {
   } else {
     sprintf(s,"Searching (%d sats)",gpsData.satellites); srow("GPS:", s, C_MUTED);
   }
-  tft.setTextColor(C_DIM); tft.setTextDatum(MC_DATUM);
-  tft.drawString("Full settings in companion app", W/2, H-20);
+  canvas.setTextColor(C_DIM); canvas.setTextDatum(MC_DATUM);
+  canvas.drawString("Full settings in companion app", W/2, H-20);
   drawBottomHint("any button: back");
 }
 
 // ── FALL CONFIRM ─────────────────────────────────────────────
 void drawFallConfirm() {
-  tft.fillScreen(0x8200);
-  tft.setTextDatum(MC_DATUM);
-  tft.setTextColor(C_TEXT); tft.setTextSize(2);
-  tft.drawString("Are you OK?", W/2, 35);
-  tft.setTextSize(1); tft.setTextColor(C_YELLOW);
-  tft.drawString("Press BTN2 if you're fine.", W/2, 60);
-  tft.setTextSize(5); tft.setTextColor(C_TEXT);
+  canvas.fillScreen(0x8200);
+  canvas.setTextDatum(MC_DATUM);
+  canvas.setTextColor(C_TEXT); canvas.setTextSize(2);
+  canvas.drawString("Are you OK?", W/2, 35);
+  canvas.setTextSize(1); canvas.setTextColor(C_YELLOW);
+  canvas.drawString("Press BTN2 if you're fine.", W/2, 60);
+  canvas.setTextSize(5); canvas.setTextColor(C_TEXT);
   char cs[4]; sprintf(cs,"%d",fallCountdown);
-  tft.drawString(cs, W/2, 100);
-  tft.setTextSize(1); tft.setTextColor(C_YELLOW);
-  tft.drawString("Alert sending if no response...", W/2, 140);
-  tft.drawString("BTN2 = I'm fine", W/2, 155);
+  canvas.drawString(cs, W/2, 100);
+  canvas.setTextSize(1); canvas.setTextColor(C_YELLOW);
+  canvas.drawString("Alert sending if no response...", W/2, 140);
+  canvas.drawString("BTN2 = I'm fine", W/2, 155);
 }
 
 // ── EMERGENCY / SOS ──────────────────────────────────────────
 void drawEmergency() {
   uint16_t bg = pulseOn ? C_RED : 0x9000;
-  tft.fillScreen(bg);
-  tft.setTextDatum(MC_DATUM); tft.setTextColor(C_TEXT);
+  canvas.fillScreen(bg);
+  canvas.setTextDatum(MC_DATUM); canvas.setTextColor(C_TEXT);
 
   if (state == STATE_SOS) {
-    tft.setTextSize(3); tft.drawString("SOS", W/2, 40);
-    tft.setTextSize(1); tft.setTextColor(C_YELLOW);
-    tft.drawString("Help is being notified.", W/2, 75);
-    tft.drawString("Stay calm. Help is coming.", W/2, 92);
+    canvas.setTextSize(3); canvas.drawString("SOS", W/2, 40);
+    canvas.setTextSize(1); canvas.setTextColor(C_YELLOW);
+    canvas.drawString("Help is being notified.", W/2, 75);
+    canvas.drawString("Stay calm. Help is coming.", W/2, 92);
   } else {
     if (data.heartRate > HR_WARN_HIGH) {
-      tft.setTextSize(2); tft.drawString("HEART RATE", W/2, 38);
-      tft.drawString("TOO HIGH", W/2, 62);
+      canvas.setTextSize(2); canvas.drawString("HEART RATE", W/2, 38);
+      canvas.drawString("TOO HIGH", W/2, 62);
       char s[16]; sprintf(s,"%.0f bpm",data.heartRate);
-      tft.setTextSize(1); tft.setTextColor(C_YELLOW);
-      tft.drawString(s, W/2, 85);
-      tft.drawString("Please sit down and rest.", W/2, 100);
+      canvas.setTextSize(1); canvas.setTextColor(C_YELLOW);
+      canvas.drawString(s, W/2, 85);
+      canvas.drawString("Please sit down and rest.", W/2, 100);
     } else if (data.heartRate>0 && data.heartRate<HR_WARN_LOW) {
-      tft.setTextSize(2); tft.drawString("HEART RATE", W/2, 38);
-      tft.drawString("VERY LOW", W/2, 62);
+      canvas.setTextSize(2); canvas.drawString("HEART RATE", W/2, 38);
+      canvas.drawString("VERY LOW", W/2, 62);
       char s[16]; sprintf(s,"%.0f bpm",data.heartRate);
-      tft.setTextSize(1); tft.setTextColor(C_YELLOW);
-      tft.drawString(s, W/2, 85);
-      tft.drawString("Please sit and rest.", W/2, 100);
+      canvas.setTextSize(1); canvas.setTextColor(C_YELLOW);
+      canvas.drawString(s, W/2, 85);
+      canvas.drawString("Please sit and rest.", W/2, 100);
     } else {
-      tft.setTextSize(3); tft.drawString("FALL", W/2, 40);
-      tft.setTextSize(2); tft.drawString("DETECTED", W/2, 72);
-      tft.setTextSize(1); tft.setTextColor(C_YELLOW);
-      tft.drawString("Family has been notified.", W/2, 100);
-      tft.drawString("Help is on the way.", W/2, 116);
+      canvas.setTextSize(3); canvas.drawString("FALL", W/2, 40);
+      canvas.setTextSize(2); canvas.drawString("DETECTED", W/2, 72);
+      canvas.setTextSize(1); canvas.setTextColor(C_YELLOW);
+      canvas.drawString("Family has been notified.", W/2, 100);
+      canvas.drawString("Help is on the way.", W/2, 116);
     }
   }
-  tft.setTextSize(1); tft.setTextColor(C_TEXT);
-  tft.drawString("BTN2: I'm OK — dismiss", W/2, H-12);
+  canvas.setTextSize(1); canvas.setTextColor(C_TEXT);
+  canvas.drawString("BTN2: I'm OK — dismiss", W/2, H-12);
 }
 
 // ── Battery read (every 30s) ─────────────────────────────────
@@ -1899,6 +2997,6 @@ void readBattery() {
     lastBat = millis();
     int r = analogRead(BAT_ADC_PIN);
     float v = (r / 4095.0f) * 3.3f * 2.0f;
-    data.battery = constrain((v - 3.2f) / (4.2f - 3.2f) * 100.0f, 0, 100);
+    acq.data.battery = constrain((v - 3.2f) / (4.2f - 3.2f) * 100.0f, 0, 100);
   }
 }
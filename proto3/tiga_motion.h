@@ -0,0 +1,154 @@
+// ============================================================
+// tiga_motion.h — fixed-point motion kernel for TIGA v6a
+// ============================================================
+// Integer versions of the per-sample accelerometer maths:
+//
+//   |a|²      three 16×16 multiplies, compared against squared
+//             thresholds — fall, stable, activity and spike tests
+//             need no square root at all
+//   |a|       exact floor square root in counts, for the stages
+//             that need a linear magnitude (step baseline, balance)
+//   tilt      atan2(ax, √(ay² + az²)) from an atan table, in
+//             hundredths of a degree
+//
+// Why: each sample cost a sqrtf, and the display tilt an atan2f
+// plus another sqrtf. The ESP32-S3 FPU has no square root or
+// divide instruction, so these run as library sequences, and
+// atan2f is entirely software. Here every step is integer adds,
+// multiplies and table reads; the only divide is one per tilt.
+//
+// Units: one count = 1 / MOTION_LSB_PER_G g (±4g range, as set in
+// mpuConfigure()). Thresholds are written in g and converted at
+// compile time: motionG2(3.0f) is 3g squared, in counts².
+//
+// Accuracy against the float code (host/bench_motion.cpp):
+//   |a|    floor, so 0 to -1 count (< 0.00013 g)
+//   tilt   within ±0.01°
+//   |a|² threshold tests agree except where |a| is within one
+//          count of the threshold itself
+// Step, fall, activity and balance outcomes on the bench data
+// match the float stages exactly.
+// ============================================================
+
+#pragma once
+
+#include <stdint.h>
+#include "tiga_imu_fifo.h"
+
+#define MOTION_LSB_PER_G  8192      // MPU6050 accel at ±4g
+
+// g → counts, and g → counts² for squared comparisons
+#define MOTION_G(g)       ((int32_t)((g) * MOTION_LSB_PER_G + 0.5f))
+constexpr uint32_t motionG2(float g) {
+  return (uint32_t)((double)g * MOTION_LSB_PER_G * (double)g * MOTION_LSB_PER_G + 0.5);
+}
+
+// ── Square magnitude ─────────────────────────────────────────
+// Max 3 × 32768² = 3.2e9 — fits uint32_t.
+inline uint32_t motionMag2(int16_t x, int16_t y, int16_t z) {
+  return (uint32_t)((int32_t)x * x) + (uint32_t)((int32_t)y * y) + (uint32_t)((int32_t)z * z);
+}
+
+// ── Integer square root ──────────────────────────────────────
+// floor(√v) for v up to 3 × 32768² (any motionMag2 result).
+// Shift v up an even number of bits into [2^30, 2^32), read √ off
+// a 193-entry table with linear interpolation, shift back. Table
+// and interpolation both round down, so the estimate is at most
+// one count low: a single compare fixes it. No loop, no divide.
+static const uint32_t motionSqrtTab[193] = {  // floor(√(1 + k/64) × 2^23)
+  8388608, 8453889, 8518671, 8582964, 8646779, 8710126, 8773016, 8835458,
+  8897462, 8959037, 9020191, 9080934, 9141273, 9201217, 9260772, 9319947,
+  9378748, 9437184, 9495259, 9552982, 9610357, 9667393, 9724093, 9780465,
+  9836514, 9892246, 9947665, 10002777, 10057587, 10112100, 10166321, 10220254,
+  10273904, 10327275, 10380372, 10433199, 10485760, 10538058, 10590098, 10641884,
+  10693418, 10744706, 10795750, 10846554, 10897121, 10947454, 10997557, 11047433,
+  11097085, 11146515, 11195728, 11244724, 11293509, 11342083, 11390450, 11438613,
+  11486574, 11534336, 11581900, 11629270, 11676448, 11723436, 11770236, 11816851,
+  11863283, 11909533, 11955605, 12001500, 12047221, 12092768, 12138144, 12183352,
+  12228392, 12273267, 12317978, 12362528, 12406918, 12451150, 12495225, 12539145,
+  12582912, 12626527, 12669992, 12713308, 12756477, 12799501, 12842380, 12885117,
+  12927713, 12970168, 13012485, 13054665, 13096710, 13138619, 13180395, 13222040,
+  13263553, 13304937, 13346193, 13387322, 13428324, 13469202, 13509956, 13550588,
+  13591098, 13631488, 13671758, 13711910, 13751945, 13791863, 13831667, 13871356,
+  13910932, 13950396, 13989748, 14028990, 14068123, 14107147, 14146063, 14184873,
+  14223576, 14262175, 14300670, 14339061, 14377349, 14415536, 14453622, 14491608,
+  14529495, 14567283, 14604973, 14642566, 14680064, 14717465, 14754772, 14791984,
+  14829104, 14866130, 14903065, 14939908, 14976660, 15013323, 15049896, 15086381,
+  15122778, 15159087, 15195309, 15231446, 15267497, 15303462, 15339344, 15375142,
+  15410856, 15446489, 15482039, 15517507, 15552895, 15588202, 15623430, 15658578,
+  15693648, 15728640, 15763553, 15798390, 15833150, 15867834, 15902442, 15936975,
+  15971433, 16005817, 16040128, 16074365, 16108530, 16142622, 16176642, 16210591,
+  16244469, 16278277, 16312014, 16345682, 16379280, 16412810, 16446271, 16479665,
+  16512991, 16546250, 16579442, 16612568, 16645627, 16678622, 16711551, 16744415,
+  16777216,
+};
+
+inline uint16_t motionIsqrt(uint32_t v) {
+  if (v == 0) return 0;
+  uint8_t  s = __builtin_clz(v) & ~1;
+  uint32_t n = v << s;
+  uint32_t i = (n >> 24) - 64;              // 64 steps per unit of n / 2^30
+  uint32_t f = (n >> 12) & 0xFFF;
+  uint32_t r = motionSqrtTab[i] + (((motionSqrtTab[i + 1] - motionSqrtTab[i]) * f) >> 12);
+  r >>= (s >> 1) + 8;
+  r += ((r + 1) * (r + 1) <= v);
+  return (uint16_t)r;
+}
+
+// ── atan2 by table ───────────────────────────────────────────
+// Fold into the first octant, one divide for the ratio, then a
+// 129-entry atan table with linear interpolation.
+static const uint16_t motionAtanTab[129] = {  // atan(k/128), millidegrees
+  0, 448, 895, 1343, 1790, 2237, 2684, 3130, 3576, 4022,
+  4467, 4912, 5356, 5799, 6242, 6684, 7125, 7565, 8005, 8443,
+  8881, 9317, 9752, 10187, 10620, 11051, 11482, 11911, 12339, 12766,
+  13191, 13614, 14036, 14457, 14876, 15293, 15709, 16123, 16535, 16945,
+  17354, 17761, 18166, 18569, 18970, 19370, 19767, 20163, 20556, 20947,
+  21337, 21724, 22109, 22493, 22874, 23253, 23629, 24004, 24376, 24747,
+  25115, 25481, 25844, 26206, 26565, 26922, 27277, 27629, 27979, 28327,
+  28673, 29017, 29358, 29697, 30033, 30368, 30700, 31030, 31357, 31682,
+  32005, 32326, 32645, 32961, 33275, 33587, 33896, 34203, 34509, 34811,
+  35112, 35410, 35707, 36001, 36293, 36582, 36870, 37155, 37439, 37720,
+  37999, 38276, 38550, 38823, 39094, 39362, 39629, 39894, 40156, 40416,
+  40675, 40931, 41186, 41438, 41689, 41938, 42184, 42429, 42672, 42913,
+  43152, 43390, 43625, 43859, 44091, 44321, 44549, 44775, 45000,
+};
+
+// atan2(y, x) in hundredths of a degree, for x >= 0 and
+// |y|, x < 2^16 (-9000..9000)
+inline int32_t motionAtan2Cdeg(int32_t y, int32_t x) {
+  uint32_t ay = y < 0 ? -y : y, ax = x;
+  if (ax == 0 && ay == 0) return 0;
+  bool     steep = ay > ax;
+  uint32_t num = steep ? ax : ay, den = steep ? ay : ax;
+  uint32_t r = (num << 16) / den;           // tan, Q16, 0..1
+  uint32_t i = r >> 9, f = r & 511;
+  if (i == 128) { i = 127; f = 512; }
+  int32_t m = motionAtanTab[i] + (((int32_t)(motionAtanTab[i + 1] - motionAtanTab[i]) * (int32_t)f) >> 9);
+  if (steep) m = 90000 - m;
+  if (y < 0) m = -m;
+  return m >= 0 ? (m + 5) / 10 : (m - 5) / 10;
+}
+
+// Pitch of the watch face: atan2(ax, √(ay² + az²)). Both sides are
+// scaled up together first so a near-zero vector keeps its angle.
+inline int32_t motionTiltCdeg(int16_t ax, int16_t ay, int16_t az) {
+  uint32_t yz2 = (uint32_t)((int32_t)ay * ay) + (uint32_t)((int32_t)az * az);
+  uint32_t x2  = (uint32_t)((int32_t)ax * ax);
+  uint32_t m   = yz2 > x2 ? yz2 : x2;
+  if (m == 0) return 0;
+  uint8_t z = __builtin_clz(m);
+  uint8_t s = z ? (z - 1) & ~1 : 0;         // m << s in [2^29, 2^31]
+  return motionAtan2Cdeg((int32_t)ax * (1 << (s >> 1)), motionIsqrt(yz2 << s));
+}
+
+// ── Burst kernel ─────────────────────────────────────────────
+// Fills g2 and g for every sample of a burst in one tight pass,
+// ahead of the branchy per-sample checks.
+inline void motionBatch(ImuSample* s, uint8_t n) {
+  for (uint8_t i = 0; i < n; i++) {
+    uint32_t m = motionMag2(s[i].ax, s[i].ay, s[i].az);
+    s[i].g2 = m;
+    s[i].g  = motionIsqrt(m);
+  }
+}
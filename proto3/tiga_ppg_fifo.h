@@ -0,0 +1,321 @@
+// ============================================================
+// tiga_ppg_fifo.h — MAX30102 FIFO acquisition for TIGA v6a
+// ============================================================
+// Drains the MAX30102's 32-deep sample FIFO in burst I2C reads
+// and hands fixed-size blocks to the HR / SpO2 stages.
+//
+// Why: polling getIR()/getRed() once per loop() pass only sees
+// one sample per pass. With delay(20) plus blocking draws the
+// FIFO silently overflows and checkForBeat() gets a decimated,
+// jittery signal. Draining the FIFO keeps every sample and tells
+// us exactly how many were lost when the loop stalls.
+//
+// Usage:
+//   Max30102FifoSource ppgSrc(i2c, I2C_DEV_MAX);   // via tiga_i2c.h
+//   PpgAcquisition     ppgAcq(ppgSrc);
+//   ppgAcq.poll();                        // as often as possible
+//   while (const PpgBlock* b = ppgAcq.front()) { ...; ppgAcq.pop(); }
+//
+// Timing: every sample carries an absolute index (firstSample + i).
+// Lost samples advance the index, so index / sample rate is always
+// the true sample time even across overflows.
+//
+// Host builds: PpgReplaySource plays a CSV trace ("red,ir" per
+// line) into a modelled 32-deep FIFO against any clock, so block
+// throughput and lost-sample counts can be checked on Linux.
+// Host bench: host/bench_ppg_fifo.cpp
+// ============================================================
+
+#pragma once
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// ── Sizes ────────────────────────────────────────────────────
+#define PPG_FIFO_DEPTH        32
+#define PPG_BYTES_PER_SAMPLE   6    // 3 bytes red + 3 bytes IR
+#define PPG_BURST_SAMPLES     16    // 96 bytes — under ESP32 Wire's 128 B buffer
+#define PPG_BLOCK_SAMPLES     25    // 250 ms at 100 Hz
+#define PPG_BLOCK_QUEUE        4    // blocks buffered for the consumer
+
+// ── MAX30102 registers ───────────────────────────────────────
+#define MAX30102_ADDR         0x57
+#define MAX30102_FIFO_WR_PTR  0x04
+#define MAX30102_OVF_COUNTER  0x05
+#define MAX30102_FIFO_RD_PTR  0x06
+#define MAX30102_FIFO_DATA    0x07
+
+struct PpgSample {
+  uint32_t red;
+  uint32_t ir;
+};
+
+struct PpgBlock {
+  uint32_t  seq;            // block sequence number, +1 per block
+  uint32_t  firstSample;    // absolute sample index of s[0]
+  uint16_t  lost;           // samples dropped by FIFO overflow just before s[0]
+  uint16_t  count;          // valid samples (< PPG_BLOCK_SAMPLES only after a gap)
+  PpgSample s[PPG_BLOCK_SAMPLES];
+};
+
+// ── Sample source ────────────────────────────────────────────
+// pending() returns unread samples in the FIFO and reports how
+// many were overwritten since the previous call.
+// read() burst-reads n <= PPG_BURST_SAMPLES samples.
+class PpgSource {
+public:
+  virtual ~PpgSource() {}
+  virtual uint8_t pending(uint8_t* overflow) = 0;
+  virtual bool    read(PpgSample* out, uint8_t n) = 0;
+};
+
+// ── Acquisition engine ───────────────────────────────────────
+class PpgAcquisition {
+public:
+  explicit PpgAcquisition(PpgSource& src) : src_(src) { reset(); }
+
+  // Clear counters and queued blocks. Call after max30102.setup(),
+  // which also clears the sensor FIFO.
+  void reset() {
+    memset(queue_, 0, sizeof(queue_));
+    qHead_ = qCount_ = 0;
+    cur_ = &queue_[0];
+    curOpen_ = false;
+    nextSample_ = 0;
+    nextSeq_ = 0;
+    pendingLost_ = 0;
+    samplesIn = samplesLost = 0;
+    blocksOut = blocksDropped = 0;
+    burstReads = readErrors = 0;
+    maxFifoFill = 0;
+  }
+
+  // Drain everything currently in the FIFO. Returns samples read.
+  uint16_t poll() {
+    uint8_t ovf = 0;
+    uint8_t avail = src_.pending(&ovf);
+    if (avail > maxFifoFill) maxFifoFill = avail;
+    if (ovf) noteLost(ovf);
+
+    uint16_t got = 0;
+    PpgSample burst[PPG_BURST_SAMPLES];
+    while (avail > 0) {
+      uint8_t n = avail > PPG_BURST_SAMPLES ? PPG_BURST_SAMPLES : avail;
+      if (!src_.read(burst, n)) { readErrors++; break; }
+      burstReads++;
+      for (uint8_t i = 0; i < n; i++) push(burst[i]);
+      avail -= n;
+      got   += n;
+    }
+    return got;
+  }
+
+  // Oldest complete block, or nullptr. Valid until pop() or poll().
+  const PpgBlock* front() const {
+    return qCount_ ? &queue_[qHead_] : nullptr;
+  }
+
+  void pop() {
+    if (!qCount_) return;
+    qHead_ = (qHead_ + 1) % (PPG_BLOCK_QUEUE + 1);
+    qCount_--;
+  }
+
+  uint32_t sampleIndex() const { return nextSample_; }
+
+  // Counters
+  uint32_t samplesIn;       // samples read from the FIFO
+  uint32_t samplesLost;     // samples overwritten before we read them
+  uint32_t blocksOut;       // blocks completed
+  uint32_t blocksDropped;   // blocks discarded because the consumer fell behind
+  uint32_t burstReads;
+  uint32_t readErrors;
+  uint8_t  maxFifoFill;     // worst FIFO occupancy seen (32 = overflowing)
+
+private:
+  // One spare slot: the block being filled lives in the ring too,
+  // so completed blocks are handed out without a copy.
+  PpgBlock  queue_[PPG_BLOCK_QUEUE + 1];
+  uint8_t   qHead_, qCount_;
+  PpgBlock* cur_;
+  bool      curOpen_;
+  uint32_t  nextSample_;
+  uint32_t  nextSeq_;
+  uint16_t  pendingLost_;
+  PpgSource& src_;
+
+  void noteLost(uint8_t n) {
+    samplesLost += n;
+    // Close the partial block so each block stays contiguous in time
+    if (curOpen_ && cur_->count) closeBlock();
+    nextSample_  += n;
+    pendingLost_ += n;
+  }
+
+  void openBlock() {
+    uint8_t slot = (qHead_ + qCount_) % (PPG_BLOCK_QUEUE + 1);
+    cur_ = &queue_[slot];
+    cur_->seq         = nextSeq_++;
+    cur_->firstSample = nextSample_;
+    cur_->lost        = pendingLost_;
+    cur_->count       = 0;
+    pendingLost_ = 0;
+    curOpen_ = true;
+  }
+
+  void closeBlock() {
+    curOpen_ = false;
+    blocksOut++;
+    if (qCount_ == PPG_BLOCK_QUEUE) {
+      // Consumer is behind — drop the oldest, keep the fresh data
+      qHead_ = (qHead_ + 1) % (PPG_BLOCK_QUEUE + 1);
+      blocksDropped++;
+    } else {
+      qCount_++;
+    }
+  }
+
+  void push(const PpgSample& s) {
+    if (!curOpen_) openBlock();
+    cur_->s[cur_->count++] = s;
+    nextSample_++;
+    samplesIn++;
+    if (cur_->count == PPG_BLOCK_SAMPLES) closeBlock();
+  }
+};
+
+// ── Device source: MAX30102 through the bus engine ───────────
+#ifdef ARDUINO
+#include "tiga_i2c.h"
+
+class Max30102FifoSource : public PpgSource {
+public:
+  Max30102FifoSource(I2cEngine& bus, int busId) : bus_(bus), id_(busId) {}
+
+  // The three pointer registers are adjacent: one 3-byte burst.
+  // A failed transfer reads as an empty FIFO; the engine counts it.
+  uint8_t pending(uint8_t* overflow) override {
+    uint8_t r[3];
+    *overflow = 0;
+    if (!bus_.readRegs(id_, MAX30102_FIFO_WR_PTR, r, 3)) return 0;
+    uint8_t wr = r[0], ovf = r[1], rd = r[2];
+    *overflow = ovf;
+    // With rollover on, a full FIFO has wr == rd — the overflow
+    // counter is the only way to tell it apart from empty.
+    if (ovf) return PPG_FIFO_DEPTH;
+    return (uint8_t)((wr - rd) & (PPG_FIFO_DEPTH - 1));
+  }
+
+  bool read(PpgSample* out, uint8_t n) override {
+    uint8_t buf[PPG_BURST_SAMPLES * PPG_BYTES_PER_SAMPLE];
+    if (!bus_.readRegs(id_, MAX30102_FIFO_DATA, buf, n * PPG_BYTES_PER_SAMPLE)) return false;
+    for (uint8_t i = 0; i < n; i++) {
+      out[i].red = read18(&buf[i * PPG_BYTES_PER_SAMPLE]);
+      out[i].ir  = read18(&buf[i * PPG_BYTES_PER_SAMPLE + 3]);
+    }
+    return true;
+  }
+
+private:
+  I2cEngine& bus_;
+  int        id_;
+
+  static uint32_t read18(const uint8_t* b) {
+    return ((uint32_t)b[0] << 16 | (uint32_t)b[1] << 8 | b[2]) & 0x3FFFF;
+  }
+};
+#endif
+
+// ── Replay source: CSV trace into a modelled FIFO ────────────
+// The sensor produces one sample every 1e6/rateHz µs of the
+// supplied clock; anything beyond 32 unread samples is counted
+// as overflow, exactly like the real part with rollover enabled.
+// At the end of the trace it loops, so long runs stay fed.
+class PpgReplaySource : public PpgSource {
+public:
+  PpgReplaySource(uint32_t (*clockUs)(), uint16_t rateHz = 100)
+    : clockUs_(clockUs), periodUs_(1000000UL / rateHz) {}
+
+  ~PpgReplaySource() { if (owned_) free(trace_); }
+
+  // Use caller-owned samples
+  void setTrace(const PpgSample* s, uint32_t n) {
+    if (owned_) free(trace_);
+    trace_ = (PpgSample*)s; len_ = n; owned_ = false;
+    restart();
+  }
+
+  // Load "red,ir" lines; '#' lines are comments. Returns samples loaded.
+  uint32_t loadCsv(const char* path) {
+    FILE* f = fopen(path, "r");
+    if (!f) return 0;
+    uint32_t cap = 1024, n = 0;
+    PpgSample* buf = (PpgSample*)malloc(cap * sizeof(PpgSample));
+    char line[64];
+    while (buf && fgets(line, sizeof(line), f)) {
+      unsigned long red, ir;
+      if (line[0] == '#' || sscanf(line, "%lu,%lu", &red, &ir) != 2) continue;
+      if (n == cap) {
+        cap *= 2;
+        PpgSample* grown = (PpgSample*)realloc(buf, cap * sizeof(PpgSample));
+        if (!grown) break;
+        buf = grown;
+      }
+      buf[n].red = (uint32_t)red;
+      buf[n].ir  = (uint32_t)ir;
+      n++;
+    }
+    fclose(f);
+    if (owned_) free(trace_);
+    trace_ = buf; len_ = n; owned_ = true;
+    restart();
+    return n;
+  }
+
+  // Also forgets earlier losses, so the next pending() reports
+  // only the new trace's
+  void restart() {
+    produced_ = consumed_ = lost_ = reportedLost_ = 0;
+    startUs_ = clockUs_();
+  }
+
+  uint8_t pending(uint8_t* overflow) override {
+    update();
+    uint32_t lost = lost_ - reportedLost_;
+    reportedLost_ = lost_;
+    *overflow = lost > 31 ? 31 : (uint8_t)lost;   // OVF_COUNTER saturates
+    return (uint8_t)(produced_ - consumed_);
+  }
+
+  bool read(PpgSample* out, uint8_t n) override {
+    if (!len_ || produced_ - consumed_ < n) return false;
+    for (uint8_t i = 0; i < n; i++)
+      out[i] = trace_[(consumed_++) % len_];
+    return true;
+  }
+
+  uint32_t totalProduced() const { return produced_; }
+
+private:
+  uint32_t (*clockUs_)();
+  uint32_t   periodUs_;
+  PpgSample* trace_ = nullptr;
+  uint32_t   len_   = 0;
+  bool       owned_ = false;
+  uint32_t   startUs_ = 0;
+  uint32_t   produced_ = 0, consumed_ = 0;
+  uint32_t   lost_ = 0, reportedLost_ = 0;
+
+  void update() {
+    uint32_t due = (clockUs_() - startUs_) / periodUs_;
+    produced_ = due;
+    // Oldest samples are overwritten once the FIFO holds 32
+    if (produced_ - consumed_ > PPG_FIFO_DEPTH) {
+      uint32_t drop = produced_ - consumed_ - PPG_FIFO_DEPTH;
+      consumed_ += drop;
+      lost_     += drop;
+    }
+  }
+};
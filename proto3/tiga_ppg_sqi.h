@@ -0,0 +1,370 @@
+// ============================================================
+// tiga_ppg_sqi.h — PPG signal quality for TIGA v6a
+// ============================================================
+// Scores each 250 ms PPG block 0-100 before beat detection,
+// SpO2 and HRV see it. v6a took any IR above the finger
+// threshold as a pulse: an arm swinging at step cadence puts a
+// periodic artefact into the IR as big as the pulse itself, the
+// beat detector locks onto it, HR reads the cadence and three
+// readings over 110 bpm are an emergency. Here three things are
+// measured, each scored 0-100, and the block gets the lowest:
+//
+//   motion    RMS of |a| - 1g from the accelerometer in the
+//             worst of the last PPG_SQI_SLOTS blocks (fed by the
+//             IMU stage, same core), so movement counts from its
+//             first block and for 2 s after. Full marks under
+//             PPG_SQI_STILL_MG, none over PPG_SQI_MOVING_MG
+//   perfusion AC / DC of the IR over the same blocks, the
+//             perfusion index. Under PPG_SQI_PI_MIN the pulse is
+//             lost in the noise (loose strap, cold hands); over
+//             PPG_SQI_PI_MAX something other than blood moved
+//             the light. Scored down over a factor of two
+//             outside the range
+//   template  each beat's shape against a running template of
+//             clean beats, Pearson r, mean over the blocks. A
+//             pulse keeps its shape when its timing doesn't
+//             (ectopics, AF), an artefact doesn't have one
+//
+// The template: the IR is averaged 4:1 to 25 Hz, high-passed
+// and turned over so blood arriving is a rising edge. A beat is
+// marked where the rise over 80 ms crosses half the recent
+// beats' rise; PPG_SQI_PRE + PPG_SQI_POST samples around the
+// mark are its shape. r is taken at shifts of -1, 0 and +1
+// samples and the best kept, as the mark sits on a 40 ms grid.
+// The template is the mean of the first PPG_SQI_SEED beats,
+// then follows beats with r ≥ PPG_SQI_KEEP_R by 1/8 — only while
+// the arm is still, so movement never becomes the template.
+// PPG_SQI_RELOCK beats in a row at or under PPG_SQI_R_LO while
+// still drop it, so a strap moved to a new spot is learnt
+// again. Until there is a
+// template the score is PPG_SQI_UNKNOWN, and with no beat in
+// the blocks it is 0.
+//
+// The bands the sketch acts on:
+//   < PPG_SQI_USABLE   skip beats, HRV and SpO2 for the block;
+//                      after PPG_SQI_HOLD_BLOCKS of those the
+//                      readings go blank. Beats count again from
+//                      the PPG_SQI_SETTLE-th usable block, once
+//                      the beat detector's filters have settled
+//   < PPG_SQI_GOOD     use it, but a beat more than
+//                      PPG_SQI_FAIR_JUMP off the average is
+//                      dropped, SpO2 moves slowly, and the HR
+//                      doesn't count towards an alarm
+//
+// push() is a few adds per sample and one more per 4 samples;
+// the correlation (3 × 16 multiplies) once per beat; judge()
+// merges PPG_SQI_SLOTS slots once per block. motion() is one
+// multiply per IMU sample.
+//
+// Memory: ~430 B. No heap. False alarms and CPU saved on
+// walking traces: host/bench_ppg_sqi.cpp.
+// ============================================================
+
+#pragma once
+
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+#include "tiga_motion.h"
+
+// ── Config ───────────────────────────────────────────────────
+#define PPG_SQI_DECIM        4         // 100 Hz → 25 Hz for the template
+#define PPG_SQI_HP_SHIFT     4         // high-pass, τ = 16 samples (0.64 s)
+#define PPG_SQI_PRE          2         // beat shape: 80 ms before the mark
+#define PPG_SQI_POST         8         //   and 320 ms after
+#define PPG_SQI_RING         32        // 25 Hz samples kept, power of two
+#define PPG_SQI_REFRACT      8         // 320 ms between marks (187 bpm)
+#define PPG_SQI_LOST         75        // 3 s without a mark halves the level
+#define PPG_SQI_SLOTS        8         // blocks in the window (2 s)
+#define PPG_SQI_SEED         4         // beats averaged into a new template
+#define PPG_SQI_KEEP_R       0.60f     // still beats this close update the template
+#define PPG_SQI_RELOCK       12        // misfits in a row (still) drop it
+#define PPG_SQI_R_LO         0.50f     // template score 0 at or below
+#define PPG_SQI_R_HI         0.85f     //   100 at or above
+#define PPG_SQI_STILL_MG     60        // motion score 100 at or below
+#define PPG_SQI_MOVING_MG    200       //   0 at or above
+#define PPG_SQI_PI_MIN       5         // perfusion index, 0.01 % (0.05 %)
+#define PPG_SQI_PI_MAX       300       // 3 %
+#define PPG_SQI_UNKNOWN      50        // template score before there is one
+#define PPG_SQI_USABLE       30        // below: block skipped
+#define PPG_SQI_GOOD         70        // below: readings held back
+#define PPG_SQI_SETTLE       4         // usable blocks after a skip before beats count
+#define PPG_SQI_FAIR_JUMP    0.15f     // fair beats this far off the average are dropped
+#define PPG_SQI_HOLD_BLOCKS  40        // skipped blocks (10 s) before HR / SpO2 go blank
+
+#define PPG_SQI_SHAPE (PPG_SQI_PRE + PPG_SQI_POST)
+
+// What held a block's score down, for the counters
+enum PpgSqiLimit : uint8_t { SQI_BY_NONE, SQI_BY_MOTION, SQI_BY_PERFUSION, SQI_BY_TEMPLATE };
+
+class PpgQuality {
+public:
+  // Last judged block
+  uint8_t  sqi       = 0;
+  uint8_t  motionMg  = 0;       // RMS |a| - 1g, worst block, mg (255 = over)
+  uint16_t piCenti   = 0;       // perfusion index, 0.01 %
+  int8_t   rPct      = -1;      // mean template r × 100; -1 = no beat / no template
+  uint8_t  limit     = SQI_BY_NONE;
+
+  // Counters since reset
+  uint32_t blocks    = 0;
+  uint32_t skipped   = 0;       // under PPG_SQI_USABLE
+  uint32_t fair      = 0;       // usable, under PPG_SQI_GOOD
+  uint32_t byMotion  = 0;       // skipped, and motion scored lowest
+  uint32_t beats     = 0;       // shapes compared with the template
+  uint32_t relocks   = 0;
+
+  PpgQuality() { clear(); }
+
+  // Finger off, or a gap in the samples
+  void reset() {
+    memset(ring_, 0, sizeof(ring_));
+    memset(slot_, 0, sizeof(slot_));
+    open();
+    slotPos_ = 0;
+    decSum_ = 0; decN_ = 0;
+    base16_ = 0; primed_ = false;
+    pos_ = 0; filled_ = 0;
+    peak_ = 0; level_ = 0; armed_ = true; sinceMark_ = PPG_SQI_REFRACT;
+    pending_[0] = pending_[1] = -1;
+    still_ = true;
+  }
+
+  // Forget the template too (new session)
+  void clear() {
+    reset();
+    seeded_ = 0; misfits_ = 0;
+    memset(tmpl16_, 0, sizeof(tmpl16_));
+  }
+
+  // One accelerometer sample, |a| in MOTION_LSB_PER_G counts
+  void motion(int32_t g) {
+    int32_t d = g - MOTION_LSB_PER_G;
+    motSq_ += (uint64_t)((int64_t)d * d);
+    motN_++;
+  }
+
+  // One PPG sample, raw IR counts
+  void push(int32_t ir) {
+    decSum_ += ir;
+    if (++decN_ < PPG_SQI_DECIM) return;
+    int32_t y = decSum_ / PPG_SQI_DECIM;
+    decSum_ = 0; decN_ = 0;
+    decimated(y);
+  }
+
+  // Score the samples and motion since the last call; the block
+  // is usable when the result is ≥ PPG_SQI_USABLE
+  uint8_t judge() {
+    if (motN_) {
+      uint64_t m = motSq_ / motN_;
+      cur_.motMs = m > UINT32_MAX ? UINT32_MAX : (uint32_t)m;
+      cur_.moved = true;
+    }
+    slot_[slotPos_] = cur_;
+    slotPos_ = (slotPos_ + 1) % PPG_SQI_SLOTS;
+    open();
+
+    // The window: worst motion, widest swing, all the beats
+    uint32_t motMax = 0;
+    bool     moved = false;
+    int32_t  lo = INT32_MAX, hi = INT32_MIN;
+    float    rSum = 0;
+    uint16_t rN = 0;
+    for (uint8_t i = 0; i < PPG_SQI_SLOTS; i++) {
+      const Slot& s = slot_[i];
+      if (s.moved) { moved = true; if (s.motMs > motMax) motMax = s.motMs; }
+      if (s.lo < lo) lo = s.lo;
+      if (s.hi > hi) hi = s.hi;
+      rSum += s.rSum; rN += s.rN;
+    }
+
+    // Motion — no IMU samples (MPU down) scores as still
+    uint8_t mScore = 100;
+    if (moved) {
+      uint32_t rms = motionIsqrt(motMax);
+      uint32_t mg = rms * 1000 / MOTION_LSB_PER_G;
+      motionMg = mg > 255 ? 255 : (uint8_t)mg;
+      mScore = ramp(PPG_SQI_MOVING_MG - (int32_t)mg, PPG_SQI_MOVING_MG - PPG_SQI_STILL_MG);
+    } else {
+      motionMg = 0;
+    }
+    still_ = mScore == 100;
+
+    // Perfusion index
+    uint8_t pScore = 0;
+    int32_t dc = base16_ >> 4;
+    if (dc > 0 && hi >= lo) {
+      uint32_t pi = (uint32_t)((int64_t)(hi - lo) * 10000 / dc);
+      piCenti = pi > 65535 ? 65535 : (uint16_t)pi;
+      if (pi < PPG_SQI_PI_MIN)      pScore = ramp((int32_t)pi - PPG_SQI_PI_MIN / 2, PPG_SQI_PI_MIN / 2);
+      else if (pi > PPG_SQI_PI_MAX) pScore = ramp(2 * PPG_SQI_PI_MAX - (int32_t)pi, PPG_SQI_PI_MAX);
+      else                          pScore = 100;
+    } else {
+      piCenti = 0;
+    }
+
+    // Template
+    uint8_t tScore;
+    if (seeded_ < PPG_SQI_SEED) { tScore = PPG_SQI_UNKNOWN; rPct = -1; }
+    else if (!rN)               { tScore = 0; rPct = -1; }
+    else {
+      float r = rSum / rN;
+      rPct = (int8_t)lroundf(r < 0 ? 0 : r * 100);
+      tScore = (uint8_t)lroundf(100 * clampf((r - PPG_SQI_R_LO) / (PPG_SQI_R_HI - PPG_SQI_R_LO)));
+    }
+
+    sqi = mScore; limit = SQI_BY_MOTION;
+    if (pScore < sqi) { sqi = pScore; limit = SQI_BY_PERFUSION; }
+    if (tScore < sqi) { sqi = tScore; limit = SQI_BY_TEMPLATE; }
+    if (sqi == 100) limit = SQI_BY_NONE;
+
+    blocks++;
+    if (sqi < PPG_SQI_USABLE) { skipped++; if (limit == SQI_BY_MOTION) byMotion++; }
+    else if (sqi < PPG_SQI_GOOD) fair++;
+    return sqi;
+  }
+
+  bool usable() const  { return sqi >= PPG_SQI_USABLE; }
+  bool good() const    { return sqi >= PPG_SQI_GOOD; }
+  bool hasTemplate() const { return seeded_ >= PPG_SQI_SEED; }
+
+private:
+  // One block, summed up as it closes
+  struct Slot {
+    uint32_t motMs;          // mean square of |a| - 1g
+    int32_t  lo, hi;         // high-passed 25 Hz samples
+    float    rSum;           // template r of the beats that ended in it
+    uint8_t  rN;
+    bool     moved;          // had IMU samples
+  };
+
+  Slot     slot_[PPG_SQI_SLOTS];
+  Slot     cur_;
+  uint8_t  slotPos_;
+  uint64_t motSq_;
+  uint32_t motN_;
+
+  int32_t  decSum_;
+  uint8_t  decN_;
+  int32_t  base16_;          // DC ×16
+  bool     primed_;
+
+  int32_t  ring_[PPG_SQI_RING];   // high-passed, inverted
+  uint8_t  pos_;             // next write
+  uint8_t  filled_;
+  int32_t  peak_;            // steepest rise since the mark
+  int32_t  level_;           // recent beats' rise
+  bool     armed_;
+  uint8_t  sinceMark_;
+  int8_t   pending_[2];      // samples since each mark still waiting for its shape
+
+  int32_t  tmpl16_[PPG_SQI_SHAPE];   // template ×16
+  uint8_t  seeded_ = 0;
+  uint8_t  misfits_ = 0;
+  bool     still_;
+
+  void open() {
+    cur_ = {};
+    cur_.lo = INT32_MAX; cur_.hi = INT32_MIN;
+    motSq_ = 0; motN_ = 0;
+  }
+
+  static float clampf(float x) { return x < 0 ? 0 : x > 1 ? 1 : x; }
+
+  // 0 at x ≤ 0, 100 at x ≥ span
+  static uint8_t ramp(int32_t x, int32_t span) {
+    if (x <= 0) return 0;
+    if (x >= span) return 100;
+    return (uint8_t)(x * 100 / span);
+  }
+
+  int32_t at(uint8_t back) const { return ring_[(pos_ - 1 - back) & (PPG_SQI_RING - 1)]; }
+
+  void decimated(int32_t y) {
+    if (!primed_) { base16_ = y << 4; primed_ = true; }
+    base16_ += ((y << 4) - base16_) >> PPG_SQI_HP_SHIFT;
+    int32_t p = (base16_ >> 4) - y;         // IR falls as blood arrives
+    ring_[pos_] = p;
+    pos_ = (pos_ + 1) & (PPG_SQI_RING - 1);
+    if (filled_ < PPG_SQI_RING) filled_++;
+    if (p < cur_.lo) cur_.lo = p;
+    if (p > cur_.hi) cur_.hi = p;
+    if (filled_ < 3) return;
+
+    // Mark: the 80 ms rise crossing half the beats' level. The
+    // level follows each beat's steepest rise by 1/4, at most
+    // doubling at a time, and halves after PPG_SQI_LOST with no
+    // mark so a weaker pulse is found again.
+    int32_t rise = p - at(2);
+    if (sinceMark_ < 255) sinceMark_++;
+    if (armed_) {
+      if (rise > (level_ >> 1) && rise > 0 && sinceMark_ >= PPG_SQI_REFRACT) {
+        armed_ = false;
+        sinceMark_ = 0;
+        peak_ = rise;
+        if (pending_[0] < 0) pending_[0] = 0; else pending_[1] = 0;
+      } else if (sinceMark_ == PPG_SQI_LOST) {
+        level_ >>= 1;
+        sinceMark_ = PPG_SQI_REFRACT;
+      }
+    } else if (rise > peak_) {
+      peak_ = rise;
+    } else if (rise <= 0) {
+      armed_ = true;
+      int32_t cap = level_ > 0 ? 2 * level_ : peak_;
+      level_ += ((peak_ < cap ? peak_ : cap) - level_) >> 2;
+    }
+
+    for (int8_t& pd : pending_) {
+      if (pd < 0) continue;
+      if (++pd == PPG_SQI_POST) { shape(); pd = -1; }
+    }
+  }
+
+  // The shape around the mark PPG_SQI_POST samples back
+  void shape() {
+    if (filled_ < PPG_SQI_SHAPE + 2) return;
+    int32_t s[PPG_SQI_SHAPE + 2];            // one extra each side for the shifts
+    for (uint8_t i = 0; i < PPG_SQI_SHAPE + 2; i++) s[i] = at(PPG_SQI_SHAPE + 1 - i);
+    float r = 0;
+    if (seeded_ >= PPG_SQI_SEED) {
+      r = -1;
+      for (uint8_t k = 0; k < 3; k++) {
+        float c = pearson(s + k);
+        if (c > r) r = c;
+      }
+      cur_.rSum += r;
+      cur_.rN++;
+      beats++;
+    }
+    if (!still_) return;                     // only still beats shape the template
+    if (seeded_ < PPG_SQI_SEED) {
+      for (uint8_t i = 0; i < PPG_SQI_SHAPE; i++)
+        tmpl16_[i] += (s[i + 1] << 4) / PPG_SQI_SEED;
+      seeded_++;
+    } else if (r >= PPG_SQI_KEEP_R) {
+      for (uint8_t i = 0; i < PPG_SQI_SHAPE; i++)
+        tmpl16_[i] += ((s[i + 1] << 4) - tmpl16_[i]) >> 3;
+      misfits_ = 0;
+    } else if (r > PPG_SQI_R_LO) {
+      misfits_ = 0;
+    } else if (++misfits_ >= PPG_SQI_RELOCK) {
+      memset(tmpl16_, 0, sizeof(tmpl16_));
+      seeded_ = 0; misfits_ = 0;
+      relocks++;
+    }
+  }
+
+  float pearson(const int32_t* s) const {
+    float sx = 0, st = 0;
+    for (uint8_t i = 0; i < PPG_SQI_SHAPE; i++) { sx += s[i]; st += tmpl16_[i]; }
+    sx /= PPG_SQI_SHAPE; st /= PPG_SQI_SHAPE;
+    float xy = 0, xx = 0, tt = 0;
+    for (uint8_t i = 0; i < PPG_SQI_SHAPE; i++) {
+      float x = s[i] - sx, t = tmpl16_[i] - st;
+      xy += x * t; xx += x * x; tt += t * t;
+    }
+    return xx > 0 && tt > 0 ? xy / sqrtf(xx * tt) : 0;
+  }
+};
@@ -0,0 +1,184 @@
+// ============================================================
+// tiga_sched.h — cooperative task scheduler for TIGA v6a
+// ============================================================
+// Replaces the `static unsigned long lastX` timers in loop().
+// Every periodic job is a registered task with a period, a
+// priority and a worst-case budget. loop() just calls
+// sched.runOnce().
+//
+//   runOnce() runs the single most urgent due task — lowest
+//   priority number first, earliest due time on a tie. If nothing
+//   is due it hands the wait to the idle hook (delay() on the
+//   device, which lets FreeRTOS idle the core) instead of spinning.
+//
+// Accounting per task:
+//   jitter   = actual start − due time
+//   overrun  = run time exceeded the task's budget
+//   missed   = whole periods skipped because the task ran late
+//
+// All times are uint32_t µs compared by signed difference, so
+// micros() wrapping every ~71 min is harmless.
+//
+// Storage is static (SCHED_MAX_TASKS). No heap. A task past it
+// is refused and counted in `refused`; check it once all are in.
+//
+// Host builds: pass a SchedClock backed by a virtual clock whose
+// idle hook simply advances time — timing tests then run as fast
+// as the CPU allows and are fully deterministic.
+// Host bench: host/bench_sched.cpp
+// ============================================================
+
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+
+#define SCHED_MAX_TASKS  20        // core 1 has 16
+
+typedef void (*SchedTaskFn)();
+
+struct SchedClock {
+  uint32_t (*nowUs)();               // time base for periods and jitter
+  void     (*idleUs)(uint32_t us);   // wait without burning CPU
+  uint32_t (*cpuUs)();               // run-time measurement; nullptr = nowUs
+};
+
+struct SchedTask {
+  const char* name;
+  SchedTaskFn fn;
+  uint32_t    periodUs;
+  uint32_t    budgetUs;
+  uint8_t     priority;      // 0 = most urgent
+  bool        enabled;
+  uint32_t    dueUs;
+
+  // Accounting
+  uint32_t    runs;
+  uint32_t    overruns;
+  uint32_t    missed;
+  uint32_t    maxJitterUs;
+  uint64_t    sumJitterUs;
+  uint32_t    maxRunUs;
+  uint64_t    sumRunUs;
+};
+
+class Scheduler {
+public:
+  explicit Scheduler(const SchedClock& clk) : idleTotalUs(0), refused(0), clk_(clk), count_(0) {}
+
+  // Register a task. First run is one period from start().
+  // Returns the task id, or -1 when the table is full.
+  int add(const char* name, SchedTaskFn fn, uint32_t periodMs,
+          uint8_t priority, uint32_t budgetUs) {
+    if (count_ >= SCHED_MAX_TASKS) { refused++; return -1; }
+    SchedTask& t = tasks_[count_];
+    memset(&t, 0, sizeof(t));
+    t.name     = name;
+    t.fn       = fn;
+    t.periodUs = periodMs * 1000UL;
+    t.budgetUs = budgetUs;
+    t.priority = priority;
+    t.enabled  = true;
+    return count_++;
+  }
+
+  // Anchor every task's first due time to now
+  void start() {
+    uint32_t now = clk_.nowUs();
+    for (uint8_t i = 0; i < count_; i++) tasks_[i].dueUs = now + tasks_[i].periodUs;
+  }
+
+  void enable(int id, bool on) {
+    if (id < 0 || id >= count_) return;
+    if (on && !tasks_[id].enabled) tasks_[id].dueUs = clk_.nowUs() + tasks_[id].periodUs;
+    tasks_[id].enabled = on;
+  }
+
+  // Make a task due right now (e.g. redraw after a state change)
+  void trigger(int id) {
+    if (id >= 0 && id < count_) tasks_[id].dueUs = clk_.nowUs();
+  }
+
+  // Run the most urgent due task, or idle until one is due.
+  // Returns true if a task ran.
+  bool runOnce() {
+    uint32_t now = clk_.nowUs();
+    int pick = -1;
+    int32_t soonest = INT32_MAX;
+
+    for (uint8_t i = 0; i < count_; i++) {
+      SchedTask& t = tasks_[i];
+      if (!t.enabled) continue;
+      int32_t wait = (int32_t)(t.dueUs - now);
+      if (wait <= 0) {
+        if (pick < 0 || t.priority < tasks_[pick].priority ||
+            (t.priority == tasks_[pick].priority &&
+             (int32_t)(t.dueUs - tasks_[pick].dueUs) < 0)) {
+          pick = i;
+        }
+      } else if (wait < soonest) {
+        soonest = wait;
+      }
+    }
+
+    if (pick < 0) {
+      if (soonest == INT32_MAX) return false;   // nothing enabled
+      idleTotalUs += (uint32_t)soonest;
+      clk_.idleUs((uint32_t)soonest);
+      return false;
+    }
+
+    execute(tasks_[pick], now);
+    return true;
+  }
+
+  // Clear accounting (e.g. at session reset). Schedule is kept.
+  void resetStats() {
+    for (uint8_t i = 0; i < count_; i++) {
+      SchedTask& t = tasks_[i];
+      t.runs = t.overruns = t.missed = 0;
+      t.maxJitterUs = t.maxRunUs = 0;
+      t.sumJitterUs = t.sumRunUs = 0;
+    }
+    idleTotalUs = 0;
+  }
+
+  uint8_t          count() const { return count_; }
+  const SchedTask& task(uint8_t i) const { return tasks_[i]; }
+
+  uint64_t idleTotalUs;     // time handed to the idle hook
+  uint8_t  refused;         // add() calls past SCHED_MAX_TASKS
+
+private:
+  SchedClock clk_;
+  SchedTask  tasks_[SCHED_MAX_TASKS];
+  uint8_t    count_;
+
+  uint32_t cpuNow() const { return clk_.cpuUs ? clk_.cpuUs() : clk_.nowUs(); }
+
+  void execute(SchedTask& t, uint32_t now) {
+    uint32_t jitter = now - t.dueUs;
+    if (jitter > t.maxJitterUs) t.maxJitterUs = jitter;
+    t.sumJitterUs += jitter;
+
+    uint32_t c0 = cpuNow();
+    t.fn();
+    uint32_t ran = cpuNow() - c0;
+
+    t.runs++;
+    t.sumRunUs += ran;
+    if (ran > t.maxRunUs) t.maxRunUs = ran;
+    if (t.budgetUs && ran > t.budgetUs) t.overruns++;
+
+    // Stay on the original grid; skip periods we can no longer make
+    t.dueUs += t.periodUs;
+    uint32_t after = clk_.nowUs();
+    if ((int32_t)(after - t.dueUs) > 0) {
+      uint32_t behind = after - t.dueUs;
+      uint32_t skip = t.periodUs ? behind / t.periodUs + 1 : 0;
+      t.missed += skip;
+      t.dueUs  += skip * t.periodUs;
+      if (!t.periodUs) t.dueUs = after;
+    }
+  }
+};
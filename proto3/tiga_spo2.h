@@ -0,0 +1,179 @@
+// ============================================================
+// tiga_spo2.h — streaming SpO2 estimator for TIGA v6a
+// ============================================================
+// Ratio-of-ratios over a sliding window of red/IR samples:
+//
+//   AC = max - min over the window     DC = mean over the window
+//   R  = (redAC / redDC) / (irAC / irDC)
+//   SpO2 ≈ 110 - 25 R                  (Maxim app-note line)
+//
+// Why: the old estimator rescanned a 25-sample window after every
+// sample. 250ms is a third of a heartbeat, so max - min caught
+// only part of the pulse and R came out noisy and biased. A
+// window of several seconds holds whole beats, but a rescan then
+// costs hundreds of compares per sample.
+//
+// Here every sample is O(1) amortised:
+//   DC       running sums, one add and one subtract per sample
+//   min/max  monotonic deques — each index is pushed and popped
+//            at most once, the front is always the extreme
+//
+// Usage:
+//   Spo2Estimator spo2(SPO2_WINDOW);
+//   spo2.push(red, ir);                    // every sample
+//   float pct, R;
+//   if (spo2.estimate(&pct, &R)) ...       // any time, O(1)
+//   spo2.reset();                          // gap or sensor off skin
+//
+// Host builds: spo2Batch() is the plain rescan of the same window,
+// used as the reference in host/bench_spo2.cpp.
+// ============================================================
+
+#pragma once
+
+#include <stdint.h>
+
+#define SPO2_WINDOW_MAX  512     // 5.12s at 100 Hz; power of two
+#define SPO2_MASK        (SPO2_WINDOW_MAX - 1)
+
+// Signal gates, as in v6a: reject tiny or implausible readings
+#define SPO2_MIN_DC      1000
+#define SPO2_MIN_AC      50
+#define SPO2_MIN_PCT     80.0f
+#define SPO2_MAX_PCT     100.0f
+
+// ── Sliding-window extreme ───────────────────────────────────
+// Candidates for the window's max (or min), values strictly
+// decreasing (increasing) from front to back. A new sample evicts
+// every candidate it beats from the back — they can never be the
+// extreme again — and the front leaves once it falls out of the
+// window. Values are kept next to their index so nothing has to
+// look back into the sample ring.
+template <bool IsMax>
+class SlidingExtreme {
+public:
+  void reset() { head_ = 0; count_ = 0; }
+
+  void push(uint32_t idx, int32_t v) {
+    while (count_ && !beats(q_[(head_ + count_ - 1) & SPO2_MASK].v, v)) count_--;
+    q_[(head_ + count_) & SPO2_MASK] = { idx, v };
+    count_++;
+  }
+
+  void expire(uint32_t oldestIdx) {
+    while (count_ && (int32_t)(q_[head_].idx - oldestIdx) < 0) {
+      head_ = (head_ + 1) & SPO2_MASK;
+      count_--;
+    }
+  }
+
+  int32_t value() const { return q_[head_].v; }
+
+private:
+  struct Entry { uint32_t idx; int32_t v; };
+  Entry    q_[SPO2_WINDOW_MAX];
+  uint16_t head_ = 0, count_ = 0;
+
+  // Keep the older candidate only if it is strictly more extreme
+  static bool beats(int32_t older, int32_t v) { return IsMax ? older > v : older < v; }
+};
+
+// ── Estimator ────────────────────────────────────────────────
+class Spo2Estimator {
+public:
+  explicit Spo2Estimator(uint16_t window) { setWindow(window); }
+
+  void setWindow(uint16_t window) {
+    if (window < 2) window = 2;
+    if (window > SPO2_WINDOW_MAX) window = SPO2_WINDOW_MAX;
+    win_ = window;
+    reset();
+  }
+
+  void reset() {
+    n_ = 0;
+    slot_ = 0;
+    redSum_ = irSum_ = 0;
+    redMax_.reset(); redMin_.reset();
+    irMax_.reset();  irMin_.reset();
+  }
+
+  void push(int32_t red, int32_t ir) {
+    if (n_ >= win_) {                       // oldest sample leaves the window
+      redSum_ -= red_[slot_];
+      irSum_  -= ir_[slot_];
+      uint32_t oldest = n_ + 1 - win_;
+      redMax_.expire(oldest); redMin_.expire(oldest);
+      irMax_.expire(oldest);  irMin_.expire(oldest);
+    }
+    red_[slot_] = red;
+    ir_[slot_]  = ir;
+    if (++slot_ == win_) slot_ = 0;
+    redSum_ += red;
+    irSum_  += ir;
+
+    redMax_.push(n_, red); redMin_.push(n_, red);
+    irMax_.push(n_, ir);   irMin_.push(n_, ir);
+    n_++;
+  }
+
+  bool     full() const    { return n_ >= win_; }
+  uint16_t window() const  { return win_; }
+
+  // Window statistics; only meaningful once full()
+  int32_t redAc() const { return redMax_.value() - redMin_.value(); }
+  int32_t irAc()  const { return irMax_.value() - irMin_.value(); }
+  float   redDc() const { return (float)redSum_ / win_; }
+  float   irDc()  const { return (float)irSum_ / win_; }
+
+  // Ratio of ratios; 0 when the signal fails the gates
+  float ratio() const {
+    if (!full()) return 0;
+    float rAc = (float)redAc(), iAc = (float)irAc();
+    float rDc = redDc(), iDc = irDc();
+    if (rDc <= SPO2_MIN_DC || iDc <= SPO2_MIN_DC || rAc <= SPO2_MIN_AC || iAc <= SPO2_MIN_AC)
+      return 0;
+    return (rAc / rDc) / (iAc / iDc);
+  }
+
+  // True with a plausible reading. *R is set whenever the gates pass.
+  bool estimate(float* spo2, float* R) const {
+    float r = ratio();
+    if (R) *R = r;
+    if (r <= 0) return false;
+    float pct = 110.0f - 25.0f * r;
+    if (pct < SPO2_MIN_PCT || pct > SPO2_MAX_PCT) return false;
+    *spo2 = pct;
+    return true;
+  }
+
+private:
+  uint16_t win_;
+  uint16_t slot_;               // next write position in the rings
+  uint32_t n_;                  // samples pushed since reset
+  int32_t  red_[SPO2_WINDOW_MAX];
+  int32_t  ir_[SPO2_WINDOW_MAX];
+  int64_t  redSum_, irSum_;
+  SlidingExtreme<true>  redMax_, irMax_;
+  SlidingExtreme<false> redMin_, irMin_;
+};
+
+// ── Reference: full rescan of the last `window` samples ──────
+// Same gates and formula as Spo2Estimator::ratio().
+inline float spo2Batch(const int32_t* red, const int32_t* ir, uint32_t window) {
+  int32_t rMin = red[0], rMax = red[0], iMin = ir[0], iMax = ir[0];
+  int64_t rSum = 0, iSum = 0;
+  for (uint32_t i = 0; i < window; i++) {
+    if (red[i] < rMin) rMin = red[i];
+    if (red[i] > rMax) rMax = red[i];
+    if (ir[i]  < iMin) iMin = ir[i];
+    if (ir[i]  > iMax) iMax = ir[i];
+    rSum += red[i];
+    iSum += ir[i];
+  }
+  float rAc = (float)(rMax - rMin), iAc = (float)(iMax - iMin);
+  float rDc = (float)rSum / window, iDc = (float)iSum / window;
+  if (rDc <= SPO2_MIN_DC || iDc <= SPO2_MIN_DC || rAc <= SPO2_MIN_AC || iAc <= SPO2_MIN_AC)
+    return 0;
+  return (rAc / rDc) / (iAc / iDc);
+}
@@ -0,0 +1,209 @@
+// ============================================================
+// tiga_stats.h — per-second, per-minute and per-hour statistics
+// ============================================================
+// Count, min, max, mean and variance of each daily metric (HR,
+// SpO2, steps, altitude) at three resolutions, in fixed memory:
+//
+//   seconds   the last STATS_SECS readings, one per second
+//   minutes   the last STATS_MINS whole minutes, rolled up
+//   hours     the last STATS_HOURS whole hours, rolled up
+//   session   everything since reset()
+//
+// ── Update ───────────────────────────────────────────────────
+// push() takes one second of every metric. Each value goes into
+// the seconds ring and into running aggregates for the minute
+// and the session: adds, a multiply and two compares. When a
+// minute completes its aggregate is copied into the minutes ring
+// and merged into the hour's; when an hour completes, the same
+// one level up. So a push is O(1), and the rollup cascades
+// without rescanning anything.
+//
+// A metric with no reading that second (finger off, sensor
+// missing) is STATS_NONE: counted nowhere, so a mean is over the
+// seconds that had a reading, not diluted by the ones that didn't.
+//
+// ── Aggregates ───────────────────────────────────────────────
+// Integer sums of v and v², so merging is exact, the order of
+// merging doesn't matter and a day of seconds doesn't drift the
+// way a running float mean does. Mean and variance come out as
+// floats only when asked for.
+//
+// ── Queries ──────────────────────────────────────────────────
+// range() merges the seconds [from, to) since reset() from the
+// finest level still holding them: whole hours from the hours
+// ring, whole minutes from the minutes ring, seconds at the
+// ends. Past a ring's reach the ends round out to the next level
+// up's slot. At most ~260 merges for any range.
+//
+// Memory: STATS_METRICS × (60 × 2 + 84 × 24 + 3 × 24) B = 8.8 KB
+// with the defaults, no heap. Merge, rollup and range checks
+// against a brute-force reference: host/bench_stats.cpp.
+// ============================================================
+
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+
+// ── Config ───────────────────────────────────────────────────
+#define STATS_SECS      60
+#define STATS_MINS      60        // one hour of minutes
+#define STATS_HOURS     24
+#define STATS_NONE      INT16_MIN // no reading this second
+
+static_assert(STATS_SECS >= 60 && STATS_MINS >= 60,
+              "the current minute and hour must be within the finer ring");
+
+enum StatMetric : uint8_t {
+  STAT_HR,          // bpm
+  STAT_SPO2,        // %
+  STAT_STEPS,       // steps in the second: sum is steps
+  STAT_ALT,         // climbed altitude, dm
+  STAT_METRICS
+};
+
+struct StatAgg {
+  uint32_t n;
+  int16_t  lo, hi;
+  int64_t  sum;
+  int64_t  sq;              // Σv²
+
+  void clear() { n = 0; lo = INT16_MAX; hi = INT16_MIN; sum = sq = 0; }
+
+  void add(int16_t v) {
+    n++;
+    if (v < lo) lo = v;
+    if (v > hi) hi = v;
+    sum += v;
+    sq  += (int32_t)v * v;
+  }
+
+  void merge(const StatAgg& o) {
+    if (!o.n) return;
+    n += o.n;
+    if (o.lo < lo) lo = o.lo;
+    if (o.hi > hi) hi = o.hi;
+    sum += o.sum;
+    sq  += o.sq;
+  }
+
+  float mean() const { return n ? (float)sum / n : 0; }
+
+  // Sample variance
+  float var() const {
+    if (n < 2) return 0;
+    double d = (double)sq - (double)sum * sum / n;
+    return d > 0 ? (float)(d / (n - 1)) : 0;
+  }
+};
+
+class StatsStore {
+public:
+  StatsStore() { reset(); }
+
+  void reset() {
+    now_ = 0;
+    for (int m = 0; m < STAT_METRICS; m++) {
+      for (int i = 0; i < STATS_SECS; i++) secs_[m][i] = STATS_NONE;
+      for (int i = 0; i < STATS_MINS; i++) mins_[m][i].clear();
+      for (int i = 0; i < STATS_HOURS; i++) hours_[m][i].clear();
+      minute_[m].clear();
+      hour_[m].clear();
+      session_[m].clear();
+    }
+  }
+
+  // One second of every metric, STATS_NONE where there's no reading
+  void push(const int16_t v[STAT_METRICS]) {
+    for (int m = 0; m < STAT_METRICS; m++) {
+      secs_[m][now_ % STATS_SECS] = v[m];
+      if (v[m] == STATS_NONE) continue;
+      minute_[m].add(v[m]);
+      session_[m].add(v[m]);
+    }
+    now_++;
+    if (now_ % 60) return;
+    uint32_t min = now_ / 60 - 1;
+    for (int m = 0; m < STAT_METRICS; m++) {
+      mins_[m][min % STATS_MINS] = minute_[m];
+      hour_[m].merge(minute_[m]);
+      minute_[m].clear();
+    }
+    if (now_ % 3600) return;
+    uint32_t hr = now_ / 3600 - 1;
+    for (int m = 0; m < STAT_METRICS; m++) {
+      hours_[m][hr % STATS_HOURS] = hour_[m];
+      hour_[m].clear();
+    }
+  }
+
+  // Seconds pushed since reset()
+  uint32_t seconds() const { return now_; }
+
+  const StatAgg& session(uint8_t m) const { return session_[m]; }
+
+  // The last `secs` seconds
+  StatAgg last(uint8_t m, uint32_t secs) const {
+    return range(m, secs < now_ ? now_ - secs : 0, now_);
+  }
+
+  // Seconds [from, to) since reset(), from the finest level that
+  // still holds them
+  StatAgg range(uint8_t m, uint32_t from, uint32_t to) const {
+    StatAgg a;
+    a.clear();
+    if (to > now_) to = now_;
+    uint32_t t = from;
+    while (t < to) {
+      if (t % 3600 == 0 && t + 3600 <= to && hourHeld(t / 3600)) {
+        a.merge(hours_[m][t / 3600 % STATS_HOURS]);
+        t += 3600;
+      } else if (t % 60 == 0 && t + 60 <= to && minuteHeld(t / 60)) {
+        a.merge(mins_[m][t / 60 % STATS_MINS]);
+        t += 60;
+      } else if (now_ - t <= STATS_SECS) {
+        int16_t v = secs_[m][t % STATS_SECS];
+        if (v != STATS_NONE) a.add(v);
+        t++;
+      } else if (minuteHeld(t / 60)) {      // too old for seconds: the whole minute
+        a.merge(mins_[m][t / 60 % STATS_MINS]);
+        t = (t / 60 + 1) * 60;
+      } else {                              // the whole hour, if still held
+        if (hourHeld(t / 3600)) a.merge(hours_[m][t / 3600 % STATS_HOURS]);
+        t = (t / 3600 + 1) * 3600;
+      }
+    }
+    return a;
+  }
+
+  // A whole minute or hour by index since reset(); false once it
+  // has left its ring or before it completes
+  bool minute(uint8_t m, uint32_t i, StatAgg* out) const {
+    if (!minuteHeld(i)) return false;
+    *out = mins_[m][i % STATS_MINS];
+    return true;
+  }
+  bool hour(uint8_t m, uint32_t i, StatAgg* out) const {
+    if (!hourHeld(i)) return false;
+    *out = hours_[m][i % STATS_HOURS];
+    return true;
+  }
+
+private:
+  uint32_t now_;
+  int16_t  secs_[STAT_METRICS][STATS_SECS];
+  StatAgg  mins_[STAT_METRICS][STATS_MINS];
+  StatAgg  hours_[STAT_METRICS][STATS_HOURS];
+  StatAgg  minute_[STAT_METRICS];   // running: this minute
+  StatAgg  hour_[STAT_METRICS];     // this hour's whole minutes
+  StatAgg  session_[STAT_METRICS];
+
+  bool minuteHeld(uint32_t i) const {
+    uint32_t done = now_ / 60;              // minutes complete
+    return i < done && done - i <= STATS_MINS;
+  }
+  bool hourHeld(uint32_t i) const {
+    uint32_t done = now_ / 3600;
+    return i < done && done - i <= STATS_HOURS;
+  }
+};
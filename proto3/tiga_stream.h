@@ -0,0 +1,546 @@
+// ============================================================
+// tiga_stream.h — raw PPG and accelerometer waveforms over BLE
+// ============================================================
+// The telemetry characteristic sends a few numbers a second; a
+// clinician reviewing a walk test wants the waveforms behind them.
+// While a phone asks for it, this streams the 100 Hz red / IR
+// samples and the 200 Hz accelerometer as they come off the FIFOs,
+// packed into notifications the size of the link's MTU. Opt-in:
+// nothing is encoded or sent until the phone writes START, and it
+// stops at STOP or a disconnect.
+//
+// ── Frames (notifications, little-endian) ────────────────────
+//     [0]     header    bits 7-6  STREAM_VERSION
+//                       bits 5-4  level: one sample per 2^level
+//                       bits 3-0  StreamType
+//     [1-2]   seq       uint16, +1 per frame made on this channel
+//     [3-6]   first     sensor sample index of the first sample
+//                       (PPG and IMU FIFO indices, tiga_*_fifo.h)
+//     [7]     count     samples in the frame
+//     [8..]   base      the first sample in full:
+//                         PPG  red, ir   uint24 each
+//                         ACC  ax, ay, az int16 each (raw counts)
+//     [..]    deltas    the other count − 1 samples in groups of
+//                       STREAM_GROUP (the last may be short),
+//                       bit-packed LSB first: per axis a 5-bit
+//                       width w, then per sample, per axis, the
+//                       zigzag of x[n] − x[n−1] in w bits. The
+//                       frame ends at the byte the last group ends in.
+//   A byte varint spends 16 bits on any delta past ±63, which is
+//   where sensor noise sits; a width per group of 8 costs under a
+//   bit a sample and follows the signal from rest into a swing.
+//   Samples in a frame are consecutive at the frame's level: the
+//   k-th is at first + k·2^level. Every frame decodes on its own,
+//   so a lost one costs only itself. A frame fills what the link
+//   carries in one packet — MTU − 3, at most STREAM_FRAME_MAX — or
+//   closes after STREAM_SPAN_MS of signal, at a FIFO gap or when
+//   the level changes.
+//
+//     [0] STREAM_STAT  [1-2] seq  [3-4] ppgHz  [5-6] accHz
+//     [7] level  [8-11] frames made  [12-15] frames dropped
+//   Once a second. Made − dropped − received is what the air lost.
+//
+// ── Control (writes) ─────────────────────────────────────────
+//     STREAM_START  channels u8 (StreamChannel bits),
+//                   accel level u8 (0 = 200 Hz, 1 = 100 Hz)
+//     STREAM_STOP
+//
+// ── Keeping up ───────────────────────────────────────────────
+// Frames are made on core 0 next to the capture stage and cross
+// to core 1 in an SPSC ring (tiga_cores.h); run(), from a core 1
+// task, notifies them. When the stack is full the frame is held
+// for the next run. When the ring hasn't once drained below a
+// quarter in STREAM_PACE_MS, or a frame finds it full (dropped,
+// counted), every channel halves its rate — pairs of samples
+// averaged, so the wave keeps its shape below the new Nyquist —
+// down to 1/8. A PPG block's worth of frames landing at once is
+// not a backlog; a ring the link never clears is. After
+// STREAM_RELAX_MS of windows in which it emptied it steps back
+// up; if that has to be undone within the wait, the next wait is
+// twice as long, so a link between two rates settles on the lower
+// one instead of see-sawing. The phone reads the rate from each
+// frame.
+//
+// While streaming, run() asks the link for its fastest setting
+// (StreamLink::fast: 7.5–15 ms connection interval, 2M PHY,
+// 251-byte data PDUs) and hands it back when the stream stops.
+//
+// Memory: ~5.1 KB, most of it the ring. Host bench: host/bench_stream.cpp
+// ============================================================
+
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+#include "tiga_cores.h"
+#include "tiga_imu_fifo.h"
+#include "tiga_ppg_fifo.h"
+#include "tiga_telemetry.h"
+#include "tiga_sync.h"
+
+#define STREAM_VERSION       1
+#define STREAM_FRAME_MAX     244     // 251-byte LE data PDU less L2CAP and ATT headers
+#define STREAM_HDR           8
+#define STREAM_AXES_MAX      3
+#define STREAM_GROUP         8       // samples sharing a bit width
+#define STREAM_WIDTH_BITS    5
+#define STREAM_QUEUE         16      // frames between the cores
+#define STREAM_BURST         8       // notifications per run()
+#define STREAM_LEVEL_MAX     3       // down to 1/8 of the sensor rate
+#define STREAM_PACE_MS       250     // backlog judged over this window
+#define STREAM_HOLD_MS       500     // after a step, before the next one
+#define STREAM_RELAX_MS      2000    // ring emptied in every window this long: step up
+#define STREAM_RELAX_MAX_MS  32000   // doubled each time a step up doesn't hold
+#define STREAM_SPAN_MS       1000    // most signal in one frame
+#define STREAM_STAT_MS       1000
+#define STREAM_STAT_BYTES    16
+
+enum StreamType : uint8_t {
+  STREAM_PPG   = 1,
+  STREAM_ACC   = 2,
+  STREAM_STAT  = 3,
+  STREAM_START = 0x10,               // control
+  STREAM_STOP  = 0x11
+};
+
+enum StreamChannel : uint8_t {
+  STREAM_CH_PPG = 1 << 0,
+  STREAM_CH_ACC = 1 << 1
+};
+
+struct StreamFrame {
+  uint8_t n;
+  uint8_t b[STREAM_FRAME_MAX];
+};
+
+// ── Bit packing ──────────────────────────────────────────────
+inline uint8_t streamBits(uint32_t z) { return z ? (uint8_t)(32 - __builtin_clz(z)) : 0; }
+
+// LSB first from bit `pos`; bytes are cleared as they are reached
+inline void streamPut(uint8_t* b, uint32_t& pos, uint32_t v, uint8_t w) {
+  while (w) {
+    uint8_t sh = pos & 7, k = (uint8_t)(8 - sh);
+    if (k > w) k = w;
+    if (!sh) b[pos >> 3] = 0;
+    b[pos >> 3] |= (uint8_t)((v & ((1u << k) - 1)) << sh);
+    v >>= k; pos += k; w = (uint8_t)(w - k);
+  }
+}
+
+// False past `end` bits
+inline bool streamGet(const uint8_t* b, uint32_t& pos, uint32_t end, uint8_t w, uint32_t* v) {
+  if (pos + w > end) return false;
+  uint32_t x = 0;
+  for (uint8_t got = 0; got < w; ) {
+    uint8_t sh = pos & 7, k = (uint8_t)(8 - sh);
+    if (k > w - got) k = (uint8_t)(w - got);
+    x |= (uint32_t)((b[pos >> 3] >> sh) & ((1u << k) - 1)) << got;
+    pos += k; got = (uint8_t)(got + k);
+  }
+  *v = x;
+  return true;
+}
+
+// ── Link ─────────────────────────────────────────────────────
+struct StreamLink {
+  uint16_t (*mtu)();                              // ATT MTU in use now
+  bool     (*send)(const uint8_t* p, uint16_t n); // one notification; false = stack full, later
+  void     (*fast)(bool on);                      // quickest interval / PHY, or back to normal
+};
+
+// ── Watch side ───────────────────────────────────────────────
+class StreamSender {
+public:
+  // Counters since boot. Core 0: frames made, samples in and out,
+  // steps; core 1 the rest
+  uint32_t framesMade  = 0;
+  uint32_t samplesIn   = 0;      // sensor samples while streaming
+  uint32_t samplesOut  = 0;      // samples in frames, after decimation
+  uint32_t slower      = 0;      // steps down in rate
+  uint32_t faster      = 0;      // steps back up
+  uint32_t sessions    = 0;      // STARTs taken
+  uint32_t framesSent  = 0;
+  uint64_t bytesSent   = 0;
+  uint32_t busy        = 0;      // runs that found the stack full
+
+  StreamSender(const StreamLink& link, uint16_t ppgHz, uint16_t accHz, uint32_t (*nowMs)())
+    : link_(link), nowMs_(nowMs), ppgHz_(ppgHz), accHz_(accHz) {
+    chan_[0].type = STREAM_PPG; chan_[0].axes = 2; chan_[0].width = 3;
+    chan_[0].span = (uint32_t)ppgHz * STREAM_SPAN_MS / 1000;
+    chan_[1].type = STREAM_ACC; chan_[1].axes = 3; chan_[1].width = 2;
+    chan_[1].span = (uint32_t)accHz * STREAM_SPAN_MS / 1000;
+  }
+
+  // From the control characteristic's write callback (BLE task)
+  void onControl(const uint8_t* p, uint16_t n) {
+    uint8_t w = 0;
+    if (n >= 2 && p[0] == STREAM_START)
+      w = (uint8_t)((p[1] & (STREAM_CH_PPG | STREAM_CH_ACC)) | (n >= 3 && p[2] ? 1 : 0) << 4);
+    else if (n < 1 || p[0] != STREAM_STOP) return;
+    __atomic_store_n(&want_, (uint8_t)(w ? w | (nextGen() << 5) : 0), __ATOMIC_RELEASE);
+  }
+
+  // Link went down (BLE task too); the phone asks again
+  void disconnect() { __atomic_store_n(&want_, (uint8_t)0, __ATOMIC_RELEASE); }
+
+  // ── Core 0: from the PPG block and IMU stages ──────────────
+  void ppg(const PpgBlock& b) {
+    if (!follow(STREAM_CH_PPG)) return;
+    int32_t v[2];
+    for (uint16_t i = 0; i < b.count; i++) {
+      v[0] = (int32_t)b.s[i].red;
+      v[1] = (int32_t)b.s[i].ir;
+      feed(chan_[0], b.firstSample + i, v);
+    }
+  }
+
+  void acc(const ImuSample* s, uint8_t n) {
+    if (!follow(STREAM_CH_ACC)) return;
+    int32_t v[3];
+    for (uint8_t i = 0; i < n; i++) {
+      v[0] = s[i].ax; v[1] = s[i].ay; v[2] = s[i].az;
+      feed(chan_[1], s[i].idx, v);
+    }
+  }
+
+  // ── Core 1: from a scheduler task ──────────────────────────
+  void run() {
+    uint8_t w  = __atomic_load_n(&want_, __ATOMIC_ACQUIRE);
+    bool    on = w & (STREAM_CH_PPG | STREAM_CH_ACC);
+    uint16_t mtu  = link_.mtu();
+    uint16_t room = mtu > SYNC_ATT_HDR ? mtu - SYNC_ATT_HDR : 0;
+    __atomic_store_n(&room_, room < STREAM_FRAME_MAX ? room : (uint16_t)STREAM_FRAME_MAX, __ATOMIC_RELAXED);
+
+    if (on != fast_) {
+      fast_ = on;
+      if (link_.fast) link_.fast(on);
+      if (on) {
+        sessions++;
+        statSeq_ = 0;
+        statMs_  = nowMs_() - STREAM_STAT_MS;   // one straight away
+      }
+    }
+    if (!on) {                                  // the stream's over: empty the ring
+      held_ = false;
+      while (q_.pop(out_)) {}
+      return;
+    }
+
+    uint32_t now = nowMs_();
+    if (now - statMs_ >= STREAM_STAT_MS && sendStat()) statMs_ = now;
+    for (uint8_t k = 0; k < STREAM_BURST; k++) {
+      if (!held_ && !q_.pop(out_)) return;
+      if (!link_.send(out_.b, out_.n)) {       // stack full: same frame next run
+        held_ = true;
+        busy++;
+        return;
+      }
+      held_ = false;
+      framesSent++;
+      bytesSent += out_.n;
+    }
+  }
+
+  bool     active() const  { return __atomic_load_n(&want_, __ATOMIC_RELAXED) != 0; }
+  uint8_t  level() const   { return __atomic_load_n(&level_, __ATOMIC_RELAXED); }
+  uint32_t dropped() const { return __atomic_load_n(&q_.dropped, __ATOMIC_RELAXED); }
+  uint32_t queued() const  { return q_.size(); }
+
+private:
+  struct Chan {
+    uint8_t     type, axes, width;
+    uint32_t    span;                    // sensor samples in STREAM_SPAN_MS
+    uint8_t     level;                   // of the frame being built
+    uint16_t    seq;
+    uint32_t    next;                    // sensor index expected next
+    uint8_t     gLevel, gk;              // decimation group: its level, samples in it
+    uint32_t    gIdx;
+    int32_t     gSum[STREAM_AXES_MAX];
+    uint8_t     count;                   // samples in f, the open group's included
+    uint32_t    first, after;            // f's first index, the one after its last
+    uint32_t    bits;                    // f's length up to the open group
+    int32_t     prev[STREAM_AXES_MAX];   // last sample before the open group
+    int32_t     grp[STREAM_GROUP][STREAM_AXES_MAX];
+    uint8_t     gn, gw[STREAM_AXES_MAX]; // open group: samples, widths so far
+    StreamFrame f;
+  };
+
+  StreamLink  link_;
+  uint32_t  (*nowMs_)();
+  uint16_t    ppgHz_, accHz_;
+
+  // Shared: want_ written by the BLE task, room_ by run(), level_
+  // by core 0
+  uint8_t     want_  = 0;                // StreamChannel bits | accel level << 4 | gen << 5
+  uint8_t     gen_   = 0;
+  uint16_t    room_  = 20;
+  uint8_t     level_ = 0;
+
+  // Core 0
+  uint8_t     have_  = 0;                // the want_ the channels were set up for
+  uint8_t     accFloor_ = 0;
+  uint32_t    paceMs_ = 0, stepMs_ = 0, calmMs_ = 0, upMs_ = 0;   // window start; last step; last busy window; last step up
+  uint32_t    low_ = 0;                  // least the ring held this window
+  uint32_t    relaxMs_ = STREAM_RELAX_MS;
+  uint16_t    roomNow_ = 20;
+  Chan        chan_[2];
+  SpscRing<StreamFrame, STREAM_QUEUE> q_;
+
+  // Core 1
+  bool        fast_ = false, held_ = false;
+  uint16_t    statSeq_ = 0;
+  uint32_t    statMs_ = 0;
+  StreamFrame out_;
+
+  uint8_t nextGen() { gen_ = (uint8_t)((gen_ + 1) & 7); return gen_ ? gen_ : (gen_ = 1); }
+
+  // A new START (or a STOP) since the last sample starts every
+  // channel afresh; true if this channel is wanted
+  bool follow(uint8_t ch) {
+    uint8_t w = __atomic_load_n(&want_, __ATOMIC_ACQUIRE);
+    if (w != have_) {
+      have_     = w;
+      accFloor_ = (w >> 4) & 1;
+      for (Chan& c : chan_) { c.seq = 0; c.count = 0; c.gk = 0; }
+      calmMs_  = paceMs_ = nowMs_();
+      low_     = 0;
+      stepMs_  = calmMs_ - STREAM_HOLD_MS;
+      upMs_    = calmMs_ - STREAM_RELAX_MAX_MS;
+      relaxMs_ = STREAM_RELAX_MS;
+      __atomic_store_n(&level_, (uint8_t)0, __ATOMIC_RELAXED);
+    }
+    roomNow_ = __atomic_load_n(&room_, __ATOMIC_RELAXED);
+    if (!(w & ch)) return false;
+
+    uint32_t fill = q_.size(), now = nowMs_();
+    if (fill < low_) low_ = fill;
+    if (now - paceMs_ >= STREAM_PACE_MS) {
+      if (low_) calmMs_ = now;
+      pace(low_ >= STREAM_QUEUE / 4);
+      paceMs_ = now;
+      low_    = fill;
+    }
+    return true;
+  }
+
+  // Halve the rate when the link is behind; double it again once
+  // the ring has kept emptying for relaxMs_
+  void pace(bool behind) {
+    uint32_t now = nowMs_();
+    uint8_t  l   = level_;
+    if (behind) calmMs_ = now;
+    if (now - stepMs_ < STREAM_HOLD_MS) return;
+    if (behind && l < STREAM_LEVEL_MAX) {
+      __atomic_store_n(&level_, (uint8_t)(l + 1), __ATOMIC_RELAXED);
+      slower++;
+      stepMs_ = now;
+      if (now - upMs_ < relaxMs_ && relaxMs_ < STREAM_RELAX_MAX_MS) relaxMs_ *= 2;
+    } else if (!behind && l && now - calmMs_ >= relaxMs_) {
+      __atomic_store_n(&level_, (uint8_t)(l - 1), __ATOMIC_RELAXED);
+      faster++;
+      stepMs_ = upMs_ = calmMs_ = now;
+    }
+  }
+
+  uint8_t levelFor(const Chan& c) const {
+    uint8_t l = (uint8_t)(level_ + (c.type == STREAM_ACC ? accFloor_ : 0));
+    return l > STREAM_LEVEL_MAX ? STREAM_LEVEL_MAX : l;
+  }
+
+  // One sensor sample into its channel's decimation group
+  void feed(Chan& c, uint32_t idx, const int32_t* v) {
+    samplesIn++;
+    if (c.gk && idx != c.next) c.gk = 0;          // FIFO gap: the part-group goes
+    c.next = idx + 1;
+    if (!c.gk) {
+      c.gLevel = levelFor(c);
+      c.gIdx   = idx;
+      for (uint8_t a = 0; a < c.axes; a++) c.gSum[a] = 0;
+    }
+    for (uint8_t a = 0; a < c.axes; a++) c.gSum[a] += v[a];
+    if (++c.gk < (1u << c.gLevel)) return;
+    c.gk = 0;
+    int32_t m[STREAM_AXES_MAX];
+    for (uint8_t a = 0; a < c.axes; a++)
+      m[a] = (c.gSum[a] + ((1 << c.gLevel) >> 1)) >> c.gLevel;
+    put(c, c.gIdx, m, c.gLevel);
+  }
+
+  // One (decimated) sample into the frame being built. It joins
+  // the open group if the group still fits with it at the widths
+  // it then needs; if not, the open group ends the frame (a short
+  // group is only ever the last one) and the sample starts the next.
+  void put(Chan& c, uint32_t idx, const int32_t* v, uint8_t lvl) {
+    if (c.count) {
+      if (lvl == c.level && idx == c.after && c.count < 255 && idx - c.first < c.span) {
+        const int32_t* last = c.gn ? c.grp[c.gn - 1] : c.prev;
+        uint8_t  w[STREAM_AXES_MAX];
+        uint32_t per = 0;
+        for (uint8_t a = 0; a < c.axes; a++) {
+          uint8_t b = streamBits(telZig((uint32_t)(v[a] - last[a])));
+          w[a] = b > c.gw[a] ? b : c.gw[a];
+          per += w[a];
+        }
+        if (c.bits + c.axes * STREAM_WIDTH_BITS + (c.gn + 1u) * per <= roomNow_ * 8u) {
+          memcpy(c.grp[c.gn++], v, c.axes * sizeof(int32_t));
+          memcpy(c.gw, w, c.axes);
+          c.count++;
+          c.after += 1u << lvl;
+          samplesOut++;
+          if (c.gn == STREAM_GROUP) commit(c);
+          return;
+        }
+      }
+      close(c);
+    }
+    if (roomNow_ < STREAM_HDR + c.axes * c.width) return;   // MTU not settled yet
+
+    c.level = lvl;
+    c.first = idx;
+    c.after = idx + (1u << lvl);
+    c.f.b[0] = (uint8_t)(STREAM_VERSION << 6 | lvl << 4 | c.type);
+    syncPut32(c.f.b + 3, idx);
+    uint8_t* p = c.f.b + STREAM_HDR;
+    for (uint8_t a = 0; a < c.axes; a++, p += c.width) {
+      if (c.width == 3) { p[0] = (uint8_t)v[a]; p[1] = (uint8_t)(v[a] >> 8); p[2] = (uint8_t)(v[a] >> 16); }
+      else              syncPut16(p, (uint16_t)v[a]);
+      c.prev[a] = v[a];
+      c.gw[a]   = 0;
+    }
+    c.bits  = (uint32_t)(p - c.f.b) * 8;
+    c.gn    = 0;
+    c.count = 1;
+    samplesOut++;
+  }
+
+  // Pack the open group: its widths, then its deltas
+  void commit(Chan& c) {
+    uint32_t pos = c.bits;
+    for (uint8_t a = 0; a < c.axes; a++) streamPut(c.f.b, pos, c.gw[a], STREAM_WIDTH_BITS);
+    for (uint8_t i = 0; i < c.gn; i++) {
+      const int32_t* last = i ? c.grp[i - 1] : c.prev;
+      for (uint8_t a = 0; a < c.axes; a++)
+        streamPut(c.f.b, pos, telZig((uint32_t)(c.grp[i][a] - last[a])), c.gw[a]);
+    }
+    memcpy(c.prev, c.grp[c.gn - 1], sizeof(c.prev));
+    memset(c.gw, 0, sizeof(c.gw));
+    c.gn   = 0;
+    c.bits = pos;
+  }
+
+  // Number the frame and hand it to core 1
+  void close(Chan& c) {
+    if (c.gn) commit(c);
+    c.f.n = (uint8_t)((c.bits + 7) / 8);
+    syncPut16(c.f.b + 1, c.seq++);
+    c.f.b[7] = c.count;
+    c.count  = 0;
+    __atomic_store_n(&framesMade, framesMade + 1, __ATOMIC_RELAXED);
+    if (!q_.push(c.f)) pace(true);
+  }
+
+  bool sendStat() {
+    uint8_t s[STREAM_STAT_BYTES];
+    s[0] = (uint8_t)(STREAM_VERSION << 6 | STREAM_STAT);
+    syncPut16(s + 1, statSeq_);
+    syncPut16(s + 3, ppgHz_);
+    syncPut16(s + 5, accHz_);
+    s[7] = level();
+    syncPut32(s + 8, __atomic_load_n(&framesMade, __ATOMIC_RELAXED));
+    syncPut32(s + 12, dropped());
+    if (!link_.send(s, sizeof(s))) return false;
+    statSeq_++;
+    return true;
+  }
+};
+
+// ── Phone side ───────────────────────────────────────────────
+// Reference decoder, as a phone app would implement it; the host
+// bench and simulator check the watch side against it. Samples
+// come out with their sensor index and the level they were sent
+// at (the rate is the channel's / 2^level).
+typedef void (*StreamSampleFn)(uint8_t type, uint32_t idx, uint8_t level, const int32_t* v, void* ctx);
+
+class StreamReceiver {
+public:
+  uint32_t frames = 0, samples = 0, bytes = 0;
+  uint32_t lost   = 0;           // frames missing from a channel's seq
+  uint32_t bad    = 0;           // wrong version, short or overrunning
+  uint32_t stats  = 0;
+  // From the newest STREAM_STAT
+  uint16_t ppgHz = 0, accHz = 0;
+  uint8_t  level = 0;
+  uint32_t watchMade = 0, watchDropped = 0;
+
+  StreamReceiver(StreamSampleFn fn, void* ctx) : fn_(fn), ctx_(ctx) {}
+
+  // The control write; expectations start over with it
+  uint8_t start(uint8_t* out, uint8_t channels, uint8_t accLevel) {
+    out[0] = STREAM_START;
+    out[1] = channels;
+    out[2] = accLevel;
+    have_[0] = have_[1] = false;
+    return 3;
+  }
+
+  bool onFrame(const uint8_t* p, uint16_t n) {
+    if (n < 1 || p[0] >> 6 != STREAM_VERSION) { bad++; return false; }
+    uint8_t type = p[0] & 0x0F, lvl = (p[0] >> 4) & 3;
+    if (type == STREAM_STAT) {
+      if (n < STREAM_STAT_BYTES) { bad++; return false; }
+      stats++;
+      ppgHz = syncGet16(p + 3);
+      accHz = syncGet16(p + 5);
+      level = p[7];
+      watchMade    = syncGet32(p + 8);
+      watchDropped = syncGet32(p + 12);
+      return true;
+    }
+    if (type != STREAM_PPG && type != STREAM_ACC) { bad++; return false; }
+    uint8_t axes = type == STREAM_PPG ? 2 : 3, width = type == STREAM_PPG ? 3 : 2;
+    if (n < STREAM_HDR + axes * width) { bad++; return false; }
+
+    uint16_t seq   = syncGet16(p + 1);
+    uint32_t idx   = syncGet32(p + 3);
+    uint8_t  count = p[7];
+    int32_t  v[STREAM_AXES_MAX];
+    const uint8_t* q = p + STREAM_HDR;
+    for (uint8_t a = 0; a < axes; a++, q += width)
+      v[a] = width == 3 ? (int32_t)((uint32_t)q[0] | (uint32_t)q[1] << 8 | (uint32_t)q[2] << 16)
+                        : (int16_t)syncGet16(q);
+
+    // Decode the whole frame before handing any of it out
+    int32_t  buf[256 * STREAM_AXES_MAX];
+    uint32_t pos = (uint32_t)(q - p) * 8, end = (uint32_t)n * 8;
+    memcpy(buf, v, axes * sizeof(int32_t));
+    for (uint16_t k = 1; k < count; ) {
+      uint32_t w[STREAM_AXES_MAX], z;
+      for (uint8_t a = 0; a < axes; a++)
+        if (!streamGet(p, pos, end, STREAM_WIDTH_BITS, &w[a])) { bad++; return false; }
+      for (uint8_t i = 0; i < STREAM_GROUP && k < count; i++, k++)
+        for (uint8_t a = 0; a < axes; a++) {
+          if (!streamGet(p, pos, end, (uint8_t)w[a], &z)) { bad++; return false; }
+          v[a] += (int32_t)telUnzig(z);
+          buf[k * axes + a] = v[a];
+        }
+    }
+    if (!count || (pos + 7) / 8 != n) { bad++; return false; }
+
+    uint8_t ch = type - STREAM_PPG;
+    if (have_[ch] && seq != expect_[ch]) lost += (uint16_t)(seq - expect_[ch]);
+    have_[ch]   = true;
+    expect_[ch] = seq + 1;
+    frames++;
+    samples += count;
+    bytes   += n;
+    if (fn_)
+      for (uint16_t k = 0; k < count; k++) fn_(type, idx + ((uint32_t)k << lvl), lvl, buf + k * axes, ctx_);
+    return true;
+  }
+
+private:
+  StreamSampleFn fn_;
+  void*          ctx_;
+  bool           have_[2] = { false, false };
+  uint16_t       expect_[2] = { 0, 0 };
+};
@@ -0,0 +1,483 @@
+// ============================================================
+// tiga_sync.h — bulk history backfill over BLE
+// ============================================================
+// The live characteristic in tiga_ble.h sends one 20-byte snapshot
+// a second while a phone is connected; anything that happens out
+// of range never reaches it. This streams the flash history
+// (tiga_history.h) instead: the phone says where it is up to and
+// the watch sends everything after that, as fast as the link
+// takes it, and carries on as new blocks land.
+//
+// Two characteristics on their own service:
+//   control  phone → watch, write / write without response
+//   data     watch → phone, notify
+//
+// ── Data chunks (notifications, little-endian) ──────────────
+//     [0]     type      SYNC_DATA, | SYNC_ACK_NOW when the watch
+//                       can send no more until it hears an ACK
+//     [1-2]   seq       uint16, +1 per chunk, wraps
+//     [3-17]  base      the chunk's first sample, in full:
+//                         t u32, hr u8, spo2 u8,
+//                         battery u8 (bit 7 = worn),
+//                         steps int32, altDm int32
+//     [18..]  records   the following samples as tiga_history.h
+//                       records, deltas from the one before
+//     [n-2]   crc16     CCITT over everything before it
+//   Every chunk decodes on its own, so a lost one costs only
+//   itself. A chunk fills the notification the negotiated ATT
+//   MTU allows (MTU − 3): 20 bytes at the default 23 — one sample —
+//   up to 514 at 517, about 330 quiet seconds.
+//
+//     [0] SYNC_END  [1-2] next seq  [3-6] newest t sent  [7-8] crc16
+//   Sent when everything in flash has gone out. A phone holding
+//   every chunk before `next seq` ACKs it; one that isn't NACKs.
+//
+// ── Control (writes) ─────────────────────────────────────────
+//     SYNC_START  fromT u32, seq u16   send samples with t ≥ fromT,
+//                                      numbering chunks from seq
+//     SYNC_ACK    seq u16              every chunk up to seq arrived
+//     SYNC_NACK   seq u16              seq is missing; resend from it
+//     SYNC_STOP
+//
+// ── Resuming ─────────────────────────────────────────────────
+// The watch keeps no per-phone state. After a disconnect (or a
+// watch reboot) the phone sends START with its newest sample's t
+// + 1 and its next expected seq; the numbering carries on where
+// it stopped and the store seeks straight to the time. History
+// timestamps are unique and increasing (taskHistory() stores at
+// most one sample per second), which is what makes t a position.
+//
+// ── Flow ─────────────────────────────────────────────────────
+// Go-back-N over a window of unacknowledged chunks. In flight the
+// watch keeps only each chunk's seq and first t (8 bytes); a resend
+// re-reads flash from that t. The window grows by one for every
+// window's worth acknowledged and halves on a NACK or a timeout,
+// so it settles at what the link sustains. The phone ACKs every
+// SYNC_ACK_EVERY chunks and any chunk flagged SYNC_ACK_NOW, NACKs
+// the first gap, and re-ACKs duplicates (its ACK was lost).
+//
+// Control writes arrive in the BLE stack's task; SyncSender queues
+// them (single producer, single consumer) and run(), called from
+// a scheduler task, does all the work.
+// ============================================================
+
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+#include "tiga_history.h"
+
+#define SYNC_MTU_WANT     517       // ATT MTU asked for at connect
+#define SYNC_ATT_HDR      3         // notification opcode + handle
+#define SYNC_CHUNK_MAX    (SYNC_MTU_WANT - SYNC_ATT_HDR)
+#define SYNC_CHUNK_HDR    3         // type + seq
+#define SYNC_CHUNK_CRC    2
+#define SYNC_BASE_BYTES   15
+#define SYNC_WINDOW       24        // chunks in flight, at most
+#define SYNC_WINDOW_MIN   2
+#define SYNC_BURST        6         // chunks per run(), ~ one connection event
+#define SYNC_RETRY_US     600000    // no ACK progress for this long: go back
+#define SYNC_ACK_EVERY    4
+#define SYNC_CTL_QUEUE    8
+#define SYNC_CTL_MAX      8         // longest control write
+
+enum SyncType : uint8_t {
+  SYNC_DATA    = 0x01,
+  SYNC_ACK_NOW = 0x80,             // flag on SYNC_DATA
+  SYNC_END     = 0x02,
+  SYNC_START   = 0x10,
+  SYNC_ACK     = 0x11,
+  SYNC_NACK    = 0x12,
+  SYNC_STOP    = 0x13
+};
+
+// ── Chunk helpers ────────────────────────────────────────────
+inline void syncPut16(uint8_t* p, uint16_t v) { p[0] = (uint8_t)v; p[1] = (uint8_t)(v >> 8); }
+inline void syncPut32(uint8_t* p, uint32_t v) { for (uint8_t i = 0; i < 4; i++) p[i] = (uint8_t)(v >> (8 * i)); }
+inline uint16_t syncGet16(const uint8_t* p) { return (uint16_t)(p[0] | p[1] << 8); }
+inline uint32_t syncGet32(const uint8_t* p) {
+  return (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+inline uint8_t* syncPutBase(uint8_t* p, const HistSample& s) {
+  syncPut32(p, s.t);
+  p[4] = s.hr;
+  p[5] = s.spo2;
+  p[6] = (uint8_t)((s.battery & 0x7F) | (s.worn ? 0x80 : 0));
+  syncPut32(p + 7, (uint32_t)s.steps);
+  syncPut32(p + 11, (uint32_t)s.altDm);
+  return p + SYNC_BASE_BYTES;
+}
+
+inline void syncGetBase(const uint8_t* p, HistSample& s) {
+  s.t       = syncGet32(p);
+  s.hr      = p[4];
+  s.spo2    = p[5];
+  s.battery = p[6] & 0x7F;
+  s.worn    = p[6] & 0x80;
+  s.steps   = (int32_t)syncGet32(p + 7);
+  s.altDm   = (int32_t)syncGet32(p + 11);
+}
+
+// Append the CRC; returns the full chunk length
+inline uint16_t syncSeal(uint8_t* chunk, uint16_t len) {
+  syncPut16(chunk + len, histCrc16(0xFFFF, chunk, len));
+  return len + SYNC_CHUNK_CRC;
+}
+
+inline bool syncCheck(const uint8_t* chunk, uint16_t n) {
+  return n > SYNC_CHUNK_CRC &&
+         histCrc16(0xFFFF, chunk, n - SYNC_CHUNK_CRC) == syncGet16(chunk + n - SYNC_CHUNK_CRC);
+}
+
+// ── Link ─────────────────────────────────────────────────────
+struct SyncLink {
+  uint16_t (*mtu)();                              // ATT MTU in use now
+  bool     (*send)(const uint8_t* p, uint16_t n); // one notification; false = stack full, later
+};
+
+// ── Watch side ───────────────────────────────────────────────
+class SyncSender {
+public:
+  // Counters since boot
+  uint32_t sessions    = 0;      // STARTs taken
+  uint32_t chunksSent  = 0;
+  uint32_t chunksAgain = 0;      // resends after a NACK or timeout
+  uint32_t samplesSent = 0;
+  uint64_t bytesSent   = 0;
+  uint32_t nacks       = 0;
+  uint32_t timeouts    = 0;
+  uint32_t ctlDropped  = 0;      // control queue full
+
+  SyncSender(HistoryStore& store, const SyncLink& link, uint32_t (*nowUs)())
+    : store_(store), link_(link), nowUs_(nowUs) {}
+
+  // From the control characteristic's write callback (BLE task)
+  void onControl(const uint8_t* p, uint16_t n) {
+    uint8_t h = __atomic_load_n(&ctlHead_, __ATOMIC_RELAXED);
+    uint8_t t = __atomic_load_n(&ctlTail_, __ATOMIC_ACQUIRE);
+    if ((uint8_t)(h - t) >= SYNC_CTL_QUEUE || n == 0 || n > SYNC_CTL_MAX) {
+      ctlDropped++;
+      return;
+    }
+    CtlMsg& m = ctl_[h % SYNC_CTL_QUEUE];
+    memcpy(m.b, p, n);
+    m.n = (uint8_t)n;
+    __atomic_store_n(&ctlHead_, (uint8_t)(h + 1), __ATOMIC_RELEASE);
+  }
+
+  // Link went down (BLE task too); the phone resumes with START
+  void disconnect() {
+    const uint8_t stop = SYNC_STOP;
+    onControl(&stop, 1);
+  }
+
+  // From a scheduler task: handle control, then send what the
+  // window and SYNC_BURST allow
+  void run() {
+    uint8_t h = __atomic_load_n(&ctlHead_, __ATOMIC_ACQUIRE);
+    while (ctlTail_ != h) {
+      const CtlMsg& m = ctl_[ctlTail_ % SYNC_CTL_QUEUE];
+      control(m.b, m.n);
+      __atomic_store_n(&ctlTail_, (uint8_t)(ctlTail_ + 1), __ATOMIC_RELEASE);
+    }
+    if (!active_) return;
+
+    uint32_t now = nowUs_();
+    if (nFlight_ && now - progressUs_ > SYNC_RETRY_US) {
+      timeouts++;
+      shrink();
+      goBack(flight(0).seq);
+    }
+
+    for (uint8_t k = 0; k < SYNC_BURST && nFlight_ < window_; k++) {
+      uint16_t n = held_ ? held_ : build();
+      if (!n) {
+        if (!endSent_) sendEnd();
+        return;
+      }
+      held_ = 0;
+      bool last = nFlight_ + 1 >= window_;
+      if (last != (bool)(chunk_[0] & SYNC_ACK_NOW)) {
+        chunk_[0] ^= SYNC_ACK_NOW;
+        n = syncSeal(chunk_, n - SYNC_CHUNK_CRC);
+      }
+      if (!link_.send(chunk_, n)) {         // stack full: same chunk next run
+        held_ = n;
+        return;
+      }
+      if (!nFlight_) progressUs_ = now;
+      Flight& f = flight(nFlight_++);
+      f.seq = nextSeq_++;
+      f.t   = chunkT_;
+      if ((int16_t)(f.seq - highSeq_) <= 0) chunksAgain++;
+      else highSeq_ = f.seq;
+      chunksSent++;
+      samplesSent += chunkSamples_;
+      bytesSent   += n;
+      endSent_ = false;
+    }
+  }
+
+  // The store was erased ahead (history.prepare()) — the cursor
+  // may point at a sector that's gone; find the place again
+  void reseek() {
+    if (active_) goBack(nFlight_ ? flight(0).seq : nextSeq_);
+  }
+
+  bool     active() const   { return active_; }
+  uint8_t  window() const   { return window_; }
+  uint8_t  inFlight() const { return nFlight_; }
+
+private:
+  struct CtlMsg { uint8_t b[SYNC_CTL_MAX]; uint8_t n; };
+  struct Flight { uint16_t seq; uint32_t t; };
+
+  HistoryStore& store_;
+  SyncLink      link_;
+  uint32_t    (*nowUs_)();
+
+  CtlMsg   ctl_[SYNC_CTL_QUEUE];
+  uint8_t  ctlHead_ = 0, ctlTail_ = 0;   // head: BLE task, tail: run()
+
+  bool       active_   = false;
+  bool       endSent_  = false;
+  uint16_t   nextSeq_  = 0, highSeq_ = 0;
+  uint32_t   nextT_    = 0;          // first t not yet in a chunk
+  uint32_t   progressUs_ = 0;
+  Flight     flight_[SYNC_WINDOW];
+  uint8_t    flightHead_ = 0, nFlight_ = 0;
+  uint8_t    window_ = SYNC_WINDOW_MIN, grown_ = 0;
+  HistCursor cur_;
+  bool       curOk_ = false;
+  uint32_t   seekBlocks_ = 0;            // store_.blocksOut at the last seek
+  uint16_t   held_ = 0;                  // built, not yet taken by the link
+  uint32_t   chunkT_ = 0;
+  uint16_t   chunkSamples_ = 0;
+  uint8_t    chunk_[SYNC_CHUNK_MAX];
+
+  Flight& flight(uint8_t k) { return flight_[(flightHead_ + k) % SYNC_WINDOW]; }
+
+  void control(const uint8_t* p, uint8_t n) {
+    switch (p[0]) {
+      case SYNC_START:
+        if (n < 7) return;
+        store_.flush();                     // up to this second
+        sessions++;
+        active_     = true;
+        endSent_    = false;
+        nFlight_    = 0;
+        held_       = 0;
+        nextSeq_    = syncGet16(p + 5);
+        highSeq_    = nextSeq_ - 1;
+        window_     = SYNC_WINDOW_MIN;
+        grown_      = 0;
+        nextT_      = syncGet32(p + 1);
+        curOk_      = position(nextT_);
+        break;
+      case SYNC_ACK:
+        if (n >= 3) ack(syncGet16(p + 1));
+        break;
+      case SYNC_NACK:
+        if (n < 3) return;
+        nacks++;
+        ack((uint16_t)(syncGet16(p + 1) - 1));
+        if (nFlight_ && flight(0).seq == syncGet16(p + 1)) {
+          shrink();
+          goBack(flight(0).seq);
+        }
+        break;
+      case SYNC_STOP:
+        active_  = false;
+        nFlight_ = 0;
+        held_    = 0;
+        break;
+    }
+  }
+
+  // Everything up to and including seq has arrived
+  void ack(uint16_t seq) {
+    bool moved = false;
+    while (nFlight_ && (int16_t)(seq - flight(0).seq) >= 0) {
+      flightHead_ = (uint8_t)((flightHead_ + 1) % SYNC_WINDOW);
+      nFlight_--;
+      moved = true;
+      if (++grown_ >= window_) {
+        grown_ = 0;
+        if (window_ < SYNC_WINDOW) window_++;
+      }
+    }
+    if (moved) progressUs_ = nowUs_();
+  }
+
+  void shrink() {
+    window_ = window_ / 2 < SYNC_WINDOW_MIN ? SYNC_WINDOW_MIN : window_ / 2;
+    grown_  = 0;
+  }
+
+  // Resend from seq: forget it and everything after, re-read flash
+  void goBack(uint16_t seq) {
+    uint8_t keep = 0;
+    while (keep < nFlight_ && flight(keep).seq != seq) keep++;
+    if (keep < nFlight_) nextT_ = flight(keep).t;
+    else if (held_)      nextT_ = chunkT_;
+    nFlight_ = keep;
+    nextSeq_ = seq;
+    held_    = 0;
+    curOk_   = position(nextT_);
+    progressUs_ = nowUs_();
+  }
+
+  // Put cur_ at the first sample with t' >= t. Seeking to t − 1
+  // and stepping over it keeps the cursor valid when t is past the
+  // newest sample — the usual case for a phone that is up to date —
+  // so next() returns blocks as they are flushed.
+  bool position(uint32_t t) {
+    seekBlocks_ = store_.blocksOut;
+    HistSample s;
+    if (t && store_.seek(t - 1, cur_)) {
+      if (cur_.state.t < t) store_.next(cur_, s);
+      return true;
+    }
+    return store_.seek(t, cur_);
+  }
+
+  // Next chunk into chunk_; 0 when there is nothing new in flash
+  uint16_t build() {
+    if (!curOk_ && store_.blocksOut != seekBlocks_) curOk_ = position(nextT_);
+    HistSample s, prev;
+    if (!curOk_ || !store_.next(cur_, s)) return 0;
+
+    uint16_t room = link_.mtu() > SYNC_ATT_HDR ? link_.mtu() - SYNC_ATT_HDR : 0;
+    if (room > SYNC_CHUNK_MAX) room = SYNC_CHUNK_MAX;
+    room -= SYNC_CHUNK_CRC;
+
+    chunk_[0] = SYNC_DATA;
+    syncPut16(chunk_ + 1, nextSeq_);
+    uint8_t* p = syncPutBase(chunk_ + SYNC_CHUNK_HDR, s);
+    chunkT_       = s.t;
+    chunkSamples_ = 1;
+    prev = s;
+    uint8_t rec[HIST_REC_MAX];
+    while (store_.next(cur_, s)) {
+      uint16_t len = (uint16_t)(histEncode(rec, s, prev) - rec);
+      if ((p - chunk_) + len > room) {
+        cur_.staged = true;                 // cur_.state is s: hand it out again
+        break;
+      }
+      memcpy(p, rec, len);
+      p += len;
+      prev = s;
+      chunkSamples_++;
+    }
+    nextT_ = prev.t + 1;
+    return syncSeal(chunk_, (uint16_t)(p - chunk_));
+  }
+
+  void sendEnd() {
+    uint8_t e[9];
+    e[0] = SYNC_END;
+    syncPut16(e + 1, nextSeq_);
+    syncPut32(e + 3, nextT_ - 1);
+    if (link_.send(e, syncSeal(e, 7))) endSent_ = true;
+  }
+};
+
+// ── Phone side ───────────────────────────────────────────────
+// Reference receiver, as a phone app would implement it; the host
+// tests drive it against the watch side. Replies (ACK / NACK /
+// START) go into `out`; the return value is their length.
+typedef void (*SyncSampleFn)(const HistSample& s, void* ctx);
+
+class SyncReceiver {
+public:
+  uint32_t chunks = 0, samples = 0, dupes = 0, gaps = 0, badCrc = 0, ends = 0;
+  uint16_t expect  = 0;          // next seq wanted
+  uint32_t lastT   = 0;          // newest sample taken
+  bool     haveT   = false;
+  bool     caughtUp = false;     // END seen with nothing outstanding
+
+  SyncReceiver(SyncSampleFn fn, void* ctx) : fn_(fn), ctx_(ctx) {}
+
+  // After connecting, and again if nothing arrives for a while
+  uint8_t start(uint8_t* out) {
+    out[0] = SYNC_START;
+    syncPut32(out + 1, haveT ? lastT + 1 : 0);
+    syncPut16(out + 5, expect);
+    nacked_ = false;
+    sinceAck_ = 0;
+    caughtUp = false;
+    return 7;
+  }
+
+  uint8_t onChunk(const uint8_t* p, uint16_t n, uint8_t* out) {
+    if (n < SYNC_CHUNK_HDR + SYNC_CHUNK_CRC || !syncCheck(p, n)) { badCrc++; return 0; }
+    uint16_t seq = syncGet16(p + 1);
+    int16_t  d   = (int16_t)(seq - expect);
+
+    if (p[0] == SYNC_END) {
+      ends++;
+      if (d == 0) {
+        caughtUp = true;
+        return reply(out, SYNC_ACK, expect - 1);
+      }
+      return d > 0 ? nack(out) : 0;
+    }
+    bool now = p[0] & SYNC_ACK_NOW;
+    if ((p[0] & ~SYNC_ACK_NOW) != SYNC_DATA || n < SYNC_CHUNK_HDR + SYNC_BASE_BYTES + SYNC_CHUNK_CRC) {
+      badCrc++;
+      return 0;
+    }
+    if (d < 0) {                          // seen it: our ACK was lost
+      dupes++;
+      return reply(out, SYNC_ACK, expect - 1);
+    }
+    if (d > 0) {
+      gaps++;
+      return nack(out);
+    }
+
+    HistSample s;
+    syncGetBase(p + SYNC_CHUNK_HDR, s);
+    const uint8_t* q   = p + SYNC_CHUNK_HDR + SYNC_BASE_BYTES;
+    const uint8_t* end = p + n - SYNC_CHUNK_CRC;
+    take(s);
+    while (q && q < end) {
+      q = histDecode(q, end, s);
+      if (q) take(s);
+    }
+    chunks++;
+    expect++;
+    nacked_ = false;
+    caughtUp = false;
+    if (++sinceAck_ >= SYNC_ACK_EVERY || now) return reply(out, SYNC_ACK, expect - 1);
+    return 0;
+  }
+
+private:
+  SyncSampleFn fn_;
+  void*        ctx_;
+  bool         nacked_ = false;
+  uint8_t      sinceAck_ = 0;
+
+  void take(const HistSample& s) {
+    lastT = s.t;
+    haveT = true;
+    samples++;
+    if (fn_) fn_(s, ctx_);
+  }
+
+  uint8_t reply(uint8_t* out, uint8_t type, uint16_t seq) {
+    out[0] = type;
+    syncPut16(out + 1, seq);
+    sinceAck_ = 0;
+    return 3;
+  }
+
+  // Once per gap; the watch's timeout covers a lost NACK
+  uint8_t nack(uint8_t* out) {
+    if (nacked_) return 0;
+    nacked_ = true;
+    return reply(out, SYNC_NACK, expect);
+  }
+};
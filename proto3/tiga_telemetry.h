@@ -0,0 +1,259 @@
+// ============================================================
+// tiga_telemetry.h — versioned, compact live telemetry codec
+// ============================================================
+// The 20-byte bleNotify() packet sends every field every second,
+// changed or not, with four bytes reserved and nothing saying
+// which layout it is. This codec sends only what moved, as small
+// varint deltas, under a version the phone can check. The firmware
+// encodes with it; the host builds the same header into a decoder
+// library (proto3/host, `make lib`) for the app and tools.
+//
+// ── Frame (one notification, little-endian varints) ──────────
+//     [0]     header    bits 7-4  TEL_VERSION
+//                       bit  3    key frame
+//                       bits 2-0  seq, +1 per frame sent
+//     [1..]   presence  varint, bit f set = field f follows
+//     [..]    values    one zigzag varint per present field, in
+//                       field order: the change since the value
+//                       last sent for that field
+//
+// A key frame first sets every field's base to 0 on both sides,
+// so its values are the readings themselves. The watch sends one
+// when the phone subscribes and every TEL_KEY_EVERY seconds; a decoder that sees
+// a seq gap drops delta frames until the next one. A quiet second
+// (nothing past its deadband) sends nothing at all.
+//
+// ── Fields ───────────────────────────────────────────────────
+//     0  hr        bpm, 0 = no reading            deadband 2
+//     1  spo2      %, 0 = no reading                       1
+//     2  steps     count                                   0
+//     3  altDm     altitude, decimetres                    5
+//     4  floors    count                                   0
+//     5  battery   %                                       1
+//     6  flags     TelFlag bits                            0
+//     7  falls     count this session                      0
+//     8  gpsSats   count                                   1
+//     9  pressure  hPa × 10                                2
+//    10  rmssd     HRV over the last minute, ms, 0 = none  2
+//    11  sdnn      ms, 0 = no reading                      2
+//    12  pnn50     %, 0 = no reading                       2
+// A field is sent when it is more than its deadband away from
+// what the phone last got, so noise stays on the watch but a slow
+// drift still arrives.
+//
+// ── Evolving ─────────────────────────────────────────────────
+// New fields take the next presence bit. Every value is a varint,
+// so an older decoder skips fields it doesn't know (counted in
+// `unknown`) and the version stays. TEL_VERSION only changes when
+// an existing field changes meaning; decoders reject other
+// versions rather than guess.
+// ============================================================
+
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+
+#define TEL_VERSION     1
+#define TEL_FIELDS      13
+#define TEL_KEY_EVERY   60        // encode() calls: once a minute
+#define TEL_VARINT_MAX  5
+#define TEL_FRAME_MAX   (1 + 2 + TEL_FIELDS * TEL_VARINT_MAX)
+
+enum TelField : uint8_t {
+  TEL_HR, TEL_SPO2, TEL_STEPS, TEL_ALT_DM, TEL_FLOORS,
+  TEL_BATTERY, TEL_FLAGS, TEL_FALLS, TEL_GPS_SATS, TEL_PRESSURE,
+  TEL_RMSSD, TEL_SDNN, TEL_PNN50
+};
+
+enum TelFlag : uint8_t {
+  TEL_WORN       = 1 << 0,
+  TEL_STABLE     = 1 << 1,
+  TEL_SPO2_VALID = 1 << 2,
+  TEL_GPS_FIX    = 1 << 3
+};
+
+struct TelFieldInfo {
+  const char* name;
+  uint16_t    deadband;
+};
+
+static const TelFieldInfo TEL_FIELD_INFO[TEL_FIELDS] = {
+  {"hr",       2}, {"spo2",     1}, {"steps",    0}, {"altDm",    5},
+  {"floors",   0}, {"battery",  1}, {"flags",    0}, {"falls",    0},
+  {"gpsSats",  1}, {"pressure", 2}, {"rmssd",    2}, {"sdnn",     2},
+  {"pnn50",    2}
+};
+
+struct TelSnapshot {
+  int32_t v[TEL_FIELDS];
+};
+
+// ── Varints ──────────────────────────────────────────────────
+// Deltas wrap in 32 bits on both sides, so any int32 round-trips
+inline uint8_t telPutVarint(uint8_t* p, uint32_t v) {
+  uint8_t n = 0;
+  while (v >= 0x80) { p[n++] = (uint8_t)(v | 0x80); v >>= 7; }
+  p[n++] = (uint8_t)v;
+  return n;
+}
+
+inline uint8_t telVarintLen(uint32_t v) {
+  uint8_t n = 1;
+  while (v >= 0x80) { v >>= 7; n++; }
+  return n;
+}
+
+// nullptr on a truncated or over-long varint
+inline const uint8_t* telGetVarint(const uint8_t* p, const uint8_t* end, uint32_t* v) {
+  uint32_t x = 0;
+  for (uint8_t i = 0; i < TEL_VARINT_MAX; i++) {
+    if (p >= end) return nullptr;
+    uint8_t b = *p++;
+    if (i == TEL_VARINT_MAX - 1 && b > 0x0F) return nullptr;
+    x |= (uint32_t)(b & 0x7F) << (7 * i);
+    if (!(b & 0x80)) { *v = x; return p; }
+  }
+  return nullptr;
+}
+
+inline uint32_t telZig(uint32_t d)   { return (d << 1) ^ (uint32_t)-(int32_t)(d >> 31); }
+inline uint32_t telUnzig(uint32_t z) { return (z >> 1) ^ (uint32_t)-(int32_t)(z & 1); }
+
+// ── Watch side ───────────────────────────────────────────────
+class TelEncoder {
+public:
+  uint32_t frames    = 0;
+  uint32_t keyFrames = 0;
+  uint32_t quiet     = 0;      // calls with nothing to send
+  uint32_t deferred  = 0;      // fields that didn't fit `room`
+  uint64_t bytes     = 0;
+
+  // Next frame is a key frame. From another task, pass `key` to
+  // encode() instead.
+  void reset() { key_ = true; }
+
+  // Once a second. Writes a frame of at most `room` bytes (the
+  // notification payload, MTU − 3) and returns its length, or 0
+  // when nothing needs sending. A field that doesn't fit stays
+  // owed and goes in the next frame. `key` asks for a key frame
+  // now (a phone just subscribed). Only call it when the frame can
+  // go: what it returns counts as sent.
+  uint8_t encode(const TelSnapshot& s, uint8_t* out, uint8_t room, bool key = false) {
+    key = key || key_ || ++sinceKey_ >= TEL_KEY_EVERY;
+    uint32_t base[TEL_FIELDS];
+    if (key) memset(base, 0, sizeof(base));
+    else     memcpy(base, sent_, sizeof(base));
+
+    uint8_t  vals[TEL_FIELDS * TEL_VARINT_MAX];
+    uint8_t  nv   = 0;
+    uint32_t mask = 0;
+    for (uint8_t f = 0; f < TEL_FIELDS; f++) {
+      uint32_t d   = (uint32_t)s.v[f] - base[f];
+      uint32_t mag = (int32_t)d < 0 ? 0u - d : d;
+      if (!key && mag <= TEL_FIELD_INFO[f].deadband) continue;
+      uint32_t z = telZig(d);
+      if (1 + telVarintLen(mask | 1u << f) + nv + telVarintLen(z) > room) {
+        deferred++;
+        continue;
+      }
+      nv += telPutVarint(vals + nv, z);
+      base[f] = (uint32_t)s.v[f];
+      mask |= 1u << f;
+    }
+    if (!mask) {
+      quiet++;
+      return 0;
+    }
+
+    memcpy(sent_, base, sizeof(sent_));
+    if (key) {
+      key_      = false;
+      sinceKey_ = 0;
+      keyFrames++;
+    }
+    out[0] = (uint8_t)(TEL_VERSION << 4 | (key ? 0x08 : 0) | (seq_++ & 0x07));
+    uint8_t n = 1 + telPutVarint(out + 1, mask);
+    memcpy(out + n, vals, nv);
+    n += nv;
+    frames++;
+    bytes += n;
+    return n;
+  }
+
+private:
+  uint32_t sent_[TEL_FIELDS] = {};
+  bool     key_      = true;
+  uint8_t  sinceKey_ = 0;
+  uint8_t  seq_      = 0;
+};
+
+// ── Phone side ───────────────────────────────────────────────
+// Also what the host decoder library wraps. A frame is applied
+// whole or not at all.
+class TelDecoder {
+public:
+  TelSnapshot cur  = {};
+  uint32_t    have = 0;        // fields received since the last key frame
+  bool        synced = false;  // a key frame seen and no gap since
+
+  uint32_t frames    = 0;      // applied
+  uint32_t keyFrames = 0;
+  uint32_t gaps      = 0;      // seq jumps; deltas dropped until a key frame
+  uint32_t stale     = 0;      // delta frames dropped while not synced
+  uint32_t rejected  = 0;      // wrong version, truncated, malformed
+  uint32_t unknown   = 0;      // values skipped for fields newer than this decoder
+
+  // Returns the fields the frame updated, 0 if it was dropped
+  uint32_t decode(const uint8_t* p, uint16_t n) {
+    const uint8_t* end = p + n;
+    if (n < 2 || (p[0] >> 4) != TEL_VERSION) return reject();
+    bool    key = p[0] & 0x08;
+    uint8_t seq = p[0] & 0x07;
+
+    uint32_t mask;
+    const uint8_t* q = telGetVarint(p + 1, end, &mask);
+    if (!q || !mask) return reject();
+
+    uint32_t v[TEL_FIELDS];
+    for (uint8_t f = 0; f < TEL_FIELDS; f++) v[f] = key ? 0 : (uint32_t)cur.v[f];
+    uint32_t skipped = 0;
+    for (uint8_t f = 0; f < 32; f++) {
+      if (!(mask >> f & 1)) continue;
+      uint32_t z;
+      if (!(q = telGetVarint(q, end, &z))) return reject();
+      if (f < TEL_FIELDS) v[f] += telUnzig(z);
+      else                skipped++;
+    }
+    if (q != end) return reject();
+
+    if (!key) {
+      if (synced && seq != expect_) {
+        gaps++;
+        synced = false;
+      }
+      if (!synced) {
+        stale++;
+        return 0;
+      }
+    }
+    for (uint8_t f = 0; f < TEL_FIELDS; f++) cur.v[f] = (int32_t)v[f];
+    uint32_t known = mask & ((1u << TEL_FIELDS) - 1);
+    have    = key ? known : have | known;
+    synced  = true;
+    expect_ = (seq + 1) & 0x07;
+    unknown += skipped;
+    frames++;
+    if (key) keyFrames++;
+    return known;
+  }
+
+private:
+  uint8_t expect_ = 0;
+
+  uint32_t reject() {
+    rejected++;
+    synced = false;
+    return 0;
+  }
+};
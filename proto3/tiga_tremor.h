@@ -0,0 +1,289 @@
+// ============================================================
+// tiga_tremor.h — tremor spectrum for TIGA v6a
+// ============================================================
+// Finds rhythmic shaking in the 4-12 Hz tremor band from the
+// MPU6050 gyro: dominant frequency, how strong it is, and how
+// that compares with earlier sessions.
+//
+//   push()      every IMU sample, O(1): gyro X/Y/Z into a ring
+//   analyze()   when a window is due (every TREMOR_HOP samples),
+//               from a low-priority task — never in the IMU stage
+//
+// Each window is TREMOR_N samples (2.56 s at 200 Hz, 0.39 Hz per
+// bin), half overlapping the one before. Per axis: mean removed,
+// Hann window, then a radix-2 real FFT (one TREMOR_N/2-point
+// complex FFT plus a split pass, tables built once). The power of
+// the three axes is summed, so the answer doesn't depend on which
+// way the wrist is turned.
+//
+// Walking puts its cadence and harmonics right across the band,
+// so a window with a step anywhere in it is skipped rather than
+// analysed (push()'s `still`).
+//
+// Reported per window (TremorResult):
+//   hz        peak bin, refined by a parabola through its
+//             neighbours' magnitudes
+//   dps       RMS rotation rate inside the band, °/s
+//   ampDeg    the swing that rate means at hz, ± degrees
+//   present   dps ≥ TREMOR_MIN_DPS and the peak holds at least
+//             TREMOR_MIN_PEAK of the band's power — a tone, not
+//             broadband fidgeting
+//
+// Per session, the windows that found tremor are averaged
+// (TremorSession); TremorTrend keeps the last TREMOR_SESSIONS of
+// those for comparison.
+//
+// Memory: ring 6 KB (int16, two windows so analysis can run a
+// window late), FFT work 2 KB, tables 3.3 KB. No heap.
+// Cost and accuracy on synthetic tones in noise:
+// host/bench_tremor.cpp.
+// ============================================================
+
+#pragma once
+
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+#include "tiga_imu_fifo.h"
+
+// ── Config ───────────────────────────────────────────────────
+#define TREMOR_N            512       // window, samples (power of two)
+#define TREMOR_HOP          (TREMOR_N / 2)
+#define TREMOR_RING         (TREMOR_N * 2)
+#define TREMOR_LO_HZ        4.0f
+#define TREMOR_HI_HZ        12.0f
+#define TREMOR_TOP_HZ       20.0f     // share is of 0.4-20 Hz power
+#define TREMOR_MIN_DPS      1.0f      // band RMS below this is no tremor
+#define TREMOR_MIN_PEAK     0.35f     // peak ±1 bin / band power
+#define TREMOR_LSB_DPS      131.0f    // gyro counts per °/s (±250°/s)
+#define TREMOR_SESSIONS     8
+#define TREMOR_MIN_WINDOWS  8         // ~10 s still before a session counts
+
+#define TREMOR_M            (TREMOR_N / 2)   // complex FFT size
+#define TREMOR_BIN(hz)      ((uint16_t)((hz) * TREMOR_N / IMU_RATE_HZ + 0.5f))
+#define TREMOR_BIN_LO       TREMOR_BIN(TREMOR_LO_HZ)
+#define TREMOR_BIN_HI       TREMOR_BIN(TREMOR_HI_HZ)
+#define TREMOR_BIN_TOP      TREMOR_BIN(TREMOR_TOP_HZ)
+
+static_assert((TREMOR_N & (TREMOR_N - 1)) == 0, "TREMOR_N must be a power of two");
+static_assert(TREMOR_M <= 256, "bit-reverse table is uint8_t");
+
+struct TremorResult {
+  float hz;                 // dominant frequency in the band
+  float dps;                // band RMS, °/s
+  float ampDeg;             // ± degrees of swing at hz
+  float share;              // band power / 0.4-20 Hz power
+  bool  present;
+};
+
+// One session's tremor, over the windows that found it
+struct TremorSession {
+  uint16_t windows;         // still windows analysed
+  uint16_t found;           // ...with tremor present
+  float    meanHz;
+  float    meanDps;
+};
+
+// ── Session trend ────────────────────────────────────────────
+// The last TREMOR_SESSIONS sessions that had enough still time
+// to mean anything. Plain data, so the sketch can keep it in RTC
+// memory across deep sleep.
+struct TremorTrend {
+  TremorSession past[TREMOR_SESSIONS];
+  uint8_t       count;
+  uint8_t       next;
+
+  void add(const TremorSession& s) {
+    if (s.windows < TREMOR_MIN_WINDOWS) return;
+    past[next] = s;
+    next = (next + 1) % TREMOR_SESSIONS;
+    if (count < TREMOR_SESSIONS) count++;
+  }
+
+  // i = 0 is the most recent
+  const TremorSession& ago(uint8_t i) const {
+    return past[(next + TREMOR_SESSIONS - 1 - i) % TREMOR_SESSIONS];
+  }
+
+  // Band RMS now against the mean of earlier sessions that had
+  // tremor, as a percentage change. False with nothing to compare.
+  bool change(const TremorSession& now, float* pct) const {
+    float sum = 0;
+    uint8_t n = 0;
+    for (uint8_t i = 0; i < count; i++)
+      if (ago(i).found) { sum += ago(i).meanDps; n++; }
+    if (!n || !now.found || sum <= 0) return false;
+    *pct = (now.meanDps / (sum / n) - 1) * 100;
+    return true;
+  }
+};
+
+// ── Engine ───────────────────────────────────────────────────
+class TremorEngine {
+public:
+  // Counters
+  uint32_t windows;         // analysed
+  uint32_t skipped;         // a step inside the window
+  uint32_t late;            // overwritten before analyze() got to them
+
+  TremorEngine() {
+    for (uint16_t k = 0; k < TREMOR_M; k++) {
+      twr_[k] = cosf(6.2831853f * k / TREMOR_N);
+      twi_[k] = -sinf(6.2831853f * k / TREMOR_N);
+    }
+    float s2 = 0;
+    for (uint16_t n = 0; n < TREMOR_M; n++) {
+      hann_[n] = 0.5f - 0.5f * cosf(6.2831853f * n / (TREMOR_N - 1));
+      s2 += 2 * hann_[n] * hann_[n];
+    }
+    // One-sided power → mean square: 2 / (N Σw²)
+    scale_ = 2.0f / ((float)TREMOR_N * s2 * TREMOR_LSB_DPS * TREMOR_LSB_DPS);
+    uint8_t bits = 0;
+    while ((1u << bits) < TREMOR_M) bits++;
+    for (uint16_t i = 0; i < TREMOR_M; i++) {
+      uint16_t r = 0;
+      for (uint8_t b = 0; b < bits; b++) if (i >> b & 1) r |= 1 << (bits - 1 - b);
+      rev_[i] = (uint8_t)r;
+    }
+    head_ = sinceHop_ = dirty_ = 0;
+    due_ = false;
+    windows = skipped = late = 0;
+    resetSession();
+  }
+
+  // One sample. `still` false marks the whole window around it
+  // as unusable (walking, a fall).
+  void push(int16_t gx, int16_t gy, int16_t gz, bool still) {
+    uint16_t i = head_ & (TREMOR_RING - 1);
+    ring_[0][i] = gx; ring_[1][i] = gy; ring_[2][i] = gz;
+    head_++;
+    if (!still) dirty_ = TREMOR_N;
+    else if (dirty_) dirty_--;
+    if (++sinceHop_ < TREMOR_HOP || head_ < TREMOR_N) return;
+    sinceHop_ = 0;
+    if (due_) late++;                       // the last one never got analysed
+    due_   = true;
+    clean_ = dirty_ == 0;
+    end_   = head_;
+  }
+
+  bool due() const { return due_; }
+
+  // Analyse the window that is due. False when none is, or when
+  // it was skipped; otherwise fills `r` and the session.
+  bool analyze(TremorResult& r) {
+    if (!due_) return false;
+    due_ = false;
+    if (!clean_) { skipped++; return false; }
+
+    float pw[TREMOR_BIN_TOP + 2];
+    memset(pw, 0, sizeof(pw));
+    for (uint8_t axis = 0; axis < 3; axis++) {
+      load(axis);
+      fft();
+      accumulate(pw);
+    }
+    windows++;
+
+    float band = 0, total = 0;
+    uint16_t pk = TREMOR_BIN_LO;
+    for (uint16_t k = 1; k <= TREMOR_BIN_TOP; k++) total += pw[k];
+    for (uint16_t k = TREMOR_BIN_LO; k <= TREMOR_BIN_HI; k++) {
+      band += pw[k];
+      if (pw[k] > pw[pk]) pk = k;
+    }
+    float a = sqrtf(pw[pk - 1]), b = sqrtf(pw[pk]), c = sqrtf(pw[pk + 1]);
+    float den = a - 2 * b + c;
+    float d = den < 0 ? 0.5f * (a - c) / den : 0;
+    r.hz      = (pk + d) * IMU_RATE_HZ / TREMOR_N;
+    r.dps     = sqrtf(band * scale_);
+    r.ampDeg  = r.dps * 1.41421356f / (6.2831853f * r.hz);
+    r.share   = total > 0 ? band / total : 0;
+    float peak = pw[pk - 1] + pw[pk] + pw[pk + 1];
+    r.present = r.dps >= TREMOR_MIN_DPS && band > 0 && peak >= TREMOR_MIN_PEAK * band;
+
+    sess_.windows++;
+    if (r.present) {
+      sess_.found++;
+      sumHz_  += r.hz;
+      sumDps_ += r.dps;
+    }
+    return true;
+  }
+
+  TremorSession session() const {
+    TremorSession s = sess_;
+    s.meanHz  = s.found ? sumHz_  / s.found : 0;
+    s.meanDps = s.found ? sumDps_ / s.found : 0;
+    return s;
+  }
+
+  void resetSession() {
+    memset(&sess_, 0, sizeof(sess_));
+    sumHz_ = sumDps_ = 0;
+  }
+
+private:
+  int16_t  ring_[3][TREMOR_RING];
+  float    zr_[TREMOR_M], zi_[TREMOR_M];
+  float    twr_[TREMOR_M], twi_[TREMOR_M];   // e^(-2πik/N), k < N/2
+  float    hann_[TREMOR_M];                  // first half; the window is symmetric
+  uint8_t  rev_[TREMOR_M];
+  float    scale_;
+  uint32_t head_;           // samples pushed
+  uint32_t end_;            // head_ when the due window closed
+  uint16_t sinceHop_;
+  uint16_t dirty_;          // samples until a step is out of the window
+  bool     due_, clean_;
+  TremorSession sess_;
+  float    sumHz_, sumDps_;
+
+  float win(uint16_t n) const { return n < TREMOR_M ? hann_[n] : hann_[TREMOR_N - 1 - n]; }
+
+  // Window → z[n] = x[2n] + i·x[2n+1], mean removed and windowed,
+  // stored bit-reversed ready for the butterflies
+  void load(uint8_t axis) {
+    const int16_t* x = ring_[axis];
+    uint32_t s0 = end_ - TREMOR_N;
+    int32_t sum = 0;
+    for (uint16_t n = 0; n < TREMOR_N; n++) sum += x[(s0 + n) & (TREMOR_RING - 1)];
+    float mean = (float)sum / TREMOR_N;
+    for (uint16_t m = 0; m < TREMOR_M; m++) {
+      uint16_t n = 2 * m;
+      float re = (x[(s0 + n)     & (TREMOR_RING - 1)] - mean) * win(n);
+      float im = (x[(s0 + n + 1) & (TREMOR_RING - 1)] - mean) * win(n + 1);
+      zr_[rev_[m]] = re;
+      zi_[rev_[m]] = im;
+    }
+  }
+
+  // In-place radix-2 decimation-in-time over TREMOR_M points
+  void fft() {
+    for (uint16_t len = 2; len <= TREMOR_M; len <<= 1) {
+      uint16_t half = len >> 1, stride = TREMOR_N / len;
+      for (uint16_t j = 0; j < half; j++) {
+        float wr = twr_[j * stride], wi = twi_[j * stride];
+        for (uint16_t i = j; i < TREMOR_M; i += len) {
+          uint16_t k = i + half;
+          float tr = zr_[k] * wr - zi_[k] * wi;
+          float ti = zr_[k] * wi + zi_[k] * wr;
+          zr_[k] = zr_[i] - tr; zi_[k] = zi_[i] - ti;
+          zr_[i] += tr;         zi_[i] += ti;
+        }
+      }
+    }
+  }
+
+  // Split the half-size complex result into the real signal's
+  // bins 1..TREMOR_BIN_TOP+1 and add their power
+  void accumulate(float* pw) {
+    for (uint16_t k = 1; k <= TREMOR_BIN_TOP + 1; k++) {
+      uint16_t j = TREMOR_M - k;
+      float er = 0.5f * (zr_[k] + zr_[j]), ei = 0.5f * (zi_[k] - zi_[j]);
+      float orr = 0.5f * (zi_[k] + zi_[j]), oi = -0.5f * (zr_[k] - zr_[j]);
+      float xr = er + twr_[k] * orr - twi_[k] * oi;
+      float xi = ei + twr_[k] * oi + twi_[k] * orr;
+      pw[k] += xr * xr + xi * xi;
+    }
+  }
+};